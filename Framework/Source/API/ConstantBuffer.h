@@ -51,12 +51,14 @@ namespace Falcor
             {
             public:
                 Var(ConstantBuffer* pBuf, size_t offset) : mpBuf(pBuf), mOffset(offset) {}
-                template<typename T> void operator=(const T& val) { mpBuf->setVariable(mOffset, val); }
+                Var(ConstantBuffer* pBuf, const ReflectionVarHandle& handle) : mpBuf(pBuf), mOffset(handle.getOffset()), mpHandle(&handle) {}
+                template<typename T> void operator=(const T& val) { mpHandle ? mpBuf->setVariable(*mpHandle, val) : mpBuf->setVariable(mOffset, val); }
 
                 size_t getOffset() const { return mOffset; }
             protected:
                 ConstantBuffer* mpBuf;
                 size_t mOffset;
+                const ReflectionVarHandle* mpHandle = nullptr;
             };
 
             SharedPtr() = default;
@@ -66,6 +68,7 @@ namespace Falcor
 
             Var operator[](size_t offset) { return Var(get(), offset); }
             Var operator[](const std::string& var) { return Var(get(), get()->getVariableOffset(var)); }
+            Var operator[](const ReflectionVarHandle& handle) { return Var(get(), handle); }
         };
 
         using SharedConstPtr = std::shared_ptr<const ConstantBuffer>;
@@ -122,6 +125,29 @@ namespace Falcor
             return VariablesBuffer::setVariable(offset, 0, value);
         }
 
+        /** Set a variable into the buffer.
+            The function will validate that the value Type matches the type the handle was resolved with. If there's a mismatch, an error will be logged and the call will be ignored.
+            \param[in] handle The variable handle, resolved with getVariableHandle()
+            \param[in] value Value to set
+        */
+        template<typename T>
+        void setVariable(const ReflectionVarHandle& handle, const T& value)
+        {
+            return VariablesBuffer::setVariable(handle, 0, value);
+        }
+
+        /** Set a variable array in the buffer.
+            The function will validate that the value Type matches the type the handle was resolved with. If there's a mismatch, an error will be logged and the call will be ignored.
+            \param[in] handle The variable handle, resolved with getVariableHandle()
+            \param[in] pValue Pointer to an array of values to set
+            \param[in] count pValue array size
+        */
+        template<typename T>
+        void setVariableArray(const ReflectionVarHandle& handle, const T* pValue, size_t count)
+        {
+            return VariablesBuffer::setVariableArray(handle, 0, pValue, count);
+        }
+
         /** Set a variable array in the buffer.
             The function will validate that the value Type matches the declaration in the shader. If there's a mismatch, an error will be logged and the call will be ignored.
             \param[in] name The variable name. See notes about naming in the ConstantBuffer class description.
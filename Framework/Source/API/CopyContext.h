@@ -56,7 +56,7 @@ namespace Falcor
             uint32_t mRowCount;
             ResourceFormat mTextureFormat;
             D3D12_PLACED_SUBRESOURCE_FOOTPRINT mFootprint;
-#elif defined(FALCOR_VK)
+#elif defined(FALCOR_VK) || defined(FALCOR_NULL)
             size_t mDataSize;
 #endif
         };
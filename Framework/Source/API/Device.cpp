@@ -31,7 +31,7 @@
 
 namespace Falcor
 {
-    Device::SharedPtr Device::create(Window::SharedPtr& pWindow, const Device::Desc& desc)
+    Device::SharedPtr Device::create(const Window::SharedPtr& pWindow, const Device::Desc& desc)
     {
         if (gpDevice)
         {
@@ -71,9 +71,17 @@ namespace Falcor
         mpResourceAllocator = ResourceAllocator::create(1024 * 1024 * 2, mpRenderContext->getLowLevelData()->getFence());
 
         mpFrameFence = GpuFence::create();
+        mpGsoCache = GraphicsStateObjectCache::create();
 
         // Update the FBOs
-        if (updateDefaultFBO(mpWindow->getClientAreaWidth(), mpWindow->getClientAreaHeight(), desc.colorFormat, desc.depthFormat) == false)
+#ifdef FALCOR_NULL
+        uint32_t width = mpWindow ? mpWindow->getClientAreaWidth() : desc.headlessWidth;
+        uint32_t height = mpWindow ? mpWindow->getClientAreaHeight() : desc.headlessHeight;
+#else
+        uint32_t width = mpWindow->getClientAreaWidth();
+        uint32_t height = mpWindow->getClientAreaHeight();
+#endif
+        if (updateDefaultFBO(width, height, desc.colorFormat, desc.depthFormat) == false)
         {
             return false;
         }
@@ -179,6 +187,7 @@ namespace Falcor
 
         for (uint32_t i = 0; i < arraysize(mCmdQueues); i++) mCmdQueues[i].clear();
         for (uint32_t i = 0; i < mSwapChainBufferCount; i++) mpSwapChainFbos[i].reset();
+        mpGsoCache.reset();
         mDeferredReleases = decltype(mDeferredReleases)();
 
         mpRenderContext.reset();
@@ -262,7 +271,7 @@ namespace Falcor
         }
 #endif
 
-#if !defined(FALCOR_D3D12) && !defined(FALCOR_VK)
+#if !defined(FALCOR_D3D12) && !defined(FALCOR_VK) && !defined(FALCOR_NULL)
 #error Verify state handling on swapchain resize for this API
 #endif
 
@@ -33,6 +33,7 @@
 #include "API/LowLevel/DescriptorPool.h"
 #include "API/LowLevel/ResourceAllocator.h"
 #include "API/QueryHeap.h"
+#include "API/GraphicsStateObject.h"
 
 namespace Falcor
 {
@@ -71,6 +72,10 @@ namespace Falcor
 #ifdef FALCOR_D3D12
             // GUID list for experimental features
             std::vector<UUID> experimentalFeatures;
+#endif
+#ifdef FALCOR_NULL
+            uint32_t headlessWidth = 1920;                                  ///< Swap-chain width when the device is created without a window
+            uint32_t headlessHeight = 1080;                                 ///< Swap-chain height when the device is created without a window
 #endif
         };
 
@@ -83,11 +88,11 @@ namespace Falcor
         };
 
         /** Create a new device.
-            \param[in] pWindow a previously-created window object
+            \param[in] pWindow a previously-created window object. The null backend also accepts nullptr, in which case the swap-chain size is taken from the descriptor
             \param[in] desc Device configuration descriptor.
             \return nullptr if the function failed, otherwise a new device object
         */
-        static SharedPtr create(Window::SharedPtr& pWindow, const Desc& desc);
+        static SharedPtr create(const Window::SharedPtr& pWindow, const Desc& desc);
 
         /** Acts as the destructor for Device. Some resources use gpDevice in their cleanup.
             Cleaning up the SharedPtr directly would clear gpDevice before calling destructors.
@@ -150,6 +155,9 @@ namespace Falcor
         const DescriptorPool::SharedPtr& getGpuDescriptorPool() const { return mpGpuDescPool; }
         const ResourceAllocator::SharedPtr& getResourceAllocator() const { return mpResourceAllocator; }
         const QueryHeap::SharedPtr& getTimestampQueryHeap() const { return mTimestampQueryHeap; }
+        /** Get the graphics state objects shared by all the GraphicsState objects. The cache lives as long as the device, see StateObjectCache::removeIf() about releasing its objects
+        */
+        const GraphicsStateObjectCache::SharedPtr& getGraphicsStateObjectCache() const { return mpGsoCache; }
         void releaseResource(ApiObjectHandle pResource);
         double getGpuTimestampFrequency() const { return mGpuTimestampFrequency; } // ms/tick
 
@@ -168,6 +176,11 @@ namespace Falcor
         uint32_t getVkMemoryType(MemoryType falcorType, uint32_t memoryTypeBits) const;
         const VkPhysicalDeviceLimits& getPhysicalDeviceLimits() const;
         uint32_t  getDeviceVendorID() const;
+#endif
+#ifdef FALCOR_NULL
+        /** Get the API calls recorded during the last presented frame
+        */
+        const NullApiStats& getLastFrameStats() const;
 #endif
     private:
         struct ResourceRelease
@@ -200,6 +213,7 @@ namespace Falcor
         bool mVsyncOn;
         size_t mFrameID = 0;
         QueryHeap::SharedPtr mTimestampQueryHeap;
+        GraphicsStateObjectCache::SharedPtr mpGsoCache;
         double mGpuTimestampFrequency;
         std::vector<CommandQueueHandle> mCmdQueues[kQueueTypeCount];
 
@@ -30,6 +30,7 @@
 #include "BlendState.h"
 #include "VAO.h"
 #include "Device.h"
+#include "Utils/Hash.h"
 
 namespace Falcor
 {
@@ -37,6 +38,13 @@ namespace Falcor
     RasterizerState::SharedPtr GraphicsStateObject::spDefaultRasterizerState;
     DepthStencilState::SharedPtr GraphicsStateObject::spDefaultDepthStencilState;
 
+    // The default states are assigned to descriptors with null states when the object is created. Map them back to null, so that both forms compare and hash the same
+    template<typename T>
+    static const T* getCanonicalState(const std::shared_ptr<T>& pState, const std::shared_ptr<T>& pDefault)
+    {
+        return (pState == pDefault) ? nullptr : pState.get();
+    }
+
     bool GraphicsStateObject::Desc::operator==(const GraphicsStateObject::Desc& other) const
     {
         bool b = true;
@@ -47,35 +55,33 @@ namespace Falcor
         b = b && (mpRootSignature           == other.mpRootSignature);
         b = b && (mPrimType                 == other.mPrimType);
         b = b && (mSinglePassStereoEnabled  == other.mSinglePassStereoEnabled);
+        b = b && (getCanonicalState(mpRasterizerState, spDefaultRasterizerState) == getCanonicalState(other.mpRasterizerState, spDefaultRasterizerState));
+        b = b && (getCanonicalState(mpBlendState, spDefaultBlendState) == getCanonicalState(other.mpBlendState, spDefaultBlendState));
+        b = b && (getCanonicalState(mpDepthStencilState, spDefaultDepthStencilState) == getCanonicalState(other.mpDepthStencilState, spDefaultDepthStencilState));
+        return b;
+    }
 
-        if (mpRasterizerState)
-        {
-            b = b && (mpRasterizerState == other.mpRasterizerState);
-        }
-        else
-        {
-            b = b && (other.mpRasterizerState == nullptr || other.mpRasterizerState == spDefaultRasterizerState);
-        }
-
-        if (mpBlendState)
-        {
-            b = b && (mpBlendState == other.mpBlendState);
-        }
-        else
+    uint64_t GraphicsStateObject::Desc::getHash() const
+    {
+        const void* pointers[] =
         {
-            b = b && (other.mpBlendState == nullptr || other.mpBlendState == spDefaultBlendState);
-        }
+            mpLayout.get(),
+            mpProgram.get(),
+            mpRootSignature.get(),
+            getCanonicalState(mpRasterizerState, spDefaultRasterizerState),
+            getCanonicalState(mpBlendState, spDefaultBlendState),
+            getCanonicalState(mpDepthStencilState, spDefaultDepthStencilState),
+        };
+        uint64_t hash = hashData(pointers, sizeof(pointers));
 
-        if (mpDepthStencilState)
+        uint32_t values[] = { mSampleMask, (uint32_t)mPrimType, mSinglePassStereoEnabled ? 1u : 0u, mFboDesc.getSampleCount(), (uint32_t)mFboDesc.getDepthStencilFormat(), mFboDesc.isDepthStencilUav() ? 1u : 0u };
+        hash = hashData(values, sizeof(values), hash);
+        for (uint32_t i = 0; i < Fbo::getMaxColorTargetCount(); i++)
         {
-            b = b && (mpDepthStencilState == other.mpDepthStencilState);
+            uint32_t target[] = { (uint32_t)mFboDesc.getColorTargetFormat(i), mFboDesc.isColorTargetUav(i) ? 1u : 0u };
+            hash = hashData(target, sizeof(target), hash);
         }
-        else
-        {
-            b = b && (other.mpDepthStencilState == nullptr || other.mpDepthStencilState == spDefaultDepthStencilState);
-        }
-
-        return b;
+        return hash;
     }
 
     GraphicsStateObject::~GraphicsStateObject()
@@ -34,6 +34,7 @@
 #include "API/BlendState.h"
 #include "API/LowLevel/RootSignature.h"
 #include "API/VAO.h"
+#include "Utils/StateObjectCache.h"
 
 namespace Falcor
 {
@@ -88,8 +89,14 @@ namespace Falcor
 
             bool getSinglePassStereoEnabled() const { return mSinglePassStereoEnabled; }
 
+            /** Comparison operator. A null blend, rasterizer or depth-stencil state is equal to the default state
+            */
             bool operator==(const Desc& other) const;
 
+            /** Get a hash of the descriptor, consistent with operator==. The hash is only valid for the lifetime of the objects the descriptor references
+            */
+            uint64_t getHash() const;
+
         private:
             friend class GraphicsStateObject;
             VertexLayout::SharedConstPtr mpLayout;
@@ -133,4 +140,6 @@ namespace Falcor
 
         bool apiInit();
     };
+
+    using GraphicsStateObjectCache = StateObjectCache<GraphicsStateObject>;
 }
\ No newline at end of file
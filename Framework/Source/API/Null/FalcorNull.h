@@ -0,0 +1,130 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#define NOMINMAX
+#include "API/Formats.h"
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace Falcor
+{
+    /** CPU memory backing a buffer or a texture.
+        The null backend doesn't use a GPU. Resources are allocated in system memory, and copies and updates are executed immediately.
+    */
+    struct NullResourceData
+    {
+        using SharedPtr = std::shared_ptr<NullResourceData>;
+        std::vector<uint8_t> data;
+    };
+
+    /** API calls recorded by the null backend.
+        Draws and dispatches are not executed, they only update the counters. Device::getLastFrameStats() returns the counters of the last presented frame.
+    */
+    struct NullApiStats
+    {
+        uint64_t draws = 0;                 ///< Draw calls, including indirect draws and blits
+        uint64_t indirectDraws = 0;         ///< Indirect draw calls
+        uint64_t instances = 0;             ///< Instances submitted by direct draw calls
+        uint64_t dispatches = 0;            ///< Dispatch calls, including indirect dispatches
+        uint64_t indirectDispatches = 0;    ///< Indirect dispatch calls
+        uint64_t clears = 0;                ///< RTV, DSV and UAV clears
+        uint64_t copies = 0;                ///< Buffer and texture copies, including updates
+        uint64_t bytesCopied = 0;           ///< Number of bytes moved by the copies
+        uint64_t barriers = 0;              ///< Resource state transitions
+        uint64_t pipelineBinds = 0;         ///< Graphics and compute state objects bound by draws and dispatches
+        uint64_t descriptorWrites = 0;      ///< Descriptors written into descriptor sets
+        uint64_t descriptorSetBinds = 0;    ///< Descriptor sets bound by draws and dispatches
+        uint64_t submits = 0;               ///< Command list submissions
+    };
+
+    /** The counters of the current frame
+    */
+    dlldecl NullApiStats gNullApiStats;
+
+    using HeapCpuHandle = void*;
+    using HeapGpuHandle = void*;
+
+#ifdef _WIN32
+    using WindowHandle = HWND;
+#else
+    struct WindowHandle
+    {
+        void* pDisplay;
+        unsigned long window;
+    };
+#endif
+
+    using DeviceHandle = void*;
+    using CommandListHandle = void*;
+    using CommandQueueHandle = void*;
+    using ApiCommandQueueType = uint32_t;
+    using CommandAllocatorHandle = void*;
+    using CommandSignatureHandle = void*;
+    using FenceHandle = void*;
+    using ResourceHandle = NullResourceData::SharedPtr;
+    using RtvHandle = NullResourceData::SharedPtr;
+    using DsvHandle = NullResourceData::SharedPtr;
+    using SrvHandle = NullResourceData::SharedPtr;
+    using UavHandle = NullResourceData::SharedPtr;
+    using CbvHandle = NullResourceData::SharedPtr;
+    using FboHandle = void*;
+    using SamplerHandle = void*;
+    using GpuAddress = size_t;
+    using DescriptorSetApiHandle = void*;
+    using QueryHeapHandle = void*;
+
+    using GraphicsStateHandle = std::shared_ptr<void>;
+    using ComputeStateHandle = std::shared_ptr<void>;
+    using ShaderHandle = void*;
+    using ShaderReflectionHandle = void*;
+    using RootSignatureHandle = void*;
+    using DescriptorHeapHandle = void*;
+
+    using VaoHandle = void*;
+    using VertexShaderHandle = void*;
+    using FragmentShaderHandle = void*;
+    using DomainShaderHandle = void*;
+    using HullShaderHandle = void*;
+    using GeometryShaderHandle = void*;
+    using ComputeShaderHandle = void*;
+    using ProgramHandle = void*;
+    using DepthStencilStateHandle = void*;
+    using RasterizerStateHandle = void*;
+    using BlendStateHandle = void*;
+
+    static const uint32_t kDefaultSwapChainBuffers = 3;
+
+    using ApiObjectHandle = std::shared_ptr<void>;
+
+    uint32_t getMaxViewportCount();
+}
+
+#define UNSUPPORTED_IN_NULL(msg_) {logWarning(msg_ + std::string(" is not supported by the null backend. Ignoring call."));}
@@ -0,0 +1,94 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/Buffer.h"
+#include "API/Device.h"
+#include "API/LowLevel/ResourceAllocator.h"
+
+namespace Falcor
+{
+    Buffer::ApiHandle createNullResource(size_t size)
+    {
+        Buffer::ApiHandle apiHandle = std::make_shared<NullResourceData>();
+        apiHandle->data.resize(size);
+        return apiHandle;
+    }
+
+    void* mapBufferApi(const Buffer::ApiHandle& apiHandle, size_t size)
+    {
+        assert(apiHandle->data.size() >= size);
+        return apiHandle->data.data();
+    }
+
+    size_t getBufferDataAlignment(const Buffer* pBuffer)
+    {
+        // Match the constant-buffer alignment of the GPU backends, so that the data layout doesn't change between backends
+        return 256;
+    }
+
+    bool Buffer::apiInit(bool hasInitData)
+    {
+        if (mCpuAccess == CpuAccess::Write)
+        {
+            mDynamicData = gpDevice->getResourceAllocator()->allocate(mSize);
+            mApiHandle = mDynamicData.pResourceHandle;
+        }
+        else
+        {
+            mApiHandle = createNullResource(mSize);
+        }
+        return true;
+    }
+
+    uint64_t Buffer::getGpuAddress() const
+    {
+        UNSUPPORTED_IN_NULL(__FUNCTION__);
+        return 0;
+    }
+
+    void Buffer::unmap()
+    {
+        // Buffers live in CPU memory, only the staging buffer needs to be released
+        if (mpStagingResource)
+        {
+            mpStagingResource->unmap();
+            mpStagingResource = nullptr;
+        }
+    }
+
+    uint64_t Buffer::makeResident(Buffer::GpuAccessFlags flags) const
+    {
+        UNSUPPORTED_IN_NULL(__FUNCTION__);
+        return 0;
+    }
+
+    void Buffer::evict() const
+    {
+        UNSUPPORTED_IN_NULL(__FUNCTION__);
+    }
+}
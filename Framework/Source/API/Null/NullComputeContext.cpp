@@ -0,0 +1,97 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include <algorithm>
+#include "Framework.h"
+#include "API/ComputeContext.h"
+#include "API/Device.h"
+
+namespace Falcor
+{
+    void ComputeContext::prepareForDispatch()
+    {
+        assert(mpComputeState);
+        if(mpComputeVars) applyComputeVars();
+
+        mpComputeState->getCSO(mpComputeVars.get());
+        gNullApiStats.pipelineBinds++;
+        mBindComputeRootSig = false;
+        mCommandsPending = true;
+    }
+
+    void ComputeContext::clearUAV(const UnorderedAccessView* pUav, const vec4& value)
+    {
+        // Texture clears would require converting the value to the texture format. The texture content is left unchanged
+        resourceBarrier(pUav->getResource(), Resource::State::CopyDest);
+        gNullApiStats.clears++;
+        mCommandsPending = true;
+    }
+
+    void ComputeContext::clearUAV(const UnorderedAccessView* pUav, const uvec4& value)
+    {
+        resourceBarrier(pUav->getResource(), Resource::State::CopyDest);
+        const Buffer* pBuffer = dynamic_cast<const Buffer*>(pUav->getResource());
+        if (pBuffer)
+        {
+            // Like Vulkan, buffers are filled with a single uint value. This is what the UAV counters and the culling buffers rely on
+            if ((value.x != value.y) || ((value.x != value.z) && (value.x != value.w)))
+            {
+                logWarning("Null buffer clears only support a single element. A vector was supplied which has different elements per channel. only `x` will be used'");
+            }
+            uint32_t* pData = (uint32_t*)(pBuffer->getApiHandle()->data.data() + pBuffer->getGpuAddressOffset());
+            std::fill(pData, pData + pBuffer->getSize() / sizeof(uint32_t), value.x);
+        }
+        gNullApiStats.clears++;
+        mCommandsPending = true;
+    }
+
+    void ComputeContext::clearUAVCounter(const StructuredBuffer::SharedPtr& pBuffer, uint32_t value)
+    {
+        if (pBuffer->hasUAVCounter())
+        {
+            clearUAV(pBuffer->getUAVCounter()->getUAV().get(), uvec4(value));
+        }
+    }
+
+    void ComputeContext::initDispatchCommandSignature()
+    {
+    }
+
+    void ComputeContext::dispatch(uint32_t groupSizeX, uint32_t groupSizeY, uint32_t groupSizeZ)
+    {
+        prepareForDispatch();
+        gNullApiStats.dispatches++;
+    }
+
+    void ComputeContext::dispatchIndirect(const Buffer* pArgBuffer, uint64_t argBufferOffset)
+    {
+        prepareForDispatch();
+        resourceBarrier(pArgBuffer, Resource::State::IndirectArg);
+        gNullApiStats.dispatches++;
+        gNullApiStats.indirectDispatches++;
+    }
+}
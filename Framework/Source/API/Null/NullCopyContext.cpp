@@ -0,0 +1,259 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/CopyContext.h"
+#include "API/Buffer.h"
+#include "API/Texture.h"
+#include <cstring>
+
+namespace Falcor
+{
+    // All the copies are executed on the CPU as soon as they are recorded. Textures are stored as tightly packed blocks, subresource after subresource, in the order of Texture::getSubresourceIndex()
+
+    static uvec3 getBlockCount(ResourceFormat format, const uvec3& texels)
+    {
+        uint32_t perW = getFormatWidthCompressionRatio(format);
+        uint32_t perH = getFormatHeightCompressionRatio(format);
+        return uvec3(align_to(perW, texels.x) / perW, align_to(perH, texels.y) / perH, texels.z);
+    }
+
+    static uvec3 getMipLevelBlockCount(const Texture* pTexture, uint32_t mipLevel)
+    {
+        return getBlockCount(pTexture->getFormat(), uvec3(pTexture->getWidth(mipLevel), pTexture->getHeight(mipLevel), pTexture->getDepth(mipLevel)));
+    }
+
+    static size_t getMipLevelPackedDataSize(const Texture* pTexture, uint32_t mipLevel)
+    {
+        uvec3 blocks = getMipLevelBlockCount(pTexture, mipLevel);
+        return size_t(blocks.x) * blocks.y * blocks.z * getFormatBytesPerBlock(pTexture->getFormat());
+    }
+
+    size_t getNullSubresourceOffset(const Texture* pTexture, uint32_t subresource)
+    {
+        size_t arraySliceSize = 0;
+        size_t mipOffset = 0;
+        uint32_t mipLevel = pTexture->getSubresourceMipLevel(subresource);
+        for (uint32_t m = 0; m < pTexture->getMipCount(); m++)
+        {
+            if (m == mipLevel) mipOffset = arraySliceSize;
+            arraySliceSize += getMipLevelPackedDataSize(pTexture, m);
+        }
+        return pTexture->getSubresourceArraySlice(subresource) * arraySliceSize + mipOffset;
+    }
+
+    static uint8_t* getSubresourceData(const Texture* pTexture, uint32_t subresource)
+    {
+        return pTexture->getApiHandle()->data.data() + getNullSubresourceOffset(pTexture, subresource);
+    }
+
+    /** Copy a box of blocks between two tightly packed 3D arrays of blocks
+        \param[in] pDst The destination data
+        \param[in] dstDims The dimensions of the destination, in blocks
+        \param[in] dstOffset The offset into the destination, in blocks
+        \param[in] pSrc The source data
+        \param[in] srcDims The dimensions of the source, in blocks
+        \param[in] srcOffset The offset into the source, in blocks
+        \param[in] count The number of blocks to copy
+        \param[in] bytesPerBlock The size of a block
+        \return The number of bytes copied
+    */
+    static size_t copyBlocks(uint8_t* pDst, const uvec3& dstDims, const uvec3& dstOffset, const uint8_t* pSrc, const uvec3& srcDims, const uvec3& srcOffset, const uvec3& count, uint32_t bytesPerBlock)
+    {
+        size_t rowSize = size_t(count.x) * bytesPerBlock;
+        for (uint32_t z = 0; z < count.z; z++)
+        {
+            for (uint32_t y = 0; y < count.y; y++)
+            {
+                size_t dstIndex = (size_t(dstOffset.z + z) * dstDims.y + dstOffset.y + y) * dstDims.x + dstOffset.x;
+                size_t srcIndex = (size_t(srcOffset.z + z) * srcDims.y + srcOffset.y + y) * srcDims.x + srcOffset.x;
+                std::memcpy(pDst + dstIndex * bytesPerBlock, pSrc + srcIndex * bytesPerBlock, rowSize);
+            }
+        }
+        return rowSize * count.y * count.z;
+    }
+
+    static uvec3 getRegionSize(const Texture* pTexture, uint32_t mipLevel, const uvec3& offset, const uvec3& size)
+    {
+        uvec3 regionSize;
+        regionSize.x = (size.x == -1) ? pTexture->getWidth(mipLevel) - offset.x : size.x;
+        regionSize.y = (size.y == -1) ? pTexture->getHeight(mipLevel) - offset.y : size.y;
+        regionSize.z = (size.z == -1) ? pTexture->getDepth(mipLevel) - offset.z : size.z;
+        return regionSize;
+    }
+
+    static void recordCopy(size_t bytes)
+    {
+        gNullApiStats.copies++;
+        gNullApiStats.bytesCopied += bytes;
+    }
+
+    void CopyContext::bindDescriptorHeaps()
+    {
+    }
+
+    void CopyContext::updateTextureSubresources(const Texture* pTexture, uint32_t firstSubresource, uint32_t subresourceCount, const void* pData, const uvec3& offset, const uvec3& size)
+    {
+        bool copyRegion = (offset != uvec3(0)) || (size != uvec3(-1));
+        assert(subresourceCount == 1 || (copyRegion == false));
+
+        resourceBarrier(pTexture, Resource::State::CopyDest);
+        mCommandsPending = true;
+        ResourceFormat format = pTexture->getFormat();
+        const uint8_t* pSubResData = (uint8_t*)pData;
+        for (uint32_t i = 0; i < subresourceCount; i++)
+        {
+            uint32_t subresource = i + firstSubresource;
+            uint32_t mipLevel = pTexture->getSubresourceMipLevel(subresource);
+            uvec3 blockCount = getBlockCount(format, getRegionSize(pTexture, mipLevel, offset, size));
+            uvec3 blockOffset = getBlockCount(format, offset);
+            recordCopy(copyBlocks(getSubresourceData(pTexture, subresource), getMipLevelBlockCount(pTexture, mipLevel), blockOffset, pSubResData, blockCount, uvec3(0), blockCount, getFormatBytesPerBlock(format)));
+            pSubResData += getMipLevelPackedDataSize(pTexture, mipLevel);
+        }
+    }
+
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex)
+    {
+        SharedPtr pThis = SharedPtr(new ReadTextureTask);
+        pThis->mpContext = pCtx;
+
+        // Subresources are tightly packed, so the readback is a single copy
+        pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
+        pThis->mDataSize = getMipLevelPackedDataSize(pTexture, pTexture->getSubresourceMipLevel(subresourceIndex));
+        pThis->mpBuffer = Buffer::create(pThis->mDataSize, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+        std::memcpy(pThis->mpBuffer->getApiHandle()->data.data(), getSubresourceData(pTexture, subresourceIndex), pThis->mDataSize);
+        recordCopy(pThis->mDataSize);
+
+        pThis->mpFence = GpuFence::create();
+        pCtx->flush(false);
+        pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
+
+        return pThis;
+    }
+
+    std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
+    {
+        mpFence->syncCpu();
+        std::vector<uint8> result(mDataSize);
+        uint8* pData = reinterpret_cast<uint8*>(mpBuffer->map(Buffer::MapType::Read));
+        std::memcpy(result.data(), pData, mDataSize);
+        mpBuffer->unmap();
+        return result;
+    }
+
+    void CopyContext::uavBarrier(const Resource* pResource)
+    {
+        // Copies are executed immediately, so there are no hazards to resolve
+        gNullApiStats.barriers++;
+    }
+
+    void CopyContext::apiSubresourceBarrier(const Texture* pTexture, Resource::State newState, Resource::State oldState, uint32_t arraySlice, uint32_t mipLevel)
+    {
+        gNullApiStats.barriers++;
+    }
+
+    void CopyContext::textureBarrier(const Texture* pTexture, Resource::State newState)
+    {
+        if (pTexture->getGlobalState() != newState)
+        {
+            gNullApiStats.barriers++;
+            pTexture->setGlobalState(newState);
+            mCommandsPending = true;
+        }
+    }
+
+    void CopyContext::bufferBarrier(const Buffer* pBuffer, Resource::State newState)
+    {
+        assert(pBuffer);
+        if (pBuffer->getGlobalState() != newState)
+        {
+            gNullApiStats.barriers++;
+            pBuffer->setGlobalState(newState);
+            mCommandsPending = true;
+        }
+    }
+
+    void CopyContext::copyResource(const Resource* pDst, const Resource* pSrc)
+    {
+        const Buffer* pDstBuffer = dynamic_cast<const Buffer*>(pDst);
+        if (pDstBuffer)
+        {
+            const Buffer* pSrcBuffer = dynamic_cast<const Buffer*>(pSrc);
+            assert(pSrcBuffer && (pSrcBuffer->getSize() == pDstBuffer->getSize()));
+            copyBufferRegion(pDstBuffer, 0, pSrcBuffer, 0, pSrcBuffer->getSize());
+        }
+        else
+        {
+            const Texture* pSrcTex = dynamic_cast<const Texture*>(pSrc);
+            const Texture* pDstTex = dynamic_cast<const Texture*>(pDst);
+            assert(pSrcTex && pDstTex);
+            assert(pSrcTex->getApiHandle()->data.size() == pDstTex->getApiHandle()->data.size());
+
+            resourceBarrier(pDst, Resource::State::CopyDest);
+            resourceBarrier(pSrc, Resource::State::CopySource);
+            auto& dstData = pDstTex->getApiHandle()->data;
+            const auto& srcData = pSrcTex->getApiHandle()->data;
+            std::memcpy(dstData.data(), srcData.data(), srcData.size());
+            recordCopy(srcData.size());
+        }
+        mCommandsPending = true;
+    }
+
+    void CopyContext::copySubresource(const Texture* pDst, uint32_t dstSubresourceIdx, const Texture* pSrc, uint32_t srcSubresourceIdx)
+    {
+        copySubresourceRegion(pDst, dstSubresourceIdx, pSrc, srcSubresourceIdx);
+    }
+
+    void CopyContext::copyBufferRegion(const Buffer* pDst, uint64_t dstOffset, const Buffer* pSrc, uint64_t srcOffset, uint64_t numBytes)
+    {
+        resourceBarrier(pDst, Resource::State::CopyDest);
+        resourceBarrier(pSrc, Resource::State::CopySource);
+        uint8_t* pDstData = pDst->getApiHandle()->data.data() + pDst->getGpuAddressOffset() + dstOffset;
+        const uint8_t* pSrcData = pSrc->getApiHandle()->data.data() + pSrc->getGpuAddressOffset() + srcOffset;
+        std::memmove(pDstData, pSrcData, numBytes);
+        recordCopy(numBytes);
+        mCommandsPending = true;
+    }
+
+    void CopyContext::copySubresourceRegion(const Texture* pDst, uint32_t dstSubresource, const Texture* pSrc, uint32_t srcSubresource, const uvec3& dstOffset, const uvec3& srcOffset, const uvec3& size)
+    {
+        resourceBarrier(pDst, Resource::State::CopyDest);
+        resourceBarrier(pSrc, Resource::State::CopySource);
+
+        // The formats may differ, but they must have the same block size. The region is measured in source blocks
+        assert(getFormatBytesPerBlock(pSrc->getFormat()) == getFormatBytesPerBlock(pDst->getFormat()));
+        uint32_t srcMip = pSrc->getSubresourceMipLevel(srcSubresource);
+        uint32_t dstMip = pDst->getSubresourceMipLevel(dstSubresource);
+        ResourceFormat srcFormat = pSrc->getFormat();
+        uvec3 blockCount = getBlockCount(srcFormat, getRegionSize(pSrc, srcMip, srcOffset, size));
+
+        size_t bytes = copyBlocks(getSubresourceData(pDst, dstSubresource), getMipLevelBlockCount(pDst, dstMip), getBlockCount(pDst->getFormat(), dstOffset),
+            getSubresourceData(pSrc, srcSubresource), getMipLevelBlockCount(pSrc, srcMip), getBlockCount(srcFormat, srcOffset), blockCount, getFormatBytesPerBlock(srcFormat));
+        recordCopy(bytes);
+        mCommandsPending = true;
+    }
+}
@@ -0,0 +1,127 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/Device.h"
+
+namespace Falcor
+{
+    uint32_t getMaxViewportCount()
+    {
+        return 16;
+    }
+
+    struct DeviceApiData
+    {
+        NullApiStats lastFrameStats;
+    };
+
+    bool Device::getApiFboData(uint32_t width, uint32_t height, ResourceFormat colorFormat, ResourceFormat depthFormat, std::vector<ResourceHandle>& apiHandles, uint32_t& currentBackBufferIndex)
+    {
+        size_t size = size_t(width) * height * getFormatBytesPerBlock(colorFormat);
+        for (auto& apiHandle : apiHandles)
+        {
+            apiHandle = std::make_shared<NullResourceData>();
+            apiHandle->data.resize(size);
+        }
+        currentBackBufferIndex = 0;
+        return true;
+    }
+
+    void Device::destroyApiObjects()
+    {
+        safe_delete(mpApiData);
+    }
+
+    void Device::toggleFullScreen(bool fullscreen)
+    {
+    }
+
+    bool Device::createSwapChain(ResourceFormat colorFormat)
+    {
+        return true;
+    }
+
+    void Device::apiPresent()
+    {
+        mpApiData->lastFrameStats = gNullApiStats;
+        gNullApiStats = NullApiStats();
+        mCurrentBackBufferIndex = (mCurrentBackBufferIndex + 1) % mSwapChainBufferCount;
+    }
+
+    bool Device::apiInit(const Desc& desc)
+    {
+        mpApiData = new DeviceApiData;
+
+        // There are no queues to submit to. The context and fence code only passes the handles around
+        for (uint32_t i = 0; i < kQueueTypeCount; i++)
+        {
+            mCmdQueues[i].resize(desc.cmdQueues[i], nullptr);
+        }
+
+        // Timestamps are never written, so the frequency only needs to be valid
+        mGpuTimestampFrequency = 1e-6;
+
+        if (createSwapChain(desc.colorFormat) == false)
+        {
+            return false;
+        }
+
+        mpRenderContext = RenderContext::create(mCmdQueues[(uint32_t)LowLevelContextData::CommandQueueType::Direct][0]);
+        return true;
+    }
+
+    void Device::apiResizeSwapChain(uint32_t width, uint32_t height, ResourceFormat colorFormat)
+    {
+        createSwapChain(colorFormat);
+    }
+
+    bool Device::isWindowOccluded() const
+    {
+        return false;
+    }
+
+    bool Device::isExtensionSupported(const std::string& name) const
+    {
+        return false;
+    }
+
+    CommandQueueHandle Device::getCommandQueueHandle(LowLevelContextData::CommandQueueType type, uint32_t index) const
+    {
+        return mCmdQueues[(uint32_t)type][index];
+    }
+
+    ApiCommandQueueType Device::getApiCommandQueueType(LowLevelContextData::CommandQueueType type) const
+    {
+        return (ApiCommandQueueType)type;
+    }
+
+    const NullApiStats& Device::getLastFrameStats() const
+    {
+        return mpApiData->lastFrameStats;
+    }
+}
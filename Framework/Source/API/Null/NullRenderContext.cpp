@@ -0,0 +1,192 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/RenderContext.h"
+#include "API/Device.h"
+
+namespace Falcor
+{
+    RenderContext::SharedPtr RenderContext::create(CommandQueueHandle queue)
+    {
+        SharedPtr pCtx = SharedPtr(new RenderContext());
+        pCtx->mpLowLevelData = LowLevelContextData::create(LowLevelContextData::CommandQueueType::Direct, queue);
+        if (pCtx->mpLowLevelData == nullptr)
+        {
+            return nullptr;
+        }
+
+        pCtx->bindDescriptorHeaps();
+        return pCtx;
+    }
+
+    RenderContext::~RenderContext() = default;
+
+    void RenderContext::clearRtv(const RenderTargetView* pRtv, const glm::vec4& color)
+    {
+        resourceBarrier(pRtv->getResource(), Resource::State::CopyDest);
+        gNullApiStats.clears++;
+        mCommandsPending = true;
+    }
+
+    void RenderContext::clearDsv(const DepthStencilView* pDsv, float depth, uint8_t stencil, bool clearDepth, bool clearStencil)
+    {
+        resourceBarrier(pDsv->getResource(), Resource::State::CopyDest);
+        gNullApiStats.clears++;
+        mCommandsPending = true;
+    }
+
+    static void transitionFboResources(RenderContext* pCtx, const Fbo* pFbo)
+    {
+        uint32_t colorTargets = Fbo::getMaxColorTargetCount();
+
+        if (pFbo)
+        {
+            for (uint32_t i = 0; i < colorTargets; i++)
+            {
+                auto pTexture = pFbo->getColorTexture(i);
+                if (pTexture) pCtx->resourceBarrier(pTexture.get(), Resource::State::RenderTarget);
+            }
+
+            auto pTexture = pFbo->getDepthStencilTexture();
+            if (pTexture) pCtx->resourceBarrier(pTexture.get(), Resource::State::DepthStencil);
+        }
+    }
+
+    static void transitionVaoResources(RenderContext* pCtx, const Vao* pVao)
+    {
+        for (uint32_t i = 0; i < pVao->getVertexBuffersCount(); i++)
+        {
+            const Buffer* pVB = pVao->getVertexBuffer(i).get();
+            if (pVB) pCtx->resourceBarrier(pVB, Resource::State::VertexBuffer);
+        }
+
+        const Buffer* pIB = pVao->getIndexBuffer().get();
+        if (pIB) pCtx->resourceBarrier(pIB, Resource::State::IndexBuffer);
+    }
+
+    void RenderContext::prepareForDraw()
+    {
+        assert(mpGraphicsState);
+        // Vao must be valid so at least primitive topology is known
+        assert(mpGraphicsState->getVao().get());
+
+        // Apply the vars. Must be first because applyGraphicsVars() might cause a flush
+        if (is_set(RenderContext::StateBindFlags::Vars, mBindFlags))
+        {
+            if (mpGraphicsVars)
+            {
+                applyGraphicsVars();
+            }
+        }
+        if (is_set(RenderContext::StateBindFlags::PipelineState, mBindFlags))
+        {
+            mpGraphicsState->getGSO(mpGraphicsVars.get());
+            gNullApiStats.pipelineBinds++;
+        }
+        if (is_set(RenderContext::StateBindFlags::Fbo, mBindFlags))
+        {
+            transitionFboResources(this, mpGraphicsState->getFbo().get());
+        }
+        if (is_set(RenderContext::StateBindFlags::Vao, mBindFlags))
+        {
+            transitionVaoResources(this, mpGraphicsState->getVao().get());
+        }
+        mCommandsPending = true;
+    }
+
+    void RenderContext::drawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation)
+    {
+        prepareForDraw();
+        gNullApiStats.draws++;
+        gNullApiStats.instances += instanceCount;
+    }
+
+    void RenderContext::draw(uint32_t vertexCount, uint32_t startVertexLocation)
+    {
+        drawInstanced(vertexCount, 1, startVertexLocation, 0);
+    }
+
+    void RenderContext::drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+    {
+        prepareForDraw();
+        gNullApiStats.draws++;
+        gNullApiStats.instances += instanceCount;
+    }
+
+    void RenderContext::drawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+    {
+        drawIndexedInstanced(indexCount, 1, startIndexLocation, baseVertexLocation, 0);
+    }
+
+    void RenderContext::drawIndirect(const Buffer* pArgBuffer, uint64_t argBufferOffset)
+    {
+        resourceBarrier(pArgBuffer, Resource::State::IndirectArg);
+        prepareForDraw();
+        gNullApiStats.draws++;
+        gNullApiStats.indirectDraws++;
+    }
+
+    void RenderContext::drawIndexedIndirect(const Buffer* pArgBuffer, uint64_t argBufferOffset)
+    {
+        resourceBarrier(pArgBuffer, Resource::State::IndirectArg);
+        prepareForDraw();
+        gNullApiStats.draws++;
+        gNullApiStats.indirectDraws++;
+    }
+
+    void RenderContext::initDrawCommandSignatures()
+    {
+    }
+
+    void RenderContext::blit(ShaderResourceView::SharedPtr pSrc, RenderTargetView::SharedPtr pDst, const uvec4& srcRect, const uvec4& dstRect, Sampler::Filter filter)
+    {
+        // The GPU backends blit with a draw or a blit command. Neither filters on the CPU, so the destination is left unchanged
+        resourceBarrier(pSrc->getResource(), Resource::State::CopySource, &pSrc->getViewInfo());
+        resourceBarrier(pDst->getResource(), Resource::State::CopyDest, &pDst->getViewInfo());
+        gNullApiStats.draws++;
+        mCommandsPending = true;
+    }
+
+    void RenderContext::resolveResource(const Texture::SharedPtr& pSrc, const Texture::SharedPtr& pDst)
+    {
+        blit(pSrc->getSRV(), pDst->getRTV());
+    }
+
+    void RenderContext::resolveSubresource(const Texture::SharedPtr& pSrc, uint32_t srcSubresource, const Texture::SharedPtr& pDst, uint32_t dstSubresource)
+    {
+        uint32_t srcArray = pSrc->getSubresourceArraySlice(srcSubresource);
+        uint32_t srcMip = pSrc->getSubresourceMipLevel(srcSubresource);
+        const auto& pSrcSrv = pSrc->getSRV(srcMip, 1, srcArray, 1);
+
+        uint32_t dstArray = pDst->getSubresourceArraySlice(dstSubresource);
+        uint32_t dstMip = pDst->getSubresourceMipLevel(dstSubresource);
+        const auto& pDstRtv = pDst->getRTV(dstMip, dstArray, 1);
+
+        blit(pSrcSrv, pDstRtv);
+    }
+}
@@ -0,0 +1,120 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/ResourceViews.h"
+#include "API/Resource.h"
+
+namespace Falcor
+{
+    // The views reference the memory of the resource. Null views have a nullptr handle
+
+    template<typename T>
+    ResourceView<T>::~ResourceView() = default;
+
+    ResourceWeakPtr getEmptyTexture()
+    {
+        return ResourceWeakPtr();
+    }
+
+    static ResourceHandle getViewHandle(const Resource::SharedConstPtr& pResource)
+    {
+        return pResource ? pResource->getApiHandle() : nullptr;
+    }
+
+    ShaderResourceView::SharedPtr ShaderResourceView::create(ResourceWeakPtr pResource, uint32_t mostDetailedMip, uint32_t mipCount, uint32_t firstArraySlice, uint32_t arraySize)
+    {
+        Resource::SharedConstPtr pSharedPtr = pResource.lock();
+        if (!pSharedPtr && gNullSrv)
+        {
+            return gNullSrv;
+        }
+
+        SharedPtr pNewObj;
+        SharedPtr& pObj = pSharedPtr ? pNewObj : gNullSrv;
+        pObj = SharedPtr(new ShaderResourceView(pResource, getViewHandle(pSharedPtr), mostDetailedMip, mipCount, firstArraySlice, arraySize));
+        return pObj;
+    }
+
+    DepthStencilView::SharedPtr DepthStencilView::create(ResourceWeakPtr pResource, uint32_t mipLevel, uint32_t firstArraySlice, uint32_t arraySize)
+    {
+        Resource::SharedConstPtr pSharedPtr = pResource.lock();
+        if (!pSharedPtr && gNullDsv)
+        {
+            return gNullDsv;
+        }
+
+        SharedPtr pNewObj;
+        SharedPtr& pObj = pSharedPtr ? pNewObj : gNullDsv;
+        pObj = SharedPtr(new DepthStencilView(pResource, getViewHandle(pSharedPtr), mipLevel, firstArraySlice, arraySize));
+        return pObj;
+    }
+
+    UnorderedAccessView::SharedPtr UnorderedAccessView::create(ResourceWeakPtr pResource, uint32_t mipLevel, uint32_t firstArraySlice, uint32_t arraySize)
+    {
+        Resource::SharedConstPtr pSharedPtr = pResource.lock();
+        if (!pSharedPtr && gNullUav)
+        {
+            return gNullUav;
+        }
+
+        SharedPtr pNewObj;
+        SharedPtr& pObj = pSharedPtr ? pNewObj : gNullUav;
+        pObj = SharedPtr(new UnorderedAccessView(pResource, getViewHandle(pSharedPtr), mipLevel, firstArraySlice, arraySize));
+        return pObj;
+    }
+
+    RenderTargetView::~RenderTargetView() = default;
+
+    RenderTargetView::SharedPtr RenderTargetView::create(ResourceWeakPtr pResource, uint32_t mipLevel, uint32_t firstArraySlice, uint32_t arraySize)
+    {
+        Resource::SharedConstPtr pSharedPtr = pResource.lock();
+        if (!pSharedPtr && gNullRtv)
+        {
+            return gNullRtv;
+        }
+
+        SharedPtr pNewObj;
+        SharedPtr& pObj = pSharedPtr ? pNewObj : gNullRtv;
+        pObj = SharedPtr(new RenderTargetView(pResource, getViewHandle(pSharedPtr), mipLevel, firstArraySlice, arraySize));
+        return pObj;
+    }
+
+    ConstantBufferView::SharedPtr ConstantBufferView::create(ResourceWeakPtr pResource)
+    {
+        Resource::SharedConstPtr pSharedPtr = pResource.lock();
+        if (!pSharedPtr && gNullCbv)
+        {
+            return gNullCbv;
+        }
+
+        SharedPtr pNewObj;
+        SharedPtr& pObj = pSharedPtr ? pNewObj : gNullCbv;
+        pObj = SharedPtr(new ConstantBufferView(pResource, getViewHandle(pSharedPtr)));
+        return pObj;
+    }
+}
@@ -0,0 +1,59 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/Texture.h"
+#include "API/Device.h"
+
+namespace Falcor
+{
+    size_t getNullSubresourceOffset(const Texture* pTexture, uint32_t subresource);
+
+    struct TextureApiData
+    {
+    };
+
+    Texture::~Texture()
+    {
+        if (gpDevice) gpDevice->releaseResource(mApiHandle);
+    }
+
+    void Texture::apinit(const void* pData, bool autoGenMips)
+    {
+        mState.global = pData ? Resource::State::PreInitialized : Resource::State::Undefined;
+
+        // The subresources are stored tightly packed, one after the other. Passing the subresource count returns the total size
+        uint32_t subresourceCount = mMipLevels * mArraySize * ((mType == Type::TextureCube) ? 6 : 1);
+        mApiHandle = std::make_shared<NullResourceData>();
+        mApiHandle->data.resize(getNullSubresourceOffset(this, subresourceCount));
+
+        if (pData != nullptr)
+        {
+            uploadInitData(pData, autoGenMips);
+        }
+    }
+}
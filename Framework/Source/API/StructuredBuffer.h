@@ -53,17 +53,20 @@ namespace Falcor
                 {
                 public:
                     Var(StructuredBuffer* pBuf, size_t offset, size_t element) : mpBuf(pBuf), mElement(element), mOffset(offset) {}
-                    template<typename T> void operator=(const T& val) { mpBuf->setVariable(mOffset, mElement, val); }
+                    Var(StructuredBuffer* pBuf, const ReflectionVarHandle& handle, size_t element) : mpBuf(pBuf), mElement(element), mOffset(handle.getOffset()), mpHandle(&handle) {}
+                    template<typename T> void operator=(const T& val) { mpHandle ? mpBuf->setVariable(*mpHandle, mElement, val) : mpBuf->setVariable(mOffset, mElement, val); }
                     template<typename T> operator T() const { T val;  mpBuf->getVariable(mOffset, mElement, val); return val; }
                 protected:
                     size_t mElement;
                     size_t mOffset;
                     StructuredBuffer* mpBuf;
+                    const ReflectionVarHandle* mpHandle = nullptr;
                 };
 
                 Element(StructuredBuffer* pBuf, size_t element) : mpBuf(pBuf), mElement(element) {}
                 Var operator[](size_t offset) { return Var(mpBuf, offset, mElement); }
                 Var operator[](const std::string& var) { return Var(mpBuf, mpBuf->getVariableOffset(var), mElement); }
+                Var operator[](const ReflectionVarHandle& handle) { return Var(mpBuf, handle, mElement); }
                 size_t getElement() const { return mElement; }
             private:
                 StructuredBuffer* mpBuf;
@@ -28,7 +28,7 @@
 #include "Framework.h"
 #include "API/Texture.h"
 #include "API/Device.h"
-#include "Utils/ThreadPool.h"
+#include "Utils/TaskScheduler.h"
 
 namespace Falcor
 {
@@ -134,8 +134,7 @@ namespace Falcor
             Bitmap::saveImage(filename, getWidth(mipLevel), getHeight(mipLevel), format, exportFlags, getFormat(), true, (void*)textureData.data());
         };
 
-        static ThreadPool<16> sThreadPool;
-        sThreadPool.getAvailable() = std::thread(func);
+        TaskScheduler::getDefault()->submit(func);
     }
 
     void Texture::uploadInitData(const void* pData, bool autoGenMips)
@@ -381,6 +381,141 @@ namespace Falcor
 
 #undef set_constant_array_by_string
 
+    template<typename VarType>
+    bool checkVariableByHandle(const ReflectionVarHandle& handle, size_t count, const ReflectionResourceType* pReflection)
+    {
+#if _LOG_ENABLED
+        if (handle.isValid() == false)
+        {
+            logError("Trying to set a variable using an invalid handle");
+            return false;
+        }
+
+        // Buffers can be shared between programs with the same declarations. If the handle was resolved for another program, validate it against this buffer's layout
+        if (handle.getOwner() != pReflection)
+        {
+            return checkVariableByOffset<VarType>(handle.getOffset(), count, pReflection);
+        }
+
+        static const ReflectionBasicType::Type callType = getReflectionTypeFromCType<VarType>();
+        if (handle.getBasicType() != callType)
+        {
+            logError("Error when setting variable at offset " + std::to_string(handle.getOffset()) + ". Type mismatch. Expecting " + to_string(handle.getBasicType()) + " but the user provided a " + to_string(callType));
+            return false;
+        }
+
+        if (count != 0 && count > handle.getArraySize())
+        {
+            logError("Error when setting variable at offset " + std::to_string(handle.getOffset()) + ". Trying to set too many array elements.");
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    template<typename VarType>
+    void VariablesBuffer::setVariable(const ReflectionVarHandle& handle, size_t elementIndex, const VarType& value)
+    {
+        verify_element_index();
+        if (checkVariableByHandle<VarType>(handle, 0, mpReflector.get()))
+        {
+            uint8_t* pVar = mData.data() + handle.getOffset() + elementIndex * mElementSize;
+            *(VarType*)pVar = value;
+            mDirty = true;
+        }
+    }
+
+#define set_constant_by_handle(_t) template void VariablesBuffer::setVariable(const ReflectionVarHandle& handle, size_t elementIndex, const _t& value)
+
+    set_constant_by_handle(bool);
+    set_constant_by_handle(glm::bvec2);
+    set_constant_by_handle(glm::bvec3);
+    set_constant_by_handle(glm::bvec4);
+
+    set_constant_by_handle(uint32_t);
+    set_constant_by_handle(glm::uvec2);
+    set_constant_by_handle(glm::uvec3);
+    set_constant_by_handle(glm::uvec4);
+
+    set_constant_by_handle(int32_t);
+    set_constant_by_handle(glm::ivec2);
+    set_constant_by_handle(glm::ivec3);
+    set_constant_by_handle(glm::ivec4);
+
+    set_constant_by_handle(float);
+    set_constant_by_handle(glm::vec2);
+    set_constant_by_handle(glm::vec3);
+    set_constant_by_handle(glm::vec4);
+
+    set_constant_by_handle(glm::mat2);
+    set_constant_by_handle(glm::mat2x3);
+    set_constant_by_handle(glm::mat2x4);
+
+    set_constant_by_handle(glm::mat3);
+    set_constant_by_handle(glm::mat3x2);
+    set_constant_by_handle(glm::mat3x4);
+
+    set_constant_by_handle(glm::mat4);
+    set_constant_by_handle(glm::mat4x2);
+    set_constant_by_handle(glm::mat4x3);
+
+    set_constant_by_handle(uint64_t);
+
+#undef set_constant_by_handle
+
+    template<typename VarType>
+    void VariablesBuffer::setVariableArray(const ReflectionVarHandle& handle, size_t elementIndex, const VarType* pValue, size_t count)
+    {
+        verify_element_index();
+        if (checkVariableByHandle<VarType>(handle, count, mpReflector.get()))
+        {
+            VarType* pData = (VarType*)(mData.data() + handle.getOffset() + elementIndex * mElementSize);
+            for (size_t i = 0; i < count; i++)
+            {
+                pData[i] = pValue[i];
+            }
+            mDirty = true;
+        }
+    }
+
+#define set_constant_array_by_handle(_t) template void VariablesBuffer::setVariableArray(const ReflectionVarHandle& handle, size_t elementIndex, const _t* pValue, size_t count)
+
+    set_constant_array_by_handle(bool);
+    set_constant_array_by_handle(glm::bvec2);
+    set_constant_array_by_handle(glm::bvec3);
+    set_constant_array_by_handle(glm::bvec4);
+
+    set_constant_array_by_handle(uint32_t);
+    set_constant_array_by_handle(glm::uvec2);
+    set_constant_array_by_handle(glm::uvec3);
+    set_constant_array_by_handle(glm::uvec4);
+
+    set_constant_array_by_handle(int32_t);
+    set_constant_array_by_handle(glm::ivec2);
+    set_constant_array_by_handle(glm::ivec3);
+    set_constant_array_by_handle(glm::ivec4);
+
+    set_constant_array_by_handle(float);
+    set_constant_array_by_handle(glm::vec2);
+    set_constant_array_by_handle(glm::vec3);
+    set_constant_array_by_handle(glm::vec4);
+
+    set_constant_array_by_handle(glm::mat2);
+    set_constant_array_by_handle(glm::mat2x3);
+    set_constant_array_by_handle(glm::mat2x4);
+
+    set_constant_array_by_handle(glm::mat3);
+    set_constant_array_by_handle(glm::mat3x2);
+    set_constant_array_by_handle(glm::mat3x4);
+
+    set_constant_array_by_handle(glm::mat4);
+    set_constant_array_by_handle(glm::mat4x2);
+    set_constant_array_by_handle(glm::mat4x3);
+
+    set_constant_array_by_handle(uint64_t);
+
+#undef set_constant_array_by_handle
+
     void VariablesBuffer::setBlob(const void* pSrc, size_t offset, size_t size)
     {
         if((_LOG_ENABLED != 0) && (offset + size > mSize))
@@ -78,6 +78,10 @@ namespace Falcor
         */
         size_t getVariableOffset(const std::string& varName) const;
 
+        /** Resolve a variable handle. Setting a variable through a handle skips the name lookup, so use it for variables which are set frequently. See ReflectionVarHandle
+        */
+        ReflectionVarHandle getVariableHandle(const std::string& varName) const { return ReflectionVarHandle::create(mpReflector, varName); }
+
         size_t getElementCount() const { return mElementCount; }
 
         size_t getElementSize() const { return mElementSize; }
@@ -104,6 +108,12 @@ namespace Falcor
         template<typename T>
         void setVariableArray(const std::string& name, size_t elementIndex, const T* pValue, size_t count);
 
+        template<typename T>
+        void setVariable(const ReflectionVarHandle& handle, size_t elementIndex, const T& value);
+
+        template<typename T>
+        void setVariableArray(const ReflectionVarHandle& handle, size_t elementIndex, const T* pValue, size_t count);
+
         ReflectionResourceType::SharedConstPtr mpReflector;
         std::vector<uint8_t> mData;
         mutable bool mDirty = true;
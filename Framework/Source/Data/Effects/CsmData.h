@@ -59,7 +59,7 @@ struct CsmData
 
     float2 evsmExponents DEFAULTS(float2(5.54f, 3.0f)); // posExp, negExp
     float cascadeBlendThreshold DEFAULTS(0.0f);
-    uint32_t padding;
+    uint32_t cascadeMask DEFAULTS(0xFFFFFFFF);  // The cascades the shadow pass renders into. Used to refresh only the invalid cascades of the static caster cache
 
 #ifndef HOST_CODE
     Texture2DArray shadowMap;
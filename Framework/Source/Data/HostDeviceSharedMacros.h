@@ -32,7 +32,6 @@
                     Common structures & routines
 *******************************************************************/
 
-#define MAX_INSTANCES 64    ///< Max supported instances per draw call
 #define MAX_BONES 256       ///< Max supported bones per model
 
 /*******************************************************************
@@ -65,6 +65,26 @@ namespace Falcor
         { (uint32_t)16, "16" }
     };
 
+    // Fraction of a cascade's radius which its crop can move by before being snapped again, when caching static casters
+    static const float kCascadeSnapMargin = 0.125f;
+
+    // The instance's address is stable for its lifetime. Its index isn't, since deleting an instance shifts the ones after it
+    static uint64_t getCasterID(const Scene::ModelInstance* pInstance)
+    {
+        return (uint64_t)(uintptr_t)pInstance;
+    }
+
+    // A counter which changes whenever one of the model's mesh instances moves. The versions only grow, so their sum does too
+    static uint32_t getMeshInstancesVersion(const Model* pModel)
+    {
+        uint32_t version = 0;
+        for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+        {
+            for (uint32_t i = 0; i < pModel->getMeshInstanceCount(meshID); i++) version += pModel->getMeshInstance(meshID, i)->getTransformVersion();
+        }
+        return version;
+    }
+
     class CsmSceneRenderer : public SceneRenderer
     {
     public:
@@ -76,6 +96,30 @@ namespace Falcor
 
         void setDepthClamp(bool enable) { mDepthClamp = enable; }
 
+        enum class CasterFilter
+        {
+            All,
+            Static,     // Only the casters the cache considers static
+            Dynamic,    // Only the casters the cache considers dynamic
+        };
+
+        void setCasterFilter(CasterFilter filter, const ShadowCasterCache* pCache)
+        {
+            mCasterFilter = filter;
+            mpCasterCache = pCache;
+        }
+
+        // Only draw the casters which overlap one of the cascades in the mask. A mask of 0 disables the culling
+        // This is separate from the mesh culling, which tests against the light camera's frustum and is off by default
+        void setCascadeCulling(const glm::mat4* pCascadeMats, uint32_t cascadeMask)
+        {
+            mCullCascades.clear();
+            for (uint32_t c = 0; c < CSM_MAX_CASCADES; c++)
+            {
+                if (cascadeMask & (1u << c)) mCullCascades.push_back(pCascadeMats[c]);
+            }
+        }
+
         void renderScene(RenderContext* pContext, const Camera* pCamera) override
         {
             pContext->getGraphicsState()->setRasterizerState(nullptr);
@@ -92,6 +136,12 @@ namespace Falcor
             mBindLocations.alphaMapSampler = alphaMapSamplerLoc;
 
             toggleMeshCulling(false); 
+            // The light's projection would select coarser levels than the main view, which makes the shadows self-intersect the receivers
+            toggleLodSelection(false);
+            // The cascades are drawn in a single pass with the light camera, whose frustum doesn't match the cascades. Culling meshlets against it would drop casters
+            toggleClusterCulling(false);
+            // The mips are requested by the main view. The light's projection would request mips for the shadow map's resolution instead
+            toggleTextureStreaming(false);
             Sampler::Desc desc;
             desc.setFilterMode(Sampler::Filter::Linear, Sampler::Filter::Linear, Sampler::Filter::Linear);
             mpAlphaSampler = Sampler::create(desc);
@@ -107,6 +157,36 @@ namespace Falcor
 
         bool mMaterialChanged = false;
         Sampler::SharedPtr mpAlphaSampler;
+        CasterFilter mCasterFilter = CasterFilter::All;
+        const ShadowCasterCache* mpCasterCache = nullptr;
+        std::vector<glm::mat4> mCullCascades;
+
+        bool isInCascades(const BoundingBox& box) const
+        {
+            if (mCullCascades.empty()) return true;
+            for (const auto& mat : mCullCascades)
+            {
+                if (ShadowCasterCache::isBoxInCascade(box, mat)) return true;
+            }
+            return false;
+        }
+
+        bool isModelInstanceDrawn(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance) override
+        {
+            if (SceneRenderer::isModelInstanceDrawn(currentData, pModelInstance) == false) return false;
+            if (mCasterFilter != CasterFilter::All)
+            {
+                bool isStatic = mpCasterCache->isCasterStatic(getCasterID(pModelInstance));
+                if (isStatic != (mCasterFilter == CasterFilter::Static)) return false;
+            }
+            return isInCascades(pModelInstance->getBoundingBox());
+        }
+
+        bool setPerMeshInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t drawInstanceID) override
+        {
+            if (mCullCascades.size() && !isInCascades(pMeshInstance->getBoundingBox().transform(pModelInstance->getTransformMatrix()))) return false;
+            return SceneRenderer::setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, drawInstanceID);
+        }
 
         struct
         {
@@ -345,6 +425,7 @@ namespace Falcor
             mipLevels = Texture::kMaxPossible;
         }
         mShadowPass.pFbo = FboHelper::create2D(mapWidth, mapHeight, fboDesc, mCsmData.cascadeCount, mipLevels);
+        mpStaticCasterFbo = nullptr;
         mDepthPass.pState->setFbo(FboHelper::create2D(mapWidth, mapHeight, fboDesc, mCsmData.cascadeCount));
 
         mShadowPass.fboAspectRatio = (float)mapWidth / (float)mapHeight;
@@ -467,6 +548,15 @@ namespace Falcor
             pGui->addFloatVar("Depth Bias", mCsmData.depthBias, 0, FLT_MAX, 0.0001f);
             pGui->addCheckBox("Stabilize Cascades", mControls.stabilizeCascades);
 
+            bool cacheStaticCasters = mControls.cacheStaticCasters;
+            if (pGui->addCheckBox("Cache Static Casters", cacheStaticCasters)) toggleStaticCasterCaching(cacheStaticCasters);
+            if (isCachingActive() && mpCasterCache)
+            {
+                const auto& stats = mpCasterCache->getStats();
+                std::string text = "Static casters: " + std::to_string(stats.staticCasterCount) + ", dynamic casters: " + std::to_string(stats.dynamicCasterCount) + ", refreshed cascades: " + std::to_string(stats.invalidCascadeCount);
+                pGui->addText(text.c_str());
+            }
+
             // SDSM data
             const char* sdsmGroup = "SDSM MinMax";
             if (pGui->beginGroup(sdsmGroup))
@@ -607,6 +697,39 @@ namespace Falcor
         offset.w = 0;
     }
 
+    // Like getCascadeCropParams(), but the crop only changes when the camera moves by a fraction of the cascade's size, so that the cascade can be cached
+    void getStableCascadeCropParams(const glm::vec3 crd[8], const glm::mat4& lightVP, float mapSize, glm::vec4& scale, glm::vec4& offset)
+    {
+        // The radius of the frustum's bounding sphere doesn't change when the camera moves or rotates. Quantize it, so that small changes of the partitions don't change the crop
+        glm::vec3 center = glm::vec3(0);
+        for (uint32_t i = 0; i < 8; i++) center += crd[i] * (1.0f / 8.0f);
+        float radius = 0;
+        for (uint32_t i = 0; i < 8; i++) radius = max(radius, glm::length(crd[i] - center));
+        radius = exp2(ceil(log2(max(radius, 1e-4f)) * 4.0f) / 4.0f);
+
+        // Light clip-space size. The light's transform is orthographic, with the same scale along X and Y
+        float clipRadius = radius * glm::length(glm::vec3(lightVP[0][0], lightVP[1][0], lightVP[2][0]));
+        float halfSize = clipRadius * (1 + kCascadeSnapMargin);
+
+        // Snap the crop's center to whole texels. The margin keeps the sphere inside the crop until the next snap
+        float texelSize = 2 * halfSize / mapSize;
+        float snapStep = max(1.0f, floor(kCascadeSnapMargin * clipRadius / texelSize)) * texelSize;
+        glm::vec2 centerCS = glm::vec2(lightVP * glm::vec4(center, 1.0f));
+        centerCS = glm::round(centerCS / snapStep) * snapStep;
+
+        scale = glm::vec4(1 / halfSize, 1 / halfSize, 1, 1);
+        offset = glm::vec4(-centerCS * scale.x, 0, 0);
+    }
+
+    // Quantize the scene's bounding sphere, so that the global shadow transform doesn't change when objects move a little
+    void getStableSceneBounds(Scene* pScene, glm::vec3& center, float& radius)
+    {
+        radius = exp2(ceil(log2(max(pScene->getRadius(), 1e-4f)) * 4.0f) / 4.0f);
+        float snapStep = radius * kCascadeSnapMargin;
+        center = glm::round(pScene->getCenter() / snapStep) * snapStep;
+        radius += 2 * snapStep;
+    }
+
     void CascadedShadowMaps::partitionCascades(const Camera* pCamera, const glm::vec2& distanceRange)
     {
         struct
@@ -618,8 +741,19 @@ namespace Falcor
 
         camClipSpaceToWorldSpace(pCamera, camFrustum.crd, camFrustum.center, camFrustum.radius);
 
-        // Create the global shadow space
-        createShadowMatrix(mpLight.get(), camFrustum.center, camFrustum.radius, mShadowPass.fboAspectRatio, mCsmData.globalMat);
+        // Create the global shadow space. When caching, it's fitted to the scene rather than to the camera, so that it doesn't change every frame
+        const bool stableCascades = isCachingActive();
+        if (stableCascades)
+        {
+            glm::vec3 sceneCenter;
+            float sceneRadius;
+            getStableSceneBounds(mpSceneRenderer->getScene().get(), sceneCenter, sceneRadius);
+            createShadowMatrix(mpLight.get(), sceneCenter, sceneRadius, mShadowPass.fboAspectRatio, mCsmData.globalMat);
+        }
+        else
+        {
+            createShadowMatrix(mpLight.get(), camFrustum.center, camFrustum.radius, mShadowPass.fboAspectRatio, mCsmData.globalMat);
+        }
 
         if(mCsmData.cascadeCount == 1)
         {
@@ -627,6 +761,7 @@ namespace Falcor
             mCsmData.cascadeOffset[0] = glm::vec4(0);
             mCsmData.cascadeRange[0].x = 0;
             mCsmData.cascadeRange[0].y = 1;
+            mCascadeMats[0] = mCsmData.globalMat;
             return;
         }
 
@@ -683,7 +818,18 @@ namespace Falcor
                 cascadeFrust[i + 4] = camFrustum.crd[i] + end;
             }
 
-            getCascadeCropParams(cascadeFrust, mCsmData.globalMat, mCsmData.cascadeScale[c], mCsmData.cascadeOffset[c]);
+            if (stableCascades)
+            {
+                getStableCascadeCropParams(cascadeFrust, mCsmData.globalMat, mShadowPass.mapSize.x, mCsmData.cascadeScale[c], mCsmData.cascadeOffset[c]);
+            }
+            else
+            {
+                getCascadeCropParams(cascadeFrust, mCsmData.globalMat, mCsmData.cascadeScale[c], mCsmData.cascadeOffset[c]);
+            }
+
+            // The shadow pass scales and offsets the global clip-space position
+            glm::mat4 crop = glm::translate(glm::mat4(), glm::vec3(mCsmData.cascadeOffset[c])) * glm::scale(glm::mat4(), glm::vec3(mCsmData.cascadeScale[c]));
+            mCascadeMats[c] = crop * mCsmData.globalMat;
         }
     }
 
@@ -729,6 +875,82 @@ namespace Falcor
         pCtx->popGraphicsVars();
     }
 
+    bool CascadedShadowMaps::isCachingActive() const
+    {
+        if (mControls.cacheStaticCasters == false || mpSceneRenderer == nullptr) return false;
+
+        // The VSM/EVSM modes blur the color target, which would need to be cached as well
+        return mCsmData.filterMode != CsmFilterVsm && mCsmData.filterMode != CsmFilterEvsm2 && mCsmData.filterMode != CsmFilterEvsm4;
+    }
+
+    void CascadedShadowMaps::toggleStaticCasterCaching(bool enable)
+    {
+        mControls.cacheStaticCasters = enable;
+        if (mpCasterCache) mpCasterCache->invalidateAll();
+    }
+
+    void CascadedShadowMaps::renderCachedScene(RenderContext* pCtx)
+    {
+        const Texture::SharedPtr& pShadowMap = mShadowPass.pFbo->getDepthStencilTexture();
+        if (mpCasterCache == nullptr) mpCasterCache = ShadowCasterCache::create();
+        if (mpStaticCasterFbo == nullptr)
+        {
+            Fbo::Desc fboDesc;
+            fboDesc.setDepthStencilTarget(pShadowMap->getFormat());
+            mpStaticCasterFbo = FboHelper::create2D(pShadowMap->getWidth(), pShadowMap->getHeight(), fboDesc, mCsmData.cascadeCount);
+            mpCasterCache->invalidateAll();
+        }
+
+        // Find the casters which moved, and the cascades which need to be refreshed
+        const Scene* pScene = mpSceneRenderer->getScene().get();
+        mpCasterCache->beginFrame();
+        for (uint32_t modelID = 0; modelID < pScene->getModelCount(); modelID++)
+        {
+            const Model* pModel = pScene->getModel(modelID).get();
+            const bool animated = pModel->hasAnimations();
+
+            // The mesh instances are shared by all the model's instances, so moving one of them moves all the casters of the model
+            const uint32_t meshInstancesVersion = getMeshInstancesVersion(pModel);
+            for (uint32_t instanceID = 0; instanceID < pScene->getModelInstanceCount(modelID); instanceID++)
+            {
+                const Scene::ModelInstance* pInstance = pScene->getModelInstance(modelID, instanceID).get();
+                if (pInstance->isVisible())
+                {
+                    mpCasterCache->updateCaster(getCasterID(pInstance), pInstance->getTransformVersion() + meshInstancesVersion, pInstance->getBoundingBox(), animated);
+                }
+            }
+        }
+        for (uint32_t c = 0; c < (uint32_t)mCsmData.cascadeCount; c++) mpCasterCache->setCascade(c, mCascadeMats[c]);
+        const uint32_t invalidCascades = mpCasterCache->endFrame();
+        const uint32_t allCascades = (1u << mCsmData.cascadeCount) - 1;
+
+        // Render the static casters into the invalid cascades of the cache
+        if (invalidCascades)
+        {
+            const Texture* pCache = mpStaticCasterFbo->getDepthStencilTexture().get();
+            for (uint32_t c = 0; c < (uint32_t)mCsmData.cascadeCount; c++)
+            {
+                if (invalidCascades & (1u << c)) pCtx->clearDsv(pCache->getDSV(0, c, 1).get(), 1, 0);
+            }
+
+            mCsmData.cascadeMask = invalidCascades;
+            mpCsmSceneRenderer->setCasterFilter(CsmSceneRenderer::CasterFilter::Static, mpCasterCache.get());
+            mpCsmSceneRenderer->setCascadeCulling(mCascadeMats, invalidCascades);
+            mShadowPass.pState->pushFbo(mpStaticCasterFbo, false);
+            renderScene(pCtx);
+            mShadowPass.pState->popFbo(false);
+            mpCasterCache->markCascadesRendered(invalidCascades);
+        }
+
+        // Start from the cached depth and render the dynamic casters on top
+        pCtx->copyResource(pShadowMap.get(), mpStaticCasterFbo->getDepthStencilTexture().get());
+        mCsmData.cascadeMask = allCascades;
+        mpCsmSceneRenderer->setCasterFilter(CsmSceneRenderer::CasterFilter::Dynamic, mpCasterCache.get());
+        mpCsmSceneRenderer->setCascadeCulling(mCascadeMats, allCascades);
+        renderScene(pCtx);
+        mpCsmSceneRenderer->setCasterFilter(CsmSceneRenderer::CasterFilter::All, nullptr);
+    }
+
     void CascadedShadowMaps::executeDepthPass(RenderContext* pCtx, const Camera* pCamera)
     {
         // Must have an FBO attached, otherwise don't know the size of the depth map
@@ -822,9 +1044,6 @@ namespace Falcor
     {
         if (!mpLight || !mpSceneRenderer) return;
 
-        const glm::vec4 clearColor(0);
-        pRenderCtx->clearFbo(mShadowPass.pFbo.get(), clearColor, 1, 0, FboAttachmentType::All);
-
         // Calc the bounds
         glm::vec2 distanceRange = calcDistanceRange(pRenderCtx, pCamera, pSceneDepthBuffer);
 
@@ -841,7 +1060,22 @@ namespace Falcor
         mpCsmSceneRenderer->setDepthClamp(mControls.depthClamp);
         pRenderCtx->pushGraphicsState(mShadowPass.pState);
         partitionCascades(pCamera, distanceRange);
-        renderScene(pRenderCtx);
+        if (isCachingActive())
+        {
+            renderCachedScene(pRenderCtx);
+        }
+        else
+        {
+            const glm::vec4 clearColor(0);
+            pRenderCtx->clearFbo(mShadowPass.pFbo.get(), clearColor, 1, 0, FboAttachmentType::All);
+            const uint32_t allCascades = (1u << mCsmData.cascadeCount) - 1;
+            mCsmData.cascadeMask = allCascades;
+            mpCsmSceneRenderer->setCascadeCulling(mCascadeMats, allCascades);
+            renderScene(pRenderCtx);
+        }
+
+        // The depth pass renders from the camera, so it must not be culled against the cascades
+        mpCsmSceneRenderer->setCascadeCulling(nullptr, 0);
         
         if(mCsmData.filterMode == CsmFilterVsm || mCsmData.filterMode == CsmFilterEvsm2 || mCsmData.filterMode == CsmFilterEvsm4)
         {
@@ -33,6 +33,7 @@
 #include "Graphics/Scene/Scene.h"
 #include "Utils/Math/ParallelReduction.h"
 #include "Experimental/RenderGraph/RenderPass.h"
+#include "ShadowCasterCache.h"
 
 namespace Falcor
 {
@@ -144,6 +145,20 @@ namespace Falcor
         */
         bool isMeshCullingEnabled() const;
 
+        /** Enable caching of static shadow casters. The static casters are rendered into a cache, which is only refreshed for the cascades they or the cascade's transform changed in, and the dynamic casters are rendered on top every frame.
+            The cascades are fitted to the scene's bounds and snapped to texel increments, so that their transforms only change when the camera moves far enough.
+            Only supported by the depth-based filter modes. The VSM/EVSM modes always render all the casters
+        */
+        void toggleStaticCasterCaching(bool enable);
+
+        /** Check if static caster caching is enabled
+        */
+        bool isStaticCasterCachingEnabled() const { return mControls.cacheStaticCasters; }
+
+        /** Get the static caster cache, which holds the statistics of the last frame. nullptr if caching was never used
+        */
+        const ShadowCasterCache* getShadowCasterCache() const { return mpCasterCache.get(); }
+
         /** Enable saving cascade info into the gba channels of the visibility buffer
         */
         void toggleCascadeVisualization(bool shouldVisualze);
@@ -194,6 +209,8 @@ namespace Falcor
         void createVisibilityPassResources();
         void partitionCascades(const Camera* pCamera, const glm::vec2& distanceRange);
         void renderScene(RenderContext* pCtx);
+        void renderCachedScene(RenderContext* pCtx);
+        bool isCachingActive() const;
 
         // Shadow-pass
         struct
@@ -208,6 +225,11 @@ namespace Falcor
             glm::vec2 mapSize;
         } mShadowPass;
 
+        // Static caster cache
+        ShadowCasterCache::UniquePtr mpCasterCache;
+        Fbo::SharedPtr mpStaticCasterFbo;
+        glm::mat4 mCascadeMats[CSM_MAX_CASCADES];   // Transforms from world space to each cascade's clip space
+
         // SDSM
         struct SdsmData
         {
@@ -260,6 +282,7 @@ namespace Falcor
             float pssmLambda = 0.5f;
             PartitionMode partitionMode = PartitionMode::Logarithmic;
             bool stabilizeCascades = false;
+            bool cacheStaticCasters = false;
         };
 
         int32_t renderCascade = 0;
@@ -0,0 +1,173 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ShadowCasterCache.h"
+#include <algorithm>
+#include <limits>
+
+namespace Falcor
+{
+    ShadowCasterCache::UniquePtr ShadowCasterCache::create(uint32_t settleFrameCount)
+    {
+        return UniquePtr(new ShadowCasterCache(settleFrameCount));
+    }
+
+    void ShadowCasterCache::beginFrame()
+    {
+        mFrame++;
+        mCascadeCount = 0;
+        mDirtyRegions.clear();
+    }
+
+    void ShadowCasterCache::updateCaster(uint64_t id, uint32_t transformVersion, const BoundingBox& bounds, bool alwaysDynamic)
+    {
+        auto it = mCasters.find(id);
+        if (it == mCasters.end())
+        {
+            // New casters are cached right away, so that the whole scene is cached when it's loaded
+            Caster& caster = mCasters[id];
+            caster.transformVersion = transformVersion;
+            caster.bounds = bounds;
+            caster.lastFrame = mFrame;
+            caster.isStatic = !alwaysDynamic;
+            if (caster.isStatic) mDirtyRegions.push_back(bounds);
+            return;
+        }
+
+        Caster& caster = it->second;
+        caster.lastFrame = mFrame;
+        // The bounds are compared too, in case the ID now belongs to a different caster which happens to have the same version
+        if (alwaysDynamic || caster.transformVersion != transformVersion || !(caster.bounds == bounds))
+        {
+            // The caster must be removed from the cache where it used to be
+            if (caster.isStatic) mDirtyRegions.push_back(caster.bounds);
+            caster.isStatic = false;
+            caster.stillFrameCount = 0;
+            caster.transformVersion = transformVersion;
+            caster.bounds = bounds;
+        }
+        else if (caster.isStatic == false)
+        {
+            caster.bounds = bounds;
+            if (++caster.stillFrameCount >= mSettleFrameCount)
+            {
+                caster.isStatic = true;
+                mDirtyRegions.push_back(bounds);
+            }
+        }
+    }
+
+    void ShadowCasterCache::setCascade(uint32_t cascade, const glm::mat4& viewProj)
+    {
+        assert(cascade < kMaxCascades);
+        mCascades[cascade].viewProj = viewProj;
+        mCascadeCount = std::max(mCascadeCount, cascade + 1);
+    }
+
+    uint32_t ShadowCasterCache::endFrame()
+    {
+        // Removed casters leave a hole in the cache
+        for (auto it = mCasters.begin(); it != mCasters.end();)
+        {
+            if (it->second.lastFrame != mFrame)
+            {
+                if (it->second.isStatic) mDirtyRegions.push_back(it->second.bounds);
+                it = mCasters.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        mInvalidCascades = 0;
+        for (uint32_t c = 0; c < mCascadeCount; c++)
+        {
+            Cascade& cascade = mCascades[c];
+            if (cascade.cacheValid && cascade.viewProj != cascade.cachedViewProj) cascade.cacheValid = false;
+            for (size_t r = 0; r < mDirtyRegions.size() && cascade.cacheValid; r++)
+            {
+                if (isBoxInCascade(mDirtyRegions[r], cascade.viewProj)) cascade.cacheValid = false;
+            }
+            if (cascade.cacheValid == false) mInvalidCascades |= (1u << c);
+        }
+
+        mStats = Stats();
+        for (const auto& c : mCasters)
+        {
+            if (c.second.isStatic) mStats.staticCasterCount++;
+            else mStats.dynamicCasterCount++;
+        }
+        mStats.dirtyRegionCount = (uint32_t)mDirtyRegions.size();
+        for (uint32_t mask = mInvalidCascades; mask; mask &= mask - 1) mStats.invalidCascadeCount++;
+
+        return mInvalidCascades;
+    }
+
+    bool ShadowCasterCache::isCasterStatic(uint64_t id) const
+    {
+        auto it = mCasters.find(id);
+        return (it != mCasters.end()) && it->second.isStatic;
+    }
+
+    void ShadowCasterCache::markCascadesRendered(uint32_t cascadeMask)
+    {
+        for (uint32_t c = 0; c < mCascadeCount; c++)
+        {
+            if (cascadeMask & (1u << c))
+            {
+                mCascades[c].cachedViewProj = mCascades[c].viewProj;
+                mCascades[c].cacheValid = true;
+            }
+        }
+        mInvalidCascades &= ~cascadeMask;
+    }
+
+    void ShadowCasterCache::invalidateAll()
+    {
+        for (auto& c : mCascades) c.cacheValid = false;
+    }
+
+    bool ShadowCasterCache::isBoxInCascade(const BoundingBox& box, const glm::mat4& viewProj)
+    {
+        glm::vec2 ndcMin = glm::vec2(std::numeric_limits<float>::max());
+        glm::vec2 ndcMax = glm::vec2(-std::numeric_limits<float>::max());
+        for (uint32_t corner = 0; corner < 8; corner++)
+        {
+            glm::vec3 sign = glm::vec3((corner & 1) ? 1 : -1, (corner & 2) ? 1 : -1, (corner & 4) ? 1 : -1);
+            glm::vec4 clip = viewProj * glm::vec4(box.center + sign * box.extent, 1.0f);
+
+            // The box crosses the light's plane, which only happens with perspective projections. Be conservative
+            if (clip.w <= 0) return true;
+            glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            ndcMin = glm::min(ndcMin, ndc);
+            ndcMax = glm::max(ndcMax, ndc);
+        }
+        return ndcMax.x >= -1 && ndcMin.x <= 1 && ndcMax.y >= -1 && ndcMin.y <= 1;
+    }
+}
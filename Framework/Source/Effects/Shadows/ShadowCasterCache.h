@@ -0,0 +1,142 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Utils/AABB.h"
+#include "glm/mat4x4.hpp"
+
+namespace Falcor
+{
+    /** Tracks which shadow casters are static and which cascades of a cached shadow map need to be re-rendered.
+        Casters which haven't moved for a few frames are static. Their depth is rendered once into a per-cascade cache, and only the dynamic casters are rendered on top every frame.
+        A cascade's cache is invalidated when its light-space transform changes, or when a dirty region overlaps it. Regions become dirty when a static caster starts moving, when a dynamic caster settles, and when a static caster is removed.
+        The cache doesn't touch any GPU resources, so the bookkeeping can be tested on the CPU.
+    */
+    class ShadowCasterCache
+    {
+    public:
+        using UniquePtr = std::unique_ptr<ShadowCasterCache>;
+
+        static const uint32_t kMaxCascades = 32;
+
+        /** Statistics of the last update
+        */
+        struct Stats
+        {
+            uint32_t staticCasterCount = 0;
+            uint32_t dynamicCasterCount = 0;
+            uint32_t dirtyRegionCount = 0;          ///< Dirty regions found by the last update
+            uint32_t invalidCascadeCount = 0;       ///< Cascades which need to be re-rendered
+        };
+
+        /** Create a cache
+            \param[in] settleFrameCount Number of frames a caster must stay still before it's considered static again
+        */
+        static UniquePtr create(uint32_t settleFrameCount = 8);
+
+        /** Start a frame. Call once per frame, before updating the casters and cascades
+        */
+        void beginFrame();
+
+        /** Update a caster. A caster moved if its transform version or its bounds changed
+            \param[in] id The caster's ID. Must be unique and stable across frames, so it can't depend on the caster's position in a container which other casters are removed from
+            \param[in] transformVersion A counter which changes whenever the caster moves, such as ObjectInstance::getTransformVersion()
+            \param[in] bounds The caster's world-space bounds
+            \param[in] alwaysDynamic Whether the caster is animated and can never be cached
+        */
+        void updateCaster(uint64_t id, uint32_t transformVersion, const BoundingBox& bounds, bool alwaysDynamic);
+
+        /** Set a cascade's transform. A different transform than the one the cascade's cache was rendered with invalidates the cascade
+            \param[in] cascade The cascade's index
+            \param[in] viewProj Transform from world space to the cascade's clip space
+        */
+        void setCascade(uint32_t cascade, const glm::mat4& viewProj);
+
+        /** Finish the frame's update. Removes the casters which weren't updated in this frame and computes the cascades to re-render
+            \return A mask of the cascades whose cache needs to be re-rendered
+        */
+        uint32_t endFrame();
+
+        /** Check whether a caster is static. Static casters are rendered into the cache, dynamic ones on top of it every frame
+        */
+        bool isCasterStatic(uint64_t id) const;
+
+        /** Get the mask of the cascades whose cache needs to be re-rendered
+        */
+        uint32_t getInvalidCascadeMask() const { return mInvalidCascades; }
+
+        /** Mark cascades as re-rendered, using the transforms passed to setCascade()
+        */
+        void markCascadesRendered(uint32_t cascadeMask);
+
+        /** Invalidate all the cascades, for example after the shadow-map was resized
+        */
+        void invalidateAll();
+
+        /** Get the statistics of the last update
+        */
+        const Stats& getStats() const { return mStats; }
+
+        /** Check whether a world-space box overlaps a cascade's shadow-map. Depth is ignored, since casters in front of the cascade also cast shadows into it
+            \param[in] box The world-space box
+            \param[in] viewProj Transform from world space to the cascade's clip space
+        */
+        static bool isBoxInCascade(const BoundingBox& box, const glm::mat4& viewProj);
+
+    private:
+        ShadowCasterCache(uint32_t settleFrameCount) : mSettleFrameCount(settleFrameCount) {}
+
+        struct Caster
+        {
+            uint32_t transformVersion = 0;
+            BoundingBox bounds;
+            uint32_t stillFrameCount = 0;   // Number of consecutive frames without movement
+            uint64_t lastFrame = 0;         // The last frame the caster was updated in
+            bool isStatic = false;
+        };
+
+        struct Cascade
+        {
+            glm::mat4 viewProj;             // The current transform
+            glm::mat4 cachedViewProj;       // The transform the cache was rendered with
+            bool cacheValid = false;
+        };
+
+        uint32_t mSettleFrameCount;
+        uint64_t mFrame = 0;
+        std::unordered_map<uint64_t, Caster> mCasters;
+        std::vector<BoundingBox> mDirtyRegions;
+        Cascade mCascades[kMaxCascades];
+        uint32_t mCascadeCount = 0;
+        uint32_t mInvalidCascades = 0;
+        Stats mStats;
+    };
+}
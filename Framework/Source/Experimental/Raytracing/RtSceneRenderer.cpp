@@ -29,6 +29,7 @@
 #include "RtSceneRenderer.h"
 #include "RtProgramVars.h"
 #include "RtState.h"
+#include "glm/matrix.hpp"
 
 namespace Falcor
 {
@@ -112,7 +113,23 @@ namespace Falcor
             setVertexBuffer(mMeshBufferLocations.prevPosition, VERTEX_POSITION_LOC, pVao, pVars);
         }
 
-        return SceneRenderer::setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, drawInstanceID);
+        // Hit groups are set up for a single mesh instance, so the transforms are set into the per-mesh constant buffer rather than into the instance buffers
+        ConstantBuffer* pCB = pVars->getConstantBuffer(kPerMeshCbName).get();
+        if (pCB)
+        {
+            glm::mat4 worldMat;
+            glm::mat4 prevWorldMat;
+            getMeshInstanceTransforms(pModelInstance, pMeshInstance, worldMat, prevWorldMat);
+            glm::mat3x4 worldInvTransposeMat = transpose(inverse(glm::mat3(worldMat)));
+
+            pCB->setBlob(&worldMat, sWorldMatOffset, sizeof(glm::mat4));
+            pCB->setBlob(&worldInvTransposeMat, sWorldInvTransposeMatOffset, sizeof(glm::mat3x4)); // HLSL uses column-major and packing rules require 16B alignment, hence use glm:mat3x4
+            pCB->setBlob(&prevWorldMat, sPrevWorldMatOffset, sizeof(glm::mat4));
+            pCB->setVariable(sMeshIdOffset, pMesh->getId());
+            pCB->setVariable(sFirstInstanceOffset, 0u);
+        }
+
+        return true;
     }
 
     void RtSceneRenderer::setPerFrameData(RtProgramVars* pRtVars, InstanceData& data)
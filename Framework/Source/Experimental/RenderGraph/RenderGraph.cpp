@@ -94,7 +94,7 @@ namespace Falcor
             mNameToIndex[passName] = passIndex;
         }
 
-        auto passChangedCB = [this]() {mRecompile = true; };
+        auto passChangedCB = [this, passIndex]() {mDirtyPasses.insert(passIndex); };
         pPass->setPassChangedCB(passChangedCB);
         pPass->setScene(mpScene);
         mNodeData[passIndex] = { passName, pPass, passFlags };
@@ -154,11 +154,11 @@ namespace Falcor
         auto pPass = RenderPassLibrary::instance().createPass(passTypeName.c_str(), dict);
         pPassIt->second.pPass = pPass;
 
-        auto passChangedCB = [this]() {mRecompile = true; };
+        auto passChangedCB = [this, index]() {mDirtyPasses.insert(index); };
         pPass->setPassChangedCB(passChangedCB);
 
         pPass->setScene(mpScene);
-        mRecompile = true;
+        mDirtyPasses.insert(index);
     }
 
     const RenderPass::SharedPtr& RenderGraph::getPass(const std::string& name) const
@@ -568,6 +568,7 @@ namespace Falcor
             passToIndex.emplace(mNodeData[mExecutionList[i]].pPass.get(), uint32_t(i));
         }
 
+        mPassReflections.clear();
         for (size_t i = 0; i < mExecutionList.size(); i++)
         {
             uint32_t nodeIndex = mExecutionList[i];
@@ -575,6 +576,7 @@ namespace Falcor
             assert(pNode);
             RenderPass* pCurrPass = mNodeData[nodeIndex].pPass.get();
             RenderPassReflection passReflection = pCurrPass->reflect();
+            mPassReflections[nodeIndex] = passReflection;
 
             const auto isGraphOutput = [=](uint32_t nodeId, const std::string& field)
             {
@@ -625,7 +627,8 @@ namespace Falcor
                 const auto& pSrcPass = mNodeData[pEdge->getSourceNode()].pPass;
                 auto srcReflection = pSrcPass->reflect();
                 assert(passToIndex.count(pSrcPass.get()) > 0);
-                mpResourcesCache->registerField(dstFieldName, dstField, passToIndex[pSrcPass.get()], srcFieldName);
+                // The resource is alive until the last pass reading it has executed
+                mpResourcesCache->registerField(dstFieldName, dstField, uint32_t(i), srcFieldName);
             }
         }
 
@@ -633,21 +636,82 @@ namespace Falcor
         return true;
     }
 
+    bool RenderGraph::needsResourceRecompile()
+    {
+        bool recompile = false;
+        for (uint32_t nodeIndex : mDirtyPasses)
+        {
+            // Passes which weren't part of the last compilation don't affect the execution
+            auto reflectionIt = mPassReflections.find(nodeIndex);
+            auto nodeIt = mNodeData.find(nodeIndex);
+            if (reflectionIt == mPassReflections.end() || nodeIt == mNodeData.end()) continue;
+
+            RenderPassReflection reflection = nodeIt->second.pPass->reflect();
+            if (reflection == reflectionIt->second) continue;
+            recompile = true;
+
+            // Multi-sampled fields may require adding/removing auto-generated resolve passes, which changes the topology
+            const auto isMultiSampled = [](const RenderPassReflection& r)
+            {
+                for (size_t f = 0; f < r.getFieldCount(); f++)
+                {
+                    if (r.getField(f).getSampleCount() != 1) return true;
+                }
+                return false;
+            };
+            if (isMultiSampled(reflection) || isMultiSampled(reflectionIt->second)) mRecompile = true;
+        }
+        mDirtyPasses.clear();
+        return recompile;
+    }
+
+    bool RenderGraph::compileResources(std::string& log)
+    {
+        // Textures allocated so far are kept by the cache and reused where the field properties didn't change
+        mpResourcesCache->reset();
+        if (resolveResourceTypes() == false) return false;
+        return isValid(log);
+    }
+
     bool RenderGraph::compile(std::string& log)
     {
+        if (mRecompile == false && mDirtyPasses.empty()) return true;
+
+        bool profile = mProfileGraph && gProfileEnabled;
+        if (profile) Profiler::startEvent("RenderGraph::compile()");
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        // Pass changes only require re-resolving the resources if they changed the pass reflection. Topology changes require a full compilation
+        bool recompileResources = (mRecompile == false) && needsResourceRecompile();
+        bool result = true;
         if (mRecompile)
         {
             mpResourcesCache->reset();
             restoreCompilationChanges();
 
-            if (resolveExecutionOrder() == false) return false;
+            result = resolveExecutionOrder();
             // If passes were added, resolve execution order again
-            if (insertAutoPasses()) if (resolveExecutionOrder() == false) return false;
-            if (resolveResourceTypes() == false) return false;
-            if (isValid(log) == false) return false;
+            if (result && insertAutoPasses()) result = resolveExecutionOrder();
+            result = result && resolveResourceTypes() && isValid(log);
+            mCompileStats.fullCompileCount++;
         }
-        mRecompile = false;
-        return true;
+        else if (recompileResources)
+        {
+            result = compileResources(log);
+            mCompileStats.resourceCompileCount++;
+        }
+        else
+        {
+            mCompileStats.skippedCompileCount++;
+        }
+
+        // Passes added while compiling (auto-resolve) are already accounted for
+        mDirtyPasses.clear();
+        mRecompile = (result == false);
+
+        mCompileStats.lastCompileTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        if (profile) Profiler::endEvent("RenderGraph::compile()");
+        return result;
     }
 
     void RenderGraph::execute(RenderContext* pContext)
@@ -991,6 +1055,18 @@ namespace Falcor
             pGui->addCheckBox("Profile Passes", mProfileGraph);
             pGui->addTooltip("Profile the render-passes. The results will be shown in the profiler window. If you can't see it, click 'P'");
 
+            if (pGui->beginGroup("Compilation Stats"))
+            {
+                const auto& resStats = mpResourcesCache->getAllocationStats();
+                std::string stats = "Full compilations: " + std::to_string(mCompileStats.fullCompileCount) + "\n";
+                stats += "Resource compilations: " + std::to_string(mCompileStats.resourceCompileCount) + "\n";
+                stats += "Skipped compilations: " + std::to_string(mCompileStats.skippedCompileCount) + "\n";
+                stats += "Last compilation: " + std::to_string(mCompileStats.lastCompileTime) + " ms\n";
+                stats += "Textures: " + std::to_string(resStats.textureCount) + " (" + std::to_string(resStats.reusedTextureCount) + " reused)";
+                pGui->addText(stats.c_str());
+                pGui->endGroup();
+            }
+
             for (const auto& passId : mExecutionList)
             {
                 const auto& pass = mNodeData[passId];
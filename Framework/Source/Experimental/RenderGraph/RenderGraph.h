@@ -29,6 +29,7 @@
 #include "RenderPass.h"
 #include "Utils/DirectedGraph.h"
 #include "ResourceCache.h"
+#include <unordered_set>
 
 namespace Falcor
 {
@@ -171,6 +172,20 @@ namespace Falcor
         */
         void profileGraph(bool enabled) { mProfileGraph = enabled; }
 
+        /** Graph compilation statistics
+        */
+        struct CompileStats
+        {
+            uint32_t fullCompileCount = 0;          ///< Number of compilations which rebuilt the execution order and the resources
+            uint32_t resourceCompileCount = 0;      ///< Number of compilations which only re-resolved the resources
+            uint32_t skippedCompileCount = 0;       ///< Number of pass changes which didn't require any recompilation
+            float lastCompileTime = 0;              ///< CPU time of the last compilation, in milliseconds
+        };
+
+        /** Get the compilation statistics
+        */
+        const CompileStats& getCompileStats() const { return mCompileStats; }
+
         /** Mouse event handler.
             Returns true if the event was handled by the object, false otherwise
         */
@@ -201,6 +216,8 @@ namespace Falcor
         std::string mName;
 
         bool compile(std::string& log);
+        bool compileResources(std::string& log);
+        bool needsResourceRecompile();
         bool resolveExecutionOrder();
         bool insertAutoPasses();
         bool resolveResourceTypes();
@@ -226,6 +243,9 @@ namespace Falcor
         void restoreCompilationChanges();
 
         bool mRecompile = true;
+        std::unordered_set<uint32_t> mDirtyPasses; // Passes which changed without changing the graph topology
+        std::unordered_map<uint32_t, RenderPassReflection> mPassReflections; // The reflection of the executed passes at the time of the last compilation
+        CompileStats mCompileStats;
         std::shared_ptr<Scene> mpScene;
 
         std::unordered_map<std::string, uint32_t> mNameToIndex;
@@ -95,6 +95,26 @@ namespace Falcor
         return true;
     }
 
+    bool RenderPassReflection::Field::operator==(const Field& other) const
+    {
+#define compare_field(_a) if (_a != other._a) return false
+        compare_field(mType);
+        compare_field(mName);
+        compare_field(mDesc);
+        compare_field(mWidth);
+        compare_field(mHeight);
+        compare_field(mDepth);
+        compare_field(mSampleCount);
+        compare_field(mMipLevels);
+        compare_field(mArraySize);
+        compare_field(mFormat);
+        compare_field(mBindFlags);
+        compare_field(mFlags);
+        compare_field(mVisibility);
+#undef compare_field
+        return true;
+    }
+
     RenderPassReflection::Field& RenderPassReflection::addField(const std::string& name, const std::string& desc, Field::Visibility visibility)
     {
         // See if the field already exists
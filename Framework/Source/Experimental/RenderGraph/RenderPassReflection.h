@@ -95,6 +95,11 @@ namespace Falcor
             Type getType() const { return mType; }
             Visibility getVisibility() const { return mVisibility; }
 
+            /** Check if two fields have identical properties
+            */
+            bool operator==(const Field& other) const;
+            bool operator!=(const Field& other) const { return !(*this == other); }
+
         private:
             friend class RenderPassReflection;
 
@@ -121,6 +126,11 @@ namespace Falcor
         size_t getFieldCount() const { return mFields.size(); }
         const Field& getField(size_t f) const { return mFields[f]; }
         const Field& getField(const std::string& name) const;
+
+        /** Check if two reflections contain identical fields, in the same order
+        */
+        bool operator==(const RenderPassReflection& other) const { return mFields == other.mFields; }
+        bool operator!=(const RenderPassReflection& other) const { return !(*this == other); }
     private:
         Field& addField(const std::string& name, const std::string& desc, Field::Visibility visibility);
         std::vector<Field> mFields;
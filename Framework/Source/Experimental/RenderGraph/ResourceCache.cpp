@@ -27,6 +27,7 @@
 ***************************************************************************/
 #include "Framework.h"
 #include "ResourceCache.h"
+#include <unordered_set>
 
 namespace Falcor
 {
@@ -37,6 +38,12 @@ namespace Falcor
 
     void ResourceCache::reset()
     {
+        for (const auto& it : mNameToIndex)
+        {
+            const auto& pResource = mResourceData[it.second].pResource;
+            if (pResource) mPrevTextures[it.first] = std::dynamic_pointer_cast<Texture>(pResource);
+        }
+
         mNameToIndex.clear();
         mResourceData.clear();
     }
@@ -264,50 +271,211 @@ namespace Falcor
         }
     }
 
-    Texture::SharedPtr createTextureForPass(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field)
+    /** Fully resolved texture properties of a field
+    */
+    struct TextureDesc
     {
-        uint32_t width = field.getWidth() ? field.getWidth() : params.width;
-        uint32_t height = field.getHeight() ? field.getHeight() : params.height;
-        uint32_t depth = field.getDepth() ? field.getDepth() : 1;
-        uint32_t sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
-        ResourceFormat format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 0;
+        uint32_t sampleCount = 0;
+        ResourceFormat format = ResourceFormat::Unknown;
+        Resource::BindFlags bindFlags = Resource::BindFlags::None;
+
+        bool operator==(const TextureDesc& other) const
+        {
+            return width == other.width && height == other.height && depth == other.depth && sampleCount == other.sampleCount && format == other.format && bindFlags == other.bindFlags;
+        }
 
-        auto bindFlags = getBindFlagsFromFormat(field.getBindFlags(), format, field.getVisibility());
+        uint64_t getSize() const
+        {
+            uint64_t blocksX = (width + getFormatWidthCompressionRatio(format) - 1) / getFormatWidthCompressionRatio(format);
+            uint64_t blocksY = (height + getFormatHeightCompressionRatio(format) - 1) / getFormatHeightCompressionRatio(format);
+            return blocksX * blocksY * depth * sampleCount * getFormatBytesPerBlock(format);
+        }
+    };
+
+    static TextureDesc getTextureDesc(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field)
+    {
+        TextureDesc desc;
+        desc.width = field.getWidth() ? field.getWidth() : params.width;
+        desc.height = field.getHeight() ? field.getHeight() : params.height;
+        desc.depth = field.getDepth() ? field.getDepth() : 1;
+        desc.sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
+        desc.format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+        desc.bindFlags = getBindFlagsFromFormat(field.getBindFlags(), desc.format, field.getVisibility());
+        return desc;
+    }
+
+    static bool isTextureCompatible(const Texture* pTexture, const TextureDesc& desc)
+    {
+        if (pTexture == nullptr) return false;
+        return pTexture->getWidth() == desc.width && pTexture->getHeight() == desc.height && pTexture->getDepth() == desc.depth && pTexture->getSampleCount() == desc.sampleCount &&
+            pTexture->getFormat() == desc.format && pTexture->getBindFlags() == desc.bindFlags && pTexture->getMipCount() == 1 && pTexture->getArraySize() == 1;
+    }
 
+    static Texture::SharedPtr createTextureForPass(const TextureDesc& desc)
+    {
         Texture::SharedPtr pTexture;
-        if (depth > 1)
+        if (desc.depth > 1)
         {
-            assert(sampleCount == 1);
-            pTexture = Texture::create3D(width, height, depth, format, 1, nullptr, bindFlags);
+            assert(desc.sampleCount == 1);
+            pTexture = Texture::create3D(desc.width, desc.height, desc.depth, desc.format, 1, nullptr, desc.bindFlags);
         }
-        else if (height > 1 || sampleCount > 1)
+        else if (desc.height > 1 || desc.sampleCount > 1)
         {
-            if (sampleCount > 1)
+            if (desc.sampleCount > 1)
             {
-                pTexture = Texture::create2DMS(width, height, format, sampleCount, 1, bindFlags);
+                pTexture = Texture::create2DMS(desc.width, desc.height, desc.format, desc.sampleCount, 1, desc.bindFlags);
             }
             else
             {
-                pTexture = Texture::create2D(width, height, format, 1, 1, nullptr, bindFlags);
+                pTexture = Texture::create2D(desc.width, desc.height, desc.format, 1, 1, nullptr, desc.bindFlags);
             }
         }
         else
         {
-            pTexture = Texture::create1D(width, format, 1, 1, nullptr, bindFlags);
+            pTexture = Texture::create1D(desc.width, desc.format, 1, 1, nullptr, desc.bindFlags);
         }
 
         return pTexture;
     }
 
+    std::vector<uint32_t> ResourceCache::packLifetimes(const std::vector<LifetimeInterval>& intervals, std::vector<uint64_t>& allocationSizes)
+    {
+        allocationSizes.clear();
+        std::vector<uint32_t> assignment(intervals.size(), uint32_t(-1));
+
+        // Process the intervals in order of first use. Within a class, greedily reusing any allocation which is free at that point results in the minimal allocation count
+        std::vector<uint32_t> order(intervals.size());
+        for (uint32_t i = 0; i < (uint32_t)order.size(); i++) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return intervals[a].firstUsed < intervals[b].firstUsed; });
+
+        struct Allocation
+        {
+            uint32_t compatClass;
+            uint32_t lastUsed;
+            bool shareable;
+        };
+        std::vector<Allocation> allocations;
+
+        for (uint32_t i : order)
+        {
+            const auto& interval = intervals[i];
+            assert(interval.firstUsed <= interval.lastUsed);
+
+            uint32_t slot = uint32_t(-1);
+            if (interval.canAlias)
+            {
+                for (uint32_t a = 0; a < (uint32_t)allocations.size(); a++)
+                {
+                    const auto& alloc = allocations[a];
+                    // A resource is still accessed at its lastUsed time-point, so the next user must start strictly after it
+                    if (alloc.shareable && alloc.compatClass == interval.compatClass && alloc.lastUsed < interval.firstUsed)
+                    {
+                        assert(allocationSizes[a] == interval.size);
+                        slot = a;
+                        break;
+                    }
+                }
+            }
+
+            if (slot == uint32_t(-1))
+            {
+                slot = (uint32_t)allocations.size();
+                allocations.push_back({ interval.compatClass, interval.lastUsed, interval.canAlias });
+                allocationSizes.push_back(interval.size);
+            }
+            else
+            {
+                allocations[slot].lastUsed = interval.lastUsed;
+            }
+            assignment[i] = slot;
+        }
+
+        return assignment;
+    }
+
     void ResourceCache::allocateResources(const DefaultProperties& params)
     {
-        for (auto& data : mResourceData)
+        // Resources may share textures, so changing any of them requires re-packing all of them
+        bool needsAllocation = false;
+        for (const auto& data : mResourceData)
+        {
+            if ((data.pResource == nullptr || data.dirty) && data.field.isValid()) needsAllocation = true;
+        }
+        if (needsAllocation == false) return;
+
+        // Gather the resources requiring a texture, and group them into classes of identical texture properties
+        std::vector<uint32_t> resourceIndices;
+        std::vector<TextureDesc> descs;
+        std::vector<TextureDesc> classDescs;
+        std::vector<LifetimeInterval> intervals;
+
+        for (uint32_t i = 0; i < (uint32_t)mResourceData.size(); i++)
         {
-            if ((data.pResource == nullptr || data.dirty) && data.field.isValid())
+            auto& data = mResourceData[i];
+            if (data.field.isValid() == false) continue;
+
+            TextureDesc desc = getTextureDesc(params, data.field);
+            uint32_t compatClass = (uint32_t)(std::find(classDescs.begin(), classDescs.end(), desc) - classDescs.begin());
+            if (compatClass == classDescs.size()) classDescs.push_back(desc);
+
+            LifetimeInterval interval;
+            interval.firstUsed = data.firstUsed;
+            interval.lastUsed = data.lastUsed;
+            interval.compatClass = compatClass;
+            interval.size = desc.getSize();
+            // Persistent resources must keep their content between execute() calls, so they can't be shared
+            interval.canAlias = mAliasingEnabled && (is_set(data.field.getFlags(), RenderPassReflection::Field::Flags::Persistent) == false);
+
+            resourceIndices.push_back(i);
+            descs.push_back(desc);
+            intervals.push_back(interval);
+        }
+
+        std::vector<uint64_t> allocationSizes;
+        std::vector<uint32_t> assignment = packLifetimes(intervals, allocationSizes);
+        std::vector<Texture::SharedPtr> textures(allocationSizes.size());
+
+        // Keep the textures of fields which were allocated before the last reset() and whose properties didn't change. Each texture can only back a single allocation
+        mStats = AllocationStats();
+        std::unordered_set<const Texture*> claimedTextures;
+        for (const auto& it : mNameToIndex)
+        {
+            auto prevIt = mPrevTextures.find(it.first);
+            if (prevIt == mPrevTextures.end()) continue;
+
+            size_t r = std::find(resourceIndices.begin(), resourceIndices.end(), it.second) - resourceIndices.begin();
+            if (r == resourceIndices.size() || textures[assignment[r]]) continue;
+
+            const Texture* pPrev = prevIt->second.get();
+            if (isTextureCompatible(pPrev, descs[r]) && claimedTextures.insert(pPrev).second)
             {
-                data.pResource = createTextureForPass(params, data.field);
-                data.dirty = false;
+                textures[assignment[r]] = prevIt->second;
+                mStats.reusedTextureCount++;
             }
         }
+        mPrevTextures.clear();
+
+        for (size_t r = 0; r < resourceIndices.size(); r++)
+        {
+            auto& data = mResourceData[resourceIndices[r]];
+            auto& pTexture = textures[assignment[r]];
+            if (pTexture == nullptr) pTexture = createTextureForPass(descs[r]);
+            data.pResource = pTexture;
+            data.dirty = false;
+            mStats.bytesWithoutAliasing += intervals[r].size;
+        }
+
+        mStats.resourceCount = (uint32_t)resourceIndices.size();
+        mStats.textureCount = (uint32_t)allocationSizes.size();
+        for (uint64_t size : allocationSizes) mStats.bytesWithAliasing += size;
+
+        if (mStats.resourceCount)
+        {
+            logInfo("RenderGraph transient resources: " + std::to_string(mStats.resourceCount) + " resources in " + std::to_string(mStats.textureCount) + " textures (" + std::to_string(mStats.reusedTextureCount) + " reused). Memory before aliasing " +
+                std::to_string(mStats.bytesWithoutAliasing / 1024) + "KB, after aliasing " + std::to_string(mStats.bytesWithAliasing / 1024) + "KB");
+        }
     }
 }
@@ -76,9 +76,46 @@ namespace Falcor
         void allocateResources(const DefaultProperties& params);
 
         /** Clears all registered field/resource properties and allocated resources.
+            The allocated textures are kept alive until the next allocateResources() call, which reuses them for fields with matching properties.
         */
         void reset();
 
+        /** Enable/disable sharing textures between transient resources whose lifetimes don't overlap. Takes effect on the next allocateResources() call.
+        */
+        void setAliasingEnabled(bool enabled) { mAliasingEnabled = enabled; }
+        bool isAliasingEnabled() const { return mAliasingEnabled; }
+
+        /** Statistics of the last allocateResources() call
+        */
+        struct AllocationStats
+        {
+            uint32_t resourceCount = 0;             ///< Number of graph resources requiring a texture
+            uint32_t textureCount = 0;              ///< Number of textures used by the resources
+            uint32_t reusedTextureCount = 0;        ///< Number of textures reused from before the last reset() call
+            uint64_t bytesWithoutAliasing = 0;      ///< Peak texture memory if every resource had its own texture
+            uint64_t bytesWithAliasing = 0;         ///< Peak texture memory after aliasing
+        };
+        const AllocationStats& getAllocationStats() const { return mStats; }
+
+        /** Lifetime of a resource, used to pack resources into shared allocations
+        */
+        struct LifetimeInterval
+        {
+            uint32_t firstUsed = 0;     ///< First point in time the resource is used
+            uint32_t lastUsed = 0;      ///< Last point in time the resource is used
+            uint32_t compatClass = 0;   ///< Resources can only share an allocation with resources of the same class. All resources in a class must have the same size
+            uint64_t size = 0;          ///< Size of the resource in bytes
+            bool canAlias = true;       ///< If false, the resource always gets an allocation of its own
+        };
+
+        /** Assign resource lifetimes to allocations, such that resources sharing an allocation are never used at the same point in time.
+            Uses the minimal number of allocations per compatibility class.
+            \param[in] intervals The resource lifetimes
+            \param[out] allocationSizes The size of each allocation required
+            \return For each interval, the index of the allocation it was assigned to
+        */
+        static std::vector<uint32_t> packLifetimes(const std::vector<LifetimeInterval>& intervals, std::vector<uint64_t>& allocationSizes);
+
     private:
         ResourceCache() = default;
 
@@ -100,6 +137,12 @@ namespace Falcor
 
         // References to output resources not to be allocated by the render graph
         std::unordered_map<std::string, std::shared_ptr<Resource>> mExternalInputs;
+
+        // Textures allocated before the last reset() call, available for reuse
+        std::unordered_map<std::string, Texture::SharedPtr> mPrevTextures;
+
+        bool mAliasingEnabled = true;
+        AllocationStats mStats;
     };
 
 }
\ No newline at end of file
@@ -41,6 +41,7 @@ namespace Falcor
 
     static std::string kSampleCount = "sampleCount";
     static std::string kSuperSampling = "enableSuperSampling";
+    static std::string kClusteredLighting = "clusteredLighting";
 
     ForwardLightingPass::SharedPtr ForwardLightingPass::create(const Dictionary& dict)
     {
@@ -51,6 +52,7 @@ namespace Falcor
         {
             if (v.key() == kSampleCount) pThis->setSampleCount(v.val());
             else if (v.key() == kSuperSampling) pThis->setSuperSampling(v.val());
+            else if (v.key() == kClusteredLighting) pThis->setClusteredLighting(v.val());
             logWarning("Unknown field `" + v.key() + "` in a ForwardLightingPass dictionary");
         }
 
@@ -62,6 +64,7 @@ namespace Falcor
         Dictionary d;
         d[kSampleCount] = mSampleCount;
         d[kSuperSampling] = mEnableSuperSampling;
+        d[kClusteredLighting] = mClusteredLighting;
         return d;
     }
 
@@ -70,10 +73,10 @@ namespace Falcor
         GraphicsProgram::SharedPtr pProgram = GraphicsProgram::createFromFile("RenderPasses/ForwardLightingPass.slang", "", "ps");
         mpState = GraphicsState::create();
         mpState->setProgram(pProgram);
-        mpVars = GraphicsVars::create(pProgram->getReflector());
         Sampler::Desc samplerDesc;
         samplerDesc.setFilterMode(Sampler::Filter::Linear, Sampler::Filter::Linear, Sampler::Filter::Linear);
-        setSampler(Sampler::create(samplerDesc));
+        mpSampler = Sampler::create(samplerDesc);
+        createVars();
 
         mpFbo = Fbo::create();
         
@@ -82,6 +85,15 @@ namespace Falcor
         mpDsNoDepthWrite = DepthStencilState::create(dsDesc);        
     }
 
+    void ForwardLightingPass::createVars()
+    {
+        mpVars = GraphicsVars::create(mpState->getProgram()->getReflector());
+        mPerFrameCbHandle = mpVars->getResourceHandle("PerFrameCB");
+        mRenderTargetDimHandle = mpVars[mPerFrameCbHandle]->getVariableHandle("gRenderTargetDim");
+        mVisBufferHandle = mpVars->getResourceHandle(kVisBuffer);
+        mpVars->setSampler("gSampler", mpSampler);
+    }
+
     RenderPassReflection ForwardLightingPass::reflect() const
     {
         RenderPassReflection reflector;
@@ -154,8 +166,8 @@ namespace Falcor
 
         if (mpSceneRenderer)
         {
-            mpVars["PerFrameCB"]["gRenderTargetDim"] = vec2(mpFbo->getWidth(), mpFbo->getHeight());
-            mpVars->setTexture(kVisBuffer, pRenderData->getTexture(kVisBuffer));
+            mpVars[mPerFrameCbHandle][mRenderTargetDimHandle] = vec2(mpFbo->getWidth(), mpFbo->getHeight());
+            mpVars->setTexture(mVisBufferHandle, pRenderData->getTexture(kVisBuffer));
 
             mpState->setFbo(mpFbo);
             pContext->pushGraphicsState(mpState);
@@ -180,6 +192,7 @@ namespace Falcor
         {
             if (pGui->addDropdown("Sample Count", kSampleCountList, mSampleCount))              setSampleCount(mSampleCount);
             if (mSampleCount > 1 && pGui->addCheckBox("Super Sampling", mEnableSuperSampling))  setSuperSampling(mEnableSuperSampling);
+            if (pGui->addCheckBox("Clustered Lighting", mClusteredLighting))                    setClusteredLighting(mClusteredLighting);
 
             if (uiGroup) pGui->endGroup();
         }
@@ -236,6 +249,23 @@ namespace Falcor
         return *this;
     }
 
+    ForwardLightingPass& ForwardLightingPass::setClusteredLighting(bool enable)
+    {
+        mClusteredLighting = enable;
+        if (mClusteredLighting)
+        {
+            mpState->getProgram()->addDefine("_CLUSTERED_LIGHTING");
+        }
+        else
+        {
+            mpState->getProgram()->removeDefine("_CLUSTERED_LIGHTING");
+        }
+
+        // The define adds the cluster buffers to the program, so the vars need to be recreated
+        createVars();
+        return *this;
+    }
+
     ForwardLightingPass& ForwardLightingPass::usePreGeneratedDepthBuffer(bool enable)
     {
         mUsePreGenDepth = enable;
@@ -247,6 +277,7 @@ namespace Falcor
 
     ForwardLightingPass& ForwardLightingPass::setSampler(const Sampler::SharedPtr& pSampler)
     {
+        mpSampler = pSampler;
         mpVars->setSampler("gSampler", pSampler);
         return *this;
     }
@@ -71,6 +71,10 @@ namespace Falcor
         */
         ForwardLightingPass& setSuperSampling(bool enable);
 
+        /** Enable clustered lighting. Instead of looping over the first MAX_LIGHT_SOURCES lights, each pixel evaluates the lights binned into its cluster, so the number of lights isn't limited
+        */
+        ForwardLightingPass& setClusteredLighting(bool enable);
+
         /** If set to true, the pass requires the user to provide a pre-rendered depth-buffer
         */
         ForwardLightingPass& usePreGeneratedDepthBuffer(bool enable);
@@ -86,12 +90,17 @@ namespace Falcor
         ForwardLightingPass();
         void initDepth(const RenderData* pRenderData);
         void initFbo(RenderContext* pContext, const RenderData* pRenderData);
+        void createVars();
 
         Fbo::SharedPtr mpFbo;
         GraphicsState::SharedPtr mpState;
         DepthStencilState::SharedPtr mpDsNoDepthWrite;
         GraphicsVars::SharedPtr mpVars;
+        ReflectionVarHandle mPerFrameCbHandle;
+        ReflectionVarHandle mRenderTargetDimHandle;
+        ReflectionVarHandle mVisBufferHandle;
         SceneRenderer::SharedPtr mpSceneRenderer;
+        std::shared_ptr<Sampler> mpSampler;
 
         ResourceFormat mColorFormat = ResourceFormat::Unknown;
         ResourceFormat mNormalMapFormat = ResourceFormat::Unknown;
@@ -99,5 +108,6 @@ namespace Falcor
         uint32_t mSampleCount = 0;
         bool mEnableSuperSampling = false;
         bool mUsePreGenDepth = false;
+        bool mClusteredLighting = false;
     };
 }
\ No newline at end of file
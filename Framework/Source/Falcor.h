@@ -62,13 +62,13 @@
 #include "API/ComputeContext.h"
 #include "API/QueryHeap.h"
 
-#if defined FALCOR_D3D12 || defined FALCOR_VK
+#if defined FALCOR_D3D12 || defined FALCOR_VK || defined FALCOR_NULL
 #include "API/DescriptorSet.h"
 #include "API/LowLevel/DescriptorPool.h"
 #include "API/LowLevel/FencedPool.h"
 #include "API/LowLevel/GpuFence.h"
 #include "API/LowLevel/RootSignature.h"
-#endif //FALCOR_D3D12 || defined FALCOR_VK
+#endif //FALCOR_D3D12 || defined FALCOR_VK || defined FALCOR_NULL
 
 // Graphics
 #include "Graphics/Camera/Camera.h"
@@ -86,6 +86,7 @@
 #include "Graphics/Program/ProgramVars.h"
 #include "Graphics/Program/ProgramVersion.h"
 #include "Graphics/Program/Program.h"
+#include "Graphics/Program/ShaderCache.h"
 #include "Graphics/Program/GraphicsProgram.h"
 #include "Graphics/Program/ComputeProgram.h"
 #include "Graphics/Program/ParameterBlock.h"
@@ -120,12 +121,15 @@
 #include "Utils/Profiler.h"
 #include "Utils/StringUtils.h"
 #include "Utils/BinaryFileStream.h"
+#include "Utils/BinaryMemoryStream.h"
 #include "Utils/Video/VideoEncoder.h"
 #include "Utils/Video/VideoEncoderUI.h"
 #include "Utils/Video/VideoDecoder.h"
 #include "Utils/Platform/OS.h"
 #include "Utils/Platform/ProgressBar.h"
-#include "Utils/ThreadPool.h"
+#include "Utils/Platform/MemoryMappedFile.h"
+#include "Utils/TaskScheduler.h"
+#include "Utils/Hash.h"
 #include "Utils/PatternGenerators/DxSamplePattern.h"
 #include "Utils/PatternGenerators/HaltonSamplePattern.h"
 
@@ -222,6 +222,8 @@ namespace Falcor
 #include "API/D3D12/FalcorD3D12.h"
 #elif defined(FALCOR_VK)
 #include "API/Vulkan/FalcorVK.h"
+#elif defined(FALCOR_NULL)
+#include "API/Null/FalcorNull.h"
 #else
 #error Undefined falcor backend. Make sure that a backend is selected in "FalcorConfig.h"
 #endif
@@ -32,6 +32,11 @@
 #include "API/ConstantBuffer.h"
 #include "Utils/Gui.h"
 
+#if defined(_M_X64) || defined(__SSE2__)
+#define FALCOR_CULL_SSE
+#include <emmintrin.h>
+#endif
+
 namespace Falcor
 {
     // Default dimensions of full frame cameras and 35mm film
@@ -205,6 +210,130 @@ namespace Falcor
         return !isInside;
     }
 
+    Camera::FrustumIntersection Camera::intersectFrustum(const BoundingBox& box) const
+    {
+        calculateCameraParameters();
+
+        bool fullyInside = true;
+        for (int plane = 0; plane < 6; plane++)
+        {
+            // Test the corner furthest along the plane normal first. If it's behind the plane, so is the whole box
+            glm::vec3 signedExtent = box.extent * mFrustumPlanes[plane].sign;
+            if (glm::dot(box.center + signedExtent, mFrustumPlanes[plane].xyz) <= mFrustumPlanes[plane].negW)
+            {
+                return FrustumIntersection::Outside;
+            }
+
+            // The box is only contained if the nearest corner is in front of every plane
+            if (glm::dot(box.center - signedExtent, mFrustumPlanes[plane].xyz) <= mFrustumPlanes[plane].negW)
+            {
+                fullyInside = false;
+            }
+        }
+
+        return fullyInside ? FrustumIntersection::Inside : FrustumIntersection::Partial;
+    }
+
+    uint32_t Camera::cullBoundingBoxes(const BoundingBoxSoA& boxes, std::vector<uint32_t>& visibilityMask) const
+    {
+        calculateCameraParameters();
+
+        const uint32_t count = (uint32_t)boxes.size();
+        visibilityMask.assign((count + 31) / 32, 0);
+
+        // The SSE path handles groups of 4 boxes, the remainder goes through the scalar path
+        uint32_t scalarBegin = 0;
+        uint32_t visibleCount = 0;
+#ifdef FALCOR_CULL_SSE
+        scalarBegin = count & ~3u;
+        visibleCount += cullBoundingBoxesSSE(boxes, 0, scalarBegin, visibilityMask.data());
+#endif
+        visibleCount += cullBoundingBoxesScalar(boxes, scalarBegin, count, visibilityMask.data());
+        return visibleCount;
+    }
+
+    uint32_t Camera::cullBoundingBoxesScalar(const BoundingBoxSoA& boxes, uint32_t begin, uint32_t end, uint32_t* pVisibilityMask) const
+    {
+        // Same math as isObjectCulled(), evaluated in the same order so that the results are bit-exact
+        uint32_t visibleCount = 0;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            bool isInside = true;
+            for (int plane = 0; plane < 6; plane++)
+            {
+                const auto& p = mFrustumPlanes[plane];
+                float x = (boxes.centerX[i] + boxes.extentX[i] * p.sign.x) * p.xyz.x;
+                float y = (boxes.centerY[i] + boxes.extentY[i] * p.sign.y) * p.xyz.y;
+                float z = (boxes.centerZ[i] + boxes.extentZ[i] * p.sign.z) * p.xyz.z;
+                float dr = x + y + z;
+                isInside = isInside && (dr > p.negW);
+            }
+
+            if (isInside)
+            {
+                pVisibilityMask[i >> 5] |= 1u << (i & 31);
+                visibleCount++;
+            }
+        }
+        return visibleCount;
+    }
+
+    uint32_t Camera::cullBoundingBoxesSSE(const BoundingBoxSoA& boxes, uint32_t begin, uint32_t end, uint32_t* pVisibilityMask) const
+    {
+#ifdef FALCOR_CULL_SSE
+        assert((begin % 4) == 0 && ((end - begin) % 4) == 0);
+
+        struct
+        {
+            __m128 signX, signY, signZ;
+            __m128 x, y, z;
+            __m128 negW;
+        } planes[6];
+
+        for (int plane = 0; plane < 6; plane++)
+        {
+            const auto& p = mFrustumPlanes[plane];
+            planes[plane].signX = _mm_set1_ps(p.sign.x);
+            planes[plane].signY = _mm_set1_ps(p.sign.y);
+            planes[plane].signZ = _mm_set1_ps(p.sign.z);
+            planes[plane].x = _mm_set1_ps(p.xyz.x);
+            planes[plane].y = _mm_set1_ps(p.xyz.y);
+            planes[plane].z = _mm_set1_ps(p.xyz.z);
+            planes[plane].negW = _mm_set1_ps(p.negW);
+        }
+
+        uint32_t visibleCount = 0;
+        for (uint32_t i = begin; i < end; i += 4)
+        {
+            const __m128 centerX = _mm_loadu_ps(&boxes.centerX[i]);
+            const __m128 centerY = _mm_loadu_ps(&boxes.centerY[i]);
+            const __m128 centerZ = _mm_loadu_ps(&boxes.centerZ[i]);
+            const __m128 extentX = _mm_loadu_ps(&boxes.extentX[i]);
+            const __m128 extentY = _mm_loadu_ps(&boxes.extentY[i]);
+            const __m128 extentZ = _mm_loadu_ps(&boxes.extentZ[i]);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int plane = 0; plane < 6; plane++)
+            {
+                const auto& p = planes[plane];
+                __m128 x = _mm_mul_ps(_mm_add_ps(centerX, _mm_mul_ps(extentX, p.signX)), p.x);
+                __m128 y = _mm_mul_ps(_mm_add_ps(centerY, _mm_mul_ps(extentY, p.signY)), p.y);
+                __m128 z = _mm_mul_ps(_mm_add_ps(centerZ, _mm_mul_ps(extentZ, p.signZ)), p.z);
+                __m128 dr = _mm_add_ps(_mm_add_ps(x, y), z);
+                inside = _mm_and_ps(inside, _mm_cmpgt_ps(dr, p.negW));
+            }
+
+            uint32_t bits = (uint32_t)_mm_movemask_ps(inside);
+            pVisibilityMask[i >> 5] |= bits << (i & 31);
+            visibleCount += (bits & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1) + ((bits >> 3) & 1);
+        }
+        return visibleCount;
+#else
+        should_not_get_here();
+        return 0;
+#endif
+    }
+
     void Camera::setRightEyeMatrices(const glm::mat4& view, const glm::mat4& proj)
     {
         mData.rightEyeViewMat = view;
@@ -37,6 +37,7 @@
 namespace Falcor
 {
     struct BoundingBox;
+    struct BoundingBoxSoA;
     class ConstantBuffer;
     class Gui;
 
@@ -196,6 +197,27 @@ namespace Falcor
         */
         bool isObjectCulled(const BoundingBox& box) const;
 
+        /** Result of classifying a bounding box against the camera frustum
+        */
+        enum class FrustumIntersection
+        {
+            Outside,    ///< The box is completely outside the frustum
+            Partial,    ///< The box intersects at least one of the frustum planes
+            Inside      ///< The box is completely inside the frustum
+        };
+
+        /** Classify a bounding box against the camera frustum. Unlike isObjectCulled(), this also reports whether the box is fully contained, which allows hierarchical culling to skip testing the contents of the box.
+            \param[in] box Bounding box of the object to check
+        */
+        FrustumIntersection intersectFrustum(const BoundingBox& box) const;
+
+        /** Cull a batch of bounding boxes against the camera frustum. Uses SSE when available, the results are identical to calling isObjectCulled() for every box.
+            \param[in] boxes The boxes to check
+            \param[out] visibilityMask Will be resized to hold one bit per box. A bit is set if the box is potentially visible (i.e. not culled). Box i maps to bit (i % 32) of word (i / 32).
+            \return The number of visible boxes
+        */
+        uint32_t cullBoundingBoxes(const BoundingBoxSoA& boxes, std::vector<uint32_t>& visibilityMask) const;
+
         /** Set camera data into a program's constant buffer.
             \param[in] pBuffer The constant buffer to set the parameters into.
             \param[in] varName The name of the light variable in the program.
@@ -258,6 +280,8 @@ namespace Falcor
         std::string mName;
 
         void calculateCameraParameters() const;
+        uint32_t cullBoundingBoxesScalar(const BoundingBoxSoA& boxes, uint32_t begin, uint32_t end, uint32_t* pVisibilityMask) const;
+        uint32_t cullBoundingBoxesSSE(const BoundingBoxSoA& boxes, uint32_t begin, uint32_t end, uint32_t* pVisibilityMask) const;
         mutable CameraData mData;
         mutable glm::mat4 mViewProjMatNoJitter;
 
@@ -0,0 +1,298 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "CompressedTextureCache.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include "Utils/Hash.h"
+#include "Utils/DDSHeader.h"
+#include "Utils/Platform/OS.h"
+#include "Utils/StringUtils.h"
+
+namespace Falcor
+{
+    using namespace DdsHelper;
+
+    static const uint32_t kDdsMagicNumber = 0x20534444;     // 'DDS '
+    static const uint32_t kDx10FourCC = 0x30315844;         // 'DX10'
+    static const uint32_t kCacheMagic = 0x43435446;         // 'FTCC', stored in the reserved fields of the DDS header
+    static const uint32_t kCacheVersion = 1;                // Increment when the encoders change, so that old entries are ignored
+    static const std::string kCacheFileExtension = ".dds";
+
+    // Indices of the reserved fields of the DDS header used by the cache. 64-bit values take 2 fields, starting with the low bits
+    static const uint32_t kMagicField = 0;
+    static const uint32_t kVersionField = 1;
+    static const uint32_t kKeyField = 2;
+    static const uint32_t kDataHashField = 4;
+
+    static const struct
+    {
+        ResourceFormat format;
+        DXFormat dxFormat;
+    } kFormats[] =
+    {
+        { ResourceFormat::BC1Unorm,         FORMAT_BC1_UNORM },
+        { ResourceFormat::BC1UnormSrgb,     FORMAT_BC1_UNORM_SRGB },
+        { ResourceFormat::BC3Unorm,         FORMAT_BC3_UNORM },
+        { ResourceFormat::BC3UnormSrgb,     FORMAT_BC3_UNORM_SRGB },
+        { ResourceFormat::BC4Unorm,         FORMAT_BC4_UNORM },
+        { ResourceFormat::BC5Unorm,         FORMAT_BC5_UNORM },
+        { ResourceFormat::BC6HU16,          FORMAT_BC6H_UF16 },
+        { ResourceFormat::BC7Unorm,         FORMAT_BC7_UNORM },
+        { ResourceFormat::BC7UnormSrgb,     FORMAT_BC7_UNORM_SRGB },
+    };
+
+    static struct
+    {
+        bool enabled = true;
+        std::string directory;
+        std::mutex mutex;
+        CompressedTextureCache::Stats stats;
+    } gCache;
+
+    static bool readFileData(const std::string& path, std::vector<uint8_t>& data)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (file.is_open() == false) return false;
+        std::streamoff size = file.tellg();
+        if (size < 0) return false;
+        data.resize((size_t)size);
+        file.seekg(0, std::ios::beg);
+        if (size > 0) file.read((char*)data.data(), size);
+        return file.good() || (size == 0);
+    }
+
+    /** Parse and validate a cache file
+    */
+    static bool parseCacheFile(const std::vector<uint8_t>& fileData, uint64_t key, TextureCompressor::CompressedImage& image)
+    {
+        const size_t headerSize = sizeof(uint32_t) + sizeof(DdsHeader) + sizeof(DdsHeaderDX10);
+        if (fileData.size() < headerSize) return false;
+
+        uint32_t magic;
+        DdsHeader header;
+        DdsHeaderDX10 dx10Header;
+        std::memcpy(&magic, fileData.data(), sizeof(magic));
+        std::memcpy(&header, fileData.data() + sizeof(magic), sizeof(header));
+        std::memcpy(&dx10Header, fileData.data() + sizeof(magic) + sizeof(header), sizeof(dx10Header));
+
+        if (magic != kDdsMagicNumber || header.pixelFormat.fourCC != kDx10FourCC) return false;
+        if (header.reserved[kMagicField] != kCacheMagic || header.reserved[kVersionField] != kCacheVersion) return false;
+        if (header.reserved[kKeyField] != (uint32_t)key || header.reserved[kKeyField + 1] != (uint32_t)(key >> 32)) return false;
+        if (dx10Header.resourceDimension != RESOURCE_DIMENSION_TEXTURE2D || dx10Header.arraySize != 1) return false;
+
+        image.format = ResourceFormat::Unknown;
+        for (const auto& f : kFormats)
+        {
+            if (f.dxFormat == dx10Header.dxgiFormat) image.format = f.format;
+        }
+        if (image.format == ResourceFormat::Unknown || header.width == 0 || header.height == 0 || header.mipCount == 0) return false;
+
+        image.width = header.width;
+        image.height = header.height;
+        image.mipCount = header.mipCount;
+        size_t dataSize = 0;
+        for (uint32_t mip = 0; mip < image.mipCount; mip++) dataSize += TextureCompressor::getMipSize(image.width, image.height, image.format, mip);
+        if (dataSize != fileData.size() - headerSize) return false;
+
+        const uint8_t* pData = fileData.data() + headerSize;
+        const uint64_t dataHash = hashData(pData, dataSize);
+        if (header.reserved[kDataHashField] != (uint32_t)dataHash || header.reserved[kDataHashField + 1] != (uint32_t)(dataHash >> 32)) return false;
+
+        image.data.assign(pData, pData + dataSize);
+        return true;
+    }
+
+    void CompressedTextureCache::setEnabled(bool enabled)
+    {
+        gCache.enabled = enabled;
+    }
+
+    bool CompressedTextureCache::isEnabled()
+    {
+        return gCache.enabled;
+    }
+
+    void CompressedTextureCache::setDirectory(const std::string& directory)
+    {
+        gCache.directory = directory;
+    }
+
+    const std::string& CompressedTextureCache::getDirectory()
+    {
+        if (gCache.directory.empty())
+        {
+            gCache.directory = getExecutableDirectory() + "/TextureCache";
+        }
+        return gCache.directory;
+    }
+
+    void CompressedTextureCache::clear()
+    {
+        const std::string& dir = getDirectory();
+        std::vector<std::string> filenames;
+#ifdef _WIN32
+        enumerateFiles(dir + "/*" + kCacheFileExtension, filenames);
+#else
+        enumerateFiles(dir, filenames);
+#endif
+        for (const auto& f : filenames)
+        {
+            if (hasSuffix(f, kCacheFileExtension))
+            {
+                std::remove((dir + '/' + f).c_str());
+            }
+        }
+    }
+
+    uint64_t CompressedTextureCache::getKey(uint64_t sourceHash, TextureCompressor::Mode mode, bool isSrgb, bool generateMips)
+    {
+        const uint32_t settings[] = { kCacheVersion, (uint32_t)mode, isSrgb ? 1u : 0u, generateMips ? 1u : 0u };
+        return hashData(settings, sizeof(settings), hashData(&sourceHash, sizeof(sourceHash)));
+    }
+
+    std::string CompressedTextureCache::getEntryFilename(uint64_t key)
+    {
+        char name[17];
+        snprintf(name, arraysize(name), "%016llx", (unsigned long long)key);
+        return getDirectory() + '/' + name + kCacheFileExtension;
+    }
+
+    bool CompressedTextureCache::load(uint64_t key, TextureCompressor::CompressedImage& image)
+    {
+        if (gCache.enabled == false) return false;
+
+        std::vector<uint8_t> fileData;
+        bool found = readFileData(getEntryFilename(key), fileData);
+        bool valid = found && parseCacheFile(fileData, key, image);
+
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        if (valid)
+        {
+            gCache.stats.hits++;
+            gCache.stats.bytesLoaded += image.data.size();
+        }
+        else
+        {
+            gCache.stats.misses++;
+            if (found) gCache.stats.rejected++;
+        }
+        return valid;
+    }
+
+    bool CompressedTextureCache::store(uint64_t key, const TextureCompressor::CompressedImage& image)
+    {
+        if (gCache.enabled == false) return false;
+
+        DXFormat dxFormat = FORMAT_UNKNOWN;
+        for (const auto& f : kFormats)
+        {
+            if (f.format == image.format) dxFormat = f.dxFormat;
+        }
+        if (dxFormat == FORMAT_UNKNOWN)
+        {
+            logWarning("CompressedTextureCache::store() - unsupported format " + to_string(image.format));
+            return false;
+        }
+
+        DdsHeader header = {};
+        header.headerSize = sizeof(DdsHeader);
+        header.flags = DdsHeader::kCapsMask | DdsHeader::kHeightMask | DdsHeader::kWidthMask | DdsHeader::kPixelFormatMask | DdsHeader::kMipCountMask | DdsHeader::kLinearSizeMask;
+        header.width = image.width;
+        header.height = image.height;
+        header.linearSize = (uint32_t)TextureCompressor::getMipSize(image.width, image.height, image.format, 0);
+        header.mipCount = image.mipCount;
+        header.pixelFormat.structSize = sizeof(DdsHeader::PixelFormat);
+        header.pixelFormat.flags = DdsHeader::PixelFormat::kFourCCFlag;
+        header.pixelFormat.fourCC = kDx10FourCC;
+        header.caps[0] = DdsHeader::kCapsTextureMask | ((image.mipCount > 1) ? (DdsHeader::kCapsComplexMask | DdsHeader::kCapsMipMapMask) : 0);
+
+        const uint64_t dataHash = hashData(image.data.data(), image.data.size());
+        header.reserved[kMagicField] = kCacheMagic;
+        header.reserved[kVersionField] = kCacheVersion;
+        header.reserved[kKeyField] = (uint32_t)key;
+        header.reserved[kKeyField + 1] = (uint32_t)(key >> 32);
+        header.reserved[kDataHashField] = (uint32_t)dataHash;
+        header.reserved[kDataHashField + 1] = (uint32_t)(dataHash >> 32);
+
+        DdsHeaderDX10 dx10Header = {};
+        dx10Header.dxgiFormat = dxFormat;
+        dx10Header.resourceDimension = RESOURCE_DIMENSION_TEXTURE2D;
+        dx10Header.arraySize = 1;
+
+        const std::string& dir = getDirectory();
+        if (isDirectoryExists(dir) == false && createDirectory(dir) == false)
+        {
+            logWarning("CompressedTextureCache::store() - can't create cache directory '" + dir + "'");
+            return false;
+        }
+
+        // Write to a temporary file first, so that an interrupted write never leaves a partial entry behind
+        std::string filename = getEntryFilename(key);
+        std::string tempFilename = filename + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+            if (file.is_open() == false) return false;
+            file.write((const char*)&kDdsMagicNumber, sizeof(kDdsMagicNumber));
+            file.write((const char*)&header, sizeof(header));
+            file.write((const char*)&dx10Header, sizeof(dx10Header));
+            file.write((const char*)image.data.data(), image.data.size());
+            if (file.good() == false)
+            {
+                file.close();
+                std::remove(tempFilename.c_str());
+                return false;
+            }
+        }
+
+        std::remove(filename.c_str());
+        if (std::rename(tempFilename.c_str(), filename.c_str()) != 0)
+        {
+            std::remove(tempFilename.c_str());
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.stats.stores++;
+        return true;
+    }
+
+    CompressedTextureCache::Stats CompressedTextureCache::getStats()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        return gCache.stats;
+    }
+
+    void CompressedTextureCache::resetStats()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.stats = Stats();
+    }
+}
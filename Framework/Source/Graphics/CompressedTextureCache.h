@@ -0,0 +1,106 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include "Graphics/TextureCompressor.h"
+
+namespace Falcor
+{
+    /** Disk cache for block-compressed textures, so that images are only encoded once.
+        Entries are addressed by a key which should hash the source image together with everything that affects the encoding (see getKey()). Entries are stored as regular DDS files with a DX10 header,
+        so they can be inspected with any DDS viewer. The key and a hash of the data are stored in the reserved fields of the header and are validated when loading.
+    */
+    class CompressedTextureCache
+    {
+    public:
+        /** Cache statistics
+        */
+        struct Stats
+        {
+            uint64_t hits = 0;          ///< Number of loads which found a valid entry
+            uint64_t misses = 0;        ///< Number of loads which didn't find a valid entry, including rejected entries
+            uint64_t rejected = 0;      ///< Number of entries which were found but failed validation
+            uint64_t stores = 0;        ///< Number of entries written to disk
+            uint64_t bytesLoaded = 0;   ///< Total size of the compressed data loaded from the cache
+        };
+
+        /** Enable or disable the cache. The cache is enabled by default
+        */
+        static void setEnabled(bool enabled);
+
+        /** Check if the cache is enabled
+        */
+        static bool isEnabled();
+
+        /** Set the directory the cache files are stored in. By default, the cache is stored in a `TextureCache` folder next to the executable
+        */
+        static void setDirectory(const std::string& directory);
+
+        /** Get the directory the cache files are stored in
+        */
+        static const std::string& getDirectory();
+
+        /** Delete all the files stored in the cache directory
+        */
+        static void clear();
+
+        /** Create the key of an entry
+            \param[in] sourceHash Hash of the source image, e.g. hashFile() of the image file
+            \param[in] mode The compression mode
+            \param[in] isSrgb Whether the image is loaded as sRGB
+            \param[in] generateMips Whether the entry holds the full mip chain
+        */
+        static uint64_t getKey(uint64_t sourceHash, TextureCompressor::Mode mode, bool isSrgb, bool generateMips);
+
+        /** Look for an entry in the cache
+            \param[in] key The key of the entry
+            \param[out] image On success, the compressed image
+            \return true if a valid entry was found, otherwise false
+        */
+        static bool load(uint64_t key, TextureCompressor::CompressedImage& image);
+
+        /** Store an entry in the cache. If an entry with the same key exists it will be replaced
+            \param[in] key The key of the entry
+            \param[in] image The compressed image
+            \return true if the entry was written to disk, otherwise false
+        */
+        static bool store(uint64_t key, const TextureCompressor::CompressedImage& image);
+
+        /** Get the cache statistics
+        */
+        static Stats getStats();
+
+        /** Reset the cache statistics
+        */
+        static void resetStats();
+
+        /** Get the file used to store an entry
+        */
+        static std::string getEntryFilename(uint64_t key);
+    };
+}
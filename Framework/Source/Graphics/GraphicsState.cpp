@@ -61,8 +61,6 @@ namespace Falcor
         {
             setViewport(i, mViewports[i], true);
         }
-
-        mpGsoGraph = StateGraph::create();
     }
 
     GraphicsState::~GraphicsState() = default;
@@ -75,11 +73,10 @@ namespace Falcor
             mpVao->getVertexLayout()->addVertexAttribDclToProg(mpProgram.get());
         }
         const ProgramVersion::SharedConstPtr pProgVersion = mpProgram ? mpProgram->getActiveVersion() : nullptr;
-        bool newProgVersion = pProgVersion.get() != mCachedData.pProgramVersion;
-        if (newProgVersion)
+        if (pProgVersion.get() != mCachedData.pProgramVersion)
         {
             mCachedData.pProgramVersion = pProgVersion.get();
-            mpGsoGraph->walk((void*)pProgVersion.get());
+            mpGso = nullptr;
         }
     
         RootSignature::SharedPtr pRoot = pVars ? pVars->getRootSignature() : RootSignature::getEmpty();
@@ -87,18 +84,17 @@ namespace Falcor
         if (mCachedData.pRootSig != pRoot.get())
         {
             mCachedData.pRootSig = pRoot.get();
-            mpGsoGraph->walk((void*)mCachedData.pRootSig);
+            mpGso = nullptr;
         }
 
         const Fbo::Desc* pFboDesc = mpFbo ? &mpFbo->getDesc() : nullptr;
         if(mCachedData.pFboDesc != pFboDesc)
         {
-            mpGsoGraph->walk((void*)pFboDesc);
             mCachedData.pFboDesc = pFboDesc;
+            mpGso = nullptr;
         }
 
-        GraphicsStateObject::SharedPtr pGso = mpGsoGraph->getCurrentNode();
-        if(pGso == nullptr)
+        if(mpGso == nullptr)
         {
             mDesc.setProgramVersion(pProgVersion);
             mDesc.setFboFormats(mpFbo ? mpFbo->getDesc() : Fbo::Desc());
@@ -110,23 +106,10 @@ namespace Falcor
             mDesc.setRootSignature(pRoot);
 
             mDesc.setSinglePassStereoEnable(mEnableSinglePassStereo);
-            
-            StateGraph::CompareFunc cmpFunc = [&desc = mDesc](GraphicsStateObject::SharedPtr pGso) -> bool
-            {
-                return pGso && (desc == pGso->getDesc());
-            };
 
-            if (mpGsoGraph->scanForMatchingNode(cmpFunc))
-            {
-                pGso = mpGsoGraph->getCurrentNode();
-            }
-            else
-            {
-                pGso = GraphicsStateObject::create(mDesc);
-                mpGsoGraph->setCurrentNodeData(pGso);
-            }
+            mpGso = gpDevice->getGraphicsStateObjectCache()->getObject(mDesc);
         }
-        return pGso;
+        return mpGso;
     }
 
     GraphicsState& GraphicsState::setFbo(const Fbo::SharedPtr& pFbo, bool setVp0Sc0)
@@ -166,11 +149,14 @@ namespace Falcor
         {
             mpVao = pVao;
 
+            // Meshes usually share their vertex layout, so only a different layout or topology requires a different state object
+            if (pVao == nullptr || mDesc.getVertexLayout() != pVao->getVertexLayout() || mDesc.getPrimitiveType() != topology2Type(pVao->getPrimitiveTopology()))
+            {
+                mpGso = nullptr;
+            }
 #ifdef FALCOR_VK
             mDesc.setVao(pVao);
 #endif
-
-            mpGsoGraph->walk(pVao ? (void*)pVao->getVertexLayout().get() : nullptr);
         }
         return *this;
     }
@@ -180,7 +166,7 @@ namespace Falcor
         if(mDesc.getBlendState() != pBlendState)
         {
             mDesc.setBlendState(pBlendState);
-            mpGsoGraph->walk((void*)pBlendState.get());
+            mpGso = nullptr;
         }
         return *this;
     }
@@ -190,7 +176,7 @@ namespace Falcor
         if(mDesc.getRasterizerState() != pRasterizerState)
         {
             mDesc.setRasterizerState(pRasterizerState);
-            mpGsoGraph->walk((void*)pRasterizerState.get());
+            mpGso = nullptr;
         }
         return *this;
     }
@@ -200,7 +186,7 @@ namespace Falcor
         if(mDesc.getSampleMask() != sampleMask)
         {
             mDesc.setSampleMask(sampleMask);
-            mpGsoGraph->walk((void*)(uint64_t)sampleMask);
+            mpGso = nullptr;
         }
         return *this; 
     }
@@ -210,7 +196,7 @@ namespace Falcor
         if(mDesc.getDepthStencilState() != pDepthStencilState)
         {
             mDesc.setDepthStencilState(pDepthStencilState);
-            mpGsoGraph->walk((void*)pDepthStencilState.get());
+            mpGso = nullptr;
         }
         return *this;
     }
@@ -274,8 +260,11 @@ namespace Falcor
     void GraphicsState::toggleSinglePassStereo(bool enable)
     {
 #if _ENABLE_NVAPI
-        mEnableSinglePassStereo = enable;
-        mpGsoGraph->walk((void*)enable);
+        if (mEnableSinglePassStereo != enable)
+        {
+            mEnableSinglePassStereo = enable;
+            mpGso = nullptr;
+        }
 #else
         if (enable)
         {
@@ -34,7 +34,6 @@
 #include "API/DepthStencilState.h"
 #include "API/BlendState.h"
 #include <stack>
-#include "Utils/Graph.h"
 
 namespace Falcor
 {
@@ -222,7 +221,7 @@ namespace Falcor
         */
         uint32_t getSampleMask() const { return mDesc.getSampleMask(); }
 
-        /** Get the active graphics state object.
+        /** Get the active graphics state object. State objects are shared between all the GraphicsState objects through the device's GraphicsStateObjectCache
         */
         virtual GraphicsStateObject::SharedPtr getGSO(const GraphicsVars* pVars);
 
@@ -263,7 +262,7 @@ namespace Falcor
         };
         CachedData mCachedData;
 
-        using StateGraph = Graph<GraphicsStateObject::SharedPtr, void*>;
-        StateGraph::SharedPtr mpGsoGraph;
+        // The state object matching the current state. Reset whenever the state changes
+        GraphicsStateObject::SharedPtr mpGso;
     };
 }
@@ -253,6 +253,7 @@ namespace Falcor
             {
                 setPenumbraAngle(mData.penumbraAngle);
             }
+            pGui->addFloatVar("Range", mData.range, 0.f, FLT_MAX);
             Light::renderUI(pGui);
 
             if (group)
@@ -234,6 +234,15 @@ namespace Falcor
         */
         float getOpeningAngle() const { return mData.openingAngle; }
 
+        /** Set the light's range. The light's contribution is smoothly windowed to zero at this distance, which allows clustered lighting to skip the light beyond it.
+            \param[in] range The range in world units, or 0 for an unbounded light
+        */
+        void setRange(float range) { mData.range = glm::max(range, 0.0f); }
+
+        /** Get the light's range. 0 means the light is unbounded
+        */
+        float getRange() const { return mData.range; }
+
         /** IMovableObject interface
         */
         void move(const glm::vec3& position, const glm::vec3& target, const glm::vec3& up) override;
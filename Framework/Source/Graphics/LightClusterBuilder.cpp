@@ -0,0 +1,282 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "LightClusterBuilder.h"
+#include "Graphics/Camera/Camera.h"
+#include "Utils/TaskScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Computes the view-space position of a point given in NDC XY and view depth. Supports any projection whose X and Y only depend on the matching view coordinate and Z, which includes jittered perspective and orthographic projections
+        glm::vec3 ndcToView(const glm::mat4& proj, float ndcX, float ndcY, float depth)
+        {
+            float z = -depth;
+            float w = proj[2][3] * z + proj[3][3];
+            float x = (ndcX * w - proj[2][0] * z - proj[3][0]) / proj[0][0];
+            float y = (ndcY * w - proj[2][1] * z - proj[3][1]) / proj[1][1];
+            return glm::vec3(x, y, z);
+        }
+
+        uint32_t ndcToTile(float ndc, uint32_t tileCount)
+        {
+            float t = (ndc * 0.5f + 0.5f) * float(tileCount);
+            return (uint32_t)glm::clamp(t, 0.0f, float(tileCount - 1));
+        }
+
+        bool sphereIntersectsBox(const glm::vec3& center, float radius, const glm::vec3& minBound, const glm::vec3& maxBound)
+        {
+            glm::vec3 d = center - glm::clamp(center, minBound, maxBound);
+            return glm::dot(d, d) <= radius * radius;
+        }
+    }
+
+    LightClusterBuilder::SharedPtr LightClusterBuilder::create(const Desc& desc)
+    {
+        if (desc.mTileCountX == 0 || desc.mTileCountY == 0 || desc.mSliceCount == 0)
+        {
+            logError("LightClusterBuilder::create() - the cluster grid can't be empty");
+            return nullptr;
+        }
+        return SharedPtr(new LightClusterBuilder(desc));
+    }
+
+    LightClusterBuilder::LightClusterBuilder(const Desc& desc) : mDesc(desc)
+    {
+        mClusterBounds.resize(getClusterCount());
+        mClusters.resize(getClusterCount());
+        mSliceCandidates.resize(mDesc.mSliceCount);
+        mSliceIndices.resize(mDesc.mSliceCount);
+    }
+
+    uint32_t LightClusterBuilder::getSlice(float depth) const
+    {
+        if (depth <= mNearZ) return 0;
+        float slice = std::log2(depth) * mDepthScale + mDepthBias;
+        return (uint32_t)glm::clamp(slice, 0.0f, float(mDesc.mSliceCount - 1));
+    }
+
+    float LightClusterBuilder::getSliceDepth(uint32_t slice) const
+    {
+        if (slice >= mDesc.mSliceCount) return mFarZ;
+        return mNearZ * std::pow(mFarZ / mNearZ, float(slice) / float(mDesc.mSliceCount));
+    }
+
+    void LightClusterBuilder::computeClusterBounds()
+    {
+        const glm::vec2 tileSize = glm::vec2(2.0f / float(mDesc.mTileCountX), 2.0f / float(mDesc.mTileCountY));
+        for (uint32_t k = 0; k < mDesc.mSliceCount; k++)
+        {
+            const float depths[2] = { getSliceDepth(k), getSliceDepth(k + 1) };
+            for (uint32_t y = 0; y < mDesc.mTileCountY; y++)
+            {
+                for (uint32_t x = 0; x < mDesc.mTileCountX; x++)
+                {
+                    ClusterBounds& bounds = mClusterBounds[getClusterIndex(x, y, k)];
+                    bounds.minBound = glm::vec3(std::numeric_limits<float>::max());
+                    bounds.maxBound = glm::vec3(-std::numeric_limits<float>::max());
+                    for (uint32_t corner = 0; corner < 8; corner++)
+                    {
+                        float ndcX = -1.0f + float(x + (corner & 1)) * tileSize.x;
+                        float ndcY = -1.0f + float(y + ((corner >> 1) & 1)) * tileSize.y;
+                        glm::vec3 p = ndcToView(mProjMat, ndcX, ndcY, depths[corner >> 2]);
+                        bounds.minBound = glm::min(bounds.minBound, p);
+                        bounds.maxBound = glm::max(bounds.maxBound, p);
+                    }
+                }
+            }
+        }
+    }
+
+    bool LightClusterBuilder::prepareLight(const LightBounds& light, uint32_t index, ViewLight& viewLight) const
+    {
+        viewLight.center = glm::vec3(mViewMat * glm::vec4(light.center, 1.0f));
+        viewLight.radius = light.radius;
+        viewLight.index = index;
+
+        float depth = -viewLight.center.z;
+        if (depth + light.radius < mNearZ || depth - light.radius > mFarZ) return false;
+        viewLight.sliceMin = getSlice(depth - light.radius);
+        viewLight.sliceMax = getSlice(depth + light.radius);
+
+        // Project the corners of the sphere's bounding box to find the tiles it covers. If the box crosses the camera plane, the projection is unbounded
+        glm::vec2 ndcMin = glm::vec2(std::numeric_limits<float>::max());
+        glm::vec2 ndcMax = glm::vec2(-std::numeric_limits<float>::max());
+        bool crossesCameraPlane = false;
+        for (uint32_t corner = 0; corner < 8 && !crossesCameraPlane; corner++)
+        {
+            glm::vec3 offset = glm::vec3((corner & 1) ? 1 : -1, (corner & 2) ? 1 : -1, (corner & 4) ? 1 : -1) * light.radius;
+            glm::vec4 clip = mProjMat * glm::vec4(viewLight.center + offset, 1.0f);
+            if (clip.w <= 0)
+            {
+                crossesCameraPlane = true;
+            }
+            else
+            {
+                glm::vec2 ndc = glm::vec2(clip) / clip.w;
+                ndcMin = glm::min(ndcMin, ndc);
+                ndcMax = glm::max(ndcMax, ndc);
+            }
+        }
+
+        if (crossesCameraPlane)
+        {
+            viewLight.tileMin = glm::uvec2(0);
+            viewLight.tileMax = glm::uvec2(mDesc.mTileCountX - 1, mDesc.mTileCountY - 1);
+            return true;
+        }
+
+        if (ndcMax.x < -1 || ndcMin.x > 1 || ndcMax.y < -1 || ndcMin.y > 1) return false;
+        viewLight.tileMin = glm::uvec2(ndcToTile(ndcMin.x, mDesc.mTileCountX), ndcToTile(ndcMin.y, mDesc.mTileCountY));
+        viewLight.tileMax = glm::uvec2(ndcToTile(ndcMax.x, mDesc.mTileCountX), ndcToTile(ndcMax.y, mDesc.mTileCountY));
+        return true;
+    }
+
+    void LightClusterBuilder::binSlice(uint32_t slice)
+    {
+        auto& candidates = mSliceCandidates[slice];
+        candidates.clear();
+        for (uint32_t i = 0; i < (uint32_t)mViewLights.size(); i++)
+        {
+            const ViewLight& light = mViewLights[i];
+            if (slice >= light.sliceMin && slice <= light.sliceMax) candidates.push_back(i);
+        }
+
+        // The offsets are relative to the start of the slice's list until build() concatenates the slices
+        auto& indices = mSliceIndices[slice];
+        indices.clear();
+        for (uint32_t y = 0; y < mDesc.mTileCountY; y++)
+        {
+            for (uint32_t x = 0; x < mDesc.mTileCountX; x++)
+            {
+                uint32_t cluster = getClusterIndex(x, y, slice);
+                const ClusterBounds& bounds = mClusterBounds[cluster];
+                uint32_t offset = (uint32_t)indices.size();
+                for (uint32_t i : candidates)
+                {
+                    const ViewLight& light = mViewLights[i];
+                    if (x < light.tileMin.x || x > light.tileMax.x || y < light.tileMin.y || y > light.tileMax.y) continue;
+                    if (sphereIntersectsBox(light.center, light.radius, bounds.minBound, bounds.maxBound))
+                    {
+                        indices.push_back(light.index);
+                    }
+                }
+                mClusters[cluster] = glm::uvec2(offset, (uint32_t)indices.size() - offset);
+            }
+        }
+    }
+
+    void LightClusterBuilder::build(const glm::mat4& viewMat, const glm::mat4& projMat, float nearZ, float farZ, const std::vector<LightBounds>& lights, TaskScheduler* pScheduler)
+    {
+        assert(nearZ > 0 && farZ > nearZ);
+        mViewMat = viewMat;
+        mProjMat = projMat;
+        mViewProjMat = projMat * viewMat;
+        mNearZ = nearZ;
+        mFarZ = farZ;
+        mDepthScale = float(mDesc.mSliceCount) / std::log2(farZ / nearZ);
+        mDepthBias = -std::log2(nearZ) * mDepthScale;
+        computeClusterBounds();
+
+        mStats = Stats();
+        mStats.lightCount = (uint32_t)lights.size();
+
+        // Global lights go first in the index list
+        mLightIndices.clear();
+        mViewLights.clear();
+        for (uint32_t i = 0; i < (uint32_t)lights.size(); i++)
+        {
+            if (lights[i].radius <= 0)
+            {
+                mLightIndices.push_back(i);
+                continue;
+            }
+
+            ViewLight viewLight;
+            if (prepareLight(lights[i], i, viewLight))
+            {
+                mViewLights.push_back(viewLight);
+            }
+            else
+            {
+                mStats.culledLightCount++;
+            }
+        }
+        mGlobalLightCount = (uint32_t)mLightIndices.size();
+
+        // Slices write to disjoint clusters and lists, so they can be binned in parallel
+        if (pScheduler)
+        {
+            pScheduler->parallelFor(0, mDesc.mSliceCount, [this](uint32_t slice) { binSlice(slice); }, 1);
+        }
+        else
+        {
+            for (uint32_t slice = 0; slice < mDesc.mSliceCount; slice++) binSlice(slice);
+        }
+
+        // Concatenate the slices' lists
+        const uint32_t clustersPerSlice = mDesc.mTileCountX * mDesc.mTileCountY;
+        for (uint32_t slice = 0; slice < mDesc.mSliceCount; slice++)
+        {
+            uint32_t base = (uint32_t)mLightIndices.size();
+            for (uint32_t c = slice * clustersPerSlice; c < (slice + 1) * clustersPerSlice; c++)
+            {
+                mClusters[c].x += base;
+                if (mClusters[c].y > 0) mStats.nonEmptyClusterCount++;
+                mStats.maxLightsPerCluster = std::max(mStats.maxLightsPerCluster, mClusters[c].y);
+            }
+            mLightIndices.insert(mLightIndices.end(), mSliceIndices[slice].begin(), mSliceIndices[slice].end());
+        }
+        mStats.indexCount = (uint32_t)mLightIndices.size();
+    }
+
+    void LightClusterBuilder::build(const Camera* pCamera, const std::vector<LightBounds>& lights, TaskScheduler* pScheduler)
+    {
+        build(pCamera->getViewMatrix(), pCamera->getProjMatrix(), pCamera->getNearPlane(), pCamera->getFarPlane(), lights, pScheduler);
+    }
+
+    uint32_t LightClusterBuilder::findCluster(const glm::vec3& posW) const
+    {
+        glm::vec4 clip = mViewProjMat * glm::vec4(posW, 1.0f);
+        float depth = -(mViewMat * glm::vec4(posW, 1.0f)).z;
+        if (clip.w <= 0 || depth < mNearZ || depth > mFarZ) return uint32_t(-1);
+
+        glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        if (std::abs(ndc.x) > 1 || std::abs(ndc.y) > 1) return uint32_t(-1);
+        return getClusterIndex(ndcToTile(ndc.x, mDesc.mTileCountX), ndcToTile(ndc.y, mDesc.mTileCountY), getSlice(depth));
+    }
+
+    void LightClusterBuilder::getClusterBounds(uint32_t cluster, glm::vec3& minBound, glm::vec3& maxBound) const
+    {
+        minBound = mClusterBounds[cluster].minBound;
+        maxBound = mClusterBounds[cluster].maxBound;
+    }
+}
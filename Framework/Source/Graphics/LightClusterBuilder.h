@@ -0,0 +1,188 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
+
+namespace Falcor
+{
+    class Camera;
+    class TaskScheduler;
+
+    /** Bins lights into a grid of view-frustum clusters (froxels), so that shaders only evaluate the lights which can reach a pixel.
+        The grid divides the screen into tiles, and the depth range between the camera's near and far planes into exponentially distributed slices.
+        Lights without a bounded range are global and affect every cluster.
+        The builder doesn't touch any GPU resources. SceneRenderer uploads its output into the buffers declared in Lights.slang.
+    */
+    class LightClusterBuilder
+    {
+    public:
+        using SharedPtr = std::shared_ptr<LightClusterBuilder>;
+
+        /** Grid configuration
+        */
+        class Desc
+        {
+        public:
+            Desc& setTileCount(uint32_t x, uint32_t y) { mTileCountX = x; mTileCountY = y; return *this; }
+            Desc& setSliceCount(uint32_t count) { mSliceCount = count; return *this; }
+        private:
+            friend class LightClusterBuilder;
+            uint32_t mTileCountX = 16;
+            uint32_t mTileCountY = 9;
+            uint32_t mSliceCount = 24;
+        };
+
+        /** The bounding sphere of a light, in world space
+        */
+        struct LightBounds
+        {
+            glm::vec3 center;
+            float radius = 0;       ///< 0 or less means the light is unbounded
+        };
+
+        /** Statistics of the last build
+        */
+        struct Stats
+        {
+            uint32_t lightCount = 0;            ///< Number of lights passed to build()
+            uint32_t culledLightCount = 0;      ///< Number of bounded lights outside the view frustum
+            uint32_t nonEmptyClusterCount = 0;
+            uint32_t maxLightsPerCluster = 0;   ///< Not including the global lights
+            uint32_t indexCount = 0;            ///< Size of the light index list, including the global lights
+        };
+
+        /** Create a builder
+        */
+        static SharedPtr create(const Desc& desc = Desc());
+
+        /** Bin lights into clusters
+            \param[in] viewMat The camera's view matrix
+            \param[in] projMat The camera's projection matrix. Perspective and orthographic projections are supported, including jitter
+            \param[in] nearZ Distance to the near plane
+            \param[in] farZ Distance to the far plane
+            \param[in] lights The lights' bounds. The light indices in the output refer to this list
+            \param[in] pScheduler Scheduler to bin the depth slices in parallel, or nullptr to build on the calling thread
+        */
+        void build(const glm::mat4& viewMat, const glm::mat4& projMat, float nearZ, float farZ, const std::vector<LightBounds>& lights, TaskScheduler* pScheduler = nullptr);
+
+        /** Bin lights into the clusters of a camera's view frustum. See the other overload
+        */
+        void build(const Camera* pCamera, const std::vector<LightBounds>& lights, TaskScheduler* pScheduler = nullptr);
+
+        /** Get the grid dimensions, in tiles along X and Y, and slices along Z
+        */
+        glm::uvec3 getDims() const { return glm::uvec3(mDesc.mTileCountX, mDesc.mTileCountY, mDesc.mSliceCount); }
+
+        /** Get the number of clusters
+        */
+        uint32_t getClusterCount() const { return mDesc.mTileCountX * mDesc.mTileCountY * mDesc.mSliceCount; }
+
+        /** Get a cluster's index from its grid coordinates
+        */
+        uint32_t getClusterIndex(uint32_t x, uint32_t y, uint32_t slice) const { return (slice * mDesc.mTileCountY + y) * mDesc.mTileCountX + x; }
+
+        /** Get the light index list. The global lights come first, followed by the lights of each cluster
+        */
+        const std::vector<uint32_t>& getLightIndices() const { return mLightIndices; }
+
+        /** Get the number of global lights, at the start of the light index list
+        */
+        uint32_t getGlobalLightCount() const { return mGlobalLightCount; }
+
+        /** Get the clusters. Each entry is the offset of the cluster's lights in the light index list, and their count
+        */
+        const std::vector<glm::uvec2>& getClusters() const { return mClusters; }
+
+        /** Get the scale and bias which map log2(view depth) to a slice
+        */
+        float getDepthScale() const { return mDepthScale; }
+        float getDepthBias() const { return mDepthBias; }
+
+        /** Find the cluster containing a world-space position, the same way the shaders do
+            \return The cluster's index, or uint32_t(-1) if the position is outside the grid
+        */
+        uint32_t findCluster(const glm::vec3& posW) const;
+
+        /** Get the view-space bounds of a cluster, as computed by the last build()
+        */
+        void getClusterBounds(uint32_t cluster, glm::vec3& minBound, glm::vec3& maxBound) const;
+
+        /** Get the statistics of the last build
+        */
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        LightClusterBuilder(const Desc& desc);
+
+        struct ViewLight
+        {
+            glm::vec3 center;           // View space
+            float radius;
+            uint32_t index;             // Index in the list passed to build()
+            glm::uvec2 tileMin;
+            glm::uvec2 tileMax;
+            uint32_t sliceMin;
+            uint32_t sliceMax;
+        };
+
+        struct ClusterBounds
+        {
+            glm::vec3 minBound;
+            glm::vec3 maxBound;
+        };
+
+        uint32_t getSlice(float depth) const;
+        float getSliceDepth(uint32_t slice) const;
+        void computeClusterBounds();
+        bool prepareLight(const LightBounds& light, uint32_t index, ViewLight& viewLight) const;
+        void binSlice(uint32_t slice);
+
+        Desc mDesc;
+        glm::mat4 mViewMat;
+        glm::mat4 mProjMat;
+        glm::mat4 mViewProjMat;
+        float mNearZ = 0;
+        float mFarZ = 0;
+        float mDepthScale = 0;
+        float mDepthBias = 0;
+
+        std::vector<ClusterBounds> mClusterBounds;
+        std::vector<ViewLight> mViewLights;
+        std::vector<std::vector<uint32_t>> mSliceCandidates;    // Per slice, the lights in mViewLights overlapping the slice
+        std::vector<std::vector<uint32_t>> mSliceIndices;       // Per slice, the light indices of the slice's clusters
+        std::vector<glm::uvec2> mClusters;
+        std::vector<uint32_t> mLightIndices;
+        uint32_t mGlobalLightCount = 0;
+        Stats mStats;
+    };
+}
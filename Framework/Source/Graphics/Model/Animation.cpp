@@ -28,122 +28,447 @@
 #include "Framework.h"
 #include "Animation.h"
 #include "AnimationController.h"
-#include "glm/gtc/matrix_transform.hpp"
-#include "glm/gtx/transform.hpp"
+#include <algorithm>
+#include <cfloat>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define FALCOR_ANIMATION_SSE
+#include <emmintrin.h>
+#endif
 
 namespace Falcor
 {
-    Animation::UniquePtr Animation::create(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond)
+    namespace
     {
-        return UniquePtr(new Animation(name, animationSets, duration, ticksPerSecond));
+        void storeValue(const glm::vec3& v, float* pDst)
+        {
+            pDst[0] = v.x;
+            pDst[1] = v.y;
+            pDst[2] = v.z;
+        }
+
+        void storeValue(const glm::quat& q, float* pDst)
+        {
+            pDst[0] = q.x;
+            pDst[1] = q.y;
+            pDst[2] = q.z;
+            pDst[3] = q.w;
+        }
+
+        glm::vec3 interpolateKey(const glm::vec3& start, const glm::vec3& end, float ratio) { return glm::mix(start, end, ratio); }
+        glm::quat interpolateKey(const glm::quat& start, const glm::quat& end, float ratio) { return glm::slerp(start, end, ratio); }
+
+        float keyError(const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); }
+        float keyError(const glm::quat& a, const glm::quat& b) { return 2 * acosf(std::min(1.0f, std::abs(glm::dot(glm::normalize(a), glm::normalize(b))))); }
+
+        /** Remove the keys which the remaining keys interpolate within the tolerance. A channel which is constant within the tolerance is reduced to a single key
+        */
+        template<typename T>
+        std::vector<Animation::AnimationKey<T>> reduceKeys(const std::vector<Animation::AnimationKey<T>>& keys, float tolerance)
+        {
+            if (tolerance <= 0 || keys.size() <= 1) return keys;
+
+            bool constant = true;
+            for (size_t k = 1; k < keys.size() && constant; k++) constant = keyError(keys[k].value, keys[0].value) <= tolerance;
+            if (constant) return { keys[0] };
+
+            // Greedily extend the segment starting at the last kept key for as long as it reproduces all the skipped keys
+            std::vector<Animation::AnimationKey<T>> kept = { keys[0] };
+            size_t anchor = 0;
+            for (size_t k = 1; k + 1 < keys.size(); k++)
+            {
+                const auto& start = keys[anchor];
+                const auto& end = keys[k + 1];
+                const float span = end.time - start.time;
+                bool removable = span > 0;
+                for (size_t j = anchor + 1; j <= k && removable; j++)
+                {
+                    T value = interpolateKey(start.value, end.value, (keys[j].time - start.time) / span);
+                    removable = keyError(value, keys[j].value) <= tolerance;
+                }
+
+                if (removable == false)
+                {
+                    kept.push_back(keys[k]);
+                    anchor = k;
+                }
+            }
+            kept.push_back(keys.back());
+            return kept;
+        }
+
+        template<typename Track, uint32_t kComponents>
+        void dequantizeKey(const Track& track, uint32_t bone, uint32_t key, float(&dst)[kComponents])
+        {
+            for (uint32_t c = 0; c < kComponents; c++)
+            {
+                dst[c] = track.rangeMin[bone * kComponents + c] + track.rangeScale[bone * kComponents + c] * track.quantizedValues[key * kComponents + c];
+            }
+        }
+
+        template<typename T>
+        size_t vectorSize(const std::vector<T>& v) { return v.size() * sizeof(T); }
+
+        /** Find the last key with time <= ticks. Playback usually advances by less than a key per frame, so scan forward from the previous key and fall back to a binary search after a jump
+        */
+        uint32_t findCurrentKey(const float* pTimes, uint32_t count, uint32_t cursor, float ticks)
+        {
+            if (cursor >= count || pTimes[cursor] > ticks) cursor = 0;
+            for (uint32_t step = 0; step < 4; step++)
+            {
+                if (cursor + 1 >= count || pTimes[cursor + 1] > ticks) return cursor;
+                cursor++;
+            }
+            const float* pNext = std::upper_bound(pTimes + cursor, pTimes + count, ticks);
+            return uint32_t(pNext - pTimes) - 1;
+        }
+
+        /** Ratio correction that makes normalized lerp closely match slerp. From 'Approximating slerp' by Arseny Kapoulkine
+            \param[in] t The interpolation ratio
+            \param[in] d The absolute value of the cosine of the angle between the quaternions
+        */
+        float correctSlerpRatio(float t, float d)
+        {
+            float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+            float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+            float k = a * (t - 0.5f) * (t - 0.5f) + b;
+            return t + t * (t - 0.5f) * (t - 1) * k;
+        }
+
+        /** Linear interpolation of a lane. count must be a multiple of 4
+        */
+        void lerpLanes(const float* pStart, const float* pEnd, const float* pRatio, float* pResult, uint32_t count)
+        {
+#ifdef FALCOR_ANIMATION_SSE
+            for (uint32_t i = 0; i < count; i += 4)
+            {
+                __m128 a = _mm_loadu_ps(pStart + i);
+                __m128 b = _mm_loadu_ps(pEnd + i);
+                __m128 t = _mm_loadu_ps(pRatio + i);
+                _mm_storeu_ps(pResult + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
+            }
+#else
+            for (uint32_t i = 0; i < count; i++)
+            {
+                pResult[i] = pStart[i] + (pEnd[i] - pStart[i]) * pRatio[i];
+            }
+#endif
+        }
+
+        /** Shortest-path quaternion interpolation of 4 lanes (x, y, z, w). count must be a multiple of 4
+        */
+        void slerpLanes(const std::vector<float>* pStart, const std::vector<float>* pEnd, const float* pRatio, std::vector<float>* pResult, uint32_t count)
+        {
+#ifdef FALCOR_ANIMATION_SSE
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 signBit = _mm_set1_ps(-0.0f);
+            for (uint32_t i = 0; i < count; i += 4)
+            {
+                __m128 a[4], b[4];
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    a[c] = _mm_loadu_ps(pStart[c].data() + i);
+                    b[c] = _mm_loadu_ps(pEnd[c].data() + i);
+                }
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3])));
+
+                // Take the shortest path by flipping the end quaternion when the dot product is negative
+                __m128 sign = _mm_and_ps(d, signBit);
+                d = _mm_xor_ps(d, sign);
+
+                // correctSlerpRatio()
+                __m128 t = _mm_loadu_ps(pRatio + i);
+                __m128 ka = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+                __m128 kb = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+                __m128 tHalf = _mm_sub_ps(t, half);
+                __m128 k = _mm_add_ps(_mm_mul_ps(ka, _mm_mul_ps(tHalf, tHalf)), kb);
+                t = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(t, tHalf), _mm_mul_ps(_mm_sub_ps(t, one), k)));
+
+                __m128 s = _mm_sub_ps(one, t);
+                __m128 tb = _mm_xor_ps(t, sign);
+                __m128 q[4];
+                __m128 lengthSq = _mm_setzero_ps();
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    q[c] = _mm_add_ps(_mm_mul_ps(a[c], s), _mm_mul_ps(b[c], tb));
+                    lengthSq = _mm_add_ps(lengthSq, _mm_mul_ps(q[c], q[c]));
+                }
+                __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    _mm_storeu_ps(pResult[c].data() + i, _mm_mul_ps(q[c], invLength));
+                }
+            }
+#else
+            for (uint32_t i = 0; i < count; i++)
+            {
+                float d = 0;
+                for (uint32_t c = 0; c < 4; c++) d += pStart[c][i] * pEnd[c][i];
+                float sign = d < 0 ? -1.0f : 1.0f;
+                float t = correctSlerpRatio(pRatio[i], d * sign);
+
+                float q[4];
+                float lengthSq = 0;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    q[c] = pStart[c][i] * (1 - t) + pEnd[c][i] * t * sign;
+                    lengthSq += q[c] * q[c];
+                }
+                float invLength = 1.0f / sqrtf(lengthSq);
+                for (uint32_t c = 0; c < 4; c++) pResult[c][i] = q[c] * invLength;
+            }
+#endif
+        }
     }
 
-    Animation::UniquePtr Animation::create(const Animation& other)
+    Animation::UniquePtr Animation::create(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond, const Compression* pCompression)
     {
-        return UniquePtr(new Animation(other));
+        return UniquePtr(new Animation(name, animationSets, duration, ticksPerSecond, pCompression));
     }
 
-    Animation::Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond) : mName(name), mAnimationSets(animationSets), mDuration(duration), mTicksPerSecond(ticksPerSecond)
+    Animation::UniquePtr Animation::create(const Animation& other)
     {
-
+        return UniquePtr(new Animation(other));
     }
 
-    Animation::Animation(const Animation& other) : mName(other.mName), mDuration(other.mDuration), mTicksPerSecond(other.mTicksPerSecond)
+    glm::mat4 Animation::composeTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scaling)
     {
-        mAnimationSets = other.mAnimationSets;
+        glm::mat3 r = glm::mat3_cast(rotation);
+        glm::mat4 T;
+        T[0] = glm::vec4(r[0] * scaling.x, 0);
+        T[1] = glm::vec4(r[1] * scaling.y, 0);
+        T[2] = glm::vec4(r[2] * scaling.z, 0);
+        T[3] = glm::vec4(translation, 1);
+        return T;
     }
 
-    Animation::~Animation() = default;
-
-    template<typename T>
-    uint32_t findCurrentFrame(T channel, float ticks)
+    template<typename T, uint32_t kComponents>
+    void Animation::initTrack(const std::vector<AnimationSet>& animationSets, AnimationChannel<T> AnimationSet::* pChannel, float tolerance, bool quantize, KeyTrack<kComponents>& track)
     {
-        uint32_t curKeyID = channel.lastKeyUsed;
-        while(curKeyID < channel.keys.size() - 1)
+        track.firstKey.reserve(animationSets.size() + 1);
+        track.firstKey.push_back(0);
+        for (const auto& set : animationSets)
         {
-            if(channel.keys[curKeyID + 1].time > ticks)
+            for (const auto& key : reduceKeys((set.*pChannel).keys, tolerance))
             {
-                break;
+                track.times.push_back(key.time);
+                track.values.resize(track.values.size() + kComponents);
+                storeValue(key.value, &track.values[track.values.size() - kComponents]);
             }
-            curKeyID++;
+            track.firstKey.push_back(uint32_t(track.times.size()));
+        }
+
+        if (quantize)
+        {
+            // Quantize each bone's keys in the range they cover, which gives much better precision than a range shared by the whole clip
+            track.rangeMin.resize(animationSets.size() * kComponents);
+            track.rangeScale.resize(animationSets.size() * kComponents);
+            track.quantizedValues.resize(track.values.size());
+            for (uint32_t bone = 0; bone < animationSets.size(); bone++)
+            {
+                for (uint32_t c = 0; c < kComponents; c++)
+                {
+                    float minValue = FLT_MAX;
+                    float maxValue = -FLT_MAX;
+                    for (uint32_t k = track.firstKey[bone]; k < track.firstKey[bone + 1]; k++)
+                    {
+                        minValue = std::min(minValue, track.values[k * kComponents + c]);
+                        maxValue = std::max(maxValue, track.values[k * kComponents + c]);
+                    }
+
+                    const float scale = (maxValue > minValue) ? (maxValue - minValue) / UINT16_MAX : 0.0f;
+                    track.rangeMin[bone * kComponents + c] = (minValue <= maxValue) ? minValue : 0.0f;
+                    track.rangeScale[bone * kComponents + c] = scale;
+                    for (uint32_t k = track.firstKey[bone]; k < track.firstKey[bone + 1]; k++)
+                    {
+                        float normalized = (scale > 0) ? (track.values[k * kComponents + c] - minValue) / scale : 0.0f;
+                        track.quantizedValues[k * kComponents + c] = uint16_t(glm::clamp(normalized + 0.5f, 0.0f, float(UINT16_MAX)));
+                    }
+                }
+            }
+            track.values.clear();
+            track.values.shrink_to_fit();
         }
-        return curKeyID;
     }
 
-    glm::vec3 interpolate(const glm::vec3& start, const glm::vec3& end, float ratio)
+    Animation::Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond, const Compression* pCompression) : mName(name), mDuration(duration), mTicksPerSecond(ticksPerSecond)
     {
-        return start + ((end - start) * ratio);
+        mBoneIDs.reserve(animationSets.size());
+        for (const auto& set : animationSets) mBoneIDs.push_back(set.boneID);
+
+        const Compression none = { false, 0, 0, 0 };
+        const Compression& compression = pCompression ? *pCompression : none;
+
+        storeValue(glm::vec3(0), mTranslationTrack.defaultValue);
+        storeValue(glm::vec3(1), mScalingTrack.defaultValue);
+        storeValue(glm::quat(), mRotationTrack.defaultValue);
+        initTrack(animationSets, &AnimationSet::translation, compression.translationTolerance, compression.quantize, mTranslationTrack);
+        initTrack(animationSets, &AnimationSet::scaling, compression.scalingTolerance, compression.quantize, mScalingTrack);
+        initTrack(animationSets, &AnimationSet::rotation, compression.rotationTolerance, compression.quantize, mRotationTrack);
     }
 
-    glm::quat interpolate(const glm::quat& start, const glm::quat& end, float ratio)
+    Animation::Animation(const Animation& other) = default;
+
+    Animation::~Animation() = default;
+
+    void Animation::initState(State& state) const
     {
-        return glm::slerp(start, end, ratio);
+        state.translationCursors.assign(getChannelCount(), 0);
+        state.scalingCursors.assign(getChannelCount(), 0);
+        state.rotationCursors.assign(getChannelCount(), 0);
+
+        // The padding lanes are never written, initialize them to an identity rotation so that normalizing them doesn't produce NaNs
+        size_t laneCount = align_to(4, getChannelCount());
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            state.lanes.start[c].assign(laneCount, c == 3 ? 1.0f : 0.0f);
+            state.lanes.end[c].assign(laneCount, c == 3 ? 1.0f : 0.0f);
+            state.rotation[c].resize(laneCount);
+        }
+        state.lanes.ratio.assign(laneCount, 0.0f);
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            state.translation[c].resize(laneCount);
+            state.scaling[c].resize(laneCount);
+        }
     }
 
-    template<typename KeyType>
-    KeyType Animation::calcCurrentKey(AnimationChannel<KeyType>& channel, float ticks, float lastUpdateTime)
+    template<uint32_t kComponents>
+    void Animation::gatherKeys(const KeyTrack<kComponents>& track, std::vector<uint32_t>& cursors, SampleLanes& lanes, float ticks) const
     {
-        KeyType curValue;
-        if(channel.keys.size() > 0)
+        for (uint32_t i = 0; i < getChannelCount(); i++)
         {
-            if(ticks < lastUpdateTime)
-            {
-                channel.lastKeyUsed = 0;
-            }
+            const uint32_t firstKey = track.firstKey[i];
+            const uint32_t keyCount = track.firstKey[i + 1] - firstKey;
+            const float* pStart = track.defaultValue;
+            const float* pEnd = track.defaultValue;
+            float start[kComponents], end[kComponents];
+            float ratio = 0;
 
-            // search for the next keyframe
-            uint32_t curKeyIndex = findCurrentFrame(channel, ticks);
-            uint32_t nextKeyIndex = (curKeyIndex + 1) % channel.keys.size();
-            const AnimationKey<KeyType>& curKey = channel.keys[curKeyIndex];
-            const AnimationKey<KeyType>& nextKey = channel.keys[nextKeyIndex];
+            if (keyCount > 0)
+            {
+                const float* pTimes = track.times.data() + firstKey;
+                uint32_t curKey = findCurrentKey(pTimes, keyCount, cursors[i], ticks);
+                uint32_t nextKey = (curKey + 1) % keyCount;
 
-            assert(ticks >= curKey.time);
-            // Interpolate between them
-            float diff = nextKey.time - curKey.time;
+                // The last key interpolates towards the first one, wrapping around the end of the animation
+                float diff = pTimes[nextKey] - pTimes[curKey];
+                if (diff < 0) diff += mDuration;
+                if (diff > 0) ratio = glm::clamp((ticks - pTimes[curKey]) / diff, 0.0f, 1.0f);
 
-            if (diff == 0)
-            {
-                curValue = curKey.value;
-            }
-            else
-            {
-                if (diff < 0)
+                if (track.quantizedValues.empty())
+                {
+                    pStart = &track.values[(firstKey + curKey) * kComponents];
+                    pEnd = &track.values[(firstKey + nextKey) * kComponents];
+                }
+                else
                 {
-                    diff += mDuration;
+                    dequantizeKey(track, i, firstKey + curKey, start);
+                    dequantizeKey(track, i, firstKey + nextKey, end);
+                    pStart = start;
+                    pEnd = end;
                 }
+                cursors[i] = curKey;
+            }
 
-                float ratio = (ticks - curKey.time) / diff;
-                curValue = interpolate(curKey.value, nextKey.value, ratio);
+            for (uint32_t c = 0; c < kComponents; c++)
+            {
+                lanes.start[c][i] = pStart[c];
+                lanes.end[c][i] = pEnd[c];
             }
-            
-            channel.lastKeyUsed = curKeyIndex;
+            lanes.ratio[i] = ratio;
         }
-        return curValue;
     }
 
-    void Animation::animate(double totalTime, AnimationController* pAnimationController)
+    void Animation::sample(double totalTime, State& state) const
     {
+        assert(state.translationCursors.size() == getChannelCount());
+
         // Calculate the relative time
         float ticks = (float)fmod(totalTime * mTicksPerSecond, mDuration);
+        if (ticks < 0) ticks += mDuration;
+        SampleLanes& lanes = state.lanes;
+        const uint32_t laneCount = uint32_t(lanes.ratio.size());
 
-        for(auto& Key : mAnimationSets)
+        // Sample all the channels of each type in one batch
+        gatherKeys(mTranslationTrack, state.translationCursors, lanes, ticks);
+        for (uint32_t c = 0; c < 3; c++) lerpLanes(lanes.start[c].data(), lanes.end[c].data(), lanes.ratio.data(), state.translation[c].data(), laneCount);
+
+        gatherKeys(mScalingTrack, state.scalingCursors, lanes, ticks);
+        for (uint32_t c = 0; c < 3; c++) lerpLanes(lanes.start[c].data(), lanes.end[c].data(), lanes.ratio.data(), state.scaling[c].data(), laneCount);
+
+        gatherKeys(mRotationTrack, state.rotationCursors, lanes, ticks);
+        slerpLanes(lanes.start, lanes.end, lanes.ratio.data(), state.rotation, laneCount);
+    }
+
+    void Animation::animate(double totalTime, State& state, AnimationState* pTarget) const
+    {
+        sample(totalTime, state);
+
+        const auto& t = state.translation;
+        const auto& s = state.scaling;
+        const auto& r = state.rotation;
+        for (uint32_t i = 0; i < getChannelCount(); i++)
         {
-            glm::mat4 translation;
-            translation[3] = glm::vec4(calcCurrentKey(Key.translation, ticks, Key.lastUpdateTime), 1);
+            glm::mat4 T = composeTransform(glm::vec3(t[0][i], t[1][i], t[2][i]), glm::quat(r[3][i], r[0][i], r[1][i], r[2][i]), glm::vec3(s[0][i], s[1][i], s[2][i]));
+            pTarget->setBoneLocalTransform(mBoneIDs[i], T);
+        }
+    }
 
-            glm::mat4 scaling;
-            if (Key.scaling.keys.size() > 0)
-            {
-                scaling = glm::scale(calcCurrentKey(Key.scaling, ticks, Key.lastUpdateTime));
-            }
+    void Animation::blend(const State& state, float weight, Pose& pose) const
+    {
+        const auto& t = state.translation;
+        const auto& s = state.scaling;
+        const auto& r = state.rotation;
+        for (uint32_t i = 0; i < getChannelCount(); i++)
+        {
+            const uint32_t boneID = mBoneIDs[i];
+            pose.translation[boneID] = glm::mix(pose.translation[boneID], glm::vec3(t[0][i], t[1][i], t[2][i]), weight);
+            pose.scaling[boneID] = glm::mix(pose.scaling[boneID], glm::vec3(s[0][i], s[1][i], s[2][i]), weight);
+
+            // Normalized lerp along the shortest path. Blend weights change smoothly, so the non-constant angular velocity isn't visible
+            glm::quat q(r[3][i], r[0][i], r[1][i], r[2][i]);
+            const glm::quat& p = pose.rotation[boneID];
+            if (glm::dot(p, q) < 0) q = -q;
+            pose.rotation[boneID] = glm::normalize(p * (1 - weight) + q * weight);
+        }
+    }
 
-            glm::quat q = calcCurrentKey(Key.rotation, ticks, Key.lastUpdateTime);
-            glm::mat4 rotation = glm::mat4_cast(q);
+    void Animation::blendAdditive(const State& state, const State& reference, float weight, Pose& pose) const
+    {
+        const auto& t = state.translation;
+        const auto& s = state.scaling;
+        const auto& r = state.rotation;
+        const auto& rt = reference.translation;
+        const auto& rs = reference.scaling;
+        const auto& rr = reference.rotation;
+        const glm::quat identity;
+        for (uint32_t i = 0; i < getChannelCount(); i++)
+        {
+            const uint32_t boneID = mBoneIDs[i];
+            pose.translation[boneID] += (glm::vec3(t[0][i], t[1][i], t[2][i]) - glm::vec3(rt[0][i], rt[1][i], rt[2][i])) * weight;
 
-            Key.lastUpdateTime = ticks;
+            // A zero reference scale can't be divided out. Leave those axes unchanged
+            const glm::vec3 refScale = glm::vec3(rs[0][i], rs[1][i], rs[2][i]);
+            const glm::bvec3 validScale = glm::greaterThan(glm::abs(refScale), glm::vec3(1e-6f));
+            const glm::vec3 scaleDelta = glm::mix(glm::vec3(1), glm::vec3(s[0][i], s[1][i], s[2][i]) / glm::mix(glm::vec3(1), refScale, validScale), validScale);
+            pose.scaling[boneID] *= glm::mix(glm::vec3(1), scaleDelta, weight);
 
-            glm::mat4 T = translation * rotation * scaling;
-            pAnimationController->setBoneLocalTransform(Key.boneID, T);
+            // The delta is applied in the bone's local space, after the base rotation
+            glm::quat delta = glm::inverse(glm::quat(rr[3][i], rr[0][i], rr[1][i], rr[2][i])) * glm::quat(r[3][i], r[0][i], r[1][i], r[2][i]);
+            if (delta.w < 0) delta = -delta;
+            pose.rotation[boneID] = glm::normalize(pose.rotation[boneID] * glm::normalize(identity * (1 - weight) + delta * weight));
         }
     }
-}
+
+    size_t Animation::getKeyDataSize() const
+    {
+        size_t size = vectorSize(mBoneIDs);
+        auto trackSize = [](const auto& track)
+        {
+            return vectorSize(track.firstKey) + vectorSize(track.times) + vectorSize(track.values) + vectorSize(track.quantizedValues) + vectorSize(track.rangeMin) + vectorSize(track.rangeScale);
+        };
+        return size + trackSize(mTranslationTrack) + trackSize(mScalingTrack) + trackSize(mRotationTrack);
+    }
+}
\ No newline at end of file
@@ -32,13 +32,17 @@
 
 namespace Falcor
 {
-    class AnimationController;
+    class AnimationState;
 
+    /** An animation clip. Clips are immutable once created, so a single clip can be shared by every instance playing it. The playback state is stored in Animation::State
+    */
     class Animation
     {
     public:
         using UniquePtr = std::unique_ptr<Animation>;
         using UniqueConstPtr = std::unique_ptr<const Animation>;
+        using SharedPtr = std::shared_ptr<Animation>;
+        using SharedConstPtr = std::shared_ptr<const Animation>;
 
         template<typename T>
         struct AnimationKey
@@ -51,7 +55,6 @@ namespace Falcor
         struct AnimationChannel
         {
             std::vector<AnimationKey<T>> keys;
-            uint32_t lastKeyUsed = 0;
         };
 
         struct AnimationSet
@@ -60,26 +63,128 @@ namespace Falcor
             AnimationChannel<glm::vec3> translation;
             AnimationChannel<glm::vec3> scaling;
             AnimationChannel<glm::quat> rotation;
-            float lastUpdateTime = 0;
         };
 
-        static UniquePtr create(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond);
+        /** Lossy clip compression settings. Keys which the remaining keys interpolate within the tolerances are removed, then the remaining values can be quantized
+        */
+        struct Compression
+        {
+            bool quantize = true;                   ///< Store key values as 16-bit integers in a per-bone range instead of floats
+            float translationTolerance = 1e-3f;     ///< Max error of a removed translation key, in model units
+            float scalingTolerance = 1e-3f;         ///< Max error of a removed scaling key
+            float rotationTolerance = 1e-3f;        ///< Max error of a removed rotation key, in radians
+        };
+
+        /** Bone transforms decomposed into translation, rotation and scaling, indexed by bone ID. Used to blend animations
+        */
+        struct Pose
+        {
+            std::vector<glm::vec3> translation;
+            std::vector<glm::quat> rotation;
+            std::vector<glm::vec3> scaling;
+        };
+
+        /** Structure-of-arrays sampling lanes. Each array is padded to a multiple of 4 channels so that the interpolation kernels don't need a scalar tail
+        */
+        struct SampleLanes
+        {
+            std::vector<float> start[4];
+            std::vector<float> end[4];
+            std::vector<float> ratio;
+        };
+
+        /** Playback state of a clip. Holds the key cursors and the sampling scratch memory, so that different threads can evaluate the same clip
+        */
+        struct State
+        {
+            std::vector<uint32_t> translationCursors;   // The last key used by each bone
+            std::vector<uint32_t> scalingCursors;
+            std::vector<uint32_t> rotationCursors;
+            SampleLanes lanes;
+            std::vector<float> translation[3];
+            std::vector<float> scaling[3];
+            std::vector<float> rotation[4];
+        };
+
+        /** Create an animation clip
+            \param[in] name The clip's name
+            \param[in] animationSets The keys of the animated bones
+            \param[in] duration The clip's duration in ticks
+            \param[in] ticksPerSecond Playback rate
+            \param[in] pCompression Compression settings, or nullptr to store the keys as is
+        */
+        static UniquePtr create(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond, const Compression* pCompression = nullptr);
         static UniquePtr create(const Animation& other);
         ~Animation();
-        void animate(double totalTime, AnimationController* pAnimationController);
+
+        /** Compose a bone transform, translation * rotation * scaling
+        */
+        static glm::mat4 composeTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scaling);
+
+        /** Allocate the playback state of the clip and rewind it
+        */
+        void initState(State& state) const;
+
+        /** Evaluate the clip and write the bones' local transforms into the target
+            \param[in] totalTime The playback time in seconds
+            \param[in] state The playback state. Must have been initialized with initState()
+            \param[in] pTarget The animation state to write the transforms into
+        */
+        void animate(double totalTime, State& state, AnimationState* pTarget) const;
+
+        /** Evaluate the clip into the state without writing it anywhere. Use with blend() and blendAdditive()
+        */
+        void sample(double totalTime, State& state) const;
+
+        /** Blend a sampled clip into a pose, pose = mix(pose, clip, weight). Bones without channels are left unchanged
+        */
+        void blend(const State& state, float weight, Pose& pose) const;
+
+        /** Add the difference between a sampled clip and a reference sample of the same clip to a pose, scaled by weight
+        */
+        void blendAdditive(const State& state, const State& reference, float weight, Pose& pose) const;
+
+        /** Get the memory used by the keys, in bytes
+        */
+        size_t getKeyDataSize() const;
         const std::string& getName() const { return mName; }
 
+        /** Get the number of animated bones
+        */
+        uint32_t getChannelCount() const { return uint32_t(mBoneIDs.size()); }
+
     private:
-        Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond);
+        Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond, const Compression* pCompression);
         Animation(const Animation& other);
-        
+
+        /** The keys of one channel type for all the animated bones. Bone i uses keys [firstKey[i], firstKey[i + 1])
+            Values are stored as kComponents floats per key, or as kComponents 16-bit integers per key when quantized.
+        */
+        template<uint32_t kComponents>
+        struct KeyTrack
+        {
+            std::vector<uint32_t> firstKey;
+            std::vector<float> times;
+            std::vector<float> values;
+            std::vector<uint16_t> quantizedValues;
+            std::vector<float> rangeMin;        // Per-bone dequantization range, kComponents floats per bone
+            std::vector<float> rangeScale;
+            float defaultValue[kComponents];    // Used by bones without keys
+        };
+
         const std::string mName;
         float mDuration;
         float mTicksPerSecond;
 
-        std::vector<AnimationSet> mAnimationSets;
+        std::vector<uint32_t> mBoneIDs;
+        KeyTrack<3> mTranslationTrack;
+        KeyTrack<3> mScalingTrack;
+        KeyTrack<4> mRotationTrack;
+
+        template<typename T, uint32_t kComponents>
+        static void initTrack(const std::vector<AnimationSet>& animationSets, AnimationChannel<T> AnimationSet::* pChannel, float tolerance, bool quantize, KeyTrack<kComponents>& track);
 
-        template<typename _KeyType>
-        _KeyType calcCurrentKey(AnimationChannel<_KeyType>& channel, float ticks, float lastUpdateTime);
+        template<uint32_t kComponents>
+        void gatherKeys(const KeyTrack<kComponents>& track, std::vector<uint32_t>& cursors, SampleLanes& lanes, float ticks) const;
     };
 }
\ No newline at end of file
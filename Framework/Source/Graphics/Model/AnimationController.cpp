@@ -30,10 +30,34 @@
 #include "Model.h"
 #include <fstream>
 #include "Animation.h"
+#include "Utils/Math/FalcorMath.h"
+#include "Utils/TaskScheduler.h"
 #include <algorithm>
+#include <atomic>
 
 namespace Falcor
 {
+    /** Split a transform without shear into translation, rotation and scaling
+    */
+    static void decomposeTransform(const glm::mat4& m, glm::vec3& translation, glm::quat& rotation, glm::vec3& scaling)
+    {
+        translation = glm::vec3(m[3]);
+        glm::mat3 r(m);
+        for (int c = 0; c < 3; c++)
+        {
+            scaling[c] = glm::length(r[c]);
+            r[c] /= scaling[c];
+        }
+
+        // Move a reflection into the scaling, a rotation matrix can't represent it
+        if (glm::determinant(r) < 0)
+        {
+            scaling.x = -scaling.x;
+            r[0] = -r[0];
+        }
+        rotation = glm::normalize(glm::quat_cast(r));
+    }
+
     void dumpBonesHeirarchy(const std::string& filename, Bone* pBone, uint32_t count)
     {
         std::ofstream dotfile;
@@ -74,21 +98,70 @@ namespace Falcor
     AnimationController::AnimationController(const std::vector<Bone>& Bones)
     {
         mBones = Bones;
-        mBoneTransforms.resize(mBones.size());
-        mBoneInvTransposeTransforms.resize(mBones.size());
-        setActiveAnimation(kBindPoseAnimationId);
+        initHierarchy();
+        mpDefaultState = createState();
     }
 
     AnimationController::AnimationController(const AnimationController& other)
     {
+        // The clips are immutable, share them instead of copying the keys
         mBones = other.mBones;
-        mBoneTransforms = other.mBoneTransforms;
-        mBoneInvTransposeTransforms = other.mBoneInvTransposeTransforms;
-        for (const auto& it : other.mAnimations)
+        mAnimations = other.mAnimations;
+        mUpdateOrder = other.mUpdateOrder;
+        mBoneUpdateIndex = other.mBoneUpdateIndex;
+        mParentUpdateIndex = other.mParentUpdateIndex;
+        mBindPose = other.mBindPose;
+        mBindPoseDecomposed = other.mBindPoseDecomposed;
+        mOffsets = other.mOffsets;
+        mpDefaultState = createState();
+        mpDefaultState->setActiveAnimation(other.getActiveAnimation());
+    }
+
+    void AnimationController::initHierarchy()
+    {
+        const uint32_t boneCount = getBoneCount();
+        std::vector<std::vector<uint32_t>> children(boneCount);
+        std::vector<uint32_t> stack;
+        for (uint32_t i = 0; i < boneCount; i++)
         {
-            mAnimations.push_back(Animation::create(*it));
+            if (mBones[i].parentID == kInvalidBoneID) stack.push_back(i);
+            else children[mBones[i].parentID].push_back(i);
+        }
+
+        // Depth-first pre-order, visiting children in ID order. The importer creates the bones in that order, in which case the update order is the identity
+        std::reverse(stack.begin(), stack.end());
+        mUpdateOrder.clear();
+        mUpdateOrder.reserve(boneCount);
+        while (stack.empty() == false)
+        {
+            uint32_t boneID = stack.back();
+            stack.pop_back();
+            mUpdateOrder.push_back(boneID);
+            stack.insert(stack.end(), children[boneID].rbegin(), children[boneID].rend());
+        }
+        assert(mUpdateOrder.size() == boneCount);
+
+        mBoneUpdateIndex.resize(boneCount);
+        for (uint32_t i = 0; i < boneCount; i++) mBoneUpdateIndex[mUpdateOrder[i]] = i;
+
+        mParentUpdateIndex.resize(boneCount);
+        mBindPose.resize(boneCount);
+        mOffsets.resize(boneCount);
+        for (uint32_t i = 0; i < boneCount; i++)
+        {
+            const Bone& bone = mBones[mUpdateOrder[i]];
+            mParentUpdateIndex[i] = (bone.parentID == kInvalidBoneID) ? kInvalidBoneID : mBoneUpdateIndex[bone.parentID];
+            mBindPose[i] = bone.originalLocalTransform;
+            mOffsets[i] = bone.offset;
+        }
+
+        mBindPoseDecomposed.translation.resize(boneCount);
+        mBindPoseDecomposed.rotation.resize(boneCount);
+        mBindPoseDecomposed.scaling.resize(boneCount);
+        for (uint32_t i = 0; i < boneCount; i++)
+        {
+            decomposeTransform(mBones[i].originalLocalTransform, mBindPoseDecomposed.translation[i], mBindPoseDecomposed.rotation[i], mBindPoseDecomposed.scaling[i]);
         }
-        mActiveAnimation = other.mActiveAnimation;
     }
 
     void AnimationController::addAnimation(Animation::UniquePtr pAnimation)
@@ -98,47 +171,237 @@ namespace Falcor
 
     AnimationController::~AnimationController() = default;
 
+    AnimationState::SharedPtr AnimationController::createState() const
+    {
+        return AnimationState::create(this);
+    }
+
     void AnimationController::setBoneLocalTransform(uint32_t boneID, const glm::mat4& transform)
     {
-        assert(boneID < mBones.size());
-        mBones[boneID].localTransform = transform;
+        mpDefaultState->setBoneLocalTransform(boneID, transform);
     }
 
-    void AnimationController::animate(double currentTime)
+    bool AnimationController::animate(double currentTime)
     {
-        if(mActiveAnimation != kBindPoseAnimationId)
+        return mpDefaultState->animate(currentTime);
+    }
+
+    void AnimationController::setActiveAnimation(uint32_t id)
+    {
+        mpDefaultState->setActiveAnimation(id);
+    }
+
+    void AnimationController::crossFade(uint32_t id, float duration)
+    {
+        mpDefaultState->crossFade(id, duration);
+    }
+
+    void AnimationController::setAdditiveAnimation(uint32_t id, float weight)
+    {
+        mpDefaultState->setAdditiveAnimation(id, weight);
+    }
+
+    uint32_t AnimationController::getActiveAnimation() const
+    {
+        return mpDefaultState->getActiveAnimation();
+    }
+
+    const std::vector<mat4>& AnimationController::getBoneMatrices() const
+    {
+        return mpDefaultState->getBoneMatrices();
+    }
+
+    const std::vector<mat4>& AnimationController::getBoneInvTransposeMatrices() const
+    {
+        return mpDefaultState->getBoneInvTransposeMatrices();
+    }
+
+    const std::string& AnimationController::getAnimationName(uint32_t ID) const
+    { 
+        return mAnimations[ID]->getName(); 
+    }
+
+    AnimationState::SharedPtr AnimationState::create(const AnimationController* pController)
+    {
+        return SharedPtr(new AnimationState(pController));
+    }
+
+    AnimationState::AnimationState(const AnimationController* pController) : mpController(pController)
+    {
+        const uint32_t boneCount = pController->getBoneCount();
+        mGlobalTransforms.resize(boneCount);
+        mBoneTransforms.resize(boneCount);
+        mBoneInvTransposeTransforms.resize(boneCount);
+        setActiveAnimation(AnimationController::kBindPoseAnimationId);
+    }
+
+    AnimationState::~AnimationState() = default;
+
+    void AnimationState::setBoneLocalTransform(uint32_t boneID, const glm::mat4& transform)
+    {
+        assert(boneID < getBoneCount());
+        mLocalTransforms[mpController->mBoneUpdateIndex[boneID]] = transform;
+        mPoseDirty = true;
+    }
+
+    void AnimationState::setActiveAnimation(uint32_t id)
+    {
+        assert(id == AnimationController::kBindPoseAnimationId || id < mpController->getAnimationCount());
+        mActiveAnimation = id;
+        mFading = false;
+
+        // Bones the clip doesn't animate stay in the bind pose
+        mLocalTransforms = mpController->mBindPose;
+        mPoseBlended = false;
+        if (id != AnimationController::kBindPoseAnimationId)
+        {
+            mpController->getAnimation(id)->initState(mClipState);
+        }
+        animate(0);
+        mPoseDirty = true;
+    }
+
+    void AnimationState::crossFade(uint32_t id, float duration)
+    {
+        assert(id == AnimationController::kBindPoseAnimationId || id < mpController->getAnimationCount());
+        if (duration <= 0 || id == mActiveAnimation)
+        {
+            setActiveAnimation(id);
+            return;
+        }
+
+        // The active animation becomes the one we fade out of. Its cursors stay valid, so it continues playing smoothly
+        std::swap(mClipState, mPrevClipState);
+        mPrevAnimation = mActiveAnimation;
+        mActiveAnimation = id;
+        if (id != AnimationController::kBindPoseAnimationId)
+        {
+            mpController->getAnimation(id)->initState(mClipState);
+        }
+        mFading = true;
+        mFadeStartPending = true;
+        mFadeDuration = duration;
+        mPoseDirty = true;
+    }
+
+    void AnimationState::setAdditiveAnimation(uint32_t id, float weight)
+    {
+        assert(id == AnimationController::kBindPoseAnimationId || id < mpController->getAnimationCount());
+        mAdditiveAnimation = id;
+        mAdditiveWeight = weight;
+        if (id != AnimationController::kBindPoseAnimationId)
         {
-            mAnimations[mActiveAnimation]->animate(currentTime, this);
+            const Animation* pAnimation = mpController->getAnimation(id);
+            pAnimation->initState(mAdditiveState);
+            pAnimation->initState(mAdditiveReference);
+            pAnimation->sample(0, mAdditiveReference);
         }
+        mPoseDirty = true;
+    }
+
+    bool AnimationState::animate(double currentTime)
+    {
+        // Only states which play a clip change over time
+        const bool isPlaying = mFading || mActiveAnimation != AnimationController::kBindPoseAnimationId || mAdditiveAnimation != AnimationController::kBindPoseAnimationId;
+        if (mPoseDirty == false && (isPlaying == false || currentTime == mLastAnimateTime)) return false;
 
-        for(uint32_t i = 0; i < mBones.size(); i++)
+        const double playbackTime = currentTime * mSpeed + mTimeOffset;
+        if (mFading || mAdditiveAnimation != AnimationController::kBindPoseAnimationId)
         {
-            mBones[i].globalTransform = mBones[i].localTransform;
-            if(mBones[i].parentID != kInvalidBoneID)
+            blendPose(currentTime, playbackTime);
+            mPoseBlended = true;
+        }
+        else
+        {
+            // Blending wrote every bone. After a fade completes or the additive layer is removed, the bones the active clip doesn't animate go back to the bind pose
+            if (mPoseBlended)
+            {
+                mLocalTransforms = mpController->mBindPose;
+                mPoseBlended = false;
+            }
+            if (mActiveAnimation != AnimationController::kBindPoseAnimationId)
             {
-                mBones[i].globalTransform = mBones[mBones[i].parentID].globalTransform * mBones[i].localTransform;
+                mpController->getAnimation(mActiveAnimation)->animate(playbackTime, mClipState, this);
             }
-            mBoneTransforms[i] = mBones[i].globalTransform * mBones[i].offset;
-            mBoneInvTransposeTransforms[i] = transpose(inverse(mBoneTransforms[i]));
         }
+        updateHierarchy();
+        mLastAnimateTime = currentTime;
+        mPoseDirty = false;
+        return true;
     }
 
-    void AnimationController::setActiveAnimation(uint32_t id)
+    void AnimationState::blendPose(double currentTime, double playbackTime)
     {
-        assert(id == kBindPoseAnimationId || id < mAnimations.size());
-        mActiveAnimation = id;
-        if(id == kBindPoseAnimationId)
+        const uint32_t kBindPose = AnimationController::kBindPoseAnimationId;
+        float fadeWeight = 1;
+        if (mFading)
         {
-            for(auto& bone : mBones)
+            if (mFadeStartPending)
             {
-                bone.localTransform = bone.originalLocalTransform;
+                mFadeStart = currentTime;
+                mFadeStartPending = false;
             }
+            fadeWeight = (float)glm::clamp((currentTime - mFadeStart) / mFadeDuration, 0.0, 1.0);
         }
-        animate(0);
+
+        // Blending starts from the bind pose, so bones without channels in the blended clips are in the bind pose
+        mPose = mpController->mBindPoseDecomposed;
+        if (mFading && mPrevAnimation != kBindPose)
+        {
+            const Animation* pPrev = mpController->getAnimation(mPrevAnimation);
+            pPrev->sample(playbackTime, mPrevClipState);
+            pPrev->blend(mPrevClipState, (mActiveAnimation == kBindPose) ? 1 - fadeWeight : 1, mPose);
+        }
+
+        if (mActiveAnimation != kBindPose)
+        {
+            const Animation* pActive = mpController->getAnimation(mActiveAnimation);
+            pActive->sample(playbackTime, mClipState);
+            pActive->blend(mClipState, fadeWeight, mPose);
+        }
+
+        if (mAdditiveAnimation != kBindPose)
+        {
+            const Animation* pAdditive = mpController->getAnimation(mAdditiveAnimation);
+            pAdditive->sample(playbackTime, mAdditiveState);
+            pAdditive->blendAdditive(mAdditiveState, mAdditiveReference, mAdditiveWeight, mPose);
+        }
+
+        const auto& updateOrder = mpController->mUpdateOrder;
+        for (uint32_t i = 0; i < updateOrder.size(); i++)
+        {
+            const uint32_t boneID = updateOrder[i];
+            mLocalTransforms[i] = Animation::composeTransform(mPose.translation[boneID], mPose.rotation[boneID], mPose.scaling[boneID]);
+        }
+
+        if (fadeWeight >= 1) mFading = false;
     }
 
-    const std::string& AnimationController::getAnimationName(uint32_t ID) const
-    { 
-        return mAnimations[ID]->getName(); 
+    bool AnimationState::animate(const std::vector<AnimationState*>& states, double currentTime)
+    {
+        // A state only writes to its own memory and the clips are immutable, so the states can be evaluated concurrently
+        std::atomic<bool> changed(false);
+        TaskScheduler::getDefault()->parallelFor(0, uint32_t(states.size()), [&](uint32_t i)
+        {
+            if (states[i]->animate(currentTime)) changed = true;
+        });
+        return changed;
+    }
+
+    void AnimationState::updateHierarchy()
+    {
+        const auto& updateOrder = mpController->mUpdateOrder;
+        const auto& parentIndex = mpController->mParentUpdateIndex;
+        const auto& offsets = mpController->mOffsets;
+
+        for(uint32_t i = 0; i < updateOrder.size(); i++)
+        {
+            const uint32_t parent = parentIndex[i];
+            mGlobalTransforms[i] = (parent == AnimationController::kInvalidBoneID) ? mLocalTransforms[i] : mGlobalTransforms[parent] * mLocalTransforms[i];
+
+            const uint32_t boneID = updateOrder[i];
+            mBoneTransforms[boneID] = mGlobalTransforms[i] * offsets[i];
+            mBoneInvTransposeTransforms[boneID] = affineInverseTranspose(mBoneTransforms[boneID]);
+        }
     }
 }
\ No newline at end of file
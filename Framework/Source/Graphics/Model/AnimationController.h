@@ -46,7 +46,11 @@ namespace Falcor
 
     class Model;
     class AssimpModelImporter;
+    class AnimationState;
 
+    /** Holds a model's skeleton and animation clips. The clips are shared, copies of the controller reference the same clip data.
+        The controller owns a default AnimationState which drives the model when its instances don't have a state of their own. Use createState() to animate instances independently
+    */
     class AnimationController
     {
     public:
@@ -60,31 +64,162 @@ namespace Falcor
         ~AnimationController();
 
         void addAnimation(Animation::UniquePtr pAnimation);
-        void animate(double currentTime);
+
+        /** Animate the default state
+            \return Whether the pose changed
+        */
+        bool animate(double currentTime);
 
         uint32_t getAnimationCount() const { return uint32_t(mAnimations.size()); }
         const std::string& getAnimationName(uint32_t ID) const;
+        const Animation* getAnimation(uint32_t ID) const { return mAnimations[ID].get(); }
         void setActiveAnimation(uint32_t id);
-        uint32_t getActiveAnimation() const {return mActiveAnimation;}
+        uint32_t getActiveAnimation() const;
 
-        const std::vector<mat4>& getBoneMatrices() const { return mBoneTransforms; }
-        const std::vector<mat4>& getBoneInvTransposeMatrices() const { return mBoneInvTransposeTransforms; }
+        /** Blend from the active animation to a new one. See AnimationState::crossFade()
+        */
+        void crossFade(uint32_t id, float duration);
+
+        /** Layer an additive animation on top of the active one. See AnimationState::setAdditiveAnimation()
+        */
+        void setAdditiveAnimation(uint32_t id, float weight = 1);
+
+        const std::vector<mat4>& getBoneMatrices() const;
+        const std::vector<mat4>& getBoneInvTransposeMatrices() const;
         uint32_t getBoneCount() const { return uint32_t(mBones.size()); }
 
         uint32_t getBoneIdFromName(const std::string& name) const;
         void setBoneLocalTransform(uint32_t boneID, const glm::mat4& transform);
 
+        /** Create a new animation state for this skeleton, playing the bind pose. The state references the controller, which must outlive it
+        */
+        std::shared_ptr<AnimationState> createState() const;
+
+        /** Get the default state, used by the model itself
+        */
+        AnimationState* getDefaultState() const { return mpDefaultState.get(); }
+
     private:
+        friend class AnimationState;
         AnimationController(const std::vector<Bone>& bones);
         AnimationController(const AnimationController& other);
 
         std::vector<Bone> mBones;
-        std::vector<glm::mat4> mBoneTransforms;
-        std::vector<glm::mat4> mBoneInvTransposeTransforms;
-        std::vector<Animation::UniquePtr> mAnimations;
+        std::vector<Animation::SharedConstPtr> mAnimations;
+
+        // The hierarchy is stored in update order, which places parents before their children, so the update is a single linear pass
+        std::vector<uint32_t> mUpdateOrder;         // Update index -> bone ID
+        std::vector<uint32_t> mBoneUpdateIndex;     // Bone ID -> update index
+        std::vector<uint32_t> mParentUpdateIndex;
+        std::vector<glm::mat4> mBindPose;           // Original local transforms, in update order
+        Animation::Pose mBindPoseDecomposed;        // Original local transforms, in bone ID order
+        std::vector<glm::mat4> mOffsets;
+
+        std::shared_ptr<AnimationState> mpDefaultState;
+
+        void initHierarchy();
+    };
+
+    /** Per-instance animation state: the active clip, the playback time and the resulting pose. The skeleton and the clips are shared through the AnimationController
+    */
+    class AnimationState
+    {
+    public:
+        using SharedPtr = std::shared_ptr<AnimationState>;
+        using SharedConstPtr = std::shared_ptr<const AnimationState>;
+
+        /** Create a state playing the bind pose. Use AnimationController::createState()
+        */
+        static SharedPtr create(const AnimationController* pController);
+        ~AnimationState();
+
+        /** Evaluate the active animation and update the bone matrices
+            \param[in] currentTime The current global time. The state's time offset and speed are applied to it
+            \return Whether the pose changed. A state which plays the bind pose and wasn't modified since the last call doesn't change
+        */
+        bool animate(double currentTime);
+
+        /** Animate a batch of states in parallel using the default task scheduler
+            \param[in] states The states to animate. They must be distinct
+            \param[in] currentTime The current global time
+            \return Whether the pose of any of the states changed
+        */
+        static bool animate(const std::vector<AnimationState*>& states, double currentTime);
 
-        uint32_t mActiveAnimation = kBindPoseAnimationId;
+        /** Select the active animation, or kBindPoseAnimationId for the bind pose. The switch is immediate, use crossFade() for a smooth transition
+        */
+        void setActiveAnimation(uint32_t id);
+        uint32_t getActiveAnimation() const { return mActiveAnimation; }
+
+        /** Blend from the current pose to a new active animation. The previous animation keeps playing until the fade completes
+            \param[in] id The new active animation, or kBindPoseAnimationId to fade to the bind pose
+            \param[in] duration The fade duration in seconds, measured from the next call to animate()
+        */
+        void crossFade(uint32_t id, float duration);
+
+        /** Check if a cross-fade is in progress
+        */
+        bool isFading() const { return mFading; }
+
+        /** Layer an additive animation on top of the active one. The additive clip's difference from its first frame is added to the pose
+            \param[in] id The additive animation, or kBindPoseAnimationId to remove the layer
+            \param[in] weight The layer's weight
+        */
+        void setAdditiveAnimation(uint32_t id, float weight = 1);
+        uint32_t getAdditiveAnimation() const { return mAdditiveAnimation; }
+        void setAdditiveWeight(float weight) { mAdditiveWeight = weight; mPoseDirty = true; }
+        float getAdditiveWeight() const { return mAdditiveWeight; }
+
+        /** Set the playback time offset in seconds. Use different offsets to keep instances playing the same clip out of sync
+        */
+        void setTimeOffset(double offset) { mTimeOffset = offset; mPoseDirty = true; }
+        double getTimeOffset() const { return mTimeOffset; }
+
+        /** Set the playback speed multiplier
+        */
+        void setSpeed(float speed) { mSpeed = speed; mPoseDirty = true; }
+        float getSpeed() const { return mSpeed; }
+
+        void setBoneLocalTransform(uint32_t boneID, const glm::mat4& transform);
+
+        const std::vector<mat4>& getBoneMatrices() const { return mBoneTransforms; }
+        const std::vector<mat4>& getBoneInvTransposeMatrices() const { return mBoneInvTransposeTransforms; }
+        uint32_t getBoneCount() const { return uint32_t(mBoneTransforms.size()); }
+        const AnimationController* getController() const { return mpController; }
+
+    private:
+        AnimationState(const AnimationController* pController);
+        void blendPose(double currentTime, double playbackTime);
+        void updateHierarchy();
+
+        const AnimationController* mpController;
+        uint32_t mActiveAnimation = AnimationController::kBindPoseAnimationId;
+        double mTimeOffset = 0;
+        float mSpeed = 1;
+        bool mPoseDirty = true;         // The state was modified since the last call to animate()
+        bool mPoseBlended = false;      // mLocalTransforms was written by blendPose()
+        double mLastAnimateTime = 0;
 
-        void calculateBoneTransforms();
+        Animation::State mClipState;
+
+        // Cross-fade from the previous animation
+        bool mFading = false;
+        bool mFadeStartPending = false;
+        double mFadeStart = 0;
+        float mFadeDuration = 0;
+        uint32_t mPrevAnimation = AnimationController::kBindPoseAnimationId;
+        Animation::State mPrevClipState;
+
+        // Additive layer
+        uint32_t mAdditiveAnimation = AnimationController::kBindPoseAnimationId;
+        float mAdditiveWeight = 1;
+        Animation::State mAdditiveState;
+        Animation::State mAdditiveReference;    // The additive clip's first frame
+
+        Animation::Pose mPose;
+        std::vector<glm::mat4> mLocalTransforms;    // In update order
+        std::vector<glm::mat4> mGlobalTransforms;
+        std::vector<glm::mat4> mBoneTransforms;     // In bone ID order
+        std::vector<glm::mat4> mBoneInvTransposeTransforms;
     };
 }
\ No newline at end of file
@@ -26,8 +26,10 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #include "assimp/Importer.hpp"
+#include "assimp/Exporter.hpp"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
+#include "assimp/version.h"
 
 #include "Framework.h"
 #include "AssimpModelImporter.h"
@@ -35,14 +37,24 @@
 #include "Graphics/Model/Animation.h"
 #include "Graphics/Model/Mesh.h"
 #include "Graphics/Model/AnimationController.h"
+#include "Graphics/Model/TangentSpace.h"
+#include "Graphics/Model/MeshOptimizer.h"
+#include "Graphics/Model/MeshSimplifier.h"
+#include "Graphics/Model/Meshlet.h"
 #include "API/Texture.h"
 #include "API/Buffer.h"
 #include "Utils/Platform/OS.h"
 #include "Graphics/TextureHelper.h"
+#include "Graphics/TextureStreamer.h"
 #include "API/VertexLayout.h"
 #include "Data/VertexAttrib.h"
 #include "Utils/StringUtils.h"
 #include "API/Device.h"
+#include "Utils/Profiler.h"
+#include "Utils/TaskScheduler.h"
+#include "Utils/Hash.h"
+#include <cstdio>
+#include <thread>
 
 namespace Falcor
 {
@@ -56,23 +68,10 @@ namespace Falcor
 
     using VertexIdsVec = std::vector<uvec8_4>;
 
-    template<typename posType>
-    void generateSubmeshTangentData(
-        const std::vector<uint32_t>& indices,
-        uint32_t vertexCount,
-        const posType* vertexPosData,
-        const glm::vec3* vertexNormalData,
-        const glm::vec2* texCrdData,
-        uint32_t texCrdCount,
-        glm::vec3* bitangentData);
 
-
-    void loadBones(const aiMesh* pAiMesh, VertexWeightsVec& weights, VertexIdsVec& ids, uint32_t vertexCount, const std::map<std::string, uint32_t>& boneNameToIdMap)
+    bool loadBones(const aiMesh* pAiMesh, VertexWeightsVec& weights, VertexIdsVec& ids, uint32_t vertexCount, const std::map<std::string, uint32_t>& boneNameToIdMap)
     {
-        if (pAiMesh->mNumBones > 0xff)
-        {
-            logError("Too many bones");
-        }
+        bool result = (pAiMesh->mNumBones <= 0xff);
 
         weights.resize(vertexCount);
         ids.resize(vertexCount);
@@ -108,7 +107,7 @@ namespace Falcor
 
                 if (emptySlotFound == false)
                 {
-                    logError("Too many bones");
+                    result = false;
                 }
             }
         }
@@ -126,6 +125,7 @@ namespace Falcor
             }
             w /= f;
         }
+        return result;
     }
 
     std::vector<uint32_t> createIndexBufferData(const aiMesh* pAiMesh)
@@ -147,30 +147,32 @@ namespace Falcor
         return indices;
     }
 
-    void genTangentSpace(aiMesh* pAiMesh)
+    void genTangentSpace(const aiMesh* pAiMesh, const std::vector<uint32_t>& indices, std::vector<glm::vec3>& bitangents)
     {
         if (pAiMesh->mFaces[0].mNumIndices == 3)
         {
-            pAiMesh->mBitangents = new aiVector3D[pAiMesh->mNumVertices];
+            bitangents.resize(pAiMesh->mNumVertices);
 
-            const glm::vec3* pPos = (glm::vec3*)pAiMesh->mVertices;
-            glm::vec3* pBi = (glm::vec3*)pAiMesh->mBitangents;
-            glm::vec3* pNormals = (glm::vec3*)pAiMesh->mNormals;
-            std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
+            TangentSpaceInput input;
+            input.pIndices = indices.data();
+            input.indexCount = (uint32_t)indices.size();
+            input.vertexCount = pAiMesh->mNumVertices;
+            input.pPositions = pAiMesh->mVertices;
+            input.pNormals = (glm::vec3*)pAiMesh->mNormals;
 
-            uint32_t texCrdCount = 0;
+            // Assimp stores 3-component texture coordinates
             std::vector<glm::vec2> texCrd;
             if (pAiMesh->mTextureCoords[0] != nullptr)
             {
-                texCrdCount = 1;
                 texCrd.resize(pAiMesh->mNumVertices);
                 for (size_t i = 0; i < pAiMesh->mNumVertices; ++i)
                 {
                     texCrd[i] = glm::vec2(pAiMesh->mTextureCoords[0][i].x, pAiMesh->mTextureCoords[0][i].y);
                 }
+                input.pTexCrd = texCrd.data();
             }
 
-            generateSubmeshTangentData<glm::vec3>(indices, pAiMesh->mNumVertices, pPos, pNormals, (texCrdCount > 0 ? texCrd.data() : nullptr), texCrdCount, pBi);
+            generateBitangents(input, bitangents.data());
         }
     }
 
@@ -237,6 +239,12 @@ namespace Falcor
         }
     }
 
+    // Matches the slots setTexture() assigns the textures to
+    static bool isNormalMap(aiTextureType type, bool isObjFile)
+    {
+        return (type == aiTextureType_NORMALS) || (isObjFile && (type == aiTextureType_HEIGHT || type == aiTextureType_DISPLACEMENT));
+    }
+
     bool isSrgbRequired(aiTextureType aiType, bool isSrgbRequested, uint32_t shadingModel)
     {
         if (isSrgbRequested == false)
@@ -306,7 +314,25 @@ namespace Falcor
                     // create a new texture
                     std::string fullpath = folder + '/' + s;
                     fullpath = replaceSubstring(fullpath, "\\", "/");
-                    pTex = createTextureFromFile(fullpath, true, isSrgbRequired(aiType, useSrgb, pMaterial->getShadingModel()));
+                    bool loadAsSrgb = isSrgbRequired(aiType, useSrgb, pMaterial->getShadingModel());
+                    if (is_set(mFlags, Model::LoadFlags::StreamTextures) && hasSuffix(fullpath, ".dds") == false)
+                    {
+                        // Falls back to loading all the mips below if the image isn't an 8-bit RGBA image
+                        TextureStreamer::Source source;
+                        source.name = stripDataDirectories(fullpath);
+                        source.filename = fullpath;
+                        source.format = loadAsSrgb ? ResourceFormat::RGBA8UnormSrgb : ResourceFormat::RGBA8Unorm;
+                        pTex = TextureStreamer::getDefault()->addTexture(source);
+                    }
+                    if (pTex == nullptr)
+                    {
+                        TextureCompressor::Mode compression = TextureCompressor::Mode::None;
+                        if (is_set(mFlags, Model::LoadFlags::CompressTextures))
+                        {
+                            compression = isNormalMap(aiType, isObjFile) ? TextureCompressor::Mode::NormalMap : TextureCompressor::Mode::Color;
+                        }
+                        pTex = createTextureFromFile(fullpath, true, loadAsSrgb, Texture::BindFlags::ShaderResource, compression);
+                    }
                     if (pTex)
                     {
                         mTextureCache[s] = pTex;
@@ -418,6 +444,11 @@ namespace Falcor
                 else logWarning("Unknown material property found in the material's name - `" + nameVec[i] + "`");
             }
         }
+
+        if (is_set(mFlags, Model::LoadFlags::StreamTextures))
+        {
+            TextureStreamer::getDefault()->addMaterial(pMaterial);
+        }
         return pMaterial;
     }
 
@@ -461,7 +492,7 @@ namespace Falcor
         return true;
     }
 
-    bool AssimpModelImporter::parseAiSceneNode(const aiNode* pCurrent, const aiScene* pScene, IdToMesh& aiToFalcorMesh)
+    bool AssimpModelImporter::parseAiSceneNode(const aiNode* pCurrent, const aiScene* pScene, const IdToMesh& aiToFalcorMesh)
     {
         if (pCurrent->mNumMeshes)
         {
@@ -474,19 +505,12 @@ namespace Falcor
                 pParent = pParent->mParent;
             }
 
-            // Initialize the meshes
+            // Add the mesh instances. The meshes were created by createDrawList()
             for (uint32_t i = 0; i < pCurrent->mNumMeshes; i++)
             {
                 uint32_t aiId = pCurrent->mMeshes[i];
-
-                // New mesh
-                if (aiToFalcorMesh.find(aiId) == aiToFalcorMesh.end())
-                {
-                    // Cache mesh
-                    aiToFalcorMesh[aiId] = createMesh(pScene->mMeshes[aiId]);
-                }
-
-                mModel.addMeshInstance(aiToFalcorMesh[aiId], aiMatToGLM(transform));
+                assert(aiToFalcorMesh.find(aiId) != aiToFalcorMesh.end());
+                mModel.addMeshInstance(aiToFalcorMesh.at(aiId), aiMatToGLM(transform));
             }
         }
 
@@ -499,21 +523,123 @@ namespace Falcor
         return b;
     }
 
+    static void collectNodeMeshes(const aiNode* pCurrent, std::vector<bool>& isCollected, std::vector<uint32_t>& meshIds)
+    {
+        for (uint32_t i = 0; i < pCurrent->mNumMeshes; i++)
+        {
+            uint32_t aiId = pCurrent->mMeshes[i];
+            if (isCollected[aiId] == false)
+            {
+                isCollected[aiId] = true;
+                meshIds.push_back(aiId);
+            }
+        }
+
+        for (uint32_t i = 0; i < pCurrent->mNumChildren; i++)
+        {
+            collectNodeMeshes(pCurrent->mChildren[i], isCollected, meshIds);
+        }
+    }
+
     bool AssimpModelImporter::createDrawList(const aiScene* pScene)
     {
         createAnimationController(pScene);
-        IdToMesh aiToFalcorMeshId;
         aiNode* pRoot = pScene->mRootNode;
-        return parseAiSceneNode(pRoot, pScene, aiToFalcorMeshId);
+
+        // Find the meshes used by the scene graph. Keep the traversal order, so meshes are created in the same order as the nodes reference them
+        std::vector<bool> isCollected(pScene->mNumMeshes, false);
+        std::vector<uint32_t> meshIds;
+        collectNodeMeshes(pRoot, isCollected, meshIds);
+
+        // Generate the CPU data of all meshes in parallel
+        std::vector<MeshData> meshData(meshIds.size());
+        {
+            PROFILE_CPU("AssimpModelImporter::prepareMeshes");
+            TaskScheduler::getDefault()->parallelFor(0, (uint32_t)meshIds.size(), [&](uint32_t i) { prepareMesh(pScene->mMeshes[meshIds[i]], meshData[i]); });
+        }
+
+        // Create the GPU resources. Release the CPU data as we go to keep the peak memory usage down
+        IdToMesh aiToFalcorMesh;
+        {
+            PROFILE_CPU("AssimpModelImporter::createMeshes");
+            for (size_t i = 0; i < meshIds.size(); i++)
+            {
+                aiToFalcorMesh[meshIds[i]] = createMesh(meshData[i]);
+                meshData[i] = MeshData();
+            }
+        }
+
+        return parseAiSceneNode(pRoot, pScene, aiToFalcorMesh);
     }
 
-    bool AssimpModelImporter::initModel(const std::string& filename)
+    /** Holds the Assimp importer, which owns the parsed and post-processed scene
+    */
+    class AssimpDecodedFile : public Model::DecodedFile
     {
+    public:
+        AssimpDecodedFile(const std::string& filename, Model::LoadFlags flags) : DecodedFile(filename, flags) {}
+        using DecodedFile::setError;
+
         std::string fullpath;
-        if (findFileInDataDirectories(filename, fullpath) == false)
+        Assimp::Importer importer;
+        const aiScene* pScene = nullptr;
+    };
+
+    static const char* kImportCacheFormat = "assbin";
+    static const uint32_t kImportCacheVersion = 1;
+
+    /** Get the name of the file caching the post-processed scene. The key includes the file's modification time, so editing the file invalidates the entry.
+        It also includes the post-processing flags and the Assimp build, since both change the imported scene
+    */
+    static std::string getImportCacheFilename(const std::string& fullpath, uint32_t assimpFlags)
+    {
+        const uint32_t assimpBuild[] = { aiGetVersionMajor(), aiGetVersionMinor(), aiGetVersionRevision(), aiGetCompileFlags() };
+        uint64_t modifiedTime = (uint64_t)getFileModifiedTime(fullpath);
+        uint64_t key = hashData(fullpath.data(), fullpath.size());
+        key = hashData(&modifiedTime, sizeof(modifiedTime), key);
+        key = hashData(&assimpFlags, sizeof(assimpFlags), key);
+        key = hashData(assimpBuild, sizeof(assimpBuild), key);
+        key = hashData(&kImportCacheVersion, sizeof(kImportCacheVersion), key);
+
+        char keyString[17];
+        snprintf(keyString, sizeof(keyString), "%016llx", (unsigned long long)key);
+        return Model::getImportCacheDirectory() + '/' + getFilenameFromPath(fullpath) + "_" + keyString + "." + kImportCacheFormat;
+    }
+
+    /** Write the post-processed scene to the cache. The scene is written to a temporary file first, so other threads and processes never see a partial file
+    */
+    static void storeImportCache(const aiScene* pScene, const std::string& cacheFilename)
+    {
+        std::string directory = getDirectoryFromFile(cacheFilename);
+        if (isDirectoryExists(directory) == false && createDirectory(directory) == false)
         {
-            logError(std::string("Can't find model file ") + filename, true);
-            return false;
+            logWarning("AssimpModelImporter: Can't create the model cache directory '" + directory + "'");
+            return;
+        }
+
+        std::string tempFilename = cacheFilename + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        Assimp::Exporter exporter;
+        if (exporter.Export(pScene, kImportCacheFormat, tempFilename) != AI_SUCCESS)
+        {
+            logWarning("AssimpModelImporter: Can't write the model cache file '" + cacheFilename + "'\n" + exporter.GetErrorString());
+            std::remove(tempFilename.c_str());
+            return;
+        }
+
+        // Another thread might have stored the same entry in the meantime, in which case the rename fails and the existing file is kept
+        if (std::rename(tempFilename.c_str(), cacheFilename.c_str()) != 0)
+        {
+            std::remove(tempFilename.c_str());
+        }
+    }
+
+    Model::DecodedFile::SharedPtr AssimpModelImporter::decode(const std::string& filename, Model::LoadFlags flags)
+    {
+        auto pFile = std::make_shared<AssimpDecodedFile>(filename, flags);
+        if (findFileInDataDirectories(filename, pFile->fullpath) == false)
+        {
+            pFile->setError(std::string("Can't find model file ") + filename);
+            return pFile;
         }
 
         uint32_t assimpFlags = aiProcessPreset_TargetRealtime_MaxQuality |
@@ -521,25 +647,59 @@ namespace Falcor
             aiProcess_FlipUVs |
             0;
 
-        if(is_set(mFlags, Model::LoadFlags::FindDegeneratePrimitives) == false) assimpFlags &= ~aiProcess_FindDegenerates;
-        if(is_set(mFlags, Model::LoadFlags::DontMergeMeshes))                   assimpFlags &= ~aiProcess_OptimizeMeshes; // Avoid merging original meshes
-        if(is_set(mFlags, Model::LoadFlags::RemoveInstancing))                  assimpFlags |= aiProcess_PreTransformVertices;
+        if(is_set(flags, Model::LoadFlags::FindDegeneratePrimitives) == false) assimpFlags &= ~aiProcess_FindDegenerates;
+        if(is_set(flags, Model::LoadFlags::DontMergeMeshes))                   assimpFlags &= ~aiProcess_OptimizeMeshes; // Avoid merging original meshes
+        if(is_set(flags, Model::LoadFlags::RemoveInstancing))                  assimpFlags |= aiProcess_PreTransformVertices;
+        if(is_set(flags, Model::LoadFlags::OptimizeMeshes))                    assimpFlags &= ~aiProcess_ImproveCacheLocality; // Done by MeshOptimizer after the import
 
         // Never use Assimp's tangent gen code
         assimpFlags &= ~(aiProcess_CalcTangentSpace);
 
-        Assimp::Importer importer;
-        const aiScene* pScene = importer.ReadFile(fullpath, assimpFlags);
+        // The cached scene is already post-processed, so it's read without any post-processing steps
+        std::string cacheFilename;
+        const bool useCache = is_set(flags, Model::LoadFlags::CacheImportedScene);
+        if (useCache)
+        {
+            cacheFilename = getImportCacheFilename(pFile->fullpath, assimpFlags);
+            if (doesFileExist(cacheFilename))
+            {
+                pFile->pScene = pFile->importer.ReadFile(cacheFilename, 0);
+                if (pFile->pScene) return pFile;
+                logWarning("AssimpModelImporter: Can't read the model cache file '" + cacheFilename + "'. Importing '" + filename + "' instead");
+            }
+        }
+
+        pFile->pScene = pFile->importer.ReadFile(pFile->fullpath, assimpFlags);
+        if (pFile->pScene == nullptr)
+        {
+            pFile->setError(std::string("Can't open model file '") + filename + "'\n" + pFile->importer.GetErrorString());
+        }
+        else if (useCache)
+        {
+            storeImportCache(pFile->pScene, cacheFilename);
+        }
+        return pFile;
+    }
+
+    bool AssimpModelImporter::initModel(const Model::DecodedFile* pDecodedFile)
+    {
+        const AssimpDecodedFile* pFile = static_cast<const AssimpDecodedFile*>(pDecodedFile);
+        const std::string& filename = pFile->getFilename();
+        if (pFile->isValid() == false)
+        {
+            logError(pFile->getError(), true);
+            return false;
+        }
 
-        if((pScene == nullptr) || (verifyScene(pScene) == false))
+        const aiScene* pScene = pFile->pScene;
+        if (verifyScene(pScene) == false)
         {
-            std::string str("Can't open model file '");
-            str = str + std::string(filename) + "'\n" + importer.GetErrorString();
-            logError(str, true);
+            logError(std::string("Can't open model file '") + filename + "'\n", true);
             return false;
         }
 
         // Extract the folder name
+        const std::string& fullpath = pFile->fullpath;
         auto last = fullpath.find_last_of("/\\");
         std::string modelFolder = fullpath.substr(0, last);
 
@@ -561,10 +721,16 @@ namespace Falcor
         return true;
     }
 
+    bool AssimpModelImporter::import(Model& model, const Model::DecodedFile* pFile)
+    {
+        AssimpModelImporter loader(model, pFile->getLoadFlags());
+        return loader.initModel(pFile);
+    }
+
     bool AssimpModelImporter::import(Model& model, const std::string& filename, Model::LoadFlags flags)
     {
-        AssimpModelImporter loader(model, flags);
-        return loader.initModel(filename);
+        auto pFile = decode(filename, flags);
+        return import(model, pFile.get());
     }
 
     bool AssimpModelImporter::isUsedNode(const aiNode* pNode) const
@@ -680,9 +846,11 @@ namespace Falcor
         {
             auto pAnimCtrl = AnimationController::create(mBones);
 
+            Animation::Compression compression;
+            const Animation::Compression* pCompression = is_set(mFlags, Model::LoadFlags::CompressAnimations) ? &compression : nullptr;
             for (uint32_t i = 0; i < pScene->mNumAnimations; i++)
             {
-                Animation::UniquePtr pAnimation = createAnimation(pScene->mAnimations[i]);
+                Animation::UniquePtr pAnimation = createAnimation(pScene->mAnimations[i], mBoneNameToIdMap, pCompression);
                 pAnimCtrl->addAnimation(std::move(pAnimation));
             }
 
@@ -691,7 +859,43 @@ namespace Falcor
     }
 
 
-    Animation::UniquePtr AssimpModelImporter::createAnimation(const aiAnimation* pAiAnim)
+    std::vector<Animation::UniquePtr> AssimpModelImporter::importAnimations(const std::string& filename, const Animation::Compression* pCompression)
+    {
+        std::vector<Animation::UniquePtr> animations;
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false)
+        {
+            logError(std::string("Can't find model file ") + filename);
+            return animations;
+        }
+
+        // Animations don't need any post-processing
+        Assimp::Importer importer;
+        const aiScene* pScene = importer.ReadFile(fullpath, 0);
+        if (pScene == nullptr)
+        {
+            logError(std::string("Can't open model file '") + filename + "'\n" + importer.GetErrorString());
+            return animations;
+        }
+
+        std::map<std::string, uint32_t> boneNameToId;
+        for (uint32_t i = 0; i < pScene->mNumAnimations; i++)
+        {
+            const aiAnimation* pAiAnim = pScene->mAnimations[i];
+            for (uint32_t c = 0; c < pAiAnim->mNumChannels; c++)
+            {
+                boneNameToId.emplace(pAiAnim->mChannels[c]->mNodeName.C_Str(), uint32_t(boneNameToId.size()));
+            }
+        }
+
+        for (uint32_t i = 0; i < pScene->mNumAnimations; i++)
+        {
+            animations.push_back(createAnimation(pScene->mAnimations[i], boneNameToId, pCompression));
+        }
+        return animations;
+    }
+
+    Animation::UniquePtr AssimpModelImporter::createAnimation(const aiAnimation* pAiAnim, const std::map<std::string, uint32_t>& boneNameToId, const Animation::Compression* pCompression)
     {
         assert(pAiAnim->mNumMeshChannels == 0);
         float duration = float(pAiAnim->mDuration);
@@ -709,8 +913,8 @@ namespace Falcor
             const aiNodeAnim* pAiNode = pAiAnim->mChannels[i];
 
             // If the bone is not used, skip it
-            const auto& idIt = mBoneNameToIdMap.find(pAiNode->mNodeName.C_Str());
-            if (idIt == mBoneNameToIdMap.end()) continue;
+            const auto& idIt = boneNameToId.find(pAiNode->mNodeName.C_Str());
+            if (idIt == boneNameToId.end()) continue;
 
             animationSets[i].boneID = idIt->second;
 
@@ -751,7 +955,7 @@ namespace Falcor
             animationSets.end()
         );
 
-        return Animation::create(std::string(pAiAnim->mName.C_Str()), animationSets, duration, ticksPerSecond);
+        return Animation::create(std::string(pAiAnim->mName.C_Str()), animationSets, duration, ticksPerSecond, pCompression);
     }
 
     BoundingBox createMeshBbox(const aiMesh* pAiMesh)
@@ -768,87 +972,173 @@ namespace Falcor
         return BoundingBox::fromMinMax(boxMin, boxMax);
     }
 
-    Mesh::SharedPtr AssimpModelImporter::createMesh(aiMesh* pAiMesh)
+    void AssimpModelImporter::prepareMesh(const aiMesh* pAiMesh, MeshData& data) const
     {
+        data.pAiMesh = pAiMesh;
         uint32_t vertexCount = pAiMesh->mNumVertices;
-        uint32_t indexCount = pAiMesh->mNumFaces * pAiMesh->mFaces[0].mNumIndices;
-        auto pIB = createIndexBuffer(pAiMesh);
-        BoundingBox boundingBox = createMeshBbox(pAiMesh);
+        data.indices = createIndexBufferData(pAiMesh);
+        data.boundingBox = createMeshBbox(pAiMesh);
 
+        // Generate the bitangents into a local array. The scene is shared with other threads and must not be modified
+        std::vector<glm::vec3> generatedBitangents;
         const bool generateTangentSpace = (pAiMesh->HasTangentsAndBitangents() == false) && (is_set(mFlags, Model::LoadFlags::DontGenerateTangentSpace) == false);
         if (generateTangentSpace)
         {
-            genTangentSpace(pAiMesh);
+            genTangentSpace(pAiMesh, data.indices, generatedBitangents);
         }
+        const glm::vec3* pBitangents = generatedBitangents.empty() ? (const glm::vec3*)pAiMesh->mBitangents : generatedBitangents.data();
 
-        VertexLayout::SharedPtr pLayout = createVertexLayout(pAiMesh);
-        if (pLayout == nullptr)
+        data.pLayout = createVertexLayout(pAiMesh, pBitangents != nullptr, data);
+        if (data.pLayout == nullptr)
         {
-            assert(0);
-            return nullptr;
+            return;
         }
 
-        std::vector<Buffer::SharedPtr> pVBs(pLayout->getBufferCount());
-
         // Initialize the bones data
         VertexWeightsVec weights;
         VertexIdsVec ids;
         if (pAiMesh->HasBones())
         {
-            loadBones(pAiMesh, weights, ids, vertexCount, mBoneNameToIdMap);
+            if (loadBones(pAiMesh, weights, ids, vertexCount, mBoneNameToIdMap) == false)
+            {
+                data.messages.push_back({ Logger::Level::Error, "Too many bones" });
+            }
         }
 
-        // Create corresponding vertex buffers
-        for (uint32_t i = 0; i < pLayout->getBufferCount(); i++)
+        // Create the data of the corresponding vertex buffers
+        data.vertexData.resize(data.pLayout->getBufferCount());
+        for (uint32_t i = 0; i < data.pLayout->getBufferCount(); i++)
         {
-            const VertexBufferLayout* pVbLayout = pLayout->getBufferLayout(i).get();
-            pVBs[i] = createVertexBuffer(pAiMesh, pVbLayout, (uint8_t*)ids.data(), weights.data());
+            const VertexBufferLayout* pVbLayout = data.pLayout->getBufferLayout(i).get();
+            if (createVertexBufferData(pAiMesh, pVbLayout, pBitangents, (uint8_t*)ids.data(), weights.data(), data, data.vertexData[i]) == false)
+            {
+                return;
+            }
         }
 
-        Vao::Topology topology = Vao::Topology::TriangleList;
         switch (pAiMesh->mFaces[0].mNumIndices)
         {
         case 1:
-            topology = Vao::Topology::PointList;
+            data.topology = Vao::Topology::PointList;
             break;
         case 2:
-            topology = Vao::Topology::LineList;
+            data.topology = Vao::Topology::LineList;
             break;
         case 3:
-            topology = Vao::Topology::TriangleList;
+            data.topology = Vao::Topology::TriangleList;
             break;
         default:
-            logError(std::string("Error when creating mesh. Unknown topology with " + std::to_string(pAiMesh->mFaces[0].mNumIndices) + " indices."));
+            data.messages.push_back({ Logger::Level::Error, "Error when creating mesh. Unknown topology with " + std::to_string(pAiMesh->mFaces[0].mNumIndices) + " indices." });
             assert(0);
         }
 
-        auto pMaterial = mAiMaterialToFalcor[pAiMesh->mMaterialIndex];
-        assert(pMaterial);
+        const bool isTriangleList = (data.topology == Vao::Topology::TriangleList);
+        const bool optimize = is_set(mFlags, Model::LoadFlags::OptimizeMeshes) && isTriangleList;
+        const uint32_t indexCount = (uint32_t)data.indices.size();
+        MeshOptimizer::CacheStats before;
+        if (optimize)
+        {
+            before = MeshOptimizer::analyzeVertexCache(data.indices.data(), indexCount, vertexCount);
+            auto clusters = MeshOptimizer::optimizeVertexCache(data.indices.data(), indexCount, vertexCount);
+            MeshOptimizer::optimizeOverdraw(data.indices.data(), indexCount, clusters, pAiMesh->mVertices, sizeof(aiVector3D), vertexCount);
+        }
 
-        Mesh::SharedPtr pMesh = Mesh::create(pVBs, vertexCount, pIB, indexCount, pLayout, topology, pMaterial, boundingBox, pAiMesh->HasBones());
+        // Split the full-resolution mesh into meshlets. The bounds of skinned meshes change every frame, so they are skipped
+        if (is_set(mFlags, Model::LoadFlags::GenerateMeshlets) && isTriangleList && (pAiMesh->HasBones() == false))
+        {
+            data.meshlets = MeshletBuilder::build(data.indices.data(), indexCount, pAiMesh->mVertices, sizeof(aiVector3D), vertexCount);
+        }
 
-        if (generateTangentSpace)
+        // The levels of detail are appended to the full-resolution indices
+        if (is_set(mFlags, Model::LoadFlags::GenerateLods) && isTriangleList)
         {
-            safe_delete_array(pAiMesh->mBitangents);
+            auto lods = MeshSimplifier::generateLodChain(data.indices.data(), indexCount, pAiMesh->mVertices, sizeof(aiVector3D), vertexCount, Mesh::kMaxLodCount - 1);
+            for (auto& lod : lods)
+            {
+                if (optimize) MeshOptimizer::optimizeVertexCache(lod.indices.data(), (uint32_t)lod.indices.size(), vertexCount);
+                Mesh::Lod range;
+                range.startIndex = (uint32_t)data.indices.size();
+                range.indexCount = (uint32_t)lod.indices.size();
+                range.error = lod.error;
+                data.lods.push_back(range);
+                data.indices.insert(data.indices.end(), lod.indices.begin(), lod.indices.end());
+            }
         }
 
-        return pMesh;
+        if (optimize)
+        {
+            // The levels of detail only reference vertices of the full-resolution mesh, so the vertices end up in the order the full-resolution mesh uses them
+            auto remap = MeshOptimizer::optimizeVertexFetch(data.indices.data(), (uint32_t)data.indices.size(), vertexCount);
+            for (uint32_t i = 0; i < data.pLayout->getBufferCount(); i++)
+            {
+                MeshOptimizer::remapVertexBuffer(remap, data.pLayout->getBufferLayout(i)->getStride(), data.vertexData[i]);
+            }
+            auto after = MeshOptimizer::analyzeVertexCache(data.indices.data(), indexCount, vertexCount);
+            data.messages.push_back({ Logger::Level::Info, "Optimized mesh '" + std::string(pAiMesh->mName.C_Str()) + "'. ACMR " + std::to_string(before.acmr) + " -> " + std::to_string(after.acmr) +
+                ", ATVR " + std::to_string(before.atvr) + " -> " + std::to_string(after.atvr) });
+        }
     }
 
-    Buffer::SharedPtr AssimpModelImporter::createIndexBuffer(const aiMesh* pAiMesh)
+    Mesh::SharedPtr AssimpModelImporter::createMesh(const MeshData& data)
+    {
+        bool isFatal = false;
+        for (const auto& m : data.messages)
+        {
+            switch (m.level)
+            {
+            case Logger::Level::Info:
+                logInfo(m.msg);
+                break;
+            case Logger::Level::Warning:
+                logWarning(m.msg);
+                break;
+            case Logger::Level::Fatal:
+                isFatal = true;
+                // fall through
+            default:
+                logError(m.msg);
+            }
+        }
+
+        if (isFatal)
+        {
+            logErrorAndExit("AssimpModelImporter: Can't create mesh");
+        }
+
+        if (data.pLayout == nullptr)
+        {
+            assert(0);
+            return nullptr;
+        }
+
+        const aiMesh* pAiMesh = data.pAiMesh;
+        uint32_t vertexCount = pAiMesh->mNumVertices;
+        uint32_t indexCount = data.lods.empty() ? (uint32_t)data.indices.size() : data.lods[0].startIndex;
+        auto pIB = Buffer::create((uint32_t)(sizeof(uint32_t) * data.indices.size()), getBufferBindFlags(Buffer::BindFlags::Index), Buffer::CpuAccess::None, data.indices.data());
+
+        std::vector<Buffer::SharedPtr> pVBs(data.pLayout->getBufferCount());
+        for (uint32_t i = 0; i < data.pLayout->getBufferCount(); i++)
+        {
+            const std::vector<uint8_t>& initData = data.vertexData[i];
+            pVBs[i] = Buffer::create((uint32_t)initData.size(), getBufferBindFlags(Buffer::BindFlags::Vertex), Buffer::CpuAccess::None, initData.data());
+        }
+
+        auto pMaterial = mAiMaterialToFalcor[pAiMesh->mMaterialIndex];
+        assert(pMaterial);
+
+        return Mesh::create(pVBs, vertexCount, pIB, indexCount, data.pLayout, data.topology, pMaterial, data.boundingBox, pAiMesh->HasBones(), data.lods, data.meshlets);
+    }
+
+    Buffer::BindFlags AssimpModelImporter::getBufferBindFlags(Buffer::BindFlags bindFlags) const
     {
-        std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
-        const uint32_t size = (uint32_t)(sizeof(uint32_t) * indices.size());
-        Buffer::BindFlags bindFlags = Buffer::BindFlags::Index;
         if (is_set(mFlags, Model::LoadFlags::BuffersAsShaderResource))
         {
             bindFlags |= Buffer::BindFlags::ShaderResource;
         }
-        return Buffer::create(size, bindFlags, Buffer::CpuAccess::None, indices.data());;
+        return bindFlags;
     }
 
-
-    bool isElementUsed(const aiMesh* pAiMesh, uint32_t location)
+    bool isElementUsed(const aiMesh* pAiMesh, uint32_t location, bool hasBitangents)
     {
         switch (location)
         {
@@ -857,7 +1147,7 @@ namespace Falcor
         case VERTEX_NORMAL_LOC:
             return pAiMesh->HasNormals();
         case VERTEX_BITANGENT_LOC:
-            return (pAiMesh->mBitangents != nullptr); // ASSIMP doesn't have a function that checks only for bitangents
+            return hasBitangents; // Either loaded by ASSIMP or generated by us
         case VERTEX_BONE_WEIGHT_LOC:
         case VERTEX_BONE_ID_LOC:
             return pAiMesh->HasBones();
@@ -875,26 +1165,26 @@ namespace Falcor
         }
     }
 
-    VertexLayout::SharedPtr AssimpModelImporter::createVertexLayout(const aiMesh* pAiMesh)
+    VertexLayout::SharedPtr AssimpModelImporter::createVertexLayout(const aiMesh* pAiMesh, bool hasBitangents, MeshData& data) const
     {
         static const uint32_t kMaxSupportedUVs = 2;
         // Must have position!!!
         if (pAiMesh->HasPositions() == false)
         {
-            logError("AssimpModelImporter: Loaded mesh with no positions!");
+            data.messages.push_back({ Logger::Level::Error, "AssimpModelImporter: Loaded mesh with no positions!" });
             return nullptr;
         }
 
         if (pAiMesh->GetNumUVChannels() > kMaxSupportedUVs)
         {
-            logWarning("AssimpModelImporter: Loaded mesh with more then " + std::to_string(kMaxSupportedUVs) + " UV channels. Ignoring extra UVs");
+            data.messages.push_back({ Logger::Level::Warning, "AssimpModelImporter: Loaded mesh with more then " + std::to_string(kMaxSupportedUVs) + " UV channels. Ignoring extra UVs" });
         }
 
         for (uint32_t i = 0; i < min(pAiMesh->GetNumUVChannels(), kMaxSupportedUVs); i++)
         {
             if (pAiMesh->HasTextureCoords(i) == false)
             {
-                logError("AssimpModelImporter: Unsupported texture coordinate set used in model.");
+                data.messages.push_back({ Logger::Level::Error, "AssimpModelImporter: Unsupported texture coordinate set used in model." });
                 return nullptr;
             }
         }
@@ -904,7 +1194,7 @@ namespace Falcor
         uint32_t bufferCount = 0;
         for (uint32_t location = 0; location < VERTEX_LOCATION_COUNT; ++location)
         {
-            if (isElementUsed(pAiMesh, location))
+            if (isElementUsed(pAiMesh, location, hasBitangents))
             {
                 VertexBufferLayout::SharedPtr pVbLayout = VertexBufferLayout::create();
                 pVbLayout->addElement(kLayoutData[location].name, 0, kLayoutData[location].format, 1, location);
@@ -916,10 +1206,10 @@ namespace Falcor
         return pLayout;
     }
 
-    Buffer::SharedPtr AssimpModelImporter::createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights)
+    bool AssimpModelImporter::createVertexBufferData(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const glm::vec3* pBitangents, const uint8_t* pBoneIds, const vec4* pBoneWeights, MeshData& data, std::vector<uint8_t>& initData) const
     {
         const uint32_t vertexStride = pLayout->getStride();
-        std::vector<uint8_t> initData(vertexStride * pAiMesh->mNumVertices, 0);
+        initData.assign(vertexStride * pAiMesh->mNumVertices, 0);
 
         for (uint32_t vertexID = 0; vertexID < pAiMesh->mNumVertices; vertexID++)
         {
@@ -944,8 +1234,8 @@ namespace Falcor
                     size = sizeof(pAiMesh->mNormals[0]);
                     break;
                 case VERTEX_BITANGENT_LOC:
-                    pSrc = (uint8_t*)(&pAiMesh->mBitangents[vertexID]);
-                    size = sizeof(pAiMesh->mBitangents[0]);
+                    pSrc = (uint8_t*)(&pBitangents[vertexID]);
+                    size = sizeof(pBitangents[0]);
                     break;
                 case VERTEX_DIFFUSE_COLOR_LOC:
                     pSrc = (uint8_t*)(&pAiMesh->mColors[0][vertexID]);
@@ -954,7 +1244,8 @@ namespace Falcor
                 case VERTEX_TEXCOORD_LOC:
                     if (pAiMesh->mTextureCoords[0][vertexID].z != 0.f)
                     {
-                        Falcor::logErrorAndExit("AssimpModelImporter::createVertexBuffer: Texcoord[0].z != 0.0");
+                        data.messages.push_back({ Logger::Level::Fatal, "AssimpModelImporter::createVertexBufferData: Texcoord[0].z != 0.0" });
+                        return false;
                     }
                     pSrc = (uint8_t*)(&pAiMesh->mTextureCoords[0][vertexID]);
                     size = sizeof(pAiMesh->mTextureCoords[0][vertexID]);
@@ -962,7 +1253,8 @@ namespace Falcor
                 case VERTEX_LIGHTMAP_UV_LOC:
                     if (pAiMesh->mTextureCoords[1][vertexID].z != 0.f)
                     {
-                        Falcor::logErrorAndExit("AssimpModelImporter::createVertexBuffer: Texcoord[1].z != 0.0");
+                        data.messages.push_back({ Logger::Level::Fatal, "AssimpModelImporter::createVertexBufferData: Texcoord[1].z != 0.0" });
+                        return false;
                     }
                     pSrc = (uint8_t*)(&pAiMesh->mTextureCoords[1][vertexID]);
                     size = sizeof(pAiMesh->mTextureCoords[1][vertexID]);
@@ -983,12 +1275,6 @@ namespace Falcor
                 memcpy(pDst, pSrc, size);
             }
         }
-        Buffer::BindFlags bindFlags = Buffer::BindFlags::Vertex;
-        if (is_set(mFlags, Model::LoadFlags::BuffersAsShaderResource))
-        {
-            bindFlags |= Buffer::BindFlags::ShaderResource;
-        }
-
-        return Buffer::create(vertexStride * pAiMesh->mNumVertices, bindFlags, Buffer::CpuAccess::None, initData.data());;
+        return true;
     }
 }
\ No newline at end of file
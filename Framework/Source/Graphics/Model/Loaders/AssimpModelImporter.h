@@ -65,17 +65,60 @@ namespace Falcor
         */
         static bool import(Model& model, const std::string& filename, Model::LoadFlags flags);
 
+        /** Parse and post-process a model file using ASSIMP. Doesn't create any GPU resources, so it can be called from any thread.
+            \param[in] filename Model's filename. Can include a full path or a relative path from a data directory
+            \param[in] flags Flags controlling model creation
+            \return The decoded file. Check DecodedFile::isValid() for errors
+        */
+        static Model::DecodedFile::SharedPtr decode(const std::string& filename, Model::LoadFlags flags);
+
+        /** Create the model's GPU resources from a file decoded with decode()
+            \param[out] model Model object to load into
+            \param[in] pFile The decoded file
+            \return Whether import succeeded
+        */
+        static bool import(Model& model, const Model::DecodedFile* pFile);
+
+        /** Load only the animations of a file, without creating a model. Bone IDs are assigned in the order the animated nodes first appear in the file's animations.
+            Useful for tools and benchmarks which process animation clips.
+            \param[in] filename The file's name. Can include a full path or a relative path from a data directory
+            \param[in] pCompression Clip compression settings, or nullptr to keep the keys as is
+            \return The animations, or an empty list if the file can't be loaded
+        */
+        static std::vector<Animation::UniquePtr> importAnimations(const std::string& filename, const Animation::Compression* pCompression);
+
     private:
 
         using IdToMesh = std::unordered_map<uint32_t, Mesh::SharedPtr>;
 
+        /** CPU-side data of a single mesh. Created on worker threads by prepareMesh() and turned into a Falcor mesh by createMesh()
+        */
+        struct MeshData
+        {
+            struct Message
+            {
+                Logger::Level level;
+                std::string msg;
+            };
+
+            const aiMesh* pAiMesh = nullptr;
+            std::vector<uint32_t> indices;                  // The full-resolution indices, followed by the indices of the levels of detail
+            std::vector<Mesh::Lod> lods;                    // Simplified levels of detail, not including the full-resolution mesh
+            std::vector<Meshlet> meshlets;                  // Meshlets of the full-resolution indices
+            std::vector<std::vector<uint8_t>> vertexData;   // One entry per buffer in the layout
+            VertexLayout::SharedPtr pLayout;
+            BoundingBox boundingBox;
+            Vao::Topology topology = Vao::Topology::TriangleList;
+            std::vector<Message> messages;                  // Logged by createMesh(), since the logger may show a message box
+        };
+
         AssimpModelImporter(Model& model, Model::LoadFlags flags);
         AssimpModelImporter(const AssimpModelImporter&) = delete;
         void operator=(const AssimpModelImporter&) = delete;
 
-        bool initModel(const std::string& filename);
+        bool initModel(const Model::DecodedFile* pFile);
         bool createDrawList(const aiScene* pScene);
-        bool parseAiSceneNode(const aiNode* pCurrent, const aiScene* pScene, IdToMesh& aiToFalcorMesh);
+        bool parseAiSceneNode(const aiNode* pCurrent, const aiScene* pScene, const IdToMesh& aiToFalcorMesh);
         bool createAllMaterials(const aiScene* pScene, const std::string& modelFolder, bool isObjFile, bool useSrgb);
 
         void createAnimationController(const aiScene* pScene);
@@ -83,12 +126,14 @@ namespace Falcor
         uint32_t initBone(const aiNode* pNode, uint32_t parentID, uint32_t boneID);
         void initializeBonesOffsetMatrices(const aiScene* pScene);
 
-        Animation::UniquePtr createAnimation(const aiAnimation* pAiAnim);
+        static Animation::UniquePtr createAnimation(const aiAnimation* pAiAnim, const std::map<std::string, uint32_t>& boneNameToId, const Animation::Compression* pCompression);
 
-        Mesh::SharedPtr createMesh(aiMesh* pAiMesh);
-        VertexLayout::SharedPtr createVertexLayout(const aiMesh* pAiMesh);
-        Buffer::SharedPtr createIndexBuffer(const aiMesh* pAiMesh);
-        Buffer::SharedPtr createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights);
+        // Doesn't access the device or modify the importer, so it can run concurrently for different meshes
+        void prepareMesh(const aiMesh* pAiMesh, MeshData& data) const;
+        Mesh::SharedPtr createMesh(const MeshData& data);
+        VertexLayout::SharedPtr createVertexLayout(const aiMesh* pAiMesh, bool hasBitangents, MeshData& data) const;
+        bool createVertexBufferData(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const glm::vec3* pBitangents, const uint8_t* pBoneIds, const vec4* pBoneWeights, MeshData& data, std::vector<uint8_t>& initData) const;
+        Buffer::BindFlags getBufferBindFlags(Buffer::BindFlags bindFlags) const;
         void loadTextures(const aiMaterial* pAiMaterial, const std::string& folder, Material* pMaterial, bool isObjFile, bool useSrgb);
         Material::SharedPtr createMaterial(const aiMaterial* pAiMaterial, const std::string& folder, bool isObjFile, bool useSrgb);
 
@@ -220,7 +220,7 @@ namespace Falcor
     bool BinaryModelExporter::writeHeader()
     {
         mStream.write("BinScene", 8);
-        mStream << (int32_t)8 << (int32_t)mpModel->getTextureCount() << (int32_t)mMeshes.size() << (int32_t)mInstanceCount;
+        mStream << (int32_t)9 << (int32_t)mpModel->getTextureCount() << (int32_t)mMeshes.size() << (int32_t)mInstanceCount;
         return true;
     }
 
@@ -346,8 +346,17 @@ namespace Falcor
         mStream << (int32_t)primCount;
 
         // Output the index buffer
-        const void* pIndices = pMesh->getVao()->getIndexBuffer()->map(Buffer::MapType::Read);
+        const uint32_t* pIndices = (const uint32_t*)pMesh->getVao()->getIndexBuffer()->map(Buffer::MapType::Read);
         mStream.write(pIndices, indexCount * sizeof(uint32_t));
+
+        // Output the levels of detail, which are stored after the full-resolution indices
+        mStream << (int32_t)(pMesh->getLodCount() - 1);
+        for(uint32_t i = 1; i < pMesh->getLodCount(); i++)
+        {
+            const Mesh::Lod& lod = pMesh->getLod(i);
+            mStream << lod.error << (int32_t)(lod.indexCount / 3);
+            mStream.write(pIndices + lod.startIndex, lod.indexCount * sizeof(uint32_t));
+        }
         pMesh->getVao()->getIndexBuffer()->unmap();
 
         return true;
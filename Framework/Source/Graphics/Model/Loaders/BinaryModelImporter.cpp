@@ -30,6 +30,10 @@
 #include "BinaryModelSpec.h"
 #include "../Model.h"
 #include "../Mesh.h"
+#include "../TangentSpace.h"
+#include "../MeshOptimizer.h"
+#include "../MeshSimplifier.h"
+#include "../Meshlet.h"
 #include "Utils/Platform/OS.h"
 #include "API/VertexLayout.h"
 #include "Data/VertexAttrib.h"
@@ -38,9 +42,13 @@
 #include "API/Formats.h"
 #include "API/Texture.h"
 #include "Graphics/Material/Material.h"
+#include "Graphics/TextureHelper.h"
+#include "Graphics/TextureStreamer.h"
 #include "API/Device.h"
+#include "Utils/Platform/MemoryMappedFile.h"
 #include <numeric>
 #include <cstring>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -49,129 +57,11 @@ namespace Falcor
         uint32_t width  = 0;
         uint32_t height = 0;
         ResourceFormat format = ResourceFormat::Unknown;
-        std::vector<uint8_t> data;
+        uint32_t bpp = 0;
+        const uint8_t* pData = nullptr;     ///< Points directly into the file data
         std::string name;
     };
 
-    bool isSpecialFloat(float f)
-    {
-        uint32_t d = *(uint32_t*)&f;
-        // Check the exponent
-        d = (d >> 23) & 0xff;
-        return d == 0xff;
-    }
-
-    static vec3 projectNormalToBitangent(const vec3& normal)
-    {
-        vec3 bitangent;
-        if (abs(normal.x) > abs(normal.y))
-        {
-            bitangent = vec3(normal.z, 0.f, -normal.x) / length(vec2(normal.x, normal.z));
-        }
-        else
-        {
-            bitangent = vec3(0.f, normal.z, -normal.y) / length(vec2(normal.y, normal.z));
-        }
-        return normalize(bitangent);
-    }
-
-    static bool isInvalidVec(const vec3& v)
-    {
-        return isSpecialFloat(v.x) || isSpecialFloat(v.y) || isSpecialFloat(v.z);
-    }
-
-    template<typename posType>
-    void generateSubmeshTangentData(
-        const std::vector<uint32_t>& indices,
-        uint32_t vertexCount,
-        const posType* vertexPosData,
-        const glm::vec3* vertexNormalData,
-        const glm::vec2* texCrdData,
-        uint32_t texCrdCount,
-        glm::vec3* bitangentData)
-    {
-        std::memset(bitangentData, 0, vertexCount * sizeof(vec3));
-
-        // calculate the tangent and bitangent for every face
-        size_t primCount = indices.size() / 3;
-        for(size_t primID = 0; primID < primCount; primID++)
-        {
-            struct Data
-            {
-                posType position;
-                glm::vec3 normal;
-                glm::vec2 uv;
-            };
-            Data V[3];
-
-            // Get the data
-            for(uint32_t i = 0; i < 3; i++)
-            {
-                uint32_t index = indices[primID * 3 + i];
-                V[i].position = vertexPosData[index];
-                V[i].normal = vertexNormalData[index];
-                V[i].uv = texCrdData ? texCrdData[index * texCrdCount] : vec2(0);
-            }
-
-            // Position delta
-            posType posDelta[2];
-            posDelta[0] = V[1].position - V[0].position;
-            posDelta[1] = V[2].position - V[0].position;
-
-            // Texture offset
-            glm::vec2 s = V[1].uv - V[0].uv;
-            glm::vec2 t = V[2].uv - V[0].uv;
-
-            glm::vec3 tangent;
-            glm::vec3 bitangent;
-
-            // when t1, t2, t3 in same position in UV space, just use default UV direction.
-            if((s == glm::vec2(0, 0)) || (t == glm::vec2(0, 0)))
-            {
-                const glm::vec3 &normal = V[0].normal;
-                bitangent = projectNormalToBitangent(normal);
-                tangent = cross(bitangent, normal);
-            }
-            else
-            {
-                float dirCorrection = 1.0f / (s.x * t.y - s.y * t.x);
-
-                // tangent points in the direction where to positive X axis of the texture coord's would point in model space
-                // bitangent's points along the positive Y axis of the texture coord's, respectively
-                tangent   = (posDelta[0] * t.y - posDelta[1] * t.x) * dirCorrection;
-                bitangent = (posDelta[1] * s.x - posDelta[0] * s.y) * dirCorrection;
-            }
-
-            // store for every vertex of that face
-            for(uint32_t i = 0; i < 3; i++)
-            {
-                // project tangent and bitangent into the plane formed by the vertex' normal
-                glm::vec3 localTangent = tangent - V[i].normal * (glm::dot(tangent, V[i].normal));
-                localTangent = glm::normalize(localTangent);
-                glm::vec3 localBitangent = bitangent - V[i].normal * (glm::dot(bitangent, V[i].normal));
-                localBitangent = glm::normalize(localBitangent);
-                localBitangent = localBitangent - localTangent * (glm::dot(localBitangent, localTangent));
-                localBitangent = glm::normalize(localBitangent);
-
-                if (isInvalidVec(bitangent) == false)
-                {
-                    // and write it into the mesh
-                    uint32_t index = indices[primID * 3 + i];
-                    bitangentData[index] += normalize(localBitangent);
-                }
-            }
-        }
-
-        for (uint32_t v = 0; v < vertexCount; v++)
-        {
-            bitangentData[v] = normalize(bitangentData[v]);
-            if (isInvalidVec(bitangentData[v]))
-            {
-                bitangentData[v] = projectNormalToBitangent(vertexNormalData[v]);
-            }
-        }
-    }
-
     static void setTexture(Material* pMaterial, Texture::SharedPtr pTexture, TextureType texType, const std::string& modelName)
     {
         switch(texType)
@@ -352,7 +242,59 @@ namespace Falcor
         }
     }
 
-    std::string readString(BinaryFileStream& stream)
+    /** The vertices referenced by a submesh, renumbered to [0, vertexCount). The vertex buffers are shared by all the submeshes, so the per-submesh optimizations
+        work on the compacted vertices. Otherwise their cost would be proportional to the entire vertex buffer for every submesh.
+    */
+    struct CompactSubmesh
+    {
+        std::vector<uint32_t> localToGlobal;
+        std::unordered_map<uint32_t, uint32_t> globalToLocal;
+        std::vector<uint32_t> indices;      // The submesh indices, in the compacted range
+        std::vector<uint8_t> positions;     // The compacted positions. Empty if the mesh has no positions
+        uint32_t positionStride = 0;
+
+        uint32_t getVertexCount() const { return (uint32_t)localToGlobal.size(); }
+
+        /** Convert indices to the compacted range. Vertices the submesh doesn't reference are appended to the range, without positions
+        */
+        void toLocal(std::vector<uint32_t>& data)
+        {
+            for (auto& index : data)
+            {
+                auto it = globalToLocal.emplace(index, (uint32_t)localToGlobal.size());
+                if (it.second) localToGlobal.push_back(index);
+                index = it.first->second;
+            }
+        }
+
+        /** Convert indices in the compacted range back to the vertex buffer indices
+        */
+        void toGlobal(const uint32_t* pLocal, uint32_t count, uint32_t* pGlobal) const
+        {
+            for (uint32_t i = 0; i < count; i++) pGlobal[i] = localToGlobal[pLocal[i]];
+        }
+    };
+
+    static CompactSubmesh compactSubmesh(const uint32_t* pIndices, uint32_t indexCount, const uint8_t* pPositions, uint32_t positionStride)
+    {
+        CompactSubmesh submesh;
+        submesh.globalToLocal.reserve(indexCount);
+        submesh.indices.assign(pIndices, pIndices + indexCount);
+        submesh.toLocal(submesh.indices);
+
+        if (pPositions)
+        {
+            submesh.positionStride = positionStride;
+            submesh.positions.resize(submesh.localToGlobal.size() * positionStride);
+            for (size_t v = 0; v < submesh.localToGlobal.size(); v++)
+            {
+                std::memcpy(submesh.positions.data() + v * positionStride, pPositions + size_t(submesh.localToGlobal[v]) * positionStride, positionStride);
+            }
+        }
+        return submesh;
+    }
+
+    std::string readString(BinaryMemoryStream& stream)
     {
         int32_t length;
         stream >> length;
@@ -362,7 +304,7 @@ namespace Falcor
         return std::string(charVec.data());
     }
 
-    bool loadBinaryTextureData(BinaryFileStream& stream, const std::string& modelName, TextureData& data)
+    static bool readBinaryImage(BinaryMemoryStream& stream, TextureData& data, std::string& error)
     {
         // ImageHeader.
         char tag[9];
@@ -370,27 +312,24 @@ namespace Falcor
         tag[8] = '\0';
         if(std::string(tag) != "BinImage")
         {
-            std::string msg = "Error when loading model " + modelName + ".\nBinary image header corrupted.";
-            logError(msg);
+            error = "Binary image header corrupted.";
             return false;
         }
 
-        int32_t version;
+        int32_t version = 0;
         stream >> version;
 
         if(version < 1 || version > 2)        
         {
-            std::string msg = "Error when loading model " + modelName + ".\nUnsupported binary image version.";
-            logError(msg);
+            error = "Unsupported binary image version.";
             return false;
         }
 
-        int32_t bpp, numChannels;
+        int32_t bpp = 0, numChannels = 0;
         stream >> data.width >> data.height >> bpp >> numChannels;
         if(data.width < 0 || data.height < 0 || bpp < 0 || numChannels < 0)
         {
-            std::string msg = "Error when loading model " + modelName + ".\nCorrupt binary image version.";
-            logError(msg);
+            error = "Corrupt binary image version.";
             return false;
         }
 
@@ -402,8 +341,7 @@ namespace Falcor
             stream >> formatId >> dataSize;
             if(formatId < 0 || formatId >= FW::ImageFormat::ID_Generic || dataSize < 0)
             {
-                std::string msg = "Error when loading model " + modelName + ".\nCorrupt binary image data (unsupported image format).";
-                logError(msg);
+                error = "Corrupt binary image data (unsupported image format).";
                 return false;
             }
             format = FW::ImageFormat(FW::ImageFormat::ID(formatId));
@@ -420,8 +358,7 @@ namespace Falcor
                 c.fieldOfs < 0 || c.fieldSize <= 0 || c.fieldOfs + c.fieldSize > c.wordSize * 8 ||
                 (cformat == FW::ImageFormat::ChannelFormat_Float && c.fieldSize != 32))
             {
-                std::string msg = "Error when loading model " + modelName + ".\nCorrupt binary image data (unsupported floating point format).";
-                logError(msg);
+                error = "Corrupt binary image data (unsupported floating point format).";
                 return false;
             }
 
@@ -432,8 +369,7 @@ namespace Falcor
 
         if(bpp != format.getBPP())
         {
-            std::string msg = "Error when loading model " + modelName + ".\nCorrupt binary image data (bits/pixel do not match with format).";
-            logError(msg);
+            error = "Corrupt binary image data (bits/pixel do not match with format).";
             return false;
         }
 
@@ -448,73 +384,209 @@ namespace Falcor
         {
             dataSize = bpp * texelCount;
         }
-        size_t storageSize = dataSize;
-        if(bpp == 3)
-            storageSize = 4 * texelCount;
-
-        data.data.resize(storageSize);
-        stream.read(data.data.data(), dataSize);
-
-        // Convert 3-channel 8-bits RGB formats to 4-channel RGBX by adding padding
-        if(bpp == 3)
+        if((size_t)dataSize > stream.getRemainingStreamSize())
         {
-            for(int32_t i=texelCount-1;i>=0;--i)
-            {
-                data.data[i * 4 + 0] = data.data[i * 3 + 0];
-                data.data[i * 4 + 1] = data.data[i * 3 + 1];
-                data.data[i * 4 + 2] = data.data[i * 3 + 2];
-                data.data[i * 4 + 3] = 0xff;
-            }
+            error = "Binary image data is truncated.";
+            return false;
         }
 
+        // Reference the pixels in place. 3-channel images are expanded when the texture is created.
+        data.bpp = bpp;
+        data.pData = (const uint8_t*)stream.readSpan(dataSize);
         return true;
     }
 
-    bool importTextures(std::vector<TextureData>& textures, uint32_t textureCount, BinaryFileStream& stream, const std::string& modelName)
+    static bool importTextures(std::vector<TextureData>& textures, uint32_t textureCount, BinaryMemoryStream& stream, std::string& error)
     {
         textures.assign(textureCount, TextureData());
 
-        bool success = true;
+        // The images are only referenced here. The textures are created when the materials use them
         for(uint32_t i = 0; i < textureCount; i++)
         {
             textures[i].name = readString(stream);
-            if(loadBinaryTextureData(stream, modelName, textures[i]) == false)
+            if(readBinaryImage(stream, textures[i], error) == false)
             {
-                success = false;
-                break;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static Texture::SharedPtr createTexture(const TextureData& data, ResourceFormat format, TextureCompressor::Mode compression)
+    {
+        // Convert 3-channel 8-bits RGB formats to 4-channel RGBX by adding padding
+        std::vector<uint8_t> expanded;
+        const uint8_t* pData = data.pData;
+        if(data.bpp == 3)
+        {
+            const size_t texelCount = (size_t)data.width * data.height;
+            expanded.resize(texelCount * 4);
+            for(size_t i = 0; i < texelCount; i++)
+            {
+                expanded[i * 4 + 0] = pData[i * 3 + 0];
+                expanded[i * 4 + 1] = pData[i * 3 + 1];
+                expanded[i * 4 + 2] = pData[i * 3 + 2];
+                expanded[i * 4 + 3] = 0xff;
             }
+            pData = expanded.data();
         }
 
-        // Flush upload heap after every material so we don't accumulate a ton of memory usage when loading a model with a lot of textures
-        gpDevice->flushAndSync();
-        return success;
+        Texture::SharedPtr pTexture;
+        if(compression != TextureCompressor::Mode::None)
+        {
+            TextureCompressor::Image image;
+            image.width = data.width;
+            image.height = data.height;
+            image.format = format;
+            image.pData = pData;
+            pTexture = createCompressedTexture(image, compression, true);
+        }
+        if(pTexture == nullptr)
+        {
+            pTexture = Texture::create2D(data.width, data.height, format, 1, Texture::kMaxPossible, pData);
+        }
+        pTexture->setSourceFilename(data.name);
+        return pTexture;
     }
 
-    BinaryModelImporter::BinaryModelImporter(const std::string& fullpath) : mModelName(fullpath), mStream(fullpath.c_str(), BinaryFileStream::Mode::Read)
+    // Returns nullptr if the texture can't be streamed, in which case it should be created with all of its mips
+    static Texture::SharedPtr createStreamedTexture(const TextureData& data, ResourceFormat format, const std::shared_ptr<const void>& pFileData)
     {
+        if(TextureStreamer::isSupportedFormat(format) == false || (data.bpp != 3 && data.bpp != 4))
+        {
+            return nullptr;
+        }
+
+        // The streamer reads the mips straight from the mapped file
+        TextureStreamer::Source source;
+        source.name = data.name;
+        source.pData = data.pData;
+        source.pDataOwner = pFileData;
+        source.width = data.width;
+        source.height = data.height;
+        source.bytesPerPixel = data.bpp;
+        source.format = format;
+        return TextureStreamer::getDefault()->addTexture(source);
     }
 
-    bool BinaryModelImporter::import(Model& model, const std::string& filename, Model::LoadFlags flags)
+    static const uint32_t kInvalidBufferIndex = (uint32_t)-1;
+
+    /** Holds a binary model file mapped into memory and the meshes parsed from it. The vertex data is copied out of the file, the images and the unmodified indices are referenced in place
+    */
+    class BinaryDecodedFile : public Model::DecodedFile
     {
+    public:
+        BinaryDecodedFile(const std::string& filename, Model::LoadFlags flags) : DecodedFile(filename, flags) {}
+        using DecodedFile::setError;
+
+        struct BufferData
+        {
+            std::vector<uint8_t> vec;
+            bool shouldSkip = false;
+            uint32_t elementSize = 0;
+        };
+
+        struct SubmeshData
+        {
+            glm::vec4 baseColor;
+            glm::vec4 specularParams;
+            float displacementCoeff = 0;
+            float displacementBias = 0;
+            std::vector<int32_t> textureIDs;        ///< Texture of each slot, -1 if the slot is empty
+            const uint32_t* pFileIndices = nullptr; ///< The indices in the file. Only used if indexData is empty
+            std::vector<uint32_t> indexData;        ///< The indices followed by the levels of detail, if they were modified or the file's indices are unaligned
+            uint32_t indexCount = 0;                ///< Number of full-resolution indices
+            std::vector<Mesh::Lod> lods;
+            std::vector<Meshlet> meshlets;
+            BoundingBox box;
+
+            const uint32_t* getIndices() const { return indexData.empty() ? pFileIndices : indexData.data(); }
+            uint32_t getIndexBufferCount() const { return indexData.empty() ? indexCount : (uint32_t)indexData.size(); }
+        };
+
+        struct MeshData
+        {
+            uint32_t vertexCount = 0;
+            VertexLayout::SharedPtr pLayout;
+            std::vector<BufferData> buffers;
+            uint32_t generatedBitangentIndex = kInvalidBufferIndex;  ///< The bitangent buffer if the tangent space was generated
+            std::vector<SubmeshData> submeshes;
+        };
+
+        struct InstanceData
+        {
+            int32_t meshIdx;
+            glm::mat4 transform;
+        };
+
         std::string fullpath;
-        if(findFileInDataDirectories(filename, fullpath) == false)
+        MemoryMappedFile::SharedPtr pMapping;
+        uint32_t version = 0;
+        std::vector<TextureData> textures;
+        std::vector<MeshData> meshes;
+        std::vector<InstanceData> instances;
+    };
+
+    BinaryModelImporter::BinaryModelImporter(const std::string& fullpath, const void* pData, size_t size, const std::shared_ptr<const void>& pDataOwner) : mModelName(fullpath), mStream(pData, size), mpDataOwner(pDataOwner)
+    {
+    }
+
+    Model::DecodedFile::SharedPtr BinaryModelImporter::decode(const std::string& filename, Model::LoadFlags flags)
+    {
+        auto pFile = std::make_shared<BinaryDecodedFile>(filename, flags);
+        if(findFileInDataDirectories(filename, pFile->fullpath) == false)
+        {
+            pFile->setError(std::string("Can't find model file ") + filename);
+            return pFile;
+        }
+
+        pFile->pMapping = MemoryMappedFile::create(pFile->fullpath);
+        if(pFile->pMapping == nullptr)
         {
-            logError(std::string("Can't find model file ") + filename);
+            pFile->setError(std::string("Can't open model file ") + filename);
+            return pFile;
+        }
+
+        // Reject malformed files here, before any GPU resources are created
+        std::string error;
+        if(validate(pFile->pMapping->getData(), pFile->pMapping->getSize(), error) == false)
+        {
+            pFile->setError("Error when loading model " + pFile->fullpath + ".\n" + error);
+            return pFile;
+        }
+
+        // The meshes are parsed and processed here as well, so that the work runs on the decoding thread
+        BinaryModelImporter loader(pFile->fullpath, pFile->pMapping->getData(), pFile->pMapping->getSize(), pFile->pMapping);
+        loader.decodeModel(*pFile);
+        return pFile;
+    }
+
+    bool BinaryModelImporter::import(Model& model, const Model::DecodedFile* pDecodedFile)
+    {
+        const BinaryDecodedFile* pFile = static_cast<const BinaryDecodedFile*>(pDecodedFile);
+        if(pFile->isValid() == false)
+        {
+            logError(pFile->getError());
             return false;
         }
 
-        BinaryModelImporter loader(fullpath);
-        return loader.importModel(model, flags);
+        BinaryModelImporter loader(pFile->fullpath, pFile->pMapping->getData(), pFile->pMapping->getSize(), pFile->pMapping);
+        return loader.createModel(model, *pFile);
     }
 
-    static bool checkVersion(const std::string& formatID, uint32_t version, const std::string& modelName)
+    bool BinaryModelImporter::import(Model& model, const std::string& filename, Model::LoadFlags flags)
+    {
+        auto pFile = decode(filename, flags);
+        return import(model, pFile.get());
+    }
+
+    static bool checkVersion(const std::string& formatID, uint32_t version, std::string& error)
     {
         if(std::string(formatID) == "BinScene")
         {
-            if(version < 6 || version > 8)
+            if(version < 6 || version > 9)
             {
-                std::string Msg = "Error when loading model " + modelName + ".\nUnsupported binary scene version " + std::to_string(version);
-                logError(Msg);
+                error = "Unsupported binary scene version " + std::to_string(version);
                 return false;
             }
         }
@@ -522,20 +594,38 @@ namespace Falcor
         {
             if(version < 1 || version > 5)
             {
-                std::string Msg = "Error when loading model " + modelName + ".\nUnsupported binary scene version " + std::to_string(version);
-                logError(Msg);
+                error = "Unsupported binary scene version " + std::to_string(version);
                 return false;
             }
         }
         else
         {
-            std::string Msg = "Error when loading model " + modelName + ".\nNot a binary scene file!";
-            logError(Msg);
+            error = "Not a binary scene file!";
             return false;
         }
         return true;
     }
     
+    static void getVersionLayout(uint32_t version, int& numTextureSlots, int& numAttributesType)
+    {
+        numAttributesType = AttribType_AORadius + 1;
+        switch(version)
+        {
+        case 1:     numTextureSlots = 0; break;
+        case 2:     numTextureSlots = TextureType_Alpha + 1; break;
+        case 3:     numTextureSlots = TextureType_Displacement + 1; break;
+        case 4:     numTextureSlots = TextureType_Environment + 1; break;
+        case 5:     numTextureSlots = TextureType_Specular + 1; break;
+        case 6:     numTextureSlots = TextureType_Specular + 1; break;
+        case 7:     numTextureSlots = TextureType_Glossiness + 1; break;
+        case 8:
+        case 9:     numTextureSlots = TextureType_Glossiness + 1; numAttributesType = AttribType_Max; break;
+        default:
+            should_not_get_here();
+            numTextureSlots = 0;
+        }
+    }
+
     ResourceFormat getFormatFromMapType(bool requestSrgb, ResourceFormat originalFormat, TextureType texType)
     {
         if(requestSrgb == false)
@@ -554,40 +644,278 @@ namespace Falcor
         }
     }
     
-    bool BinaryModelImporter::importModel(Model& model, Model::LoadFlags flags)
+    static bool skipString(BinaryMemoryStream& stream)
     {
-        // Format ID and version.
-        char formatID[9];
-        mStream.read(formatID, 8);
-        formatID[8] = '\0';
+        int32_t length = -1;
+        stream >> length;
+        if(length < 0 || (uint32_t)length > stream.getRemainingStreamSize()) return false;
+        stream.skip(length);
+        return true;
+    }
 
-        uint32_t version;
-        mStream >> version;
+    static bool validateIndices(BinaryMemoryStream& stream, uint64_t numIndices, int32_t numVertices, std::string& error)
+    {
+        if(numIndices * sizeof(uint32_t) > stream.getRemainingStreamSize())
+        {
+            error = "File is truncated.";
+            return false;
+        }
 
-        // Check if the version matches
-        if(checkVersion(formatID, version, mModelName) == false)
+        // The indices are used to address the vertex data on the CPU, so make sure they are in range
+        const uint8_t* pIndices = (const uint8_t*)stream.readSpan(size_t(numIndices * sizeof(uint32_t)));
+        for(uint64_t i = 0; i < numIndices; i++)
+        {
+            uint32_t index;
+            std::memcpy(&index, pIndices + i * sizeof(uint32_t), sizeof(uint32_t));
+            if(index >= (uint32_t)numVertices)
+            {
+                error = "Mesh index " + std::to_string(index) + " is out of range.";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool BinaryModelImporter::validate(const void* pData, size_t size, std::string& error)
+    {
+        BinaryMemoryStream stream(pData, size);
+        const std::string truncated = "File is truncated.";
+        const std::string corrupted = "File is corrupted.";
+
+        // Format ID and version
+        const char* pFormatID = (const char*)stream.readSpan(8);
+        uint32_t version = 0;
+        stream >> version;
+        if(stream.isFail())
         {
+            error = truncated;
+            return false;
+        }
+
+        const std::string formatID(pFormatID, 8);
+        if(formatID == "BinScene")
+        {
+            if(version < 6 || version > 9)
+            {
+                error = "Unsupported binary scene version " + std::to_string(version);
+                return false;
+            }
+        }
+        else if(formatID == "BinMesh ")
+        {
+            if(version < 1 || version > 5)
+            {
+                error = "Unsupported binary scene version " + std::to_string(version);
+                return false;
+            }
+        }
+        else
+        {
+            error = "Not a binary scene file!";
             return false;
         }
 
         int numTextureSlots;
-        int numAttributesType = AttribType_AORadius + 1;
+        int numAttributesType;
+        getVersionLayout(version, numTextureSlots, numAttributesType);
 
-        switch(version)
+        // File header
+        int32_t numTextures = 0;
+        int32_t numMeshes = 1;
+        int32_t numInstances = 0;
+        int32_t numAttribs_v5 = 0;
+        int32_t numVertices_v5 = 0;
+        int32_t numSubmeshes_v5 = 0;
+
+        if(version >= 6)
         {
-        case 1:     numTextureSlots = 0; break;
-        case 2:     numTextureSlots = TextureType_Alpha + 1; break;
-        case 3:     numTextureSlots = TextureType_Displacement + 1; break;
-        case 4:     numTextureSlots = TextureType_Environment + 1; break;
-        case 5:     numTextureSlots = TextureType_Specular + 1; break;
-        case 6:     numTextureSlots = TextureType_Specular + 1; break;
-        case 7:     numTextureSlots = TextureType_Glossiness + 1; break;
-        case 8:     numTextureSlots = TextureType_Glossiness + 1; numAttributesType = AttribType_Max; break;
-        default:
-            should_not_get_here();
+            stream >> numTextures >> numMeshes >> numInstances;
+        }
+        else
+        {
+            stream >> numAttribs_v5 >> numVertices_v5;
+            if(version >= 2)
+            {
+                stream >> numTextures;
+            }
+            stream >> numSubmeshes_v5;
+        }
+
+        if(numTextures < 0 || numMeshes < 0 || numInstances < 0)
+        {
+            error = corrupted;
             return false;
         }
 
+        auto validateTextures = [&]()
+        {
+            for(int32_t i = 0; i < numTextures; i++)
+            {
+                TextureData data;
+                if(skipString(stream) == false)
+                {
+                    error = truncated;
+                    return false;
+                }
+                if(readBinaryImage(stream, data, error) == false) return false;
+            }
+            return true;
+        };
+
+        if(version >= 6 && validateTextures() == false) return false;
+
+        for(int32_t meshIdx = 0; meshIdx < numMeshes; meshIdx++)
+        {
+            // Mesh header
+            int32_t numAttribs = numAttribs_v5;
+            int32_t numVertices = numVertices_v5;
+            int32_t numSubmeshes = numSubmeshes_v5;
+            if(version >= 6)
+            {
+                stream >> numAttribs >> numVertices >> numSubmeshes;
+            }
+
+            if(numAttribs < 0 || numVertices < 0 || numSubmeshes < 0)
+            {
+                error = corrupted;
+                return false;
+            }
+
+            // Attribute specs. The vertex size has to match the stride importModel() reads with.
+            uint64_t vertexSize = 0;
+            for(int32_t i = 0; i < numAttribs; i++)
+            {
+                int32_t type, format, length;
+                stream >> type >> format >> length;
+                if(type < 0 || type >= numAttributesType || format < 0 || format >= AttribFormat::AttribFormat_Max || length < 1 || length > 4)
+                {
+                    error = corrupted;
+                    return false;
+                }
+                vertexSize += getFormatBytesPerBlock(getFalcorFormat(AttribFormat(format), length));
+            }
+
+            // Vertex data
+            const uint64_t vertexDataSize = vertexSize * numVertices;
+            if(stream.isFail() || vertexDataSize > stream.getRemainingStreamSize())
+            {
+                error = truncated;
+                return false;
+            }
+            stream.skip((size_t)vertexDataSize);
+
+            if(version <= 5 && validateTextures() == false) return false;
+
+            // Submeshes
+            for(int32_t submesh = 0; submesh < numSubmeshes; submesh++)
+            {
+                // Ambient, diffuse, specular, glossiness and the displacement parameters
+                stream.skip(uint32_t(sizeof(float) * (version >= 3 ? 13 : 11)));
+
+                for(int i = 0; i < numTextureSlots; i++)
+                {
+                    int32_t texID;
+                    stream >> texID;
+                    if(texID < -1 || texID >= numTextures)
+                    {
+                        error = "Corrupt binary mesh data!";
+                        return false;
+                    }
+                }
+
+                int32_t numTriangles = -1;
+                stream >> numTriangles;
+                if(numTriangles < 0)
+                {
+                    error = stream.isFail() ? truncated : "Mesh has negative number of triangles!";
+                    return false;
+                }
+
+                if(validateIndices(stream, (uint64_t)numTriangles * 3, numVertices, error) == false) return false;
+
+                if(version >= 9)
+                {
+                    int32_t numLods = -1;
+                    stream >> numLods;
+                    if(numLods < 0 || numLods >= (int32_t)Mesh::kMaxLodCount)
+                    {
+                        error = stream.isFail() ? truncated : "Mesh has an invalid number of levels of detail.";
+                        return false;
+                    }
+
+                    for(int32_t lod = 0; lod < numLods; lod++)
+                    {
+                        float lodError;
+                        int32_t lodTriangles = -1;
+                        stream >> lodError >> lodTriangles;
+                        if(lodTriangles < 0)
+                        {
+                            error = stream.isFail() ? truncated : "Level of detail has negative number of triangles!";
+                            return false;
+                        }
+                        if(validateIndices(stream, (uint64_t)lodTriangles * 3, numVertices, error) == false) return false;
+                    }
+                }
+            }
+        }
+
+        // Instances
+        if(version >= 6)
+        {
+            for(int32_t i = 0; i < numInstances; i++)
+            {
+                int32_t meshIdx, enabled;
+                stream >> meshIdx >> enabled;
+                stream.skip(sizeof(glm::mat4));
+                if(meshIdx < -1 || meshIdx >= numMeshes)
+                {
+                    error = stream.isFail() ? truncated : "Instance references a mesh that doesn't exist.";
+                    return false;
+                }
+                if(skipString(stream) == false || skipString(stream) == false)
+                {
+                    error = truncated;
+                    return false;
+                }
+            }
+        }
+
+        if(stream.isFail() || stream.isEof())
+        {
+            error = truncated;
+            return false;
+        }
+        return true;
+    }
+
+    bool BinaryModelImporter::decodeModel(BinaryDecodedFile& file)
+    {
+        const auto error = [&](const std::string& msg)
+        {
+            file.setError("Error when loading model " + mModelName + ".\n" + msg);
+            return false;
+        };
+        const Model::LoadFlags flags = file.getLoadFlags();
+
+        // Format ID and version.
+        char formatID[9];
+        mStream.read(formatID, 8);
+        formatID[8] = '\0';
+
+        mStream >> file.version;
+        const uint32_t version = file.version;
+
+        // Check if the version matches
+        std::string versionError;
+        if(checkVersion(formatID, version, versionError) == false)
+        {
+            return error(versionError);
+        }
+
+        int numTextureSlots;
+        int numAttributesType;
+        getVersionLayout(version, numTextureSlots, numAttributesType);
+
 
         // File header
         int32_t numTextures = 0;
@@ -605,55 +933,33 @@ namespace Falcor
         {
             numMeshes = 1;
             numInstances = 1;
-            mStream >> numAttribs_v5 >> numVertices_v5 >> numSubmeshes_v5;
+            mStream >> numAttribs_v5 >> numVertices_v5;
             if(version >= 2)
             {
                 mStream >> numTextures;
             }
+            mStream >> numSubmeshes_v5;
         }
 
         if(numTextures < 0 || numMeshes < 0 || numInstances < 0)
         {
-            std::string msg = "Error when loading model " + mModelName + ".\nFile is corrupted.";
-            logError(msg);
-            return false;
+            return error("File is corrupted.");
         }
 
-        // create objects
         bool shouldGenerateTangents = is_set(flags, Model::LoadFlags::DontGenerateTangentSpace) == false;
 
-        std::vector<TextureData> texData;
-
-        if(version >= 6)
+        std::string textureError;
+        if(version >= 6 && importTextures(file.textures, numTextures, mStream, textureError) == false)
         {
-            importTextures(texData, numTextures, mStream, mModelName);
+            return error(textureError);
         }
 
-        // This file format has a concept of sub-meshes, which Falcor model doesn't have - Falcor creates a new mesh for each sub-mesh
-        // When creating instances of meshes, it means we need to translate the original mesh index to all it's submeshes Falcor IDs. This is what the next 2 variables are for.
-        std::vector<std::vector<uint32_t>> meshToSubmeshesID(numMeshes);
-
-        // This importer loads mesh/submesh data before instance data, so the meshes are cached here.
-        std::vector<Mesh::SharedPtr> falcorMeshCache;
-        
-        struct TexSignature
-        {
-            const uint8_t* pData;
-            ResourceFormat format;
-            bool operator<(const TexSignature& other) const 
-            { 
-                if(pData < other.pData) return true;
-                if(pData == other.pData) return format < other.format;
-                return false;
-            }
-            bool operator==(const TexSignature& other) const { return pData == other.pData || format == other.format; }
-        };
-        std::map<TexSignature, Texture::SharedPtr> textures;
-        bool loadTexAsSrgb = !is_set(flags, Model::LoadFlags::AssumeLinearSpaceTextures);
-
         // Load the meshes
+        file.meshes.resize(numMeshes);
         for(int meshIdx = 0; meshIdx < numMeshes; meshIdx++)
         {
+            BinaryDecodedFile::MeshData& mesh = file.meshes[meshIdx];
+
             // Mesh header
             int32_t numAttribs = 0;
             int32_t numVertices = 0;
@@ -672,26 +978,14 @@ namespace Falcor
 
             if(numAttribs < 0 || numVertices < 0 || numSubmeshes < 0)
             {
-                std::string Msg = "Error when loading model " + mModelName + ".\nCorrupted data.!";
-                logError(Msg);
-                return false;
+                return error("Corrupted data.!");
             }
 
-            Vao::BufferVec pVBs;
-            VertexLayout::SharedPtr pLayout = VertexLayout::create();
-            
-            struct BufferData
-            {
-                std::vector<uint8_t> vec;
-                bool shouldSkip = false;
-                uint32_t elementSize = 0;
-            };
-
-            std::vector<BufferData> buffers;
-            pVBs.resize(numAttribs);
+            mesh.vertexCount = numVertices;
+            mesh.pLayout = VertexLayout::create();
+            auto& buffers = mesh.buffers;
             buffers.resize(numAttribs);
 
-            const uint32_t kInvalidBufferIndex = (uint32_t)-1;
             uint32_t positionBufferIndex = kInvalidBufferIndex;
             uint32_t normalBufferIndex = kInvalidBufferIndex;
             uint32_t bitangentBufferIndex = kInvalidBufferIndex;
@@ -700,15 +994,13 @@ namespace Falcor
             for(int i = 0; i < numAttribs; i++)
             {
                 VertexBufferLayout::SharedPtr pBufferLayout = VertexBufferLayout::create();
-                pLayout->addBufferLayout(i, pBufferLayout);
+                mesh.pLayout->addBufferLayout(i, pBufferLayout);
                 int32_t type, format, length;
                 mStream >> type >> format >> length;
 
                 if(type < 0 || type >= numAttributesType || format < 0 || format >= AttribFormat::AttribFormat_Max || length < 1 || length > 4)
                 {
-                    std::string msg = "Error when loading model " + mModelName + ".\nCorrupted data.!";
-                    logError(msg);
-                    return false;
+                    return error("Corrupted data.!");
                 }
                 else
                 {
@@ -748,8 +1040,8 @@ namespace Falcor
                 }
             }
 
-            
-            // Check if we need to generate tangents  
+
+            // Check if we need to generate tangents
             bool genTangentForMesh = false;
             if(shouldGenerateTangents && (bitangentBufferIndex == kInvalidBufferIndex))
             {
@@ -762,17 +1054,17 @@ namespace Falcor
                 {
                     // Set the offsets
                     genTangentForMesh = true;
-                    bitangentBufferIndex = (uint32_t)pVBs.size();
-                    pVBs.resize(bitangentBufferIndex + 1);
+                    bitangentBufferIndex = (uint32_t)buffers.size();
+                    mesh.generatedBitangentIndex = bitangentBufferIndex;
                     buffers.resize(bitangentBufferIndex + 1);
-                   
+
                     auto pBitangentLayout = VertexBufferLayout::create();
-                    pLayout->addBufferLayout(bitangentBufferIndex, pBitangentLayout);
+                    mesh.pLayout->addBufferLayout(bitangentBufferIndex, pBitangentLayout);
                     pBitangentLayout->addElement(VERTEX_BITANGENT_NAME, 0, ResourceFormat::RGB32Float, 1, VERTEX_BITANGENT_LOC);
                     buffers[bitangentBufferIndex].vec.resize(sizeof(glm::vec3) * numVertices);
                 }
             }
-            
+
 
             // Read the data, one vertex at a time
             for(int32_t i = 0; i < numVertices; i++)
@@ -785,40 +1077,26 @@ namespace Falcor
                     }
                     else
                     {
-                        uint32_t stride = pLayout->getBufferLayout(attributes)->getStride();
+                        uint32_t stride = mesh.pLayout->getBufferLayout(attributes)->getStride();
                         uint8_t* pDest = buffers[attributes].vec.data() + stride * i;
                         mStream.read(pDest, stride);
                     }
                 }
             }
 
-            Buffer::BindFlags vbBindFlags = Buffer::BindFlags::Vertex;
-            if (is_set(flags, Model::LoadFlags::BuffersAsShaderResource))
+            if(version <= 5 && importTextures(file.textures, numTextures, mStream, textureError) == false)
             {
-                vbBindFlags |= Buffer::BindFlags::ShaderResource;
-            }
-
-            for (int32_t i = 0; i < numAttribs; ++i)
-            {
-                if(buffers[i].shouldSkip == false)
-                {
-                    pVBs[i] = Buffer::create(buffers[i].vec.size(), vbBindFlags, Buffer::CpuAccess::None, buffers[i].vec.data());
-                }
-            }
-
-            if(version <= 5)
-            {
-                importTextures(texData, numTextures, mStream, mModelName);
-                textures.clear();
+                return error(textureError);
             }
 
             // Array of Submesh.
-            // Falcor doesn't have a concept of submeshes, just create a new mesh for each submesh
-            for(int submesh = 0; submesh < numSubmeshes; submesh++)
+            // Falcor doesn't have a concept of submeshes, a new mesh is created for each submesh
+            mesh.submeshes.resize(numSubmeshes);
+            for(int submeshIdx = 0; submeshIdx < numSubmeshes; submeshIdx++)
             {
-                // create the material
-                Material::SharedPtr pMaterial = Material::create("");
+                BinaryDecodedFile::SubmeshData& submesh = mesh.submeshes[submeshIdx];
 
+                // Material parameters
                 glm::vec3 ambient;
                 glm::vec4 diffuse;
                 glm::vec3 specular;
@@ -826,128 +1104,185 @@ namespace Falcor
 
                 mStream >> ambient >> diffuse >> specular >> glossiness;
                 diffuse.w = 1 - diffuse.w;
-                pMaterial->setBaseColor(diffuse);
-                pMaterial->setSpecularParams(vec4(specular, glossiness));
+                submesh.baseColor = diffuse;
+                submesh.specularParams = vec4(specular, glossiness);
 
                 if(version >= 3)
                 {
-                    float displacementCoeff;
-                    float displacementBias;
-                    mStream >> displacementCoeff >> displacementBias;
-                    pMaterial->setHeightScaleOffset(displacementCoeff, displacementBias);
+                    mStream >> submesh.displacementCoeff >> submesh.displacementBias;
                 }
 
+                submesh.textureIDs.resize(numTextureSlots);
                 for(int i = 0; i < numTextureSlots; i++)
                 {
                     int32_t texID;
                     mStream >> texID;
                     if(texID < -1 || texID >= numTextures)
                     {
-                        std::string msg = "Error when loading model " + mModelName + ".\nCorrupt binary mesh data!";
-                        logError(msg);
-                        return false;
-                    }
-                    else if(texID != -1)
-                    {
-                        // Load the texture
-                        TexSignature texSig;
-                        texSig.format = getFormatFromMapType(loadTexAsSrgb, texData[texID].format, TextureType(i));
-                        texSig.pData = texData[texID].data.data();
-                        // Check if we already created a matching texture
-                        auto existingTex = textures.find(texSig);
-                        if(existingTex != textures.end())
-                        {
-                            setTexture(pMaterial.get(), existingTex->second, TextureType(i), mModelName);
-                        }
-                        else
-                        {
-                            auto pTexture = Texture::create2D(texData[texID].width, texData[texID].height, texSig.format, 1, Texture::kMaxPossible, texSig.pData);
-                            pTexture->setSourceFilename(texData[texID].name);
-                            textures[texSig] = pTexture;
-                            setTexture(pMaterial.get(), pTexture, TextureType(i), mModelName);
-                        }
+                        return error("Corrupt binary mesh data!");
                     }
+                    submesh.textureIDs[i] = texID;
                 }
 
-                // Create material and check if it already exists
-                pMaterial = checkForExistingMaterial(pMaterial);
-
                 int32_t numTriangles;
                 mStream >> numTriangles;
                 if(numTriangles < 0)
                 {
-                    std::string Msg = "Error when loading model " + mModelName + ".\nMesh has negative number of triangles!";
-                    logError(Msg);
-                    return false;
+                    return error("Mesh has negative number of triangles!");
                 }
 
-                // create the index buffer
+                // Reference the indices in the file. Strings and images in the file can leave them unaligned, in which case they are copied, and so are the indices which are reordered below
                 uint32_t numIndices = numTriangles * 3;
-                std::vector<uint32_t> indices(numIndices);
                 uint32_t ibSize = 3 * numTriangles * sizeof(uint32_t);
-                mStream.read(&indices[0], ibSize);
-
+                submesh.indexCount = numIndices;
+                submesh.pFileIndices = (const uint32_t*)mStream.readSpan(ibSize);
+                if(submesh.pFileIndices == nullptr)
+                {
+                    return error("File is truncated.");
+                }
 
-                Buffer::BindFlags ibBindFlags = Buffer::BindFlags::Index;
-                if (is_set(flags, Model::LoadFlags::BuffersAsShaderResource))
+                std::vector<uint32_t>& indices = submesh.indexData;
+                const auto copyIndices = [&]()
                 {
-                    ibBindFlags |= Buffer::BindFlags::ShaderResource;
+                    if(indices.empty() == false) return;
+                    indices.resize(numIndices);
+                    std::memcpy(indices.data(), submesh.pFileIndices, ibSize);
+                };
+                if(((uintptr_t)submesh.pFileIndices % alignof(uint32_t)) != 0) copyIndices();
+
+                // The per-submesh processing works on the vertices the submesh references, compacted to a dense range
+                const bool optimize = is_set(flags, Model::LoadFlags::OptimizeMeshes);
+                const bool buildMeshlets = is_set(flags, Model::LoadFlags::GenerateMeshlets) && positionBufferIndex != kInvalidBufferIndex;
+                const bool generateLods = version < 9 && is_set(flags, Model::LoadFlags::GenerateLods) && positionBufferIndex != kInvalidBufferIndex;
+                CompactSubmesh compact;
+                if (optimize || buildMeshlets || generateLods)
+                {
+                    const uint8_t* pPositions = (positionBufferIndex != kInvalidBufferIndex) ? buffers[positionBufferIndex].vec.data() : nullptr;
+                    const uint32_t positionStride = (positionBufferIndex != kInvalidBufferIndex) ? buffers[positionBufferIndex].elementSize : 0;
+                    compact = compactSubmesh(submesh.getIndices(), numIndices, pPositions, positionStride);
                 }
-                auto pIB = Buffer::create(ibSize, ibBindFlags, Buffer::CpuAccess::None, indices.data());
 
-                // Generate tangent space data if needed
-                if(genTangentForMesh)
+                // The vertex buffers are shared by all the submeshes, so only the triangles can be reordered
+                if (optimize)
                 {
-                    uint32_t texCrdCount = 0;
-                    glm::vec2* texCrd = nullptr;
-                    if(texCoordBufferIndex != kInvalidBufferIndex)
+                    const uint32_t vertexCount = compact.getVertexCount();
+                    auto before = MeshOptimizer::analyzeVertexCache(compact.indices.data(), numIndices, vertexCount);
+                    auto clusters = MeshOptimizer::optimizeVertexCache(compact.indices.data(), numIndices, vertexCount);
+                    if (compact.positions.size())
                     {
-                        texCrdCount = pLayout->getBufferLayout(texCoordBufferIndex)->getStride() / sizeof(glm::vec2);
-                        texCrd = (glm::vec2*)buffers[texCoordBufferIndex].vec.data();
+                        MeshOptimizer::optimizeOverdraw(compact.indices.data(), numIndices, clusters, compact.positions.data(), compact.positionStride, vertexCount);
                     }
+                    auto after = MeshOptimizer::analyzeVertexCache(compact.indices.data(), numIndices, vertexCount);
+                    logInfo("Optimized submesh " + std::to_string(submeshIdx) + " of model " + mModelName + ". ACMR " + std::to_string(before.acmr) + " -> " + std::to_string(after.acmr) +
+                        ", ATVR " + std::to_string(before.atvr) + " -> " + std::to_string(after.atvr));
+                }
+
+                // Meshlets reorder the triangles of the full-resolution mesh
+                if (buildMeshlets)
+                {
+                    submesh.meshlets = MeshletBuilder::build(compact.indices.data(), numIndices, compact.positions.data(), compact.positionStride, compact.getVertexCount());
+                }
 
-                    ResourceFormat posFormat = pLayout->getBufferLayout(positionBufferIndex)->getElementFormat(0);
+                if (optimize || buildMeshlets)
+                {
+                    copyIndices();
+                    compact.toGlobal(compact.indices.data(), numIndices, indices.data());
+                }
 
-                    if (posFormat == ResourceFormat::RGB32Float)
+                // Levels of detail. Stored in the file since version 9, otherwise generated if requested
+                std::vector<MeshSimplifier::Lod> lodData;
+                if(version >= 9)
+                {
+                    int32_t numLods = -1;
+                    mStream >> numLods;
+                    if(numLods < 0 || numLods >= (int32_t)Mesh::kMaxLodCount)
                     {
-                        generateSubmeshTangentData<glm::vec3>(indices, numVertices, (glm::vec3*)buffers[positionBufferIndex].vec.data(), (glm::vec3*)buffers[normalBufferIndex].vec.data(), texCrd, texCrdCount, (glm::vec3*)buffers[bitangentBufferIndex].vec.data());
+                        return error("Mesh has an invalid number of levels of detail.");
                     }
-                    else if (posFormat == ResourceFormat::RGBA32Float)
+
+                    lodData.resize(numLods);
+                    for(auto& lod : lodData)
                     {
-                        generateSubmeshTangentData<glm::vec4>(indices, numVertices, (glm::vec4*)buffers[positionBufferIndex].vec.data(), (glm::vec3*)buffers[normalBufferIndex].vec.data(), texCrd, texCrdCount, (glm::vec3*)buffers[bitangentBufferIndex].vec.data());
+                        int32_t lodTriangles = -1;
+                        mStream >> lod.error >> lodTriangles;
+                        const void* pLodIndices = (lodTriangles >= 0) ? mStream.readSpan(size_t(lodTriangles) * 3 * sizeof(uint32_t)) : nullptr;
+                        if(pLodIndices == nullptr)
+                        {
+                            return error("Corrupt level of detail data.");
+                        }
+                        lod.indices.resize(lodTriangles * 3);
+                        std::memcpy(lod.indices.data(), pLodIndices, lod.indices.size() * sizeof(uint32_t));
+                        if (optimize) compact.toLocal(lod.indices);
                     }
+                }
+                else if(generateLods)
+                {
+                    lodData = MeshSimplifier::generateLodChain(compact.indices.data(), numIndices, compact.positions.data(), compact.positionStride, compact.getVertexCount(), Mesh::kMaxLodCount - 1);
+                }
 
-                    pVBs[bitangentBufferIndex] = Buffer::create(buffers[bitangentBufferIndex].vec.size(), Buffer::BindFlags::Vertex, Buffer::CpuAccess::None, buffers[bitangentBufferIndex].vec.data());
+                // The levels of detail are appended to the full-resolution indices
+                if(lodData.empty() == false)
+                {
+                    copyIndices();
+                    const bool lodsAreLocal = optimize || generateLods;
+                    for(auto& lod : lodData)
+                    {
+                        if (optimize) MeshOptimizer::optimizeVertexCache(lod.indices.data(), (uint32_t)lod.indices.size(), compact.getVertexCount());
+                        if (lodsAreLocal) compact.toGlobal(lod.indices.data(), (uint32_t)lod.indices.size(), lod.indices.data());
+                        Mesh::Lod range;
+                        range.startIndex = (uint32_t)indices.size();
+                        range.indexCount = (uint32_t)lod.indices.size();
+                        range.error = lod.error;
+                        submesh.lods.push_back(range);
+                        indices.insert(indices.end(), lod.indices.begin(), lod.indices.end());
+                    }
                 }
-                
 
                 // Calculate the bounding-box
+                const uint32_t* pIndices = submesh.getIndices();
                 glm::vec3 max, min;
                 for(uint32_t i = 0; i < numIndices; i++)
                 {
-                    uint32_t vertexID = indices[i];
-                    uint8_t* pVertex = (pLayout->getBufferLayout(positionBufferIndex)->getStride() * vertexID) + buffers[positionBufferIndex].vec.data();
+                    uint32_t vertexID = pIndices[i];
+                    const uint8_t* pVertex = (mesh.pLayout->getBufferLayout(positionBufferIndex)->getStride() * vertexID) + buffers[positionBufferIndex].vec.data();
 
-                    float* pPosition = (float*)pVertex;
+                    const float* pPosition = (const float*)pVertex;
 
                     glm::vec3 xyz(pPosition[0], pPosition[1], pPosition[2]);
                     min = glm::min(min, xyz);
                     max = glm::max(max, xyz);
                 }
 
-                BoundingBox box = BoundingBox::fromMinMax(min, max);
+                submesh.box = BoundingBox::fromMinMax(min, max);
+            }
 
-                // create the mesh
-                auto pMesh = Mesh::create(pVBs, numVertices, pIB, numIndices, pLayout, Vao::Topology::TriangleList, pMaterial, box, false);
+            // Generate tangent space data if needed. The vertex buffers are shared by all the submeshes, so this is done once for the triangles of all the submeshes
+            if(genTangentForMesh)
+            {
+                std::vector<uint32_t> meshIndices;
+                for(const auto& submesh : mesh.submeshes)
+                {
+                    meshIndices.insert(meshIndices.end(), submesh.getIndices(), submesh.getIndices() + submesh.indexCount);
+                }
 
-                if (version >= 6)
+                TangentSpaceInput input;
+                input.pIndices = meshIndices.data();
+                input.indexCount = (uint32_t)meshIndices.size();
+                input.vertexCount = numVertices;
+                input.pPositions = buffers[positionBufferIndex].vec.data();
+                input.pNormals = (glm::vec3*)buffers[normalBufferIndex].vec.data();
+                if(texCoordBufferIndex != kInvalidBufferIndex)
                 {
-                    falcorMeshCache.push_back(pMesh);
-                    meshToSubmeshesID[meshIdx].push_back((uint32_t)(falcorMeshCache.size() - 1));
+                    input.texCrdStride = mesh.pLayout->getBufferLayout(texCoordBufferIndex)->getStride() / sizeof(glm::vec2);
+                    input.pTexCrd = (glm::vec2*)buffers[texCoordBufferIndex].vec.data();
                 }
-                else
+
+                ResourceFormat posFormat = mesh.pLayout->getBufferLayout(positionBufferIndex)->getElementFormat(0);
+
+                if (posFormat == ResourceFormat::RGB32Float || posFormat == ResourceFormat::RGBA32Float)
                 {
-                    model.addMeshInstance(pMesh, glm::mat4());
+                    input.positionStride = getFormatBytesPerBlock(posFormat);
+                    generateBitangents(input, (glm::vec3*)buffers[bitangentBufferIndex].vec.data());
                 }
             }
         }
@@ -965,16 +1300,139 @@ namespace Falcor
                 readString(mStream);   // Name
                 readString(mStream);   // Meta-data
 
-                if(enabled)
+                if(enabled && meshIdx >= 0)
+                {
+                    file.instances.push_back({ meshIdx, transformation });
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool BinaryModelImporter::createModel(Model& model, const BinaryDecodedFile& file)
+    {
+        const Model::LoadFlags flags = file.getLoadFlags();
+
+        // This file format has a concept of sub-meshes, which Falcor model doesn't have - Falcor creates a new mesh for each sub-mesh
+        // When creating instances of meshes, it means we need to translate the original mesh index to all it's submeshes. This is what the next variable is for.
+        std::vector<std::vector<Mesh::SharedPtr>> meshToSubmeshes(file.meshes.size());
+
+        struct TexSignature
+        {
+            const uint8_t* pData;
+            ResourceFormat format;
+            bool operator<(const TexSignature& other) const
+            {
+                if(pData < other.pData) return true;
+                if(pData == other.pData) return format < other.format;
+                return false;
+            }
+            bool operator==(const TexSignature& other) const { return pData == other.pData || format == other.format; }
+        };
+        std::map<TexSignature, Texture::SharedPtr> textures;
+        bool loadTexAsSrgb = !is_set(flags, Model::LoadFlags::AssumeLinearSpaceTextures);
+        bool streamTextures = is_set(flags, Model::LoadFlags::StreamTextures);
+        bool compressTextures = is_set(flags, Model::LoadFlags::CompressTextures);
+
+        Buffer::BindFlags vbBindFlags = Buffer::BindFlags::Vertex;
+        Buffer::BindFlags ibBindFlags = Buffer::BindFlags::Index;
+        if (is_set(flags, Model::LoadFlags::BuffersAsShaderResource))
+        {
+            vbBindFlags |= Buffer::BindFlags::ShaderResource;
+            ibBindFlags |= Buffer::BindFlags::ShaderResource;
+        }
+
+        for(size_t meshIdx = 0; meshIdx < file.meshes.size(); meshIdx++)
+        {
+            const BinaryDecodedFile::MeshData& mesh = file.meshes[meshIdx];
+
+            Vao::BufferVec pVBs(mesh.buffers.size());
+            for(size_t i = 0; i < mesh.buffers.size(); i++)
+            {
+                const auto& buffer = mesh.buffers[i];
+                if(buffer.shouldSkip == false)
+                {
+                    Buffer::BindFlags bindFlags = (i == mesh.generatedBitangentIndex) ? Buffer::BindFlags::Vertex : vbBindFlags;
+                    pVBs[i] = Buffer::create(buffer.vec.size(), bindFlags, Buffer::CpuAccess::None, buffer.vec.data());
+                }
+            }
+
+            for(const auto& submesh : mesh.submeshes)
+            {
+                // create the material
+                Material::SharedPtr pMaterial = Material::create("");
+                pMaterial->setBaseColor(submesh.baseColor);
+                pMaterial->setSpecularParams(submesh.specularParams);
+                if(file.version >= 3)
+                {
+                    pMaterial->setHeightScaleOffset(submesh.displacementCoeff, submesh.displacementBias);
+                }
+
+                for(size_t i = 0; i < submesh.textureIDs.size(); i++)
                 {
-                    for(uint32_t i : meshToSubmeshesID[meshIdx])
+                    int32_t texID = submesh.textureIDs[i];
+                    if(texID == -1) continue;
+
+                    // Load the texture
+                    const TextureData& texData = file.textures[texID];
+                    TexSignature texSig;
+                    texSig.format = getFormatFromMapType(loadTexAsSrgb, texData.format, TextureType(i));
+                    texSig.pData = texData.pData;
+                    // Check if we already created a matching texture
+                    auto existingTex = textures.find(texSig);
+                    if(existingTex != textures.end())
                     {
-                        model.addMeshInstance(falcorMeshCache[i], transformation);
+                        setTexture(pMaterial.get(), existingTex->second, TextureType(i), mModelName);
+                    }
+                    else
+                    {
+                        Texture::SharedPtr pTexture = streamTextures ? createStreamedTexture(texData, texSig.format, mpDataOwner) : nullptr;
+                        if(pTexture == nullptr)
+                        {
+                            TextureCompressor::Mode compression = TextureCompressor::Mode::None;
+                            if(compressTextures)
+                            {
+                                compression = (TextureType(i) == TextureType_Normal) ? TextureCompressor::Mode::NormalMap : TextureCompressor::Mode::Color;
+                            }
+                            pTexture = createTexture(texData, texSig.format, compression);
+                        }
+                        textures[texSig] = pTexture;
+                        setTexture(pMaterial.get(), pTexture, TextureType(i), mModelName);
                     }
                 }
+
+                // Create material and check if it already exists
+                pMaterial = checkForExistingMaterial(pMaterial);
+                if(streamTextures)
+                {
+                    TextureStreamer::getDefault()->addMaterial(pMaterial);
+                }
+
+                auto pIB = Buffer::create(submesh.getIndexBufferCount() * sizeof(uint32_t), ibBindFlags, Buffer::CpuAccess::None, submesh.getIndices());
+
+                // create the mesh
+                auto pMesh = Mesh::create(pVBs, mesh.vertexCount, pIB, submesh.indexCount, mesh.pLayout, Vao::Topology::TriangleList, pMaterial, submesh.box, false, submesh.lods, submesh.meshlets);
+
+                if (file.version >= 6)
+                {
+                    meshToSubmeshes[meshIdx].push_back(pMesh);
+                }
+                else
+                {
+                    model.addMeshInstance(pMesh, glm::mat4());
+                }
             }
         }
-        
+
+        for(const auto& instance : file.instances)
+        {
+            for(const auto& pMesh : meshToSubmeshes[instance.meshIdx])
+            {
+                model.addMeshInstance(pMesh, instance.transform);
+            }
+        }
+
         return true;
     }
 }
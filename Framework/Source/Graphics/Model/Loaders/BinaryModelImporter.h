@@ -27,7 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include <string>
-#include "Utils/BinaryFileStream.h"
+#include "Utils/BinaryMemoryStream.h"
 #include "glm/vec3.hpp"
 #include "../Model.h"
 #include "Graphics/Model/Loaders/ModelImporter.h"
@@ -35,6 +35,7 @@
 namespace Falcor
 {
     class Texture;
+    class BinaryDecodedFile;
 
     class BinaryModelImporter : public ModelImporter
     {
@@ -46,12 +47,36 @@ namespace Falcor
         */
         static bool import(Model& model, const std::string& filename, Model::LoadFlags flags);
 
+        /** Map a binary model file into memory, validate it and parse the meshes, including the mesh processing requested by the flags. Doesn't create any GPU resources, so it can be called from any thread.
+            \param[in] filename Model's filename. Loader will look for it in the data directories.
+            \param[in] flags Flags controlling model creation
+            \return The decoded file. Check DecodedFile::isValid() for errors
+        */
+        static Model::DecodedFile::SharedPtr decode(const std::string& filename, Model::LoadFlags flags);
+
+        /** Create the model from a file decoded with decode()
+            \param[out] model Model object to load into
+            \param[in] pFile The decoded file
+            \return Whether import succeeded
+        */
+        static bool import(Model& model, const Model::DecodedFile* pFile);
+
+        /** Check that the contents of a binary model file are well formed. Walks the file and mesh headers of versions 1 to 8 as described in BinaryModelSpec.h, and checks that all counts, texture IDs and indices are in range, without copying any of the data.
+            \param[in] pData Pointer to the file contents
+            \param[in] size Size of the file in bytes
+            \param[out] error Description of the problem if the file is malformed
+            \return true if the file can be imported, otherwise false
+        */
+        static bool validate(const void* pData, size_t size, std::string& error);
+
     private:
-        BinaryModelImporter(const std::string& fullpath);
-        bool importModel(Model& model, Model::LoadFlags flags);
+        BinaryModelImporter(const std::string& fullpath, const void* pData, size_t size, const std::shared_ptr<const void>& pDataOwner);
+        bool decodeModel(BinaryDecodedFile& file);
+        bool createModel(Model& model, const BinaryDecodedFile& file);
 
         std::string mModelName;
-        BinaryFileStream mStream;
+        BinaryMemoryStream mStream;
+        std::shared_ptr<const void> mpDataOwner;    // Keeps the file data alive for streamed textures
 
         struct TangentSpace
         {
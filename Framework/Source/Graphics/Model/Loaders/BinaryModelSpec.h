@@ -30,7 +30,7 @@
 //------------------------------------------------------------------------
 /*
 
-Binary scene file format v8
+Binary scene file format v9
 ---------------------------
 
 - The basic units of data are 32-bit little-endian ints and floats.
@@ -41,7 +41,7 @@ Binary scene file format v8
 
 File
 0       2       string8 v6  formatID            ("BinScene")
-2       1       int     v6  formatVersion       (6)
+2       1       int     v6  formatVersion       (6 .. 9)
 3       1       int     v6  numTextures
 4       1       int     v6  numMeshes
 5       1       int     v6  numInstances
@@ -103,6 +103,14 @@ Submesh
 18      1       int     v5  specularTexture     (-1 if none)
 19      1       int     v1  numTriangles
 20      n*3     int     v1  indices             (numTriangles * 3)
+?       1       int     v9  numLods             (simplified levels of detail, not counting the full-resolution mesh)
+?       n*?     array   v9  Lod                 (numLods, from the most to the least detailed)
+?
+
+Lod
+0       1       float   v9  error               (object-space simplification error)
+1       1       int     v9  numTriangles
+2       n*3     int     v9  indices             (numTriangles * 3, referencing the vertices of the submesh's mesh)
 ?
 
 Instance
@@ -48,9 +48,11 @@ namespace Falcor
         Vao::Topology topology,
         const Material::SharedPtr& pMaterial,
         const BoundingBox& boundingBox,
-        bool hasBones)
+        bool hasBones,
+        const std::vector<Lod>& lods,
+        const std::vector<Meshlet>& meshlets)
     {
-        return SharedPtr(new Mesh(vertexBuffers, vertexCount, pIndexBuffer, indexCount, pLayout, topology, pMaterial, boundingBox, hasBones));
+        return SharedPtr(new Mesh(vertexBuffers, vertexCount, pIndexBuffer, indexCount, pLayout, topology, pMaterial, boundingBox, hasBones, lods, meshlets));
     }
 
     Mesh::Mesh(const Vao::BufferVec& vertexBuffers,
@@ -61,7 +63,9 @@ namespace Falcor
         Vao::Topology topology,
         const Material::SharedPtr& pMaterial,
         const BoundingBox& boundingBox,
-        bool hasBones) 
+        bool hasBones,
+        const std::vector<Lod>& lods,
+        const std::vector<Meshlet>& meshlets)
         : mId(sMeshCounter++)
         , mIndexCount(indexCount)
         , mVertexCount(vertexCount)
@@ -87,6 +91,13 @@ namespace Falcor
 
         mPrimitiveCount = mIndexCount / VertsPerPrim;
 
+        Lod fullResolution;
+        fullResolution.indexCount = mIndexCount;
+        mLods.push_back(fullResolution);
+        mLods.insert(mLods.end(), lods.begin(), lods.end());
+        assert(mLods.size() <= kMaxLodCount);
+        mMeshlets = meshlets;
+
         mpVao = Vao::create(topology, pLayout, vertexBuffers, pIndexBuffer, ResourceFormat::R32Uint);
     }
 
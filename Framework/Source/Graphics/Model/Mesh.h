@@ -35,6 +35,7 @@
 #include "Utils/AABB.h"
 #include "Graphics/Material/Material.h"
 #include "Graphics/Paths/MovableObject.h"
+#include "Graphics/Model/Meshlet.h"
 
 namespace Falcor
 {
@@ -56,6 +57,17 @@ namespace Falcor
         using SharedPtr = std::shared_ptr<Mesh>;
         using SharedConstPtr = std::shared_ptr<const Mesh>;
 
+        static const uint32_t kMaxLodCount = 8;  ///> Max number of levels of detail, including the full-resolution mesh
+
+        /** A level of detail. All the levels share the mesh's vertex buffers, and their indices are stored one after the other in the mesh's index buffer
+        */
+        struct Lod
+        {
+            uint32_t startIndex = 0;    ///< First index of the level in the index buffer
+            uint32_t indexCount = 0;
+            float error = 0;            ///< Object-space simplification error, i.e. how far the level's surface may be from the full-resolution mesh
+        };
+
         /** create a new mesh
             \param[in] VertexBuffers Vector of vertex buffer descriptors
             \param[in] VertexCount Number of vertices in the vertex buffer
@@ -65,6 +77,8 @@ namespace Falcor
             \param[in] pMaterial The material of the mesh
             \param[in] BoundingBox The mesh's axis-aligned bounding-box
             \param[in] bHasBones Indicates the the mesh uses bones for animation
+            \param[in] lods Simplified levels of detail, ordered from the most to the least detailed. The full-resolution mesh is LOD 0, described by indexCount, and isn't part of the list
+            \param[in] meshlets Optional. The meshlets of the full-resolution mesh, created with MeshletBuilder
         */
         static SharedPtr create(const Vao::BufferVec& vertexBuffers,
             uint32_t vertexCount,
@@ -74,7 +88,9 @@ namespace Falcor
             Vao::Topology topology,
             const Material::SharedPtr& pMaterial,
             const BoundingBox& boundingBox,
-            bool hasBones);
+            bool hasBones,
+            const std::vector<Lod>& lods = std::vector<Lod>(),
+            const std::vector<Meshlet>& meshlets = std::vector<Meshlet>());
 
         /** Destructor
         */
@@ -92,10 +108,22 @@ namespace Falcor
         */
         uint32_t getPrimitiveCount() const { return mPrimitiveCount; }
 
-        /** Get the number of indices in the index buffer. Use this value when drawing the mesh.
+        /** Get the number of indices of the full-resolution mesh. Use this value when drawing the mesh.
         */
         uint32_t getIndexCount() const { return mIndexCount; }
 
+        /** Get the number of levels of detail, including the full-resolution mesh. Always at least 1
+        */
+        uint32_t getLodCount() const { return (uint32_t)mLods.size(); }
+
+        /** Get a level of detail. Level 0 is the full-resolution mesh
+        */
+        const Lod& getLod(uint32_t lod) const { return mLods[lod]; }
+
+        /** Get the meshlets of the full-resolution mesh. Empty unless the mesh was loaded with Model::LoadFlags::GenerateMeshlets
+        */
+        const std::vector<Meshlet>& getMeshlets() const { return mMeshlets; }
+
         /** Get a pointer to the mesh's material
         */
         const Material::SharedPtr& getMaterial() const { return mpMaterial; }
@@ -139,7 +167,9 @@ namespace Falcor
             Vao::Topology topology,
             const Material::SharedPtr& pMaterial,
             const BoundingBox& boundingBox,
-            bool hasBones);
+            bool hasBones,
+            const std::vector<Lod>& lods,
+            const std::vector<Meshlet>& meshlets);
 
         static uint32_t sMeshCounter;
 
@@ -152,5 +182,7 @@ namespace Falcor
         Material::SharedPtr mpMaterial;
         BoundingBox mBoundingBox;
         Vao::SharedPtr mpVao;
+        std::vector<Lod> mLods;
+        std::vector<Meshlet> mMeshlets;
     };
 }
\ No newline at end of file
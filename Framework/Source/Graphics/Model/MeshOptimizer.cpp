@@ -0,0 +1,292 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidIndex = uint32_t(-1);
+
+        /** Vertex to triangle adjacency, stored as a compressed list
+        */
+        struct Adjacency
+        {
+            std::vector<uint32_t> offsets;      // vertexCount + 1 entries. The triangles of vertex v are triangles[offsets[v]] to triangles[offsets[v + 1] - 1]
+            std::vector<uint32_t> triangles;
+        };
+
+        Adjacency buildAdjacency(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount)
+        {
+            Adjacency adjacency;
+            adjacency.offsets.assign(vertexCount + 1, 0);
+            for (uint32_t i = 0; i < indexCount; i++)
+            {
+                assert(pIndices[i] < vertexCount);
+                adjacency.offsets[pIndices[i] + 1]++;
+            }
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                adjacency.offsets[v + 1] += adjacency.offsets[v];
+            }
+
+            adjacency.triangles.resize(indexCount);
+            std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+            for (uint32_t i = 0; i < indexCount; i++)
+            {
+                adjacency.triangles[cursor[pIndices[i]]++] = i / 3;
+            }
+            return adjacency;
+        }
+
+        const glm::vec3& getPosition(const void* pPositions, uint32_t stride, uint32_t index)
+        {
+            return *(const glm::vec3*)((const uint8_t*)pPositions + size_t(index) * stride);
+        }
+    }
+
+    MeshOptimizer::CacheStats MeshOptimizer::analyzeVertexCache(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+    {
+        CacheStats stats;
+        if (indexCount < 3) return stats;
+
+        // A vertex is in the cache if it was one of the last cacheSize vertices inserted into it
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+        uint32_t referencedCount = 0;
+        for (uint32_t i = 0; i < indexCount; i++)
+        {
+            uint32_t v = pIndices[i];
+            assert(v < vertexCount);
+            if (timestamps[v] == 0) referencedCount++;
+            if (time - timestamps[v] > cacheSize)
+            {
+                timestamps[v] = time++;
+                stats.misses++;
+            }
+        }
+
+        stats.acmr = float(stats.misses) / float(indexCount / 3);
+        stats.atvr = float(stats.misses) / float(referencedCount);
+        return stats;
+    }
+
+    std::vector<uint32_t> MeshOptimizer::optimizeVertexCache(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+    {
+        std::vector<uint32_t> clusters;
+        const uint32_t triangleCount = indexCount / 3;
+        if (triangleCount == 0) return clusters;
+
+        Adjacency adjacency = buildAdjacency(pIndices, indexCount, vertexCount);
+        std::vector<uint32_t> liveTriangles(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+        }
+
+        std::vector<uint32_t> timestamps(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> output;
+        output.reserve(indexCount);
+        uint32_t time = cacheSize + 1;
+        uint32_t cursor = 0;
+
+        // Fallback when none of the candidates has live triangles. Prefers recently used vertices, then scans the vertices in order
+        auto skipDeadEnd = [&]() -> uint32_t
+        {
+            while (deadEnds.empty() == false)
+            {
+                uint32_t v = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveTriangles[v] > 0) return v;
+            }
+            for (; cursor < vertexCount; cursor++)
+            {
+                if (liveTriangles[cursor] > 0) return cursor;
+            }
+            return kInvalidIndex;
+        };
+
+        uint32_t fan = skipDeadEnd();
+        bool isCached = false;
+        while (fan != kInvalidIndex)
+        {
+            if (isCached == false) clusters.push_back((uint32_t)output.size() / 3);
+
+            // Emit all the live triangles around the fanning vertex
+            candidates.clear();
+            for (uint32_t a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; a++)
+            {
+                uint32_t t = adjacency.triangles[a];
+                if (emitted[t]) continue;
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    uint32_t v = pIndices[t * 3 + i];
+                    output.push_back(v);
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    liveTriangles[v]--;
+                    if (time - timestamps[v] > cacheSize) timestamps[v] = time++;
+                }
+                emitted[t] = true;
+            }
+
+            // Pick the oldest candidate which will still be in the cache after emitting its triangles
+            uint32_t next = kInvalidIndex;
+            int32_t bestPriority = -1;
+            for (uint32_t v : candidates)
+            {
+                if (liveTriangles[v] == 0) continue;
+                int32_t priority = 0;
+                if (time - timestamps[v] + 2 * liveTriangles[v] <= cacheSize) priority = int32_t(time - timestamps[v]);
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    next = v;
+                }
+            }
+
+            if (next == kInvalidIndex) next = skipDeadEnd();
+            fan = next;
+            isCached = (fan != kInvalidIndex) && (time - timestamps[fan] <= cacheSize);
+        }
+
+        assert(output.size() == indexCount);
+        std::memcpy(pIndices, output.data(), indexCount * sizeof(uint32_t));
+        return clusters;
+    }
+
+    void MeshOptimizer::optimizeOverdraw(uint32_t* pIndices, uint32_t indexCount, const std::vector<uint32_t>& clusters, const void* pPositions, uint32_t positionStride, uint32_t vertexCount, float threshold)
+    {
+        const uint32_t triangleCount = indexCount / 3;
+        if (clusters.size() <= 1) return;
+
+        // Area-weighted centroid and normal of every cluster
+        struct Cluster
+        {
+            uint32_t firstTriangle;
+            uint32_t triangleCount;
+            glm::vec3 centroid;
+            glm::vec3 normal;
+            float area;
+            float sortKey;
+        };
+
+        std::vector<Cluster> clusterData(clusters.size());
+        glm::vec3 meshCentroid(0);
+        float meshArea = 0;
+        for (size_t c = 0; c < clusters.size(); c++)
+        {
+            Cluster& cluster = clusterData[c];
+            cluster.firstTriangle = clusters[c];
+            cluster.triangleCount = ((c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount) - clusters[c];
+            cluster.centroid = glm::vec3(0);
+            cluster.normal = glm::vec3(0);
+            cluster.area = 0;
+            for (uint32_t t = cluster.firstTriangle; t < cluster.firstTriangle + cluster.triangleCount; t++)
+            {
+                const glm::vec3& p0 = getPosition(pPositions, positionStride, pIndices[t * 3]);
+                const glm::vec3& p1 = getPosition(pPositions, positionStride, pIndices[t * 3 + 1]);
+                const glm::vec3& p2 = getPosition(pPositions, positionStride, pIndices[t * 3 + 2]);
+                glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+                float area = glm::length(n);
+                cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+                cluster.normal += n;
+                cluster.area += area;
+            }
+            meshCentroid += cluster.centroid;
+            meshArea += cluster.area;
+            if (cluster.area > 0) cluster.centroid /= cluster.area;
+        }
+        if (meshArea > 0) meshCentroid /= meshArea;
+
+        // Clusters on the outside of the mesh, facing away from its center, are likely to occlude the rest of the mesh
+        for (Cluster& cluster : clusterData)
+        {
+            float length = glm::length(cluster.normal);
+            cluster.sortKey = (length > 0) ? glm::dot(cluster.centroid - meshCentroid, cluster.normal / length) : 0;
+        }
+
+        std::vector<uint32_t> order(clusterData.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return clusterData[a].sortKey > clusterData[b].sortKey; });
+
+        std::vector<uint32_t> sorted;
+        sorted.reserve(indexCount);
+        for (uint32_t c : order)
+        {
+            const Cluster& cluster = clusterData[c];
+            sorted.insert(sorted.end(), pIndices + cluster.firstTriangle * 3, pIndices + (cluster.firstTriangle + cluster.triangleCount) * 3);
+        }
+
+        // Don't give up too much of the vertex cache efficiency
+        float acmr = analyzeVertexCache(pIndices, indexCount, vertexCount).acmr;
+        float sortedAcmr = analyzeVertexCache(sorted.data(), indexCount, vertexCount).acmr;
+        if (sortedAcmr <= acmr * threshold)
+        {
+            std::memcpy(pIndices, sorted.data(), indexCount * sizeof(uint32_t));
+        }
+    }
+
+    std::vector<uint32_t> MeshOptimizer::optimizeVertexFetch(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount)
+    {
+        std::vector<uint32_t> oldToNew(vertexCount, kInvalidIndex);
+        uint32_t nextVertex = 0;
+        for (uint32_t i = 0; i < indexCount; i++)
+        {
+            uint32_t& newIndex = oldToNew[pIndices[i]];
+            if (newIndex == kInvalidIndex) newIndex = nextVertex++;
+            pIndices[i] = newIndex;
+        }
+
+        std::vector<uint32_t> remap(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            if (oldToNew[v] == kInvalidIndex) oldToNew[v] = nextVertex++;
+            remap[oldToNew[v]] = v;
+        }
+        return remap;
+    }
+
+    void MeshOptimizer::remapVertexBuffer(const std::vector<uint32_t>& remap, uint32_t stride, std::vector<uint8_t>& data)
+    {
+        assert(data.size() == remap.size() * stride);
+        std::vector<uint8_t> remapped(data.size());
+        for (size_t v = 0; v < remap.size(); v++)
+        {
+            std::memcpy(remapped.data() + v * stride, data.data() + size_t(remap[v]) * stride, stride);
+        }
+        data.swap(remapped);
+    }
+}
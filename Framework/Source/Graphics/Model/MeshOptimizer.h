@@ -0,0 +1,98 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Import-time optimizations of indexed triangle lists. Used by the model importers when Model::LoadFlags::OptimizeMeshes is set.
+        The passes should run in this order, since each one preserves the gains of the previous ones:
+        1) optimizeVertexCache() reorders the triangles for the post-transform vertex cache and splits them into clusters.
+        2) optimizeOverdraw() reorders the clusters so that triangles likely to occlude others are drawn first.
+        3) optimizeVertexFetch() reorders the vertices in the order they are first referenced.
+    */
+    class MeshOptimizer
+    {
+    public:
+        static const uint32_t kDefaultCacheSize = 16;
+
+        /** Post-transform vertex cache efficiency of an index buffer, simulated with a FIFO cache
+        */
+        struct CacheStats
+        {
+            uint32_t misses = 0;
+            float acmr = 0;     ///< Average cache miss ratio - vertex shader invocations per triangle. 0.5 is the best possible value, 3 the worst
+            float atvr = 0;     ///< Average transform to vertex ratio - vertex shader invocations per referenced vertex. 1 is the best possible value
+        };
+
+        /** Simulate the post-transform vertex cache
+            \param[in] pIndices Triangle list indices
+            \param[in] indexCount Number of indices
+            \param[in] vertexCount Number of vertices in the vertex buffers
+            \param[in] cacheSize Number of entries in the simulated FIFO cache
+        */
+        static CacheStats analyzeVertexCache(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kDefaultCacheSize);
+
+        /** Reorder the triangles to reduce the number of vertex shader invocations. Implements Tipsify (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007).
+            \param[in,out] pIndices Triangle list indices
+            \param[in] indexCount Number of indices
+            \param[in] vertexCount Number of vertices in the vertex buffers
+            \param[in] cacheSize The target cache size
+            \return The first triangle of every cluster, to be used by optimizeOverdraw(). A new cluster starts wherever the reordering had to jump to a vertex out of the cache
+        */
+        static std::vector<uint32_t> optimizeVertexCache(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kDefaultCacheSize);
+
+        /** Reorder the clusters created by optimizeVertexCache() to reduce overdraw. Clusters which face away from the mesh's center are drawn first.
+            Doesn't change the order of the triangles inside a cluster. If sorting the clusters increases the ACMR by more than a factor of threshold, the order is left unchanged.
+            \param[in,out] pIndices Triangle list indices
+            \param[in] indexCount Number of indices
+            \param[in] clusters The clusters' first triangles, in ascending order
+            \param[in] pPositions The vertex positions. Only xyz is used
+            \param[in] positionStride The distance in bytes between consecutive positions
+            \param[in] vertexCount Number of vertices in the vertex buffers
+            \param[in] threshold The allowed ACMR increase
+        */
+        static void optimizeOverdraw(uint32_t* pIndices, uint32_t indexCount, const std::vector<uint32_t>& clusters, const void* pPositions, uint32_t positionStride, uint32_t vertexCount, float threshold = 1.05f);
+
+        /** Reorder the vertices in the order the index buffer first references them, and update the indices. Unreferenced vertices are moved to the end.
+            \param[in,out] pIndices Triangle list indices
+            \param[in] indexCount Number of indices
+            \param[in] vertexCount Number of vertices in the vertex buffers
+            \return For every new vertex, the index of the original vertex. Pass it to remapVertexBuffer() for every vertex buffer of the mesh
+        */
+        static std::vector<uint32_t> optimizeVertexFetch(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount);
+
+        /** Reorder a vertex buffer using the table returned by optimizeVertexFetch()
+            \param[in] remap For every new vertex, the index of the original vertex
+            \param[in] stride The vertex size in bytes
+            \param[in,out] data The vertex buffer data
+        */
+        static void remapVertexBuffer(const std::vector<uint32_t>& remap, uint32_t stride, std::vector<uint8_t>& data);
+    };
+}
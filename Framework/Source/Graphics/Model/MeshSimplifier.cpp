@@ -0,0 +1,341 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidIndex = uint32_t(-1);
+        const uint32_t kMinLodTriangles = 32;       // Don't simplify meshes smaller than that any further
+        const float kMinLodReduction = 0.9f;        // A level must have at most that fraction of the previous level's indices
+        const float kMaxNormalChange = 0.25f;       // Reject collapses which rotate a triangle's normal by more than acos(kMaxNormalChange)
+
+        /** Sum of squared distances to a set of planes, weighted by the area of the triangles they came from
+        */
+        struct Quadric
+        {
+            double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+            double b0 = 0, b1 = 0, b2 = 0;
+            double c = 0;
+            double weight = 0;
+
+            void addPlane(const glm::vec3& n, float d, float area)
+            {
+                double w = area;
+                a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+                a11 += w * n.y * n.y; a12 += w * n.y * n.z; a22 += w * n.z * n.z;
+                b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+                c += w * d * d;
+                weight += w;
+            }
+
+            Quadric& operator+=(const Quadric& q)
+            {
+                a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+                b0 += q.b0; b1 += q.b1; b2 += q.b2;
+                c += q.c;
+                weight += q.weight;
+                return *this;
+            }
+
+            /** The area-weighted RMS distance of a point to the planes
+            */
+            float getError(const glm::vec3& p) const
+            {
+                if (weight <= 0) return 0;
+                double x = p.x, y = p.y, z = p.z;
+                double e = a00 * x * x + a11 * y * y + a22 * z * z + 2 * (a01 * x * y + a02 * x * z + a12 * y * z) + 2 * (b0 * x + b1 * y + b2 * z) + c;
+                return (float)std::sqrt(std::max(e, 0.0) / weight);
+            }
+        };
+
+        struct Collapse
+        {
+            uint32_t from;
+            uint32_t to;
+            float error;
+        };
+
+        class Simplifier
+        {
+        public:
+            Simplifier(const uint32_t* pIndices, uint32_t indexCount, const void* pPositions, uint32_t positionStride, uint32_t vertexCount)
+                : mIndices(pIndices, pIndices + indexCount), mpPositions((const uint8_t*)pPositions), mPositionStride(positionStride), mVertexCount(vertexCount)
+            {
+                lockVertices();
+                initQuadrics();
+                mRemap.resize(vertexCount);
+                std::iota(mRemap.begin(), mRemap.end(), 0);
+            }
+
+            std::vector<uint32_t> run(uint32_t targetIndexCount, float maxError, float& error)
+            {
+                error = 0;
+                uint32_t triangleCount = (uint32_t)mIndices.size() / 3;
+                const uint32_t targetTriangleCount = targetIndexCount / 3;
+                std::vector<uint8_t> touched(mVertexCount);
+
+                // Every pass collapses each vertex at most once, using the cheapest collapses first, then rebuilds the mesh
+                while (triangleCount > targetTriangleCount)
+                {
+                    buildAdjacency();
+                    std::vector<Collapse> collapses = findCollapses();
+                    std::fill(touched.begin(), touched.end(), 0);
+
+                    bool collapsed = false;
+                    for (const Collapse& c : collapses)
+                    {
+                        if (c.error > maxError || triangleCount <= targetTriangleCount) break;
+                        if (touched[c.from] || touched[c.to]) continue;
+
+                        uint32_t removedTriangles = 0;
+                        if (isValidCollapse(c.from, c.to, removedTriangles) == false) continue;
+
+                        mRemap[c.from] = c.to;
+                        mQuadrics[c.to] += mQuadrics[c.from];
+                        touched[c.from] = touched[c.to] = 1;
+                        triangleCount -= removedTriangles;
+                        error = std::max(error, c.error);
+                        collapsed = true;
+                    }
+
+                    applyRemap();
+                    triangleCount = (uint32_t)mIndices.size() / 3;
+                    if (collapsed == false) break;
+                }
+                return mIndices;
+            }
+
+        private:
+            const glm::vec3& getPosition(uint32_t v) const
+            {
+                return *(const glm::vec3*)(mpPositions + size_t(v) * mPositionStride);
+            }
+
+            void lockVertices()
+            {
+                mLocked.assign(mVertexCount, 0);
+
+                // Attribute seams. The vertices are sorted by position, so vertices sharing a position are next to each other
+                std::vector<uint32_t> order(mVertexCount);
+                std::iota(order.begin(), order.end(), 0);
+                auto lessPosition = [this](uint32_t a, uint32_t b)
+                {
+                    const glm::vec3& pa = getPosition(a);
+                    const glm::vec3& pb = getPosition(b);
+                    if (pa.x != pb.x) return pa.x < pb.x;
+                    if (pa.y != pb.y) return pa.y < pb.y;
+                    return pa.z < pb.z;
+                };
+                std::sort(order.begin(), order.end(), lessPosition);
+                for (size_t i = 1; i < order.size(); i++)
+                {
+                    if (getPosition(order[i - 1]) == getPosition(order[i])) mLocked[order[i - 1]] = mLocked[order[i]] = 1;
+                }
+
+                // Open borders and non-manifold edges, i.e. edges which aren't shared by exactly two triangles
+                std::vector<uint64_t> edges;
+                edges.reserve(mIndices.size());
+                for (size_t t = 0; t < mIndices.size(); t += 3)
+                {
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        uint64_t a = mIndices[t + i];
+                        uint64_t b = mIndices[t + (i + 1) % 3];
+                        edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+                    }
+                }
+                std::sort(edges.begin(), edges.end());
+                for (size_t i = 0; i < edges.size();)
+                {
+                    size_t j = i;
+                    while (j < edges.size() && edges[j] == edges[i]) j++;
+                    if (j - i != 2)
+                    {
+                        mLocked[uint32_t(edges[i] >> 32)] = 1;
+                        mLocked[uint32_t(edges[i])] = 1;
+                    }
+                    i = j;
+                }
+            }
+
+            void initQuadrics()
+            {
+                mQuadrics.assign(mVertexCount, Quadric());
+                for (size_t t = 0; t < mIndices.size(); t += 3)
+                {
+                    const glm::vec3& p0 = getPosition(mIndices[t]);
+                    glm::vec3 n = glm::cross(getPosition(mIndices[t + 1]) - p0, getPosition(mIndices[t + 2]) - p0);
+                    float length = glm::length(n);
+                    if (length == 0) continue;
+                    n /= length;
+                    float d = -glm::dot(n, p0);
+                    for (uint32_t i = 0; i < 3; i++) mQuadrics[mIndices[t + i]].addPlane(n, d, length * 0.5f);
+                }
+            }
+
+            void buildAdjacency()
+            {
+                mAdjacencyOffsets.assign(mVertexCount + 1, 0);
+                for (uint32_t index : mIndices) mAdjacencyOffsets[index + 1]++;
+                for (uint32_t v = 0; v < mVertexCount; v++) mAdjacencyOffsets[v + 1] += mAdjacencyOffsets[v];
+
+                mAdjacency.resize(mIndices.size());
+                std::vector<uint32_t> cursor(mAdjacencyOffsets.begin(), mAdjacencyOffsets.end() - 1);
+                for (uint32_t i = 0; i < (uint32_t)mIndices.size(); i++) mAdjacency[cursor[mIndices[i]]++] = i / 3;
+            }
+
+            /** Find the cheapest collapse of every vertex, sorted by increasing error
+            */
+            std::vector<Collapse> findCollapses() const
+            {
+                std::vector<Collapse> best(mVertexCount, { kInvalidIndex, kInvalidIndex, FLT_MAX });
+                auto consider = [&](uint32_t from, uint32_t to)
+                {
+                    if (mLocked[from]) return;
+                    Quadric q = mQuadrics[from];
+                    q += mQuadrics[to];
+                    float error = q.getError(getPosition(to));
+                    if (error < best[from].error) best[from] = { from, to, error };
+                };
+
+                for (size_t t = 0; t < mIndices.size(); t += 3)
+                {
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        uint32_t a = mIndices[t + i];
+                        uint32_t b = mIndices[t + (i + 1) % 3];
+                        consider(a, b);
+                        consider(b, a);
+                    }
+                }
+
+                std::vector<Collapse> collapses;
+                for (const Collapse& c : best)
+                {
+                    if (c.from != kInvalidIndex) collapses.push_back(c);
+                }
+                std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return (a.error != b.error) ? (a.error < b.error) : (a.from < b.from); });
+                return collapses;
+            }
+
+            /** Check that moving a vertex doesn't flip any of the triangles around it. The collapses performed earlier in the pass are taken into account through the remap table
+            */
+            bool isValidCollapse(uint32_t from, uint32_t to, uint32_t& removedTriangles) const
+            {
+                removedTriangles = 0;
+                for (uint32_t a = mAdjacencyOffsets[from]; a < mAdjacencyOffsets[from + 1]; a++)
+                {
+                    const uint32_t* pTriangle = &mIndices[mAdjacency[a] * 3];
+                    uint32_t v[3] = { mRemap[pTriangle[0]], mRemap[pTriangle[1]], mRemap[pTriangle[2]] };
+                    if (v[0] == v[1] || v[1] == v[2] || v[0] == v[2]) continue;
+                    if (v[0] == to || v[1] == to || v[2] == to)
+                    {
+                        removedTriangles++;
+                        continue;
+                    }
+
+                    glm::vec3 p[3] = { getPosition(v[0]), getPosition(v[1]), getPosition(v[2]) };
+                    glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        if (v[i] == from) p[i] = getPosition(to);
+                    }
+                    glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+                    float lengthBefore = glm::length(before);
+                    if (lengthBefore == 0) continue;
+                    if (glm::dot(before, after) <= kMaxNormalChange * lengthBefore * glm::length(after)) return false;
+                }
+                return true;
+            }
+
+            void applyRemap()
+            {
+                size_t count = 0;
+                for (size_t t = 0; t < mIndices.size(); t += 3)
+                {
+                    uint32_t v[3] = { mRemap[mIndices[t]], mRemap[mIndices[t + 1]], mRemap[mIndices[t + 2]] };
+                    if (v[0] == v[1] || v[1] == v[2] || v[0] == v[2]) continue;
+                    for (uint32_t i = 0; i < 3; i++) mIndices[count++] = v[i];
+                }
+                mIndices.resize(count);
+            }
+
+            std::vector<uint32_t> mIndices;
+            const uint8_t* mpPositions;
+            uint32_t mPositionStride;
+            uint32_t mVertexCount;
+            std::vector<uint8_t> mLocked;
+            std::vector<Quadric> mQuadrics;
+            std::vector<uint32_t> mRemap;
+            std::vector<uint32_t> mAdjacencyOffsets;
+            std::vector<uint32_t> mAdjacency;
+        };
+    }
+
+    std::vector<uint32_t> MeshSimplifier::simplify(const uint32_t* pIndices, uint32_t indexCount, const void* pPositions, uint32_t positionStride, uint32_t vertexCount, uint32_t targetIndexCount, float maxError, float* pError)
+    {
+        assert(indexCount % 3 == 0);
+        float error = 0;
+        Simplifier simplifier(pIndices, indexCount, pPositions, positionStride, vertexCount);
+        std::vector<uint32_t> indices = simplifier.run(targetIndexCount, maxError, error);
+        if (pError) *pError = error;
+        return indices;
+    }
+
+    std::vector<MeshSimplifier::Lod> MeshSimplifier::generateLodChain(const uint32_t* pIndices, uint32_t indexCount, const void* pPositions, uint32_t positionStride, uint32_t vertexCount, uint32_t maxLodCount)
+    {
+        std::vector<Lod> lods;
+        const uint32_t* pCurrent = pIndices;
+        uint32_t currentCount = indexCount;
+        float error = 0;
+        while (lods.size() < maxLodCount && currentCount / 3 > kMinLodTriangles)
+        {
+            float levelError = 0;
+            std::vector<uint32_t> indices = simplify(pCurrent, currentCount, pPositions, positionStride, vertexCount, (currentCount / 6) * 3, FLT_MAX, &levelError);
+            if (indices.size() > currentCount * kMinLodReduction) break;
+
+            // Each level is simplified from the previous one, so the distances to the full-resolution mesh add up
+            error += levelError;
+            Lod lod;
+            lod.indices = std::move(indices);
+            lod.error = error;
+            lods.push_back(std::move(lod));
+            pCurrent = lods.back().indices.data();
+            currentCount = (uint32_t)lods.back().indices.size();
+        }
+        return lods;
+    }
+}
@@ -0,0 +1,74 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Quadric error mesh simplification (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics", 1997) of indexed triangle lists.
+        Edges are collapsed onto one of their existing vertices, so the simplified meshes reference a subset of the original vertices and can share the original vertex buffers.
+        Vertices on open borders, attribute seams (vertices with the same position) and non-manifold edges are never moved.
+    */
+    class MeshSimplifier
+    {
+    public:
+        /** A simplified level of detail
+        */
+        struct Lod
+        {
+            std::vector<uint32_t> indices;
+            float error = 0;    ///< Estimated object-space distance to the full-resolution mesh
+        };
+
+        /** Simplify a mesh
+            \param[in] pIndices Triangle list indices
+            \param[in] indexCount Number of indices
+            \param[in] pPositions The vertex positions. Only xyz is used
+            \param[in] positionStride The distance in bytes between consecutive positions
+            \param[in] vertexCount Number of vertices in the vertex buffers
+            \param[in] targetIndexCount Stop once the mesh has at most this many indices
+            \param[in] maxError Stop before a collapse would move the surface by more than this object-space distance
+            \param[out] pError Optional. The largest error of the performed collapses
+            \return The simplified indices
+        */
+        static std::vector<uint32_t> simplify(const uint32_t* pIndices, uint32_t indexCount, const void* pPositions, uint32_t positionStride, uint32_t vertexCount, uint32_t targetIndexCount, float maxError, float* pError = nullptr);
+
+        /** Create a chain of levels of detail. Every level has about half the triangles of the previous one.
+            The chain ends when simplification stops making progress, when the mesh gets very small or after maxLodCount levels.
+            \param[in] pIndices Triangle list indices
+            \param[in] indexCount Number of indices
+            \param[in] pPositions The vertex positions. Only xyz is used
+            \param[in] positionStride The distance in bytes between consecutive positions
+            \param[in] vertexCount Number of vertices in the vertex buffers
+            \param[in] maxLodCount The maximum number of levels to create, not counting the full-resolution mesh
+            \return The levels, from the most to the least detailed. Doesn't include the full-resolution mesh
+        */
+        static std::vector<Lod> generateLodChain(const uint32_t* pIndices, uint32_t indexCount, const void* pPositions, uint32_t positionStride, uint32_t vertexCount, uint32_t maxLodCount);
+    };
+}
@@ -0,0 +1,268 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Meshlet.h"
+#include "Graphics/Camera/Camera.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidIndex = uint32_t(-1);
+
+        void computeMeshletBounds(const uint32_t* pIndices, const void* pPositions, uint32_t positionStride, Meshlet& meshlet)
+        {
+            auto getPosition = [&](uint32_t vertex) { return *(const glm::vec3*)((const uint8_t*)pPositions + size_t(vertex) * positionStride); };
+            const uint32_t* pMeshletIndices = pIndices + meshlet.startIndex;
+            const uint32_t indexCount = meshlet.triangleCount * 3;
+
+            // Bounding sphere around the center of the bounding box
+            glm::vec3 minPos(FLT_MAX);
+            glm::vec3 maxPos(-FLT_MAX);
+            for (uint32_t i = 0; i < indexCount; i++)
+            {
+                minPos = glm::min(minPos, getPosition(pMeshletIndices[i]));
+                maxPos = glm::max(maxPos, getPosition(pMeshletIndices[i]));
+            }
+            meshlet.center = (minPos + maxPos) * 0.5f;
+            float radiusSq = 0;
+            for (uint32_t i = 0; i < indexCount; i++)
+            {
+                glm::vec3 d = getPosition(pMeshletIndices[i]) - meshlet.center;
+                radiusSq = std::max(radiusSq, glm::dot(d, d));
+            }
+            meshlet.radius = std::sqrt(radiusSq);
+
+            // Normal cone. Degenerate triangles are ignored, since they are never rasterized
+            std::vector<glm::vec3> normals;
+            normals.reserve(meshlet.triangleCount);
+            glm::vec3 axis(0);
+            for (uint32_t i = 0; i < indexCount; i += 3)
+            {
+                const glm::vec3 p0 = getPosition(pMeshletIndices[i]);
+                glm::vec3 n = glm::cross(getPosition(pMeshletIndices[i + 1]) - p0, getPosition(pMeshletIndices[i + 2]) - p0);
+                float length = glm::length(n);
+                if (length > 0)
+                {
+                    normals.push_back(n / length);
+                    axis += normals.back();
+                }
+            }
+
+            meshlet.coneAxis = glm::vec3(0);
+            meshlet.coneCutoff = 0;
+            float axisLength = glm::length(axis);
+            if (axisLength > 1e-6f)
+            {
+                meshlet.coneAxis = axis / axisLength;
+                float minDot = 1;
+                for (const auto& n : normals) minDot = std::min(minDot, glm::dot(n, meshlet.coneAxis));
+                meshlet.coneCutoff = std::max(minDot, 0.0f);
+            }
+        }
+    }
+
+    std::vector<Meshlet> MeshletBuilder::build(uint32_t* pIndices, uint32_t indexCount, const void* pPositions, uint32_t positionStride, uint32_t vertexCount)
+    {
+        const uint32_t triangleCount = indexCount / 3;
+        auto getPosition = [&](uint32_t vertex) { return *(const glm::vec3*)((const uint8_t*)pPositions + size_t(vertex) * positionStride); };
+
+        // Vertex to triangle adjacency
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (uint32_t i = 0; i < triangleCount * 3; i++) adjacencyOffsets[pIndices[i] + 1]++;
+        for (uint32_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        {
+            std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (uint32_t i = 0; i < triangleCount * 3; i++) adjacency[cursor[pIndices[i]]++] = i / 3;
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> vertexMeshlet(vertexCount, kInvalidIndex);   // The last meshlet which referenced the vertex
+        std::vector<uint32_t> order;
+        order.reserve(triangleCount);
+        std::vector<uint32_t> meshletVertices;
+        meshletVertices.reserve(kMaxVertices);
+        std::vector<Meshlet> meshlets;
+        uint32_t nextSeed = 0;
+
+        while (order.size() < triangleCount)
+        {
+            const uint32_t meshletID = (uint32_t)meshlets.size();
+            Meshlet meshlet;
+            meshlet.startIndex = (uint32_t)order.size() * 3;
+            meshletVertices.clear();
+            glm::vec3 positionSum(0);
+
+            auto countNewVertices = [&](uint32_t triangle)
+            {
+                uint32_t count = 0;
+                for (uint32_t i = 0; i < 3; i++) count += (vertexMeshlet[pIndices[triangle * 3 + i]] != meshletID) ? 1 : 0;
+                return count;
+            };
+
+            // Seed with the first unused triangle
+            while (emitted[nextSeed]) nextSeed++;
+            uint32_t best = nextSeed;
+            uint32_t bestNewVertices = 3;
+
+            while (true)
+            {
+                emitted[best] = true;
+                order.push_back(best);
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    uint32_t vertex = pIndices[best * 3 + i];
+                    if (vertexMeshlet[vertex] != meshletID)
+                    {
+                        vertexMeshlet[vertex] = meshletID;
+                        meshletVertices.push_back(vertex);
+                        positionSum += getPosition(vertex);
+                    }
+                }
+                meshlet.triangleCount++;
+                if (meshlet.triangleCount == kMaxTriangles) break;
+
+                // Add the adjacent triangle which needs the fewest new vertices. Break ties by distance to the meshlet's center, which keeps the meshlets compact
+                const glm::vec3 center = positionSum / float(meshletVertices.size());
+                best = kInvalidIndex;
+                bestNewVertices = 4;
+                float bestDistance = FLT_MAX;
+                for (uint32_t vertex : meshletVertices)
+                {
+                    for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++)
+                    {
+                        uint32_t triangle = adjacency[a];
+                        if (emitted[triangle]) continue;
+                        uint32_t newVertices = countNewVertices(triangle);
+                        if (newVertices > bestNewVertices) continue;
+
+                        const uint32_t* pTriangle = pIndices + triangle * 3;
+                        glm::vec3 d = (getPosition(pTriangle[0]) + getPosition(pTriangle[1]) + getPosition(pTriangle[2])) / 3.0f - center;
+                        float distance = glm::dot(d, d);
+                        if (newVertices < bestNewVertices || distance < bestDistance)
+                        {
+                            best = triangle;
+                            bestNewVertices = newVertices;
+                            bestDistance = distance;
+                        }
+                    }
+                }
+
+                // Disconnected triangles would make the bounds loose, so start a new meshlet instead
+                if (best == kInvalidIndex || meshletVertices.size() + bestNewVertices > kMaxVertices) break;
+            }
+
+            meshlet.vertexCount = (uint32_t)meshletVertices.size();
+            meshlets.push_back(meshlet);
+        }
+
+        // Write the triangles in meshlet order
+        std::vector<uint32_t> source(pIndices, pIndices + triangleCount * 3);
+        for (uint32_t t = 0; t < triangleCount; t++)
+        {
+            for (uint32_t i = 0; i < 3; i++) pIndices[t * 3 + i] = source[order[t] * 3 + i];
+        }
+
+        for (auto& meshlet : meshlets) computeMeshletBounds(pIndices, pPositions, positionStride, meshlet);
+        return meshlets;
+    }
+
+    void MeshletCuller::cull(const std::vector<Meshlet>& meshlets, const glm::mat4& world, const Camera* pCamera, bool backfaceCulling, bool frontCcw, std::vector<IndexRange>& ranges, Stats& stats)
+    {
+        ranges.clear();
+
+        const glm::vec3 axes[3] = { glm::vec3(world[0]), glm::vec3(world[1]), glm::vec3(world[2]) };
+        const float scale = std::max(glm::length(axes[0]), std::max(glm::length(axes[1]), glm::length(axes[2])));
+
+        // The normal cones are only valid for rotations, uniform scaling and mirroring. Perspective is needed to get the view direction from the camera position
+        if (backfaceCulling)
+        {
+            const float tolerance = 1e-3f * scale * scale;
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                backfaceCulling = backfaceCulling && (std::abs(glm::dot(axes[i], axes[i]) - scale * scale) <= tolerance) && (std::abs(glm::dot(axes[i], axes[(i + 1) % 3])) <= tolerance);
+            }
+            backfaceCulling = backfaceCulling && (pCamera->getProjMatrix()[3][3] == 0);
+        }
+
+        // Mirroring flips the winding of the triangles, and so does a clockwise front face
+        const bool mirrored = glm::dot(axes[0], glm::cross(axes[1], axes[2])) < 0;
+        const float axisSign = (mirrored == frontCcw) ? -1.0f : 1.0f;
+        const glm::mat3 rotation = glm::mat3(world) * (axisSign / std::max(scale, FLT_MIN));
+        const glm::vec3 cameraPos = pCamera->getPosition();
+
+        for (const auto& meshlet : meshlets)
+        {
+            stats.meshletCount++;
+            stats.triangleCount += meshlet.triangleCount;
+
+            BoundingBox box;
+            box.center = glm::vec3(world * glm::vec4(meshlet.center, 1));
+            box.extent = glm::vec3(meshlet.radius * scale);
+            if (pCamera->isObjectCulled(box))
+            {
+                stats.frustumCulledCount++;
+                continue;
+            }
+
+            if (backfaceCulling && meshlet.coneCutoff > 0)
+            {
+                // Every point of the bounding sphere sees every normal of the cone from behind
+                const glm::vec3 axis = rotation * meshlet.coneAxis;
+                const glm::vec3 view = box.center - cameraPos;
+                const float radius = box.extent.x;
+                const float along = glm::dot(view, axis);
+                const float across = std::sqrt(std::max(glm::dot(view, view) - along * along, 0.0f));
+                const float sinAngle = std::sqrt(std::max(1 - meshlet.coneCutoff * meshlet.coneCutoff, 0.0f));
+                if ((along - radius) * meshlet.coneCutoff > (across + radius) * sinAngle)
+                {
+                    stats.backfaceCulledCount++;
+                    continue;
+                }
+            }
+
+            stats.visibleTriangleCount += meshlet.triangleCount;
+            if (ranges.empty() == false && ranges.back().startIndex + ranges.back().indexCount == meshlet.startIndex)
+            {
+                ranges.back().indexCount += meshlet.triangleCount * 3;
+            }
+            else
+            {
+                IndexRange range;
+                range.startIndex = meshlet.startIndex;
+                range.indexCount = meshlet.triangleCount * 3;
+                ranges.push_back(range);
+            }
+        }
+        stats.rangeCount += (uint32_t)ranges.size();
+    }
+}
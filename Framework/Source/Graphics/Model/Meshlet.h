@@ -0,0 +1,113 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
+
+namespace Falcor
+{
+    class Camera;
+
+    /** A cluster of up to MeshletBuilder::kMaxVertices vertices and MeshletBuilder::kMaxTriangles triangles, stored as a contiguous range of the mesh's index buffer.
+        The bounds are in the mesh's object space.
+    */
+    struct Meshlet
+    {
+        uint32_t startIndex = 0;        ///< First index of the meshlet in the index buffer
+        uint32_t triangleCount = 0;
+        uint32_t vertexCount = 0;       ///< Number of unique vertices referenced by the meshlet
+        glm::vec3 center;               ///< Bounding sphere center
+        float radius = 0;               ///< Bounding sphere radius
+        glm::vec3 coneAxis;             ///< Average direction of the triangle normals, for counter-clockwise triangles
+        float coneCutoff = 0;           ///< Cosine of the angle between the axis and the normal furthest from it. 0 if the normals span a hemisphere or more, in which case the meshlet is never back-facing
+    };
+
+    /** Partitions indexed triangle lists into meshlets
+    */
+    class MeshletBuilder
+    {
+    public:
+        static const uint32_t kMaxVertices = 64;
+        static const uint32_t kMaxTriangles = 124;
+
+        /** Split a mesh into meshlets. The triangles are reordered so that every meshlet is a contiguous range of indices.
+            Each meshlet is grown from the first unused triangle by adding the adjacent triangle which references the fewest new vertices, until it is full or has no unused neighbors left.
+            \param[in,out] pIndices Triangle list indices. Reordered in place
+            \param[in] indexCount Number of indices
+            \param[in] pPositions The vertex positions. Only xyz is used
+            \param[in] positionStride The distance in bytes between consecutive positions
+            \param[in] vertexCount Number of vertices in the vertex buffers
+            \return The meshlets, in index buffer order
+        */
+        static std::vector<Meshlet> build(uint32_t* pIndices, uint32_t indexCount, const void* pPositions, uint32_t positionStride, uint32_t vertexCount);
+    };
+
+    /** Culls meshlets on the CPU and compacts the visible ones into index ranges
+    */
+    class MeshletCuller
+    {
+    public:
+        /** A range of the index buffer to draw
+        */
+        struct IndexRange
+        {
+            uint32_t startIndex = 0;
+            uint32_t indexCount = 0;
+        };
+
+        /** Culling statistics. cull() accumulates into them, so they can be summed over several meshes
+        */
+        struct Stats
+        {
+            uint32_t meshletCount = 0;          ///< Number of tested meshlets
+            uint32_t frustumCulledCount = 0;    ///< Number of meshlets outside the view frustum
+            uint32_t backfaceCulledCount = 0;   ///< Number of meshlets inside the frustum, but facing away from the camera
+            uint32_t rangeCount = 0;            ///< Number of emitted index ranges
+            uint64_t triangleCount = 0;         ///< Number of triangles in the tested meshlets
+            uint64_t visibleTriangleCount = 0;  ///< Number of triangles in the emitted ranges
+
+            /** Get the fraction of the tested triangles which were culled
+            */
+            float getCulledTriangleRatio() const { return triangleCount ? 1.0f - float(visibleTriangleCount) / float(triangleCount) : 0.0f; }
+        };
+
+        /** Cull meshlets against the camera frustum and, optionally, their normal cones against the camera position.
+            Back-face culling is skipped for transforms with non-uniform scale or shear, since they don't preserve the normal cones.
+            \param[in] meshlets The meshlets, in index buffer order
+            \param[in] world The object to world transform
+            \param[in] pCamera The camera
+            \param[in] backfaceCulling Whether to cull meshlets which only contain back-facing triangles. Only enable it when the rasterizer culls back faces
+            \param[in] frontCcw Whether counter-clockwise triangles are front-facing
+            \param[out] ranges The index ranges of the visible meshlets. Adjacent visible meshlets are merged into a single range
+            \param[in,out] stats Statistics, accumulated with the results
+        */
+        static void cull(const std::vector<Meshlet>& meshlets, const glm::mat4& world, const Camera* pCamera, bool backfaceCulling, bool frontCcw, std::vector<IndexRange>& ranges, Stats& stats);
+    };
+}
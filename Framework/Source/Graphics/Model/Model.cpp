@@ -38,14 +38,21 @@
 #include "API/Texture.h"
 #include "Graphics/TextureHelper.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Profiler.h"
+#include "Utils/TaskScheduler.h"
 #include "Graphics/Camera/Camera.h"
 #include "API/VAO.h"
 #include <set>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 namespace Falcor
 {
 
     uint32_t Model::sModelCounter = 0;
+    static std::string gImportCacheDirectory;  // Read by the decoding threads. Protected by gImportCacheMutex
+    static std::mutex gImportCacheMutex;
     const FileDialogFilterVec Model::kFileExtensionFilters = 
     {
         {"obj"},
@@ -123,15 +130,125 @@ namespace Falcor
 
     Model::SharedPtr Model::createFromFile(const char* filename, LoadFlags flags)
     {
+        return createFromDecodedFile(decodeFile(filename, flags));
+    }
+
+    Model::DecodedFile::SharedPtr Model::decodeFile(const std::string& filename, LoadFlags flags)
+    {
+        PROFILE_CPU("Model::decodeFile");
+        if(hasSuffix(filename, ".bin", false))
+        {
+            return BinaryModelImporter::decode(filename, flags);
+        }
+        else
+        {
+            return AssimpModelImporter::decode(filename, flags);
+        }
+    }
+
+    std::vector<Model::DecodedFile::SharedPtr> Model::decodeFiles(const std::vector<std::string>& filenames, const std::vector<LoadFlags>& flags, uint32_t threadCount)
+    {
+        std::vector<DecodedFile::SharedPtr> files(filenames.size());
+        decodeFiles(filenames, flags, threadCount, [&files](uint32_t index, const DecodedFile::SharedPtr& pFile)
+        {
+            files[index] = pFile;
+            return true;
+        });
+        return files;
+    }
+
+    bool Model::decodeFiles(const std::vector<std::string>& filenames, const std::vector<LoadFlags>& flags, uint32_t threadCount, const DecodedFileCallback& onDecoded)
+    {
+        assert(filenames.size() == flags.size());
+        const uint32_t fileCount = (uint32_t)filenames.size();
+
+        const TaskScheduler::SharedPtr& pScheduler = TaskScheduler::getDefault();
+        if(threadCount == 0) threadCount = pScheduler->getWorkerCount() + 1;
+        threadCount = std::min(threadCount, fileCount);
+
+        if(threadCount <= 1)
+        {
+            for(uint32_t i = 0; i < fileCount; i++)
+            {
+                if(onDecoded(i, decodeFile(filenames[i], flags[i])) == false) return false;
+            }
+            return true;
+        }
+
+        // Each task grabs the next file to decode, so large files don't stall the other tasks. Decoded files wait in their slot until the calling thread reaches them
+        std::vector<DecodedFile::SharedPtr> files(fileCount);
+        std::mutex mutex;
+        std::condition_variable fileDecoded;
+        std::atomic<uint32_t> nextFile(0);
+        std::atomic<bool> stopped(false);
+        auto decodeNext = [&]()
+        {
+            uint32_t i = nextFile++;
+            if(i >= fileCount || stopped) return false;
+            DecodedFile::SharedPtr pFile = decodeFile(filenames[i], flags[i]);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                files[i] = pFile;
+            }
+            fileDecoded.notify_all();
+            return true;
+        };
+
+        TaskGroup group(pScheduler.get());
+        for(uint32_t t = 1; t < threadCount; t++) group.run([&]() { while(decodeNext()); });
+
+        bool result = true;
+        for(uint32_t i = 0; i < fileCount && result; i++)
+        {
+            // The calling thread decodes files too until the one it needs is ready
+            DecodedFile::SharedPtr pFile;
+            while(pFile == nullptr)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    if(files[i] == nullptr && nextFile >= fileCount)
+                    {
+                        fileDecoded.wait(lock, [&]() { return files[i] != nullptr; });
+                    }
+                    pFile = std::move(files[i]);
+                }
+                if(pFile == nullptr) decodeNext();
+            }
+
+            result = onDecoded(i, pFile);
+        }
+
+        stopped = (result == false);
+        group.wait();
+        return result;
+    }
+
+    void Model::setImportCacheDirectory(const std::string& directory)
+    {
+        std::lock_guard<std::mutex> lock(gImportCacheMutex);
+        gImportCacheDirectory = directory;
+    }
+
+    std::string Model::getImportCacheDirectory()
+    {
+        std::lock_guard<std::mutex> lock(gImportCacheMutex);
+        if (gImportCacheDirectory.empty()) gImportCacheDirectory = getExecutableDirectory() + "/ModelCache";
+        return gImportCacheDirectory;
+    }
+
+    Model::SharedPtr Model::createFromDecodedFile(const DecodedFile::SharedPtr& pFile)
+    {
+        PROFILE_CPU("Model::createFromDecodedFile");
+        const std::string& filename = pFile->getFilename();
         SharedPtr pModel = SharedPtr(new Model());
         bool res;
         if(hasSuffix(filename, ".bin", false))
         {
-            res = BinaryModelImporter::import(*pModel, filename, flags);
+            res = BinaryModelImporter::import(*pModel, pFile.get());
         }
         else
         {
-            res = AssimpModelImporter::import(*pModel, filename, flags);
+            res = AssimpModelImporter::import(*pModel, pFile.get());
         }
 
         if(res)
@@ -259,13 +376,10 @@ namespace Falcor
         bool changed = false;
         if(mpAnimationController)
         {
-            mpAnimationController->animate(currentTime);
-            changed = true;     // TODO: AnimationController::animate should return changed status. For now just mark it as always changed.
+            changed = mpAnimationController->animate(currentTime);
 
-            if (update())
-            {
-                changed = true;
-            }
+            // The skinned vertices only change with the pose, but the skinning cache may have been attached since the last change
+            update();
         }
         return changed;
     }
@@ -340,6 +454,17 @@ namespace Falcor
         mpAnimationController = std::move(pAnimController);
     }
 
+    AnimationState::SharedPtr Model::createAnimationState() const
+    {
+        return mpAnimationController ? mpAnimationController->createState() : nullptr;
+    }
+
+    bool Model::updateSkinning(const AnimationState* pState)
+    {
+        assert(pState && pState->getController() == mpAnimationController.get());
+        return mpSkinningCache ? mpSkinningCache->update(this, pState) : false;
+    }
+
     void Model::attachSkinningCache(SkinningCache::SharedPtr pSkinningCache)
     {
         mpSkinningCache = pSkinningCache;
@@ -350,14 +475,14 @@ namespace Falcor
         return mpSkinningCache;
     }
 
-    Vao::SharedPtr Model::getMeshVao(const Mesh* pMesh) const
+    Vao::SharedPtr Model::getMeshVao(const Mesh* pMesh, const AnimationState* pState) const
     {
         assert(pMesh);
         Vao::SharedPtr pVao = nullptr;
         if (pMesh->hasBones())
         {
             assert(mpSkinningCache);
-            pVao = mpSkinningCache->getVao(pMesh);
+            pVao = mpSkinningCache->getVao(pMesh, pState);
         }
         else
         {
@@ -68,12 +68,93 @@ namespace Falcor
             RemoveInstancing            = 0x20,   ///< Flatten mesh instances
             UseSpecGlossMaterials       = 0x40,   ///< Set materials to use Spec-Gloss shading model. Otherwise default is Metal-Rough for FBX, Spec-Gloss for OBJ.
             UseMetalRoughMaterials      = 0x80,   ///< Set materials to use Metal-Rough shading model. Otherwise default is Metal-Rough for FBX, Spec-Gloss for OBJ.
+            CacheImportedScene          = 0x100,  ///< Cache the parsed and post-processed scene on disk. Loading an unmodified file again with the same flags skips ASSIMP's parsing and post-processing
+            CompressAnimations          = 0x200,  ///< Remove redundant animation keys and quantize the remaining ones. Reduces the clips' memory at the cost of a small, bounded error
+            OptimizeMeshes              = 0x400,  ///< Reorder the triangles and vertices of triangle meshes for the vertex cache, overdraw and vertex fetch. The statistics are logged as info messages
+            GenerateLods                = 0x800,  ///< Generate a chain of simplified levels of detail for triangle meshes which don't have one. SceneRenderer selects the level based on the mesh's projected size
+            GenerateMeshlets            = 0x1000, ///< Split static triangle meshes into meshlets with bounding spheres and normal cones. SceneRenderer can then cull the meshlets of every mesh instance
+            StreamTextures              = 0x2000, ///< Create 8-bit RGBA textures with only their smallest mips, and stream the finer mips through TextureStreamer::getDefault() as SceneRenderer requests them
+            CompressTextures            = 0x4000, ///< Block-compress the textures which aren't streamed or stored in DDS files. Normal maps use BC5, see TextureCompressor::getCompressedFormat() for the other textures. The results are cached on disk by CompressedTextureCache
+        };
+
+        /** CPU-side contents of a model file, created by decodeFile().
+            Decoding a file doesn't access the device, so files can be decoded on worker threads and turned into models on the main thread.
+        */
+        class DecodedFile
+        {
+        public:
+            using SharedPtr = std::shared_ptr<DecodedFile>;
+            virtual ~DecodedFile() = default;
+
+            /** Get the filename the file was decoded from
+            */
+            const std::string& getFilename() const { return mFilename; }
+
+            /** Get the flags the file was decoded with
+            */
+            LoadFlags getLoadFlags() const { return mFlags; }
+
+            /** Check if decoding succeeded. If not, getError() describes the failure.
+            */
+            bool isValid() const { return mError.empty(); }
+            const std::string& getError() const { return mError; }
+
+        protected:
+            DecodedFile(const std::string& filename, LoadFlags flags) : mFilename(filename), mFlags(flags) {}
+            void setError(const std::string& error) { mError = error; }
+
+            std::string mFilename;
+            LoadFlags mFlags;
+            std::string mError;
         };
 
         /** Create a new model from file
         */
         static SharedPtr createFromFile(const char* filename, LoadFlags flags = LoadFlags::None);
 
+        /** Decode a model file without creating any GPU resources. Can be called from any thread.
+            \param[in] filename Model's filename. Can include a full path or a relative path from a data directory
+            \param[in] flags Flags controlling model creation
+            \return The decoded file. Check DecodedFile::isValid() for errors
+        */
+        static DecodedFile::SharedPtr decodeFile(const std::string& filename, LoadFlags flags = LoadFlags::None);
+
+        /** Decode multiple model files in parallel.
+            \param[in] filenames The model filenames
+            \param[in] flags Flags controlling model creation, one per file
+            \param[in] threadCount Maximum number of files decoded concurrently on the default TaskScheduler. 0 means no limit, 1 decodes all the files on the calling thread
+            \return The decoded files, in the same order as the filenames
+        */
+        static std::vector<DecodedFile::SharedPtr> decodeFiles(const std::vector<std::string>& filenames, const std::vector<LoadFlags>& flags, uint32_t threadCount = 0);
+
+        /** Callback receiving a decoded file. Return false to stop decoding the remaining files
+        */
+        using DecodedFileCallback = std::function<bool(uint32_t index, const DecodedFile::SharedPtr& pFile)>;
+
+        /** Decode multiple model files in parallel, and hand each file to a callback as soon as it and the files before it finished decoding.
+            The callback runs on the calling thread, so it can create the models. Files are released once the callback returns, so only the files decoded out of order are held at the same time.
+            \param[in] filenames The model filenames
+            \param[in] flags Flags controlling model creation, one per file
+            \param[in] threadCount Maximum number of files decoded concurrently. 0 means no limit, 1 decodes all the files on the calling thread
+            \param[in] onDecoded Called for each file, in the same order as the filenames
+            
+eturn false if the callback stopped the decoding, otherwise true
+        */
+        static bool decodeFiles(const std::vector<std::string>& filenames, const std::vector<LoadFlags>& flags, uint32_t threadCount, const DecodedFileCallback& onDecoded);
+
+        /** Create a new model from a decoded file. Creates the GPU resources, so it must be called from the main thread.
+            \return A new model, or nullptr if the file couldn't be decoded or the model creation failed
+        */
+        static SharedPtr createFromDecodedFile(const DecodedFile::SharedPtr& pFile);
+
+        /** Set the directory the scenes cached by LoadFlags::CacheImportedScene are stored in. By default, the cache is stored in a `ModelCache` folder next to the executable
+        */
+        static void setImportCacheDirectory(const std::string& directory);
+
+        /** Get the directory the scenes cached by LoadFlags::CacheImportedScene are stored in. Can be called from any thread
+        */
+        static std::string getImportCacheDirectory();
+
         static SharedPtr create();
 
         static const FileDialogFilterVec kFileExtensionFilters;
@@ -184,9 +265,22 @@ namespace Falcor
         uint32_t getActiveAnimation() const;
 
         /** Set the animation controller for the model.
+            Animation states created for the previous controller must not be used after the controller is replaced.
         */
         void setAnimationController(AnimationController::UniquePtr pAnimController);
 
+        /** Create an animation state, which allows a model instance to play animations independently of the other instances. See ObjectInstance::setAnimationState().
+            The animation clips are shared between the model and all the states.
+            \return A new state playing the bind pose, or nullptr if the model has no bones
+        */
+        AnimationState::SharedPtr createAnimationState() const;
+
+        /** Update the skinned vertex buffers of an instance which has its own animation state. Call after animating the state.
+            Does nothing if no skinning cache is attached.
+            \return true if the skinned vertex buffers changed
+        */
+        bool updateSkinning(const AnimationState* pState);
+
         /** Attach a skinning cache to the model, or nullptr to detach.
             When a cache is attached, the model will use compute shader based skinning with caching of the resulting skinned vertex buffers.
         */
@@ -198,8 +292,10 @@ namespace Falcor
 
         /** Returns a vertex array object with skinned vertex buffers for skinned models, or the original vertex buffers otherwise.
             This function requires a skinning cache to be attached to skinned models.
+            \param[in] pMesh The mesh
+            \param[in] pState The animation state of the model instance, or nullptr for instances using the model's animation
         */
-        Vao::SharedPtr getMeshVao(const Mesh* pMesh) const;
+        Vao::SharedPtr getMeshVao(const Mesh* pMesh, const AnimationState* pState = nullptr) const;
 
         /** Check if the model has bones.
         */
@@ -37,6 +37,7 @@ namespace Falcor
 {
     class SceneRenderer;
     class Model;
+    class AnimationState;
 
     /** Handles transformations for Mesh and Model instances. Primary transform is stored in the "Base" transform. An additional "Movable"
         transform is applied after the Base transform can be set through the IMovableObject interface. This is currently used by paths.
@@ -126,6 +127,7 @@ namespace Falcor
 
             mBase.translation = translation;
             mBase.matrixDirty = true;
+            mTransformVersion++;
         };
 
         /** Gets the position/translation of the instance
@@ -136,7 +138,7 @@ namespace Falcor
         /** Sets scale of the instance
             \param[in] scaling Instance scale
         */
-        void setScaling(const glm::vec3& scaling) { mBase.scale = scaling; mBase.matrixDirty = true; }
+        void setScaling(const glm::vec3& scaling) { mBase.scale = scaling; mBase.matrixDirty = true; mTransformVersion++; }
 
         /** Gets scale of the instance
             \return Scale of the instance
@@ -156,6 +158,7 @@ namespace Falcor
             mBase.target = mBase.translation + rotMtx[2]; // position + forward
 
             mBase.matrixDirty = true;
+            mTransformVersion++;
         }
 
         /** Gets rotation for the instance
@@ -173,11 +176,11 @@ namespace Falcor
 
         /** Sets the up vector orientation
         */
-        void setUpVector(const glm::vec3& up) { mBase.up = glm::normalize(up); mBase.matrixDirty = true; }
+        void setUpVector(const glm::vec3& up) { mBase.up = glm::normalize(up); mBase.matrixDirty = true; mTransformVersion++; }
 
         /** Sets the look-at target
         */
-        void setTarget(const glm::vec3& target) { mBase.target = target; mBase.matrixDirty = true; }
+        void setTarget(const glm::vec3& target) { mBase.target = target; mBase.matrixDirty = true; mTransformVersion++; }
 
         /** Gets the up vector of the instance
             \return Up vector
@@ -213,6 +216,30 @@ namespace Falcor
             return mBoundingBox;
         }
 
+        /** Gets a counter which is incremented every time the transform of the instance changes.
+            Can be used to detect changes to the instance without recalculating its matrices.
+        */
+        uint32_t getTransformVersion() const { return mTransformVersion; }
+
+        /** Sets the animation state of the instance. Instances with a state are animated independently of the other instances of the object, which share the object's own animation.
+            Only used by model instances. Create the state with Model::createAnimationState(). States can't be shared between instances
+            \param[in] pState The animation state, or nullptr to use the object's animation
+        */
+        void setAnimationState(const std::shared_ptr<AnimationState>& pState)
+        {
+            // Release the skinned vertex buffers of the previous state
+            if (mpAnimationState && mpAnimationState != pState && mpObject->getSkinningCache())
+            {
+                mpObject->getSkinningCache()->release(mpAnimationState.get());
+            }
+            mpAnimationState = pState;
+        }
+
+        /** Gets the animation state of the instance
+            \return The instance's animation state, or nullptr if the instance uses the object's animation
+        */
+        const std::shared_ptr<AnimationState>& getAnimationState() const { return mpAnimationState; }
+
         /** IMovableObject interface
         */
         virtual void move(const glm::vec3& position, const glm::vec3& target, const glm::vec3& up) override
@@ -222,6 +249,7 @@ namespace Falcor
             mMovable.up = up;
             mMovable.scale = glm::vec3(1.0f);
             mMovable.matrixDirty = true;
+            mTransformVersion++;
         }
 
         SharedPtr shared_from_this()
@@ -310,6 +338,8 @@ namespace Falcor
 
         std::string mName;
         bool mVisible = true;
+        std::shared_ptr<AnimationState> mpAnimationState;
+        uint32_t mTransformVersion = 0;
 
         typename ObjectType::SharedPtr mpObject;
 
@@ -45,7 +45,7 @@ namespace Falcor
         return ptr->init() ? ptr : nullptr;
     }
 
-    bool SkinningCache::update(const Model* pModel)
+    bool SkinningCache::update(const Model* pModel, const AnimationState* pState)
     {
         bool changed = false;
         if (pModel->hasBones())
@@ -54,17 +54,17 @@ namespace Falcor
             pRenderContext->pushComputeState(mSkinningPass.pState);
             pRenderContext->pushComputeVars(mSkinningPass.pVars);
 
-            setPerModelData(pModel);
+            setPerModelData(pModel, pState);
 
             for (uint32_t meshId = 0; meshId < pModel->getMeshCount(); meshId++)
             {
                 const Mesh* pMesh = pModel->getMesh(meshId).get();
                 if (pMesh->hasBones())
                 {
-                    createVertexBuffers(pMesh);
+                    createVertexBuffers(pMesh, pState);
 
                     // Bind resources
-                    setPerMeshData(pMesh);
+                    setPerMeshData(pMesh, pState);
 
                     // Execute
                     // TODO: Using 1D dispatch for simplicity, which limits us to 64k x 256 = 16M vertices with 256 in group size. Fix if needed.
@@ -82,9 +82,9 @@ namespace Falcor
         return changed;
     }
 
-    Vao::SharedPtr SkinningCache::getVao(const Mesh* pMesh) const
+    Vao::SharedPtr SkinningCache::getVao(const Mesh* pMesh, const AnimationState* pState) const
     {
-        auto it = mSkinnedBuffers.find(pMesh);
+        auto it = mSkinnedBuffers.find(BufferKey(pMesh, pState));
         if (it != mSkinnedBuffers.end())
         {
             return it->second.pVao;
@@ -92,6 +92,15 @@ namespace Falcor
         return nullptr;
     }
 
+    void SkinningCache::release(const AnimationState* pState)
+    {
+        assert(pState);
+        for (auto it = mSkinnedBuffers.begin(); it != mSkinnedBuffers.end();)
+        {
+            it = (it->first.second == pState) ? mSkinnedBuffers.erase(it) : std::next(it);
+        }
+    }
+
     bool SkinningCache::init()
     {
         // Create shaders
@@ -162,9 +171,9 @@ namespace Falcor
     }
 
     // Create vertex buffers for the skinned vertices of a Mesh if they do not already exist.
-    void SkinningCache::createVertexBuffers(const Mesh* pMesh)
+    void SkinningCache::createVertexBuffers(const Mesh* pMesh, const AnimationState* pState)
     {
-        auto it = mSkinnedBuffers.find(pMesh);
+        auto it = mSkinnedBuffers.find(BufferKey(pMesh, pState));
         if (it == mSkinnedBuffers.end())
         {
             const Vao* pVao = pMesh->getVao().get();
@@ -205,11 +214,11 @@ namespace Falcor
             VertexBuffers buffers;
             buffers.pVao = Vao::create(pVao->getPrimitiveTopology(), pLayout, pVBs, pVao->getIndexBuffer(), pVao->getIndexBufferFormat());
 
-            mSkinnedBuffers[pMesh] = buffers;
+            mSkinnedBuffers[BufferKey(pMesh, pState)] = buffers;
         }
     }
 
-    void SkinningCache::setPerModelData(const Model* pModel)
+    void SkinningCache::setPerModelData(const Model* pModel, const AnimationState* pState)
     {
         // Set bones
         assert(pModel->hasBones());
@@ -217,8 +226,11 @@ namespace Falcor
         if (pCB)
         {
             assert(pModel->getBoneCount() <= MAX_BONES);
-            pCB->setVariableArray(mVariableOffsets.bonesOffset, pModel->getBoneMatrices(), pModel->getBoneCount());
-            pCB->setVariableArray(mVariableOffsets.bonesInvTransposeOffset, pModel->getBoneInvTransposeMatrices(), pModel->getBoneCount());
+            assert(pState == nullptr || pState->getBoneCount() == pModel->getBoneCount());
+            const mat4* pBones = pState ? pState->getBoneMatrices().data() : pModel->getBoneMatrices();
+            const mat4* pBonesInvTranspose = pState ? pState->getBoneInvTransposeMatrices().data() : pModel->getBoneInvTransposeMatrices();
+            pCB->setVariableArray(mVariableOffsets.bonesOffset, pBones, pModel->getBoneCount());
+            pCB->setVariableArray(mVariableOffsets.bonesInvTransposeOffset, pBonesInvTranspose, pModel->getBoneCount());
         }
     }
 
@@ -261,7 +273,7 @@ namespace Falcor
         return false;
     }
 
-    void SkinningCache::setPerMeshData(const Mesh* pMesh)
+    void SkinningCache::setPerMeshData(const Mesh* pMesh, const AnimationState* pState)
     {
         ProgramVars* pVars = mSkinningPass.pVars.get();
 
@@ -283,7 +295,7 @@ namespace Falcor
         assert(hasPos && hasBoneWeight && hasBoneId);
 
         // Bind output vertex buffers. Note some of the buffers may be nullptr.
-        const auto& it = mSkinnedBuffers.find(pMesh);        
+        const auto& it = mSkinnedBuffers.find(BufferKey(pMesh, pState));        
         assert(it != mSkinnedBuffers.end());
 
         const Vao* pVaoOut = it->second.pVao.get();
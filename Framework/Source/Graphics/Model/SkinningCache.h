@@ -33,6 +33,7 @@ namespace Falcor
 {
     class Model;
     class Mesh;
+    class AnimationState;
 
     /** Cache for skinned vertex buffers for one or more models.
 
@@ -47,13 +48,10 @@ namespace Falcor
             We might want to generalize it and allow the user to override the shader
             to output additional skinned vertex buffers.
 
-        2)  Currently, a single set of skinned vertex buffers is stored per mesh.
+        2)  Currently, a single set of skinned vertex buffers is stored per mesh and animation state.
             We could extend that to hold multiple buffers to cache entire animations.
 
-        3)  We could also extend it to hold skinned buffers per mesh instance, to enable
-            mesh instances to be animated separately.
-
-        4)  Provide metric on amount of change to guide choice of BVH rebuild/refit for ray tracing purposes.
+        3)  Provide metric on amount of change to guide choice of BVH rebuild/refit for ray tracing purposes.
 
     */
     class SkinningCache : public std::enable_shared_from_this<SkinningCache>
@@ -66,12 +64,19 @@ namespace Falcor
         static SharedPtr create();
 
         /** Create/update skinned vertex buffers for model.
+            \param[in] pModel The model
+            \param[in] pState The animation state of a model instance which is animated independently, or nullptr to use the model's own animation.
+                Each state gets its own set of skinned vertex buffers
         */
-        bool update(const Model* pModel);
+        bool update(const Model* pModel, const AnimationState* pState = nullptr);
 
         /** Returns the vertex array object for pMesh containing skinned vertex buffers if it exists.
         */
-        Vao::SharedPtr getVao(const Mesh* pMesh) const;
+        Vao::SharedPtr getVao(const Mesh* pMesh, const AnimationState* pState = nullptr) const;
+
+        /** Release the skinned vertex buffers of an animation state. Call when the state is no longer used
+        */
+        void release(const AnimationState* pState);
 
     protected:
         SkinningCache() = default;
@@ -79,9 +84,9 @@ namespace Falcor
         bool init();
         void initVariableOffsets(const ParameterBlockReflection* pBlock);
         void initMeshBufferLocations(const ParameterBlockReflection* pBlock);
-        void createVertexBuffers(const Mesh* pMesh);
-        void setPerModelData(const Model* pModel);
-        void setPerMeshData(const Mesh* pMesh);
+        void createVertexBuffers(const Mesh* pMesh, const AnimationState* pState);
+        void setPerModelData(const Model* pModel, const AnimationState* pState);
+        void setPerMeshData(const Mesh* pMesh, const AnimationState* pState);
 
         struct VertexBuffers
         {
@@ -113,7 +118,8 @@ namespace Falcor
         VariableOffsets mVariableOffsets;
         MeshBufferLocations mMeshBufferLocations;
 
-        std::map<const Mesh*, VertexBuffers> mSkinnedBuffers;
+        using BufferKey = std::pair<const Mesh*, const AnimationState*>;
+        std::map<BufferKey, VertexBuffers> mSkinnedBuffers;
 
         struct
         {
@@ -0,0 +1,197 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TangentSpace.h"
+#include "Utils/TaskScheduler.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kFaceGrainSize = 1024;
+        const uint32_t kVertexGrainSize = 1024;
+
+        bool isSpecialFloat(float f)
+        {
+            uint32_t d;
+            std::memcpy(&d, &f, sizeof(d));
+            // Check the exponent
+            d = (d >> 23) & 0xff;
+            return d == 0xff;
+        }
+
+        bool isInvalidVec(const glm::vec3& v)
+        {
+            return isSpecialFloat(v.x) || isSpecialFloat(v.y) || isSpecialFloat(v.z);
+        }
+
+        glm::vec3 projectNormalToBitangent(const glm::vec3& normal)
+        {
+            glm::vec3 bitangent;
+            if (std::abs(normal.x) > std::abs(normal.y))
+            {
+                bitangent = glm::vec3(normal.z, 0.f, -normal.x) / length(glm::vec2(normal.x, normal.z));
+            }
+            else
+            {
+                bitangent = glm::vec3(0.f, normal.z, -normal.y) / length(glm::vec2(normal.y, normal.z));
+            }
+            return normalize(bitangent);
+        }
+
+        struct FaceFrame
+        {
+            glm::vec3 tangent;
+            glm::vec3 bitangent;
+        };
+
+        const glm::vec3& getPosition(const TangentSpaceInput& input, uint32_t index)
+        {
+            return *(const glm::vec3*)((const uint8_t*)input.pPositions + size_t(index) * input.positionStride);
+        }
+
+        FaceFrame calcFaceFrame(const TangentSpaceInput& input, uint32_t primID)
+        {
+            const uint32_t* pFace = input.pIndices + primID * 3;
+            glm::vec3 position[3];
+            glm::vec2 uv[3];
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                position[i] = getPosition(input, pFace[i]);
+                uv[i] = input.pTexCrd ? input.pTexCrd[size_t(pFace[i]) * input.texCrdStride] : glm::vec2(0);
+            }
+
+            // Position delta
+            glm::vec3 posDelta[2];
+            posDelta[0] = position[1] - position[0];
+            posDelta[1] = position[2] - position[0];
+
+            // Texture offset
+            glm::vec2 s = uv[1] - uv[0];
+            glm::vec2 t = uv[2] - uv[0];
+
+            FaceFrame frame;
+            // when t1, t2, t3 in same position in UV space, just use default UV direction.
+            if ((s == glm::vec2(0, 0)) || (t == glm::vec2(0, 0)))
+            {
+                const glm::vec3& normal = input.pNormals[pFace[0]];
+                frame.bitangent = projectNormalToBitangent(normal);
+                frame.tangent = cross(frame.bitangent, normal);
+            }
+            else
+            {
+                float dirCorrection = 1.0f / (s.x * t.y - s.y * t.x);
+
+                // tangent points in the direction where to positive X axis of the texture coord's would point in model space
+                // bitangent's points along the positive Y axis of the texture coord's, respectively
+                frame.tangent = (posDelta[0] * t.y - posDelta[1] * t.x) * dirCorrection;
+                frame.bitangent = (posDelta[1] * s.x - posDelta[0] * s.y) * dirCorrection;
+            }
+            return frame;
+        }
+
+        glm::vec3 calcLocalBitangent(const FaceFrame& frame, const glm::vec3& normal)
+        {
+            // project tangent and bitangent into the plane formed by the vertex' normal
+            glm::vec3 localTangent = frame.tangent - normal * (glm::dot(frame.tangent, normal));
+            localTangent = glm::normalize(localTangent);
+            glm::vec3 localBitangent = frame.bitangent - normal * (glm::dot(frame.bitangent, normal));
+            localBitangent = glm::normalize(localBitangent);
+            localBitangent = localBitangent - localTangent * (glm::dot(localBitangent, localTangent));
+            return glm::normalize(glm::normalize(localBitangent));
+        }
+    }
+
+    void generateBitangents(const TangentSpaceInput& input, glm::vec3* pBitangents)
+    {
+        assert(input.pIndices && input.pPositions && input.pNormals && pBitangents);
+        assert(input.indexCount % 3 == 0);
+        const uint32_t primCount = input.indexCount / 3;
+        const uint32_t vertexCount = input.vertexCount;
+        TaskScheduler* pScheduler = TaskScheduler::getDefault().get();
+
+        // Calculate the tangent and bitangent for every face. Each face writes only its own entry
+        std::vector<FaceFrame> faceFrames(primCount);
+        pScheduler->parallelForRange(0, primCount, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t primID = begin; primID < end; primID++)
+            {
+                faceFrames[primID] = calcFaceFrame(input, primID);
+            }
+        }, kFaceGrainSize);
+
+        // Build the list of face corners referencing each vertex. The corners are stored in index order, which is the order a serial scatter would accumulate them in
+        std::vector<uint32_t> cornerOffsets(vertexCount + 1, 0);
+        for (uint32_t i = 0; i < input.indexCount; i++)
+        {
+            assert(input.pIndices[i] < vertexCount);
+            cornerOffsets[input.pIndices[i] + 1]++;
+        }
+        for (uint32_t v = 0; v < vertexCount; v++)
+        {
+            cornerOffsets[v + 1] += cornerOffsets[v];
+        }
+
+        std::vector<uint32_t> corners(input.indexCount);
+        {
+            std::vector<uint32_t> cursor(cornerOffsets.begin(), cornerOffsets.end() - 1);
+            for (uint32_t i = 0; i < input.indexCount; i++)
+            {
+                corners[cursor[input.pIndices[i]]++] = i;
+            }
+        }
+
+        // Every vertex gathers the contributions of its own faces, so the threads never write to the same vertex
+        pScheduler->parallelForRange(0, vertexCount, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t v = begin; v < end; v++)
+            {
+                const glm::vec3& normal = input.pNormals[v];
+                glm::vec3 bitangent(0);
+                for (uint32_t c = cornerOffsets[v]; c < cornerOffsets[v + 1]; c++)
+                {
+                    const FaceFrame& frame = faceFrames[corners[c] / 3];
+                    if (isInvalidVec(frame.bitangent) == false)
+                    {
+                        bitangent += calcLocalBitangent(frame, normal);
+                    }
+                }
+
+                bitangent = normalize(bitangent);
+                if (isInvalidVec(bitangent))
+                {
+                    bitangent = projectNormalToBitangent(normal);
+                }
+                pBitangents[v] = bitangent;
+            }
+        }, kVertexGrainSize);
+    }
+}
@@ -0,0 +1,56 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+
+namespace Falcor
+{
+    /** Mesh data required to generate the tangent space. The mesh must be a triangle list
+    */
+    struct TangentSpaceInput
+    {
+        const uint32_t* pIndices = nullptr;
+        uint32_t indexCount = 0;
+        uint32_t vertexCount = 0;
+        const void* pPositions = nullptr;               ///< 3 or 4 component floats. Only xyz is used
+        uint32_t positionStride = sizeof(glm::vec3);    ///< In bytes
+        const glm::vec3* pNormals = nullptr;
+        const glm::vec2* pTexCrd = nullptr;             ///< Optional. Without texture coordinates, a default direction is derived from the normals
+        uint32_t texCrdStride = 1;                      ///< In glm::vec2 elements
+    };
+
+    /** Generate per-vertex bitangents. Used by all the model importers for meshes which don't provide a tangent space.
+        Faces are processed in parallel on the default task scheduler. Each vertex then gathers the contributions of its faces in index order,
+        so the result doesn't depend on the number of worker threads and matches a serial accumulation.
+        \param[in] input The mesh data
+        \param[out] pBitangents Array of input.vertexCount bitangents
+    */
+    void generateBitangents(const TangentSpaceInput& input, glm::vec3* pBitangents);
+}
@@ -245,7 +245,7 @@ namespace Falcor
         return getConstantBuffer(binding, arrayIndex);
     }
 
-    bool ParameterBlock::checkResourceIndices(const BindLocation& bindLocation, uint32_t arrayIndex, DescriptorSet::Type type, const std::string& funcName) const
+    bool ParameterBlock::checkResourceIndices(const BindLocation& bindLocation, uint32_t arrayIndex, DescriptorSet::Type type, const char* funcName) const
     {
         bool OK = true;
 #if _LOG_ENABLED
@@ -300,9 +300,21 @@ namespace Falcor
         return setConstantBuffer(loc, arrayIndex, pCB);
     }
 
-    static DescriptorSet::Type getSetTypeFromVar(const ReflectionVar::SharedConstPtr& pVar, DescriptorSet::Type srvType, DescriptorSet::Type uavType)
+    bool ParameterBlock::setConstantBuffer(const ReflectionVarHandle& handle, const ConstantBuffer::SharedPtr& pCB)
+    {
+        if (verifyResourceHandle(handle, ReflectionResourceType::Type::ConstantBuffer, "setConstantBuffer()") == false) return false;
+        return setConstantBuffer(handle.getBindLocation(), handle.getArrayIndex(), pCB);
+    }
+
+    ConstantBuffer::SharedPtr ParameterBlock::getConstantBuffer(const ReflectionVarHandle& handle) const
+    {
+        if (verifyResourceHandle(handle, ReflectionResourceType::Type::ConstantBuffer, "getConstantBuffer()") == false) return nullptr;
+        return getConstantBuffer(handle.getBindLocation(), handle.getArrayIndex());
+    }
+
+    static DescriptorSet::Type getSetTypeFromResourceType(const ReflectionResourceType* pType, DescriptorSet::Type srvType, DescriptorSet::Type uavType)
     {
-        switch (pVar->getType()->unwrapArray()->asResourceType()->getShaderAccess())
+        switch (pType->getShaderAccess())
         {
         case ReflectionResourceType::ShaderAccess::Read:
             return srvType;
@@ -314,12 +326,46 @@ namespace Falcor
         }
     }
 
+    static DescriptorSet::Type getSetTypeFromVar(const ReflectionVar::SharedConstPtr& pVar, DescriptorSet::Type srvType, DescriptorSet::Type uavType)
+    {
+        return getSetTypeFromResourceType(pVar->getType()->unwrapArray()->asResourceType(), srvType, uavType);
+    }
+
+    bool ParameterBlock::verifyResourceHandle(const ReflectionVarHandle& handle, ReflectionResourceType::Type type, const char* funcName) const
+    {
+#if _LOG_ENABLED
+        if (handle.isValid() == false || handle.getResourceType() == nullptr)
+        {
+            logWarning(std::string("ParameterBlock::") + funcName + " was called with an invalid handle. Ignoring call.");
+            return false;
+        }
+
+        if (handle.getOwner() != mpReflector.get())
+        {
+            logWarning(std::string("ParameterBlock::") + funcName + " was called with a handle which was resolved for a different parameter-block. Ignoring call.");
+            return false;
+        }
+
+        if (handle.getResourceType()->getType() != type)
+        {
+            logWarning(std::string("ParameterBlock::") + funcName + " was called, but the handle has different resource type. Expecting " + to_string(handle.getResourceType()->getType()) + " but provided resource is " + to_string(type) + ". Ignoring call");
+            return false;
+        }
+#endif
+        return true;
+    }
+
     void ParameterBlock::setResourceSrvUavCommon(std::string name, uint32_t descOffset, DescriptorSet::Type type, const Resource::SharedPtr& pResource, const std::string& funcName)
     {
         uint32_t index;
         while (parseArrayIndex(name, name, index)) {};
 
         ParameterBlockReflection::BindLocation bindLoc = mpReflector->getResourceBinding(name);
+        setResourceSrvUavCommon(bindLoc, descOffset, type, pResource, funcName.c_str());
+    }
+
+    void ParameterBlock::setResourceSrvUavCommon(const BindLocation& bindLoc, uint32_t descOffset, DescriptorSet::Type type, const Resource::SharedPtr& pResource, const char* funcName)
+    {
         if (checkResourceIndices(bindLoc, descOffset, type, funcName) == false) return;
         auto& desc = mAssignedResources[bindLoc.setIndex][bindLoc.rangeIndex][descOffset];
         if (desc.pResource == pResource) return;
@@ -345,7 +391,7 @@ namespace Falcor
     }
 
     template<typename ResourceType>
-    typename ResourceType::SharedPtr ParameterBlock::getResourceSrvUavCommon(const std::string& name, uint32_t descOffset, DescriptorSet::Type type, const std::string& funcName) const
+    typename ResourceType::SharedPtr ParameterBlock::getResourceSrvUavCommon(const std::string& name, uint32_t descOffset, DescriptorSet::Type type, const char* funcName) const
     {
         ParameterBlockReflection::BindLocation bindLoc = mpReflector->getResourceBinding(name);
         if (checkResourceIndices(bindLoc, descOffset, type, funcName) == false) return nullptr;
@@ -398,6 +444,30 @@ namespace Falcor
         return true;
     }
 
+    bool ParameterBlock::setRawBuffer(const ReflectionVarHandle& handle, Buffer::SharedPtr pBuf)
+    {
+        if (verifyResourceHandle(handle, ReflectionResourceType::Type::RawBuffer, "setRawBuffer()") == false) return false;
+        DescriptorSet::Type type = getSetTypeFromResourceType(handle.getResourceType(), DescriptorSet::Type::TextureSrv, DescriptorSet::Type::TextureUav);
+        setResourceSrvUavCommon(handle.getBindLocation(), handle.getArrayIndex(), type, pBuf, "setRawBuffer()");
+        return true;
+    }
+
+    bool ParameterBlock::setTypedBuffer(const ReflectionVarHandle& handle, TypedBufferBase::SharedPtr pBuf)
+    {
+        if (verifyResourceHandle(handle, ReflectionResourceType::Type::TypedBuffer, "setTypedBuffer()") == false) return false;
+        DescriptorSet::Type type = getSetTypeFromResourceType(handle.getResourceType(), DescriptorSet::Type::TypedBufferSrv, DescriptorSet::Type::TypedBufferUav);
+        setResourceSrvUavCommon(handle.getBindLocation(), handle.getArrayIndex(), type, pBuf, "setTypedBuffer()");
+        return true;
+    }
+
+    bool ParameterBlock::setStructuredBuffer(const ReflectionVarHandle& handle, StructuredBuffer::SharedPtr pBuf)
+    {
+        if (verifyResourceHandle(handle, ReflectionResourceType::Type::StructuredBuffer, "setStructuredBuffer()") == false) return false;
+        DescriptorSet::Type type = getSetTypeFromResourceType(handle.getResourceType(), DescriptorSet::Type::StructuredBufferSrv, DescriptorSet::Type::StructuredBufferUav);
+        setResourceSrvUavCommon(handle.getBindLocation(), handle.getArrayIndex(), type, pBuf, "setStructuredBuffer()");
+        return true;
+    }
+
     Buffer::SharedPtr ParameterBlock::getRawBuffer(const std::string& name) const
     {
         // Find the buffer
@@ -463,6 +533,12 @@ namespace Falcor
         return setSampler(bind, pVar->getDescOffset(), pSampler);
     }
 
+    bool ParameterBlock::setSampler(const ReflectionVarHandle& handle, const Sampler::SharedPtr& pSampler)
+    {
+        if (verifyResourceHandle(handle, ReflectionResourceType::Type::Sampler, "setSampler()") == false) return false;
+        return setSampler(handle.getBindLocation(), handle.getArrayIndex(), pSampler);
+    }
+
     Sampler::SharedPtr ParameterBlock::getSampler(const std::string& name) const
     {
         const ReflectionVar::SharedConstPtr pVar = mpReflector->getResource(name);
@@ -510,6 +586,14 @@ namespace Falcor
         return true;
     }
 
+    bool ParameterBlock::setTexture(const ReflectionVarHandle& handle, const Texture::SharedPtr& pTexture)
+    {
+        if (verifyResourceHandle(handle, ReflectionResourceType::Type::Texture, "setTexture()") == false) return false;
+        DescriptorSet::Type type = getSetTypeFromResourceType(handle.getResourceType(), DescriptorSet::Type::TextureSrv, DescriptorSet::Type::TextureUav);
+        setResourceSrvUavCommon(handle.getBindLocation(), handle.getArrayIndex(), type, pTexture, "setTexture()");
+        return true;
+    }
+
     Texture::SharedPtr ParameterBlock::getTexture(const std::string& name) const
     {
         const ReflectionVar::SharedConstPtr pVar = mpReflector->getResource(name);
@@ -50,6 +50,7 @@ namespace Falcor
             constexpr SharedPtrT(nullptr_t) : std::shared_ptr<T>(nullptr) {}
             SharedPtrT(const std::shared_ptr<ParameterBlock>& other) : std::shared_ptr<T>(other) {}
             ConstantBuffer::SharedPtr operator[](const std::string& cbName) const { return std::shared_ptr<T>::get()->getConstantBuffer(cbName); }
+            ConstantBuffer::SharedPtr operator[](const ReflectionVarHandle& handle) const { return std::shared_ptr<T>::get()->getConstantBuffer(handle); }
             ConstantBuffer::SharedPtr operator[](uint32_t index) = delete; // No set by index. This is here because if we didn't explicitly delete it, the compiler will try to convert to int into a string, resulting in runtime error
         };
 
@@ -82,6 +83,22 @@ namespace Falcor
         */
         bool setConstantBuffer(const BindLocation& bindLocation, uint32_t arrayIndex, const ConstantBuffer::SharedPtr& pCB);
 
+        /** Resolve a handle to a resource in the block. Binding resources through a handle skips the name lookups, so use it for resources which are set frequently. See ReflectionVarHandle
+            \param[in] name The name of the resource. Can contain array indices and struct members
+            \return The handle. Check ReflectionVarHandle::isValid() for errors
+        */
+        ReflectionVarHandle getResourceHandle(const std::string& name) const { return ReflectionVarHandle::create(mpReflector, name); }
+
+        /** Bind a constant buffer object using a handle returned by getResourceHandle().
+            \return false is the call failed, otherwise true
+        */
+        bool setConstantBuffer(const ReflectionVarHandle& handle, const ConstantBuffer::SharedPtr& pCB);
+
+        /** Get a constant buffer object using a handle returned by getResourceHandle().
+            \return If the handle is valid, a shared pointer to the CB. Otherwise returns nullptr
+        */
+        ConstantBuffer::SharedPtr getConstantBuffer(const ReflectionVarHandle& handle) const;
+
         /** Get a constant buffer object.
         \param[in] name The name of the buffer
         \return If the name is valid, a shared pointer to the CB. Otherwise returns nullptr
@@ -118,6 +135,18 @@ namespace Falcor
         */
         bool setStructuredBuffer(const std::string& name, StructuredBuffer::SharedPtr pBuf);
 
+        /** Set a raw-buffer using a handle returned by getResourceHandle()
+        */
+        bool setRawBuffer(const ReflectionVarHandle& handle, Buffer::SharedPtr pBuf);
+
+        /** Set a typed buffer using a handle returned by getResourceHandle()
+        */
+        bool setTypedBuffer(const ReflectionVarHandle& handle, TypedBufferBase::SharedPtr pBuf);
+
+        /** Set a structured buffer using a handle returned by getResourceHandle()
+        */
+        bool setStructuredBuffer(const ReflectionVarHandle& handle, StructuredBuffer::SharedPtr pBuf);
+
         /** Get a raw-buffer object.
             \param[in] name The name of the buffer
             \return If the name is valid, a shared pointer to the buffer object. Otherwise returns nullptr
@@ -142,6 +171,10 @@ namespace Falcor
         */
         bool setTexture(const std::string& name, const Texture::SharedPtr& pTexture);
 
+        /** Bind a texture using a handle returned by getResourceHandle()
+        */
+        bool setTexture(const ReflectionVarHandle& handle, const Texture::SharedPtr& pTexture);
+
         /** Get a texture object.
             \param[in] name The name of the texture
             \return If the name is valid, a shared pointer to the texture object. Otherwise returns nullptr
@@ -190,6 +223,10 @@ namespace Falcor
         */
         bool setSampler(const BindLocation& bindLocation, uint32_t arrayIndex, const Sampler::SharedPtr& pSampler);
 
+        /** Bind a sampler using a handle returned by getResourceHandle()
+        */
+        bool setSampler(const ReflectionVarHandle& handle, const Sampler::SharedPtr& pSampler);
+
         /** Gets a sampler object.
         \return If the index is valid, a shared pointer to the sampler. Otherwise returns nullptr
         */
@@ -254,11 +291,13 @@ namespace Falcor
         using ResourceVec = std::vector<AssignedResource>;
         using SetResourceVec = std::vector<ResourceVec>;
         std::vector<SetResourceVec> mAssignedResources;
-        bool checkResourceIndices(const BindLocation& bindLocation, uint32_t arrayIndex, DescriptorSet::Type type, const std::string& funcName) const;
+        bool checkResourceIndices(const BindLocation& bindLocation, uint32_t arrayIndex, DescriptorSet::Type type, const char* funcName) const;
 
         std::vector<RootSet> mRootSets;
         void setResourceSrvUavCommon(std::string name, uint32_t descOffset, DescriptorSet::Type type, const Resource::SharedPtr& pResource, const std::string& funcName);
+        void setResourceSrvUavCommon(const BindLocation& bindLoc, uint32_t descOffset, DescriptorSet::Type type, const Resource::SharedPtr& pResource, const char* funcName);
+        bool verifyResourceHandle(const ReflectionVarHandle& handle, ReflectionResourceType::Type type, const char* funcName) const;
         template<typename ResourceType>
-        typename ResourceType::SharedPtr getResourceSrvUavCommon(const std::string& name, uint32_t descOffset, DescriptorSet::Type type, const std::string& funcName) const;
+        typename ResourceType::SharedPtr getResourceSrvUavCommon(const std::string& name, uint32_t descOffset, DescriptorSet::Type type, const char* funcName) const;
     };
 }
\ No newline at end of file
@@ -38,12 +38,17 @@
 #include "API/RenderContext.h"
 #include "Utils/StringUtils.h"
 #include "ShaderLibrary.h"
+#include "ShaderCache.h"
+#include "Utils/Hash.h"
+#include "Utils/CpuTimer.h"
+#include "API/Device.h"
+#include <unordered_set>
 
 namespace Falcor
 {
 #ifdef FALCOR_VK
     const std::string kSupportedShaderModels[] = { "400", "410", "420", "430", "440", "450" };
-#elif defined FALCOR_D3D12
+#elif defined FALCOR_D3D12 || defined FALCOR_NULL
     const std::string kSupportedShaderModels[] = { "4_0", "4_1", "5_0", "5_1", "6_0", "6_1", "6_2", "6_3" };
 #endif
 
@@ -54,6 +59,21 @@ namespace Falcor
         return pShader;
     }
 
+    static void serializeReflector(BinaryMemoryWriter& writer, const ProgramReflection::SharedPtr& pReflector)
+    {
+        writer << (uint32_t)(pReflector != nullptr);
+        if (pReflector) pReflector->serialize(writer);
+    }
+
+    static bool deserializeReflector(BinaryMemoryStream& stream, ProgramReflection::SharedPtr& pReflector)
+    {
+        uint32_t exists = 0;
+        stream >> exists;
+        if (exists == 0) return stream.isFail() == false;
+        pReflector = ProgramReflection::deserialize(stream);
+        return pReflector != nullptr;
+    }
+
     Program::Desc::Desc() = default;
 
     Program::Desc::Desc(std::string const& path)
@@ -172,6 +192,8 @@ namespace Falcor
 
     Program::~Program()
     {
+        releaseCachedStateObjects();
+
         // Remove the current program from the program vector
         for(auto it = sPrograms.begin() ; it != sPrograms.end() ; it++)
         {
@@ -387,17 +409,105 @@ namespace Falcor
     {
 #if defined FALCOR_VK
         return "glsl_" + shaderModel;
-#elif defined FALCOR_D3D12
+#elif defined FALCOR_D3D12 || defined FALCOR_NULL
         return "sm_" + shaderModel;
 #else
 #error unknown shader compilation target
 #endif
     }
 
+    std::string Program::getShaderCacheKey() const
+    {
+        // The key should contain everything which affects the compilation result. Included files are not known before compilation, they are validated by the cache when loading an entry
+        std::string key = "FalcorShaderCache 1\n";
+#ifdef FALCOR_VK
+        key += "api vk\n";
+#elif defined FALCOR_D3D12
+        key += "api d3d12\n";
+#elif defined FALCOR_NULL
+        key += "api null\n";
+#endif
+        key += "slang " + std::string(spGetBuildTagString()) + "\n";
+        key += "sm " + mDesc.mShaderModel + "\n";
+        key += "flags " + std::to_string((uint32_t)mDesc.getCompilerFlags()) + "\n";
+        for (const auto& path : getDataDirectoriesList()) key += "path " + path + "\n";
+        for (const auto& d : mDefineList) key += "define " + d.first + "=" + d.second + "\n";
+
+        for (const auto& src : mDesc.mSources)
+        {
+            uint64_t hash = 0;
+            if (src.type == Desc::Source::Type::File)
+            {
+                std::string fullpath;
+                if (findFileInDataDirectories(src.pLibrary->getFilename(), fullpath) == false || hashFile(fullpath, hash) == false) return "";
+                key += "file " + fullpath + " ";
+            }
+            else
+            {
+                hash = hashData(src.str.data(), src.str.size());
+                key += "string ";
+            }
+            key += std::to_string(hash) + "\n";
+        }
+
+        for (uint32_t i = 0; i < kShaderCount; i++)
+        {
+            const auto& entryPoint = mDesc.mEntryPoints[i];
+            if (entryPoint.isValid()) key += "entry " + std::to_string(i) + " " + std::to_string(entryPoint.index) + " " + entryPoint.name + "\n";
+        }
+        return key;
+    }
+
+    Program::VersionData Program::createProgramVersionFromCache(const ShaderCache::Entry& entry, std::string& log) const
+    {
+        VersionData programVersion;
+        BinaryMemoryStream stream(entry.reflection.data(), entry.reflection.size());
+        if (deserializeReflector(stream, programVersion.reflectors.pReflector) == false ||
+            deserializeReflector(stream, programVersion.reflectors.pLocalReflector) == false ||
+            deserializeReflector(stream, programVersion.reflectors.pGlobalReflector) == false)
+        {
+            logWarning("Can't deserialize the cached reflection data of program " + getProgramDescString() + ". Recompiling the program.");
+            return VersionData();
+        }
+
+        Shader::Blob shaderBlob[kShaderCount];
+        for (uint32_t i = 0; i < kShaderCount; i++)
+        {
+            if (entry.code[i].size()) shaderBlob[i] = ShaderCache::createBlob(entry.code[i]);
+        }
+
+        for (const auto& d : entry.dependencies)
+        {
+            mFileTimeMap[d.path] = getFileModifiedTime(d.path);
+        }
+
+        programVersion.pVersion = createProgramVersion(log, shaderBlob, programVersion.reflectors);
+        return programVersion;
+    }
+
     Program::VersionData Program::preprocessAndCreateProgramVersion(std::string& log) const
     {
         mFileTimeMap.clear();
 
+        // Look for the program in the shader cache first. Dumping intermediates requires running the compiler, so we skip the cache in that case
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        bool dumpIR = is_set(mDesc.getCompilerFlags(), Shader::CompilerFlags::DumpIntermediates);
+        std::string cacheKey = (ShaderCache::isEnabled() && !dumpIR) ? getShaderCacheKey() : "";
+        if (cacheKey.size())
+        {
+            ShaderCache::Entry cacheEntry;
+            if (ShaderCache::load(cacheKey, cacheEntry))
+            {
+                VersionData programVersion = createProgramVersionFromCache(cacheEntry, log);
+                if (programVersion.pVersion)
+                {
+                    ShaderCache::recordLatency(true, CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()));
+                    return programVersion;
+                }
+                mFileTimeMap.clear();
+            }
+        }
+
         // Run all of the shaders through Slang, so that we can get final code,
         // reflection data, etc.
         //
@@ -419,7 +529,6 @@ namespace Falcor
         }
 
         // Enable/disable intermediates dump
-        bool dumpIR = is_set(mDesc.getCompilerFlags(), Shader::CompilerFlags::DumpIntermediates);
         spSetDumpIntermediates(slangRequest, dumpIR);
 
         // Pass any `#define` flags along to Slang, since we aren't doing our
@@ -440,6 +549,10 @@ namespace Falcor
         // If the profile string starts with a `4_` or a `5_`, use DXBC. Otherwise, use DXIL
         if (hasPrefix(mDesc.mShaderModel, "4_") || hasPrefix(mDesc.mShaderModel, "5_")) slangTarget = SLANG_DXBC;
         else                                                                            slangTarget = SLANG_DXIL;
+#elif defined FALCOR_NULL
+        // Shaders are never executed. Generating HLSL source only needs Slang, so no downstream compiler is required
+        preprocessorDefine = "FALCOR_D3D";
+        slangTarget = SLANG_HLSL;
 #else
 #error unknown shader compilation target
 #endif
@@ -562,11 +675,21 @@ namespace Falcor
         programVersion.reflectors.pGlobalReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), ProgramReflection::ResourceScope::Global, log);
 
         // Extract list of files referenced, for dependency-tracking purposes
+        ShaderCache::Entry cacheEntry;
+        bool cacheable = cacheKey.size() != 0;
         int depFileCount = spGetDependencyFileCount(slangRequest);
         for(int ii = 0; ii < depFileCount; ++ii)
         {
             std::string depFilePath = spGetDependencyFilePath(slangRequest, ii);
             mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+
+            if (cacheable)
+            {
+                ShaderCache::Dependency d;
+                d.path = depFilePath;
+                cacheable = hashFile(depFilePath, d.hash);
+                cacheEntry.dependencies.push_back(d);
+            }
         }
 
         spDestroyCompileRequest(slangRequest);
@@ -575,6 +698,29 @@ namespace Falcor
         // which may vary in subclasses of `Program`
         programVersion.pVersion = createProgramVersion(log, shaderBlob, programVersion.reflectors);
 
+        if (cacheable && programVersion.pVersion)
+        {
+            for (uint32_t i = 0; i < kShaderCount; i++)
+            {
+                if (shaderBlob[i])
+                {
+                    const uint8_t* pCode = (const uint8_t*)shaderBlob[i]->getBufferPointer();
+                    cacheEntry.code[i].assign(pCode, pCode + shaderBlob[i]->getBufferSize());
+                }
+            }
+            BinaryMemoryWriter reflection;
+            serializeReflector(reflection, programVersion.reflectors.pReflector);
+            serializeReflector(reflection, programVersion.reflectors.pLocalReflector);
+            serializeReflector(reflection, programVersion.reflectors.pGlobalReflector);
+            cacheEntry.reflection = reflection.getData();
+            ShaderCache::store(cacheKey, cacheEntry);
+        }
+
+        if (cacheKey.size() && programVersion.pVersion)
+        {
+            ShaderCache::recordLatency(false, CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()));
+        }
+
         return programVersion;
     }
 
@@ -643,8 +789,22 @@ namespace Falcor
         }
     }
 
+    void Program::releaseCachedStateObjects() const
+    {
+        // The device's state object cache holds references to the program versions. Drop the objects which use this program's versions, so that the versions are released
+        if (gpDevice == nullptr || gpDevice->getGraphicsStateObjectCache() == nullptr) return;
+
+        std::unordered_set<const ProgramVersion*> versions;
+        for (const auto& v : mProgramVersions) versions.insert(v.second.pVersion.get());
+        if (mActiveProgram.pVersion) versions.insert(mActiveProgram.pVersion.get());
+        if (versions.empty()) return;
+
+        gpDevice->getGraphicsStateObjectCache()->removeIf([&versions](const GraphicsStateObject::Desc& desc) { return versions.count(desc.getProgramVersion().get()) != 0; });
+    }
+
     void Program::reset()
     {
+        releaseCachedStateObjects();
         mActiveProgram = VersionData();
         mProgramVersions.clear();
         mFileTimeMap.clear();
@@ -30,6 +30,7 @@
 #include <map>
 #include <vector>
 #include "Graphics/Program//ProgramVersion.h"
+#include "Graphics/Program/ShaderCache.h"
 
 namespace Falcor
 {
@@ -208,7 +209,7 @@ namespace Falcor
             Shader::CompilerFlags mShaderFlags = Shader::CompilerFlags::None;
 #ifdef FALCOR_VK
             std::string mShaderModel = "450";
-#elif defined FALCOR_D3D12
+#elif defined FALCOR_D3D12 || defined FALCOR_NULL
             std::string mShaderModel = "5_1";
 #endif
         };
@@ -291,6 +292,8 @@ namespace Falcor
 
         bool link() const;
         VersionData preprocessAndCreateProgramVersion(std::string& log) const;
+        VersionData createProgramVersionFromCache(const ShaderCache::Entry& entry, std::string& log) const;
+        std::string getShaderCacheKey() const;
         virtual ProgramVersion::SharedPtr createProgramVersion(std::string& log, const Shader::Blob shaderBlob[kShaderCount], const ProgramReflectors& reflectors) const;
 
         // The description used to create this program
@@ -311,5 +314,6 @@ namespace Falcor
 
         bool checkIfFilesChanged();
         void reset();
+        void releaseCachedStateObjects() const;
     };
 }
\ No newline at end of file
@@ -1353,6 +1353,52 @@ namespace Falcor
         return (it == mResourceBindings.end()) ? BindLocation() : it->second;
     }
 
+    ReflectionVarHandle ReflectionVarHandle::create(const ReflectionResourceType::SharedConstPtr& pBufferType, const std::string& name)
+    {
+        ReflectionVarHandle handle;
+        const ReflectionVar::SharedConstPtr pVar = pBufferType ? pBufferType->findMember(name) : nullptr;
+        if (pVar == nullptr) return handle;
+
+        // The setters validate against the offset descriptor, so store it in the handle
+        const ReflectionResourceType::OffsetDesc& desc = pBufferType->getOffsetDesc(pVar->getOffset());
+        handle.mpOwner = pBufferType;
+        handle.mpType = pVar->getType();
+        handle.mOffset = pVar->getOffset();
+        handle.mBasicType = desc.type;
+        handle.mArraySize = desc.count;
+        return handle;
+    }
+
+    ReflectionVarHandle ReflectionVarHandle::create(const ParameterBlockReflection::SharedConstPtr& pBlock, const std::string& name)
+    {
+        ReflectionVarHandle handle;
+        const ReflectionVar::SharedConstPtr pVar = pBlock ? pBlock->getResource(name) : nullptr;
+        if (pVar == nullptr)
+        {
+            logWarning("Can't find a resource named '" + name + "'");
+            return handle;
+        }
+
+        const ReflectionResourceType* pResourceType = pVar->getType()->unwrapArray()->asResourceType();
+        if (pResourceType == nullptr)
+        {
+            logWarning("'" + name + "' is not a resource");
+            return handle;
+        }
+
+        // Bind-locations are stored by the name of the array
+        std::string bindName = name;
+        uint32_t index;
+        while (parseArrayIndex(bindName, bindName, index)) {};
+
+        handle.mpOwner = pBlock;
+        handle.mpType = pVar->getType();
+        handle.mpResourceType = pResourceType;
+        handle.mBindLocation = pBlock->getResourceBinding(bindName);
+        handle.mArrayIndex = pVar->getDescOffset();
+        return handle;
+    }
+
     const ReflectionVar::SharedConstPtr ProgramReflection::getResource(const std::string& name) const
     {
         return mpDefaultBlock->getResource(name);
@@ -1466,4 +1512,294 @@ namespace Falcor
         const auto& offsetIt = mOffsetDescMap.find(offset);
         return (offsetIt == mOffsetDescMap.end()) ? empty : offsetIt->second;
     }
+
+    // Serialization. Types are written into a table, children before their parents, so that a type which is referenced by multiple variables is only stored once.
+    static const uint32_t kNullTypeIndex = uint32_t(-1);
+
+    static void writeString(BinaryMemoryWriter& writer, const std::string& str)
+    {
+        writer << (uint32_t)str.size();
+        writer.write(str.data(), str.size());
+    }
+
+    static bool readString(BinaryMemoryStream& stream, std::string& str)
+    {
+        uint32_t length = 0;
+        stream >> length;
+        const char* pChars = (const char*)stream.readSpan(length);
+        if (pChars == nullptr) return false;
+        str.assign(pChars, length);
+        return true;
+    }
+
+    class ReflectionTypeWriter
+    {
+    public:
+        uint32_t addType(const ReflectionType* pType)
+        {
+            if (pType == nullptr) return kNullTypeIndex;
+            auto it = mTypeIndices.find(pType);
+            if (it != mTypeIndices.end()) return it->second;
+
+            // Add the children first
+            BinaryMemoryWriter entry;
+            entry << (uint32_t)pType->getType();
+            switch (pType->getType())
+            {
+            case ReflectionType::Type::Array:
+            {
+                const ReflectionArrayType* pArray = pType->asArrayType();
+                uint32_t elementType = addType(pArray->getType().get());
+                entry << (uint64_t)pArray->getOffset() << pArray->getArraySize() << pArray->getArrayStride() << elementType;
+            }
+            break;
+            case ReflectionType::Type::Struct:
+            {
+                const ReflectionStructType* pStruct = pType->asStructType();
+                std::vector<uint32_t> memberTypes;
+                for (const auto& pMember : *pStruct) memberTypes.push_back(addType(pMember->getType().get()));
+
+                entry << (uint64_t)pStruct->getOffset() << (uint64_t)pStruct->getSize();
+                writeString(entry, pStruct->getName());
+                entry << pStruct->getMemberCount();
+                for (uint32_t i = 0; i < pStruct->getMemberCount(); i++)
+                {
+                    writeVar(entry, *pStruct->getMember(i), memberTypes[i]);
+                }
+            }
+            break;
+            case ReflectionType::Type::Basic:
+            {
+                const ReflectionBasicType* pBasic = pType->asBasicType();
+                entry << (uint64_t)pBasic->getOffset() << (int32_t)pBasic->getType() << (uint32_t)pBasic->isRowMajor() << (uint64_t)pBasic->getSize();
+            }
+            break;
+            case ReflectionType::Type::Resource:
+            {
+                const ReflectionResourceType* pResource = pType->asResourceType();
+                uint32_t structType = addType(pResource->getStructType().get());
+                entry << (uint32_t)pResource->getType() << (uint32_t)pResource->getDimensions() << (uint32_t)pResource->getStructuredBufferType();
+                entry << (uint32_t)pResource->getReturnType() << (uint32_t)pResource->getShaderAccess() << structType;
+            }
+            break;
+            default:
+                should_not_get_here();
+            }
+
+            mTypes.write(entry.getData().data(), entry.getData().size());
+            uint32_t index = mTypeCount++;
+            mTypeIndices[pType] = index;
+            return index;
+        }
+
+        static void writeVar(BinaryMemoryWriter& writer, const ReflectionVar& var, uint32_t typeIndex)
+        {
+            writeString(writer, var.getName());
+            writer << typeIndex << (uint64_t)var.getOffset() << var.getDescOffset() << var.getRegisterSpace() << (uint32_t)var.getModifier();
+        }
+
+        uint32_t getTypeCount() const { return mTypeCount; }
+        const std::vector<uint8_t>& getTypeData() const { return mTypes.getData(); }
+
+    private:
+        BinaryMemoryWriter mTypes;
+        uint32_t mTypeCount = 0;
+        std::unordered_map<const ReflectionType*, uint32_t> mTypeIndices;
+    };
+
+    class ReflectionTypeReader
+    {
+    public:
+        bool readTypes(BinaryMemoryStream& stream)
+        {
+            uint32_t typeCount = 0;
+            stream >> typeCount;
+            if (typeCount > stream.getRemainingStreamSize()) return false;
+
+            for (uint32_t t = 0; t < typeCount; t++)
+            {
+                uint32_t kind = -1;
+                stream >> kind;
+                ReflectionType::SharedPtr pType;
+                switch ((ReflectionType::Type)kind)
+                {
+                case ReflectionType::Type::Array:
+                {
+                    uint64_t offset;
+                    uint32_t arraySize, arrayStride, elementType;
+                    stream >> offset >> arraySize >> arrayStride >> elementType;
+                    if (isValidIndex(elementType) == false) return false;
+                    pType = ReflectionArrayType::create((size_t)offset, arraySize, arrayStride, mTypes[elementType]);
+                }
+                break;
+                case ReflectionType::Type::Struct:
+                {
+                    uint64_t offset, size;
+                    std::string name;
+                    uint32_t memberCount = 0;
+                    stream >> offset >> size;
+                    if (readString(stream, name) == false) return false;
+                    stream >> memberCount;
+                    ReflectionStructType::SharedPtr pStruct = ReflectionStructType::create((size_t)offset, (size_t)size, name);
+                    for (uint32_t m = 0; m < memberCount; m++)
+                    {
+                        ReflectionVar::SharedPtr pVar = readVar(stream);
+                        if (pVar == nullptr) return false;
+                        pStruct->addMember(pVar);
+                    }
+                    pType = pStruct;
+                }
+                break;
+                case ReflectionType::Type::Basic:
+                {
+                    uint64_t offset, size;
+                    int32_t basicType;
+                    uint32_t isRowMajor;
+                    stream >> offset >> basicType >> isRowMajor >> size;
+                    pType = ReflectionBasicType::create((size_t)offset, (ReflectionBasicType::Type)basicType, isRowMajor != 0, (size_t)size);
+                }
+                break;
+                case ReflectionType::Type::Resource:
+                {
+                    uint32_t type, dims, structuredType, returnType, access, structTypeIndex;
+                    stream >> type >> dims >> structuredType >> returnType >> access >> structTypeIndex;
+                    if (structTypeIndex != kNullTypeIndex && isValidIndex(structTypeIndex) == false) return false;
+                    ReflectionResourceType::SharedPtr pResource = ReflectionResourceType::create((ReflectionResourceType::Type)type, (ReflectionResourceType::Dimensions)dims,
+                        (ReflectionResourceType::StructuredType)structuredType, (ReflectionResourceType::ReturnType)returnType, (ReflectionResourceType::ShaderAccess)access);
+                    if (structTypeIndex != kNullTypeIndex) pResource->setStructType(mTypes[structTypeIndex]);
+                    pType = pResource;
+                }
+                break;
+                default:
+                    return false;
+                }
+
+                if (stream.isFail()) return false;
+                mTypes.push_back(pType);
+            }
+            return true;
+        }
+
+        ReflectionVar::SharedPtr readVar(BinaryMemoryStream& stream) const
+        {
+            std::string name;
+            uint32_t typeIndex, descOffset, regSpace, modifier;
+            uint64_t offset;
+            if (readString(stream, name) == false) return nullptr;
+            stream >> typeIndex >> offset >> descOffset >> regSpace >> modifier;
+            if (stream.isFail() || isValidIndex(typeIndex) == false) return nullptr;
+            return ReflectionVar::create(name, mTypes[typeIndex], (size_t)offset, descOffset, regSpace, (ReflectionVar::Modifier)modifier);
+        }
+
+        bool isValidIndex(uint32_t index) const { return index < mTypes.size(); }
+        const ReflectionType::SharedPtr& getType(uint32_t index) const { return mTypes[index]; }
+
+    private:
+        std::vector<ReflectionType::SharedPtr> mTypes;
+    };
+
+    static void writeVariableMap(BinaryMemoryWriter& writer, const ProgramReflection::VariableMap& varMap)
+    {
+        writer << (uint32_t)varMap.size();
+        for (const auto& v : varMap)
+        {
+            writeString(writer, v.first);
+            writeString(writer, v.second.semanticName);
+            writer << v.second.bindLocation << (int32_t)v.second.type;
+        }
+    }
+
+    static bool readVariableMap(BinaryMemoryStream& stream, ProgramReflection::VariableMap& varMap)
+    {
+        uint32_t count = 0;
+        stream >> count;
+        for (uint32_t i = 0; i < count && stream.isFail() == false; i++)
+        {
+            std::string name;
+            ProgramReflection::ShaderVariable var;
+            int32_t type;
+            if (readString(stream, name) == false || readString(stream, var.semanticName) == false) return false;
+            stream >> var.bindLocation >> type;
+            var.type = (ReflectionBasicType::Type)type;
+            varMap[name] = var;
+        }
+        return stream.isFail() == false;
+    }
+
+    void ProgramReflection::serialize(BinaryMemoryWriter& writer) const
+    {
+        ReflectionTypeWriter types;
+        BinaryMemoryWriter body;
+
+        // Parameter blocks. The resource list and the resource variables are enough to recreate the block, the bindings and set layouts are regenerated by finalize()
+        body << (uint32_t)mpParameterBlocks.size();
+        for (const auto& pBlock : mpParameterBlocks)
+        {
+            writeString(body, pBlock->mName);
+            body << types.addType(pBlock->mpResourceVars.get());
+            body << (uint32_t)pBlock->mResources.size();
+            for (const auto& res : pBlock->mResources)
+            {
+                writeString(body, res.name);
+                body << res.descOffset << res.descCount << res.regIndex << res.regSpace << (uint32_t)res.setType << types.addType(res.pType.get());
+            }
+        }
+
+        body << mThreadGroupSize << (uint32_t)mIsSampleFrequency;
+        writeVariableMap(body, mPsOut);
+        writeVariableMap(body, mVertAttr);
+        writeVariableMap(body, mVertAttrBySemantic);
+
+        writer << types.getTypeCount();
+        writer.write(types.getTypeData().data(), types.getTypeData().size());
+        writer.write(body.getData().data(), body.getData().size());
+    }
+
+    ProgramReflection::SharedPtr ProgramReflection::deserialize(BinaryMemoryStream& stream)
+    {
+        ReflectionTypeReader types;
+        if (types.readTypes(stream) == false) return nullptr;
+
+        SharedPtr pReflection = SharedPtr(new ProgramReflection());
+        uint32_t blockCount = 0;
+        stream >> blockCount;
+        for (uint32_t b = 0; b < blockCount; b++)
+        {
+            std::string name;
+            uint32_t varsType = kNullTypeIndex;
+            uint32_t resourceCount = 0;
+            if (readString(stream, name) == false) return nullptr;
+            stream >> varsType >> resourceCount;
+            if (stream.isFail() || types.isValidIndex(varsType) == false || types.getType(varsType)->asStructType() == nullptr) return nullptr;
+            if (pReflection->mParameterBlocksIndices.find(name) != pReflection->mParameterBlocksIndices.end()) return nullptr;
+
+            ParameterBlockReflection::SharedPtr pBlock = ParameterBlockReflection::create(name);
+            pBlock->mpResourceVars = std::static_pointer_cast<ReflectionStructType>(types.getType(varsType));
+            for (uint32_t r = 0; r < resourceCount; r++)
+            {
+                ParameterBlockReflection::ResourceDesc res;
+                uint32_t setType, typeIndex;
+                if (readString(stream, res.name) == false) return nullptr;
+                stream >> res.descOffset >> res.descCount >> res.regIndex >> res.regSpace >> setType >> typeIndex;
+                if (stream.isFail() || types.isValidIndex(typeIndex) == false || types.getType(typeIndex)->asResourceType() == nullptr) return nullptr;
+                res.setType = (ParameterBlockReflection::ResourceDesc::Type)setType;
+                res.pType = std::static_pointer_cast<const ReflectionResourceType>(types.getType(typeIndex));
+                pBlock->mResources.push_back(res);
+            }
+            pBlock->finalize();
+            pReflection->addParameterBlock(pBlock);
+        }
+
+        uint32_t isSampleFrequency = 0;
+        stream >> pReflection->mThreadGroupSize >> isSampleFrequency;
+        pReflection->mIsSampleFrequency = isSampleFrequency != 0;
+        if (readVariableMap(stream, pReflection->mPsOut) == false) return nullptr;
+        if (readVariableMap(stream, pReflection->mVertAttr) == false) return nullptr;
+        if (readVariableMap(stream, pReflection->mVertAttrBySemantic) == false) return nullptr;
+
+        // Every program has a default block
+        if (stream.isFail() || pReflection->mpDefaultBlock == nullptr) return nullptr;
+        pReflection->updateDefaultBlockResourceBindings();
+        return pReflection;
+    }
 }
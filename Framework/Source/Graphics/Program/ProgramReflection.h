@@ -31,6 +31,7 @@
 #include <unordered_set>
 #include "Externals/Slang/slang.h"
 #include "API/DescriptorSet.h"
+#include "Utils/BinaryMemoryStream.h"
 
 namespace Falcor
 {
@@ -92,6 +93,10 @@ namespace Falcor
         */
         virtual size_t getSize() const = 0;
 
+        /** Get the offset of the object relative to its parent
+        */
+        size_t getOffset() const { return mOffset; }
+
         // Helper functions
         virtual std::shared_ptr<const ReflectionVar> findMemberInternal(const std::string& name, size_t strPos, size_t offset, uint32_t regIndex, uint32_t regSpace, uint32_t descOffset) const = 0;
 
@@ -573,6 +578,80 @@ namespace Falcor
         SetLayoutVec mSetLayouts;
     };
 
+    /** A variable resolved ahead of time.
+        Resolving a handle parses the name and walks the reflection once. Using the handle afterwards doesn't require any string parsing, hash-map lookups or allocations, so handles should be used for variables which are set every frame.
+        A handle is only valid for the reflection object it was resolved from. After recompiling a program, the handles need to be resolved again.
+    */
+    class ReflectionVarHandle
+    {
+    public:
+        using BindLocation = ParameterBlockReflection::BindLocation;
+
+        /** Create an invalid handle
+        */
+        ReflectionVarHandle() = default;
+
+        /** Resolve a variable inside a constant- or structured-buffer
+            \param[in] pBufferType The buffer's reflection object
+            \param[in] name The variable name. Can contain array indices and struct members
+            \return The handle. Check isValid() for errors
+        */
+        static ReflectionVarHandle create(const ReflectionResourceType::SharedConstPtr& pBufferType, const std::string& name);
+
+        /** Resolve a resource inside a parameter-block
+            \param[in] pBlock The parameter-block's reflection object
+            \param[in] name The resource name. Can contain array indices and struct members
+            \return The handle. Check isValid() for errors
+        */
+        static ReflectionVarHandle create(const ParameterBlockReflection::SharedConstPtr& pBlock, const std::string& name);
+
+        /** Check if the handle was resolved successfully
+        */
+        bool isValid() const { return mpType != nullptr; }
+
+        /** Get the reflection object the handle was resolved from
+        */
+        const void* getOwner() const { return mpOwner.get(); }
+
+        /** Get the variable type
+        */
+        const ReflectionType::SharedConstPtr& getType() const { return mpType; }
+
+        /** For variables inside a buffer, get the byte offset of the variable
+        */
+        size_t getOffset() const { return mOffset; }
+
+        /** For variables inside a buffer, get the basic type of the variable. Returns Unknown for structs
+        */
+        ReflectionBasicType::Type getBasicType() const { return mBasicType; }
+
+        /** For variables inside a buffer, get the number of array elements starting at the variable, or 0 if it's not an array
+        */
+        uint32_t getArraySize() const { return mArraySize; }
+
+        /** For resources, get the resource type
+        */
+        const ReflectionResourceType* getResourceType() const { return mpResourceType; }
+
+        /** For resources, get the bind-location in the parameter-block
+        */
+        const BindLocation& getBindLocation() const { return mBindLocation; }
+
+        /** For resources, get the array index (the descriptor offset inside the bind-location)
+        */
+        uint32_t getArrayIndex() const { return mArrayIndex; }
+
+    private:
+        std::shared_ptr<const void> mpOwner;
+        ReflectionType::SharedConstPtr mpType;
+        size_t mOffset = ReflectionType::kInvalidOffset;
+        ReflectionBasicType::Type mBasicType = ReflectionBasicType::Type::Unknown;
+        uint32_t mArraySize = 0;
+        const ReflectionResourceType* mpResourceType = nullptr;
+        BindLocation mBindLocation;
+        uint32_t mArrayIndex = 0;
+    };
+
     /** Reflection object for an entire program. Essentially, it's a collection of ParameterBlocks
     */
     class ProgramReflection
@@ -666,7 +745,19 @@ namespace Falcor
         /** Merge to reflection objects into a new one
         */
         static SharedPtr merge(const ProgramReflection& first, const ProgramReflection& second);
+
+        /** Write the reflection data into a binary buffer. Used by the shader cache to store reflection data on disk.
+            \param[out] writer The writer to append the data to
+        */
+        void serialize(BinaryMemoryWriter& writer) const;
+
+        /** Create a reflection object from data written by serialize()
+            \param[in] stream The stream to read from
+            \return A new object, or nullptr if the data is malformed
+        */
+        static SharedPtr deserialize(BinaryMemoryStream& stream);
     private:
+        ProgramReflection() = default;
         ProgramReflection(slang::ShaderReflection* pSlangReflector, ResourceScope scopeToReflect, std::string& log);
         ProgramReflection(const ProgramReflection&) = default;
         void addParameterBlock(const ParameterBlockReflection::SharedConstPtr& pBlock);
@@ -155,6 +155,46 @@ namespace Falcor
         return mDefaultBlock.pBlock->getConstantBuffer(name);
     }
 
+    ReflectionVarHandle ProgramVars::getResourceHandle(const std::string& name) const
+    {
+        return mDefaultBlock.pBlock->getResourceHandle(name);
+    }
+
+    ConstantBuffer::SharedPtr ProgramVars::getConstantBuffer(const ReflectionVarHandle& handle) const
+    {
+        return mDefaultBlock.pBlock->getConstantBuffer(handle);
+    }
+
+    bool ProgramVars::setConstantBuffer(const ReflectionVarHandle& handle, const ConstantBuffer::SharedPtr& pCB)
+    {
+        return mDefaultBlock.pBlock->setConstantBuffer(handle, pCB);
+    }
+
+    bool ProgramVars::setRawBuffer(const ReflectionVarHandle& handle, Buffer::SharedPtr pBuf)
+    {
+        return mDefaultBlock.pBlock->setRawBuffer(handle, pBuf);
+    }
+
+    bool ProgramVars::setTypedBuffer(const ReflectionVarHandle& handle, TypedBufferBase::SharedPtr pBuf)
+    {
+        return mDefaultBlock.pBlock->setTypedBuffer(handle, pBuf);
+    }
+
+    bool ProgramVars::setStructuredBuffer(const ReflectionVarHandle& handle, StructuredBuffer::SharedPtr pBuf)
+    {
+        return mDefaultBlock.pBlock->setStructuredBuffer(handle, pBuf);
+    }
+
+    bool ProgramVars::setTexture(const ReflectionVarHandle& handle, const Texture::SharedPtr& pTexture)
+    {
+        return mDefaultBlock.pBlock->setTexture(handle, pTexture);
+    }
+
+    bool ProgramVars::setSampler(const ReflectionVarHandle& handle, const Sampler::SharedPtr& pSampler)
+    {
+        return mDefaultBlock.pBlock->setSampler(handle, pSampler);
+    }
+
     ConstantBuffer::SharedPtr ProgramVars::getConstantBuffer(uint32_t regSpace, uint32_t baseRegIndex, uint32_t arrayIndex) const
     {
         const auto& loc = mpReflector->translateRegisterIndicesToBindLocation(regSpace, baseRegIndex, ProgramReflection::BindType::Cbv);
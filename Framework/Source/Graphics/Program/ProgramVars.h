@@ -57,6 +57,7 @@ namespace Falcor
             constexpr SharedPtrT(nullptr_t) : std::shared_ptr<T>(nullptr) {}
             SharedPtrT(const std::shared_ptr<T>& other) : std::shared_ptr<T>(other) {}
             ConstantBuffer::SharedPtr operator[](const std::string& cbName) { return std::shared_ptr<T>::get()->getConstantBuffer(cbName); }
+            ConstantBuffer::SharedPtr operator[](const ReflectionVarHandle& handle) { return std::shared_ptr<T>::get()->getConstantBuffer(handle); }
             ConstantBuffer::SharedPtr operator[](uint32_t index) = delete; // No set by index. This is here because if we didn't explicitly delete it, the compiler will try to convert to int into a string, resulting in runtime error
         };
 
@@ -87,6 +88,22 @@ namespace Falcor
         */
         ConstantBuffer::SharedPtr getConstantBuffer(const std::string& name) const;
 
+        /** Resolve a handle to a resource in the default parameter-block. Binding resources through a handle skips the name lookups. See ReflectionVarHandle
+            \param[in] name The name of the resource. Can contain array indices and struct members
+            \return The handle. Check ReflectionVarHandle::isValid() for errors
+        */
+        ReflectionVarHandle getResourceHandle(const std::string& name) const;
+
+        /** Bind a constant buffer object using a handle returned by getResourceHandle()
+            \return false is the call failed, otherwise true
+        */
+        bool setConstantBuffer(const ReflectionVarHandle& handle, const ConstantBuffer::SharedPtr& pCB);
+
+        /** Get a constant buffer object using a handle returned by getResourceHandle()
+            \return If the handle is valid, a shared pointer to the CB. Otherwise returns nullptr
+        */
+        ConstantBuffer::SharedPtr getConstantBuffer(const ReflectionVarHandle& handle) const;
+
         /** Get a constant buffer object.
             Please note that the register space and index are the global indices used in the program. Do not confuse those indices with ParameterBlock::BindLocation.
             \param[in] regSpace The register space
@@ -117,6 +134,18 @@ namespace Falcor
         */
         bool setStructuredBuffer(const std::string& name, StructuredBuffer::SharedPtr pBuf);
 
+        /** Set a raw-buffer using a handle returned by getResourceHandle()
+        */
+        bool setRawBuffer(const ReflectionVarHandle& handle, Buffer::SharedPtr pBuf);
+
+        /** Set a typed buffer using a handle returned by getResourceHandle()
+        */
+        bool setTypedBuffer(const ReflectionVarHandle& handle, TypedBufferBase::SharedPtr pBuf);
+
+        /** Set a structured buffer using a handle returned by getResourceHandle()
+        */
+        bool setStructuredBuffer(const ReflectionVarHandle& handle, StructuredBuffer::SharedPtr pBuf);
+
         /** Get a raw-buffer object.
             \param[in] name The name of the buffer
             \return If the name is valid, a shared pointer to the buffer object. Otherwise returns nullptr
@@ -142,6 +171,10 @@ namespace Falcor
         */
         bool setTexture(const std::string& name, const Texture::SharedPtr& pTexture);
 
+        /** Bind a texture using a handle returned by getResourceHandle()
+        */
+        bool setTexture(const ReflectionVarHandle& handle, const Texture::SharedPtr& pTexture);
+
         /** Get a texture object.
             \param[in] name The name of the texture
             \return If the name is valid, a shared pointer to the texture object. Otherwise returns nullptr
@@ -203,6 +236,10 @@ namespace Falcor
         */
         bool setSampler(uint32_t regSpace, uint32_t baseRegIndex, uint32_t arrayIndex, const Sampler::SharedPtr& pSampler);
 
+        /** Bind a sampler using a handle returned by getResourceHandle()
+        */
+        bool setSampler(const ReflectionVarHandle& handle, const Sampler::SharedPtr& pSampler);
+
         /** Gets a sampler object.
             \return If the index is valid, a shared pointer to the sampler. Otherwise returns nullptr
         */
@@ -0,0 +1,336 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ShaderCache.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include "Utils/Platform/OS.h"
+#include "Utils/BinaryMemoryStream.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Hash.h"
+
+namespace Falcor
+{
+    static const uint32_t kCacheFileMagic = 0x43535346; // 'FSSC'
+    static const uint32_t kCacheFileVersion = 1;
+    static const std::string kCacheFileExtension = ".fsc";
+
+    struct CacheFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t payloadSize;
+        uint64_t payloadHash;
+    };
+
+    static struct
+    {
+        bool enabled = true;
+        std::string directory;
+        std::mutex mutex;
+        ShaderCache::Stats stats;
+    } gCache;
+
+    /** A blob which owns a copy of the cached code. Implements the COM-style interface expected by Shader::Blob
+    */
+    class CachedShaderBlob final : public ISlangBlob
+    {
+    public:
+        CachedShaderBlob(const std::vector<uint8_t>& data) : mData(data) {}
+
+        SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** ppObject) override
+        {
+            static const SlangUUID kUnknownUUID = SLANG_UUID_ISlangUnknown;
+            static const SlangUUID kBlobUUID = SLANG_UUID_ISlangBlob;
+            if (isSameUUID(uuid, kUnknownUUID) || isSameUUID(uuid, kBlobUUID))
+            {
+                addRef();
+                *ppObject = static_cast<ISlangBlob*>(this);
+                return SLANG_OK;
+            }
+            *ppObject = nullptr;
+            return SLANG_E_NO_INTERFACE;
+        }
+
+        SLANG_NO_THROW uint32_t SLANG_MCALL addRef() override { return ++mRefCount; }
+
+        SLANG_NO_THROW uint32_t SLANG_MCALL release() override
+        {
+            uint32_t count = --mRefCount;
+            if (count == 0) delete this;
+            return count;
+        }
+
+        SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() override { return mData.data(); }
+        SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() override { return mData.size(); }
+
+    private:
+        static bool isSameUUID(const SlangUUID& a, const SlangUUID& b) { return memcmp(&a, &b, sizeof(SlangUUID)) == 0; }
+        std::vector<uint8_t> mData;
+        std::atomic<uint32_t> mRefCount{ 0 };
+    };
+
+    static void writeString(BinaryMemoryWriter& writer, const std::string& str)
+    {
+        writer << (uint64_t)str.size();
+        writer.write(str.data(), str.size());
+    }
+
+    static bool readString(BinaryMemoryStream& stream, std::string& str)
+    {
+        uint64_t size = 0;
+        stream >> size;
+        const char* pChars = (const char*)stream.readSpan((size_t)size);
+        if (pChars == nullptr) return false;
+        str.assign(pChars, (size_t)size);
+        return true;
+    }
+
+    static void writeBytes(BinaryMemoryWriter& writer, const std::vector<uint8_t>& data)
+    {
+        writer << (uint64_t)data.size();
+        writer.write(data.data(), data.size());
+    }
+
+    static bool readBytes(BinaryMemoryStream& stream, std::vector<uint8_t>& data)
+    {
+        uint64_t size = 0;
+        stream >> size;
+        const uint8_t* pBytes = (const uint8_t*)stream.readSpan((size_t)size);
+        if (pBytes == nullptr) return false;
+        data.assign(pBytes, pBytes + size);
+        return true;
+    }
+
+    static bool readFileData(const std::string& path, std::vector<uint8_t>& data)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (file.is_open() == false) return false;
+        std::streamoff size = file.tellg();
+        if (size < 0) return false;
+        data.resize((size_t)size);
+        file.seekg(0, std::ios::beg);
+        if (size > 0) file.read((char*)data.data(), size);
+        return file.good() || (size == 0);
+    }
+
+    /** Parse and validate the content of a cache file
+    */
+    static bool parseCacheFile(const std::vector<uint8_t>& fileData, const std::string& key, ShaderCache::Entry& entry)
+    {
+        BinaryMemoryStream stream(fileData.data(), fileData.size());
+        CacheFileHeader header;
+        stream >> header;
+        if (stream.isFail() || header.magic != kCacheFileMagic || header.version != kCacheFileVersion) return false;
+
+        const void* pPayload = stream.readSpan(stream.getRemainingStreamSize());
+        if (header.payloadSize != fileData.size() - sizeof(CacheFileHeader) || header.payloadHash != hashData(pPayload, (size_t)header.payloadSize)) return false;
+
+        stream = BinaryMemoryStream(pPayload, (size_t)header.payloadSize);
+
+        // The file name is only a hash of the key. Compare the full key to make sure this is the entry we are looking for
+        std::string storedKey;
+        if (readString(stream, storedKey) == false || storedKey != key) return false;
+
+        for (uint32_t i = 0; i < ShaderCache::kShaderCount; i++)
+        {
+            if (readBytes(stream, entry.code[i]) == false) return false;
+        }
+        if (readBytes(stream, entry.reflection) == false) return false;
+
+        uint32_t dependencyCount = 0;
+        stream >> dependencyCount;
+        entry.dependencies.clear();
+        for (uint32_t i = 0; i < dependencyCount; i++)
+        {
+            ShaderCache::Dependency d;
+            if (readString(stream, d.path) == false) return false;
+            stream >> d.hash;
+            if (stream.isFail()) return false;
+
+            // Make sure that the included files didn't change since the entry was created
+            uint64_t currentHash;
+            if (hashFile(d.path, currentHash) == false || currentHash != d.hash) return false;
+            entry.dependencies.push_back(d);
+        }
+
+        return stream.isFail() == false;
+    }
+
+    void ShaderCache::setEnabled(bool enabled)
+    {
+        gCache.enabled = enabled;
+    }
+
+    bool ShaderCache::isEnabled()
+    {
+        return gCache.enabled;
+    }
+
+    void ShaderCache::setDirectory(const std::string& directory)
+    {
+        gCache.directory = directory;
+    }
+
+    const std::string& ShaderCache::getDirectory()
+    {
+        if (gCache.directory.empty())
+        {
+            gCache.directory = getUserCacheDirectory() + "/ShaderCache";
+        }
+        return gCache.directory;
+    }
+
+    void ShaderCache::clear()
+    {
+        const std::string& dir = getDirectory();
+        std::vector<std::string> filenames;
+#ifdef _WIN32
+        enumerateFiles(dir + "/*" + kCacheFileExtension, filenames);
+#else
+        enumerateFiles(dir, filenames);
+#endif
+        for (const auto& f : filenames)
+        {
+            if (hasSuffix(f, kCacheFileExtension))
+            {
+                std::remove((dir + '/' + f).c_str());
+            }
+        }
+    }
+
+    std::string ShaderCache::getEntryFilename(const std::string& key)
+    {
+        char name[17];
+        snprintf(name, arraysize(name), "%016llx", (unsigned long long)hashData(key.data(), key.size()));
+        return getDirectory() + '/' + name + kCacheFileExtension;
+    }
+
+    bool ShaderCache::load(const std::string& key, Entry& entry)
+    {
+        if (gCache.enabled == false) return false;
+
+        std::vector<uint8_t> fileData;
+        bool found = readFileData(getEntryFilename(key), fileData);
+        bool valid = found && parseCacheFile(fileData, key, entry);
+
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        if (valid)
+        {
+            gCache.stats.hits++;
+        }
+        else
+        {
+            gCache.stats.misses++;
+            if (found) gCache.stats.rejected++;
+        }
+        return valid;
+    }
+
+    bool ShaderCache::store(const std::string& key, const Entry& entry)
+    {
+        if (gCache.enabled == false) return false;
+
+        BinaryMemoryWriter payload;
+        writeString(payload, key);
+        for (uint32_t i = 0; i < kShaderCount; i++) writeBytes(payload, entry.code[i]);
+        writeBytes(payload, entry.reflection);
+        payload << (uint32_t)entry.dependencies.size();
+        for (const auto& d : entry.dependencies)
+        {
+            writeString(payload, d.path);
+            payload << d.hash;
+        }
+
+        CacheFileHeader header;
+        header.magic = kCacheFileMagic;
+        header.version = kCacheFileVersion;
+        header.payloadSize = payload.getData().size();
+        header.payloadHash = hashData(payload.getData().data(), payload.getData().size());
+
+        const std::string& dir = getDirectory();
+        if (isDirectoryExists(dir) == false && createDirectory(dir) == false)
+        {
+            logWarning("ShaderCache::store() - can't create cache directory '" + dir + "'");
+            return false;
+        }
+
+        // Write to a temporary file first, so that an interrupted write never leaves a partial entry behind
+        std::string filename = getEntryFilename(key);
+        std::string tempFilename = filename + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+            if (file.is_open() == false) return false;
+            file.write((const char*)&header, sizeof(header));
+            file.write((const char*)payload.getData().data(), payload.getData().size());
+            if (file.good() == false)
+            {
+                file.close();
+                std::remove(tempFilename.c_str());
+                return false;
+            }
+        }
+
+        std::remove(filename.c_str());
+        if (std::rename(tempFilename.c_str(), filename.c_str()) != 0)
+        {
+            std::remove(tempFilename.c_str());
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.stats.stores++;
+        return true;
+    }
+
+    void ShaderCache::recordLatency(bool hit, double timeMs)
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        if (hit) gCache.stats.hitTimeMs += timeMs;
+        else     gCache.stats.missTimeMs += timeMs;
+    }
+
+    ShaderCache::Stats ShaderCache::getStats()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        return gCache.stats;
+    }
+
+    void ShaderCache::resetStats()
+    {
+        std::lock_guard<std::mutex> lock(gCache.mutex);
+        gCache.stats = Stats();
+    }
+
+    Shader::Blob ShaderCache::createBlob(const std::vector<uint8_t>& data)
+    {
+        return Shader::Blob(new CachedShaderBlob(data));
+    }
+}
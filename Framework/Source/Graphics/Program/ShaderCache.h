@@ -0,0 +1,129 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <mutex>
+#include "API/Shader.h"
+
+namespace Falcor
+{
+    /** Content-addressed disk cache for compiled programs.
+        An entry stores the compiled code of each shader stage together with the serialized program reflection. Entries are addressed by a key string which should
+        contain everything that affects the compilation result (source hashes, defines, shader model, compiler flags, etc.). Files included by the shaders are only
+        known after compilation, so they are stored in the entry alongside a hash of their content and are re-hashed and validated when the entry is loaded.
+    */
+    class ShaderCache
+    {
+    public:
+        static const uint32_t kShaderCount = (uint32_t)ShaderType::Count;
+
+        /** A file the cached program depends on
+        */
+        struct Dependency
+        {
+            std::string path;       ///< Full path of the file
+            uint64_t hash = 0;      ///< Hash of the file content
+        };
+
+        /** A cache entry
+        */
+        struct Entry
+        {
+            std::vector<uint8_t> code[kShaderCount];    ///< Compiled code for each shader stage. Empty for unused stages
+            std::vector<uint8_t> reflection;            ///< Serialized reflection data
+            std::vector<Dependency> dependencies;       ///< Files the program depends on
+        };
+
+        /** Cache statistics
+        */
+        struct Stats
+        {
+            uint64_t hits = 0;          ///< Number of loads which found a valid entry
+            uint64_t misses = 0;        ///< Number of loads which didn't find a valid entry, including rejected entries
+            uint64_t rejected = 0;      ///< Number of entries which were found but failed validation
+            uint64_t stores = 0;        ///< Number of entries written to disk
+            double hitTimeMs = 0;       ///< Total time spent creating programs from cached entries
+            double missTimeMs = 0;      ///< Total time spent creating programs which weren't in the cache
+        };
+
+        /** Enable or disable the cache. The cache is enabled by default
+        */
+        static void setEnabled(bool enabled);
+
+        /** Check if the cache is enabled
+        */
+        static bool isEnabled();
+
+        /** Set the directory the cache files are stored in. By default, the cache is stored in a `ShaderCache` folder in the user's cache directory, see getUserCacheDirectory()
+        */
+        static void setDirectory(const std::string& directory);
+
+        /** Get the directory the cache files are stored in
+        */
+        static const std::string& getDirectory();
+
+        /** Delete all the files stored in the cache directory
+        */
+        static void clear();
+
+        /** Look for an entry in the cache.
+            \param[in] key The key string of the entry
+            \param[out] entry On success, the cached data
+            \return true if a valid entry was found, otherwise false. An entry is valid only if its checksum and key match and none of its dependencies changed
+        */
+        static bool load(const std::string& key, Entry& entry);
+
+        /** Store an entry in the cache. If an entry with the same key exists it will be replaced
+            \param[in] key The key string of the entry
+            \param[in] entry The data to store
+            \return true if the entry was written to disk, otherwise false
+        */
+        static bool store(const std::string& key, const Entry& entry);
+
+        /** Record the time it took to create a program, used for the hit/miss latency statistics
+            \param[in] hit Whether the program was created from a cached entry
+            \param[in] timeMs The time in milliseconds
+        */
+        static void recordLatency(bool hit, double timeMs);
+
+        /** Get the cache statistics
+        */
+        static Stats getStats();
+
+        /** Reset the cache statistics
+        */
+        static void resetStats();
+
+        /** Create a shader blob which holds a copy of the data
+        */
+        static Shader::Blob createBlob(const std::vector<uint8_t>& data);
+
+        /** Get the file used to store an entry
+        */
+        static std::string getEntryFilename(const std::string& key);
+    };
+}
@@ -0,0 +1,59 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "InstanceDataPacker.h"
+#include "glm/matrix.hpp"
+
+namespace Falcor
+{
+    void InstanceDataPacker::clear()
+    {
+        mWorldMats.clear();
+        mPrevWorldMats.clear();
+        mWorldInvTransposeMats.clear();
+        mDrawIds.clear();
+    }
+
+    void InstanceDataPacker::reserve(uint32_t instanceCount)
+    {
+        mWorldMats.reserve(instanceCount);
+        mPrevWorldMats.reserve(instanceCount);
+        mWorldInvTransposeMats.reserve(instanceCount);
+        mDrawIds.reserve(instanceCount);
+    }
+
+    uint32_t InstanceDataPacker::addInstance(const glm::mat4& worldMat, const glm::mat4& prevWorldMat, uint32_t drawID)
+    {
+        uint32_t index = getInstanceCount();
+        mWorldMats.push_back(worldMat);
+        mPrevWorldMats.push_back(prevWorldMat);
+        mWorldInvTransposeMats.push_back(glm::mat3x4(transpose(inverse(glm::mat3(worldMat)))));
+        mDrawIds.push_back(drawID);
+        return index;
+    }
+}
@@ -0,0 +1,85 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "glm/mat3x4.hpp"
+#include "glm/mat4x4.hpp"
+
+namespace Falcor
+{
+    /** Packs the per-instance data of the mesh instances drawn by SceneRenderer, in the structure-of-arrays layout of the instance buffers declared in ShaderCommon.slang.
+        A draw's instances are stored contiguously, and the shaders fetch them with gFirstInstance + SV_InstanceID.
+        Doesn't touch any GPU resources, so the packing can be tested and benchmarked on its own.
+    */
+    class InstanceDataPacker
+    {
+    public:
+        /** Remove all the instances. Keeps the allocated memory
+        */
+        void clear();
+
+        /** Reserve memory for a number of instances
+        */
+        void reserve(uint32_t instanceCount);
+
+        /** Append an instance
+            \param[in] worldMat The instance's world transform
+            \param[in] prevWorldMat The instance's world transform in the previous frame
+            \param[in] drawID The instance's draw ID. See SceneRenderer::CurrentWorkingData::drawID
+            \return The index of the instance in the arrays
+        */
+        uint32_t addInstance(const glm::mat4& worldMat, const glm::mat4& prevWorldMat, uint32_t drawID);
+
+        /** Get the number of instances
+        */
+        uint32_t getInstanceCount() const { return (uint32_t)mDrawIds.size(); }
+
+        /** Get the world transforms
+        */
+        const std::vector<glm::mat4>& getWorldMats() const { return mWorldMats; }
+
+        /** Get the world transforms of the previous frame
+        */
+        const std::vector<glm::mat4>& getPrevWorldMats() const { return mPrevWorldMats; }
+
+        /** Get the matrices transforming the normals to world space. HLSL uses column-major and packing rules require 16B alignment, hence the glm::mat3x4
+        */
+        const std::vector<glm::mat3x4>& getWorldInvTransposeMats() const { return mWorldInvTransposeMats; }
+
+        /** Get the draw IDs
+        */
+        const std::vector<uint32_t>& getDrawIds() const { return mDrawIds; }
+
+    private:
+        std::vector<glm::mat4> mWorldMats;
+        std::vector<glm::mat4> mPrevWorldMats;
+        std::vector<glm::mat3x4> mWorldInvTransposeMats;
+        std::vector<uint32_t> mDrawIds;
+    };
+}
@@ -105,6 +105,138 @@ namespace Falcor
         }
     }
 
+    static BoundingBox getMeshInstanceWorldBounds(const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance)
+    {
+        return pMeshInstance->getBoundingBox().transform(pModelInstance->getTransformMatrix());
+    }
+
+    void Scene::updateBVH()
+    {
+        if (mpBVH == nullptr)
+        {
+            mpBVH = SceneBVH::create();
+        }
+
+        // Adding or removing models and instances sets mBVHDirty, other structural changes are detected below and rebuild the hierarchy.
+        // Otherwise only the items of the instances which moved are updated. The mesh instances are shared by all the instances of a model, so they are checked once per model,
+        // and an unchanged scene costs a version check per model instance.
+        bool rebuild = mBVHDirty || (mBVHFirstItem.size() != getModelCount());
+        bool changed = false;
+        for (uint32_t modelID = 0; modelID < getModelCount() && !rebuild; modelID++)
+        {
+            const Model* pModel = getModel(modelID).get();
+            const auto& meshOffset = mBVHMeshOffset[modelID];
+            const uint32_t instanceCount = getModelInstanceCount(modelID);
+            if (instanceCount != mBVHFirstItem[modelID].size() || meshOffset.size() != pModel->getMeshCount() + 1)
+            {
+                rebuild = true;
+                break;
+            }
+            if (instanceCount == 0 || meshOffset.back() == 0) continue;
+
+            // Compare the mesh instances with the items of the first model instance
+            const uint32_t firstItem = mBVHFirstItem[modelID][0];
+            uint32_t meshVersion = 0;
+            for (uint32_t meshID = 0; meshID < pModel->getMeshCount() && !rebuild; meshID++)
+            {
+                const uint32_t meshInstanceCount = pModel->getMeshInstanceCount(meshID);
+                if (meshInstanceCount != meshOffset[meshID + 1] - meshOffset[meshID])
+                {
+                    rebuild = true;
+                    break;
+                }
+                for (uint32_t meshInstanceID = 0; meshInstanceID < meshInstanceCount; meshInstanceID++)
+                {
+                    const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, meshInstanceID).get();
+                    if (mBVHItems[firstItem + meshOffset[meshID] + meshInstanceID].pMeshInstance != pMeshInstance)
+                    {
+                        rebuild = true;
+                        break;
+                    }
+                    meshVersion += pMeshInstance->getTransformVersion();
+                }
+            }
+            if (rebuild) break;
+
+            // The versions only grow, so the sum changes whenever a mesh instance moves
+            const bool meshesMoved = (meshVersion != mBVHMeshVersion[modelID]);
+            mBVHMeshVersion[modelID] = meshVersion;
+
+            for (uint32_t instanceID = 0; instanceID < instanceCount; instanceID++)
+            {
+                const ModelInstance* pInstance = getModelInstance(modelID, instanceID).get();
+                const uint32_t instanceFirstItem = mBVHFirstItem[modelID][instanceID];
+                if (mBVHItems[instanceFirstItem].pModelInstance != pInstance)
+                {
+                    rebuild = true;
+                    break;
+                }
+                if (!meshesMoved && mBVHItems[instanceFirstItem].modelInstanceVersion == pInstance->getTransformVersion()) continue;
+
+                for (uint32_t itemID = instanceFirstItem; itemID < instanceFirstItem + meshOffset.back(); itemID++)
+                {
+                    BVHItem& item = mBVHItems[itemID];
+                    if (item.modelInstanceVersion != pInstance->getTransformVersion() || item.meshInstanceVersion != item.pMeshInstance->getTransformVersion())
+                    {
+                        item.modelInstanceVersion = pInstance->getTransformVersion();
+                        item.meshInstanceVersion = item.pMeshInstance->getTransformVersion();
+                        mpBVH->setItemBounds(itemID, getMeshInstanceWorldBounds(pInstance, item.pMeshInstance));
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        if (rebuild == false)
+        {
+            if (changed) mpBVH->refit();
+            return;
+        }
+
+        mBVHDirty = false;
+        mBVHItems.clear();
+        mBVHFirstItem.resize(getModelCount());
+        mBVHMeshOffset.resize(getModelCount());
+        mBVHMeshVersion.assign(getModelCount(), 0);
+        std::vector<BoundingBox> itemBounds;
+
+        for (uint32_t modelID = 0; modelID < getModelCount(); modelID++)
+        {
+            const Model* pModel = getModel(modelID).get();
+            auto& meshOffset = mBVHMeshOffset[modelID];
+            meshOffset.resize(pModel->getMeshCount() + 1);
+            uint32_t offset = 0;
+            for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+            {
+                meshOffset[meshID] = offset;
+                offset += pModel->getMeshInstanceCount(meshID);
+                for (uint32_t meshInstanceID = 0; meshInstanceID < pModel->getMeshInstanceCount(meshID); meshInstanceID++)
+                {
+                    mBVHMeshVersion[modelID] += pModel->getMeshInstance(meshID, meshInstanceID)->getTransformVersion();
+                }
+            }
+            meshOffset.back() = offset;
+
+            mBVHFirstItem[modelID].resize(getModelInstanceCount(modelID));
+            for (uint32_t instanceID = 0; instanceID < getModelInstanceCount(modelID); instanceID++)
+            {
+                const ModelInstance* pInstance = getModelInstance(modelID, instanceID).get();
+                mBVHFirstItem[modelID][instanceID] = (uint32_t)mBVHItems.size();
+                for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+                {
+                    for (uint32_t meshInstanceID = 0; meshInstanceID < pModel->getMeshInstanceCount(meshID); meshInstanceID++)
+                    {
+                        const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, meshInstanceID).get();
+                        mBVHItems.push_back({ pInstance, pMeshInstance, pInstance->getTransformVersion(), pMeshInstance->getTransformVersion() });
+                        itemBounds.push_back(getMeshInstanceWorldBounds(pInstance, pMeshInstance));
+                    }
+                }
+            }
+        }
+
+        mpBVH->build(itemBounds);
+    }
+
     bool Scene::update(double currentTime, CameraController* cameraController)
     {
         bool changed = false;
@@ -116,14 +248,40 @@ namespace Falcor
             }
         }
 
+        // Instances with their own animation state are animated in a batch below. The model's animation only needs to run if some instances use it
+        mAnimationStates.clear();
         for (uint32_t i = 0; i < mModels.size(); i++)
         {
-            if (mModels[i][0]->getObject()->animate(currentTime))
+            bool usesModelAnimation = false;
+            for (const auto& pInstance : mModels[i])
+            {
+                if (pInstance->getAnimationState()) mAnimationStates.push_back(pInstance->getAnimationState().get());
+                else usesModelAnimation = true;
+            }
+
+            if (usesModelAnimation && mModels[i][0]->getObject()->animate(currentTime))
             {
                 changed = true;
             }
         }
 
+        if (mAnimationStates.empty() == false)
+        {
+            // Evaluate the poses on the worker threads, then skin on this thread since it records GPU work
+            if (AnimationState::animate(mAnimationStates, currentTime))
+            {
+                changed = true;
+            }
+
+            for (auto& instances : mModels)
+            {
+                for (const auto& pInstance : instances)
+                {
+                    if (pInstance->getAnimationState()) pInstance->getObject()->updateSkinning(pInstance->getAnimationState().get());
+                }
+            }
+        }
+
         mExtentsDirty = mExtentsDirty || changed;
 
         if (getCameraCount() > 0)
@@ -147,12 +305,14 @@ namespace Falcor
         // Delete entire vector of instances
         mModels.erase(mModels.begin() + modelID);
         mExtentsDirty = true;
+        mBVHDirty = true;
     }
 
     void Scene::deleteAllModels()
     {
         mModels.clear();
         mExtentsDirty = true;
+        mBVHDirty = true;
     }
 
     uint32_t Scene::getModelInstanceCount(uint32_t modelID) const
@@ -169,6 +329,8 @@ namespace Falcor
 
     void Scene::addModelInstance(const ModelInstance::SharedPtr& pInstance)
     {
+        mBVHDirty = true;
+
         // Checking for existing instance list for model
         for (uint32_t modelID = 0; modelID < (uint32_t)mModels.size(); modelID++)
         {
@@ -191,6 +353,11 @@ namespace Falcor
         // Delete instance
         auto& instances = mModels[modelID];
 
+        // Release the skinned vertex buffers of instances animated independently
+        const auto& pState = instances[instanceID]->getAnimationState();
+        const auto& pSkinningCache = instances[instanceID]->getObject()->getSkinningCache();
+        if (pState && pSkinningCache) pSkinningCache->release(pState.get());
+
         //  Check if there is only one instance left.
         if (instances.size() == 1)
         {
@@ -206,6 +373,7 @@ namespace Falcor
 
         //  Extents will be dirty in either case.
         mExtentsDirty = true;
+        mBVHDirty = true;
     }
 
     const Scene::UserVariable& Scene::getUserVariable(const std::string& name) const
@@ -323,6 +491,7 @@ namespace Falcor
 #undef merge
         mUserVars.insert(pFrom->mUserVars.begin(), pFrom->mUserVars.end());
         mExtentsDirty = true;
+        mBVHDirty = true;
     }
 
     void Scene::createAreaLights()
@@ -37,6 +37,7 @@
 #include "Graphics/Paths/ObjectPath.h"
 #include "Graphics/Model/ObjectInstance.h"
 #include "Graphics/Model/SkinningCache.h"
+#include "Graphics/Scene/SceneBVH.h"
 
 namespace Falcor
 {
@@ -102,6 +103,7 @@ namespace Falcor
         {
             None = 0x0,
             GenerateAreaLights = 0x1,    ///< Create area light(s) for meshes that have emissive material
+            SerialModelLoading = 0x2,    ///< Decode the model files on the calling thread only. By default, model files are decoded on worker threads
         };
 
         static Scene::SharedPtr loadFromFile(const std::string& filename, Model::LoadFlags modelLoadFlags = Model::LoadFlags::None, Scene::LoadFlags sceneLoadFlags = LoadFlags::None);
@@ -207,6 +209,22 @@ namespace Falcor
         */
         const BoundingBox& getBoundingBox() { updateExtents(); return mBoundingBox; }
 
+        /** Returns a bounding volume hierarchy over the world-space bounds of all mesh instances in the scene.
+            The hierarchy is rebuilt if models or instances were added or removed, and refit if instance transforms changed since the last call.
+        */
+        const SceneBVH::SharedPtr& getBVH() { updateBVH(); return mpBVH; }
+
+        /** Get the ID of a mesh instance in the hierarchy returned by getBVH(). Only valid after calling getBVH().
+            \param[in] modelID ID of the model
+            \param[in] instanceID ID of the model instance
+            \param[in] meshID ID of the mesh in the model
+            \param[in] meshInstanceID ID of the mesh instance
+        */
+        uint32_t getBVHItemID(uint32_t modelID, uint32_t instanceID, uint32_t meshID, uint32_t meshInstanceID) const
+        {
+            return mBVHFirstItem[modelID][instanceID] + mBVHMeshOffset[modelID][meshID] + meshInstanceID;
+        }
+
         /**
             This routine creates area light(s) in the scene. All meshes that
             have emissive material are treated as area lights.
@@ -248,11 +266,16 @@ namespace Falcor
         */
         void updateExtents();
 
+        /** Rebuild or refit the mesh instance hierarchy.
+        */
+        void updateBVH();
+
         static uint32_t sSceneCounter;
 
         uint32_t mId;
 
         std::vector<ModelInstanceList> mModels;
+        std::vector<AnimationState*> mAnimationStates;  // Scratch list used by update()
         std::vector<Light::SharedPtr> mpLights;
         std::vector<Camera::SharedPtr> mCameras;
         std::vector<ObjectPath::SharedPtr> mpPaths;
@@ -273,6 +296,21 @@ namespace Falcor
 
         bool mExtentsDirty = true;
 
+        struct BVHItem
+        {
+            const ModelInstance* pModelInstance;
+            const Model::MeshInstance* pMeshInstance;
+            uint32_t modelInstanceVersion;
+            uint32_t meshInstanceVersion;
+        };
+
+        SceneBVH::SharedPtr mpBVH;
+        bool mBVHDirty = true;
+        std::vector<BVHItem> mBVHItems;                         ///< Mesh instances in the hierarchy, ordered by [model][instance][mesh][meshInstance]
+        std::vector<std::vector<uint32_t>> mBVHFirstItem;       ///< [model][instance] ID of the first item of a model instance
+        std::vector<std::vector<uint32_t>> mBVHMeshOffset;      ///< [model][mesh] Offset of a mesh's instances from the first item of a model instance. The last entry is the number of items per model instance
+        std::vector<uint32_t> mBVHMeshVersion;                  ///< [model] Sum of the mesh instances' transform versions when the items were last updated
+
         std::string mFilename;
 
         using string_uservar_map = std::map<const std::string, UserVariable>;
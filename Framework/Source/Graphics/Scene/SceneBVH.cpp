@@ -0,0 +1,215 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "SceneBVH.h"
+#include "Graphics/Camera/Camera.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    SceneBVH::SharedPtr SceneBVH::create()
+    {
+        return SharedPtr(new SceneBVH());
+    }
+
+    void SceneBVH::build(const std::vector<BoundingBox>& itemBounds)
+    {
+        mItemBounds = itemBounds;
+        mNodes.clear();
+        mItemOrder.resize(itemBounds.size());
+        mItemLeaf.assign(itemBounds.size(), kInvalidNode);
+        for (uint32_t i = 0; i < (uint32_t)mItemOrder.size(); i++)
+        {
+            mItemOrder[i] = i;
+        }
+
+        if (mItemBounds.size())
+        {
+            mNodes.reserve(2 * (mItemBounds.size() / kMaxLeafSize + 1));
+            buildRecursive(0, (uint32_t)mItemOrder.size(), kInvalidNode);
+        }
+
+        mDirtyNodes.assign(mNodes.size(), false);
+        mDirty = false;
+    }
+
+    uint32_t SceneBVH::buildRecursive(uint32_t begin, uint32_t end, uint32_t parent)
+    {
+        const uint32_t nodeID = (uint32_t)mNodes.size();
+        mNodes.emplace_back();
+
+        glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+        glm::vec3 centerMin(FLT_MAX), centerMax(-FLT_MAX);
+        for (uint32_t i = begin; i < end; i++)
+        {
+            const BoundingBox& box = mItemBounds[mItemOrder[i]];
+            boundsMin = glm::min(boundsMin, box.getMinPos());
+            boundsMax = glm::max(boundsMax, box.getMaxPos());
+            centerMin = glm::min(centerMin, box.center);
+            centerMax = glm::max(centerMax, box.center);
+        }
+
+        Node& node = mNodes[nodeID];
+        node.bounds = BoundingBox::fromMinMax(boundsMin, boundsMax);
+        node.parent = parent;
+        node.firstItem = begin;
+        node.itemCount = end - begin;
+
+        if (node.itemCount <= kMaxLeafSize)
+        {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                mItemLeaf[mItemOrder[i]] = nodeID;
+            }
+            return nodeID;
+        }
+
+        // Median split along the axis with the largest spread of box centers
+        glm::vec3 spread = centerMax - centerMin;
+        int axis = (spread.x >= spread.y && spread.x >= spread.z) ? 0 : ((spread.y >= spread.z) ? 1 : 2);
+        uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(mItemOrder.begin() + begin, mItemOrder.begin() + mid, mItemOrder.begin() + end,
+            [this, axis](uint32_t a, uint32_t b) { return mItemBounds[a].center[axis] < mItemBounds[b].center[axis]; });
+
+        buildRecursive(begin, mid, nodeID);
+        uint32_t rightChild = buildRecursive(mid, end, nodeID);
+        mNodes[nodeID].rightChild = rightChild; // Don't keep a reference to the node across the recursion, the vector may have been reallocated
+        return nodeID;
+    }
+
+    void SceneBVH::setItemBounds(uint32_t itemID, const BoundingBox& bounds)
+    {
+        assert(itemID < mItemBounds.size());
+        mItemBounds[itemID] = bounds;
+
+        // Mark the path to the root. Stop once we reach a node which is already marked, its ancestors are marked as well
+        uint32_t nodeID = mItemLeaf[itemID];
+        while (nodeID != kInvalidNode && mDirtyNodes[nodeID] == false)
+        {
+            mDirtyNodes[nodeID] = true;
+            nodeID = mNodes[nodeID].parent;
+        }
+        mDirty = true;
+    }
+
+    void SceneBVH::updateNodeBounds(uint32_t nodeID)
+    {
+        Node& node = mNodes[nodeID];
+        if (node.isLeaf())
+        {
+            glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+            for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; i++)
+            {
+                const BoundingBox& box = mItemBounds[mItemOrder[i]];
+                boundsMin = glm::min(boundsMin, box.getMinPos());
+                boundsMax = glm::max(boundsMax, box.getMaxPos());
+            }
+            node.bounds = BoundingBox::fromMinMax(boundsMin, boundsMax);
+        }
+        else
+        {
+            node.bounds = BoundingBox::fromUnion(mNodes[nodeID + 1].bounds, mNodes[node.rightChild].bounds);
+        }
+    }
+
+    void SceneBVH::refit()
+    {
+        if (mDirty == false) return;
+
+        // Children are always stored after their parents, so a reverse walk updates them first
+        for (size_t i = mNodes.size(); i-- > 0;)
+        {
+            if (mDirtyNodes[i])
+            {
+                updateNodeBounds((uint32_t)i);
+                mDirtyNodes[i] = false;
+            }
+        }
+        mDirty = false;
+    }
+
+    uint32_t SceneBVH::cull(const Camera* pCamera, std::vector<uint8_t>& visibility) const
+    {
+        assert(mDirty == false);
+        visibility.assign(mItemBounds.size(), 0);
+        if (mNodes.empty()) return 0;
+
+        uint32_t visibleCount = 0;
+        mBatchItems.clear();
+        mBatchBounds.clear();
+        std::vector<uint32_t> stack;
+        stack.reserve(64);
+        stack.push_back(0);
+
+        while (stack.empty() == false)
+        {
+            uint32_t nodeID = stack.back();
+            stack.pop_back();
+            const Node& node = mNodes[nodeID];
+
+            Camera::FrustumIntersection result = pCamera->intersectFrustum(node.bounds);
+            if (result == Camera::FrustumIntersection::Outside) continue;
+
+            if (result == Camera::FrustumIntersection::Inside)
+            {
+                // Accept the entire subtree without testing it
+                for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; i++)
+                {
+                    visibility[mItemOrder[i]] = 1;
+                }
+                visibleCount += node.itemCount;
+            }
+            else if (node.isLeaf())
+            {
+                // Defer the items of partially visible leaves, they are tested together in a single batch
+                for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; i++)
+                {
+                    uint32_t itemID = mItemOrder[i];
+                    mBatchItems.push_back(itemID);
+                    mBatchBounds.push_back(mItemBounds[itemID]);
+                }
+            }
+            else
+            {
+                stack.push_back(node.rightChild);
+                stack.push_back(nodeID + 1);
+            }
+        }
+
+        if (mBatchItems.size())
+        {
+            visibleCount += pCamera->cullBoundingBoxes(mBatchBounds, mBatchMask);
+            for (uint32_t i = 0; i < (uint32_t)mBatchItems.size(); i++)
+            {
+                visibility[mBatchItems[i]] = (mBatchMask[i >> 5] >> (i & 31)) & 1;
+            }
+        }
+
+        return visibleCount;
+    }
+}
@@ -0,0 +1,127 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <memory>
+#include "Utils/AABB.h"
+
+namespace Falcor
+{
+    class Camera;
+
+    /** Bounding volume hierarchy over a set of axis-aligned bounding boxes.
+        The scene keeps one over the world-space bounds of all its mesh instances, which allows SceneRenderer to reject or accept entire subtrees with a single frustum test.
+        Items are identified by the index of their bounding box in the array passed to build().
+    */
+    class SceneBVH
+    {
+    public:
+        using SharedPtr = std::shared_ptr<SceneBVH>;
+        using SharedConstPtr = std::shared_ptr<const SceneBVH>;
+
+        /** Maximum number of items stored in a leaf node
+        */
+        static const uint32_t kMaxLeafSize = 4;
+
+        /** Create an empty hierarchy
+        */
+        static SharedPtr create();
+
+        /** Rebuild the hierarchy from scratch.
+            \param[in] itemBounds Bounding box of every item. The index of a box in the array is the item's ID.
+        */
+        void build(const std::vector<BoundingBox>& itemBounds);
+
+        /** Update the bounds of a single item. The hierarchy is not valid until refit() is called.
+            \param[in] itemID ID of the item
+            \param[in] bounds New bounding box of the item
+        */
+        void setItemBounds(uint32_t itemID, const BoundingBox& bounds);
+
+        /** Recalculate the bounds of all nodes affected by setItemBounds() calls since the last refit.
+            Only the ancestors of changed items are visited.
+        */
+        void refit();
+
+        /** Cull the items against a camera frustum.
+            \param[in] pCamera The camera to cull against
+            \param[out] visibility Will be resized to the number of items. An entry is non-zero if the item is potentially visible.
+            \return The number of visible items
+        */
+        uint32_t cull(const Camera* pCamera, std::vector<uint8_t>& visibility) const;
+
+        /** Get the number of items in the hierarchy
+        */
+        uint32_t getItemCount() const { return (uint32_t)mItemBounds.size(); }
+
+        /** Get the number of nodes in the hierarchy
+        */
+        uint32_t getNodeCount() const { return (uint32_t)mNodes.size(); }
+
+        /** Get the bounding box of an item
+        */
+        const BoundingBox& getItemBounds(uint32_t itemID) const { return mItemBounds[itemID]; }
+
+        /** Get the bounding box enclosing all the items. Only valid if the hierarchy is not empty.
+        */
+        const BoundingBox& getBounds() const { return mNodes[0].bounds; }
+
+    private:
+        SceneBVH() = default;
+
+        static const uint32_t kInvalidNode = (uint32_t)-1;
+
+        /** Nodes are stored depth-first, so a node's left child immediately follows it and every child has a larger index than its parent.
+            The items of a subtree occupy a contiguous range in mItemOrder.
+        */
+        struct Node
+        {
+            BoundingBox bounds;
+            uint32_t parent = kInvalidNode;
+            uint32_t rightChild = kInvalidNode; ///< kInvalidNode for leaf nodes
+            uint32_t firstItem = 0;             ///< Offset into mItemOrder
+            uint32_t itemCount = 0;             ///< Total number of items in the subtree
+            bool isLeaf() const { return rightChild == kInvalidNode; }
+        };
+
+        uint32_t buildRecursive(uint32_t begin, uint32_t end, uint32_t parent);
+        void updateNodeBounds(uint32_t nodeID);
+
+        std::vector<Node> mNodes;
+        std::vector<BoundingBox> mItemBounds;
+        std::vector<uint32_t> mItemOrder;   ///< Item IDs sorted so that the items of each subtree are contiguous
+        std::vector<uint32_t> mItemLeaf;    ///< Leaf node containing each item
+        std::vector<bool> mDirtyNodes;
+        bool mDirty = false;
+
+        // Scratch space for batching the items of partially visible leaves in cull()
+        mutable std::vector<uint32_t> mBatchItems;
+        mutable BoundingBoxSoA mBatchBounds;
+        mutable std::vector<uint32_t> mBatchMask;
+    };
+}
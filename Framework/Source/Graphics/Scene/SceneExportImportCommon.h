@@ -86,6 +86,7 @@ namespace Falcor
         static const char* kLightIntensity = "intensity";
         static const char* kLightOpeningAngle = "opening_angle";
         static const char* kLightPenumbraAngle = "penumbra_angle";
+        static const char* kLightRange = "range";
         static const char* kLightPos = "pos";
         static const char* kLightDirection = "direction";
 
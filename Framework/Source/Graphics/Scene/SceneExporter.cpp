@@ -240,6 +240,7 @@ namespace Falcor
         addVector(jsonLight, allocator, SceneKeys::kLightDirection, pLight->getWorldDirection());
         addLiteral(jsonLight, allocator, SceneKeys::kLightOpeningAngle, glm::degrees(pLight->getOpeningAngle()));
         addLiteral(jsonLight, allocator, SceneKeys::kLightPenumbraAngle, glm::degrees(pLight->getPenumbraAngle()));
+        addLiteral(jsonLight, allocator, SceneKeys::kLightRange, pLight->getRange());
     }
 
     void createDirectionalLightValue(const DirectionalLight* pLight, rapidjson::Document::AllocatorType& allocator, rapidjson::Value& jsonLight)
@@ -175,7 +175,7 @@ namespace Falcor
         return true;
     }
 
-    bool SceneImporter::createModel(const rapidjson::Value& jsonModel)
+    bool SceneImporter::getModelFileAndFlags(const rapidjson::Value& jsonModel, std::string& file, Model::LoadFlags& modelFlags)
     {
         // Model must have at least a filename
         if (jsonModel.HasMember(SceneKeys::kFilename) == false)
@@ -190,14 +190,14 @@ namespace Falcor
             return error("Model filename must be a string");
         }
 
-        std::string file = mDirectory + '/' + modelFile.GetString();
+        file = mDirectory + '/' + modelFile.GetString();
         if (doesFileExist(file) == false)
         {
             file = modelFile.GetString();
         }
 
         // Parse additional properties that affect loading
-        Model::LoadFlags modelFlags = mModelLoadFlags;
+        modelFlags = mModelLoadFlags;
         if (jsonModel.HasMember(SceneKeys::kMaterial))
         {
             const auto& materialSettings = jsonModel[SceneKeys::kMaterial];
@@ -226,13 +226,11 @@ namespace Falcor
             }
         }
 
-        // Load the model
-        auto pModel = Model::createFromFile(file.c_str(), modelFlags);
-        if (pModel == nullptr)
-        {
-            return error("Could not load model: " + file);
-        }
+        return true;
+    }
 
+    bool SceneImporter::createModel(const rapidjson::Value& jsonModel, const Model::SharedPtr& pModel)
+    {
         bool instanceAdded = false;
 
         // Loop over the other members
@@ -304,15 +302,29 @@ namespace Falcor
             return error("models section should be an array of objects.");
         }
 
-        // Loop over the array
+        // Parse all the model entries up front, so that the files can be decoded in parallel
+        std::vector<std::string> files(jsonVal.Size());
+        std::vector<Model::LoadFlags> modelFlags(jsonVal.Size());
         for (uint32_t i = 0; i < jsonVal.Size(); i++)
         {
-            if (createModel(jsonVal[i]) == false)
+            if (getModelFileAndFlags(jsonVal[i], files[i], modelFlags[i]) == false)
             {
                 return false;
             }
         }
-        return true;
+
+        // Create the GPU resources and the instances in the scene-file order, so that the scene is identical to a serial load.
+        // Each model is created as soon as its file is decoded, and the decoded data is released right after
+        uint32_t threadCount = is_set(mSceneLoadFlags, Scene::LoadFlags::SerialModelLoading) ? 1 : 0;
+        return Model::decodeFiles(files, modelFlags, threadCount, [&](uint32_t i, const Model::DecodedFile::SharedPtr& pFile)
+        {
+            auto pModel = Model::createFromDecodedFile(pFile);
+            if (pModel == nullptr)
+            {
+                return error("Could not load model: " + files[i]);
+            }
+            return createModel(jsonVal[i], pModel);
+        });
     }
 
     bool SceneImporter::createDirLight(const rapidjson::Value& jsonLight)
@@ -414,6 +426,14 @@ namespace Falcor
                 angle = glm::radians(angle);
                 pPointLight->setPenumbraAngle(angle);
             }
+            else if (key == SceneKeys::kLightRange)
+            {
+                if (value.IsNumber() == false)
+                {
+                    return error("Point light range should be a number");
+                }
+                pPointLight->setRange((float)value.GetDouble());
+            }
             else if (key == SceneKeys::kLightIntensity)
             {
                 glm::vec3 intensity;
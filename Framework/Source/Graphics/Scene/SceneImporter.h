@@ -66,7 +66,8 @@ namespace Falcor
 
         bool loadIncludeFile(const std::string& Include);
 
-        bool createModel(const rapidjson::Value& jsonModel);
+        bool getModelFileAndFlags(const rapidjson::Value& jsonModel, std::string& file, Model::LoadFlags& modelFlags);
+        bool createModel(const rapidjson::Value& jsonModel, const Model::SharedPtr& pModel);
         bool createModelInstances(const rapidjson::Value& jsonVal, const Model::SharedPtr& pModel);
         bool createPointLight(const rapidjson::Value& jsonLight);
         bool createDirLight(const rapidjson::Value& jsonLight);
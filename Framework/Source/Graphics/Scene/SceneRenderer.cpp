@@ -35,19 +35,23 @@
 #include "Utils/Platform/OS.h"
 #include "VR/OpenVR/VRSystem.h"
 #include "API/Device.h"
+#include "Utils/TaskScheduler.h"
+#include "Utils/Hash.h"
 #include "glm/matrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace Falcor
 {
     size_t SceneRenderer::sBonesOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sBonesInvTransposeOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sCameraDataOffset = ConstantBuffer::kInvalidOffset;
-    size_t SceneRenderer::sWorldMatArraySize = 0;
     size_t SceneRenderer::sWorldMatOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sPrevWorldMatOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sWorldInvTransposeMatOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sMeshIdOffset = ConstantBuffer::kInvalidOffset;
-    size_t SceneRenderer::sDrawIDOffset = ConstantBuffer::kInvalidOffset;
+    size_t SceneRenderer::sFirstInstanceOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sLightCountOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sLightArrayOffset = ConstantBuffer::kInvalidOffset;
 
@@ -58,13 +62,22 @@ namespace Falcor
     const char* SceneRenderer::kProbeSharedVarName = "gProbeShared";
     const char* SceneRenderer::kAreaLightCbName = "InternalAreaLightCB";
 
+    static const char* kInstanceWorldMatsName = "gInstanceWorldMats";
+    static const char* kInstancePrevWorldMatsName = "gInstancePrevWorldMats";
+    static const char* kInstanceWorldInvTransposeMatsName = "gInstanceWorldInvTransposeMats";
+    static const char* kInstanceDrawIdsName = "gInstanceDrawIds";
+    static const char* kLightClusterCbName = "InternalLightClusterCB";
+    static const char* kClusteredLightsName = "gClusteredLights";
+    static const char* kLightClustersName = "gLightClusters";
+    static const char* kLightClusterIndicesName = "gLightClusterIndices";
+
 
     SceneRenderer::SharedPtr SceneRenderer::create(const Scene::SharedPtr& pScene)
     {
         return SharedPtr(new SceneRenderer(pScene));
     }
 
-    SceneRenderer::SceneRenderer(const Scene::SharedPtr& pScene) : mpScene(pScene)
+    SceneRenderer::SceneRenderer(const Scene::SharedPtr& pScene) : mpScene(pScene), mpTextureStreamer(TextureStreamer::getDefault())
     {
         setCameraControllerType(CameraControllerType::SixDof);
     }
@@ -81,16 +94,14 @@ namespace Falcor
             {
                 const ReflectionType* pType = pVar->getType().get();
 
-                assert(pType->findMember("gWorldMat[0]")->getType()->asBasicType()->isRowMajor() == true); // We copy into CBs as row-major
-                assert(pType->findMember("gWorldInvTransposeMat[0]")->getType()->asBasicType()->isRowMajor() == true);
-                assert(pType->findMember("gWorldMat")->getType()->getTotalArraySize() == pType->findMember("gWorldInvTransposeMat")->getType()->getTotalArraySize());
+                assert(pType->findMember("gWorldMat")->getType()->asBasicType()->isRowMajor() == true); // We copy into CBs as row-major
+                assert(pType->findMember("gWorldInvTransposeMat")->getType()->asBasicType()->isRowMajor() == true);
 
-                sWorldMatArraySize = pType->findMember("gWorldMat")->getType()->getTotalArraySize();
-                sWorldMatOffset = pType->findMember("gWorldMat[0]")->getOffset();
-                sWorldInvTransposeMatOffset = pType->findMember("gWorldInvTransposeMat[0]")->getOffset();
+                sWorldMatOffset = pType->findMember("gWorldMat")->getOffset();
+                sWorldInvTransposeMatOffset = pType->findMember("gWorldInvTransposeMat")->getOffset();
                 sMeshIdOffset = pType->findMember("gMeshId")->getOffset();
-                sDrawIDOffset = pType->findMember("gDrawId[0]")->getOffset();
-                sPrevWorldMatOffset = pType->findMember("gPrevWorldMat[0]")->getOffset();
+                sFirstInstanceOffset = pType->findMember("gFirstInstance")->getOffset();
+                sPrevWorldMatOffset = pType->findMember("gPrevWorldMat")->getOffset();
             }
         }
 
@@ -122,18 +133,27 @@ namespace Falcor
                 currentData.pCamera->setIntoConstantBuffer(pCB, sCameraDataOffset);
             }
 
-            // Set lights
+            // Set lights. The array only holds the first MAX_LIGHT_SOURCES lights, programs which need more lights use clustered lighting
+            const uint32_t lightCount = min(mpScene->getLightCount(), (uint32_t)MAX_LIGHT_SOURCES);
             if (sLightArrayOffset != ConstantBuffer::kInvalidOffset)
             {
-                assert(mpScene->getLightCount() <= MAX_LIGHT_SOURCES);  // Max array size in the shader
-                for (uint32_t i = 0; i < mpScene->getLightCount(); i++)
+                // Programs which define _CLUSTERED_LIGHTING declare the cluster buffers and get the other lights from them
+                const bool clustered = currentData.pVars->getReflection()->getDefaultParameterBlock()->getResource(kLightClustersName) != nullptr;
+                if (lightCount < mpScene->getLightCount() && !clustered && !mLightLimitWarned)
+                {
+                    logWarning("SceneRenderer: the scene has " + std::to_string(mpScene->getLightCount()) + " lights, but the program only uses the first " + std::to_string(MAX_LIGHT_SOURCES) +
+                        ". Define _CLUSTERED_LIGHTING in the program to use all of them.");
+                    mLightLimitWarned = true;
+                }
+
+                for (uint32_t i = 0; i < lightCount; i++)
                 {
                     mpScene->getLight(i)->setIntoProgramVars(currentData.pVars, pCB, sLightArrayOffset + (i * Light::getShaderStructSize()));
                 }
             }
             if (sLightCountOffset != ConstantBuffer::kInvalidOffset)
             {
-                pCB->setVariable(sLightCountOffset, mpScene->getLightCount());
+                pCB->setVariable(sLightCountOffset, lightCount);
             }
             if (mpScene->getLightProbeCount() > 0)
             {
@@ -162,6 +182,26 @@ namespace Falcor
                 }
             }
         }
+
+        updateLightClusters(currentData);
+    }
+
+    void SceneRenderer::setBoneMatrices(const CurrentWorkingData& currentData, const mat4* pBones, const mat4* pBonesInvTranspose)
+    {
+        ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(kBoneCbName).get();
+        if (pCB != nullptr)
+        {
+            if (sBonesOffset == ConstantBuffer::kInvalidOffset || sBonesInvTransposeOffset == ConstantBuffer::kInvalidOffset)
+            {
+                sBonesOffset = pCB->getVariableOffset("gBoneMat[0]");
+                sBonesInvTransposeOffset = pCB->getVariableOffset("gInvTransposeBoneMat[0]");
+            }
+
+            const Model* pModel = currentData.pModel;
+            assert(pModel->getBoneCount() <= MAX_BONES);
+            pCB->setVariableArray(sBonesOffset, pBones, pModel->getBoneCount());
+            pCB->setVariableArray(sBonesInvTransposeOffset, pBonesInvTranspose, pModel->getBoneCount());
+        }
     }
 
     bool SceneRenderer::setPerModelData(const CurrentWorkingData& currentData)
@@ -169,27 +209,32 @@ namespace Falcor
         const Model* pModel = currentData.pModel;
 
         // Set bones
+        mInstanceBonesBound = false;
         if (pModel->hasBones())
         {
-            ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(kBoneCbName).get();
-            if (pCB != nullptr)
-            {
-                if (sBonesOffset == ConstantBuffer::kInvalidOffset || sBonesInvTransposeOffset == ConstantBuffer::kInvalidOffset)
-                {
-                    sBonesOffset = pCB->getVariableOffset("gBoneMat[0]");
-                    sBonesInvTransposeOffset = pCB->getVariableOffset("gInvTransposeBoneMat[0]");
-                }
-
-                assert(pModel->getBoneCount() <= MAX_BONES);
-                pCB->setVariableArray(sBonesOffset, pModel->getBoneMatrices(), pModel->getBoneCount());
-                pCB->setVariableArray(sBonesInvTransposeOffset, pModel->getBoneInvTransposeMatrices(), pModel->getBoneCount());
-            }
+            setBoneMatrices(currentData, pModel->getBoneMatrices(), pModel->getBoneInvTransposeMatrices());
         }
         return true;
     }
 
     bool SceneRenderer::setPerModelInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t instanceID)
     {
+        // Instances animated independently replace the model's bones. Restore the model's bones for the following instances which use them
+        const Model* pModel = currentData.pModel;
+        if (pModel->hasBones() && !pModel->getSkinningCache())
+        {
+            const AnimationState* pState = pModelInstance->getAnimationState().get();
+            if (pState)
+            {
+                setBoneMatrices(currentData, pState->getBoneMatrices().data(), pState->getBoneInvTransposeMatrices().data());
+                mInstanceBonesBound = true;
+            }
+            else if (mInstanceBonesBound)
+            {
+                setBoneMatrices(currentData, pModel->getBoneMatrices(), pModel->getBoneInvTransposeMatrices());
+                mInstanceBonesBound = false;
+            }
+        }
         return true;
     }
 
@@ -198,33 +243,26 @@ namespace Falcor
         return true;
     }
 
-    bool SceneRenderer::setPerMeshInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t drawInstanceID)
+    void SceneRenderer::getMeshInstanceTransforms(const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, glm::mat4& worldMat, glm::mat4& prevWorldMat)
     {
-        ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(kPerMeshCbName).get();
-        if (pCB)
-        {
-            const Mesh* pMesh = pMeshInstance->getObject().get();
-
-            glm::mat4 worldMat = pModelInstance->getTransformMatrix();
-            glm::mat4 prevWorldMat = pModelInstance->getPrevTransformMatrix();
-
-            if (pMesh->hasBones() == false)
-            {
-                worldMat = worldMat * pMeshInstance->getTransformMatrix();
-                prevWorldMat = prevWorldMat * pMeshInstance->getPrevTransformMatrix();
-            }
+        worldMat = pModelInstance->getTransformMatrix();
+        prevWorldMat = pModelInstance->getPrevTransformMatrix();
 
-            glm::mat3x4 worldInvTransposeMat = transpose(inverse(glm::mat3(worldMat)));
-
-            assert(drawInstanceID < sWorldMatArraySize);
-            pCB->setBlob(&worldMat, sWorldMatOffset + drawInstanceID * sizeof(glm::mat4), sizeof(glm::mat4));
-            pCB->setBlob(&worldInvTransposeMat, sWorldInvTransposeMatOffset + drawInstanceID * sizeof(glm::mat3x4), sizeof(glm::mat3x4)); // HLSL uses column-major and packing rules require 16B alignment, hence use glm:mat3x4
-            pCB->setBlob(&prevWorldMat, sPrevWorldMatOffset + drawInstanceID * sizeof(glm::mat4), sizeof(glm::mat4));
-
-            // Set mesh id
-            pCB->setVariable(sMeshIdOffset, pMesh->getId());
+        if (pMeshInstance->getObject()->hasBones() == false)
+        {
+            worldMat = worldMat * pMeshInstance->getTransformMatrix();
+            prevWorldMat = prevWorldMat * pMeshInstance->getPrevTransformMatrix();
         }
+    }
 
+    bool SceneRenderer::setPerMeshInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t drawInstanceID)
+    {
+        glm::mat4 worldMat;
+        glm::mat4 prevWorldMat;
+        getMeshInstanceTransforms(pModelInstance, pMeshInstance, worldMat, prevWorldMat);
+
+        assert(drawInstanceID == mInstanceData.getInstanceCount());
+        mInstanceData.addInstance(worldMat, prevWorldMat, currentData.drawID);
         return true;
     }
 
@@ -234,13 +272,13 @@ namespace Falcor
         return true;
     }
 
-    void SceneRenderer::executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount)
+    void SceneRenderer::executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex)
     {
         // Draw
-        currentData.pContext->drawIndexedInstanced(indexCount, instanceCount, 0, 0, 0);
+        currentData.pContext->drawIndexedInstanced(indexCount, instanceCount, startIndex, 0, 0);
     }
 
-    void SceneRenderer::draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount)
+    void SceneRenderer::draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount, const MeshletCuller::IndexRange* pRanges, uint32_t rangeCount)
     {
         currentData.pMaterial = pMesh->getMaterial().get();
         // Bind material
@@ -258,7 +296,10 @@ namespace Falcor
             }
         }
 
-        executeDraw(currentData, pMesh->getIndexCount(), instanceCount);
+        for (uint32_t i = 0; i < rangeCount; i++)
+        {
+            executeDraw(currentData, pRanges[i].indexCount, instanceCount, pRanges[i].startIndex);
+        }
         postFlushDraw(currentData);
         currentData.pState->getProgram()->removeDefine("_MS_STATIC_MATERIAL_FLAGS");
     }
@@ -274,76 +315,355 @@ namespace Falcor
         return currentData.pCamera->isObjectCulled(box);
     }
 
-    void SceneRenderer::renderMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID)
+    bool SceneRenderer::isModelInstanceDrawn(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance)
+    {
+        return pModelInstance->isVisible();
+    }
+
+    float SceneRenderer::getProjectedRadius(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, const Mesh* pMesh) const
+    {
+        // Bounding sphere of the mesh instance in world space
+        const BoundingBox& box = pMesh->getBoundingBox();
+        const glm::mat4 world = pModelInstance->getTransformMatrix() * pMeshInstance->getTransformMatrix();
+        const float scale = glm::max(glm::length(glm::vec3(world[0])), glm::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+        const float radius = glm::length(box.extent);
+        const glm::vec3 center = glm::vec3(world * glm::vec4(box.center, 1));
+
+        const glm::mat4& proj = currentData.pCamera->getProjMatrix();
+        float projectedRadius = radius * scale * proj[1][1] * 0.5f;
+        if (proj[3][3] == 0)
+        {
+            float distance = glm::length(center - currentData.pCamera->getPosition()) - radius * scale;
+            if (distance <= 0) return std::numeric_limits<float>::infinity();
+            projectedRadius /= distance;
+        }
+        return projectedRadius;
+    }
+
+    uint32_t SceneRenderer::selectLod(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, const Mesh* pMesh)
+    {
+        // Instances the camera is inside of use the full-resolution mesh
+        const float projectedRadius = getProjectedRadius(currentData, pModelInstance, pMeshInstance, pMesh);
+        if (projectedRadius == std::numeric_limits<float>::infinity()) return 0;
+        const float radius = glm::length(pMesh->getBoundingBox().extent);
+        if (radius == 0) return pMesh->getLodCount() - 1;
+
+        // The levels are ordered by increasing error. Pick the coarsest one which is still below the threshold
+        uint32_t lod = 0;
+        while (lod + 1 < pMesh->getLodCount() && pMesh->getLod(lod + 1).error / radius * projectedRadius <= mLodErrorThreshold)
+        {
+            lod++;
+        }
+        return lod;
+    }
+
+    void SceneRenderer::collectMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID)
     {
         const Model* pModel = currentData.pModel;
         const Mesh* pMesh = pModel->getMesh(meshID).get();
 
-        if (setPerMeshData(currentData, pMesh))
+        const uint8_t* pMeshVisibility = currentData.pVisibility ? currentData.pVisibility + mpScene->getBVHItemID(currentData.modelID, currentData.modelInstanceID, meshID, 0) : nullptr;
+        const bool selectLods = mLodEnabled && (currentData.pCamera != nullptr) && (pMesh->getLodCount() > 1);
+        const bool requestTextures = mTextureStreamingEnabled && mpTextureStreamer && (currentData.pCamera != nullptr);
+        float textureScreenSize = 0;
+
+        // Sort the visible instances by level of detail, so that instances using the same level can be drawn together
+        const uint32_t instanceCount = pModel->getMeshInstanceCount(meshID);
+        for (uint32_t instanceID = 0; instanceID < instanceCount; instanceID++)
         {
-            Program* pProgram = currentData.pState->getProgram().get();
-            bool useVsSkinning = pMesh->hasBones() && !pModel->getSkinningCache();
-            if (useVsSkinning)
+            const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, instanceID).get();
+
+            if (pMeshInstance->isVisible())
             {
-                pProgram->addDefine("_VERTEX_BLENDING");
-            }
+                bool culled = false;
+                if (mCullEnabled)
+                {
+                    culled = pMeshVisibility ? (pMeshVisibility[instanceID] == 0) : cullMeshInstance(currentData, pModelInstance, pMeshInstance);
+                }
 
-            // Bind VAO and set topology            
-            currentData.pState->setVao(useVsSkinning ? pMesh->getVao() : pModel->getMeshVao(pMesh));
+                if (culled == false)
+                {
+                    uint32_t lod = selectLods ? selectLod(currentData, pModelInstance, pMeshInstance, pMesh) : 0;
+                    mLodInstances[lod].push_back(pMeshInstance);
+
+                    if (requestTextures)
+                    {
+                        textureScreenSize = std::max(textureScreenSize, getProjectedRadius(currentData, pModelInstance, pMeshInstance, pMesh));
+                    }
+                }
+            }
+        }
 
-            uint32_t activeInstances = 0;
+        // The instances share the material, so request the mips needed by the largest one. A texture is assumed to cover the mesh's bounding sphere once
+        if (textureScreenSize > 0)
+        {
+            textureScreenSize *= 2 * currentData.pState->getViewport(0).height * std::exp2(-mTextureMipBias);
+            mpTextureStreamer->requestMaterial(pMesh->getMaterial().get(), textureScreenSize);
+        }
 
-            const uint32_t instanceCount = pModel->getMeshInstanceCount(meshID);
-            for (uint32_t instanceID = 0; instanceID < instanceCount; instanceID++)
+        // Instances drawn at full resolution can cull their meshlets. The visible meshlets depend on the instance's transform, so the instances are grouped by
+        // their visible meshlets and each group is drawn together. Instances which are entirely visible, or seen from the same side, end up in the same group
+        if (mClusterCullEnabled && (currentData.pCamera != nullptr) && (pMesh->getMeshlets().empty() == false) && (pMesh->hasBones() == false))
+        {
+            const RasterizerState* pRsState = currentData.pState->getRasterizerState().get();
+            const bool cullBackfaces = mClusterBackfaceCullEnabled && (pMesh->getMaterial()->isDoubleSided() == false) && (pRsState == nullptr || pRsState->getCullMode() == RasterizerState::CullMode::Back);
+            const bool frontCcw = (pRsState == nullptr) || pRsState->isFrontCounterCW();
+            const auto rangesEqual = [](const MeshletCuller::IndexRange& a, const MeshletCuller::IndexRange& b) { return a.startIndex == b.startIndex && a.indexCount == b.indexCount; };
+
+            mClusterGroupCount = 0;
+            mClusterGroupRanges.clear();
+            mClusterGroupLookup.clear();
+            for (const Model::MeshInstance* pMeshInstance : mLodInstances[0])
             {
-                const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, instanceID).get();
+                const glm::mat4 world = pModelInstance->getTransformMatrix() * pMeshInstance->getTransformMatrix();
+                MeshletCuller::cull(pMesh->getMeshlets(), world, currentData.pCamera, cullBackfaces, frontCcw, mClusterRanges, mClusterCullStats);
+                if (mClusterRanges.empty()) continue;
+
+                const uint64_t hash = hashData(mClusterRanges.data(), mClusterRanges.size() * sizeof(MeshletCuller::IndexRange));
+                auto it = mClusterGroupLookup.find(hash);
+                uint32_t groupIndex = (it != mClusterGroupLookup.end()) ? it->second : mClusterGroupCount;
+                if (groupIndex < mClusterGroupCount)
+                {
+                    // Hash collisions start a new group
+                    const ClusterGroup& group = mClusterGroups[groupIndex];
+                    const bool equal = (group.rangeCount == mClusterRanges.size()) && std::equal(mClusterRanges.begin(), mClusterRanges.end(), mClusterGroupRanges.begin() + group.firstRange, rangesEqual);
+                    if (equal == false) groupIndex = mClusterGroupCount;
+                }
 
-                if (pMeshInstance->isVisible())
+                if (groupIndex == mClusterGroupCount)
                 {
-                    if ((mCullEnabled == false) || (cullMeshInstance(currentData, pModelInstance, pMeshInstance) == false))
-                    {
-                        if (setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, activeInstances))
-                        {
-                            currentData.drawID++;
-                            activeInstances++;
-
-                            if (activeInstances == mMaxInstanceCount)
-                            {
-                                // DISABLED_FOR_D3D12
-                                //pContext->setProgram(currentData.pProgram->getActiveProgramVersion());
-                                draw(currentData, pMesh, activeInstances);
-                                activeInstances = 0;
-                            }
-                        }
-                    }
+                    if (mClusterGroupCount == mClusterGroups.size()) mClusterGroups.emplace_back();
+                    ClusterGroup& group = mClusterGroups[mClusterGroupCount++];
+                    group.firstRange = (uint32_t)mClusterGroupRanges.size();
+                    group.rangeCount = (uint32_t)mClusterRanges.size();
+                    group.instances.clear();
+                    mClusterGroupRanges.insert(mClusterGroupRanges.end(), mClusterRanges.begin(), mClusterRanges.end());
+                    mClusterGroupLookup.emplace(hash, groupIndex);
                 }
+                mClusterGroups[groupIndex].instances.push_back(pMeshInstance);
             }
-            if(activeInstances != 0)
+
+            for (uint32_t g = 0; g < mClusterGroupCount; g++)
             {
-                draw(currentData, pMesh, activeInstances);
+                const ClusterGroup& group = mClusterGroups[g];
+                addInstancedDrawBatches(currentData, pModelInstance, meshID, group.instances, mClusterGroupRanges.data() + group.firstRange, group.rangeCount);
             }
+            mLodInstances[0].clear();
+        }
 
-            // Restore the program state
-            if (useVsSkinning)
+        for (uint32_t lod = 0; lod < pMesh->getLodCount(); lod++)
+        {
+            MeshletCuller::IndexRange range;
+            range.startIndex = pMesh->getLod(lod).startIndex;
+            range.indexCount = pMesh->getLod(lod).indexCount;
+            addInstancedDrawBatches(currentData, pModelInstance, meshID, mLodInstances[lod], &range, 1);
+            mLodInstances[lod].clear();
+        }
+    }
+
+    void SceneRenderer::addInstancedDrawBatches(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID, const std::vector<const Model::MeshInstance*>& instances, const MeshletCuller::IndexRange* pRanges, uint32_t rangeCount)
+    {
+        uint32_t firstInstance = mInstanceData.getInstanceCount();
+        uint32_t activeInstances = 0;
+        for (const Model::MeshInstance* pMeshInstance : instances)
+        {
+            if (setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, firstInstance + activeInstances))
             {
-                pProgram->removeDefine("_VERTEX_BLENDING");
+                currentData.drawID++;
+                activeInstances++;
+
+                if (activeInstances == mMaxInstanceCount)
+                {
+                    addDrawBatch(currentData, meshID, firstInstance, activeInstances, pRanges, rangeCount);
+                    firstInstance += activeInstances;
+                    activeInstances = 0;
+                }
             }
         }
+        if (activeInstances != 0)
+        {
+            addDrawBatch(currentData, meshID, firstInstance, activeInstances, pRanges, rangeCount);
+        }
+    }
+
+    void SceneRenderer::addDrawBatch(const CurrentWorkingData& currentData, uint32_t meshID, uint32_t firstInstance, uint32_t instanceCount, const MeshletCuller::IndexRange* pRanges, uint32_t rangeCount)
+    {
+        DrawBatch batch;
+        batch.modelID = currentData.modelID;
+        batch.modelInstanceID = currentData.modelInstanceID;
+        batch.meshID = meshID;
+        batch.firstInstance = firstInstance;
+        batch.instanceCount = instanceCount;
+        batch.firstRange = (uint32_t)mDrawRanges.size();
+        batch.rangeCount = rangeCount;
+        mDrawRanges.insert(mDrawRanges.end(), pRanges, pRanges + rangeCount);
+        mDrawBatches.push_back(batch);
+    }
+
+    static void setStructuredBufferData(GraphicsVars* pVars, const char* name, StructuredBuffer::SharedPtr& pBuffer, const void* pData, uint32_t elementCount)
+    {
+        // Programs which don't declare the buffer don't use its data
+        const ReflectionVar* pVar = pVars->getReflection()->getDefaultParameterBlock()->getResource(name).get();
+        if (pVar == nullptr) return;
+
+        // Grow the buffer geometrically, so that it's only reallocated a few times as the scene gets bigger
+        if (pBuffer == nullptr || pBuffer->getElementCount() < elementCount)
+        {
+            size_t newCount = pBuffer ? std::max(pBuffer->getElementCount() * 2, (size_t)elementCount) : std::max(elementCount, 1u);
+            ReflectionResourceType::SharedConstPtr pType = pVar->getType()->unwrapArray()->asResourceType()->inherit_shared_from_this::shared_from_this();
+            pBuffer = StructuredBuffer::create(name, pType, newCount, Resource::BindFlags::ShaderResource);
+        }
+
+        // A single upload for all the draws of the renderScene() call. The data goes through the CPU copy of the buffer, otherwise binding a new buffer would upload its
+        // zero-initialized copy over it. Only the used part is uploaded, which also clears the dirty flag so the bind doesn't upload the entire buffer again
+        if (elementCount > 0)
+        {
+            const size_t size = elementCount * pBuffer->getElementSize();
+            pBuffer->setBlob(pData, 0, size);
+            pBuffer->uploadToGPU(0, size);
+        }
+        pVars->setStructuredBuffer(name, pBuffer);
+    }
+
+    void SceneRenderer::uploadInstanceData(const CurrentWorkingData& currentData)
+    {
+        const uint32_t instanceCount = mInstanceData.getInstanceCount();
+        if (instanceCount == 0) return;
+
+        GraphicsVars* pVars = currentData.pVars;
+        setStructuredBufferData(pVars, kInstanceWorldMatsName, mInstanceBuffers.pWorldMats, mInstanceData.getWorldMats().data(), instanceCount);
+        setStructuredBufferData(pVars, kInstancePrevWorldMatsName, mInstanceBuffers.pPrevWorldMats, mInstanceData.getPrevWorldMats().data(), instanceCount);
+        setStructuredBufferData(pVars, kInstanceWorldInvTransposeMatsName, mInstanceBuffers.pWorldInvTransposeMats, mInstanceData.getWorldInvTransposeMats().data(), instanceCount);
+        setStructuredBufferData(pVars, kInstanceDrawIdsName, mInstanceBuffers.pDrawIds, mInstanceData.getDrawIds().data(), instanceCount);
+    }
+
+    void SceneRenderer::updateLightClusters(const CurrentWorkingData& currentData)
+    {
+        // Only programs which define _CLUSTERED_LIGHTING declare the cluster buffers
+        GraphicsVars* pVars = currentData.pVars;
+        if (pVars->getReflection()->getDefaultParameterBlock()->getResource(kLightClustersName) == nullptr) return;
+        if (currentData.pCamera == nullptr) return;
+
+        if (mpLightClusterBuilder == nullptr) mpLightClusterBuilder = LightClusterBuilder::create();
+
+        // Point lights with a range are binned into the clusters. The other lights affect every pixel
+        const uint32_t lightCount = mpScene->getLightCount();
+        mLightBounds.resize(lightCount);
+        mClusteredLightData.resize(lightCount);
+        for (uint32_t i = 0; i < lightCount; i++)
+        {
+            const LightData& data = mpScene->getLight(i)->getData();
+            mClusteredLightData[i] = data;
+            mLightBounds[i].center = data.posW;
+            mLightBounds[i].radius = (data.type == LightPoint) ? data.range : 0.0f;
+        }
+        mpLightClusterBuilder->build(currentData.pCamera, mLightBounds, TaskScheduler::getDefault().get());
+
+        const auto& clusters = mpLightClusterBuilder->getClusters();
+        const auto& indices = mpLightClusterBuilder->getLightIndices();
+        setStructuredBufferData(pVars, kClusteredLightsName, mLightClusterBuffers.pLights, mClusteredLightData.data(), lightCount);
+        setStructuredBufferData(pVars, kLightClustersName, mLightClusterBuffers.pClusters, clusters.data(), (uint32_t)clusters.size());
+        setStructuredBufferData(pVars, kLightClusterIndicesName, mLightClusterBuffers.pIndices, indices.data(), (uint32_t)indices.size());
+
+        ConstantBuffer* pCB = pVars->getConstantBuffer(kLightClusterCbName).get();
+        if (pCB)
+        {
+            pCB->setVariable("gLightClusterDims", mpLightClusterBuilder->getDims());
+            pCB->setVariable("gLightClusterGlobalCount", mpLightClusterBuilder->getGlobalLightCount());
+            pCB->setVariable("gLightClusterDepthScale", mpLightClusterBuilder->getDepthScale());
+            pCB->setVariable("gLightClusterDepthBias", mpLightClusterBuilder->getDepthBias());
+        }
     }
 
-    void SceneRenderer::renderModelInstance(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance)
+    void SceneRenderer::renderDrawBatches(CurrentWorkingData& currentData)
     {
-        mpLastMaterial = nullptr;
+        ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(kPerMeshCbName).get();
 
-        // Loop over the meshes
-        for (uint32_t meshID = 0; meshID < pModelInstance->getObject()->getMeshCount(); meshID++)
+        // The batches are ordered by model, model instance and mesh. Set the state of each level when it changes
+        const DrawBatch* pPrevBatch = nullptr;
+        const Scene::ModelInstance* pModelInstance = nullptr;
+        const Mesh* pMesh = nullptr;
+        bool modelSet = false;
+        bool modelInstanceSet = false;
+        bool meshSet = false;
+        Program* pSkinningProgram = nullptr;    // The program which _VERTEX_BLENDING was added to. The per-model callbacks may change the program
+
+        for (const DrawBatch& batch : mDrawBatches)
         {
-            renderMeshInstances(currentData, pModelInstance, meshID);
+            const bool newModel = (pPrevBatch == nullptr) || (batch.modelID != pPrevBatch->modelID);
+            const bool newModelInstance = newModel || (batch.modelInstanceID != pPrevBatch->modelInstanceID);
+            const bool newMesh = newModelInstance || (batch.meshID != pPrevBatch->meshID);
+            pPrevBatch = &batch;
+
+            // Restore the program state
+            if (newMesh && pSkinningProgram)
+            {
+                pSkinningProgram->removeDefine("_VERTEX_BLENDING");
+                pSkinningProgram = nullptr;
+            }
+
+            if (newModel)
+            {
+                currentData.pModel = mpScene->getModel(batch.modelID).get();
+                currentData.modelID = batch.modelID;
+                modelSet = setPerModelData(currentData);
+            }
+            if (modelSet == false) continue;
+
+            if (newModelInstance)
+            {
+                pModelInstance = mpScene->getModelInstance(batch.modelID, batch.modelInstanceID).get();
+                currentData.modelInstanceID = batch.modelInstanceID;
+                mpLastMaterial = nullptr;
+                modelInstanceSet = setPerModelInstanceData(currentData, pModelInstance, batch.modelInstanceID);
+            }
+            if (modelInstanceSet == false) continue;
+
+            if (newMesh)
+            {
+                const Model* pModel = currentData.pModel;
+                pMesh = pModel->getMesh(batch.meshID).get();
+                meshSet = setPerMeshData(currentData, pMesh);
+                if (meshSet)
+                {
+                    bool useVsSkinning = pMesh->hasBones() && !pModel->getSkinningCache();
+                    if (useVsSkinning)
+                    {
+                        pSkinningProgram = currentData.pState->getProgram().get();
+                        pSkinningProgram->addDefine("_VERTEX_BLENDING");
+                    }
+
+                    // Bind VAO and set topology
+                    currentData.pState->setVao(useVsSkinning ? pMesh->getVao() : pModel->getMeshVao(pMesh, pModelInstance->getAnimationState().get()));
+
+                    if (pCB)
+                    {
+                        pCB->setVariable(sMeshIdOffset, pMesh->getId());
+                    }
+                }
+            }
+            if (meshSet == false) continue;
+
+            if (pCB)
+            {
+                pCB->setVariable(sFirstInstanceOffset, batch.firstInstance);
+            }
+            draw(currentData, pMesh, batch.instanceCount, mDrawRanges.data() + batch.firstRange, batch.rangeCount);
+        }
+
+        if (pSkinningProgram)
+        {
+            pSkinningProgram->removeDefine("_VERTEX_BLENDING");
         }
     }
 
     bool SceneRenderer::update(double currentTime)
     {
+        // Uploads the mips requested by the previous frames
+        if (mTextureStreamingEnabled && mpTextureStreamer)
+        {
+            mpTextureStreamer->update();
+        }
         return mpScene->update(currentTime, mpCameraController.get());
     }
 
@@ -355,26 +675,41 @@ namespace Falcor
     void SceneRenderer::renderScene(CurrentWorkingData& currentData)
     {
         setPerFrameData(currentData);
+        mClusterCullStats = MeshletCuller::Stats();
 
+        // Cull all the mesh instances up front. The hierarchy allows us to reject or accept entire groups of instances with a single test
+        currentData.pVisibility = nullptr;
+        if (mCullEnabled && currentData.pCamera)
+        {
+            mpScene->getBVH()->cull(currentData.pCamera, mMeshInstanceVisibility);
+            currentData.pVisibility = mMeshInstanceVisibility.data();
+        }
+
+        // Collect the visible mesh instances and pack their data, so that it's uploaded once before issuing the draws
+        mInstanceData.clear();
+        mDrawBatches.clear();
+        mDrawRanges.clear();
         for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
         {
             currentData.pModel = mpScene->getModel(modelID).get();
+            currentData.modelID = modelID;
 
-            if (setPerModelData(currentData))
+            for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++)
             {
-                for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++)
+                const auto pInstance = mpScene->getModelInstance(modelID, instanceID).get();
+                currentData.modelInstanceID = instanceID;
+                if (isModelInstanceDrawn(currentData, pInstance))
                 {
-                    const auto pInstance = mpScene->getModelInstance(modelID, instanceID).get();
-                    if (pInstance->isVisible())
+                    for (uint32_t meshID = 0; meshID < currentData.pModel->getMeshCount(); meshID++)
                     {
-                        if (setPerModelInstanceData(currentData, pInstance, instanceID))
-                        {
-                            renderModelInstance(currentData, pInstance);
-                        }
+                        collectMeshInstances(currentData, pInstance, meshID);
                     }
                 }
             }
         }
+
+        uploadInstanceData(currentData);
+        renderDrawBatches(currentData);
     }
 
     void SceneRenderer::renderScene(RenderContext* pContext, const Camera* pCamera)
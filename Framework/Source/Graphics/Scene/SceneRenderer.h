@@ -26,13 +26,19 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include <limits>
+#include <unordered_map>
 #include <vector>
 #include "Utils/Gui.h"
 #include "Graphics/Camera/CameraController.h"
 #include "Graphics/Scene/Scene.h"
 #include "Utils/CpuTimer.h"
 #include "API/ConstantBuffer.h"
+#include "API/StructuredBuffer.h"
 #include "Utils/DebugDrawer.h"
+#include "Graphics/TextureStreamer.h"
+#include "Graphics/Scene/InstanceDataPacker.h"
+#include "Graphics/LightClusterBuilder.h"
 
 namespace Falcor
 {
@@ -65,7 +71,7 @@ namespace Falcor
         */
         virtual void renderScene(RenderContext* pContext, const Camera* pCamera);
 
-        /** Update the camera and model animation.
+        /** Update the camera and model animation, and the streamed textures.
             Should be called before renderScene(), unless not animations are used and you update the camera manually
         */
         bool update(double currentTime);
@@ -81,10 +87,80 @@ namespace Falcor
         */
         bool isMeshCullingEnabled() const { return mCullEnabled; }
 
+        /** Enable/disable level of detail selection. When enabled, meshes which have levels of detail are drawn with the coarsest level whose simplification error projects to less than the error threshold.
+        */
+        void toggleLodSelection(bool enable) { mLodEnabled = enable; }
+
+        /** Check if level of detail selection is enabled
+        */
+        bool isLodSelectionEnabled() const { return mLodEnabled; }
+
+        /** Set the largest allowed projected simplification error, as a fraction of the viewport height. The default is about one pixel at 1080p.
+        */
+        void setLodErrorThreshold(float threshold) { mLodErrorThreshold = threshold; }
+
+        /** Get the largest allowed projected simplification error
+        */
+        float getLodErrorThreshold() const { return mLodErrorThreshold; }
+
+        /** Enable/disable meshlet culling. When enabled, meshes which have meshlets are drawn one instance at a time, and only the meshlets inside the frustum are drawn.
+            Only applies to instances drawn at full resolution.
+        */
+        void toggleClusterCulling(bool enable) { mClusterCullEnabled = enable; }
+
+        /** Check if meshlet culling is enabled
+        */
+        bool isClusterCullingEnabled() const { return mClusterCullEnabled; }
+
+        /** Enable/disable culling meshlets which face away from the camera. Has no effect on double-sided materials or when the rasterizer state doesn't cull back faces.
+        */
+        void toggleClusterBackfaceCulling(bool enable) { mClusterBackfaceCullEnabled = enable; }
+
+        /** Check if meshlet back-face culling is enabled
+        */
+        bool isClusterBackfaceCullingEnabled() const { return mClusterBackfaceCullEnabled; }
+
+        /** Get the meshlet culling statistics of the last renderScene() call
+        */
+        const MeshletCuller::Stats& getClusterCullStats() const { return mClusterCullStats; }
+
+        /** Enable/disable texture streaming. When enabled, renderScene() requests the texture mips of the drawn mesh instances based on their projected size, and update() updates the texture streamer.
+        */
+        void toggleTextureStreaming(bool enable) { mTextureStreamingEnabled = enable; }
+
+        /** Check if texture streaming is enabled
+        */
+        bool isTextureStreamingEnabled() const { return mTextureStreamingEnabled; }
+
+        /** Set the streamer which the mips are requested from. By default, uses TextureStreamer::getDefault(), which streams the textures of models loaded with Model::LoadFlags::StreamTextures
+        */
+        void setTextureStreamer(const TextureStreamer::SharedPtr& pStreamer) { mpTextureStreamer = pStreamer; }
+
+        /** Get the texture streamer
+        */
+        const TextureStreamer::SharedPtr& getTextureStreamer() const { return mpTextureStreamer; }
+
+        /** Set a bias added to the requested mip levels. Mips are requested assuming that a texture covers its mesh once, so meshes with repeating textures need a negative bias
+        */
+        void setTextureStreamingMipBias(float bias) { mTextureMipBias = bias; }
+
+        /** Get the bias added to the requested mip levels
+        */
+        float getTextureStreamingMipBias() const { return mTextureMipBias; }
+
         /** Set the maximal number of mesh instance to dispatch in a single draw call.
+            By default there is no limit, and all the visible instances of a mesh which use the same level of detail are drawn with a single draw call.
         */
         void setMaxInstanceCount(uint32_t instanceCount) { mMaxInstanceCount = instanceCount; }
 
+        /** Set the grid which the lights are binned into when rendering with a program which defines _CLUSTERED_LIGHTING. See Lights.slang
+        */
+        void setLightClusterDesc(const LightClusterBuilder::Desc& desc) { mpLightClusterBuilder = LightClusterBuilder::create(desc); }
+
+        /** Get the light cluster builder, which holds the statistics of the last build
+        */
+        const LightClusterBuilder::SharedPtr& getLightClusterBuilder() const { return mpLightClusterBuilder; }
+
         enum class CameraControllerType
         {
             FirstPerson,
@@ -112,6 +188,10 @@ namespace Falcor
             const Material* pMaterial = nullptr;
 
             uint32_t drawID; // Zero-based mesh instance draw order/ID. Resets at the beginning of renderScene, and increments per mesh instance drawn.
+
+            uint32_t modelID = 0;
+            uint32_t modelInstanceID = 0;
+            const uint8_t* pVisibility = nullptr; // Per mesh instance visibility from the scene's BVH, indexed using Scene::getBVHItemID(). nullptr if culling is disabled.
         };
 
         SceneRenderer(const Scene::SharedPtr& pScene);
@@ -129,12 +209,11 @@ namespace Falcor
         static size_t sCameraDataOffset;
         static size_t sLightCountOffset;
         static size_t sLightArrayOffset;
-        static size_t sWorldMatArraySize;
         static size_t sWorldMatOffset;
         static size_t sPrevWorldMatOffset;
         static size_t sWorldInvTransposeMatOffset;
         static size_t sMeshIdOffset;
-        static size_t sDrawIDOffset;
+        static size_t sFirstInstanceOffset;
 
         static void updateVariableOffsets(const ProgramReflection* pReflector);
 
@@ -142,24 +221,104 @@ namespace Falcor
         virtual bool setPerModelData(const CurrentWorkingData& currentData);
         virtual bool setPerModelInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t instanceID);
         virtual bool setPerMeshData(const CurrentWorkingData& currentData, const Mesh* pMesh);
+        /** Called for every visible mesh instance before any draw is issued. The default implementation appends the instance's data to mInstanceData.
+            \param[in] drawInstanceID Index of the instance in the instance buffers
+        */
         virtual bool setPerMeshInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t drawInstanceID);
         virtual bool setPerMaterialData(const CurrentWorkingData& currentData, const Material* pMaterial);
-        virtual void executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount);
+        virtual void executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex);
         virtual void postFlushDraw(const CurrentWorkingData& currentData);
         virtual bool cullMeshInstance(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance);
+        /** Called for every model instance before its mesh instances are collected. The default implementation draws the visible instances
+        */
+        virtual bool isModelInstanceDrawn(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance);
+        virtual uint32_t selectLod(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, const Mesh* pMesh);
 
-        void renderModelInstance(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance);
-        void renderMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID);
-        void draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount);
+        // Radius of the mesh instance's bounding sphere projected on the screen, as a fraction of the viewport height. Infinite when the camera is inside the sphere
+        float getProjectedRadius(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, const Mesh* pMesh) const;
+
+        // Get the world transforms of a mesh instance, in the current and the previous frame
+        static void getMeshInstanceTransforms(const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, glm::mat4& worldMat, glm::mat4& prevWorldMat);
+
+        void setBoneMatrices(const CurrentWorkingData& currentData, const mat4* pBones, const mat4* pBonesInvTranspose);
+        void collectMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID);
+        void addDrawBatch(const CurrentWorkingData& currentData, uint32_t meshID, uint32_t firstInstance, uint32_t instanceCount, const MeshletCuller::IndexRange* pRanges, uint32_t rangeCount);
+        void addInstancedDrawBatches(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID, const std::vector<const Model::MeshInstance*>& instances, const MeshletCuller::IndexRange* pRanges, uint32_t rangeCount);
+        void uploadInstanceData(const CurrentWorkingData& currentData);
+        void updateLightClusters(const CurrentWorkingData& currentData);
+        void renderDrawBatches(CurrentWorkingData& currentData);
+        void draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount, const MeshletCuller::IndexRange* pRanges, uint32_t rangeCount);
 
         void renderScene(CurrentWorkingData& currentData);
 
         CameraControllerType mCamControllerType = CameraControllerType::SixDof;
         CameraController::SharedPtr mpCameraController;
 
-        uint32_t mMaxInstanceCount = 64;
+        uint32_t mMaxInstanceCount = std::numeric_limits<uint32_t>::max();
         const Material* mpLastMaterial = nullptr;
         bool mCullEnabled = true;
+        std::vector<uint8_t> mMeshInstanceVisibility;
         bool mCompileMaterialWithProgram = true;
+        bool mInstanceBonesBound = false;   // True when the bone matrices in the vars belong to an instance's animation state rather than to the model
+        bool mLodEnabled = true;
+        float mLodErrorThreshold = 1.0f / 1080.0f;
+        std::vector<const Model::MeshInstance*> mLodInstances[Mesh::kMaxLodCount];  // The visible instances of the mesh being drawn, per level of detail
+        bool mClusterCullEnabled = true;
+        bool mClusterBackfaceCullEnabled = true;
+        MeshletCuller::Stats mClusterCullStats;
+        std::vector<MeshletCuller::IndexRange> mClusterRanges;
+
+        /** Instances of the mesh being drawn which have the same visible meshlets. They are drawn together
+        */
+        struct ClusterGroup
+        {
+            uint32_t firstRange;        // Index of the first index range in mClusterGroupRanges
+            uint32_t rangeCount;
+            std::vector<const Model::MeshInstance*> instances;
+        };
+        std::vector<ClusterGroup> mClusterGroups;   // Only the first mClusterGroupCount are used. The rest are kept to reuse their allocations
+        uint32_t mClusterGroupCount = 0;
+        std::vector<MeshletCuller::IndexRange> mClusterGroupRanges;
+        std::unordered_map<uint64_t, uint32_t> mClusterGroupLookup;     // Hash of the visible ranges to the group index
+        bool mTextureStreamingEnabled = true;
+        TextureStreamer::SharedPtr mpTextureStreamer;
+        float mTextureMipBias = 0;
+
+        /** A draw of consecutive instances in the instance buffers, collected by renderScene() before issuing the draws
+        */
+        struct DrawBatch
+        {
+            uint32_t modelID;
+            uint32_t modelInstanceID;
+            uint32_t meshID;
+            uint32_t firstInstance;     // Index of the first instance in the instance buffers
+            uint32_t instanceCount;
+            uint32_t firstRange;        // Index of the first index range in mDrawRanges
+            uint32_t rangeCount;
+        };
+
+        InstanceDataPacker mInstanceData;
+        std::vector<DrawBatch> mDrawBatches;
+        std::vector<MeshletCuller::IndexRange> mDrawRanges;
+
+        struct
+        {
+            StructuredBuffer::SharedPtr pWorldMats;
+            StructuredBuffer::SharedPtr pPrevWorldMats;
+            StructuredBuffer::SharedPtr pWorldInvTransposeMats;
+            StructuredBuffer::SharedPtr pDrawIds;
+        } mInstanceBuffers;
+
+        LightClusterBuilder::SharedPtr mpLightClusterBuilder;
+        std::vector<LightClusterBuilder::LightBounds> mLightBounds;
+        std::vector<LightData> mClusteredLightData;
+        bool mLightLimitWarned = false;     // True after warning that a non-clustered program only gets the first MAX_LIGHT_SOURCES lights
+
+        struct
+        {
+            StructuredBuffer::SharedPtr pLights;
+            StructuredBuffer::SharedPtr pClusters;
+            StructuredBuffer::SharedPtr pIndices;
+        } mLightClusterBuffers;
     };
 }
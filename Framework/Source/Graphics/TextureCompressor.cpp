@@ -0,0 +1,1268 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TextureCompressor.h"
+#include "Utils/TaskScheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Interpolation weights of 4-bit indices, shared by BC6H and BC7
+        const uint32_t kWeights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        // Encoding many small blocks in a task isn't worth the overhead, so small mips are encoded on the calling thread
+        const uint32_t kMinParallelBlocks = 256;
+
+        /** An image with 4 channels per texel. 8-bit images use uint8_t, HDR images use float
+        */
+        template<typename T>
+        struct Level
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<T> texels;
+        };
+
+        struct SrgbTables
+        {
+            float toLinear[256];
+            uint8_t fromLinear[4096];
+
+            SrgbTables()
+            {
+                for (uint32_t i = 0; i < 256; i++)
+                {
+                    float c = i / 255.0f;
+                    toLinear[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+                for (uint32_t i = 0; i < 4096; i++)
+                {
+                    float l = i / 4095.0f;
+                    float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                    fromLinear[i] = (uint8_t)(c * 255.0f + 0.5f);
+                }
+            }
+        };
+
+        const SrgbTables& getSrgbTables()
+        {
+            static const SrgbTables tables;
+            return tables;
+        }
+
+        /** Convert a float to half-precision bits. Negative values are clamped to 0 and large values to the largest finite half, which is what unsigned BC6H can store
+        */
+        uint16_t floatToUnsignedHalf(float f)
+        {
+            if (!(f > 0)) return 0;     // Also handles NaNs
+            if (f >= 65504.0f) return 0x7bff;
+            if (f < 6.103515625e-05f)
+            {
+                // Denormal
+                return (uint16_t)std::lround(f * 16777216.0f);
+            }
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            bits += 0xfff + ((bits >> 13) & 1);   // Round to nearest even
+            return (uint16_t)std::min(0x7bffu, (bits >> 13) - (112u << 10));
+        }
+
+        float halfToFloat(uint16_t h)
+        {
+            const float sign = (h & 0x8000) ? -1.0f : 1.0f;
+            const int exponent = (h >> 10) & 0x1f;
+            const int mantissa = h & 0x3ff;
+            if (exponent == 0) return sign * std::ldexp((float)mantissa, -24);
+            if (exponent == 31) return mantissa ? std::numeric_limits<float>::quiet_NaN() : sign * std::numeric_limits<float>::infinity();
+            return sign * std::ldexp((float)(mantissa | 0x400), exponent - 25);
+        }
+
+        bool isHdrFormat(ResourceFormat format)
+        {
+            return getFormatType(format) == FormatType::Float;
+        }
+
+        /** Writes the bits of a 128-bit block, starting from the least significant bit
+        */
+        class BitWriter
+        {
+        public:
+            BitWriter(uint8_t* pDst) : mpDst(pDst) { std::memset(pDst, 0, 16); }
+
+            void write(uint32_t value, uint32_t bitCount)
+            {
+                for (uint32_t i = 0; i < bitCount; i++, mPos++)
+                {
+                    mpDst[mPos >> 3] |= (uint8_t)(((value >> i) & 1) << (mPos & 7));
+                }
+            }
+
+        private:
+            uint8_t* mpDst;
+            uint32_t mPos = 0;
+        };
+
+        class BitReader
+        {
+        public:
+            BitReader(const uint8_t* pSrc) : mpSrc(pSrc) {}
+
+            uint32_t read(uint32_t bitCount)
+            {
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < bitCount; i++, mPos++)
+                {
+                    value |= (uint32_t)((mpSrc[mPos >> 3] >> (mPos & 7)) & 1) << i;
+                }
+                return value;
+            }
+
+        private:
+            const uint8_t* mpSrc;
+            uint32_t mPos = 0;
+        };
+
+        /** Find the line which best fits a set of points, as the mean and the principal axis. Only the first channelCount channels of the points are used
+        */
+        void fitLine(const float points[16][4], uint32_t channelCount, float mean[4], float axis[4])
+        {
+            float minValue[4] = { 0, 0, 0, 0 };
+            float maxValue[4] = { 0, 0, 0, 0 };
+            for (uint32_t c = 0; c < channelCount; c++)
+            {
+                mean[c] = 0;
+                minValue[c] = maxValue[c] = points[0][c];
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    mean[c] += points[i][c];
+                    minValue[c] = std::min(minValue[c], points[i][c]);
+                    maxValue[c] = std::max(maxValue[c], points[i][c]);
+                }
+                mean[c] /= 16;
+            }
+
+            float covariance[4][4] = {};
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                for (uint32_t a = 0; a < channelCount; a++)
+                {
+                    for (uint32_t b = a; b < channelCount; b++)
+                    {
+                        covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+                    }
+                }
+            }
+            for (uint32_t a = 0; a < channelCount; a++)
+            {
+                for (uint32_t b = 0; b < a; b++) covariance[a][b] = covariance[b][a];
+            }
+
+            // Power iteration, starting from the diagonal of the bounding box
+            for (uint32_t c = 0; c < channelCount; c++) axis[c] = maxValue[c] - minValue[c];
+            for (uint32_t iteration = 0; iteration < 8; iteration++)
+            {
+                float next[4] = { 0, 0, 0, 0 };
+                float length = 0;
+                for (uint32_t a = 0; a < channelCount; a++)
+                {
+                    for (uint32_t b = 0; b < channelCount; b++) next[a] += covariance[a][b] * axis[b];
+                    length = std::max(length, std::abs(next[a]));
+                }
+                if (length == 0) break;
+                for (uint32_t c = 0; c < channelCount; c++) axis[c] = next[c] / length;
+            }
+        }
+
+        /** Initial endpoints, the extremes of the points projected on the line which fits them best
+        */
+        void findEndpoints(const float points[16][4], uint32_t channelCount, float e0[4], float e1[4])
+        {
+            float mean[4];
+            float axis[4];
+            fitLine(points, channelCount, mean, axis);
+
+            float tMin = 0;
+            float tMax = 0;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                float t = 0;
+                for (uint32_t c = 0; c < channelCount; c++) t += (points[i][c] - mean[c]) * axis[c];
+                tMin = std::min(tMin, t);
+                tMax = std::max(tMax, t);
+            }
+
+            float axisLengthSq = 0;
+            for (uint32_t c = 0; c < channelCount; c++) axisLengthSq += axis[c] * axis[c];
+            if (axisLengthSq > 0)
+            {
+                tMin /= axisLengthSq;
+                tMax /= axisLengthSq;
+            }
+
+            for (uint32_t c = 0; c < channelCount; c++)
+            {
+                e0[c] = mean[c] + axis[c] * tMin;
+                e1[c] = mean[c] + axis[c] * tMax;
+            }
+        }
+
+        /** Solve for the endpoints which minimize the squared error, given the weight of the second endpoint for each point
+            \return false if the system is degenerate, e.g. if all the points use the same index
+        */
+        bool refineEndpoints(const float points[16][4], uint32_t channelCount, const float weights[16], float e0[4], float e1[4])
+        {
+            float a = 0, b = 0, c = 0;
+            float d0[4] = { 0, 0, 0, 0 };
+            float d1[4] = { 0, 0, 0, 0 };
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const float w1 = weights[i];
+                const float w0 = 1 - w1;
+                a += w0 * w0;
+                b += w0 * w1;
+                c += w1 * w1;
+                for (uint32_t ch = 0; ch < channelCount; ch++)
+                {
+                    d0[ch] += w0 * points[i][ch];
+                    d1[ch] += w1 * points[i][ch];
+                }
+            }
+
+            const float det = a * c - b * b;
+            if (std::abs(det) < 1e-6f) return false;
+            for (uint32_t ch = 0; ch < channelCount; ch++)
+            {
+                e0[ch] = (c * d0[ch] - b * d1[ch]) / det;
+                e1[ch] = (a * d1[ch] - b * d0[ch]) / det;
+            }
+            return true;
+        }
+
+        float clampf(float v, float lo, float hi)
+        {
+            return std::min(hi, std::max(lo, v));
+        }
+
+        /************************************************************************/
+        /* BC1                                                                  */
+        /************************************************************************/
+        uint16_t quantize565(const float color[4])
+        {
+            uint32_t r = (uint32_t)(clampf(color[0], 0, 255) * 31 / 255 + 0.5f);
+            uint32_t g = (uint32_t)(clampf(color[1], 0, 255) * 63 / 255 + 0.5f);
+            uint32_t b = (uint32_t)(clampf(color[2], 0, 255) * 31 / 255 + 0.5f);
+            return (uint16_t)((r << 11) | (g << 5) | b);
+        }
+
+        void expand565(uint16_t c, uint32_t rgb[3])
+        {
+            uint32_t r = (c >> 11) & 0x1f;
+            uint32_t g = (c >> 5) & 0x3f;
+            uint32_t b = c & 0x1f;
+            rgb[0] = (r << 3) | (r >> 2);
+            rgb[1] = (g << 2) | (g >> 4);
+            rgb[2] = (b << 3) | (b >> 2);
+        }
+
+        /** Palette of a BC1 block. Colors 2 and 3 are interpolated if fourColors is true, otherwise color 2 is the average and color 3 is transparent black
+        */
+        void getBc1Palette(uint16_t c0, uint16_t c1, bool fourColors, uint32_t palette[4][4])
+        {
+            expand565(c0, palette[0]);
+            expand565(c1, palette[1]);
+            palette[0][3] = palette[1][3] = 255;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                if (fourColors)
+                {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+                }
+                else
+                {
+                    palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+            palette[2][3] = 255;
+            palette[3][3] = fourColors ? 255 : 0;
+        }
+
+        /** Encode the color of a block. Always uses the 4-color mode, as required for the color part of BC3 blocks
+        */
+        void encodeBc1(const uint8_t texels[16][4], uint8_t* pDst)
+        {
+            float points[16][4];
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                for (uint32_t c = 0; c < 3; c++) points[i][c] = texels[i][c];
+            }
+
+            float e0[4], e1[4];
+            findEndpoints(points, 3, e0, e1);
+
+            static const float kIndexWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+            uint32_t bestError = UINT32_MAX;
+            uint16_t bestC0 = 0, bestC1 = 0;
+            uint8_t bestIndices[16] = {};
+            for (uint32_t iteration = 0; iteration < 2; iteration++)
+            {
+                const uint16_t c0 = quantize565(e0);
+                const uint16_t c1 = quantize565(e1);
+                uint32_t palette[4][4];
+                getBc1Palette(c0, c1, true, palette);
+
+                uint32_t error = 0;
+                uint8_t indices[16];
+                float weights[16];
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    uint32_t best = UINT32_MAX;
+                    for (uint32_t p = 0; p < 4; p++)
+                    {
+                        uint32_t e = 0;
+                        for (uint32_t c = 0; c < 3; c++)
+                        {
+                            int32_t d = (int32_t)texels[i][c] - (int32_t)palette[p][c];
+                            e += d * d;
+                        }
+                        if (e < best)
+                        {
+                            best = e;
+                            indices[i] = (uint8_t)p;
+                        }
+                    }
+                    error += best;
+                    weights[i] = kIndexWeights[indices[i]];
+                }
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestC0 = c0;
+                    bestC1 = c1;
+                    std::memcpy(bestIndices, indices, sizeof(indices));
+                }
+                if (error == 0 || refineEndpoints(points, 3, weights, e0, e1) == false) break;
+            }
+
+            // The 4-color mode requires c0 > c1
+            if (bestC0 < bestC1)
+            {
+                std::swap(bestC0, bestC1);
+                for (uint8_t& index : bestIndices) index ^= 1;
+            }
+            else if (bestC0 == bestC1)
+            {
+                std::memset(bestIndices, 0, sizeof(bestIndices));
+            }
+
+            uint32_t indexBits = 0;
+            for (uint32_t i = 0; i < 16; i++) indexBits |= (uint32_t)bestIndices[i] << (2 * i);
+            std::memcpy(pDst + 0, &bestC0, 2);
+            std::memcpy(pDst + 2, &bestC1, 2);
+            std::memcpy(pDst + 4, &indexBits, 4);
+        }
+
+        void decodeBc1(const uint8_t* pSrc, bool forceFourColors, float texels[16][4])
+        {
+            uint16_t c0, c1;
+            uint32_t indexBits;
+            std::memcpy(&c0, pSrc + 0, 2);
+            std::memcpy(&c1, pSrc + 2, 2);
+            std::memcpy(&indexBits, pSrc + 4, 4);
+
+            uint32_t palette[4][4];
+            getBc1Palette(c0, c1, forceFourColors || c0 > c1, palette);
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const uint32_t index = (indexBits >> (2 * i)) & 3;
+                for (uint32_t c = 0; c < 4; c++) texels[i][c] = (float)palette[index][c];
+            }
+        }
+
+        /************************************************************************/
+        /* BC4                                                                  */
+        /************************************************************************/
+        void getBc4Palette(uint32_t a0, uint32_t a1, uint32_t palette[8])
+        {
+            palette[0] = a0;
+            palette[1] = a1;
+            if (a0 > a1)
+            {
+                for (uint32_t i = 2; i < 8; i++) palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+            }
+            else
+            {
+                for (uint32_t i = 2; i < 6; i++) palette[i] = ((6 - i) * a0 + (i - 1) * a1 + 2) / 5;
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        /** Encode one channel of a block
+        */
+        void encodeBc4(const uint8_t texels[16][4], uint32_t channel, uint8_t* pDst)
+        {
+            uint32_t minValue = 255;
+            uint32_t maxValue = 0;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                minValue = std::min(minValue, (uint32_t)texels[i][channel]);
+                maxValue = std::max(maxValue, (uint32_t)texels[i][channel]);
+            }
+
+            uint32_t bestA0 = maxValue;
+            uint32_t bestA1 = minValue;
+            uint8_t bestIndices[16] = {};
+            if (minValue != maxValue)
+            {
+                float points[16][4];
+                for (uint32_t i = 0; i < 16; i++) points[i][0] = texels[i][channel];
+
+                uint32_t bestError = UINT32_MAX;
+                uint32_t a0 = maxValue;
+                uint32_t a1 = minValue;
+                for (uint32_t iteration = 0; iteration < 2; iteration++)
+                {
+                    uint32_t palette[8];
+                    getBc4Palette(a0, a1, palette);
+
+                    uint32_t error = 0;
+                    uint8_t indices[16];
+                    float weights[16];
+                    for (uint32_t i = 0; i < 16; i++)
+                    {
+                        uint32_t best = UINT32_MAX;
+                        for (uint32_t p = 0; p < 8; p++)
+                        {
+                            int32_t d = (int32_t)texels[i][channel] - (int32_t)palette[p];
+                            if ((uint32_t)(d * d) < best)
+                            {
+                                best = d * d;
+                                indices[i] = (uint8_t)p;
+                            }
+                        }
+                        error += best;
+                        weights[i] = (indices[i] == 0) ? 0.0f : (indices[i] == 1) ? 1.0f : (indices[i] - 1) / 7.0f;
+                    }
+
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        bestA0 = a0;
+                        bestA1 = a1;
+                        std::memcpy(bestIndices, indices, sizeof(indices));
+                    }
+
+                    float e0[4], e1[4];
+                    if (error == 0 || refineEndpoints(points, 1, weights, e0, e1) == false) break;
+                    a0 = (uint32_t)(clampf(e0[0], 0, 255) + 0.5f);
+                    a1 = (uint32_t)(clampf(e1[0], 0, 255) + 0.5f);
+                    if (a0 <= a1) break;    // Keep the 8-value mode
+                }
+            }
+
+            pDst[0] = (uint8_t)bestA0;
+            pDst[1] = (uint8_t)bestA1;
+            uint64_t indexBits = 0;
+            for (uint32_t i = 0; i < 16; i++) indexBits |= (uint64_t)bestIndices[i] << (3 * i);
+            for (uint32_t i = 0; i < 6; i++) pDst[2 + i] = (uint8_t)(indexBits >> (8 * i));
+        }
+
+        void decodeBc4(const uint8_t* pSrc, uint32_t channel, float texels[16][4])
+        {
+            uint32_t palette[8];
+            getBc4Palette(pSrc[0], pSrc[1], palette);
+            uint64_t indexBits = 0;
+            for (uint32_t i = 0; i < 6; i++) indexBits |= (uint64_t)pSrc[2 + i] << (8 * i);
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                texels[i][channel] = (float)palette[(indexBits >> (3 * i)) & 7];
+            }
+        }
+
+        /************************************************************************/
+        /* BC7                                                                  */
+        /************************************************************************/
+
+        /** Quantize an RGBA endpoint to 7 bits per channel and a p-bit, which is the least significant bit of all the channels
+        */
+        void quantizeBc7Endpoint(const float e[4], uint32_t q[4], uint32_t& pBit)
+        {
+            float bestError = std::numeric_limits<float>::max();
+            for (uint32_t p = 0; p < 2; p++)
+            {
+                uint32_t candidate[4];
+                float error = 0;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    const float v = clampf(e[c], 0, 255);
+                    candidate[c] = std::min(127u, (uint32_t)std::max(0.0f, (v - p) / 2 + 0.5f));
+                    const float d = v - (float)(candidate[c] * 2 + p);
+                    error += d * d;
+                }
+                if (error < bestError)
+                {
+                    bestError = error;
+                    pBit = p;
+                    std::memcpy(q, candidate, sizeof(candidate));
+                }
+            }
+        }
+
+        void getBc7Palette(const uint32_t q0[4], uint32_t p0, const uint32_t q1[4], uint32_t p1, uint32_t palette[16][4])
+        {
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                const uint32_t a = q0[c] * 2 + p0;
+                const uint32_t b = q1[c] * 2 + p1;
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    palette[i][c] = ((64 - kWeights4[i]) * a + kWeights4[i] * b + 32) >> 6;
+                }
+            }
+        }
+
+        /** Encode a block with mode 6: one subset, 7-bit RGBA endpoints with a p-bit each and 4-bit indices
+        */
+        void encodeBc7(const uint8_t texels[16][4], uint8_t* pDst)
+        {
+            float points[16][4];
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                for (uint32_t c = 0; c < 4; c++) points[i][c] = texels[i][c];
+            }
+
+            float e0[4], e1[4];
+            findEndpoints(points, 4, e0, e1);
+
+            uint32_t bestError = UINT32_MAX;
+            uint32_t bestQ0[4] = {}, bestQ1[4] = {};
+            uint32_t bestP0 = 0, bestP1 = 0;
+            uint8_t bestIndices[16] = {};
+            for (uint32_t iteration = 0; iteration < 3; iteration++)
+            {
+                uint32_t q0[4], q1[4], p0, p1;
+                quantizeBc7Endpoint(e0, q0, p0);
+                quantizeBc7Endpoint(e1, q1, p1);
+                uint32_t palette[16][4];
+                getBc7Palette(q0, p0, q1, p1, palette);
+
+                uint32_t error = 0;
+                uint8_t indices[16];
+                float weights[16];
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    uint32_t best = UINT32_MAX;
+                    for (uint32_t p = 0; p < 16; p++)
+                    {
+                        uint32_t e = 0;
+                        for (uint32_t c = 0; c < 4; c++)
+                        {
+                            int32_t d = (int32_t)texels[i][c] - (int32_t)palette[p][c];
+                            e += d * d;
+                        }
+                        if (e < best)
+                        {
+                            best = e;
+                            indices[i] = (uint8_t)p;
+                        }
+                    }
+                    error += best;
+                    weights[i] = kWeights4[indices[i]] / 64.0f;
+                }
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    std::memcpy(bestQ0, q0, sizeof(q0));
+                    std::memcpy(bestQ1, q1, sizeof(q1));
+                    bestP0 = p0;
+                    bestP1 = p1;
+                    std::memcpy(bestIndices, indices, sizeof(indices));
+                }
+                if (error == 0 || refineEndpoints(points, 4, weights, e0, e1) == false) break;
+            }
+
+            // The most significant bit of the first index is implicitly 0
+            if (bestIndices[0] & 8)
+            {
+                std::swap(bestQ0, bestQ1);
+                std::swap(bestP0, bestP1);
+                for (uint8_t& index : bestIndices) index = 15 - index;
+            }
+
+            BitWriter writer(pDst);
+            writer.write(1 << 6, 7);
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                writer.write(bestQ0[c], 7);
+                writer.write(bestQ1[c], 7);
+            }
+            writer.write(bestP0, 1);
+            writer.write(bestP1, 1);
+            writer.write(bestIndices[0], 3);
+            for (uint32_t i = 1; i < 16; i++) writer.write(bestIndices[i], 4);
+        }
+
+        bool decodeBc7(const uint8_t* pSrc, float texels[16][4])
+        {
+            BitReader reader(pSrc);
+            if (reader.read(7) != (1 << 6)) return false;
+
+            uint32_t q0[4], q1[4];
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                q0[c] = reader.read(7);
+                q1[c] = reader.read(7);
+            }
+            const uint32_t p0 = reader.read(1);
+            const uint32_t p1 = reader.read(1);
+
+            uint32_t palette[16][4];
+            getBc7Palette(q0, p0, q1, p1, palette);
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const uint32_t index = reader.read(i == 0 ? 3 : 4);
+                for (uint32_t c = 0; c < 4; c++) texels[i][c] = (float)palette[index][c];
+            }
+            return true;
+        }
+
+        /************************************************************************/
+        /* BC6H                                                                 */
+        /************************************************************************/
+
+        // Mode 11 is identified by the 5 mode bits 00011
+        const uint32_t kBc6hMode11 = 0x03;
+
+        uint32_t unquantizeBc6h(uint32_t e)
+        {
+            if (e == 0) return 0;
+            if (e == 1023) return 0xffff;
+            return ((e << 16) + 0x8000) >> 10;
+        }
+
+        /** Interpolated half values of a block, per channel
+        */
+        void getBc6hPalette(const uint32_t e0[3], const uint32_t e1[3], uint32_t palette[16][3])
+        {
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                const uint32_t a = unquantizeBc6h(e0[c]);
+                const uint32_t b = unquantizeBc6h(e1[c]);
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    const uint32_t x = ((64 - kWeights4[i]) * a + kWeights4[i] * b + 32) >> 6;
+                    palette[i][c] = (x * 31) >> 6;
+                }
+            }
+        }
+
+        /** Encode a block with mode 11: one region, 10-bit RGB endpoints without delta compression and 4-bit indices.
+            The endpoints are fit in the domain of the interpolated values, which is linear in the half-precision bits, so the error is roughly relative to the magnitude of the texels
+        */
+        void encodeBc6h(const float texels[16][4], uint8_t* pDst)
+        {
+            uint32_t halfs[16][3];
+            float points[16][4];
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    halfs[i][c] = floatToUnsignedHalf(texels[i][c]);
+                    points[i][c] = halfs[i][c] * 64.0f / 31.0f;
+                }
+            }
+
+            float f0[4], f1[4];
+            findEndpoints(points, 3, f0, f1);
+
+            uint64_t bestError = UINT64_MAX;
+            uint32_t best0[3] = {}, best1[3] = {};
+            uint8_t bestIndices[16] = {};
+            for (uint32_t iteration = 0; iteration < 3; iteration++)
+            {
+                uint32_t e0[3], e1[3];
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    e0[c] = (uint32_t)clampf((f0[c] - 32) / 64 + 0.5f, 0, 1023);
+                    e1[c] = (uint32_t)clampf((f1[c] - 32) / 64 + 0.5f, 0, 1023);
+                }
+                uint32_t palette[16][3];
+                getBc6hPalette(e0, e1, palette);
+
+                uint64_t error = 0;
+                uint8_t indices[16];
+                float weights[16];
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    uint64_t best = UINT64_MAX;
+                    for (uint32_t p = 0; p < 16; p++)
+                    {
+                        uint64_t e = 0;
+                        for (uint32_t c = 0; c < 3; c++)
+                        {
+                            int64_t d = (int64_t)halfs[i][c] - (int64_t)palette[p][c];
+                            e += d * d;
+                        }
+                        if (e < best)
+                        {
+                            best = e;
+                            indices[i] = (uint8_t)p;
+                        }
+                    }
+                    error += best;
+                    weights[i] = kWeights4[indices[i]] / 64.0f;
+                }
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    std::memcpy(best0, e0, sizeof(e0));
+                    std::memcpy(best1, e1, sizeof(e1));
+                    std::memcpy(bestIndices, indices, sizeof(indices));
+                }
+                if (error == 0 || refineEndpoints(points, 3, weights, f0, f1) == false) break;
+            }
+
+            // The most significant bit of the first index is implicitly 0
+            if (bestIndices[0] & 8)
+            {
+                std::swap(best0, best1);
+                for (uint8_t& index : bestIndices) index = 15 - index;
+            }
+
+            BitWriter writer(pDst);
+            writer.write(kBc6hMode11, 5);
+            for (uint32_t c = 0; c < 3; c++) writer.write(best0[c], 10);
+            for (uint32_t c = 0; c < 3; c++) writer.write(best1[c], 10);
+            writer.write(bestIndices[0], 3);
+            for (uint32_t i = 1; i < 16; i++) writer.write(bestIndices[i], 4);
+        }
+
+        bool decodeBc6h(const uint8_t* pSrc, float texels[16][4])
+        {
+            BitReader reader(pSrc);
+            if (reader.read(5) != kBc6hMode11) return false;
+
+            uint32_t e0[3], e1[3];
+            for (uint32_t c = 0; c < 3; c++) e0[c] = reader.read(10);
+            for (uint32_t c = 0; c < 3; c++) e1[c] = reader.read(10);
+
+            uint32_t palette[16][3];
+            getBc6hPalette(e0, e1, palette);
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const uint32_t index = reader.read(i == 0 ? 3 : 4);
+                for (uint32_t c = 0; c < 3; c++) texels[i][c] = halfToFloat((uint16_t)palette[index][c]);
+                texels[i][3] = 1;
+            }
+            return true;
+        }
+
+        /************************************************************************/
+        /* Images                                                               */
+        /************************************************************************/
+
+        /** Convert an 8-bit image to RGBA
+        */
+        void convertImage(const TextureCompressor::Image& image, Level<uint8_t>& level)
+        {
+            level.width = image.width;
+            level.height = image.height;
+            const size_t texelCount = (size_t)image.width * image.height;
+            level.texels.resize(texelCount * 4);
+            const uint8_t* pSrc = (const uint8_t*)image.pData;
+            uint8_t* pDst = level.texels.data();
+
+            switch (image.format)
+            {
+            case ResourceFormat::RGBA8Unorm:
+            case ResourceFormat::RGBA8UnormSrgb:
+                std::memcpy(pDst, pSrc, texelCount * 4);
+                break;
+            case ResourceFormat::BGRA8Unorm:
+            case ResourceFormat::BGRA8UnormSrgb:
+            case ResourceFormat::BGRX8Unorm:
+            case ResourceFormat::BGRX8UnormSrgb:
+            {
+                const bool hasAlpha = (image.format == ResourceFormat::BGRA8Unorm || image.format == ResourceFormat::BGRA8UnormSrgb);
+                for (size_t i = 0; i < texelCount; i++)
+                {
+                    pDst[i * 4 + 0] = pSrc[i * 4 + 2];
+                    pDst[i * 4 + 1] = pSrc[i * 4 + 1];
+                    pDst[i * 4 + 2] = pSrc[i * 4 + 0];
+                    pDst[i * 4 + 3] = hasAlpha ? pSrc[i * 4 + 3] : 0xff;
+                }
+                break;
+            }
+            case ResourceFormat::RG8Unorm:
+            case ResourceFormat::R8Unorm:
+            {
+                const uint32_t channelCount = getFormatChannelCount(image.format);
+                for (size_t i = 0; i < texelCount; i++)
+                {
+                    pDst[i * 4 + 0] = pSrc[i * channelCount];
+                    pDst[i * 4 + 1] = (channelCount > 1) ? pSrc[i * channelCount + 1] : 0;
+                    pDst[i * 4 + 2] = 0;
+                    pDst[i * 4 + 3] = 0xff;
+                }
+                break;
+            }
+            default:
+                should_not_get_here();
+            }
+        }
+
+        /** Convert an HDR image to RGBA
+        */
+        void convertImage(const TextureCompressor::Image& image, Level<float>& level)
+        {
+            level.width = image.width;
+            level.height = image.height;
+            const size_t texelCount = (size_t)image.width * image.height;
+            level.texels.resize(texelCount * 4);
+            const uint32_t channelCount = getFormatChannelCount(image.format);
+            const bool isHalf = (image.format == ResourceFormat::RGBA16Float || image.format == ResourceFormat::RGB16Float);
+            for (size_t i = 0; i < texelCount; i++)
+            {
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    float v = 1;
+                    if (c < channelCount)
+                    {
+                        v = isHalf ? halfToFloat(((const uint16_t*)image.pData)[i * channelCount + c]) : ((const float*)image.pData)[i * channelCount + c];
+                    }
+                    level.texels[i * 4 + c] = v;
+                }
+            }
+        }
+
+        /** Halve the size of an image with a box filter. The color channels of sRGB images are averaged in linear space
+        */
+        void downsample(const Level<uint8_t>& src, bool isSrgb, Level<uint8_t>& dst, TaskScheduler* pScheduler)
+        {
+            dst.width = std::max(1u, src.width / 2);
+            dst.height = std::max(1u, src.height / 2);
+            dst.texels.resize((size_t)dst.width * dst.height * 4);
+
+            const SrgbTables& tables = getSrgbTables();
+            pScheduler->parallelForRange(0, dst.height, [&](uint32_t rowBegin, uint32_t rowEnd)
+            {
+                for (uint32_t y = rowBegin; y < rowEnd; y++)
+                {
+                    const uint32_t y0 = std::min(y * 2, src.height - 1);
+                    const uint32_t y1 = std::min(y * 2 + 1, src.height - 1);
+                    for (uint32_t x = 0; x < dst.width; x++)
+                    {
+                        const uint32_t x0 = std::min(x * 2, src.width - 1);
+                        const uint32_t x1 = std::min(x * 2 + 1, src.width - 1);
+                        const uint8_t* p[4] =
+                        {
+                            &src.texels[((size_t)y0 * src.width + x0) * 4], &src.texels[((size_t)y0 * src.width + x1) * 4],
+                            &src.texels[((size_t)y1 * src.width + x0) * 4], &src.texels[((size_t)y1 * src.width + x1) * 4],
+                        };
+                        uint8_t* pDst = &dst.texels[((size_t)y * dst.width + x) * 4];
+                        for (uint32_t c = 0; c < 4; c++)
+                        {
+                            if (isSrgb && c < 3)
+                            {
+                                float sum = tables.toLinear[p[0][c]] + tables.toLinear[p[1][c]] + tables.toLinear[p[2][c]] + tables.toLinear[p[3][c]];
+                                pDst[c] = tables.fromLinear[std::min(4095u, (uint32_t)(sum * 0.25f * 4095.0f + 0.5f))];
+                            }
+                            else
+                            {
+                                pDst[c] = (uint8_t)((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) / 4);
+                            }
+                        }
+                    }
+                }
+            });
+        }
+
+        void downsample(const Level<float>& src, bool /*isSrgb*/, Level<float>& dst, TaskScheduler* pScheduler)
+        {
+            dst.width = std::max(1u, src.width / 2);
+            dst.height = std::max(1u, src.height / 2);
+            dst.texels.resize((size_t)dst.width * dst.height * 4);
+
+            pScheduler->parallelForRange(0, dst.height, [&](uint32_t rowBegin, uint32_t rowEnd)
+            {
+                for (uint32_t y = rowBegin; y < rowEnd; y++)
+                {
+                    const uint32_t y0 = std::min(y * 2, src.height - 1);
+                    const uint32_t y1 = std::min(y * 2 + 1, src.height - 1);
+                    for (uint32_t x = 0; x < dst.width; x++)
+                    {
+                        const uint32_t x0 = std::min(x * 2, src.width - 1);
+                        const uint32_t x1 = std::min(x * 2 + 1, src.width - 1);
+                        for (uint32_t c = 0; c < 4; c++)
+                        {
+                            float sum = src.texels[((size_t)y0 * src.width + x0) * 4 + c] + src.texels[((size_t)y0 * src.width + x1) * 4 + c] +
+                                src.texels[((size_t)y1 * src.width + x0) * 4 + c] + src.texels[((size_t)y1 * src.width + x1) * 4 + c];
+                            dst.texels[((size_t)y * dst.width + x) * 4 + c] = sum * 0.25f;
+                        }
+                    }
+                }
+            });
+        }
+
+        void encodeBlock(const uint8_t texels[16][4], ResourceFormat format, uint8_t* pDst)
+        {
+            switch (format)
+            {
+            case ResourceFormat::BC1Unorm:
+            case ResourceFormat::BC1UnormSrgb:
+                encodeBc1(texels, pDst);
+                break;
+            case ResourceFormat::BC3Unorm:
+            case ResourceFormat::BC3UnormSrgb:
+                encodeBc4(texels, 3, pDst);
+                encodeBc1(texels, pDst + 8);
+                break;
+            case ResourceFormat::BC4Unorm:
+                encodeBc4(texels, 0, pDst);
+                break;
+            case ResourceFormat::BC5Unorm:
+                encodeBc4(texels, 0, pDst);
+                encodeBc4(texels, 1, pDst + 8);
+                break;
+            case ResourceFormat::BC7Unorm:
+            case ResourceFormat::BC7UnormSrgb:
+                encodeBc7(texels, pDst);
+                break;
+            default:
+                should_not_get_here();
+            }
+        }
+
+        void encodeBlock(const float texels[16][4], ResourceFormat format, uint8_t* pDst)
+        {
+            assert(format == ResourceFormat::BC6HU16);
+            encodeBc6h(texels, pDst);
+        }
+
+        /** Encode all the blocks of a level. Texels outside of the image are clamped to the edge
+        */
+        template<typename T>
+        void encodeLevel(const Level<T>& level, ResourceFormat format, uint8_t* pDst, TaskScheduler* pScheduler)
+        {
+            const uint32_t blocksX = (level.width + 3) / 4;
+            const uint32_t blocksY = (level.height + 3) / 4;
+            const uint32_t blockSize = getFormatBytesPerBlock(format);
+
+            auto encodeRows = [&](uint32_t rowBegin, uint32_t rowEnd)
+            {
+                T texels[16][4];
+                for (uint32_t by = rowBegin; by < rowEnd; by++)
+                {
+                    for (uint32_t bx = 0; bx < blocksX; bx++)
+                    {
+                        for (uint32_t i = 0; i < 16; i++)
+                        {
+                            const uint32_t x = std::min(bx * 4 + (i & 3), level.width - 1);
+                            const uint32_t y = std::min(by * 4 + (i >> 2), level.height - 1);
+                            std::memcpy(texels[i], &level.texels[((size_t)y * level.width + x) * 4], sizeof(texels[i]));
+                        }
+                        encodeBlock(texels, format, pDst + ((size_t)by * blocksX + bx) * blockSize);
+                    }
+                }
+            };
+
+            if (blocksX * blocksY < kMinParallelBlocks)
+            {
+                encodeRows(0, blocksY);
+            }
+            else
+            {
+                pScheduler->parallelForRange(0, blocksY, encodeRows);
+            }
+        }
+
+        template<typename T>
+        void compressLevels(const TextureCompressor::Image& image, ResourceFormat format, TextureCompressor::CompressedImage& result, TaskScheduler* pScheduler)
+        {
+            Level<T> level;
+            convertImage(image, level);
+            size_t offset = 0;
+            for (uint32_t mip = 0; mip < result.mipCount; mip++)
+            {
+                if (mip > 0)
+                {
+                    Level<T> next;
+                    downsample(level, isSrgbFormat(format), next, pScheduler);
+                    level = std::move(next);
+                }
+                encodeLevel(level, format, result.data.data() + offset, pScheduler);
+                offset += TextureCompressor::getMipSize(result.width, result.height, format, mip);
+            }
+        }
+    }
+
+    bool TextureCompressor::isSupportedSourceFormat(ResourceFormat format)
+    {
+        switch (format)
+        {
+        case ResourceFormat::RGBA8Unorm:
+        case ResourceFormat::RGBA8UnormSrgb:
+        case ResourceFormat::BGRA8Unorm:
+        case ResourceFormat::BGRA8UnormSrgb:
+        case ResourceFormat::BGRX8Unorm:
+        case ResourceFormat::BGRX8UnormSrgb:
+        case ResourceFormat::RG8Unorm:
+        case ResourceFormat::R8Unorm:
+        case ResourceFormat::RGBA32Float:
+        case ResourceFormat::RGB32Float:
+        case ResourceFormat::RGBA16Float:
+        case ResourceFormat::RGB16Float:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool TextureCompressor::isSupportedFormat(ResourceFormat format)
+    {
+        switch (format)
+        {
+        case ResourceFormat::BC1Unorm:
+        case ResourceFormat::BC1UnormSrgb:
+        case ResourceFormat::BC3Unorm:
+        case ResourceFormat::BC3UnormSrgb:
+        case ResourceFormat::BC4Unorm:
+        case ResourceFormat::BC5Unorm:
+        case ResourceFormat::BC6HU16:
+        case ResourceFormat::BC7Unorm:
+        case ResourceFormat::BC7UnormSrgb:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    ResourceFormat TextureCompressor::getCompressedFormat(const Image& image, Mode mode)
+    {
+        if (mode == Mode::None || isSupportedSourceFormat(image.format) == false) return ResourceFormat::Unknown;
+        if (image.width == 0 || image.height == 0 || (image.width % 4) != 0 || (image.height % 4) != 0) return ResourceFormat::Unknown;
+
+        if (isHdrFormat(image.format))
+        {
+            // Unsigned BC6H can't store the negative components of normals
+            return (mode == Mode::Color) ? ResourceFormat::BC6HU16 : ResourceFormat::Unknown;
+        }
+
+        const uint32_t channelCount = getFormatChannelCount(image.format);
+        if (channelCount == 1) return ResourceFormat::BC4Unorm;
+        if (channelCount == 2 || mode == Mode::NormalMap) return ResourceFormat::BC5Unorm;
+
+        ResourceFormat format = ResourceFormat::BC1Unorm;
+        if (image.format == ResourceFormat::RGBA8Unorm || image.format == ResourceFormat::RGBA8UnormSrgb || image.format == ResourceFormat::BGRA8Unorm || image.format == ResourceFormat::BGRA8UnormSrgb)
+        {
+            // BC1 can only store binary alpha, which isn't enough for blending, so use BC7 for images which aren't opaque
+            const uint8_t* pTexels = (const uint8_t*)image.pData;
+            const size_t texelCount = (size_t)image.width * image.height;
+            for (size_t i = 0; i < texelCount; i++)
+            {
+                if (pTexels[i * 4 + 3] != 0xff)
+                {
+                    format = ResourceFormat::BC7Unorm;
+                    break;
+                }
+            }
+        }
+        return isSrgbFormat(image.format) ? linearToSrgbFormat(format) : format;
+    }
+
+    bool TextureCompressor::compress(const Image& image, ResourceFormat format, bool generateMips, CompressedImage& result, TaskScheduler* pScheduler)
+    {
+        if (isSupportedSourceFormat(image.format) == false || isSupportedFormat(format) == false || image.pData == nullptr || image.width == 0 || image.height == 0)
+        {
+            logWarning("TextureCompressor::compress() - can't compress a " + to_string(image.format) + " image to " + to_string(format));
+            return false;
+        }
+        if (isHdrFormat(image.format) != (format == ResourceFormat::BC6HU16))
+        {
+            logWarning("TextureCompressor::compress() - HDR images can only be compressed to BC6H, and BC6H requires an HDR image");
+            return false;
+        }
+
+        if (pScheduler == nullptr) pScheduler = TaskScheduler::getDefault().get();
+
+        result.width = image.width;
+        result.height = image.height;
+        result.format = format;
+        result.mipCount = 1;
+        if (generateMips)
+        {
+            uint32_t maxDim = std::max(image.width, image.height);
+            while (maxDim > 1)
+            {
+                maxDim /= 2;
+                result.mipCount++;
+            }
+        }
+
+        size_t size = 0;
+        for (uint32_t mip = 0; mip < result.mipCount; mip++) size += getMipSize(image.width, image.height, format, mip);
+        result.data.resize(size);
+
+        if (format == ResourceFormat::BC6HU16)
+        {
+            compressLevels<float>(image, format, result, pScheduler);
+        }
+        else
+        {
+            compressLevels<uint8_t>(image, format, result, pScheduler);
+        }
+        return true;
+    }
+
+    bool TextureCompressor::decompress(const CompressedImage& image, uint32_t mip, std::vector<float>& texels)
+    {
+        if (isSupportedFormat(image.format) == false || mip >= image.mipCount) return false;
+
+        size_t offset = 0;
+        for (uint32_t m = 0; m < mip; m++) offset += getMipSize(image.width, image.height, image.format, m);
+        if (offset + getMipSize(image.width, image.height, image.format, mip) > image.data.size()) return false;
+
+        const uint32_t width = std::max(1u, image.width >> mip);
+        const uint32_t height = std::max(1u, image.height >> mip);
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blocksY = (height + 3) / 4;
+        const uint32_t blockSize = getFormatBytesPerBlock(image.format);
+        texels.resize((size_t)width * height * 4);
+
+        for (uint32_t by = 0; by < blocksY; by++)
+        {
+            for (uint32_t bx = 0; bx < blocksX; bx++)
+            {
+                const uint8_t* pBlock = image.data.data() + offset + ((size_t)by * blocksX + bx) * blockSize;
+                float block[16][4] = {};
+                for (uint32_t i = 0; i < 16; i++) block[i][3] = 255;
+
+                switch (image.format)
+                {
+                case ResourceFormat::BC1Unorm:
+                case ResourceFormat::BC1UnormSrgb:
+                    decodeBc1(pBlock, false, block);
+                    break;
+                case ResourceFormat::BC3Unorm:
+                case ResourceFormat::BC3UnormSrgb:
+                    decodeBc1(pBlock + 8, true, block);
+                    decodeBc4(pBlock, 3, block);
+                    break;
+                case ResourceFormat::BC4Unorm:
+                    decodeBc4(pBlock, 0, block);
+                    break;
+                case ResourceFormat::BC5Unorm:
+                    decodeBc4(pBlock, 0, block);
+                    decodeBc4(pBlock + 8, 1, block);
+                    break;
+                case ResourceFormat::BC7Unorm:
+                case ResourceFormat::BC7UnormSrgb:
+                    if (decodeBc7(pBlock, block) == false) return false;
+                    break;
+                case ResourceFormat::BC6HU16:
+                    if (decodeBc6h(pBlock, block) == false) return false;
+                    break;
+                default:
+                    should_not_get_here();
+                    return false;
+                }
+
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    const uint32_t x = bx * 4 + (i & 3);
+                    const uint32_t y = by * 4 + (i >> 2);
+                    if (x < width && y < height)
+                    {
+                        std::memcpy(&texels[((size_t)y * width + x) * 4], block[i], sizeof(block[i]));
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    float TextureCompressor::computePsnr(const Image& reference, const CompressedImage& compressed)
+    {
+        if (isSupportedSourceFormat(reference.format) == false || reference.width != compressed.width || reference.height != compressed.height) return 0;
+
+        std::vector<float> decoded;
+        if (decompress(compressed, 0, decoded) == false) return 0;
+
+        std::vector<float> expected;
+        float peak = 255;
+        if (isHdrFormat(reference.format))
+        {
+            Level<float> level;
+            convertImage(reference, level);
+            expected = std::move(level.texels);
+            peak = 0;
+        }
+        else
+        {
+            Level<uint8_t> level;
+            convertImage(reference, level);
+            expected.assign(level.texels.begin(), level.texels.end());
+        }
+
+        const uint32_t channelCount = getFormatChannelCount(compressed.format);
+        const size_t texelCount = (size_t)reference.width * reference.height;
+        double squaredError = 0;
+        for (size_t i = 0; i < texelCount; i++)
+        {
+            for (uint32_t c = 0; c < channelCount; c++)
+            {
+                const double d = (double)expected[i * 4 + c] - decoded[i * 4 + c];
+                squaredError += d * d;
+                if (isHdrFormat(reference.format)) peak = std::max(peak, expected[i * 4 + c]);
+            }
+        }
+
+        const double mse = squaredError / (texelCount * channelCount);
+        if (mse == 0) return std::numeric_limits<float>::infinity();
+        return (float)(10.0 * std::log10((double)peak * peak / mse));
+    }
+
+    size_t TextureCompressor::getMipSize(uint32_t width, uint32_t height, ResourceFormat format, uint32_t mip)
+    {
+        const uint32_t blockWidth = getFormatWidthCompressionRatio(format);
+        const uint32_t blockHeight = getFormatHeightCompressionRatio(format);
+        const size_t blocksX = (std::max(1u, width >> mip) + blockWidth - 1) / blockWidth;
+        const size_t blocksY = (std::max(1u, height >> mip) + blockHeight - 1) / blockHeight;
+        return blocksX * blocksY * getFormatBytesPerBlock(format);
+    }
+}
@@ -0,0 +1,117 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "API/Formats.h"
+
+namespace Falcor
+{
+    class TaskScheduler;
+
+    /** Block-compresses images on the CPU, including their mip chain. Blocks are encoded in parallel on a TaskScheduler.
+        Supported formats are BC1, BC3, BC4, BC5, BC7 and unsigned BC6H. The encoders trade quality for speed: BC7 only uses mode 6 (one subset, RGBA endpoints) and BC6H only uses mode 11 (one region, 10-bit endpoints).
+        decompress() only decodes the modes the encoders write, it's meant for measuring the encoding quality.
+    */
+    class TextureCompressor
+    {
+    public:
+        /** Selects the compressed format in getCompressedFormat()
+        */
+        enum class Mode
+        {
+            None,       ///< Don't compress
+            Color,      ///< Color or data images. Opaque images use BC1, images with alpha use BC7, 1 and 2 channel images use BC4 and BC5, HDR images use BC6H
+            NormalMap,  ///< Tangent-space normal maps. Uses BC5, the shaders reconstruct Z from X and Y
+        };
+
+        /** An uncompressed image
+        */
+        struct Image
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            ResourceFormat format = ResourceFormat::Unknown;
+            const void* pData = nullptr;    ///< Tightly packed texels, starting with the top row
+        };
+
+        /** A compressed image
+        */
+        struct CompressedImage
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t mipCount = 0;
+            ResourceFormat format = ResourceFormat::Unknown;
+            std::vector<uint8_t> data;      ///< The blocks of all the mips, tightly packed. This is the layout Texture::create2D() expects
+        };
+
+        /** Check if an image format can be compressed
+        */
+        static bool isSupportedSourceFormat(ResourceFormat format);
+
+        /** Check if the compressor can encode a format
+        */
+        static bool isSupportedFormat(ResourceFormat format);
+
+        /** Choose the compressed format for an image. The format is sRGB if the image's format is.
+            \return The compressed format, or ResourceFormat::Unknown if the image should stay uncompressed. Compression requires the dimensions to be multiples of 4
+        */
+        static ResourceFormat getCompressedFormat(const Image& image, Mode mode);
+
+        /** Compress an image
+            \param[in] image The image. Must use a supported source format
+            \param[in] format The compressed format. Must be supported
+            \param[in] generateMips Whether to generate and compress the full mip chain. The mips are filtered in linear space if the format is sRGB
+            \param[out] result The compressed image
+            \param[in] pScheduler Optional. The scheduler to run the encoding on. By default, uses TaskScheduler::getDefault()
+            \return Whether the image was compressed
+        */
+        static bool compress(const Image& image, ResourceFormat format, bool generateMips, CompressedImage& result, TaskScheduler* pScheduler = nullptr);
+
+        /** Decode a mip of a compressed image
+            \param[in] image The compressed image
+            \param[in] mip The mip to decode
+            \param[out] texels RGBA texels. 8-bit formats are returned in the [0, 255] range, without sRGB conversion
+            \return false if the format or one of the block modes isn't supported, otherwise true
+        */
+        static bool decompress(const CompressedImage& image, uint32_t mip, std::vector<float>& texels);
+
+        /** Measure the quality of the first mip of a compressed image, as the peak signal-to-noise ratio over the channels the compressed format stores.
+            The peak is 255 for 8-bit images and the largest reference value for HDR images.
+            \param[in] reference The image that was compressed
+            \param[in] compressed The compressed image
+            \return The PSNR in dB, infinity if the images match and 0 if the image can't be decoded
+        */
+        static float computePsnr(const Image& reference, const CompressedImage& compressed);
+
+        /** Get the size of a mip of a compressed image in bytes
+        */
+        static size_t getMipSize(uint32_t width, uint32_t height, ResourceFormat format, uint32_t mip);
+    };
+}
@@ -28,6 +28,8 @@
 #include "Framework.h"
 #include "TextureHelper.h"
 #include "API/Texture.h"
+#include "Graphics/CompressedTextureCache.h"
+#include "Utils/Hash.h"
 #include "Utils/Bitmap.h"
 #include "Utils/DDSHeader.h"
 #include "Utils/BinaryFileStream.h"
@@ -697,7 +699,32 @@ namespace Falcor
         return nullptr;
     }
 
-    Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags)
+    static Texture::SharedPtr createTextureFromCompressedImage(const TextureCompressor::CompressedImage& image)
+    {
+        return Texture::create2D(image.width, image.height, image.format, 1, image.mipCount, image.data.data(), Texture::BindFlags::ShaderResource);
+    }
+
+    Texture::SharedPtr createCompressedTexture(const TextureCompressor::Image& image, TextureCompressor::Mode mode, bool generateMipLevels)
+    {
+        ResourceFormat format = TextureCompressor::getCompressedFormat(image, mode);
+        if (format == ResourceFormat::Unknown) return nullptr;
+
+        // The same texels can be interpreted differently, so the description is part of the hash
+        const uint32_t desc[] = { image.width, image.height, (uint32_t)image.format };
+        const size_t size = (size_t)image.width * image.height * getFormatBytesPerBlock(image.format);
+        const uint64_t sourceHash = hashData(desc, sizeof(desc), hashData(image.pData, size));
+        const uint64_t key = CompressedTextureCache::getKey(sourceHash, mode, isSrgbFormat(image.format), generateMipLevels);
+
+        TextureCompressor::CompressedImage compressed;
+        if (CompressedTextureCache::load(key, compressed) == false)
+        {
+            if (TextureCompressor::compress(image, format, generateMipLevels, compressed) == false) return nullptr;
+            CompressedTextureCache::store(key, compressed);
+        }
+        return createTextureFromCompressedImage(compressed);
+    }
+
+    Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags, TextureCompressor::Mode compression)
     {
 #define no_srgb()   \
     if(loadAsSrgb)  \
@@ -712,16 +739,56 @@ namespace Falcor
         }
         else
         {
-            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, kTopDown);
-            if(pBitmap)
+            // Compressed textures can only be sampled. Look for the file in the cache first, so that the image doesn't need to be decoded
+            const bool compress = (compression != TextureCompressor::Mode::None) && (bindFlags == Texture::BindFlags::ShaderResource);
+            bool hasKey = false;
+            uint64_t key = 0;
+            std::string fullpath;
+            uint64_t fileHash;
+            if (compress && CompressedTextureCache::isEnabled() && findFileInDataDirectories(filename, fullpath) && hashFile(fullpath, fileHash))
             {
-                ResourceFormat texFormat = pBitmap->getFormat();
-                if(loadAsSrgb)
+                hasKey = true;
+                key = CompressedTextureCache::getKey(fileHash, compression, loadAsSrgb, generateMipLevels);
+                TextureCompressor::CompressedImage compressed;
+                if (CompressedTextureCache::load(key, compressed))
                 {
-                    texFormat = linearToSrgbFormat(texFormat);
+                    pTex = createTextureFromCompressedImage(compressed);
                 }
+            }
+
+            if (pTex == nullptr)
+            {
+                Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, kTopDown);
+                if(pBitmap)
+                {
+                    ResourceFormat texFormat = pBitmap->getFormat();
+                    if(loadAsSrgb)
+                    {
+                        texFormat = linearToSrgbFormat(texFormat);
+                    }
+
+                    if (compress)
+                    {
+                        TextureCompressor::Image image;
+                        image.width = pBitmap->getWidth();
+                        image.height = pBitmap->getHeight();
+                        image.format = texFormat;
+                        image.pData = pBitmap->getData();
+
+                        ResourceFormat compressedFormat = TextureCompressor::getCompressedFormat(image, compression);
+                        TextureCompressor::CompressedImage compressed;
+                        if (compressedFormat != ResourceFormat::Unknown && TextureCompressor::compress(image, compressedFormat, generateMipLevels, compressed))
+                        {
+                            if (hasKey) CompressedTextureCache::store(key, compressed);
+                            pTex = createTextureFromCompressedImage(compressed);
+                        }
+                    }
 
-                pTex = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, pBitmap->getData(), bindFlags);
+                    if (pTex == nullptr)
+                    {
+                        pTex = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, pBitmap->getData(), bindFlags);
+                    }
+                }
             }
         }
 
@@ -28,6 +28,7 @@
 #pragma once
 #include <string>
 #include "API/Texture.h"
+#include "Graphics/TextureCompressor.h"
 namespace Falcor
 {
     /*!
@@ -40,8 +41,18 @@ namespace Falcor
         \param[in] generateMipLevels Whether the mip-chain should be generated
         \param[in] loadAsSrgb Load the texture using sRGB format. Only valid for 3 or 4 component textures.
         \param[in] bindFlags The bind flags to create the texture with
+        \param[in] compression Block-compress the image on load. The compressed image is stored in CompressedTextureCache, keyed by the hash of the file. Ignored for DDS files and for textures with bind flags other than ShaderResource.
+            Images which can't be compressed are loaded uncompressed, see TextureCompressor::getCompressedFormat()
     */
-    Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags = Texture::BindFlags::ShaderResource);
+    Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags = Texture::BindFlags::ShaderResource, TextureCompressor::Mode compression = TextureCompressor::Mode::None);
+
+    /** Create a block-compressed texture from an image in memory. The compressed image is stored in CompressedTextureCache, keyed by the hash of the image.
+        \param[in] image The image
+        \param[in] mode The compression mode
+        \param[in] generateMipLevels Whether the mip-chain should be generated
+        \return The texture, or nullptr if the image can't be compressed, in which case the caller should create an uncompressed texture
+    */
+    Texture::SharedPtr createCompressedTexture(const TextureCompressor::Image& image, TextureCompressor::Mode mode, bool generateMipLevels);
 
     /*! @} */
 }
\ No newline at end of file
@@ -0,0 +1,344 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TextureResidencyManager.h"
+#include "Utils/TaskScheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Falcor
+{
+    static const float kNoRequest = std::numeric_limits<float>::max();
+
+    // Textures requested within this many frames are considered equally recent. Otherwise, textures requested every other frame would keep trading the same memory
+    static const uint64_t kRecentFrameCount = 16;
+
+    static uint64_t getRequestAge(uint64_t frame, uint64_t lastRequestFrame)
+    {
+        uint64_t age = frame - lastRequestFrame;
+        return age < kRecentFrameCount ? 0 : age;
+    }
+
+    TextureResidencyManager::SharedPtr TextureResidencyManager::create(Backend* pBackend, uint64_t budget, TaskScheduler* pScheduler)
+    {
+        assert(pBackend);
+        return SharedPtr(new TextureResidencyManager(pBackend, budget, pScheduler));
+    }
+
+    TextureResidencyManager::TextureResidencyManager(Backend* pBackend, uint64_t budget, TaskScheduler* pScheduler) : mpBackend(pBackend), mBudget(budget)
+    {
+        mpLoadGroup = std::make_unique<TaskGroup>(pScheduler);
+    }
+
+    TextureResidencyManager::~TextureResidencyManager()
+    {
+        // The loads reference the manager, so they must finish before it is destroyed
+        mpLoadGroup.reset();
+    }
+
+    uint64_t TextureResidencyManager::getMipSize(const TextureDesc& desc, uint32_t mip)
+    {
+        const uint64_t width = std::max(1u, desc.width >> mip);
+        const uint64_t height = std::max(1u, desc.height >> mip);
+        const uint32_t blockWidth = getFormatWidthCompressionRatio(desc.format);
+        const uint32_t blockHeight = getFormatHeightCompressionRatio(desc.format);
+        return ((width + blockWidth - 1) / blockWidth) * ((height + blockHeight - 1) / blockHeight) * getFormatBytesPerBlock(desc.format);
+    }
+
+    uint64_t TextureResidencyManager::getMipRangeSize(const TextureDesc& desc, uint32_t firstMip, uint32_t endMip)
+    {
+        uint64_t size = 0;
+        for (uint32_t mip = firstMip; mip < endMip; mip++)
+        {
+            size += getMipSize(desc, mip);
+        }
+        return size;
+    }
+
+    uint32_t TextureResidencyManager::getTailMip(const TextureDesc& desc, uint32_t maxSize)
+    {
+        uint32_t mip = 0;
+        while (mip + 1 < desc.mipCount && std::max(desc.width >> mip, desc.height >> mip) > maxSize)
+        {
+            mip++;
+        }
+        return mip;
+    }
+
+    float TextureResidencyManager::getMipForScreenSize(const TextureDesc& desc, float screenSize)
+    {
+        if (screenSize <= 0) return (float)desc.mipCount;
+        return std::log2((float)std::max(desc.width, desc.height) / screenSize);
+    }
+
+    uint32_t TextureResidencyManager::addTexture(const TextureDesc& desc, uint32_t tailMip)
+    {
+        assert(desc.mipCount > 0 && tailMip < desc.mipCount);
+        Entry t;
+        t.desc = desc;
+        t.tailMip = tailMip;
+        t.residentMip = tailMip;
+        t.targetMip = tailMip;
+        t.requestedMip = tailMip;
+        t.frameRequest = kNoRequest;
+        mTextures.push_back(t);
+        mStats.residentBytes += getMipRangeSize(desc, tailMip, desc.mipCount);
+        return (uint32_t)mTextures.size() - 1;
+    }
+
+    void TextureResidencyManager::removeTexture(uint32_t id)
+    {
+        Entry& t = mTextures[id];
+        if (t.isRemoved) return;
+        t.isRemoved = true;
+        mStats.residentBytes -= getMipRangeSize(t.desc, t.residentMip, t.desc.mipCount);
+        mpBackend->releaseTexture(id);
+    }
+
+    void TextureResidencyManager::requestMip(uint32_t id, float mip)
+    {
+        Entry& t = mTextures[id];
+        t.frameRequest = std::min(t.frameRequest, mip);
+    }
+
+    TextureResidencyManager::TextureState TextureResidencyManager::getTextureState(uint32_t id) const
+    {
+        const Entry& t = mTextures[id];
+        TextureState state;
+        state.residentMip = t.residentMip;
+        state.targetMip = t.targetMip;
+        state.requestedMip = t.requestedMip;
+        state.tailMip = t.tailMip;
+        state.isLoading = t.isLoading;
+        return state;
+    }
+
+    void TextureResidencyManager::update()
+    {
+        processRequests();
+        uploadLoads();
+        updateTargets();
+        evict();
+        startLoads();
+        mFrame++;
+    }
+
+    void TextureResidencyManager::waitForLoads()
+    {
+        mpLoadGroup->wait();
+    }
+
+    void TextureResidencyManager::processRequests()
+    {
+        for (uint32_t id = 0; id < (uint32_t)mTextures.size(); id++)
+        {
+            Entry& t = mTextures[id];
+            if (t.isRemoved) continue;
+
+            if (t.frameRequest != kNoRequest)
+            {
+                float mip = std::max(std::floor(t.frameRequest), (float)t.firstLoadableMip);
+                t.requestedMip = (uint32_t)std::min(mip, (float)t.tailMip);
+                t.lastRequestFrame = mFrame;
+                t.frameRequest = kNoRequest;
+            }
+            else if (mpBackend->isTextureUsed(id) == false)
+            {
+                removeTexture(id);
+            }
+        }
+    }
+
+    void TextureResidencyManager::uploadLoads()
+    {
+        std::vector<std::shared_ptr<Load>> loads;
+        {
+            std::lock_guard<std::mutex> lock(mLoadMutex);
+            loads.swap(mFinishedLoads);
+        }
+
+        uint64_t uploadedBytes = 0;
+        size_t i = 0;
+        for (; i < loads.size(); i++)
+        {
+            const Load& load = *loads[i];
+            if (uploadedBytes > 0 && uploadedBytes + load.size > mMaxUploadBytesPerFrame) break;
+
+            Entry& t = mTextures[load.id];
+            t.isLoading = false;
+            mStats.pendingLoads--;
+            mStats.pendingBytes -= load.size;
+            if (t.isRemoved) continue;
+
+            if (load.success == false)
+            {
+                logWarning("TextureResidencyManager: failed to load mips " + std::to_string(load.firstMip) + " to " + std::to_string(load.endMip - 1) + " of texture " + std::to_string(load.id));
+                t.firstLoadableMip = load.endMip;
+                t.requestedMip = std::max(t.requestedMip, t.firstLoadableMip);
+                continue;
+            }
+
+            // The target may have become coarser while the mips were loading, and the texture may have lost mips, in which case the loaded chain is no longer contiguous with the resident one
+            const uint32_t firstMip = std::max(load.firstMip, t.targetMip);
+            if (load.endMip != t.residentMip || firstMip >= load.endMip) continue;
+
+            const uint64_t offset = getMipRangeSize(t.desc, load.firstMip, firstMip);
+            const uint64_t size = load.size - offset;
+            mpBackend->uploadMips(load.id, firstMip, load.endMip, load.data.data() + offset);
+            t.residentMip = firstMip;
+
+            uploadedBytes += size;
+            mStats.residentBytes += size;
+            mStats.loadedBytes += size;
+            mStats.loadCount++;
+        }
+
+        // Loads which didn't fit in this frame's upload limit are uploaded by the next frames, in order
+        if (i < loads.size())
+        {
+            std::lock_guard<std::mutex> lock(mLoadMutex);
+            mFinishedLoads.insert(mFinishedLoads.begin(), loads.begin() + i, loads.end());
+        }
+    }
+
+    void TextureResidencyManager::updateTargets()
+    {
+        // The tail mips are always resident. The rest of the budget goes to the finer mips, one level at a time, in priority order:
+        // recently requested textures first, and among those, the textures missing the most levels first, so that textures sharing the budget are balanced.
+        // Resident mips finer than requested are kept with the lowest priority, so that mips are only evicted when the space is needed.
+        uint64_t usedBytes = 0;
+        mSteps.clear();
+        for (uint32_t id = 0; id < (uint32_t)mTextures.size(); id++)
+        {
+            Entry& t = mTextures[id];
+            if (t.isRemoved) continue;
+
+            usedBytes += getMipRangeSize(t.desc, t.tailMip, t.desc.mipCount);
+            t.targetMip = t.tailMip;
+
+            const uint64_t age = getRequestAge(mFrame, t.lastRequestFrame);
+            for (uint32_t mip = t.tailMip; mip-- > t.requestedMip;)
+            {
+                mSteps.push_back({ id, mip, 0, age, mip - t.requestedMip });
+            }
+            for (uint32_t mip = std::min(t.requestedMip, t.tailMip); mip-- > t.residentMip;)
+            {
+                mSteps.push_back({ id, mip, 1, age, 0 });
+            }
+        }
+
+        std::sort(mSteps.begin(), mSteps.end(), [](const Step& a, const Step& b)
+        {
+            if (a.isCached != b.isCached) return a.isCached < b.isCached;
+            if (a.age != b.age) return a.age < b.age;
+            if (a.deficit != b.deficit) return a.deficit > b.deficit;
+            if (a.id != b.id) return a.id < b.id;
+            return a.mip > b.mip;
+        });
+
+        for (const Step& step : mSteps)
+        {
+            Entry& t = mTextures[step.id];
+
+            // A texture's mips must be resident as a chain. If a coarser step was rejected, so are the finer ones
+            if (t.targetMip != step.mip + 1) continue;
+
+            const uint64_t size = getMipSize(t.desc, step.mip);
+            if (usedBytes + size > mBudget) continue;
+            usedBytes += size;
+            t.targetMip = step.mip;
+        }
+    }
+
+    void TextureResidencyManager::evict()
+    {
+        for (uint32_t id = 0; id < (uint32_t)mTextures.size(); id++)
+        {
+            Entry& t = mTextures[id];
+            if (t.isRemoved || t.targetMip <= t.residentMip) continue;
+
+            const uint64_t size = getMipRangeSize(t.desc, t.residentMip, t.targetMip);
+            mpBackend->evictMips(id, t.targetMip);
+            t.residentMip = t.targetMip;
+            mStats.residentBytes -= size;
+            mStats.evictedBytes += size;
+            mStats.evictionCount++;
+        }
+    }
+
+    void TextureResidencyManager::startLoads()
+    {
+        if (mStats.pendingLoads >= mMaxPendingLoads) return;
+
+        std::vector<uint32_t> candidates;
+        for (uint32_t id = 0; id < (uint32_t)mTextures.size(); id++)
+        {
+            const Entry& t = mTextures[id];
+            if (t.isRemoved == false && t.isLoading == false && t.targetMip < t.residentMip)
+            {
+                candidates.push_back(id);
+            }
+        }
+
+        // Same order as the budget: recently requested textures first, then the ones missing the most levels
+        std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b)
+        {
+            const Entry& ta = mTextures[a];
+            const Entry& tb = mTextures[b];
+            const uint64_t ageA = getRequestAge(mFrame, ta.lastRequestFrame);
+            const uint64_t ageB = getRequestAge(mFrame, tb.lastRequestFrame);
+            if (ageA != ageB) return ageA < ageB;
+            if (ta.residentMip - ta.targetMip != tb.residentMip - tb.targetMip) return ta.residentMip - ta.targetMip > tb.residentMip - tb.targetMip;
+            return a < b;
+        });
+
+        for (uint32_t id : candidates)
+        {
+            if (mStats.pendingLoads >= mMaxPendingLoads) break;
+
+            Entry& t = mTextures[id];
+            auto pLoad = std::make_shared<Load>();
+            pLoad->id = id;
+            pLoad->firstMip = t.targetMip;
+            pLoad->endMip = t.residentMip;
+            pLoad->size = getMipRangeSize(t.desc, pLoad->firstMip, pLoad->endMip);
+
+            t.isLoading = true;
+            mStats.pendingLoads++;
+            mStats.pendingBytes += pLoad->size;
+
+            mpLoadGroup->run([this, pLoad]()
+            {
+                pLoad->success = mpBackend->readMips(pLoad->id, pLoad->firstMip, pLoad->endMip, pLoad->data) && (pLoad->data.size() == pLoad->size);
+                std::lock_guard<std::mutex> lock(mLoadMutex);
+                mFinishedLoads.push_back(pLoad);
+            });
+        }
+    }
+}
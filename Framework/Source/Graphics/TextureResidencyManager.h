@@ -0,0 +1,258 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "API/Formats.h"
+
+namespace Falcor
+{
+    class TaskScheduler;
+    class TaskGroup;
+
+    /** Decides which mip levels of streamed textures should be resident under a memory budget, and schedules loading and eviction of mips.
+        A texture's mips are always resident as a contiguous chain, from the resident mip down to the smallest one. The mips below the tail mip, which is the resident mip when the texture is added, are never evicted.
+        The manager doesn't touch any GPU resources. Reading mips from disk, uploading them and evicting them is done through a Backend, which makes the residency and priority logic testable on the CPU.
+    */
+    class TextureResidencyManager
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TextureResidencyManager>;
+
+        static const uint32_t kInvalidID = uint32_t(-1);
+
+        /** Description of a streamed texture
+        */
+        struct TextureDesc
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t mipCount = 0;
+            ResourceFormat format = ResourceFormat::Unknown;
+        };
+
+        /** Loads, uploads and evicts mips on behalf of the manager
+        */
+        class Backend
+        {
+        public:
+            virtual ~Backend() = default;
+
+            /** Read a range of mips. Called from worker threads, concurrently for different textures
+                \param[in] id The texture's ID
+                \param[in] firstMip First mip to read
+                \param[in] endMip One past the last mip to read
+                \param[out] data The texels of the mips, tightly packed, from firstMip to endMip - 1. The size must match getMipRangeSize()
+                \return Whether the mips were read
+            */
+            virtual bool readMips(uint32_t id, uint32_t firstMip, uint32_t endMip, std::vector<uint8_t>& data) = 0;
+
+            /** Make mips resident. Called from update(), so on the thread which renders. The mips from the end of the range down to the smallest mip are already resident
+                \param[in] id The texture's ID
+                \param[in] firstMip The new resident mip
+                \param[in] endMip The previous resident mip
+                \param[in] pData The texels of the new mips, as returned by readMips()
+            */
+            virtual void uploadMips(uint32_t id, uint32_t firstMip, uint32_t endMip, const uint8_t* pData) = 0;
+
+            /** Release the mips above a level. Called from update()
+                \param[in] id The texture's ID
+                \param[in] firstMip The new resident mip
+            */
+            virtual void evictMips(uint32_t id, uint32_t firstMip) = 0;
+
+            /** Check if a texture is still in use. Textures which are no longer used are removed during update()
+            */
+            virtual bool isTextureUsed(uint32_t id) { return true; }
+
+            /** Release a texture which was removed from the manager. Its pending loads are discarded
+            */
+            virtual void releaseTexture(uint32_t id) {}
+        };
+
+        /** The residency of a texture
+        */
+        struct TextureState
+        {
+            uint32_t residentMip = 0;       ///< The finest resident mip
+            uint32_t targetMip = 0;         ///< The finest mip which fits in the budget, given the current demand
+            uint32_t requestedMip = 0;      ///< The finest mip requested in the last frame the texture was requested in
+            uint32_t tailMip = 0;           ///< The finest mip which is always resident
+            bool isLoading = false;
+        };
+
+        struct Stats
+        {
+            uint64_t residentBytes = 0;     ///< Memory used by all the resident mips
+            uint64_t pendingBytes = 0;      ///< Memory of the mips being loaded
+            uint32_t pendingLoads = 0;
+            uint64_t loadedBytes = 0;       ///< Total since the manager was created
+            uint64_t evictedBytes = 0;      ///< Total since the manager was created
+            uint32_t loadCount = 0;         ///< Total since the manager was created
+            uint32_t evictionCount = 0;     ///< Total since the manager was created
+        };
+
+        /** Create a new manager
+            \param[in] pBackend The backend. Must outlive the manager
+            \param[in] budget Memory budget of all the resident mips, in bytes
+            \param[in] pScheduler The scheduler running the loads. By default, uses the default scheduler
+        */
+        static SharedPtr create(Backend* pBackend, uint64_t budget, TaskScheduler* pScheduler = nullptr);
+
+        /** Destructor. Waits for the pending loads
+        */
+        ~TextureResidencyManager();
+
+        /** Add a texture
+            \param[in] desc The texture's description
+            \param[in] tailMip The finest mip which is resident when the texture is added. These mips are never evicted
+            \return The texture's ID
+        */
+        uint32_t addTexture(const TextureDesc& desc, uint32_t tailMip);
+
+        /** Remove a texture. Calls Backend::releaseTexture()
+        */
+        void removeTexture(uint32_t id);
+
+        /** Request a mip level of a texture for the current frame. Multiple requests in the same frame keep the finest level
+            \param[in] id The texture's ID
+            \param[in] mip The requested level. Fractional levels are rounded down, and levels outside of the mip chain are clamped
+        */
+        void requestMip(uint32_t id, float mip);
+
+        /** Process the requests of the current frame. Uploads finished loads, evicts mips which no longer fit the budget and starts new loads.
+            Should be called once per frame, on the thread which renders
+        */
+        void update();
+
+        /** Wait for all the pending loads. They are uploaded by the next update()
+        */
+        void waitForLoads();
+
+        /** Set the memory budget. The tail mips of all textures are always resident, even when they exceed the budget
+        */
+        void setBudget(uint64_t budget) { mBudget = budget; }
+        uint64_t getBudget() const { return mBudget; }
+
+        /** Set the maximal number of bytes uploaded in a single update(). At least one load is uploaded per update()
+        */
+        void setMaxUploadBytesPerFrame(uint64_t bytes) { mMaxUploadBytesPerFrame = bytes; }
+        uint64_t getMaxUploadBytesPerFrame() const { return mMaxUploadBytesPerFrame; }
+
+        /** Set the maximal number of loads in flight
+        */
+        void setMaxPendingLoads(uint32_t count) { mMaxPendingLoads = count; }
+        uint32_t getMaxPendingLoads() const { return mMaxPendingLoads; }
+
+        /** Get the state of a texture
+        */
+        TextureState getTextureState(uint32_t id) const;
+
+        /** Get the number of textures, including removed ones. IDs are in [0, getTextureCount())
+        */
+        uint32_t getTextureCount() const { return (uint32_t)mTextures.size(); }
+
+        const Stats& getStats() const { return mStats; }
+
+        /** Get the size of a mip level in bytes
+        */
+        static uint64_t getMipSize(const TextureDesc& desc, uint32_t mip);
+
+        /** Get the size of a range of mips in bytes
+        */
+        static uint64_t getMipRangeSize(const TextureDesc& desc, uint32_t firstMip, uint32_t endMip);
+
+        /** Get the finest mip whose width and height are at most maxSize
+        */
+        static uint32_t getTailMip(const TextureDesc& desc, uint32_t maxSize);
+
+        /** Get the mip level at which a texture maps one texel to one pixel
+            \param[in] desc The texture's description
+            \param[in] screenSize Size in pixels of the texture's footprint on the screen, along its largest dimension
+        */
+        static float getMipForScreenSize(const TextureDesc& desc, float screenSize);
+
+    private:
+        TextureResidencyManager(Backend* pBackend, uint64_t budget, TaskScheduler* pScheduler);
+
+        struct Entry
+        {
+            TextureDesc desc;
+            uint32_t tailMip = 0;
+            uint32_t residentMip = 0;
+            uint32_t targetMip = 0;
+            uint32_t requestedMip = 0;
+            uint32_t firstLoadableMip = 0;      // Raised when a load fails, so that it isn't retried every frame
+            float frameRequest = 0;             // The finest level requested in the current frame, or kNoRequest
+            uint64_t lastRequestFrame = 0;      // 0 if the texture was never requested
+            bool isLoading = false;
+            bool isRemoved = false;
+        };
+
+        struct Load
+        {
+            uint32_t id = 0;
+            uint32_t firstMip = 0;
+            uint32_t endMip = 0;
+            uint64_t size = 0;
+            std::vector<uint8_t> data;
+            bool success = false;
+        };
+
+        // A mip which can be made resident if it fits in the budget. Steps are accepted in priority order
+        struct Step
+        {
+            uint32_t id;
+            uint32_t mip;
+            uint32_t isCached;      // 1 if the mip is resident but finer than requested. Those are only kept when there is space left
+            uint64_t age;           // Frames since the texture was last requested, 0 if it was requested recently
+            uint32_t deficit;       // How many levels the texture is still missing after this step
+        };
+
+        void processRequests();
+        void uploadLoads();
+        void updateTargets();
+        void evict();
+        void startLoads();
+
+        Backend* mpBackend;
+        std::unique_ptr<TaskGroup> mpLoadGroup;
+        std::vector<Entry> mTextures;
+        std::vector<Step> mSteps;
+        uint64_t mBudget;
+        uint64_t mMaxUploadBytesPerFrame = 64 * 1024 * 1024;
+        uint32_t mMaxPendingLoads = 16;
+        uint64_t mFrame = 1;
+        Stats mStats;
+
+        std::mutex mLoadMutex;
+        std::vector<std::shared_ptr<Load>> mFinishedLoads;      // Guarded by mLoadMutex
+    };
+}
@@ -0,0 +1,406 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TextureStreamer.h"
+#include "API/Device.h"
+#include "API/RenderContext.h"
+#include "Graphics/Material/Material.h"
+#include "Utils/Bitmap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Falcor
+{
+    // The tail mips are created from a sparse grid of the top mip's texels, so that adding a texture doesn't have to read all of its texels
+    static const uint32_t kTailSampleCount = 4;
+
+    struct SrgbTables
+    {
+        float toLinear[256];
+        uint8_t fromLinear[4096];
+
+        SrgbTables()
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                float c = i / 255.0f;
+                toLinear[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            for (uint32_t i = 0; i < 4096; i++)
+            {
+                float l = i / 4095.0f;
+                float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                fromLinear[i] = (uint8_t)(c * 255.0f + 0.5f);
+            }
+        }
+    };
+
+    static const SrgbTables& getSrgbTables()
+    {
+        static const SrgbTables tables;
+        return tables;
+    }
+
+    /** Filter a 4-channel 8-bit image down to a smaller size. Each texel of the result is the average of its footprint in the source, sampled on a grid of at most maxSamples x maxSamples texels.
+        The color channels of sRGB images are averaged in linear space. 3-channel sources get an opaque alpha channel
+    */
+    static void downsample(const uint8_t* pSrc, uint32_t srcBpp, uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight, bool isSrgb, uint32_t maxSamples, uint8_t* pDst)
+    {
+        const SrgbTables& tables = getSrgbTables();
+        for (uint32_t y = 0; y < dstHeight; y++)
+        {
+            const uint32_t y0 = (uint32_t)((uint64_t)y * srcHeight / dstHeight);
+            const uint32_t y1 = std::max(y0 + 1, (uint32_t)((uint64_t)(y + 1) * srcHeight / dstHeight));
+            const uint32_t yStep = std::max(1u, (y1 - y0) / maxSamples);
+            for (uint32_t x = 0; x < dstWidth; x++)
+            {
+                const uint32_t x0 = (uint32_t)((uint64_t)x * srcWidth / dstWidth);
+                const uint32_t x1 = std::max(x0 + 1, (uint32_t)((uint64_t)(x + 1) * srcWidth / dstWidth));
+                const uint32_t xStep = std::max(1u, (x1 - x0) / maxSamples);
+
+                float sum[4] = { 0, 0, 0, 0 };
+                uint32_t count = 0;
+                for (uint32_t sy = y0; sy < y1; sy += yStep)
+                {
+                    for (uint32_t sx = x0; sx < x1; sx += xStep)
+                    {
+                        const uint8_t* pTexel = pSrc + ((size_t)sy * srcWidth + sx) * srcBpp;
+                        for (uint32_t c = 0; c < 3; c++)
+                        {
+                            sum[c] += isSrgb ? tables.toLinear[pTexel[c]] : pTexel[c] * (1.0f / 255.0f);
+                        }
+                        sum[3] += (srcBpp == 4) ? pTexel[3] * (1.0f / 255.0f) : 1.0f;
+                        count++;
+                    }
+                }
+
+                uint8_t* pOut = pDst + ((size_t)y * dstWidth + x) * 4;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    const float value = sum[c] / count;
+                    pOut[c] = (isSrgb && c < 3) ? tables.fromLinear[std::min(4095, (int)(value * 4095.0f + 0.5f))] : (uint8_t)std::min(255, (int)(value * 255.0f + 0.5f));
+                }
+            }
+        }
+    }
+
+    /** Create a range of mips from the top mip of a texture
+        \param[out] pDst The mips, tightly packed. Must have room for TextureResidencyManager::getMipRangeSize() bytes
+    */
+    static void buildMips(const TextureResidencyManager::TextureDesc& desc, const uint8_t* pTexels, uint32_t bpp, uint32_t firstMip, uint32_t endMip, uint32_t maxSamples, uint8_t* pDst)
+    {
+        const bool isSrgb = isSrgbFormat(desc.format);
+        uint32_t width = std::max(1u, desc.width >> firstMip);
+        uint32_t height = std::max(1u, desc.height >> firstMip);
+        if (firstMip == 0 && bpp == 4)
+        {
+            std::memcpy(pDst, pTexels, (size_t)width * height * 4);
+        }
+        else
+        {
+            downsample(pTexels, bpp, desc.width, desc.height, width, height, isSrgb, maxSamples, pDst);
+        }
+
+        // Each of the following mips is filtered from the previous one
+        for (uint32_t mip = firstMip + 1; mip < endMip; mip++)
+        {
+            const uint8_t* pPrev = pDst;
+            pDst += (size_t)width * height * 4;
+            const uint32_t prevWidth = width;
+            const uint32_t prevHeight = height;
+            width = std::max(1u, width >> 1);
+            height = std::max(1u, height >> 1);
+            downsample(pPrev, 4, prevWidth, prevHeight, width, height, isSrgb, 2, pDst);
+        }
+    }
+
+    static TextureStreamer::SharedPtr sDefaultStreamer;
+
+    TextureStreamer::SharedPtr TextureStreamer::create(uint64_t budget)
+    {
+        return SharedPtr(new TextureStreamer(budget));
+    }
+
+    const TextureStreamer::SharedPtr& TextureStreamer::getDefault()
+    {
+        if (sDefaultStreamer == nullptr)
+        {
+            sDefaultStreamer = create();
+        }
+        return sDefaultStreamer;
+    }
+
+    void TextureStreamer::shutdown()
+    {
+        sDefaultStreamer = nullptr;
+    }
+
+    TextureStreamer::TextureStreamer(uint64_t budget)
+    {
+        mpResidency = TextureResidencyManager::create(this, budget);
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        // The loads read the sources, so they must finish first
+        mpResidency = nullptr;
+    }
+
+    bool TextureStreamer::isSupportedFormat(ResourceFormat format)
+    {
+        switch (format)
+        {
+        case ResourceFormat::RGBA8Unorm:
+        case ResourceFormat::RGBA8UnormSrgb:
+        case ResourceFormat::BGRA8Unorm:
+        case ResourceFormat::BGRA8UnormSrgb:
+        case ResourceFormat::BGRX8Unorm:
+        case ResourceFormat::BGRX8UnormSrgb:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    Texture::SharedPtr TextureStreamer::addTexture(const Source& source)
+    {
+        auto pSource = std::make_shared<Source>(source);
+        const uint8_t* pTexels = source.pData;
+        Bitmap::UniqueConstPtr pBitmap;
+        if (pTexels == nullptr)
+        {
+            // The file is decoded again whenever mips are loaded. The format comes from the file, and the source's format only selects the color space
+            pBitmap = Bitmap::createFromFile(source.filename, true);
+            if (pBitmap == nullptr) return nullptr;
+            pSource->width = pBitmap->getWidth();
+            pSource->height = pBitmap->getHeight();
+            pSource->bytesPerPixel = 4;
+            pSource->format = isSrgbFormat(source.format) ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
+            pTexels = pBitmap->getData();
+        }
+
+        if (isSupportedFormat(pSource->format) == false || (pSource->bytesPerPixel != 3 && pSource->bytesPerPixel != 4) || pSource->width == 0 || pSource->height == 0)
+        {
+            return nullptr;
+        }
+
+        TextureResidencyManager::TextureDesc desc;
+        desc.width = pSource->width;
+        desc.height = pSource->height;
+        desc.mipCount = bitScanReverse(desc.width | desc.height) + 1;
+        desc.format = pSource->format;
+
+        const uint32_t tailMip = TextureResidencyManager::getTailMip(desc, kTailSize);
+        std::vector<uint8_t> tail((size_t)TextureResidencyManager::getMipRangeSize(desc, tailMip, desc.mipCount));
+        buildMips(desc, pTexels, pSource->bytesPerPixel, tailMip, desc.mipCount, kTailSampleCount, tail.data());
+
+        Texture::SharedPtr pTexture = Texture::create2D(std::max(1u, desc.width >> tailMip), std::max(1u, desc.height >> tailMip), desc.format, 1, desc.mipCount - tailMip, tail.data());
+        if (pTexture == nullptr) return nullptr;
+        pTexture->setSourceFilename(source.name);
+
+        const uint32_t id = mpResidency->addTexture(desc, tailMip);
+        assert(id == (uint32_t)mTextures.size());
+        StreamedTexture t;
+        t.desc = desc;
+        t.pTexture = pTexture;
+        t.firstMip = tailMip;
+        mTextures.push_back(t);
+        mTextureIDs[pTexture.get()] = id;
+        {
+            std::lock_guard<std::mutex> lock(mSourceMutex);
+            mSources.push_back(pSource);
+        }
+        return pTexture;
+    }
+
+    void TextureStreamer::addMaterial(const Material::SharedPtr& pMaterial)
+    {
+        const Texture::SharedPtr textures[] = { pMaterial->getBaseColorTexture(), pMaterial->getSpecularTexture(), pMaterial->getEmissiveTexture(), pMaterial->getNormalMap(), pMaterial->getOcclusionMap(), pMaterial->getLightMap(), pMaterial->getHeightMap() };
+        for (const auto& pTexture : textures)
+        {
+            auto it = pTexture ? mTextureIDs.find(pTexture.get()) : mTextureIDs.end();
+            if (it == mTextureIDs.end()) continue;
+
+            auto& materials = mTextures[it->second].materials;
+            bool isKnown = std::any_of(materials.begin(), materials.end(), [&pMaterial](const std::weak_ptr<Material>& p) { return p.lock() == pMaterial; });
+            if (isKnown == false)
+            {
+                materials.push_back(pMaterial);
+            }
+        }
+    }
+
+    void TextureStreamer::requestTexture(const Texture* pTexture, float screenSize)
+    {
+        auto it = mTextureIDs.find(pTexture);
+        if (it != mTextureIDs.end())
+        {
+            mpResidency->requestMip(it->second, TextureResidencyManager::getMipForScreenSize(mTextures[it->second].desc, screenSize));
+        }
+    }
+
+    void TextureStreamer::requestMaterial(const Material* pMaterial, float screenSize)
+    {
+        const Texture::SharedPtr textures[] = { pMaterial->getBaseColorTexture(), pMaterial->getSpecularTexture(), pMaterial->getEmissiveTexture(), pMaterial->getNormalMap(), pMaterial->getOcclusionMap(), pMaterial->getLightMap(), pMaterial->getHeightMap() };
+        for (const auto& pTexture : textures)
+        {
+            if (pTexture) requestTexture(pTexture.get(), screenSize);
+        }
+    }
+
+    void TextureStreamer::update()
+    {
+        if (mTextures.empty() == false)
+        {
+            mpResidency->update();
+        }
+    }
+
+    bool TextureStreamer::readMips(uint32_t id, uint32_t firstMip, uint32_t endMip, std::vector<uint8_t>& data)
+    {
+        std::shared_ptr<const Source> pSource;
+        {
+            std::lock_guard<std::mutex> lock(mSourceMutex);
+            pSource = mSources[id];
+        }
+        if (pSource == nullptr) return false;
+
+        const uint8_t* pTexels = pSource->pData;
+        Bitmap::UniqueConstPtr pBitmap;
+        if (pTexels == nullptr)
+        {
+            pBitmap = Bitmap::createFromFile(pSource->filename, true);
+            if (pBitmap == nullptr || pBitmap->getWidth() != pSource->width || pBitmap->getHeight() != pSource->height || getFormatBytesPerBlock(pBitmap->getFormat()) != 4) return false;
+            pTexels = pBitmap->getData();
+        }
+
+        // mTextures can grow while mips are loading, so the description is rebuilt from the source
+        TextureResidencyManager::TextureDesc desc;
+        desc.width = pSource->width;
+        desc.height = pSource->height;
+        desc.mipCount = bitScanReverse(desc.width | desc.height) + 1;
+        desc.format = pSource->format;
+
+        data.resize((size_t)TextureResidencyManager::getMipRangeSize(desc, firstMip, endMip));
+        buildMips(desc, pTexels, pSource->bytesPerPixel, firstMip, endMip, UINT32_MAX, data.data());
+        return true;
+    }
+
+    void TextureStreamer::uploadMips(uint32_t id, uint32_t firstMip, uint32_t endMip, const uint8_t* pData)
+    {
+        const StreamedTexture& t = mTextures[id];
+        assert(endMip == t.firstMip);
+        const TextureResidencyManager::TextureDesc& desc = t.desc;
+        Texture::SharedPtr pTexture = Texture::create2D(std::max(1u, desc.width >> firstMip), std::max(1u, desc.height >> firstMip), desc.format, 1, desc.mipCount - firstMip, nullptr);
+        if (pTexture == nullptr) return;
+
+        RenderContext* pContext = gpDevice->getRenderContext().get();
+        for (uint32_t mip = firstMip; mip < endMip; mip++)
+        {
+            pContext->updateSubresourceData(pTexture.get(), pTexture->getSubresourceIndex(0, mip - firstMip), pData);
+            pData += TextureResidencyManager::getMipSize(desc, mip);
+        }
+        for (uint32_t mip = endMip; mip < desc.mipCount; mip++)
+        {
+            pContext->copySubresource(pTexture.get(), pTexture->getSubresourceIndex(0, mip - firstMip), t.pTexture.get(), t.pTexture->getSubresourceIndex(0, mip - t.firstMip));
+        }
+        replaceTexture(id, pTexture, firstMip);
+    }
+
+    void TextureStreamer::evictMips(uint32_t id, uint32_t firstMip)
+    {
+        const StreamedTexture& t = mTextures[id];
+        assert(firstMip > t.firstMip);
+        const TextureResidencyManager::TextureDesc& desc = t.desc;
+        Texture::SharedPtr pTexture = Texture::create2D(std::max(1u, desc.width >> firstMip), std::max(1u, desc.height >> firstMip), desc.format, 1, desc.mipCount - firstMip, nullptr);
+        if (pTexture == nullptr) return;
+
+        RenderContext* pContext = gpDevice->getRenderContext().get();
+        for (uint32_t mip = firstMip; mip < desc.mipCount; mip++)
+        {
+            pContext->copySubresource(pTexture.get(), pTexture->getSubresourceIndex(0, mip - firstMip), t.pTexture.get(), t.pTexture->getSubresourceIndex(0, mip - t.firstMip));
+        }
+        replaceTexture(id, pTexture, firstMip);
+    }
+
+    void TextureStreamer::replaceTexture(uint32_t id, const Texture::SharedPtr& pTexture, uint32_t firstMip)
+    {
+        StreamedTexture& t = mTextures[id];
+        Texture::SharedPtr pOld = t.pTexture;
+        pTexture->setSourceFilename(pOld->getSourceFilename());
+        mTextureIDs.erase(pOld.get());
+        mTextureIDs[pTexture.get()] = id;
+        t.pTexture = pTexture;
+        t.firstMip = firstMip;
+
+        // Replace the old texture in the slots which still use it. The application may have replaced it in some of them
+        Texture::SharedPtr pNew = pTexture;
+        for (auto it = t.materials.begin(); it != t.materials.end();)
+        {
+            Material::SharedPtr pMaterial = it->lock();
+            if (pMaterial == nullptr)
+            {
+                it = t.materials.erase(it);
+                continue;
+            }
+
+            if (pMaterial->getBaseColorTexture() == pOld)
+            {
+                // Setting the base color texture resets the alpha mode
+                uint32_t alphaMode = pMaterial->getAlphaMode();
+                pMaterial->setBaseColorTexture(pNew);
+                pMaterial->setAlphaMode(alphaMode);
+            }
+            if (pMaterial->getSpecularTexture() == pOld) pMaterial->setSpecularTexture(pNew);
+            if (pMaterial->getEmissiveTexture() == pOld) pMaterial->setEmissiveTexture(pNew);
+            if (pMaterial->getNormalMap() == pOld) pMaterial->setNormalMap(pNew);
+            if (pMaterial->getOcclusionMap() == pOld) pMaterial->setOcclusionMap(pNew);
+            if (pMaterial->getLightMap() == pOld) pMaterial->setLightMap(pNew);
+            if (pMaterial->getHeightMap() == pOld) pMaterial->setHeightMap(pNew);
+            ++it;
+        }
+    }
+
+    bool TextureStreamer::isTextureUsed(uint32_t id)
+    {
+        // The streamer holds one reference. Any other reference comes from a material or from the application
+        return mTextures[id].pTexture.use_count() > 1;
+    }
+
+    void TextureStreamer::releaseTexture(uint32_t id)
+    {
+        StreamedTexture& t = mTextures[id];
+        mTextureIDs.erase(t.pTexture.get());
+        t.pTexture = nullptr;
+        t.materials.clear();
+
+        std::lock_guard<std::mutex> lock(mSourceMutex);
+        mSources[id] = nullptr;
+    }
+}
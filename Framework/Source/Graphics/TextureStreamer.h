@@ -0,0 +1,153 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "API/Texture.h"
+#include "Graphics/TextureResidencyManager.h"
+
+namespace Falcor
+{
+    class Material;
+
+    /** Streams the mips of textures based on the demand of the renderer.
+        Textures are created with only their smallest mips. Finer mips are read and filtered on worker threads when they are requested, and evicted when the memory budget is exceeded.
+        A texture's mips are resident as a contiguous chain, so making mips resident or evicting them creates a new texture object and copies the mips which stay resident on the GPU.
+        The materials registered with addMaterial() are updated with the new texture objects. The residency decisions are made by a TextureResidencyManager.
+    */
+    class TextureStreamer : private TextureResidencyManager::Backend
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TextureStreamer>;
+
+        static const uint64_t kDefaultBudget = 512ull * 1024 * 1024;
+
+        /** Textures are created with the mips whose width and height are at most this size
+        */
+        static const uint32_t kTailSize = 64;
+
+        /** The top mip of a streamed texture. 8-bit RGB or RGBA texels, either in memory or in an image file
+        */
+        struct Source
+        {
+            std::string name;                           ///< The texture's source filename
+            std::string filename;                       ///< Full path of an image file. Only used when pData is null
+            const uint8_t* pData = nullptr;             ///< The texels, top row first
+            std::shared_ptr<const void> pDataOwner;     ///< Keeps pData alive while the texture is streamed
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t bytesPerPixel = 4;                 ///< 3 or 4. 3-channel texels are expanded to 4 channels
+            ResourceFormat format = ResourceFormat::RGBA8Unorm;
+        };
+
+        /** Create a new streamer
+            \param[in] budget Memory budget of the streamed textures, in bytes
+        */
+        static SharedPtr create(uint64_t budget = kDefaultBudget);
+
+        /** Get the streamer used by the model importers and the scene renderer
+        */
+        static const SharedPtr& getDefault();
+
+        /** Release the default streamer. Called when the device is destroyed
+        */
+        static void shutdown();
+
+        ~TextureStreamer();
+
+        /** Check if textures of a format can be streamed. Only 8-bit RGBA formats are supported
+        */
+        static bool isSupportedFormat(ResourceFormat format);
+
+        /** Create a streamed texture with only its smallest mips resident
+            \param[in] source The texture's top mip
+            \return A new texture, or nullptr if the format isn't supported or the image can't be loaded
+        */
+        Texture::SharedPtr addTexture(const Source& source);
+
+        /** Keep the streamed textures of a material up to date when their texture objects are replaced. Call it once all the textures of the material are set.
+            The material is referenced weakly. Textures which are no longer referenced by materials or by the application are removed from the streamer
+        */
+        void addMaterial(const std::shared_ptr<Material>& pMaterial);
+
+        /** Check if a texture is streamed
+        */
+        bool isStreamed(const Texture* pTexture) const { return mTextureIDs.find(pTexture) != mTextureIDs.end(); }
+
+        /** Request the mips needed to draw a texture in the current frame. Has no effect on textures which aren't streamed
+            \param[in] pTexture The texture
+            \param[in] screenSize Size in pixels of the texture's footprint on the screen, along its largest dimension
+        */
+        void requestTexture(const Texture* pTexture, float screenSize);
+
+        /** Request the mips of all the textures of a material. See requestTexture()
+        */
+        void requestMaterial(const Material* pMaterial, float screenSize);
+
+        /** Upload the loaded mips, evict mips over the budget and start new loads. Call once per frame, before rendering
+        */
+        void update();
+
+        /** Wait for all the pending loads. They are uploaded by the next update()
+        */
+        void waitForLoads() { mpResidency->waitForLoads(); }
+
+        /** Get the residency manager, which controls the budget and keeps the statistics
+        */
+        TextureResidencyManager* getResidencyManager() const { return mpResidency.get(); }
+
+    private:
+        TextureStreamer(uint64_t budget);
+
+        bool readMips(uint32_t id, uint32_t firstMip, uint32_t endMip, std::vector<uint8_t>& data) override;
+        void uploadMips(uint32_t id, uint32_t firstMip, uint32_t endMip, const uint8_t* pData) override;
+        void evictMips(uint32_t id, uint32_t firstMip) override;
+        bool isTextureUsed(uint32_t id) override;
+        void releaseTexture(uint32_t id) override;
+
+        void replaceTexture(uint32_t id, const Texture::SharedPtr& pTexture, uint32_t firstMip);
+
+        struct StreamedTexture
+        {
+            TextureResidencyManager::TextureDesc desc;
+            Texture::SharedPtr pTexture;
+            uint32_t firstMip = 0;                              // The mip of the full chain which is the top mip of pTexture
+            std::vector<std::weak_ptr<Material>> materials;
+        };
+
+        std::vector<StreamedTexture> mTextures;                 // Indexed by the residency manager's IDs
+        std::unordered_map<const Texture*, uint32_t> mTextureIDs;
+
+        std::mutex mSourceMutex;
+        std::vector<std::shared_ptr<const Source>> mSources;   // Read by the loading threads. Guarded by mSourceMutex
+
+        TextureResidencyManager::SharedPtr mpResidency;
+    };
+}
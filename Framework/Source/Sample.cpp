@@ -34,6 +34,7 @@
 #include "Utils/Platform/OS.h"
 #include "API/FBO.h"
 #include "VR/OpenVR/VRSystem.h"
+#include "Graphics/TextureStreamer.h"
 #include "Utils/Platform/ProgressBar.h"
 #include "Utils/StringUtils.h"
 #include "Graphics/FboHelper.h"
@@ -191,6 +192,7 @@ namespace Falcor
 
         RenderPassLibrary::instance().shutdown();
         Scripting::shutdown();
+        TextureStreamer::shutdown();
         mpGui.reset();
         mpDefaultPipelineState.reset();
         mpTargetFBO.reset();
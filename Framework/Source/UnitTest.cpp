@@ -50,6 +50,7 @@ namespace Falcor
             std::string filename, name;
             CPUTestFunc cpuFunc;
             GPUTestFunc gpuFunc;
+            bool isBenchmark;
         };
 
         /** tests is declared as pointer so that we can ensure it can be explicitly
@@ -61,31 +62,32 @@ namespace Falcor
     }   // end anonymous namespace
 
     void registerCPUTest(const std::string& filename, const std::string& name,
-                         CPUTestFunc func)
+                         CPUTestFunc func, bool isBenchmark)
     {
         if (!tests) tests = new std::vector<Test>;
-        tests->push_back({ filename, name, std::move(func), {} });
+        tests->push_back({ filename, name, std::move(func), {}, isBenchmark });
     }
 
     void registerGPUTest(const std::string& filename, const std::string& name,
-                         GPUTestFunc func)
+                         GPUTestFunc func, bool isBenchmark)
     {
         if (!tests) tests = new std::vector<Test>;
-        tests->push_back({ filename, name, {}, std::move(func) });
+        tests->push_back({ filename, name, {}, std::move(func), isBenchmark });
     }
 
-    int32_t runTests(FILE *file, RenderContext *pRenderContext, const std::string &testFilter)
+    int32_t runTests(FILE *file, RenderContext *pRenderContext, const std::string &testFilter, bool runBenchmarks)
     {
         int32_t nFailures = 0;
 
         if (tests == nullptr) return 0;
 
         std::regex testFilterRegex(testFilter, std::regex::icase | std::regex::basic);
-        size_t nTests = std::count_if(tests->begin(), tests->end(),
-            [&testFilterRegex](const Test &test)
+        auto shouldRun = [&](const Test &test)
         {
-            return std::regex_search(test.getTitle(), testFilterRegex);
-        });
+            if (test.isBenchmark && !runBenchmarks) return false;
+            return testFilter.empty() || std::regex_search(test.getTitle(), testFilterRegex);
+        };
+        size_t nTests = std::count_if(tests->begin(), tests->end(), shouldRun);
 
         fprintf(file, "Running %d tests\n", int32_t(nTests));
 
@@ -97,7 +99,7 @@ namespace Falcor
 
         for (const auto& t : *tests)
         {
-            if (!testFilter.empty() && !std::regex_search(t.getTitle(), testFilterRegex)) continue;
+            if (!shouldRun(t)) continue;
 
             auto startTime = std::chrono::steady_clock::now();
             CPUUnitTestContext cpuCtx;
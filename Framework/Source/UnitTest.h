@@ -67,13 +67,15 @@ namespace Falcor
 
     using CPUTestFunc = std::function<void(CPUUnitTestContext& ctx)>;
     void registerCPUTest(const std::string& filename, const std::string& name,
-                         CPUTestFunc func);
+                         CPUTestFunc func, bool isBenchmark = false);
 
     using GPUTestFunc = std::function<void(GPUUnitTestContext& ctx)>;
     void registerGPUTest(const std::string& filename, const std::string& name,
-                         GPUTestFunc func);
+                         GPUTestFunc func, bool isBenchmark = false);
 
-    int32_t runTests(FILE *file, RenderContext* pRenderContext, const std::string& testFilterRegexp);
+    /** Run the registered tests. Benchmarks are timing-only tests and are skipped unless runBenchmarks is set
+    */
+    int32_t runTests(FILE *file, RenderContext* pRenderContext, const std::string& testFilterRegexp, bool runBenchmarks = false);
 
     class UnitTestContext
     {
@@ -222,6 +224,20 @@ namespace Falcor
     } RegisterCPUTest##Name;                                          \
     static void CPUUnitTest##Name(CPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/** Macro to define a CPU benchmark. It works like CPU_TEST, but the test
+    only runs when benchmarks are explicitly requested, since it measures
+    timing rather than checking results.
+*/
+#define CPU_BENCHMARK(Name) \
+    static void CPUUnitTest##Name(CPUUnitTestContext& ctx);           \
+    struct CPUUnitTestRegisterer##Name {                              \
+        CPUUnitTestRegisterer##Name()                                 \
+        {                                                             \
+            registerCPUTest(__FILE__, #Name, CPUUnitTest##Name, true);\
+        }                                                             \
+    } RegisterCPUTest##Name;                                          \
+    static void CPUUnitTest##Name(CPUUnitTestContext& ctx) /* over to the user for the braces */
+
 /** Macro to define a GPU unit test.  It defines an instance of the
     |GPUUnitTestRegisterer| class, which in turn registers the test with
     the test framework when its constructor executes at program startup
@@ -239,6 +255,19 @@ namespace Falcor
     } RegisterGPUTest##Name;                                          \
     static void GPUUnitTest##Name(GPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/** Macro to define a GPU benchmark. It works like GPU_TEST, but only runs
+    when benchmarks are explicitly requested. See CPU_BENCHMARK.
+*/
+#define GPU_BENCHMARK(Name) \
+    static void GPUUnitTest##Name(GPUUnitTestContext& ctx);           \
+    struct GPUUnitTestRegisterer##Name {                              \
+        GPUUnitTestRegisterer##Name()                                 \
+        {                                                             \
+            registerGPUTest(__FILE__, #Name, GPUUnitTest##Name, true);\
+        }                                                             \
+    } RegisterGPUTest##Name;                                          \
+    static void GPUUnitTest##Name(GPUUnitTestContext& ctx) /* over to the user for the braces */
+
 /** Macro definitions for the GPU unit testing framework. Note that they
     are all a single statement (including any additional << printed
     values).  Thus, it's perfectly fine to write code like:
@@ -29,6 +29,7 @@
 #include "glm/vec3.hpp"
 #include "glm/mat4x4.hpp"
 #include "glm/common.hpp"
+#include <vector>
 
 namespace Falcor
 {
@@ -124,4 +125,54 @@ namespace Falcor
             return BoundingBox::fromMinMax(min(bb0.getMinPos(), bb1.getMinPos()), max(bb0.getMaxPos(), bb1.getMaxPos()));
         }
     };
+
+    /** A list of axis-aligned bounding boxes stored as a structure-of-arrays, for batched processing with SIMD instructions
+    */
+    struct BoundingBoxSoA
+    {
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> extentX;
+        std::vector<float> extentY;
+        std::vector<float> extentZ;
+
+        /** Get the number of boxes
+        */
+        size_t size() const { return centerX.size(); }
+
+        /** Remove all the boxes
+        */
+        void clear()
+        {
+            centerX.clear(); centerY.clear(); centerZ.clear();
+            extentX.clear(); extentY.clear(); extentZ.clear();
+        }
+
+        /** Reserve memory for a number of boxes
+        */
+        void reserve(size_t count)
+        {
+            centerX.reserve(count); centerY.reserve(count); centerZ.reserve(count);
+            extentX.reserve(count); extentY.reserve(count); extentZ.reserve(count);
+        }
+
+        /** Append a box to the end of the list
+        */
+        void push_back(const BoundingBox& box)
+        {
+            centerX.push_back(box.center.x); centerY.push_back(box.center.y); centerZ.push_back(box.center.z);
+            extentX.push_back(box.extent.x); extentY.push_back(box.extent.y); extentZ.push_back(box.extent.z);
+        }
+
+        /** Get a box from the list
+        */
+        BoundingBox get(size_t index) const
+        {
+            BoundingBox box;
+            box.center = glm::vec3(centerX[index], centerY[index], centerZ[index]);
+            box.extent = glm::vec3(extentX[index], extentY[index], extentZ[index]);
+            return box;
+        }
+    };
 }
\ No newline at end of file
@@ -0,0 +1,168 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstring>
+#include <vector>
+
+namespace Falcor
+{
+    /** Helper class to read binary data from memory. Matches the reading interface of BinaryFileStream.
+        The stream doesn't own the data, which must outlive the stream.
+    */
+    class BinaryMemoryStream
+    {
+    public:
+        /** Default constructor. Creates an empty stream.
+        */
+        BinaryMemoryStream() {};
+
+        /** Constructor that wraps a memory range
+            \param[in] pData Pointer to the data
+            \param[in] size Size of the data in bytes
+        */
+        BinaryMemoryStream(const void* pData, size_t size) : mpData((const uint8_t*)pData), mSize(size) {}
+
+        /** Skip data in the stream. Advances the stream without reading.
+            \param[in] count Bytes to skip
+        */
+        void skip(size_t count)
+        {
+            if (count > mSize - mOffset)
+            {
+                mOffset = mSize;
+                mEof = true;
+            }
+            else
+            {
+                mOffset += count;
+            }
+        }
+
+        /** Calculates amount of remaining data in the stream.
+            \return Number of bytes remaining in the stream
+        */
+        size_t getRemainingStreamSize() const { return mSize - mOffset; }
+
+        /** Checks for validity of the stream
+            \return Returns true if no errors have been encountered and the end of the stream has not been reached
+        */
+        bool isGood() const { return !mFail && !mEof; }
+
+        /** Checks for stream errors.
+            \return Returns true if any read went past the end of the data.
+        */
+        bool isFail() const { return mFail; }
+
+        /** Checks if the end of the stream has been reached.
+            \return Returns true if a read or skip went past the end of the data
+        */
+        bool isEof() const { return mEof; }
+
+        /** Reads data from the stream. If there isn't enough data left, the remaining bytes are copied and the stream is marked as failed.
+            \param[out] pData Pointer to a buffer to copy/read data into
+            \param[in] count Number of bytes to read
+        */
+        BinaryMemoryStream& read(void* pData, size_t count)
+        {
+            if (count > mSize - mOffset)
+            {
+                count = mSize - mOffset;
+                mFail = true;
+                mEof = true;
+            }
+            if (count) std::memcpy(pData, mpData + mOffset, count);
+            mOffset += count;
+            return *this;
+        }
+
+        /** Get a pointer to the next bytes in the stream and advance past them, without copying. The pointer is valid for as long as the underlying data.
+            \param[in] count Number of bytes to read
+            \return Pointer to the data, or nullptr if there isn't enough data left. In that case the stream is marked as failed.
+        */
+        const void* readSpan(size_t count)
+        {
+            if (count > mSize - mOffset)
+            {
+                mOffset = mSize;
+                mFail = true;
+                mEof = true;
+                return nullptr;
+            }
+            const void* pSpan = mpData + mOffset;
+            mOffset += count;
+            return pSpan;
+        }
+
+        /** Get the current read position in bytes from the start of the data
+        */
+        size_t getOffset() const { return mOffset; }
+
+        /** Extracts a single value from the stream
+            \param[out] val Reference of value to extract into
+        */
+        template<typename T>
+        BinaryMemoryStream& operator>>(T& val) { return read(&val, sizeof(T)); }
+
+    private:
+        const uint8_t* mpData = nullptr;
+        size_t mSize = 0;
+        size_t mOffset = 0;
+        bool mFail = false;
+        bool mEof = false;
+    };
+
+    /** Helper class to write binary data to memory. Data written with it can be read back with BinaryMemoryStream.
+    */
+    class BinaryMemoryWriter
+    {
+    public:
+        /** Append data to the end of the buffer
+            \param[in] pData Pointer to the data
+            \param[in] count Number of bytes to write
+        */
+        BinaryMemoryWriter& write(const void* pData, size_t count)
+        {
+            const uint8_t* pBytes = (const uint8_t*)pData;
+            mData.insert(mData.end(), pBytes, pBytes + count);
+            return *this;
+        }
+
+        /** Write a single value
+            \param[in] val Value to write
+        */
+        template<typename T>
+        BinaryMemoryWriter& operator<<(const T& val) { return write(&val, sizeof(T)); }
+
+        /** Get the data written so far
+        */
+        const std::vector<uint8_t>& getData() const { return mData; }
+
+    private:
+        std::vector<uint8_t> mData;
+    };
+}
@@ -0,0 +1,60 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Hash.h"
+#include <fstream>
+#include <vector>
+
+namespace Falcor
+{
+    uint64_t hashData(const void* pData, size_t size, uint64_t seed)
+    {
+        const uint8_t* pBytes = (const uint8_t*)pData;
+        uint64_t h = seed;
+        for (size_t i = 0; i < size; i++)
+        {
+            h ^= pBytes[i];
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    bool hashFile(const std::string& path, uint64_t& hash)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (file.is_open() == false) return false;
+        std::streamoff size = file.tellg();
+        if (size < 0) return false;
+        std::vector<uint8_t> data((size_t)size);
+        file.seekg(0, std::ios::beg);
+        if (size > 0) file.read((char*)data.data(), size);
+        if (file.good() == false && size > 0) return false;
+        hash = hashData(data.data(), data.size());
+        return true;
+    }
+}
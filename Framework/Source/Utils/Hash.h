@@ -0,0 +1,51 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace Falcor
+{
+    /** The seed of hashData(). Hash multiple ranges by passing the hash of the previous range as the seed of the next one
+    */
+    static const uint64_t kHashSeed = 0xcbf29ce484222325ull;
+
+    /** Hash a memory range. Uses 64-bit FNV-1a. The result is the same on every run and platform, so it can be used to name files in a disk cache
+        \param[in] pData The data to hash
+        \param[in] size The size of the data in bytes
+        \param[in] seed Optional. The hash to continue from, used to hash multiple ranges
+    */
+    uint64_t hashData(const void* pData, size_t size, uint64_t seed = kHashSeed);
+
+    /** Hash the content of a file. See hashData()
+        \param[in] path The file to hash
+        \param[out] hash The hash of the file
+        \return false if the file couldn't be read, otherwise true
+    */
+    bool hashFile(const std::string& path, uint64_t& hash);
+}
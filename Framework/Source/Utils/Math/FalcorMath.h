@@ -65,6 +65,31 @@ namespace Falcor
         return quat;
     }
 
+    /** Calculates transpose(inverse(m)) for an affine matrix, i.e. one whose last row is (0, 0, 0, 1).
+        Much cheaper than the general inverse, the 3x3 part is inverted using cross products.
+        \param[in] m The affine matrix
+        \return The inverse-transpose of m
+    */
+    inline glm::mat4 affineInverseTranspose(const glm::mat4& m)
+    {
+        const glm::vec3 c0(m[0]);
+        const glm::vec3 c1(m[1]);
+        const glm::vec3 c2(m[2]);
+        const glm::vec3 t(m[3]);
+
+        // The rows of the inverse 3x3 are the columns of the inverse-transpose
+        glm::vec3 r0 = glm::cross(c1, c2);
+        glm::vec3 r1 = glm::cross(c2, c0);
+        glm::vec3 r2 = glm::cross(c0, c1);
+        const float invDet = 1.0f / glm::dot(c0, r0);
+        r0 *= invDet;
+        r1 *= invDet;
+        r2 *= invDet;
+
+        // The translation of the inverse, -inverse(m3x3) * t, ends up in the last row
+        return glm::mat4(glm::vec4(r0, -glm::dot(r0, t)), glm::vec4(r1, -glm::dot(r1, t)), glm::vec4(r2, -glm::dot(r2, t)), glm::vec4(0, 0, 0, 1));
+    }
+
     /** Calculates a world-space ray direction from a screen-space mouse pos.
         \param[in] mousePos Normalized coordinates in the range [0, 1] with (0, 0) being the top-left of the screen. Same coordinate space as MouseEvent.
         \param[in] viewMat View matrix from the camera.
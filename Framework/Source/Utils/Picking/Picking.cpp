@@ -181,9 +181,7 @@ namespace Falcor
 
     bool Picking::setPerMeshInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t drawInstanceID)
     {
-        ConstantBuffer* pCB = currentData.pContext->getGraphicsVars()->getConstantBuffer(kPerMeshCbName).get();
-        pCB->setBlob(&currentData.drawID, sDrawIDOffset + drawInstanceID * sizeof(uint32_t), sizeof(uint32_t));
-
+        // The base class stores the draw ID in the instance data
         mDrawIDToInstance[currentData.drawID] = Instance(pModelInstance->shared_from_this(), pMeshInstance->shared_from_this());
 
         return SceneRenderer::setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, drawInstanceID);
@@ -241,6 +241,28 @@ namespace Falcor
         return filename;
     }
 
+    const std::string& getUserCacheDirectory()
+    {
+        static std::string folder;
+        if (folder.size() == 0)
+        {
+            std::string base;
+            if (getEnvironmentVariable("XDG_CACHE_HOME", base) && base.size())
+            {
+                folder = base + "/falcor";
+            }
+            else if (getEnvironmentVariable("HOME", base) && base.size())
+            {
+                folder = base + "/.cache/falcor";
+            }
+            else
+            {
+                folder = getExecutableDirectory();
+            }
+        }
+        return folder;
+    }
+
     bool getEnvironmentVariable(const std::string& varName, std::string& value)
     {
         const char* val = ::getenv(varName.c_str());
@@ -248,8 +270,7 @@ namespace Falcor
         {
             return false;
         }
-        static std::string strvar(val);
-        value = strvar;
+        value = val;
         return true;
     }
 
@@ -0,0 +1,84 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Utils/Platform/MemoryMappedFile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Falcor
+{
+    struct MemoryMappedFileData
+    {
+        void* pMapping = nullptr;
+    };
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        if (mpData && mpData->pMapping)
+        {
+            munmap(mpData->pMapping, mSize);
+        }
+        safe_delete(mpData);
+    }
+
+    bool MemoryMappedFile::platformMap()
+    {
+        int fd = open(mFilename.c_str(), O_RDONLY);
+        if (fd == -1) return false;
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) == -1)
+        {
+            close(fd);
+            return false;
+        }
+
+        mpData = new MemoryMappedFileData;
+        mSize = (size_t)fileStat.st_size;
+        if (mSize)
+        {
+            void* pMapping = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (pMapping == MAP_FAILED)
+            {
+                close(fd);
+                mSize = 0;
+                return false;
+            }
+            // The files are read front to back by the loaders
+            madvise(pMapping, mSize, MADV_SEQUENTIAL);
+            mpData->pMapping = pMapping;
+            mpMappedData = (const uint8_t*)pMapping;
+        }
+
+        // The mapping keeps its own reference to the file
+        close(fd);
+        return true;
+    }
+}
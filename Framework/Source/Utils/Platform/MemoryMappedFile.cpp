@@ -1,5 +1,5 @@
 /***************************************************************************
-# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
 #
 # Redistribution and use in source and binary forms, with or without
 # modification, are permitted provided that the following conditions
@@ -25,29 +25,19 @@
 # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
-#include <thread>
+#include "Framework.h"
+#include "Utils/Platform/MemoryMappedFile.h"
 
-template<uint32_t threadCount>
-class ThreadPool
+namespace Falcor
 {
-public:
-    ~ThreadPool()
+    MemoryMappedFile::SharedPtr MemoryMappedFile::create(const std::string& filename)
     {
-        for (auto& t : mThreads)
+        SharedPtr pFile = SharedPtr(new MemoryMappedFile(filename));
+        if (pFile->platformMap() == false)
         {
-            if (t.joinable()) t.join();
+            logWarning("Can't map file " + filename + " into memory");
+            return nullptr;
         }
+        return pFile;
     }
-
-    std::thread& getAvailable()
-    {
-        std::thread& t = mThreads[mCurrent];
-        if (t.joinable()) t.join();
-        mCurrent = (mCurrent + 1) % arraysize(mThreads);
-        return t;
-    }
-
-private:
-    std::thread mThreads[threadCount];
-    uint32_t mCurrent = 0;
-};
\ No newline at end of file
+}
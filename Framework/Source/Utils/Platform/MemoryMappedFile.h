@@ -0,0 +1,73 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <memory>
+#include <string>
+
+namespace Falcor
+{
+    struct MemoryMappedFileData;
+
+    /** Read-only memory mapping of a file. Pages are loaded by the OS on first access, so no data is copied when the file is opened.
+        The mapped range stays valid for the lifetime of the object.
+    */
+    class MemoryMappedFile
+    {
+    public:
+        using SharedPtr = std::shared_ptr<MemoryMappedFile>;
+
+        /** Map a file into memory.
+            \param[in] filename Full path of the file
+            \return A new object, or nullptr if the file couldn't be opened or mapped
+        */
+        static SharedPtr create(const std::string& filename);
+
+        ~MemoryMappedFile();
+
+        /** Get a pointer to the start of the mapped data. Returns nullptr for empty files.
+        */
+        const uint8_t* getData() const { return mpMappedData; }
+
+        /** Get the size of the file in bytes
+        */
+        size_t getSize() const { return mSize; }
+
+        /** Get the name of the file
+        */
+        const std::string& getFilename() const { return mFilename; }
+
+    private:
+        MemoryMappedFile(const std::string& filename) : mFilename(filename) {}
+        bool platformMap();
+
+        std::string mFilename;
+        const uint8_t* mpMappedData = nullptr;
+        size_t mSize = 0;
+        MemoryMappedFileData* mpData = nullptr;
+    };
+}
@@ -102,8 +102,8 @@ namespace Falcor
 
     bool findFileInDataDirectories(const std::string& filename, std::string& fullpath)
     {
-        static bool bInit = false;
-        if (bInit == false)
+        // Initialized through a static to make it thread-safe, files can be searched from worker threads
+        static const bool bInit = []()
         {
             std::string dataDirs;
             if (getEnvironmentVariable("FALCOR_MEDIA_FOLDERS", dataDirs))
@@ -111,8 +111,9 @@ namespace Falcor
                 auto folders = splitString(dataDirs, ";");
                 gDataDirectories.insert(gDataDirectories.end(), folders.begin(), folders.end());
             }
-            bInit = true;
-        }
+            return true;
+        }();
+        (void)bInit;
 
         // Check if this is an absolute path
         if (doesFileExist(filename))
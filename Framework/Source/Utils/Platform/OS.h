@@ -175,6 +175,11 @@ namespace Falcor
     */
     const std::string& getExecutableName();
 
+    /** Get the per-user directory for data which the application can recreate, such as caches. This is `%LOCALAPPDATA%/Falcor` on Windows and `$XDG_CACHE_HOME/falcor` (or `~/.cache/falcor`) on Linux.
+        If the directory can't be determined, returns the executable directory
+    */
+    const std::string& getUserCacheDirectory();
+
     /** Get the working directory. This can be different from the executable directory (for example, by default when you launch an app from Visual Studio, the working the directory is the directory containing the project file).
     */ 
     const std::string getWorkingDirectory();
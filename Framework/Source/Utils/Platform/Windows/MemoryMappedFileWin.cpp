@@ -0,0 +1,69 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Utils/Platform/MemoryMappedFile.h"
+
+namespace Falcor
+{
+    struct MemoryMappedFileData
+    {
+        HANDLE hFile = INVALID_HANDLE_VALUE;
+        HANDLE hMapping = nullptr;
+    };
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        if (mpData)
+        {
+            if (mpMappedData) UnmapViewOfFile(mpMappedData);
+            if (mpData->hMapping) CloseHandle(mpData->hMapping);
+            if (mpData->hFile != INVALID_HANDLE_VALUE) CloseHandle(mpData->hFile);
+        }
+        safe_delete(mpData);
+    }
+
+    bool MemoryMappedFile::platformMap()
+    {
+        mpData = new MemoryMappedFileData;
+        mpData->hFile = CreateFileA(mFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (mpData->hFile == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(mpData->hFile, &fileSize) == FALSE) return false;
+        mSize = (size_t)fileSize.QuadPart;
+
+        // Mapping an empty file fails, so treat it as a valid file with no data
+        if (mSize == 0) return true;
+
+        mpData->hMapping = CreateFileMappingA(mpData->hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mpData->hMapping == nullptr) return false;
+
+        mpMappedData = (const uint8_t*)MapViewOfFile(mpData->hMapping, FILE_MAP_READ, 0, 0, 0);
+        return mpMappedData != nullptr;
+    }
+}
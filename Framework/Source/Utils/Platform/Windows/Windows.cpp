@@ -36,7 +36,6 @@
 #include <sys/types.h>
 #include "API/Window.h"
 #include "psapi.h"
-#include "Utils/ThreadPool.h"
 #include <future>
 #include <shellscalingapi.h>
 
@@ -151,6 +150,22 @@ namespace Falcor
         return filename;
     }
 
+    const std::string& getUserCacheDirectory()
+    {
+        static std::string folder;
+        if (folder.size() == 0)
+        {
+            PWSTR pPath = nullptr;
+            if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &pPath)))
+            {
+                folder = wstring_2_string(pPath) + "/Falcor";
+            }
+            CoTaskMemFree(pPath);
+            if (folder.size() == 0) folder = getExecutableDirectory();
+        }
+        return folder;
+    }
+
     bool getEnvironmentVariable(const std::string& varName, std::string& value)
     {
         static char buff[4096];
@@ -34,20 +34,28 @@
 #include <fstream>
 #include <sstream>
 #include <cstdio>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <algorithm>
 
 namespace Falcor
 {
     bool gProfileEnabled = false;
 
-    std::map<std::string, Profiler::EventData*> Profiler::sProfilerEvents;
+    std::unordered_map<std::string, Profiler::EventData*> Profiler::sProfilerEvents;
     uint32_t Profiler::sCurrentLevel = 0;
     uint32_t Profiler::sGpuTimerIndex = 0;
     std::vector<Profiler::EventData*> Profiler::sProfilerVector;
+    std::vector<Profiler::EventData*> Profiler::sEventsById;
 
     void Profiler::initNewEvent(EventData *pEvent, const std::string& name)
     {
         pEvent->name = name;
+        pEvent->traceId = registerTraceEvent(name);
         sProfilerEvents[name] = pEvent;
+        if (pEvent->traceId >= sEventsById.size()) sEventsById.resize(pEvent->traceId + 1, nullptr);
+        sEventsById[pEvent->traceId] = pEvent;
     }
 
     Profiler::EventData* Profiler::createNewEvent(const std::string& name)
@@ -69,13 +77,28 @@ namespace Falcor
         return event ? event : createNewEvent(name);
     }
 
+    Profiler::EventData* Profiler::getEvent(EventId id)
+    {
+        EventData* pData = (id < sEventsById.size()) ? sEventsById[id] : nullptr;
+        return pData ? pData : createNewEvent(getTraceEventName(id));
+    }
+
     void Profiler::startEvent(const std::string& name, bool showInMsg)
     {
-        EventData* pData = getEvent(name);
+        startEvent(getEvent(name), showInMsg);
+    }
+
+    void Profiler::startEvent(EventId id, bool showInMsg)
+    {
+        startEvent(getEvent(id), showInMsg);
+    }
+
+    void Profiler::startEvent(EventData* pData, bool showInMsg)
+    {
         pData->triggered++;
         if (pData->triggered > 1)
         {
-            logWarning("Profiler event `" + name + "` was triggered while it is already running. Nesting profiler events with the same name is disallowed and you should probably fix that. Ignoring the new call");
+            logWarning("Profiler event `" + pData->name + "` was triggered while it is already running. Nesting profiler events with the same name is disallowed and you should probably fix that. Ignoring the new call");
             return;
         }
 
@@ -92,14 +115,26 @@ namespace Falcor
         pData->callStack.push(frame.currentTimer);
         frame.currentTimer++;
         sCurrentLevel++;
+        beginTraceEvent(pData->traceId);
     }
 
     void Profiler::endEvent(const std::string& name)
     {
-        EventData* pData = getEvent(name);
+        endEvent(getEvent(name));
+    }
+
+    void Profiler::endEvent(EventId id)
+    {
+        // The events might have been cleared while the event was running
+        if (id < sEventsById.size() && sEventsById[id]) endEvent(sEventsById[id]);
+    }
+
+    void Profiler::endEvent(EventData* pData)
+    {
         pData->triggered--;
         if (pData->triggered != 0) return;
 
+        endTraceEvent(pData->traceId);
         pData->cpuEnd = CpuTimer::getCurrentTimePoint();
         pData->cpuTotal += CpuTimer::calcDuration(pData->cpuStart, pData->cpuEnd);
 
@@ -209,13 +244,313 @@ namespace Falcor
 
     void Profiler::clearEvents()
     {
-        for (EventData* pData : sProfilerVector)
+        // The frame vector only holds the events which ran this frame, and can hold an event more than once
+        for (auto& it : sProfilerEvents)
         {
-            delete pData;
+            delete it.second;
         }
         sProfilerEvents.clear();
+        sEventsById.clear();
         sProfilerVector.clear();
         sCurrentLevel = 0;
         sGpuTimerIndex = 0;
     }
+
+    namespace
+    {
+        struct TraceRecord
+        {
+            uint64_t timeNs;
+            Profiler::EventId id;
+            uint32_t isBegin;
+        };
+
+        /** A ring-buffer slot. The fields are atomics so that a reader can copy a slot while the owning thread overwrites it, the reader then uses the write head to discard torn copies
+        */
+        struct TraceSlot
+        {
+            std::atomic<uint64_t> timeNs{ 0 };
+            std::atomic<uint32_t> id{ 0 };
+            std::atomic<uint32_t> isBegin{ 0 };
+        };
+
+        /** Per-thread ring-buffer. Only the owning thread writes records, readers use the head to find the valid range.
+            The writer announces the record it is about to overwrite in writeHead before touching the slot, and publishes it in head once written.
+            Buffers are never freed, since the records are needed for export after the thread exits.
+        */
+        struct ThreadTrace
+        {
+            ThreadTrace(uint32_t capacity, uint32_t index) : records(capacity), mask(capacity - 1), threadIndex(index) {}
+            std::vector<TraceSlot> records;
+            const uint64_t mask;
+            const uint32_t threadIndex;
+            std::atomic<uint64_t> head{ 0 };        // Number of records written
+            std::atomic<uint64_t> writeHead{ 0 };   // Number of records started. Slots of records before writeHead - capacity may have been overwritten
+            uint64_t readStart = 0;     // Records before this were discarded by clearTrace(). Protected by the trace mutex
+            std::string name;           // Protected by the trace mutex
+            bool inUse = true;          // Protected by the trace mutex
+        };
+
+        struct TraceState
+        {
+            std::mutex mutex;
+            std::atomic<bool> enabled{ false };
+            uint32_t bufferSize = 64 * 1024;
+            std::unordered_map<std::string, Profiler::EventId> ids;
+            std::deque<std::string> names;
+            std::vector<std::unique_ptr<ThreadTrace>> threads;
+            const CpuTimer::TimePoint origin = CpuTimer::getCurrentTimePoint();
+        };
+
+        TraceState& getTraceState()
+        {
+            static TraceState state;
+            return state;
+        }
+
+        /** Releases the ring-buffer of a thread when the thread exits. The records are kept and the buffer is reused by the next thread, so that short-lived threads don't allocate a new buffer each time
+        */
+        struct ThreadTraceOwner
+        {
+            ThreadTrace* pTrace = nullptr;
+            ~ThreadTraceOwner()
+            {
+                if (pTrace == nullptr) return;
+                std::lock_guard<std::mutex> lock(getTraceState().mutex);
+                pTrace->inUse = false;
+            }
+        };
+
+        thread_local ThreadTraceOwner tlThreadTrace;
+
+        ThreadTrace* getThreadTrace()
+        {
+            if (tlThreadTrace.pTrace == nullptr)
+            {
+                TraceState& state = getTraceState();
+                std::lock_guard<std::mutex> lock(state.mutex);
+                for (auto& pTrace : state.threads)
+                {
+                    if (pTrace->inUse == false && pTrace->records.size() == state.bufferSize)
+                    {
+                        pTrace->inUse = true;
+                        pTrace->name.clear();
+                        tlThreadTrace.pTrace = pTrace.get();
+                        return tlThreadTrace.pTrace;
+                    }
+                }
+                state.threads.push_back(std::make_unique<ThreadTrace>(state.bufferSize, (uint32_t)state.threads.size()));
+                tlThreadTrace.pTrace = state.threads.back().get();
+            }
+            return tlThreadTrace.pTrace;
+        }
+
+        void recordTraceEvent(Profiler::EventId id, bool isBegin)
+        {
+            TraceState& state = getTraceState();
+            if (state.enabled.load(std::memory_order_relaxed) == false || id == Profiler::kInvalidEventId) return;
+
+            ThreadTrace* pTrace = getThreadTrace();
+            uint64_t head = pTrace->head.load(std::memory_order_relaxed);
+            uint64_t timeNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(CpuTimer::getCurrentTimePoint() - state.origin).count();
+
+            // Announce the overwrite before writing the slot, so that a concurrent reader can tell its copy is stale
+            pTrace->writeHead.store(head + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            TraceSlot& slot = pTrace->records[head & pTrace->mask];
+            slot.timeNs.store(timeNs, std::memory_order_relaxed);
+            slot.id.store(id, std::memory_order_relaxed);
+            slot.isBegin.store(isBegin ? 1 : 0, std::memory_order_relaxed);
+            pTrace->head.store(head + 1, std::memory_order_release);
+        }
+
+        std::string escapeJson(const std::string& str)
+        {
+            std::string out;
+            for (char c : str)
+            {
+                switch (c)
+                {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if ((unsigned char)c < 0x20)
+                    {
+                        char buf[8];
+                        snprintf(buf, sizeof(buf), "\\u%04x", c);
+                        out += buf;
+                    }
+                    else out += c;
+                }
+            }
+            return out;
+        }
+    }
+
+    Profiler::EventId Profiler::registerTraceEvent(const std::string& name)
+    {
+        TraceState& state = getTraceState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto it = state.ids.find(name);
+        if (it != state.ids.end()) return it->second;
+
+        EventId id = (EventId)state.names.size();
+        state.names.push_back(name);
+        state.ids[name] = id;
+        return id;
+    }
+
+    std::string Profiler::getTraceEventName(EventId id)
+    {
+        TraceState& state = getTraceState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return id < state.names.size() ? state.names[id] : std::string();
+    }
+
+    void Profiler::setTraceEnabled(bool enabled)
+    {
+        getTraceState().enabled = enabled;
+    }
+
+    bool Profiler::isTraceEnabled()
+    {
+        return getTraceState().enabled;
+    }
+
+    void Profiler::setTraceBufferSize(uint32_t recordCount)
+    {
+        // Round up to a power of 2 so that the ring-buffer index is a mask
+        uint32_t size = 1;
+        while (size < recordCount && size < 0x80000000u) size <<= 1;
+        TraceState& state = getTraceState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.bufferSize = size;
+    }
+
+    void Profiler::setThreadName(const std::string& name)
+    {
+        ThreadTrace* pTrace = getThreadTrace();
+        std::lock_guard<std::mutex> lock(getTraceState().mutex);
+        pTrace->name = name;
+    }
+
+    void Profiler::beginTraceEvent(EventId id)
+    {
+        recordTraceEvent(id, true);
+    }
+
+    void Profiler::endTraceEvent(EventId id)
+    {
+        recordTraceEvent(id, false);
+    }
+
+    void Profiler::clearTrace()
+    {
+        TraceState& state = getTraceState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (auto& pTrace : state.threads)
+        {
+            pTrace->readStart = pTrace->head.load(std::memory_order_acquire);
+        }
+    }
+
+    std::vector<Profiler::TraceEvent> Profiler::getTraceEvents()
+    {
+        TraceState& state = getTraceState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        std::vector<TraceEvent> events;
+        std::vector<TraceRecord> records;
+        std::vector<TraceRecord> stack;
+
+        for (auto& pTrace : state.threads)
+        {
+            // Copy the valid range, then drop the records which the owning thread started overwriting while we were copying
+            const uint64_t capacity = pTrace->records.size();
+            uint64_t head = pTrace->head.load(std::memory_order_acquire);
+            uint64_t start = std::max(pTrace->readStart, head > capacity ? head - capacity : 0);
+            records.clear();
+            for (uint64_t i = start; i < head; i++)
+            {
+                const TraceSlot& slot = pTrace->records[i & pTrace->mask];
+                TraceRecord r;
+                r.timeNs = slot.timeNs.load(std::memory_order_relaxed);
+                r.id = slot.id.load(std::memory_order_relaxed);
+                r.isBegin = slot.isBegin.load(std::memory_order_relaxed);
+                records.push_back(r);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t writeHead = pTrace->writeHead.load(std::memory_order_relaxed);
+            uint64_t overwritten = writeHead > capacity ? writeHead - capacity : 0;
+            size_t first = overwritten > start ? (size_t)std::min<uint64_t>(overwritten - start, records.size()) : 0;
+
+            // Match the begin and end records. Ends without a begin are records whose begin was overwritten
+            size_t threadFirstEvent = events.size();
+            stack.clear();
+            for (size_t i = first; i < records.size(); i++)
+            {
+                const TraceRecord& r = records[i];
+                if (r.isBegin)
+                {
+                    stack.push_back(r);
+                    continue;
+                }
+
+                auto it = std::find_if(stack.rbegin(), stack.rend(), [&r](const TraceRecord& b) { return b.id == r.id; });
+                if (it == stack.rend()) continue;
+                stack.erase(std::prev(it.base()), stack.end());
+
+                TraceEvent e;
+                e.id = r.id;
+                e.threadIndex = pTrace->threadIndex;
+                e.depth = (uint32_t)stack.size();
+                e.startUs = (double)it->timeNs * 1e-3;
+                e.durationUs = (double)(r.timeNs - it->timeNs) * 1e-3;
+                events.push_back(e);
+            }
+
+            // Events are completed in end order, sort them by start time
+            std::stable_sort(events.begin() + threadFirstEvent, events.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.startUs < b.startUs; });
+        }
+        return events;
+    }
+
+    std::string Profiler::getChromeTrace()
+    {
+        std::vector<TraceEvent> events = getTraceEvents();
+        TraceState& state = getTraceState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        std::ostringstream json;
+        json.precision(3);
+        json << std::fixed;
+        json << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (const auto& pTrace : state.threads)
+        {
+            std::string name = pTrace->name.size() ? pTrace->name : "Thread " + std::to_string(pTrace->threadIndex);
+            json << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pTrace->threadIndex << ",\"args\":{\"name\":\"" << escapeJson(name) << "\"}}";
+            first = false;
+        }
+        for (const auto& e : events)
+        {
+            json << (first ? "" : ",\n") << "{\"name\":\"" << escapeJson(state.names[e.id]) << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.threadIndex << ",\"ts\":" << e.startUs << ",\"dur\":" << e.durationUs << "}";
+            first = false;
+        }
+        json << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        return json.str();
+    }
+
+    bool Profiler::exportChromeTrace(const std::string& filename)
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (file.is_open() == false)
+        {
+            logWarning("Profiler::exportChromeTrace() - can't open file '" + filename + "'");
+            return false;
+        }
+        file << getChromeTrace();
+        return file.good();
+    }
 }
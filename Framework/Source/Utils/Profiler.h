@@ -27,7 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include <string>
-#include <map>
+#include <unordered_map>
 #include <functional>
 #include <vector>
 #include "API/GpuTimer.h"
@@ -45,10 +45,29 @@ namespace Falcor
         This class uses the most accurately available CPU and GPU timers to profile given events. It automatically creates event hierarchies based on the order of the calls made.
         This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
         ProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
+
+        The frame events (startEvent()/endEvent()) must only be used from the main thread. In addition, the profiler contains a CPU trace recorder which can be used from any thread.
+        Trace events are identified by an interned ID, and each thread records into its own ring-buffer without taking locks. The trace can be exported to the Chrome trace-event format
+        (chrome://tracing). Frame events are recorded into the trace as well.
     */
     class Profiler
     {
     public:
+        /** Interned trace event identifier
+        */
+        using EventId = uint32_t;
+        static const EventId kInvalidEventId = (EventId)-1;
+
+        /** A completed trace event, as returned by getTraceEvents()
+        */
+        struct TraceEvent
+        {
+            EventId id;             ///< The event ID
+            uint32_t threadIndex;   ///< Index of the ring-buffer the event was recorded into. A buffer is owned by one thread at a time, and is reused after the thread exits
+            uint32_t depth;         ///< Nesting level of the event in its thread
+            double startUs;         ///< Start time in microseconds, relative to the first recorded event of the process
+            double durationUs;      ///< Duration in microseconds
+        };
 
 #if _PROFILING_LOG == 1
         static void flushLog();
@@ -71,6 +90,7 @@ namespace Falcor
             float cpuTotal = 0;
             uint32_t level;
             uint32_t triggered = 0;
+            EventId traceId = kInvalidEventId;
 #if _PROFILING_LOG == 1
             int stepNr = 0;
             int filesWritten = 0;
@@ -84,11 +104,20 @@ namespace Falcor
         */
         static void startEvent(const std::string& name, bool showInMsg = true);
 
+        /** Start profiling an event without looking up its name.
+            \param[in] id The ID of the event name, as returned by registerTraceEvent(). IDs stay valid after clearEvents()
+        */
+        static void startEvent(EventId id, bool showInMsg = true);
+
         /** Finish profiling a new event and update the events hierarchies.
             \param[in] name The event name.
         */
         static void endEvent(const std::string& name);
 
+        /** Finish profiling an event started by ID. Does nothing if the events were cleared since the event started
+        */
+        static void endEvent(EventId id);
+
         /** Finish profiling for the entire frame.
             Due to the double-buffering nature of the profiler, the results returned are for the previous frame.
             \param[out] profileResults A string containing the the profiling results.
@@ -116,6 +145,10 @@ namespace Falcor
         */
         static EventData* getEvent(const std::string& name);
 
+        /** Get the event of a name ID, or create a new one if the event does not yet exist.
+        */
+        static EventData* getEvent(EventId id);
+
         /** Get the event, or create a new one if the event does not yet exist.
         This is a public interface to facilitate more complicated construction of event names and finegrained control over the profiled region.
         */
@@ -136,11 +169,66 @@ namespace Falcor
         */
         static void clearEvents();
 
+        /** Get the ID of a trace event, registering the name if it wasn't registered before. This is the only trace function which looks up strings, the ID should be cached by the caller
+            \param[in] name The event name
+        */
+        static EventId registerTraceEvent(const std::string& name);
+
+        /** Get the name of a trace event
+        */
+        static std::string getTraceEventName(EventId id);
+
+        /** Enable or disable the trace recorder. It is disabled by default
+        */
+        static void setTraceEnabled(bool enabled);
+
+        /** Check if the trace recorder is enabled
+        */
+        static bool isTraceEnabled();
+
+        /** Set the number of records in the ring-buffer of each thread. Once the ring-buffer is full, the oldest records are overwritten.
+            Only affects threads which didn't record any events yet.
+        */
+        static void setTraceBufferSize(uint32_t recordCount);
+
+        /** Set the name of the calling thread, as shown in the exported trace
+        */
+        static void setThreadName(const std::string& name);
+
+        /** Record the beginning of a trace event on the calling thread. Doesn't lock or allocate, except for the first event recorded by a thread
+        */
+        static void beginTraceEvent(EventId id);
+
+        /** Record the end of a trace event on the calling thread. Events must be ended in the reverse order they began
+        */
+        static void endTraceEvent(EventId id);
+
+        /** Discard all recorded trace events
+        */
+        static void clearTrace();
+
+        /** Get the completed trace events of all threads, sorted by thread and start time. Events which are still running or whose start was overwritten are not returned.
+            Can be called while other threads are recording. Records which are overwritten while this function runs are dropped, so for complete results it's better to call it when the other threads are idle.
+        */
+        static std::vector<TraceEvent> getTraceEvents();
+
+        /** Get the trace in Chrome's trace-event JSON format
+        */
+        static std::string getChromeTrace();
+
+        /** Write the trace to a file in Chrome's trace-event JSON format
+            \return false if the file couldn't be written, otherwise true
+        */
+        static bool exportChromeTrace(const std::string& filename);
+
     private:
         static double getGpuTime(const EventData* pData);
         static double getCpuTime(const EventData* pData);
+        static void startEvent(EventData* pData, bool showInMsg);
+        static void endEvent(EventData* pData);
 
-        static std::map<std::string, EventData*> sProfilerEvents;
+        static std::unordered_map<std::string, EventData*> sProfilerEvents;
+        static std::vector<EventData*> sEventsById;     ///< The events indexed by the ID of their name, nullptr for names without an event
         static std::vector<EventData*> sProfilerVector;
         static uint32_t sCurrentLevel;
         static uint32_t sGpuTimerIndex;
@@ -155,18 +243,41 @@ namespace Falcor
     public:
         /** C'tor
         */
-        ProfilerEvent(const std::string& name) : mName(name) { if(gProfileEnabled) { Profiler::startEvent(name); } }
+        ProfilerEvent(const std::string& name) { if(gProfileEnabled) { mId = Profiler::registerTraceEvent(name); Profiler::startEvent(mId); } }
+        /** C'tor. The ID is returned by Profiler::registerTraceEvent()
+        */
+        ProfilerEvent(Profiler::EventId id) { if(gProfileEnabled) { mId = id; Profiler::startEvent(mId); } }
+        /** D'tor
+        */
+        ~ProfilerEvent() { if(mId != Profiler::kInvalidEventId) { Profiler::endEvent(mId); }}
+
+    private:
+        Profiler::EventId mId = Profiler::kInvalidEventId;
+    };
+
+    /** Helper class for recording trace events. Can be used from any thread.
+        The PROFILE_CPU macro registers the event name once and creates a local ProfilerTraceEvent object.
+    */
+    class ProfilerTraceEvent
+    {
+    public:
+        /** C'tor
+        */
+        ProfilerTraceEvent(Profiler::EventId id) : mId(id) { Profiler::beginTraceEvent(id); }
         /** D'tor
         */
-        ~ProfilerEvent() { if(gProfileEnabled) {Profiler::endEvent(mName); }}
+        ~ProfilerTraceEvent() { Profiler::endTraceEvent(mId); }
 
     private:
-        const std::string mName;
+        const Profiler::EventId mId;
     };
 
+// Both macros register the name once per call site, so the name must be the same on every call
 #if _PROFILING_ENABLED
-#define PROFILE(_name) Falcor::ProfilerEvent _profileEvent##__LINE__(_name);
+#define PROFILE(_name) static const Falcor::Profiler::EventId concat_strings(_profileEventId, __LINE__) = Falcor::Profiler::registerTraceEvent(_name); Falcor::ProfilerEvent concat_strings(_profileEvent, __LINE__)(concat_strings(_profileEventId, __LINE__));
+#define PROFILE_CPU(_name) static const Falcor::Profiler::EventId concat_strings(_traceEventId, __LINE__) = Falcor::Profiler::registerTraceEvent(_name); Falcor::ProfilerTraceEvent concat_strings(_traceEvent, __LINE__)(concat_strings(_traceEventId, __LINE__));
 #else
 #define PROFILE(_name)
+#define PROFILE_CPU(_name)
 #endif
 }
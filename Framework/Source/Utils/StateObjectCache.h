@@ -0,0 +1,215 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Utils/CpuTimer.h"
+
+namespace Falcor
+{
+    /** Hash-based cache of immutable state objects, such as GraphicsStateObject.
+        Objects are looked up by their descriptor in O(1). StateObjectType::Desc must provide a `uint64_t getHash() const` which is consistent with its `operator==`.
+        The cache can be prewarmed with a list of descriptors, for example the list returned by getDescs() in a previous session, so that the objects aren't created in the middle of a frame.
+        Lookups and insertions are thread-safe. Objects are created outside the lock, so prewarming can run on a worker thread while the cache is in use.
+        The cache never evicts objects on its own, and the descriptors hold strong references to the resources they use. Call removeIf() when releasing those resources,
+        otherwise the cache keeps them alive. For example, a Program removes the graphics state objects which use its versions when it's destroyed or reloaded.
+    */
+    template<typename StateObjectType>
+    class StateObjectCache
+    {
+    public:
+        using SharedPtr = std::shared_ptr<StateObjectCache>;
+        using Desc = typename StateObjectType::Desc;
+        using ObjectPtr = typename StateObjectType::SharedPtr;
+        using CreateFunc = std::function<ObjectPtr(const Desc&)>;
+
+        /** Cache statistics
+        */
+        struct Stats
+        {
+            uint64_t hits = 0;          ///< Number of lookups which found an existing object
+            uint64_t misses = 0;        ///< Number of lookups which had to create a new object
+            uint64_t prewarmed = 0;     ///< Number of objects created by prewarm()
+            uint64_t failed = 0;        ///< Number of objects which couldn't be created
+            double missTimeMs = 0;      ///< Total time spent creating objects on misses, excluding prewarming
+        };
+
+        /** Create a new cache
+            \param[in] createFunc Optional. The function used to create new objects. By default, StateObjectType::create() is used
+        */
+        static SharedPtr create(CreateFunc createFunc = nullptr)
+        {
+            return SharedPtr(new StateObjectCache(createFunc ? createFunc : CreateFunc(&StateObjectType::create)));
+        }
+
+        /** Get the object matching a descriptor. If it doesn't exist, a new object will be created and added to the cache
+            \return The object, or nullptr if it couldn't be created
+        */
+        ObjectPtr getObject(const Desc& desc)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                auto it = mObjects.find(desc);
+                if (it != mObjects.end())
+                {
+                    mStats.hits++;
+                    return it->second;
+                }
+            }
+
+            auto start = CpuTimer::getCurrentTimePoint();
+            ObjectPtr pObject = mCreateFunc(desc);
+            double timeMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.misses++;
+            mStats.missTimeMs += timeMs;
+            return insert(desc, pObject);
+        }
+
+        /** Find the object matching a descriptor, without creating it. Doesn't affect the statistics
+            \return The object, or nullptr if it's not in the cache
+        */
+        ObjectPtr findObject(const Desc& desc) const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mObjects.find(desc);
+            return (it == mObjects.end()) ? nullptr : it->second;
+        }
+
+        /** Create the objects for a list of descriptors. Descriptors which are already in the cache are skipped
+            \return The number of objects created
+        */
+        uint32_t prewarm(const std::vector<Desc>& descs)
+        {
+            uint32_t created = 0;
+            for (const auto& desc : descs)
+            {
+                if (findObject(desc)) continue;
+                ObjectPtr pObject = mCreateFunc(desc);
+
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (insert(desc, pObject) == pObject && pObject)
+                {
+                    mStats.prewarmed++;
+                    created++;
+                }
+            }
+            return created;
+        }
+
+        /** Get the descriptors of all the cached objects. Can be passed to prewarm()
+        */
+        std::vector<Desc> getDescs() const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            std::vector<Desc> descs;
+            descs.reserve(mObjects.size());
+            for (const auto& o : mObjects) descs.push_back(o.first);
+            return descs;
+        }
+
+        /** Get the number of cached objects
+        */
+        uint32_t getObjectCount() const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return (uint32_t)mObjects.size();
+        }
+
+        /** Release the cached objects whose descriptor matches a predicate, for example the objects which use a resource that is being released
+            \return The number of objects released
+        */
+        uint32_t removeIf(const std::function<bool(const Desc&)>& predicate)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            uint32_t removed = 0;
+            for (auto it = mObjects.begin(); it != mObjects.end();)
+            {
+                if (predicate(it->first))
+                {
+                    it = mObjects.erase(it);
+                    removed++;
+                }
+                else it++;
+            }
+            return removed;
+        }
+
+        /** Release all the cached objects
+        */
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mObjects.clear();
+        }
+
+        /** Get the cache statistics
+        */
+        Stats getStats() const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mStats;
+        }
+
+        /** Reset the cache statistics
+        */
+        void resetStats()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats = Stats();
+        }
+
+    private:
+        StateObjectCache(const CreateFunc& createFunc) : mCreateFunc(createFunc) {}
+
+        struct DescHash
+        {
+            size_t operator()(const Desc& desc) const { return (size_t)desc.getHash(); }
+        };
+
+        // Must be called with the mutex locked. If another thread already created the object, the existing object is returned. Failed objects aren't cached
+        ObjectPtr insert(const Desc& desc, const ObjectPtr& pObject)
+        {
+            if (pObject == nullptr)
+            {
+                mStats.failed++;
+                return nullptr;
+            }
+            return mObjects.emplace(desc, pObject).first->second;
+        }
+
+        CreateFunc mCreateFunc;
+        std::unordered_map<Desc, ObjectPtr, DescHash> mObjects;
+        Stats mStats;
+        mutable std::mutex mMutex;
+    };
+}
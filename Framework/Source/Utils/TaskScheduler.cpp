@@ -0,0 +1,355 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TaskScheduler.h"
+#include "Utils/Profiler.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    struct TaskScheduler::TaskNode
+    {
+        Task task;
+        TaskGroup* pGroup = nullptr;
+        std::exception_ptr pException;  // Written before done is set
+        std::atomic<uint32_t> pendingDependencies{ 1 };
+        std::atomic<bool> done{ false };
+        std::mutex mutex;   // Protects continuations and the transition to done
+        std::vector<std::shared_ptr<TaskNode>> continuations;
+    };
+
+    namespace
+    {
+        struct WorkerContext
+        {
+            const TaskScheduler* pScheduler = nullptr;
+            uint32_t index = uint32_t(-1);
+            bool named = false;
+        };
+        thread_local WorkerContext tlWorker;
+    }
+
+    bool TaskScheduler::TaskHandle::isDone() const
+    {
+        return mpNode == nullptr || mpNode->done.load(std::memory_order_acquire);
+    }
+
+    TaskScheduler::SharedPtr TaskScheduler::create(uint32_t workerCount)
+    {
+        return SharedPtr(new TaskScheduler(workerCount));
+    }
+
+    const TaskScheduler::SharedPtr& TaskScheduler::getDefault()
+    {
+        static SharedPtr pDefault = create(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pDefault;
+    }
+
+    TaskScheduler::TaskScheduler(uint32_t workerCount)
+    {
+        for (uint32_t i = 0; i < workerCount; i++) mQueues.push_back(std::make_unique<WorkerQueue>());
+        for (uint32_t i = 0; i < workerCount; i++) mWorkers.emplace_back(&TaskScheduler::workerLoop, this, i);
+    }
+
+    TaskScheduler::~TaskScheduler()
+    {
+        // Finish the pending work
+        waitUntil([this]() { return mUnfinishedTasks.load() == 0; });
+
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+            mStop = true;
+        }
+        mWakeCondition.notify_all();
+        for (auto& t : mWorkers) t.join();
+    }
+
+    uint32_t TaskScheduler::getCurrentWorkerIndex() const
+    {
+        return tlWorker.pScheduler == this ? tlWorker.index : uint32_t(-1);
+    }
+
+    std::shared_ptr<TaskScheduler::TaskNode> TaskScheduler::createNode(Task task, TaskGroup* pGroup)
+    {
+        auto pNode = std::make_shared<TaskNode>();
+        pNode->task = std::move(task);
+        pNode->pGroup = pGroup;
+        if (pGroup) pGroup->mPending.fetch_add(1);
+        mUnfinishedTasks.fetch_add(1);
+        return pNode;
+    }
+
+    void TaskScheduler::enqueue(const std::shared_ptr<TaskNode>& pNode)
+    {
+        // Workers push to their own queue, other threads to the shared queue
+        uint32_t index = getCurrentWorkerIndex();
+        WorkerQueue& queue = (index < mQueues.size()) ? *mQueues[index] : mSharedQueue;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(pNode);
+        }
+
+        mQueuedTasks.fetch_add(1);
+        if (mSleepingWorkers.load() > 0 || mWaitingThreads.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+            mWakeCondition.notify_one();
+            mWaitCondition.notify_all();
+        }
+    }
+
+    void TaskScheduler::schedule(const std::shared_ptr<TaskNode>& pNode, const std::vector<TaskHandle>& dependencies)
+    {
+        // The node starts with one extra pending dependency, which is released once all the dependencies were registered
+        for (const auto& d : dependencies)
+        {
+            if (d.mpNode == nullptr) continue;
+            std::lock_guard<std::mutex> lock(d.mpNode->mutex);
+            if (d.mpNode->done == false)
+            {
+                pNode->pendingDependencies.fetch_add(1);
+                d.mpNode->continuations.push_back(pNode);
+            }
+        }
+
+        if (pNode->pendingDependencies.fetch_sub(1) == 1) enqueue(pNode);
+    }
+
+    std::shared_ptr<TaskScheduler::TaskNode> TaskScheduler::dequeue()
+    {
+        if (mQueuedTasks.load() == 0) return nullptr;
+
+        auto popFront = [](WorkerQueue& queue) -> std::shared_ptr<TaskNode>
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) return nullptr;
+            auto pNode = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return pNode;
+        };
+
+        std::shared_ptr<TaskNode> pNode;
+        uint32_t index = getCurrentWorkerIndex();
+        uint32_t queueCount = (uint32_t)mQueues.size();
+
+        // Own queue first, LIFO for cache locality
+        if (index < queueCount)
+        {
+            WorkerQueue& queue = *mQueues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.size())
+            {
+                pNode = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+        }
+
+        // Then the shared queue, then steal the oldest task of another worker
+        if (pNode == nullptr) pNode = popFront(mSharedQueue);
+        for (uint32_t i = 1; pNode == nullptr && i <= queueCount; i++)
+        {
+            uint32_t victim = (index < queueCount) ? (index + i) % queueCount : (i - 1);
+            pNode = popFront(*mQueues[victim]);
+        }
+
+        if (pNode) mQueuedTasks.fetch_sub(1);
+        return pNode;
+    }
+
+    void TaskScheduler::execute(const std::shared_ptr<TaskNode>& pNode)
+    {
+        // Don't let an exception escape, it would terminate a worker or leave the counters unbalanced
+        try
+        {
+            pNode->task();
+        }
+        catch (...)
+        {
+            pNode->pException = std::current_exception();
+            if (pNode->pGroup)
+            {
+                std::lock_guard<std::mutex> lock(pNode->pGroup->mExceptionMutex);
+                if (pNode->pGroup->mpException == nullptr) pNode->pGroup->mpException = pNode->pException;
+            }
+        }
+        pNode->task = nullptr;
+
+        std::vector<std::shared_ptr<TaskNode>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(pNode->mutex);
+            pNode->done.store(true, std::memory_order_release);
+            continuations.swap(pNode->continuations);
+        }
+
+        for (const auto& pNext : continuations)
+        {
+            if (pNext->pendingDependencies.fetch_sub(1) == 1) enqueue(pNext);
+        }
+
+        if (pNode->pGroup) pNode->pGroup->mPending.fetch_sub(1, std::memory_order_release);
+        mUnfinishedTasks.fetch_sub(1, std::memory_order_release);
+
+        // Pairs with the fence in waitUntil(), so that either we see the waiter or the waiter sees the task finished
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mWaitingThreads.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+            mWaitCondition.notify_all();
+        }
+    }
+
+    bool TaskScheduler::runPendingTask()
+    {
+        std::shared_ptr<TaskNode> pNode = dequeue();
+        if (pNode == nullptr) return false;
+        execute(pNode);
+        return true;
+    }
+
+    void TaskScheduler::workerLoop(uint32_t index)
+    {
+        tlWorker.pScheduler = this;
+        tlWorker.index = index;
+
+        while (true)
+        {
+            if (tlWorker.named == false && Profiler::isTraceEnabled())
+            {
+                Profiler::setThreadName("Task worker " + std::to_string(index));
+                tlWorker.named = true;
+            }
+
+            if (runPendingTask()) continue;
+
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            mSleepingWorkers.fetch_add(1);
+            mWakeCondition.wait(lock, [this]() { return mStop.load() || mQueuedTasks.load() > 0; });
+            mSleepingWorkers.fetch_sub(1);
+            if (mStop) break;
+        }
+    }
+
+    TaskScheduler::TaskHandle TaskScheduler::submit(Task task, const std::vector<TaskHandle>& dependencies)
+    {
+        auto pNode = createNode(std::move(task), nullptr);
+        schedule(pNode, dependencies);
+        return TaskHandle(pNode);
+    }
+
+    void TaskScheduler::waitUntil(const std::function<bool()>& isDone)
+    {
+        while (isDone() == false)
+        {
+            if (runPendingTask()) continue;
+
+            // Nothing to run, the remaining tasks are running on other threads. Sleep until one of them finishes or a new task is queued
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            mWaitingThreads.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            mWaitCondition.wait(lock, [this, &isDone]() { return isDone() || mQueuedTasks.load() > 0; });
+            mWaitingThreads.fetch_sub(1);
+        }
+    }
+
+    void TaskScheduler::wait(const TaskHandle& handle)
+    {
+        if (handle.mpNode == nullptr) return;
+        waitUntil([&handle]() { return handle.isDone(); });
+        if (handle.mpNode->pException) std::rethrow_exception(handle.mpNode->pException);
+    }
+
+    void TaskScheduler::parallelForRange(uint32_t begin, uint32_t end, const std::function<void(uint32_t, uint32_t)>& fn, uint32_t grainSize)
+    {
+        if (begin >= end) return;
+        uint32_t count = end - begin;
+        if (grainSize == 0)
+        {
+            uint32_t taskCount = (getWorkerCount() + 1) * 4;
+            grainSize = std::max(1u, (count + taskCount - 1) / taskCount);
+        }
+
+        if (count <= grainSize)
+        {
+            fn(begin, end);
+            return;
+        }
+
+        // Submit all the ranges but the first one, which the calling thread runs itself
+        TaskGroup group(this);
+        for (uint32_t rangeBegin = begin + grainSize; rangeBegin < end; rangeBegin += std::min(grainSize, end - rangeBegin))
+        {
+            uint32_t rangeEnd = rangeBegin + std::min(grainSize, end - rangeBegin);
+            group.run([&fn, rangeBegin, rangeEnd]() { fn(rangeBegin, rangeEnd); });
+        }
+        fn(begin, begin + grainSize);
+        group.wait();
+    }
+
+    void TaskScheduler::parallelFor(uint32_t begin, uint32_t end, const std::function<void(uint32_t)>& fn, uint32_t grainSize)
+    {
+        parallelForRange(begin, end, [&fn](uint32_t rangeBegin, uint32_t rangeEnd)
+        {
+            for (uint32_t i = rangeBegin; i < rangeEnd; i++) fn(i);
+        }, grainSize);
+    }
+
+    TaskScheduler::TaskHandle TaskGroup::run(TaskScheduler::Task task, const std::vector<TaskScheduler::TaskHandle>& dependencies)
+    {
+        auto pNode = mpScheduler->createNode(std::move(task), this);
+        mpScheduler->schedule(pNode, dependencies);
+        return TaskScheduler::TaskHandle(pNode);
+    }
+
+    void TaskGroup::wait()
+    {
+        mpScheduler->waitUntil([this]() { return isDone(); });
+
+        std::exception_ptr pException;
+        {
+            std::lock_guard<std::mutex> lock(mExceptionMutex);
+            std::swap(pException, mpException);
+        }
+        if (pException) std::rethrow_exception(pException);
+    }
+
+    TaskGroup::~TaskGroup()
+    {
+        try
+        {
+            wait();
+        }
+        catch (const std::exception& e)
+        {
+            logError("TaskGroup destroyed with an unhandled task exception: " + std::string(e.what()));
+        }
+        catch (...)
+        {
+            logError("TaskGroup destroyed with an unhandled task exception");
+        }
+    }
+}
@@ -0,0 +1,195 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+    /** Work-stealing task scheduler.
+        Each worker thread owns a deque of tasks. Workers push and pop tasks at the back of their own deque, and steal from the front of other workers' deques when they run out of work.
+        Tasks submitted from threads which are not workers of the scheduler go into a shared queue.
+        Threads which wait for tasks (TaskGroup::wait(), TaskScheduler::wait(), parallelFor()) run pending tasks while waiting, so tasks can safely wait for other tasks. When there is nothing to run they sleep until a task finishes or is queued.
+        An exception thrown by a task is caught on the thread which ran it and rethrown by wait(). The task still counts as finished, so tasks which depend on it run as usual.
+    */
+    class TaskGroup;
+
+    class TaskScheduler
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TaskScheduler>;
+        using Task = std::function<void()>;
+
+        struct TaskNode;
+
+        /** Handle to a submitted task. Can be used to wait for the task or as a dependency of other tasks
+        */
+        class TaskHandle
+        {
+        public:
+            TaskHandle() = default;
+
+            /** Check if the task finished running. An empty handle is always done
+            */
+            bool isDone() const;
+
+        private:
+            friend class TaskScheduler;
+            friend class TaskGroup;
+            TaskHandle(const std::shared_ptr<TaskNode>& pNode) : mpNode(pNode) {}
+            std::shared_ptr<TaskNode> mpNode;
+        };
+
+        /** Create a new scheduler
+            \param[in] workerCount Number of worker threads. 0 creates a scheduler without workers, in which case tasks only run when a thread waits for them
+        */
+        static SharedPtr create(uint32_t workerCount);
+
+        /** Get the default scheduler. It uses one worker thread per hardware thread, minus one for the main thread
+        */
+        static const SharedPtr& getDefault();
+
+        /** Destructor. Runs all the pending tasks before stopping the worker threads
+        */
+        ~TaskScheduler();
+
+        /** Submit a task
+            \param[in] task The task to run
+            \param[in] dependencies Tasks which must finish before this task starts. This is how continuations are expressed
+            \return A handle to the task
+        */
+        TaskHandle submit(Task task, const std::vector<TaskHandle>& dependencies = {});
+
+        /** Wait for a task to finish. The calling thread runs other tasks while waiting.
+            If the task threw an exception, the exception is rethrown here
+        */
+        void wait(const TaskHandle& handle);
+
+        /** Run fn(i) for each i in [begin, end). The calling thread participates and the function returns when all the iterations finished.
+            \param[in] begin First index
+            \param[in] end One past the last index
+            \param[in] fn The function to call for each index
+            \param[in] grainSize Number of consecutive indices processed by a single task. 0 picks a size which creates a few tasks per worker
+        */
+        void parallelFor(uint32_t begin, uint32_t end, const std::function<void(uint32_t)>& fn, uint32_t grainSize = 0);
+
+        /** Run fn(rangeBegin, rangeEnd) over sub-ranges of [begin, end). Useful when the per-index work is small. See parallelFor()
+        */
+        void parallelForRange(uint32_t begin, uint32_t end, const std::function<void(uint32_t, uint32_t)>& fn, uint32_t grainSize = 0);
+
+        /** Run a single pending task on the calling thread, if there is one
+            \return true if a task was run, otherwise false
+        */
+        bool runPendingTask();
+
+        /** Get the number of worker threads
+        */
+        uint32_t getWorkerCount() const { return (uint32_t)mWorkers.size(); }
+
+        /** Get the index of the calling thread in this scheduler, or -1 if the calling thread is not a worker of this scheduler
+        */
+        uint32_t getCurrentWorkerIndex() const;
+
+    private:
+        friend class TaskGroup;
+        TaskScheduler(uint32_t workerCount);
+
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<std::shared_ptr<TaskNode>> tasks;
+        };
+
+        std::shared_ptr<TaskNode> createNode(Task task, TaskGroup* pGroup);
+        void enqueue(const std::shared_ptr<TaskNode>& pNode);
+        void schedule(const std::shared_ptr<TaskNode>& pNode, const std::vector<TaskHandle>& dependencies);
+        std::shared_ptr<TaskNode> dequeue();
+        void execute(const std::shared_ptr<TaskNode>& pNode);
+        void workerLoop(uint32_t index);
+        void waitUntil(const std::function<bool()>& isDone);
+
+        std::vector<std::thread> mWorkers;
+        std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+        WorkerQueue mSharedQueue;
+
+        std::atomic<uint32_t> mQueuedTasks{ 0 };        // Tasks which are ready to run
+        std::atomic<uint32_t> mUnfinishedTasks{ 0 };    // Tasks which were submitted and didn't finish yet, including tasks waiting for dependencies
+        std::atomic<uint32_t> mSleepingWorkers{ 0 };
+        std::atomic<uint32_t> mWaitingThreads{ 0 };     // Threads sleeping in waitUntil()
+        std::atomic<bool> mStop{ false };
+        std::mutex mSleepMutex;
+        std::condition_variable mWakeCondition;         // Wakes up workers when a task is queued
+        std::condition_variable mWaitCondition;         // Wakes up waiting threads when a task is queued or finishes
+    };
+
+    /** A group of tasks which can be waited on together
+    */
+    class TaskGroup
+    {
+    public:
+        /** Create a group which submits tasks to a scheduler. By default, uses the default scheduler
+        */
+        TaskGroup(TaskScheduler* pScheduler = nullptr) : mpScheduler(pScheduler ? pScheduler : TaskScheduler::getDefault().get()) {}
+
+        /** Destructor. Waits for all the tasks in the group. Exceptions which weren't rethrown by wait() are logged
+        */
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        /** Submit a task as part of the group
+            \param[in] task The task to run
+            \param[in] dependencies Tasks which must finish before this task starts
+        */
+        TaskScheduler::TaskHandle run(TaskScheduler::Task task, const std::vector<TaskScheduler::TaskHandle>& dependencies = {});
+
+        /** Wait for all the tasks in the group to finish. The calling thread runs other tasks while waiting.
+            If any of the tasks threw an exception, the first one is rethrown here once all the tasks finished
+        */
+        void wait();
+
+        /** Check if all the tasks in the group finished
+        */
+        bool isDone() const { return mPending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class TaskScheduler;
+        TaskScheduler* mpScheduler;
+        std::atomic<uint32_t> mPending{ 0 };
+        std::mutex mExceptionMutex;
+        std::exception_ptr mpException;     // The first exception thrown by a task of the group. Protected by mExceptionMutex
+    };
+}
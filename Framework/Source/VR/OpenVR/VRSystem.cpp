@@ -72,6 +72,8 @@ namespace Falcor
     {
         return vr::TextureType_Vulkan;
     }
+#elif defined FALCOR_NULL
+    // There is no texture the compositor can consume. VRSystem::submit() fails instead
 #else
 #error VRSystem doesnt support the selected API backend
 #endif
@@ -404,6 +406,9 @@ namespace Falcor
     {
         if (!mpCompositor) return false;
 
+#ifdef FALCOR_NULL
+        return false;
+#else
         auto submitTex = prepareSubmitData(pDisplayTex, pRenderCtx);
         vr::Texture_t subTex;
         subTex.eType = getVrTextureType();
@@ -412,6 +417,7 @@ namespace Falcor
 
         mpCompositor->Submit((whichEye == VRDisplay::Eye::Right) ? vr::Eye_Right : vr::Eye_Left, &subTex, NULL);
         return true;
+#endif
     }
 
 
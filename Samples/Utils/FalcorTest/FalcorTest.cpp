@@ -36,19 +36,10 @@ static std::vector<std::string> librariesWithTests =
 {
 };
 
-void FalcorTest::onLoad(SampleCallbacks* pSample, RenderContext* pRenderContext)
-{
-    // Load all the DLLs so that they can register their tests.
-    for (const auto& lib : librariesWithTests)
-    {
-        RenderPassLibrary::instance().loadLibrary(lib);
-    }
-}
+static const char* kTestFilterSwitch = "test_filter";
 
-void FalcorTest::onFrameRender(SampleCallbacks* pSample, RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
+static std::string getTestFilter(const ArgList& argList)
 {
-    const char* kTestFilterSwitch = "test_filter";
-    ArgList argList = pSample->getArgList();
     std::string testFilterRegex;
     if (argList.argExists(kTestFilterSwitch))
     {
@@ -57,18 +48,66 @@ void FalcorTest::onFrameRender(SampleCallbacks* pSample, RenderContext* pRenderC
     }
     if (argList.argExists("h") || argList.argExists("help"))
     {
-        fprintf(stderr, R"(usage: FalcorTest [-test_filter filter]
+        fprintf(stderr, R"(usage: FalcorTest [-test_filter filter] [-benchmarks] [-headless]
 Where, if |filter| is provided, only tests whose source filename or test name
-have |filter| as a substring are executed.
+have |filter| as a substring are executed. Benchmarks only run when
+-benchmarks is provided. -headless runs the tests without a window, which is
+only supported by the null backend.
 )");
     }
+    return testFilterRegex;
+}
+
+void FalcorTest::onLoad(SampleCallbacks* pSample, RenderContext* pRenderContext)
+{
+    // Load all the DLLs so that they can register their tests.
+    for (const auto& lib : librariesWithTests)
+    {
+        RenderPassLibrary::instance().loadLibrary(lib);
+    }
+}
 
-    runTests(stderr, pRenderContext, testFilterRegex);
+void FalcorTest::onFrameRender(SampleCallbacks* pSample, RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
+{
+    ArgList argList = pSample->getArgList();
+    runTests(stderr, pRenderContext, getTestFilter(argList), argList.argExists("benchmarks"));
     pSample->shutdown();
 }
 
+#ifdef FALCOR_NULL
+namespace Falcor
+{
+    dlldecl void releaseSharedObjects();
+}
+
+/** Run the tests without a window or a sample. Only the null backend can create a device without a window
+*/
+static int runHeadless(const ArgList& argList)
+{
+    if (Device::create(nullptr, Device::Desc()) == nullptr)
+    {
+        logError("Failed to create the null device");
+        return 1;
+    }
+
+    int32_t failures = runTests(stderr, gpDevice->getRenderContext(), getTestFilter(argList), argList.argExists("benchmarks"));
+
+    gpDevice->flushAndSync();
+    releaseSharedObjects();
+    gpDevice->cleanup();
+    gpDevice.reset();
+    return (failures == 0) ? 0 : 1;
+}
+#endif
+
 int main(int argc, char** argv)
 {
+#ifdef FALCOR_NULL
+    ArgList argList;
+    argList.parseCommandLine(concatCommandLine(argc, argv));
+    if (argList.argExists("headless")) return runHeadless(argList);
+#endif
+
     FalcorTest::UniquePtr pRenderer = std::make_unique<FalcorTest>();
     SampleConfig config;
     config.windowDesc.title = "FalcorTest";
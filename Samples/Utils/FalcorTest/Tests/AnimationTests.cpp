@@ -0,0 +1,558 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/Model/AnimationController.h"
+#include "Graphics/Model/Loaders/AssimpModelImporter.h"
+#include "Utils/Math/FalcorMath.h"
+#include "glm/gtx/transform.hpp"
+#include "glm/gtc/constants.hpp"
+#include <random>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const float kDuration = 100;
+        const float kTicksPerSecond = 25;
+
+        /** Creates a binary tree of bones. When reverseIDs is set, children get lower IDs than their parents
+        */
+        std::vector<Bone> createSkeleton(uint32_t boneCount, bool reverseIDs)
+        {
+            auto id = [&](uint32_t i) { return reverseIDs ? boneCount - 1 - i : i; };
+            std::vector<Bone> bones(boneCount);
+            for (uint32_t i = 0; i < boneCount; i++)
+            {
+                Bone& bone = bones[id(i)];
+                bone.boneID = id(i);
+                bone.parentID = (i == 0) ? AnimationController::kInvalidBoneID : id((i - 1) / 2);
+                bone.name = "bone" + std::to_string(i);
+                bone.offset = glm::translate(glm::vec3(-0.1f * i, 0, 0));
+                bone.localTransform = glm::translate(glm::vec3(0, 1, 0)) * glm::rotate(0.1f * i, glm::vec3(0, 0, 1));
+                bone.originalLocalTransform = bone.localTransform;
+            }
+            return bones;
+        }
+
+        /** Creates a clip with keys for every bone except bone 1. Only even bones have scaling keys
+        */
+        std::vector<Animation::AnimationSet> createClip(uint32_t boneCount, uint32_t keyCount, std::mt19937& rng)
+        {
+            std::uniform_real_distribution<float> u(-1, 1);
+            std::vector<Animation::AnimationSet> sets;
+            for (uint32_t i = 0; i < boneCount; i++)
+            {
+                if (i == 1) continue;
+                Animation::AnimationSet set;
+                set.boneID = i;
+                glm::quat rotation;
+                for (uint32_t k = 0; k < keyCount; k++)
+                {
+                    float time = kDuration * k / keyCount;
+                    set.translation.keys.push_back({ glm::vec3(u(rng), 1 + u(rng), u(rng)) * 0.5f, time });
+                    if ((i % 2) == 0) set.scaling.keys.push_back({ glm::vec3(1) + glm::vec3(u(rng), u(rng), u(rng)) * 0.1f, time });
+                    rotation = glm::normalize(glm::angleAxis(0.5f * u(rng), glm::normalize(glm::vec3(u(rng), u(rng), 1))) * rotation);
+                    set.rotation.keys.push_back({ rotation, time });
+                }
+                sets.push_back(set);
+            }
+            return sets;
+        }
+
+        glm::vec3 interpolate(const glm::vec3& start, const glm::vec3& end, float ratio) { return glm::mix(start, end, ratio); }
+        glm::quat interpolate(const glm::quat& start, const glm::quat& end, float ratio) { return glm::slerp(start, end, ratio); }
+
+        template<typename T>
+        T sampleReference(const Animation::AnimationChannel<T>& channel, float ticks, const T& defaultValue)
+        {
+            const auto& keys = channel.keys;
+            if (keys.empty()) return defaultValue;
+            uint32_t cur = 0;
+            while (cur + 1 < keys.size() && keys[cur + 1].time <= ticks) cur++;
+            uint32_t next = (cur + 1) % keys.size();
+            float diff = keys[next].time - keys[cur].time;
+            if (diff < 0) diff += kDuration;
+            float ratio = (diff > 0) ? glm::clamp((ticks - keys[cur].time) / diff, 0.0f, 1.0f) : 0.0f;
+            return interpolate(keys[cur].value, keys[next].value, ratio);
+        }
+
+        /** Scalar evaluation of the skinning matrices, one bone at a time with a general inverse
+        */
+        void evaluateReference(const std::vector<Bone>& bones, const std::vector<Animation::AnimationSet>& sets, double time, std::vector<glm::mat4>& skinning, std::vector<glm::mat4>& invTranspose)
+        {
+            float ticks = (float)fmod(time * kTicksPerSecond, kDuration);
+            std::vector<glm::mat4> local(bones.size());
+            for (const auto& bone : bones) local[bone.boneID] = bone.originalLocalTransform;
+            for (const auto& set : sets)
+            {
+                glm::vec3 t = sampleReference(set.translation, ticks, glm::vec3(0));
+                glm::vec3 s = sampleReference(set.scaling, ticks, glm::vec3(1));
+                glm::quat q = sampleReference(set.rotation, ticks, glm::quat());
+                local[set.boneID] = glm::translate(t) * glm::mat4_cast(q) * glm::scale(s);
+            }
+
+            std::vector<glm::mat4> global(bones.size());
+            std::function<const glm::mat4&(uint32_t)> getGlobal = [&](uint32_t id) -> const glm::mat4&
+            {
+                uint32_t parent = bones[id].parentID;
+                global[id] = (parent == AnimationController::kInvalidBoneID) ? local[id] : getGlobal(parent) * local[id];
+                return global[id];
+            };
+
+            skinning.resize(bones.size());
+            invTranspose.resize(bones.size());
+            for (uint32_t i = 0; i < bones.size(); i++)
+            {
+                skinning[i] = getGlobal(i) * bones[i].offset;
+                invTranspose[i] = glm::transpose(glm::inverse(skinning[i]));
+            }
+        }
+
+        float maxDifference(const glm::mat4& a, const glm::mat4& b)
+        {
+            float diff = 0;
+            for (int c = 0; c < 4; c++)
+            {
+                for (int r = 0; r < 4; r++) diff = std::max(diff, std::abs(a[c][r] - b[c][r]));
+            }
+            return diff;
+        }
+
+        /** Creates a clip with smooth, densely sampled motion and constant scaling, typical of exported animations
+        */
+        std::vector<Animation::AnimationSet> createSmoothClip(uint32_t boneCount, uint32_t keyCount)
+        {
+            std::vector<Animation::AnimationSet> sets(boneCount);
+            for (uint32_t i = 0; i < boneCount; i++)
+            {
+                Animation::AnimationSet& set = sets[i];
+                set.boneID = i;
+                for (uint32_t k = 0; k < keyCount; k++)
+                {
+                    float time = kDuration * k / keyCount;
+                    float phase = glm::two_pi<float>() * time / kDuration;
+                    set.translation.keys.push_back({ glm::vec3(0.2f * sinf(phase + i), 1, 0.1f * cosf(2 * phase)), time });
+                    set.scaling.keys.push_back({ glm::vec3(1), time });
+                    set.rotation.keys.push_back({ glm::angleAxis(0.6f * sinf(phase + 0.3f * i), glm::normalize(glm::vec3(1, 0.5f, 0.2f * i))), time });
+                }
+            }
+            return sets;
+        }
+
+        AnimationController::UniquePtr createController(const std::vector<Bone>& bones, const std::vector<Animation::AnimationSet>& sets)
+        {
+            AnimationController::UniquePtr pController = AnimationController::create(bones);
+            pController->addAnimation(Animation::create("clip", sets, kDuration, kTicksPerSecond));
+            pController->setActiveAnimation(0);
+            return pController;
+        }
+    }
+
+    CPU_TEST(AffineInverseTranspose)
+    {
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<float> u(-1, 1);
+        for (uint32_t i = 0; i < 100; i++)
+        {
+            glm::mat4 m = glm::translate(glm::vec3(u(rng), u(rng), u(rng)) * 10.0f) * glm::rotate(u(rng) * 3.0f, glm::normalize(glm::vec3(u(rng), u(rng), 1))) * glm::scale(glm::vec3(1.5f + u(rng), 1.5f + u(rng), 1.5f + u(rng)));
+            EXPECT_LE(maxDifference(affineInverseTranspose(m), glm::transpose(glm::inverse(m))), 1e-4f) << "matrix " << i;
+        }
+    }
+
+    CPU_TEST(AnimationMatchesReference)
+    {
+        std::mt19937 rng(1);
+        const uint32_t boneCount = 31;
+        for (bool reverseIDs : { false, true })
+        {
+            std::vector<Bone> bones = createSkeleton(boneCount, reverseIDs);
+            std::vector<Animation::AnimationSet> sets = createClip(boneCount, 20, rng);
+            AnimationController::UniquePtr pController = createController(bones, sets);
+
+            // Includes going back in time and the interpolation from the last key back to the first
+            std::vector<glm::mat4> skinning, invTranspose;
+            for (double time : { 0.0, 0.3, 1.7, 3.99, 0.8, 2.5, 7.3 })
+            {
+                pController->animate(time);
+                evaluateReference(bones, sets, time, skinning, invTranspose);
+                for (uint32_t i = 0; i < boneCount; i++)
+                {
+                    EXPECT_LE(maxDifference(pController->getBoneMatrices()[i], skinning[i]), 1e-3f) << "time " << time << ", bone " << i << ", reversed IDs " << reverseIDs;
+                    EXPECT_LE(maxDifference(pController->getBoneInvTransposeMatrices()[i], invTranspose[i]), 1e-3f) << "time " << time << ", bone " << i << ", reversed IDs " << reverseIDs;
+                }
+            }
+
+            // The bind pose restores the original local transforms
+            pController->setActiveAnimation(AnimationController::kBindPoseAnimationId);
+            evaluateReference(bones, {}, 0, skinning, invTranspose);
+            for (uint32_t i = 0; i < boneCount; i++)
+            {
+                EXPECT_LE(maxDifference(pController->getBoneMatrices()[i], skinning[i]), 1e-4f) << "bone " << i << ", reversed IDs " << reverseIDs;
+            }
+        }
+    }
+
+    CPU_TEST(AnimationStatesAreIndependent)
+    {
+        std::mt19937 rng(3);
+        const uint32_t boneCount = 15;
+        std::vector<Bone> bones = createSkeleton(boneCount, false);
+        std::vector<Animation::AnimationSet> sets = createClip(boneCount, 10, rng);
+        AnimationController::UniquePtr pController = createController(bones, sets);
+
+        // Every third state stays in the bind pose, the others play the shared clip at different offsets and speeds
+        std::vector<AnimationState::SharedPtr> states;
+        std::vector<AnimationState*> batch;
+        for (uint32_t i = 0; i < 30; i++)
+        {
+            states.push_back(pController->createState());
+            if (i % 3) states.back()->setActiveAnimation(0);
+            states.back()->setTimeOffset(0.37 * i);
+            states.back()->setSpeed(1.0f + 0.1f * (i % 4));
+            batch.push_back(states.back().get());
+        }
+
+        std::vector<glm::mat4> skinning, invTranspose, bindPose;
+        evaluateReference(bones, {}, 0, bindPose, invTranspose);
+        for (double time : { 0.5, 2.25, 1.0 })
+        {
+            AnimationState::animate(batch, time);
+            for (uint32_t s = 0; s < states.size(); s++)
+            {
+                if (s % 3) evaluateReference(bones, sets, time * states[s]->getSpeed() + states[s]->getTimeOffset(), skinning, invTranspose);
+                for (uint32_t i = 0; i < boneCount; i++)
+                {
+                    const glm::mat4& expected = (s % 3) ? skinning[i] : bindPose[i];
+                    EXPECT_LE(maxDifference(states[s]->getBoneMatrices()[i], expected), 1e-3f) << "time " << time << ", state " << s << ", bone " << i;
+                }
+            }
+        }
+
+        // The model's own state isn't affected by the instances
+        pController->animate(0);
+        evaluateReference(bones, sets, 0, skinning, invTranspose);
+        EXPECT_LE(maxDifference(pController->getBoneMatrices().back(), skinning.back()), 1e-3f);
+    }
+
+    CPU_TEST(AnimationStateReportsChanges)
+    {
+        std::mt19937 rng(3);
+        const uint32_t boneCount = 8;
+        std::vector<Bone> bones = createSkeleton(boneCount, false);
+        AnimationController::UniquePtr pController = createController(bones, createClip(boneCount, 10, rng));
+
+        // A state in the bind pose only changes when it's modified
+        AnimationState::SharedPtr pState = pController->createState();
+        EXPECT(pState->animate(1.0));
+        EXPECT(!pState->animate(2.0));
+        pState->setBoneLocalTransform(0, glm::translate(glm::vec3(1.0f, 0.0f, 0.0f)));
+        EXPECT(pState->animate(2.0));
+        EXPECT(!pState->animate(3.0));
+
+        // A playing state changes whenever the time does
+        pState->setActiveAnimation(0);
+        EXPECT(pState->animate(3.0));
+        EXPECT(!pState->animate(3.0));
+        EXPECT(pState->animate(3.5));
+
+        std::vector<AnimationState*> batch = { pState.get() };
+        EXPECT(!AnimationState::animate(batch, 3.5));
+        EXPECT(AnimationState::animate(batch, 4.0));
+    }
+
+    CPU_TEST(AnimationCompressionWithinTolerance)
+    {
+        const uint32_t boneCount = 31;
+        std::mt19937 rng(4);
+        std::vector<Bone> bones = createSkeleton(boneCount, false);
+        for (const auto& sets : { createSmoothClip(boneCount, 200), createClip(boneCount, 20, rng) })
+        {
+            Animation::Compression compression;
+            Animation::UniquePtr pRaw = Animation::create("raw", sets, kDuration, kTicksPerSecond);
+            Animation::UniquePtr pCompressed = Animation::create("compressed", sets, kDuration, kTicksPerSecond, &compression);
+            EXPECT_LE(pCompressed->getKeyDataSize(), pRaw->getKeyDataSize() * 3 / 4);
+
+            AnimationController::UniquePtr pRawController = AnimationController::create(bones);
+            AnimationController::UniquePtr pCompressedController = AnimationController::create(bones);
+            pRawController->addAnimation(std::move(pRaw));
+            pCompressedController->addAnimation(std::move(pCompressed));
+            pRawController->setActiveAnimation(0);
+            pCompressedController->setActiveAnimation(0);
+
+            // The errors add up along the hierarchy, which is 5 bones deep, and are scaled by the bone offsets
+            for (double time : { 0.0, 0.45, 1.3, 2.9, 3.95 })
+            {
+                pRawController->animate(time);
+                pCompressedController->animate(time);
+                for (uint32_t i = 0; i < boneCount; i++)
+                {
+                    EXPECT_LE(maxDifference(pCompressedController->getBoneMatrices()[i], pRawController->getBoneMatrices()[i]), 0.05f) << "time " << time << ", bone " << i;
+                }
+            }
+        }
+
+        // Smooth motion and constant channels are reduced to a fraction of the keys
+        std::vector<Animation::AnimationSet> smooth = createSmoothClip(boneCount, 200);
+        Animation::Compression compression;
+        EXPECT_LE(Animation::create("smooth", smooth, kDuration, kTicksPerSecond, &compression)->getKeyDataSize() * 4, Animation::create("smooth", smooth, kDuration, kTicksPerSecond)->getKeyDataSize());
+    }
+
+    CPU_TEST(AnimationCrossFade)
+    {
+        std::mt19937 rng(5);
+        const uint32_t boneCount = 15;
+        std::vector<Bone> bones = createSkeleton(boneCount, false);
+        std::vector<Animation::AnimationSet> sets0 = createClip(boneCount, 10, rng);
+        std::vector<Animation::AnimationSet> sets1 = createClip(boneCount, 10, rng);
+        AnimationController::UniquePtr pController = AnimationController::create(bones);
+        pController->addAnimation(Animation::create("clip0", sets0, kDuration, kTicksPerSecond));
+        pController->addAnimation(Animation::create("clip1", sets1, kDuration, kTicksPerSecond));
+
+        AnimationState::SharedPtr pState = pController->createState();
+        pState->setActiveAnimation(0);
+        pState->animate(1.0);
+
+        // The fade starts at the next update, which still shows the first clip. After the fade duration only the second clip remains
+        std::vector<glm::mat4> skinning, invTranspose;
+        pState->crossFade(1, 0.5f);
+        EXPECT(pState->isFading());
+        pState->animate(1.2);
+        evaluateReference(bones, sets0, 1.2, skinning, invTranspose);
+        for (uint32_t i = 0; i < boneCount; i++) EXPECT_LE(maxDifference(pState->getBoneMatrices()[i], skinning[i]), 1e-3f) << "fade start, bone " << i;
+
+        pState->animate(1.45);
+        EXPECT(pState->isFading());
+
+        for (double time : { 1.75, 2.1 })
+        {
+            pState->animate(time);
+            EXPECT(pState->isFading() == false);
+            evaluateReference(bones, sets1, time, skinning, invTranspose);
+            for (uint32_t i = 0; i < boneCount; i++) EXPECT_LE(maxDifference(pState->getBoneMatrices()[i], skinning[i]), 1e-3f) << "time " << time << ", bone " << i;
+        }
+
+        // The additive clip's first frame is its reference, so at time 0 it doesn't change the pose
+        pState->setAdditiveAnimation(0);
+        pState->animate(0);
+        evaluateReference(bones, sets1, 0, skinning, invTranspose);
+        for (uint32_t i = 0; i < boneCount; i++) EXPECT_LE(maxDifference(pState->getBoneMatrices()[i], skinning[i]), 1e-3f) << "additive, bone " << i;
+
+        pState->setAdditiveWeight(0);
+        pState->animate(2.6);
+        evaluateReference(bones, sets1, 2.6, skinning, invTranspose);
+        for (uint32_t i = 0; i < boneCount; i++) EXPECT_LE(maxDifference(pState->getBoneMatrices()[i], skinning[i]), 1e-3f) << "additive weight 0, bone " << i;
+    }
+
+    CPU_TEST(AnimationLayersRestoreBindPose)
+    {
+        std::mt19937 rng(9);
+        const uint32_t boneCount = 12;
+        std::vector<Bone> bones = createSkeleton(boneCount, false);
+        std::vector<Animation::AnimationSet> sets0 = createClip(boneCount, 10, rng);
+        std::vector<Animation::AnimationSet> sets1 = createClip(boneCount, 10, rng);
+        sets1.resize(sets1.size() / 2);
+
+        // A clip which scales a bone to zero can't be used as an additive reference
+        Animation::AnimationSet zeroScale;
+        zeroScale.boneID = 2;
+        zeroScale.translation.keys.push_back({ glm::vec3(0), 0 });
+        zeroScale.scaling.keys.push_back({ glm::vec3(0), 0 });
+        zeroScale.rotation.keys.push_back({ glm::quat(), 0 });
+
+        AnimationController::UniquePtr pController = AnimationController::create(bones);
+        pController->addAnimation(Animation::create("clip0", sets0, kDuration, kTicksPerSecond));
+        pController->addAnimation(Animation::create("clip1", sets1, kDuration, kTicksPerSecond));
+        pController->addAnimation(Animation::create("zeroScale", { zeroScale }, kDuration, kTicksPerSecond));
+
+        std::vector<glm::mat4> skinning, invTranspose, bindPose;
+        evaluateReference(bones, {}, 0, bindPose, invTranspose);
+
+        // Removing the additive layer from a state in the bind pose restores the bind pose
+        AnimationState::SharedPtr pState = pController->createState();
+        pState->setAdditiveAnimation(0);
+        pState->animate(0.7);
+        pState->setAdditiveAnimation(AnimationController::kBindPoseAnimationId);
+        pState->animate(0.8);
+        for (uint32_t i = 0; i < boneCount; i++) EXPECT_LE(maxDifference(pState->getBoneMatrices()[i], bindPose[i]), 1e-3f) << "additive removed, bone " << i;
+
+        // After a fade, the bones the new clip doesn't animate are in the bind pose
+        pState->setActiveAnimation(0);
+        pState->animate(1.0);
+        pState->crossFade(1, 0.25f);
+        for (double time : { 1.1, 1.5, 1.6 }) pState->animate(time);
+        EXPECT(pState->isFading() == false);
+        evaluateReference(bones, sets1, 1.6, skinning, invTranspose);
+        for (uint32_t i = 0; i < boneCount; i++) EXPECT_LE(maxDifference(pState->getBoneMatrices()[i], skinning[i]), 1e-3f) << "after fade, bone " << i;
+
+        // A zero reference scale leaves the pose unchanged
+        pState->setActiveAnimation(AnimationController::kBindPoseAnimationId);
+        pState->setAdditiveAnimation(2);
+        pState->animate(2.0);
+        for (uint32_t i = 0; i < boneCount; i++) EXPECT_LE(maxDifference(pState->getBoneMatrices()[i], bindPose[i]), 1e-3f) << "zero scale, bone " << i;
+    }
+
+    /** Write a BVH motion capture file with a few joint chains and smooth motion
+    */
+    static std::string createMotionCaptureFile(uint32_t chainCount, uint32_t chainLength, uint32_t frameCount)
+    {
+        std::string filename = getTempFilename();
+        std::remove(filename.c_str());
+        filename += ".bvh";
+        std::ofstream bvh(filename);
+        bvh << "HIERARCHY\nROOT Hips\n{\n\tOFFSET 0 0 0\n\tCHANNELS 6 Xposition Yposition Zposition Zrotation Xrotation Yrotation\n";
+        for (uint32_t c = 0; c < chainCount; c++)
+        {
+            for (uint32_t j = 0; j < chainLength; j++)
+            {
+                bvh << "JOINT Chain" << c << "_" << j << "\n{\n\tOFFSET 0 " << (j == 0 ? 0.5f : 1.0f) << " " << 0.2f * c << "\n\tCHANNELS 3 Zrotation Xrotation Yrotation\n";
+            }
+            bvh << "End Site\n{\n\tOFFSET 0 1 0\n}\n";
+            for (uint32_t j = 0; j < chainLength; j++) bvh << "}\n";
+        }
+        bvh << "}\nMOTION\nFrames: " << frameCount << "\nFrame Time: 0.0333333\n";
+
+        const uint32_t jointCount = chainCount * chainLength;
+        for (uint32_t f = 0; f < frameCount; f++)
+        {
+            float phase = glm::two_pi<float>() * f / frameCount;
+            bvh << 0.1f * sinf(phase) << " " << 1.0f << " " << 0.5f * f / frameCount << " 0 " << 5 * sinf(phase) << " 0";
+            for (uint32_t j = 0; j < jointCount; j++)
+            {
+                // Some joints are held still, which is common in captured data
+                float amplitude = (j % 5 == 4) ? 0.0f : 30.0f;
+                bvh << " " << amplitude * sinf(phase + 0.2f * j) << " " << 0.5f * amplitude * cosf(2 * phase + j) << " 0";
+            }
+            bvh << "\n";
+        }
+        return filename;
+    }
+
+    CPU_BENCHMARK(AnimationCompressionBenchmark)
+    {
+        const uint32_t chainCount = 5;
+        const uint32_t chainLength = 8;
+        const uint32_t instanceCount = 64;
+        const uint32_t frameCount = 20;
+        std::string filename = createMotionCaptureFile(chainCount, chainLength, 600);
+
+        Animation::Compression compression;
+        auto raw = AssimpModelImporter::importAnimations(filename, nullptr);
+        auto compressed = AssimpModelImporter::importAnimations(filename, &compression);
+        std::remove(filename.c_str());
+        EXPECT_EQ(raw.size(), size_t(1));
+        EXPECT_EQ(compressed.size(), size_t(1));
+        if (raw.size() != 1 || compressed.size() != 1) return;
+
+        // The imported bones are identified by channel order. Use a flat skeleton, the benchmark measures the clip evaluation
+        std::vector<Bone> bones(raw[0]->getChannelCount());
+        for (uint32_t i = 0; i < bones.size(); i++)
+        {
+            bones[i].boneID = i;
+            bones[i].parentID = AnimationController::kInvalidBoneID;
+            bones[i].name = "bone" + std::to_string(i);
+        }
+
+        const size_t rawSize = raw[0]->getKeyDataSize();
+        const size_t compressedSize = compressed[0]->getKeyDataSize();
+        EXPECT_LT(compressedSize, rawSize);
+
+        double ms[2];
+        std::vector<glm::mat4> lastPose[2];
+        for (uint32_t c = 0; c < 2; c++)
+        {
+            AnimationController::UniquePtr pController = AnimationController::create(bones);
+            pController->addAnimation(std::move(c == 0 ? raw[0] : compressed[0]));
+            std::vector<AnimationState::SharedPtr> states;
+            for (uint32_t i = 0; i < instanceCount; i++)
+            {
+                states.push_back(pController->createState());
+                states.back()->setActiveAnimation(0);
+                states.back()->setTimeOffset(i * 0.1);
+            }
+
+            auto start = CpuTimer::getCurrentTimePoint();
+            for (uint32_t frame = 0; frame < frameCount; frame++)
+            {
+                for (auto& pState : states) pState->animate(frame / 30.0);
+            }
+            ms[c] = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+            lastPose[c] = states.back()->getBoneMatrices();
+        }
+
+        for (uint32_t i = 0; i < bones.size(); i++) EXPECT_LE(maxDifference(lastPose[0][i], lastPose[1][i]), 0.01f) << "bone " << i;
+        logInfo("AnimationCompressionBenchmark: " + std::to_string(bones.size()) + " bones, raw " + std::to_string(rawSize) + " bytes, compressed " + std::to_string(compressedSize) + " bytes (" +
+            std::to_string(double(rawSize) / compressedSize) + "x). " + std::to_string(instanceCount) + " instances, raw " + std::to_string(ms[0] / frameCount) + " ms per frame, compressed " + std::to_string(ms[1] / frameCount) + " ms per frame");
+    }
+
+    CPU_BENCHMARK(AnimationBenchmark)
+    {
+        const uint32_t instanceCount = 256;
+        const uint32_t boneCount = 64;
+        const uint32_t frameCount = 10;
+        std::mt19937 rng(2);
+        std::vector<Bone> bones = createSkeleton(boneCount, false);
+        std::vector<Animation::AnimationSet> sets = createClip(boneCount, 30, rng);
+
+        AnimationController::UniquePtr pController = createController(bones, sets);
+        std::vector<AnimationState::SharedPtr> states;
+        std::vector<AnimationState*> batch;
+        for (uint32_t i = 0; i < instanceCount; i++)
+        {
+            states.push_back(pController->createState());
+            states.back()->setActiveAnimation(0);
+            states.back()->setTimeOffset(i * 0.01);
+            batch.push_back(states.back().get());
+        }
+
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            for (uint32_t i = 0; i < instanceCount; i++) states[i]->animate(frame / 30.0);
+        }
+        double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            AnimationState::animate(batch, frame / 30.0);
+        }
+        double batchMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        std::vector<glm::mat4> skinning, invTranspose;
+        start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            for (uint32_t i = 0; i < instanceCount; i++) evaluateReference(bones, sets, frame / 30.0 + i * 0.01, skinning, invTranspose);
+        }
+        double referenceMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        EXPECT_LE(maxDifference(states.back()->getBoneMatrices().back(), skinning.back()), 1e-3f);
+        logInfo("AnimationBenchmark: " + std::to_string(instanceCount) + " instances x " + std::to_string(boneCount) + " bones, " + std::to_string(ms / frameCount) + " ms per frame, parallel batch " + std::to_string(batchMs / frameCount) + " ms per frame, scalar reference " + std::to_string(referenceMs / frameCount) + " ms per frame");
+    }
+}  // namespace Falcor
@@ -0,0 +1,282 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/Model/Loaders/BinaryModelImporter.h"
+#include "Graphics/Model/Loaders/BinaryModelSpec.h"
+#include "Graphics/Model/Mesh.h"
+#include "Utils/Platform/MemoryMappedFile.h"
+#include <fstream>
+
+namespace Falcor
+{
+    class BinaryWriter
+    {
+    public:
+        template<typename T>
+        BinaryWriter& operator<<(const T& val) { return write(&val, sizeof(T)); }
+        BinaryWriter& write(const void* pData, size_t size)
+        {
+            const uint8_t* pBytes = (const uint8_t*)pData;
+            data.insert(data.end(), pBytes, pBytes + size);
+            return *this;
+        }
+        BinaryWriter& writeString(const std::string& s)
+        {
+            *this << (int32_t)s.size();
+            return write(s.data(), s.size());
+        }
+
+        std::vector<uint8_t> data;
+    };
+
+    static void writeTextures(BinaryWriter& writer, uint32_t textureCount, uint32_t textureSize)
+    {
+        const int32_t kFormatR8G8B8A8 = 1;   // FW::ImageFormat::R8_G8_B8_A8
+        const int32_t dataSize = textureSize * textureSize * 4;
+        std::vector<uint8_t> pixels(dataSize);
+        for (uint32_t t = 0; t < textureCount; t++)
+        {
+            for (size_t i = 0; i < pixels.size(); i++) pixels[i] = uint8_t(i * 7 + t);
+            writer.writeString("texture" + std::to_string(t));
+            writer.write("BinImage", 8);
+            writer << int32_t(2) << textureSize << textureSize << int32_t(4) << int32_t(0) << kFormatR8G8B8A8 << dataSize;
+            writer.write(pixels.data(), pixels.size());
+        }
+    }
+
+    /** Creates a scene with textureCount textures and a single grid mesh with position, normal and texture coordinates.
+        Versions 1-5 use the "BinMesh " layout, versions 6-9 the "BinScene" layout.
+        Version 9 adds a level of detail made of the grid's two corner triangles.
+    */
+    static std::vector<uint8_t> createSyntheticBinaryModel(uint32_t version, uint32_t gridSize, uint32_t textureCount, uint32_t textureSize)
+    {
+        if (version < 2) textureCount = 0;
+        const int32_t vertexCount = (gridSize + 1) * (gridSize + 1);
+        const int32_t attribs[3][3] = { { AttribType_Position, AttribFormat_F32, 3 }, { AttribType_Normal, AttribFormat_F32, 3 }, { AttribType_TexCoord, AttribFormat_F32, 2 } };
+
+        BinaryWriter writer;
+        writer.write(version >= 6 ? "BinScene" : "BinMesh ", 8);
+        writer << version;
+        if (version >= 6)
+        {
+            writer << (int32_t)textureCount << int32_t(1) << int32_t(1);
+            writeTextures(writer, textureCount, textureSize);
+            writer << int32_t(3) << vertexCount << int32_t(1);
+        }
+        else
+        {
+            writer << int32_t(3) << vertexCount;
+            if (version >= 2) writer << (int32_t)textureCount;
+            writer << int32_t(1);
+        }
+
+        writer.write(attribs, sizeof(attribs));
+        for (uint32_t y = 0; y <= gridSize; y++)
+        {
+            for (uint32_t x = 0; x <= gridSize; x++)
+            {
+                glm::vec2 uv(float(x) / gridSize, float(y) / gridSize);
+                writer << glm::vec3(uv.x, 0, uv.y) << glm::vec3(0, 1, 0) << uv;
+            }
+        }
+
+        if (version <= 5) writeTextures(writer, textureCount, textureSize);
+
+        // Submesh
+        writer << glm::vec3(0) << glm::vec4(1) << glm::vec3(0) << 1.0f;
+        if (version >= 3) writer << 0.0f << 0.0f;
+        const uint32_t textureSlots[] = { 0, 0, 2, 3, 5, 6, 6, 7, 7, 7 };
+        for (uint32_t i = 0; i < textureSlots[version]; i++) writer << (int32_t)(i == 0 && textureCount ? 0 : -1);
+        writer << int32_t(gridSize * gridSize * 2);
+        for (uint32_t y = 0; y < gridSize; y++)
+        {
+            for (uint32_t x = 0; x < gridSize; x++)
+            {
+                uint32_t i0 = y * (gridSize + 1) + x;
+                uint32_t i1 = i0 + 1;
+                uint32_t i2 = i0 + gridSize + 1;
+                uint32_t i3 = i2 + 1;
+                writer << i0 << i2 << i1 << i1 << i2 << i3;
+            }
+        }
+        if (version >= 9)
+        {
+            const uint32_t last = gridSize * (gridSize + 1);
+            writer << int32_t(1) << 0.0f << int32_t(2);
+            writer << 0u << last << gridSize << gridSize << last << last + gridSize;
+        }
+
+        // Instance
+        if (version >= 6)
+        {
+            writer << int32_t(0) << int32_t(1) << glm::mat4();
+            writer.writeString("instance");
+            writer.writeString("");
+        }
+        return writer.data;
+    }
+
+    static std::string writeTempFile(const std::vector<uint8_t>& data)
+    {
+        std::string filename = getTempFilename();
+        std::ofstream file(filename, std::ios::binary);
+        file.write((const char*)data.data(), data.size());
+        return filename;
+    }
+
+    CPU_TEST(BinaryModelValidateVersions)
+    {
+        for (uint32_t version = 1; version <= 9; version++)
+        {
+            auto data = createSyntheticBinaryModel(version, 4, 2, 8);
+            std::string error;
+            EXPECT(BinaryModelImporter::validate(data.data(), data.size(), error));
+
+            // Every truncation point must be rejected
+            for (size_t size = 0; size < data.size(); size += 13)
+            {
+                EXPECT(BinaryModelImporter::validate(data.data(), size, error) == false);
+            }
+            EXPECT(BinaryModelImporter::validate(data.data(), data.size() - 1, error) == false);
+        }
+    }
+
+    CPU_TEST(BinaryModelValidateCorruption)
+    {
+        auto data = createSyntheticBinaryModel(8, 4, 1, 8);
+        std::string error;
+
+        auto badVersion = data;
+        badVersion[8] = 10;
+        EXPECT(BinaryModelImporter::validate(badVersion.data(), badVersion.size(), error) == false);
+
+        auto badFormat = data;
+        badFormat[0] = 'X';
+        EXPECT(BinaryModelImporter::validate(badFormat.data(), badFormat.size(), error) == false);
+
+        // The last index of the file is followed by the instance block: meshIdx, enabled, matrix and two strings
+        const size_t instanceSize = 4 + 4 + sizeof(glm::mat4) + (4 + 8) + 4;
+        auto badIndex = data;
+        const uint32_t outOfRange = 0xffff;
+        std::memcpy(badIndex.data() + badIndex.size() - instanceSize - sizeof(uint32_t), &outOfRange, sizeof(uint32_t));
+        EXPECT(BinaryModelImporter::validate(badIndex.data(), badIndex.size(), error) == false);
+
+        auto badInstance = data;
+        const int32_t badMesh = 1;
+        std::memcpy(badInstance.data() + badInstance.size() - instanceSize, &badMesh, sizeof(int32_t));
+        EXPECT(BinaryModelImporter::validate(badInstance.data(), badInstance.size(), error) == false);
+
+        // In version 9, the last index before the instance block belongs to the level of detail
+        auto lodData = createSyntheticBinaryModel(9, 4, 1, 8);
+        EXPECT(BinaryModelImporter::validate(lodData.data(), lodData.size(), error));
+        auto badLodIndex = lodData;
+        std::memcpy(badLodIndex.data() + badLodIndex.size() - instanceSize - sizeof(uint32_t), &outOfRange, sizeof(uint32_t));
+        EXPECT(BinaryModelImporter::validate(badLodIndex.data(), badLodIndex.size(), error) == false);
+
+        auto badLodCount = lodData;
+        const int32_t tooManyLods = Mesh::kMaxLodCount;
+        std::memcpy(badLodCount.data() + badLodCount.size() - instanceSize - 6 * sizeof(uint32_t) - 3 * sizeof(int32_t), &tooManyLods, sizeof(int32_t));
+        EXPECT(BinaryModelImporter::validate(badLodCount.data(), badLodCount.size(), error) == false);
+    }
+
+    CPU_TEST(MemoryMappedFileContents)
+    {
+        std::vector<uint8_t> data(100000);
+        for (size_t i = 0; i < data.size(); i++) data[i] = uint8_t(i * 31);
+        std::string filename = writeTempFile(data);
+
+        auto pFile = MemoryMappedFile::create(filename);
+        EXPECT(pFile != nullptr);
+        if (pFile)
+        {
+            EXPECT_EQ(pFile->getSize(), data.size());
+            EXPECT(std::memcmp(pFile->getData(), data.data(), data.size()) == 0);
+        }
+        pFile = nullptr;
+        std::remove(filename.c_str());
+
+        EXPECT(MemoryMappedFile::create(filename) == nullptr);
+    }
+
+    // Parse benchmarks. Both read the same file from the OS file cache, and report throughput and the peak amount of heap memory holding file data.
+    static const uint32_t kBenchmarkIterations = 20;
+
+    static void logParseResult(const std::string& name, size_t fileSize, float ms, size_t peakBytes)
+    {
+        double mb = double(fileSize) * kBenchmarkIterations / (1024.0 * 1024.0);
+        logInfo(name + ": " + std::to_string(mb / (ms * 1e-3)) + " MB/s, peak file memory " + std::to_string(peakBytes / 1024) + " KB");
+    }
+
+    CPU_BENCHMARK(BinaryModelParseBenchmarkStream)
+    {
+        std::string filename = writeTempFile(createSyntheticBinaryModel(8, 512, 16, 512));
+        size_t fileSize = 0;
+        size_t peakBytes = 0;
+
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kBenchmarkIterations; i++)
+        {
+            std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+            std::vector<uint8_t> data((size_t)stream.tellg());
+            stream.seekg(0);
+            stream.read((char*)data.data(), data.size());
+            fileSize = data.size();
+            peakBytes = std::max(peakBytes, data.capacity());
+
+            std::string error;
+            EXPECT(BinaryModelImporter::validate(data.data(), data.size(), error));
+        }
+        float ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        logParseResult("BinaryModel stream parse", fileSize, ms, peakBytes);
+        std::remove(filename.c_str());
+    }
+
+    CPU_BENCHMARK(BinaryModelParseBenchmarkMapped)
+    {
+        std::string filename = writeTempFile(createSyntheticBinaryModel(8, 512, 16, 512));
+        size_t fileSize = 0;
+
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kBenchmarkIterations; i++)
+        {
+            auto pFile = MemoryMappedFile::create(filename);
+            EXPECT(pFile != nullptr);
+            if (pFile == nullptr) break;
+            fileSize = pFile->getSize();
+
+            std::string error;
+            EXPECT(BinaryModelImporter::validate(pFile->getData(), pFile->getSize(), error));
+        }
+        float ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        // The mapping is backed by the OS file cache, so no heap memory holds file data
+        logParseResult("BinaryModel mapped parse", fileSize, ms, 0);
+        std::remove(filename.c_str());
+    }
+}  // namespace Falcor
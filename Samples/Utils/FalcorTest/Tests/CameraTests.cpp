@@ -0,0 +1,79 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include <random>
+
+namespace Falcor
+{
+    CPU_TEST(CameraBatchCullMatchesPerBox)
+    {
+        Camera::SharedPtr pCamera = Camera::create();
+        pCamera->setAspectRatio(1.5f);
+        pCamera->setDepthRange(0.5f, 200.0f);
+        pCamera->setPosition(glm::vec3(3.0f, 2.0f, -5.0f));
+        pCamera->setTarget(glm::vec3(-20.0f, 10.0f, 80.0f));
+        pCamera->setUpVector(glm::vec3(0.0f, 1.0f, 0.0f));
+
+        // Odd count, so that both the SIMD and the scalar tail paths are exercised
+        const uint32_t kBoxCount = 10003;
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> position(-150.0f, 250.0f);
+        std::uniform_real_distribution<float> size(0.0f, 20.0f);
+
+        std::vector<BoundingBox> boxes;
+        BoundingBoxSoA soa;
+        for (uint32_t i = 0; i < kBoxCount; i++)
+        {
+            BoundingBox box;
+            box.center = glm::vec3(position(rng), position(rng), position(rng));
+            // Every 16th box is degenerate, to check points and planes
+            box.extent = (i % 16) ? glm::vec3(size(rng), size(rng), size(rng)) : glm::vec3(0.0f, size(rng), 0.0f);
+            boxes.push_back(box);
+            soa.push_back(box);
+        }
+
+        std::vector<uint32_t> mask;
+        uint32_t visibleCount = pCamera->cullBoundingBoxes(soa, mask);
+        EXPECT_EQ(mask.size(), (kBoxCount + 31) / 32);
+
+        uint32_t expectedCount = 0;
+        for (uint32_t i = 0; i < kBoxCount; i++)
+        {
+            bool visible = ((mask[i / 32] >> (i % 32)) & 1) != 0;
+            bool expected = (pCamera->isObjectCulled(boxes[i]) == false);
+            if (expected) expectedCount++;
+            EXPECT_EQ(visible, expected) << "box " << i;
+        }
+        EXPECT_EQ(visibleCount, expectedCount);
+        EXPECT_GT(visibleCount, 0u);
+        EXPECT_LT(visibleCount, kBoxCount);
+
+        // Bits past the last box must be clear
+        EXPECT_EQ(mask.back() >> (kBoxCount % 32), 0u);
+    }
+}  // namespace Falcor
@@ -0,0 +1,122 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/Scene/InstanceDataPacker.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace Falcor
+{
+    namespace
+    {
+        glm::mat4 createTransform(uint32_t i)
+        {
+            glm::mat4 m = glm::translate(glm::mat4(), glm::vec3(float(i % 100), 0.0f, float(i / 100)));
+            m = glm::rotate(m, float(i) * 0.1f, glm::vec3(0, 1, 0));
+            return glm::scale(m, glm::vec3(1.0f + (i % 3), 1.0f, 0.5f + (i % 5)));
+        }
+    }
+
+    CPU_TEST(InstanceDataPacking)
+    {
+        // Draws are no longer split at 64 instances. Each draw's instances are packed contiguously and the shaders fetch them at gFirstInstance + SV_InstanceID
+        const uint32_t drawSizes[] = { 1000, 65, 1, 64 };
+        InstanceDataPacker packer;
+        std::vector<uint32_t> firstInstances;
+        uint32_t drawID = 0;
+        for (uint32_t draw = 0; draw < arraysize(drawSizes); draw++)
+        {
+            firstInstances.push_back(packer.getInstanceCount());
+            for (uint32_t i = 0; i < drawSizes[draw]; i++)
+            {
+                EXPECT_EQ(packer.addInstance(createTransform(drawID), createTransform(drawID + 1), drawID), firstInstances[draw] + i);
+                drawID++;
+            }
+        }
+        EXPECT_EQ(packer.getInstanceCount(), drawID);
+        EXPECT_EQ(packer.getWorldMats().size(), (size_t)drawID);
+        EXPECT_EQ(packer.getPrevWorldMats().size(), (size_t)drawID);
+        EXPECT_EQ(packer.getWorldInvTransposeMats().size(), (size_t)drawID);
+
+        drawID = 0;
+        for (uint32_t draw = 0; draw < arraysize(drawSizes); draw++)
+        {
+            for (uint32_t instanceID = 0; instanceID < drawSizes[draw]; instanceID++, drawID++)
+            {
+                const uint32_t index = firstInstances[draw] + instanceID;
+                EXPECT_EQ(packer.getDrawIds()[index], drawID) << "draw " << draw << ", instance " << instanceID;
+                if (instanceID % 37 != 0 && instanceID + 1 != drawSizes[draw]) continue;
+
+                EXPECT(packer.getWorldMats()[index] == createTransform(drawID)) << "draw " << draw << ", instance " << instanceID;
+                EXPECT(packer.getPrevWorldMats()[index] == createTransform(drawID + 1)) << "draw " << draw << ", instance " << instanceID;
+
+                // Normals transformed by the packed matrix stay perpendicular to the transformed tangents, even with non-uniform scale
+                const glm::mat3 world = glm::mat3(packer.getWorldMats()[index]);
+                const glm::mat3 normalMat = glm::mat3(packer.getWorldInvTransposeMats()[index]);
+                const glm::vec3 n = normalMat * glm::vec3(0, 0, 1);
+                const glm::vec3 t = world * glm::vec3(1, 1, 0);
+                EXPECT_LT(std::abs(glm::dot(glm::normalize(n), glm::normalize(t))), 1e-4f) << "draw " << draw << ", instance " << instanceID;
+            }
+        }
+
+        // The next frame starts over at instance 0
+        packer.clear();
+        EXPECT_EQ(packer.getInstanceCount(), 0u);
+        EXPECT_EQ(packer.addInstance(glm::mat4(), glm::mat4(), 7), 0u);
+        EXPECT_EQ(packer.getDrawIds()[0], 7u);
+    }
+
+    CPU_BENCHMARK(InstanceDataPackingBenchmark)
+    {
+        // A foliage-like scene: a few meshes with 10k instances each, every one of them a single draw
+        const uint32_t meshCount = 8;
+        const uint32_t instancesPerMesh = 10000;
+        const uint32_t frameCount = 20;
+        std::vector<glm::mat4> transforms(instancesPerMesh);
+        for (uint32_t i = 0; i < instancesPerMesh; i++) transforms[i] = createTransform(i);
+
+        InstanceDataPacker packer;
+        packer.reserve(meshCount * instancesPerMesh);
+        double packMs = 0;
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            auto start = CpuTimer::getCurrentTimePoint();
+            packer.clear();
+            for (uint32_t mesh = 0; mesh < meshCount; mesh++)
+            {
+                for (uint32_t i = 0; i < instancesPerMesh; i++) packer.addInstance(transforms[i], transforms[i], mesh * instancesPerMesh + i);
+            }
+            packMs += CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        }
+        EXPECT_EQ(packer.getInstanceCount(), meshCount * instancesPerMesh);
+
+        const uint32_t splitDraws = meshCount * ((instancesPerMesh + 63) / 64);
+        const size_t bytes = packer.getInstanceCount() * (2 * sizeof(glm::mat4) + sizeof(glm::mat3x4) + sizeof(uint32_t));
+        logInfo("InstanceDataPackingBenchmark: " + std::to_string(meshCount) + " meshes of " + std::to_string(instancesPerMesh) + " instances packed in " + std::to_string(packMs / frameCount) + " ms per frame, " +
+            std::to_string(bytes) + " bytes uploaded. " + std::to_string(meshCount) + " draws, instead of " + std::to_string(splitDraws) + " with 64 instances per draw");
+    }
+}  // namespace Falcor
@@ -0,0 +1,221 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/LightClusterBuilder.h"
+#include "Utils/TaskScheduler.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Deterministic pseudo-random numbers in [0, 1)
+        class Lcg
+        {
+        public:
+            float next()
+            {
+                mState = mState * 1664525u + 1013904223u;
+                return float(mState >> 8) / float(1 << 24);
+            }
+        private:
+            uint32_t mState = 12345;
+        };
+
+        Camera::SharedPtr createCamera()
+        {
+            Camera::SharedPtr pCamera = Camera::create();
+            pCamera->setAspectRatio(16.0f / 9.0f);
+            pCamera->setDepthRange(0.1f, 200.0f);
+            pCamera->setPosition(glm::vec3(0.0f, 5.0f, 0.0f));
+            pCamera->setTarget(glm::vec3(30.0f, 2.0f, -100.0f));
+            pCamera->setUpVector(glm::vec3(0.0f, 1.0f, 0.0f));
+            return pCamera;
+        }
+
+        // Lights scattered around the camera, every 50th light is unbounded
+        std::vector<LightClusterBuilder::LightBounds> createLights(uint32_t count)
+        {
+            Lcg rng;
+            std::vector<LightClusterBuilder::LightBounds> lights(count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                lights[i].center = glm::vec3(rng.next() * 300.0f - 150.0f, rng.next() * 20.0f - 5.0f, rng.next() * -250.0f + 20.0f);
+                lights[i].radius = (i % 50 == 0) ? 0.0f : 0.5f + rng.next() * 10.0f;
+            }
+            return lights;
+        }
+
+        bool clusterContainsLight(const LightClusterBuilder* pBuilder, uint32_t cluster, uint32_t light)
+        {
+            const glm::uvec2 range = pBuilder->getClusters()[cluster];
+            const auto& indices = pBuilder->getLightIndices();
+            return std::find(indices.begin() + range.x, indices.begin() + range.x + range.y, light) != indices.begin() + range.x + range.y;
+        }
+    }
+
+    CPU_TEST(LightClusterBinning)
+    {
+        Camera::SharedPtr pCamera = createCamera();
+        const std::vector<LightClusterBuilder::LightBounds> lights = createLights(2000);
+        LightClusterBuilder::SharedPtr pBuilder = LightClusterBuilder::create();
+        pBuilder->build(pCamera.get(), lights);
+
+        // The global lights come first, in order
+        const auto& indices = pBuilder->getLightIndices();
+        EXPECT_EQ(pBuilder->getGlobalLightCount(), 40u);
+        for (uint32_t i = 0; i < pBuilder->getGlobalLightCount(); i++)
+        {
+            EXPECT_EQ(indices[i], i * 50);
+        }
+
+        // Every light in a cluster overlaps the cluster's bounds
+        const glm::mat4& viewMat = pCamera->getViewMatrix();
+        const auto& clusters = pBuilder->getClusters();
+        EXPECT_EQ(clusters.size(), (size_t)pBuilder->getClusterCount());
+        uint32_t clusteredCount = 0;
+        for (uint32_t c = 0; c < pBuilder->getClusterCount(); c++)
+        {
+            glm::vec3 minBound, maxBound;
+            pBuilder->getClusterBounds(c, minBound, maxBound);
+            EXPECT_GE(clusters[c].x, pBuilder->getGlobalLightCount());
+            EXPECT_LE(clusters[c].x + clusters[c].y, (uint32_t)indices.size());
+            for (uint32_t i = clusters[c].x; i < clusters[c].x + clusters[c].y; i++)
+            {
+                const auto& light = lights[indices[i]];
+                glm::vec3 centerV = glm::vec3(viewMat * glm::vec4(light.center, 1.0f));
+                glm::vec3 d = centerV - glm::clamp(centerV, minBound, maxBound);
+                EXPECT_GT(light.radius, 0.0f);
+                EXPECT_LE(glm::dot(d, d), light.radius * light.radius * 1.0001f) << "cluster " << c << ", light " << indices[i];
+            }
+            clusteredCount += clusters[c].y;
+        }
+        EXPECT_GT(clusteredCount, 0u);
+        EXPECT_EQ(pBuilder->getStats().indexCount, (uint32_t)indices.size());
+
+        // Any point inside a light's range lands in a cluster which lists the light
+        Lcg rng;
+        uint32_t testedPoints = 0;
+        for (uint32_t l = 0; l < (uint32_t)lights.size(); l++)
+        {
+            if (lights[l].radius <= 0) continue;
+            for (uint32_t s = 0; s < 16; s++)
+            {
+                glm::vec3 dir = glm::vec3(rng.next(), rng.next(), rng.next()) * 2.0f - 1.0f;
+                if (glm::dot(dir, dir) > 1 || glm::dot(dir, dir) < 1e-4f) continue;
+                glm::vec3 posW = lights[l].center + dir * lights[l].radius * 0.99f;
+                uint32_t cluster = pBuilder->findCluster(posW);
+                if (cluster == uint32_t(-1)) continue;
+                testedPoints++;
+                EXPECT(clusterContainsLight(pBuilder.get(), cluster, l)) << "light " << l << ", cluster " << cluster;
+            }
+        }
+        EXPECT_GT(testedPoints, 1000u);
+
+        // Binning the slices in parallel gives the same result
+        LightClusterBuilder::SharedPtr pParallelBuilder = LightClusterBuilder::create();
+        pParallelBuilder->build(pCamera.get(), lights, TaskScheduler::getDefault().get());
+        EXPECT(pParallelBuilder->getLightIndices() == indices);
+        EXPECT(pParallelBuilder->getClusters() == clusters);
+    }
+
+    CPU_TEST(LightClusterEdgeCases)
+    {
+        Camera::SharedPtr pCamera = createCamera();
+        LightClusterBuilder::SharedPtr pBuilder = LightClusterBuilder::create(LightClusterBuilder::Desc().setTileCount(8, 4).setSliceCount(16));
+        EXPECT(pBuilder->getDims() == glm::uvec3(8, 4, 16));
+
+        // No lights
+        pBuilder->build(pCamera.get(), {});
+        EXPECT_EQ(pBuilder->getLightIndices().size(), (size_t)0);
+        EXPECT_EQ(pBuilder->getStats().nonEmptyClusterCount, 0u);
+
+        // A light behind the camera is culled, a light containing the camera reaches every tile of the first slice
+        std::vector<LightClusterBuilder::LightBounds> lights(2);
+        lights[0].center = glm::vec3(-30.0f, 5.0f, 100.0f);
+        lights[0].radius = 5.0f;
+        lights[1].center = pCamera->getPosition();
+        lights[1].radius = 2.0f;
+        pBuilder->build(pCamera.get(), lights);
+        EXPECT_EQ(pBuilder->getStats().culledLightCount, 1u);
+        for (uint32_t y = 0; y < 4; y++)
+        {
+            for (uint32_t x = 0; x < 8; x++)
+            {
+                EXPECT(clusterContainsLight(pBuilder.get(), pBuilder->getClusterIndex(x, y, 0), 1)) << "tile " << x << ", " << y;
+                EXPECT(!clusterContainsLight(pBuilder.get(), pBuilder->getClusterIndex(x, y, 15), 1)) << "tile " << x << ", " << y;
+            }
+        }
+        EXPECT_EQ(pBuilder->findCluster(pCamera->getPosition() - glm::vec3(0.0f, 0.0f, -1.0f)), uint32_t(-1));
+    }
+
+    CPU_TEST(LightClusterNoLightCap)
+    {
+        // Programs used to see at most MAX_LIGHT_SOURCES (16) lights. A cluster now lists every light that reaches it, however many there are
+        Camera::SharedPtr pCamera = createCamera();
+        const glm::vec3 target = pCamera->getPosition() + glm::normalize(pCamera->getTarget() - pCamera->getPosition()) * 20.0f;
+        const uint32_t lightCount = 1000;
+        std::vector<LightClusterBuilder::LightBounds> lights(lightCount);
+        for (uint32_t i = 0; i < lightCount; i++)
+        {
+            lights[i].center = target + glm::vec3(float(i % 10) - 4.5f, float(i / 100) * 0.1f, float((i / 10) % 10) - 4.5f) * 0.2f;
+            lights[i].radius = 4.0f;
+        }
+
+        LightClusterBuilder::SharedPtr pBuilder = LightClusterBuilder::create();
+        pBuilder->build(pCamera.get(), lights);
+        EXPECT_EQ(pBuilder->getStats().culledLightCount, 0u);
+        EXPECT_GE(pBuilder->getStats().maxLightsPerCluster, lightCount);
+
+        const uint32_t cluster = pBuilder->findCluster(target);
+        EXPECT_NE(cluster, uint32_t(-1));
+        if (cluster == uint32_t(-1)) return;
+        EXPECT_EQ(pBuilder->getClusters()[cluster].y, lightCount);
+        for (uint32_t l = 0; l < lightCount; l += 97) EXPECT(clusterContainsLight(pBuilder.get(), cluster, l)) << "light " << l;
+    }
+
+    CPU_BENCHMARK(LightClusterBenchmark)
+    {
+        // Architectural scenes have thousands of point lights. The binning cost should grow with the light count, not with the lights per pixel
+        const uint32_t iterations = 20;
+        Camera::SharedPtr pCamera = createCamera();
+        LightClusterBuilder::SharedPtr pBuilder = LightClusterBuilder::create();
+        for (uint32_t lightCount : { 1000u, 4000u, 16000u })
+        {
+            const std::vector<LightClusterBuilder::LightBounds> lights = createLights(lightCount);
+            auto start = CpuTimer::getCurrentTimePoint();
+            for (uint32_t i = 0; i < iterations; i++) pBuilder->build(pCamera.get(), lights, TaskScheduler::getDefault().get());
+            double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / iterations;
+
+            const auto& stats = pBuilder->getStats();
+            EXPECT_EQ(stats.lightCount, lightCount);
+            logInfo("LightClusterBenchmark: " + std::to_string(lightCount) + " lights in " + std::to_string(ms) + " ms, " + std::to_string(stats.nonEmptyClusterCount) + " non-empty clusters, up to " +
+                std::to_string(stats.maxLightsPerCluster) + " lights per cluster");
+        }
+    }
+}  // namespace Falcor
@@ -0,0 +1,138 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/Model/MeshOptimizer.h"
+#include "TestMeshes.h"
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** The triangles of a mesh as sorted, rotated position triplets. Two meshes with the same triangles and winding have the same list, regardless of the triangle and vertex order
+        */
+        std::vector<std::vector<float>> getTriangleList(const glm::vec3* pPositions, const std::vector<uint32_t>& indices)
+        {
+            std::vector<std::vector<float>> list;
+            for (size_t t = 0; t < indices.size(); t += 3)
+            {
+                // Use the smallest rotation, which keeps the winding
+                std::vector<float> triangle;
+                for (size_t r = 0; r < 3; r++)
+                {
+                    std::vector<float> rotated;
+                    for (size_t i = 0; i < 3; i++)
+                    {
+                        const glm::vec3& p = pPositions[indices[t + (r + i) % 3]];
+                        rotated.insert(rotated.end(), { p.x, p.y, p.z });
+                    }
+                    if (r == 0 || rotated < triangle) triangle = rotated;
+                }
+                list.push_back(triangle);
+            }
+            std::sort(list.begin(), list.end());
+            return list;
+        }
+    }
+
+    CPU_TEST(MeshOptimizerCacheStats)
+    {
+        // A single triangle misses 3 times
+        std::vector<uint32_t> triangle = { 0, 1, 2 };
+        auto stats = MeshOptimizer::analyzeVertexCache(triangle.data(), 3, 3);
+        EXPECT_EQ(stats.misses, 3);
+        EXPECT_EQ(stats.acmr, 3.0f);
+        EXPECT_EQ(stats.atvr, 1.0f);
+
+        // A fan around vertex 0 reuses the center and the previous vertex
+        const uint32_t fanCount = 8;
+        std::vector<uint32_t> fan;
+        for (uint32_t i = 0; i < fanCount; i++) fan.insert(fan.end(), { 0, i + 1, i + 2 });
+        stats = MeshOptimizer::analyzeVertexCache(fan.data(), (uint32_t)fan.size(), fanCount + 2);
+        EXPECT_EQ(stats.misses, fanCount + 2);
+        EXPECT_EQ(stats.atvr, 1.0f);
+
+        // With a cache of 3 entries, re-referencing the center after 3 new vertices misses again
+        std::vector<uint32_t> evicting = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+        stats = MeshOptimizer::analyzeVertexCache(evicting.data(), (uint32_t)evicting.size(), 6, 3);
+        EXPECT_EQ(stats.misses, 9);
+
+        // Less than a triangle has no stats
+        stats = MeshOptimizer::analyzeVertexCache(triangle.data(), 2, 3);
+        EXPECT_EQ(stats.misses, 0);
+        EXPECT_EQ(stats.acmr, 0.0f);
+        EXPECT_EQ(stats.atvr, 0.0f);
+    }
+
+    CPU_TEST(MeshOptimizerReducesCacheMisses)
+    {
+        std::mt19937 rng(3);
+        SyntheticMesh mesh = createSphere(64, 96);
+        shuffleTriangles(mesh, rng);
+        const uint32_t indexCount = (uint32_t)mesh.indices.size();
+        const uint32_t vertexCount = (uint32_t)mesh.positions.size();
+        const auto reference = getTriangleList(mesh.positions.data(), mesh.indices);
+
+        auto before = MeshOptimizer::analyzeVertexCache(mesh.indices.data(), indexCount, vertexCount);
+        auto clusters = MeshOptimizer::optimizeVertexCache(mesh.indices.data(), indexCount, vertexCount);
+        auto afterCache = MeshOptimizer::analyzeVertexCache(mesh.indices.data(), indexCount, vertexCount);
+        EXPECT(clusters.empty() == false);
+        EXPECT_EQ(clusters[0], 0);
+        EXPECT(std::is_sorted(clusters.begin(), clusters.end()));
+        EXPECT_LT(afterCache.acmr, 0.8f);
+        EXPECT_LT(afterCache.acmr, before.acmr * 0.5f);
+
+        MeshOptimizer::optimizeOverdraw(mesh.indices.data(), indexCount, clusters, mesh.positions.data(), sizeof(glm::vec3), vertexCount);
+        auto afterOverdraw = MeshOptimizer::analyzeVertexCache(mesh.indices.data(), indexCount, vertexCount);
+        EXPECT_LE(afterOverdraw.acmr, afterCache.acmr * 1.05f);
+
+        auto remap = MeshOptimizer::optimizeVertexFetch(mesh.indices.data(), indexCount, vertexCount);
+        std::vector<uint8_t> positions((const uint8_t*)mesh.positions.data(), (const uint8_t*)(mesh.positions.data() + vertexCount));
+        MeshOptimizer::remapVertexBuffer(remap, sizeof(glm::vec3), positions);
+        const glm::vec3* pRemapped = (const glm::vec3*)positions.data();
+
+        // Remapping the vertices doesn't change the cache behavior, and the vertices are referenced in order
+        auto after = MeshOptimizer::analyzeVertexCache(mesh.indices.data(), indexCount, vertexCount);
+        EXPECT_EQ(after.misses, afterOverdraw.misses);
+        uint32_t nextVertex = 0;
+        uint32_t outOfOrder = 0;
+        for (uint32_t index : mesh.indices)
+        {
+            if (index > nextVertex) outOfOrder++;
+            if (index == nextVertex) nextVertex++;
+        }
+        EXPECT_EQ(outOfOrder, 0);
+
+        // Every pass must keep the same triangles with the same winding
+        EXPECT(getTriangleList(pRemapped, mesh.indices) == reference);
+
+        logInfo("MeshOptimizerReducesCacheMisses: " + std::to_string(indexCount / 3) + " triangles, " + std::to_string(clusters.size()) + " clusters. ACMR " + std::to_string(before.acmr) + " -> " + std::to_string(after.acmr) +
+            ", ATVR " + std::to_string(before.atvr) + " -> " + std::to_string(after.atvr));
+    }
+}
@@ -0,0 +1,149 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/Model/MeshSimplifier.h"
+#include "TestMeshes.h"
+#include <algorithm>
+#include <cfloat>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** The largest distance of a triangle centroid from the unit sphere
+        */
+        float getSphereDeviation(const SyntheticMesh& mesh, const std::vector<uint32_t>& indices)
+        {
+            float deviation = 0;
+            for (size_t t = 0; t < indices.size(); t += 3)
+            {
+                glm::vec3 centroid = (mesh.positions[indices[t]] + mesh.positions[indices[t + 1]] + mesh.positions[indices[t + 2]]) / 3.0f;
+                deviation = std::max(deviation, 1 - glm::length(centroid));
+            }
+            return deviation;
+        }
+
+        glm::vec3 getNormal(const SyntheticMesh& mesh, const std::vector<uint32_t>& indices, size_t t)
+        {
+            const glm::vec3& p0 = mesh.positions[indices[t]];
+            return glm::cross(mesh.positions[indices[t + 1]] - p0, mesh.positions[indices[t + 2]] - p0);
+        }
+    }
+
+    CPU_TEST(MeshSimplifierLodChain)
+    {
+        SyntheticMesh mesh = createSphere(64, 96);
+        const uint32_t indexCount = (uint32_t)mesh.indices.size();
+        const uint32_t vertexCount = (uint32_t)mesh.positions.size();
+
+        auto start = CpuTimer::getCurrentTimePoint();
+        auto lods = MeshSimplifier::generateLodChain(mesh.indices.data(), indexCount, mesh.positions.data(), sizeof(glm::vec3), vertexCount, 7);
+        float ms = (float)CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        const float baseDeviation = getSphereDeviation(mesh, mesh.indices);
+        EXPECT(lods.size() >= 3);
+        EXPECT(lods.size() <= 7);
+        size_t previousCount = indexCount;
+        float previousError = 0;
+        std::string counts = std::to_string(indexCount / 3);
+        for (const auto& lod : lods)
+        {
+            // Each level roughly halves the triangle count, and the error grows with it
+            EXPECT_EQ(lod.indices.size() % 3, 0);
+            EXPECT_LE(lod.indices.size(), previousCount * 6 / 10);
+            EXPECT_LT(previousError, lod.error);
+
+            // The reported error bounds the distance to the original surface
+            EXPECT_LE(getSphereDeviation(mesh, lod.indices), baseDeviation + lod.error * 1.5f);
+
+            // Collapses must not flip triangles
+            for (size_t t = 0; t < lod.indices.size(); t += 3)
+            {
+                const glm::vec3& p = mesh.positions[lod.indices[t]];
+                EXPECT(glm::dot(getNormal(mesh, lod.indices, t), p) > 0);
+                EXPECT(lod.indices[t] < vertexCount && lod.indices[t + 1] < vertexCount && lod.indices[t + 2] < vertexCount);
+            }
+
+            previousCount = lod.indices.size();
+            previousError = lod.error;
+            counts += " -> " + std::to_string(lod.indices.size() / 3) + " (" + std::to_string(lod.error) + ")";
+        }
+        logInfo("MeshSimplifierLodChain: " + counts + " triangles in " + std::to_string(ms) + " ms");
+    }
+
+    CPU_TEST(MeshSimplifierErrorLimit)
+    {
+        SyntheticMesh mesh = createSphere(32, 48);
+        const uint32_t indexCount = (uint32_t)mesh.indices.size();
+        const uint32_t vertexCount = (uint32_t)mesh.positions.size();
+
+        // A tight error limit stops simplification early, a loose one reaches the target
+        float tightError = 0;
+        auto tight = MeshSimplifier::simplify(mesh.indices.data(), indexCount, mesh.positions.data(), sizeof(glm::vec3), vertexCount, 0, 1e-3f, &tightError);
+        EXPECT_LE(tightError, 1e-3f);
+        EXPECT_LE(getSphereDeviation(mesh, tight), getSphereDeviation(mesh, mesh.indices) + 1.5e-3f);
+
+        float looseError = 0;
+        auto loose = MeshSimplifier::simplify(mesh.indices.data(), indexCount, mesh.positions.data(), sizeof(glm::vec3), vertexCount, indexCount / 4, FLT_MAX, &looseError);
+        EXPECT_LE(loose.size(), indexCount / 4);
+        EXPECT_LT(loose.size(), tight.size());
+        EXPECT_LT(tightError, looseError);
+    }
+
+    CPU_TEST(MeshSimplifierPlanarGrid)
+    {
+        const uint32_t gridSize = 40;
+        SyntheticMesh mesh = createGrid(gridSize);
+        const uint32_t indexCount = (uint32_t)mesh.indices.size();
+        const uint32_t vertexCount = (uint32_t)mesh.positions.size();
+
+        // Interior vertices of a plane collapse without error, while the border is kept in place
+        float error = -1;
+        auto simplified = MeshSimplifier::simplify(mesh.indices.data(), indexCount, mesh.positions.data(), sizeof(glm::vec3), vertexCount, 0, 0, &error);
+        EXPECT_EQ(error, 0.0f);
+        EXPECT_LT(simplified.size(), indexCount / 8);
+
+        std::vector<bool> used(vertexCount, false);
+        float area = 0;
+        for (size_t t = 0; t < simplified.size(); t += 3)
+        {
+            glm::vec3 n = getNormal(mesh, simplified, t);
+            EXPECT(n.y > 0);
+            area += glm::length(n) * 0.5f;
+            for (size_t i = 0; i < 3; i++) used[simplified[t + i]] = true;
+        }
+        for (uint32_t i = 0; i <= gridSize; i++)
+        {
+            EXPECT(used[i]);
+            EXPECT(used[i * (gridSize + 1)]);
+            EXPECT(used[i * (gridSize + 1) + gridSize]);
+            EXPECT(used[gridSize * (gridSize + 1) + i]);
+        }
+        EXPECT(std::abs(area - float(gridSize * gridSize)) < 1e-2f);
+    }
+}
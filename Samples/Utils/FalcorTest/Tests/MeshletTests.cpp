@@ -0,0 +1,180 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/Model/Meshlet.h"
+#include "TestMeshes.h"
+#include <algorithm>
+#include <array>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::vector<std::array<uint32_t, 3>> getSortedTriangles(const std::vector<uint32_t>& indices)
+        {
+            std::vector<std::array<uint32_t, 3>> triangles;
+            for (size_t t = 0; t < indices.size(); t += 3) triangles.push_back({ indices[t], indices[t + 1], indices[t + 2] });
+            std::sort(triangles.begin(), triangles.end());
+            return triangles;
+        }
+
+        glm::mat4 createTransform(const glm::vec3& x, const glm::vec3& y, const glm::vec3& z, const glm::vec3& translation)
+        {
+            glm::mat4 m;
+            m[0] = glm::vec4(x, 0);
+            m[1] = glm::vec4(y, 0);
+            m[2] = glm::vec4(z, 0);
+            m[3] = glm::vec4(translation, 1);
+            return m;
+        }
+
+        /** Cull the meshlets and check that every triangle left out of the ranges is either outside the frustum or back-facing
+        */
+        MeshletCuller::Stats cullAndValidate(const SyntheticMesh& mesh, const std::vector<uint32_t>& indices, const std::vector<Meshlet>& meshlets, const glm::mat4& world, const Camera* pCamera)
+        {
+            MeshletCuller::Stats stats;
+            std::vector<MeshletCuller::IndexRange> ranges;
+            MeshletCuller::cull(meshlets, world, pCamera, true, true, ranges, stats);
+
+            std::vector<bool> drawn(indices.size() / 3, false);
+            uint32_t previousEnd = 0;
+            uint64_t drawnTriangles = 0;
+            for (const auto& range : ranges)
+            {
+                // Ranges are sorted, and adjacent ranges are merged
+                EXPECT(range.startIndex > previousEnd || (previousEnd == 0 && range.startIndex == 0));
+                EXPECT_EQ(range.indexCount % 3, 0);
+                for (uint32_t i = range.startIndex; i < range.startIndex + range.indexCount; i += 3) drawn[i / 3] = true;
+                previousEnd = range.startIndex + range.indexCount;
+                drawnTriangles += range.indexCount / 3;
+            }
+
+            for (size_t t = 0; t < drawn.size(); t++)
+            {
+                if (drawn[t]) continue;
+                glm::vec3 p[3];
+                for (uint32_t i = 0; i < 3; i++) p[i] = glm::vec3(world * glm::vec4(mesh.positions[indices[t * 3 + i]], 1));
+                BoundingBox box;
+                box.center = (glm::min(p[0], glm::min(p[1], p[2])) + glm::max(p[0], glm::max(p[1], p[2]))) * 0.5f;
+                box.extent = glm::max(p[0], glm::max(p[1], p[2])) - box.center;
+                bool backFacing = glm::dot(p[0] - pCamera->getPosition(), glm::cross(p[1] - p[0], p[2] - p[0])) > 0;
+                EXPECT(backFacing || pCamera->isObjectCulled(box));
+            }
+
+            EXPECT_EQ(stats.meshletCount, (uint32_t)meshlets.size());
+            EXPECT_EQ(stats.triangleCount, indices.size() / 3);
+            EXPECT_EQ(stats.visibleTriangleCount, drawnTriangles);
+            EXPECT_EQ(stats.rangeCount, (uint32_t)ranges.size());
+            return stats;
+        }
+    }
+
+    CPU_TEST(MeshletBuildLimits)
+    {
+        SyntheticMesh mesh = createSphere(128, 192);
+        std::vector<uint32_t> indices = mesh.indices;
+        const uint32_t indexCount = (uint32_t)indices.size();
+        const uint32_t vertexCount = (uint32_t)mesh.positions.size();
+
+        auto start = CpuTimer::getCurrentTimePoint();
+        auto meshlets = MeshletBuilder::build(indices.data(), indexCount, mesh.positions.data(), sizeof(glm::vec3), vertexCount);
+        float ms = (float)CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        // The meshlets cover the index buffer in order and keep the triangles and their winding
+        EXPECT(getSortedTriangles(indices) == getSortedTriangles(mesh.indices));
+        uint32_t nextIndex = 0;
+        uint32_t vertexTotal = 0;
+        for (const auto& meshlet : meshlets)
+        {
+            EXPECT_EQ(meshlet.startIndex, nextIndex);
+            EXPECT(meshlet.triangleCount > 0);
+            EXPECT_LE(meshlet.triangleCount, MeshletBuilder::kMaxTriangles);
+            EXPECT_LE(meshlet.vertexCount, MeshletBuilder::kMaxVertices);
+
+            std::vector<uint32_t> vertices(indices.begin() + meshlet.startIndex, indices.begin() + meshlet.startIndex + meshlet.triangleCount * 3);
+            std::sort(vertices.begin(), vertices.end());
+            EXPECT_EQ((uint32_t)(std::unique(vertices.begin(), vertices.end()) - vertices.begin()), meshlet.vertexCount);
+
+            // The bounds contain every vertex and every triangle normal
+            for (uint32_t i = meshlet.startIndex; i < meshlet.startIndex + meshlet.triangleCount * 3; i += 3)
+            {
+                const glm::vec3* p[3] = { &mesh.positions[indices[i]], &mesh.positions[indices[i + 1]], &mesh.positions[indices[i + 2]] };
+                for (uint32_t j = 0; j < 3; j++) EXPECT_LE(glm::length(*p[j] - meshlet.center), meshlet.radius * 1.0001f);
+                glm::vec3 n = glm::normalize(glm::cross(*p[1] - *p[0], *p[2] - *p[0]));
+                if (meshlet.coneCutoff > 0) EXPECT(glm::dot(n, meshlet.coneAxis) >= meshlet.coneCutoff - 1e-4f);
+            }
+
+            // On a finely tessellated sphere, every meshlet is a small patch whose normals can be culled
+            EXPECT(meshlet.coneCutoff > 0.5f);
+            EXPECT_LT(meshlet.radius, 0.5f);
+            nextIndex += meshlet.triangleCount * 3;
+            vertexTotal += meshlet.vertexCount;
+        }
+        EXPECT_EQ(nextIndex, indexCount);
+
+        // Closed regular meshes are vertex limited. 64 vertices allow about 100 triangles
+        const float trianglesPerMeshlet = float(indexCount / 3) / meshlets.size();
+        EXPECT(trianglesPerMeshlet > 75.0f);
+
+        logInfo("MeshletBuildLimits: " + std::to_string(indexCount / 3) + " triangles, " + std::to_string(meshlets.size()) + " meshlets, " + std::to_string(trianglesPerMeshlet) + " triangles and " +
+            std::to_string(float(vertexTotal) / meshlets.size()) + " vertices per meshlet, " + std::to_string(ms) + " ms");
+    }
+
+    CPU_TEST(MeshletCullStats)
+    {
+        SyntheticMesh mesh = createSphere(128, 192);
+        std::vector<uint32_t> indices = mesh.indices;
+        auto meshlets = MeshletBuilder::build(indices.data(), (uint32_t)indices.size(), mesh.positions.data(), sizeof(glm::vec3), (uint32_t)mesh.positions.size());
+
+        // Look past the sphere, so that part of it is outside the frustum
+        Camera::SharedPtr pCamera = Camera::create();
+        pCamera->setAspectRatio(1.0f);
+        pCamera->setDepthRange(0.1f, 100.0f);
+        pCamera->setPosition(glm::vec3(0, 0, 4));
+        pCamera->setTarget(glm::vec3(2.5f, 0, 0));
+        pCamera->setUpVector(glm::vec3(0, 1, 0));
+
+        const glm::vec3 x(1, 0, 0), y(0, 1, 0), z(0, 0, 1);
+        auto identity = cullAndValidate(mesh, indices, meshlets, createTransform(x, y, z, glm::vec3(0)), pCamera.get());
+        EXPECT(identity.frustumCulledCount > 0);
+        EXPECT(identity.backfaceCulledCount > 0);
+        EXPECT(identity.getCulledTriangleRatio() > 0.5f);
+        EXPECT_LT(identity.rangeCount, identity.meshletCount - identity.frustumCulledCount - identity.backfaceCulledCount);
+
+        // Rotation, uniform scale and mirroring keep back-face culling. Non-uniform scale disables it
+        auto rotated = cullAndValidate(mesh, indices, meshlets, createTransform(-z * 0.5f, y * 0.5f, x * 0.5f, glm::vec3(0.5f, 0, 0)), pCamera.get());
+        EXPECT(rotated.backfaceCulledCount > 0);
+        auto mirrored = cullAndValidate(mesh, indices, meshlets, createTransform(-x, y, z, glm::vec3(0)), pCamera.get());
+        EXPECT(mirrored.backfaceCulledCount > 0);
+        auto stretched = cullAndValidate(mesh, indices, meshlets, createTransform(x, y * 2.0f, z, glm::vec3(0)), pCamera.get());
+        EXPECT_EQ(stretched.backfaceCulledCount, 0);
+
+        logInfo("MeshletCullStats: " + std::to_string(identity.meshletCount) + " meshlets, " + std::to_string(identity.frustumCulledCount) + " outside the frustum, " + std::to_string(identity.backfaceCulledCount) + " back-facing, " +
+            std::to_string(identity.rangeCount) + " ranges. " + std::to_string(identity.getCulledTriangleRatio() * 100) + "% of the triangles culled");
+    }
+}
@@ -0,0 +1,184 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include <cmath>
+#include <fstream>
+#include <experimental/filesystem>
+
+namespace Falcor
+{
+    // Writes a synthetic scene directory of tessellated OBJ grids, which only requires CPU work to decode
+    static std::vector<std::string> createSyntheticModels(uint32_t modelCount, uint32_t gridSize)
+    {
+        const std::string basePath = getTempFilename();
+        std::remove(basePath.c_str());
+        std::vector<std::string> files;
+        for (uint32_t m = 0; m < modelCount; m++)
+        {
+            std::string filename = basePath + "_model" + std::to_string(m) + ".obj";
+            std::ofstream obj(filename);
+            for (uint32_t y = 0; y <= gridSize; y++)
+            {
+                for (uint32_t x = 0; x <= gridSize; x++)
+                {
+                    float u = float(x) / gridSize;
+                    float v = float(y) / gridSize;
+                    obj << "v " << u << " " << 0.1f * std::sin(10.0f * u + float(m)) << " " << v << "\n";
+                    obj << "vt " << u << " " << v << "\n";
+                    obj << "vn 0 1 0\n";
+                }
+            }
+
+            for (uint32_t y = 0; y < gridSize; y++)
+            {
+                for (uint32_t x = 0; x < gridSize; x++)
+                {
+                    uint32_t i0 = y * (gridSize + 1) + x + 1;
+                    uint32_t i1 = i0 + 1;
+                    uint32_t i2 = i0 + gridSize + 1;
+                    uint32_t i3 = i2 + 1;
+                    obj << "f " << i0 << "/" << i0 << "/" << i0 << " " << i2 << "/" << i2 << "/" << i2 << " " << i1 << "/" << i1 << "/" << i1 << "\n";
+                    obj << "f " << i1 << "/" << i1 << "/" << i1 << " " << i2 << "/" << i2 << "/" << i2 << " " << i3 << "/" << i3 << "/" << i3 << "\n";
+                }
+            }
+            files.push_back(filename);
+        }
+        return files;
+    }
+
+    static void deleteFiles(const std::vector<std::string>& files)
+    {
+        for (const auto& f : files) std::remove(f.c_str());
+    }
+
+    static const uint32_t kModelCount = 32;
+    static const uint32_t kGridSize = 96;
+
+    CPU_TEST(ModelDecodeParallelMatchesSerial)
+    {
+        auto files = createSyntheticModels(8, 16);
+        std::vector<Model::LoadFlags> flags(files.size(), Model::LoadFlags::None);
+        files.push_back("missing_model_file.obj");
+        flags.push_back(Model::LoadFlags::None);
+
+        auto serial = Model::decodeFiles(files, flags, 1);
+        auto parallel = Model::decodeFiles(files, flags, 4);
+        EXPECT_EQ(serial.size(), files.size());
+        EXPECT_EQ(parallel.size(), files.size());
+
+        // Results must be in the input order, with failures reported per file
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            EXPECT_EQ(serial[i]->getFilename(), files[i]);
+            EXPECT_EQ(parallel[i]->getFilename(), files[i]);
+            EXPECT_EQ(serial[i]->isValid(), parallel[i]->isValid());
+            EXPECT_EQ(parallel[i]->isValid(), i + 1 < files.size());
+        }
+
+        deleteFiles(files);
+    }
+
+    CPU_TEST(ModelDecodeStreamsInOrder)
+    {
+        auto files = createSyntheticModels(16, 16);
+        std::vector<Model::LoadFlags> flags(files.size(), Model::LoadFlags::None);
+
+        // Files are handed over in the input order regardless of which thread finishes first
+        std::vector<uint32_t> order;
+        EXPECT(Model::decodeFiles(files, flags, 4, [&](uint32_t index, const Model::DecodedFile::SharedPtr& pFile)
+        {
+            EXPECT_EQ(pFile->getFilename(), files[index]);
+            order.push_back(index);
+            return true;
+        }));
+        EXPECT_EQ(order.size(), files.size());
+        for (uint32_t i = 0; i < order.size(); i++) EXPECT_EQ(order[i], i);
+
+        // Returning false stops the decoding
+        uint32_t callCount = 0;
+        EXPECT(Model::decodeFiles(files, flags, 4, [&](uint32_t index, const Model::DecodedFile::SharedPtr& pFile)
+        {
+            callCount++;
+            return index < 2;
+        }) == false);
+        EXPECT_EQ(callCount, 3);
+
+        deleteFiles(files);
+    }
+
+    GPU_TEST(ModelImportCacheMatchesImport)
+    {
+        // Keep the cache files out of the executable's directory
+        const std::string prevCacheDirectory = Model::getImportCacheDirectory();
+        const std::string cacheDirectory = getTempFilename() + "_ModelCache";
+        Model::setImportCacheDirectory(cacheDirectory);
+
+        auto files = createSyntheticModels(2, 16);
+        for (const auto& f : files)
+        {
+            // The first cached load stores the post-processed scene, the second one reads it back
+            Model::SharedPtr pImported = Model::createFromFile(f.c_str());
+            Model::SharedPtr pStored = Model::createFromFile(f.c_str(), Model::LoadFlags::CacheImportedScene);
+            Model::SharedPtr pCached = Model::createFromFile(f.c_str(), Model::LoadFlags::CacheImportedScene);
+            EXPECT(pImported != nullptr);
+            EXPECT(pStored != nullptr);
+            EXPECT(pCached != nullptr);
+            if (!pImported || !pStored || !pCached) continue;
+
+            for (const auto& pModel : { pStored, pCached })
+            {
+                EXPECT_EQ(pModel->getMeshCount(), pImported->getMeshCount());
+                EXPECT_EQ(pModel->getVertexCount(), pImported->getVertexCount());
+                EXPECT_EQ(pModel->getIndexCount(), pImported->getIndexCount());
+                EXPECT(pModel->getBoundingBox().center == pImported->getBoundingBox().center);
+                EXPECT(pModel->getBoundingBox().extent == pImported->getBoundingBox().extent);
+            }
+        }
+        deleteFiles(files);
+
+        EXPECT(isDirectoryExists(cacheDirectory));
+        std::experimental::filesystem::remove_all(cacheDirectory);
+        Model::setImportCacheDirectory(prevCacheDirectory);
+    }
+
+    CPU_BENCHMARK(ModelDecodeBenchmarkSerial)
+    {
+        auto files = createSyntheticModels(kModelCount, kGridSize);
+        auto decoded = Model::decodeFiles(files, std::vector<Model::LoadFlags>(files.size(), Model::LoadFlags::None), 1);
+        for (const auto& pFile : decoded) EXPECT(pFile->isValid());
+        deleteFiles(files);
+    }
+
+    CPU_BENCHMARK(ModelDecodeBenchmarkParallel)
+    {
+        auto files = createSyntheticModels(kModelCount, kGridSize);
+        auto decoded = Model::decodeFiles(files, std::vector<Model::LoadFlags>(files.size(), Model::LoadFlags::None));
+        for (const auto& pFile : decoded) EXPECT(pFile->isValid());
+        deleteFiles(files);
+    }
+}  // namespace Falcor
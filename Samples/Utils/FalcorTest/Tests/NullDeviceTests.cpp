@@ -0,0 +1,97 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include <fstream>
+
+#ifdef FALCOR_NULL
+namespace Falcor
+{
+    // A single quad with normals and texture coordinates, which is enough for the scene renderer
+    static std::string createQuadModel()
+    {
+        const std::string filename = getTempFilename() + "_quad.obj";
+        std::ofstream obj(filename);
+        obj << "v -1 -1 0\nv 1 -1 0\nv 1 1 0\nv -1 1 0\n";
+        obj << "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n";
+        obj << "vn 0 0 1\n";
+        obj << "f 1/1/1 2/2/1 3/3/1\nf 1/1/1 3/3/1 4/4/1\n";
+        return filename;
+    }
+
+    GPU_TEST(NullDeviceRecordsSceneDraws)
+    {
+        const uint32_t kInstanceCount = 3;
+
+        const std::string filename = createQuadModel();
+        Model::SharedPtr pModel = Model::createFromFile(filename.c_str());
+        std::remove(filename.c_str());
+        EXPECT(pModel != nullptr);
+        if (pModel == nullptr) return;
+
+        Scene::SharedPtr pScene = Scene::create();
+        for (uint32_t i = 0; i < kInstanceCount; i++)
+        {
+            pScene->addModelInstance(pModel, "Quad" + std::to_string(i), glm::vec3(float(i) * 3, 0, -5));
+        }
+        SceneRenderer::SharedPtr pRenderer = SceneRenderer::create(pScene);
+
+        GraphicsProgram::SharedPtr pProgram = GraphicsProgram::createFromFile("NullDeviceTests.ps.slang", "", "main");
+        GraphicsVars::SharedPtr pVars = GraphicsVars::create(pProgram->getReflector());
+        GraphicsState::SharedPtr pState = GraphicsState::create();
+        pState->setProgram(pProgram);
+        pState->setFbo(gpDevice->getSwapChainFbo());
+
+        // Presenting snapshots the counters of the frame, so start from a frame which only contains the scene
+        RenderContext* pContext = gpDevice->getRenderContext();
+        gpDevice->present();
+
+        pContext->clearFbo(pState->getFbo().get(), glm::vec4(0), 1, 0);
+        pContext->pushGraphicsState(pState);
+        pContext->pushGraphicsVars(pVars);
+        pRenderer->renderScene(pContext, nullptr);
+        pContext->popGraphicsVars();
+        pContext->popGraphicsState();
+        gpDevice->present();
+
+        // Every model instance is a separate draw of the single mesh
+        const NullApiStats& stats = gpDevice->getLastFrameStats();
+        EXPECT_EQ(stats.draws, kInstanceCount);
+        EXPECT_EQ(stats.instances, kInstanceCount);
+        EXPECT_EQ(stats.indirectDraws, 0);
+        EXPECT_EQ(stats.dispatches, 0);
+        EXPECT_EQ(stats.clears, 2);
+        EXPECT_GE(stats.pipelineBinds, 1);
+        EXPECT_GT(stats.copies, 0);
+        EXPECT_GT(stats.bytesCopied, 0);
+
+        // The next frame starts from zero
+        gpDevice->present();
+        EXPECT_EQ(gpDevice->getLastFrameStats().draws, 0);
+    }
+}
+#endif
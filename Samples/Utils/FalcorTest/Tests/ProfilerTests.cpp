@@ -0,0 +1,211 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include <thread>
+#include <atomic>
+#include <set>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Enables the trace recorder and discards previous records for the duration of a test
+        */
+        class ScopedTrace
+        {
+        public:
+            ScopedTrace() : mWasEnabled(Profiler::isTraceEnabled())
+            {
+                Profiler::setTraceEnabled(true);
+                Profiler::clearTrace();
+            }
+
+            ~ScopedTrace()
+            {
+                Profiler::setTraceEnabled(mWasEnabled);
+                Profiler::clearTrace();
+            }
+
+        private:
+            bool mWasEnabled;
+        };
+
+        std::vector<Profiler::TraceEvent> getThreadEvents(const std::vector<Profiler::TraceEvent>& events, uint32_t threadIndex)
+        {
+            std::vector<Profiler::TraceEvent> result;
+            for (const auto& e : events)
+            {
+                if (e.threadIndex == threadIndex) result.push_back(e);
+            }
+            return result;
+        }
+    }
+
+    CPU_TEST(ProfilerTraceNesting)
+    {
+        ScopedTrace trace;
+        Profiler::EventId outer = Profiler::registerTraceEvent("ProfilerTraceNesting/outer");
+        Profiler::EventId inner = Profiler::registerTraceEvent("ProfilerTraceNesting/inner");
+        EXPECT_EQ(Profiler::registerTraceEvent("ProfilerTraceNesting/outer"), outer);
+        EXPECT_NE(outer, inner);
+        EXPECT_EQ(Profiler::getTraceEventName(inner), "ProfilerTraceNesting/inner");
+
+        Profiler::beginTraceEvent(outer);
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            ProfilerTraceEvent e(inner);
+        }
+        Profiler::endTraceEvent(outer);
+
+        // Still running events are not reported
+        Profiler::beginTraceEvent(outer);
+        std::vector<Profiler::TraceEvent> events = Profiler::getTraceEvents();
+        Profiler::endTraceEvent(outer);
+
+        EXPECT_EQ(events.size(), 4);
+        if (events.size() != 4) return;
+        EXPECT_EQ(events[0].id, outer);
+        EXPECT_EQ(events[0].depth, 0);
+        for (uint32_t i = 1; i < 4; i++)
+        {
+            EXPECT_EQ(events[i].id, inner);
+            EXPECT_EQ(events[i].depth, 1);
+            EXPECT_EQ(events[i].threadIndex, events[0].threadIndex);
+            EXPECT_GE(events[i].startUs, events[0].startUs);
+            EXPECT_LE(events[i].startUs + events[i].durationUs, events[0].startUs + events[0].durationUs);
+            EXPECT_GE(events[i].startUs, events[i - 1].startUs);
+        }
+    }
+
+    CPU_TEST(ProfilerTraceThreads)
+    {
+        ScopedTrace trace;
+        const uint32_t threadCount = 4;
+        const uint32_t eventCount = 1000;
+        Profiler::EventId outer = Profiler::registerTraceEvent("ProfilerTraceThreads/outer");
+        Profiler::EventId inner = Profiler::registerTraceEvent("ProfilerTraceThreads/inner");
+
+        // Keep all the threads alive until they are done, so that each one records into its own buffer
+        std::atomic<uint32_t> done(0);
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&, t]()
+            {
+                Profiler::setThreadName("ProfilerTraceThreads worker " + std::to_string(t));
+                for (uint32_t i = 0; i < eventCount; i++)
+                {
+                    ProfilerTraceEvent o(outer);
+                    ProfilerTraceEvent n(inner);
+                }
+                done++;
+                while (done < threadCount) std::this_thread::yield();
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        std::vector<Profiler::TraceEvent> events = Profiler::getTraceEvents();
+        EXPECT_EQ(events.size(), threadCount * eventCount * 2);
+
+        std::set<uint32_t> threadIndices;
+        for (const auto& e : events) threadIndices.insert(e.threadIndex);
+        EXPECT_EQ(threadIndices.size(), threadCount);
+
+        for (uint32_t index : threadIndices)
+        {
+            std::vector<Profiler::TraceEvent> threadEvents = getThreadEvents(events, index);
+            EXPECT_EQ(threadEvents.size(), eventCount * 2);
+            for (size_t i = 0; i + 1 < threadEvents.size(); i += 2)
+            {
+                EXPECT_EQ(threadEvents[i].id, outer);
+                EXPECT_EQ(threadEvents[i].depth, 0);
+                EXPECT_EQ(threadEvents[i + 1].id, inner);
+                EXPECT_EQ(threadEvents[i + 1].depth, 1);
+            }
+        }
+
+        std::string json = Profiler::getChromeTrace();
+        EXPECT(json.find("\"traceEvents\"") != std::string::npos);
+        EXPECT(json.find("ProfilerTraceThreads/inner") != std::string::npos);
+        EXPECT(json.find("ProfilerTraceThreads worker 3") != std::string::npos);
+    }
+
+    CPU_TEST(ProfilerTraceRingBuffer)
+    {
+        ScopedTrace trace;
+        Profiler::EventId id = Profiler::registerTraceEvent("ProfilerTraceRingBuffer");
+        const uint32_t bufferSize = 64;
+
+        // Only threads which didn't record events yet use the new size, so record on a new thread
+        Profiler::setTraceBufferSize(bufferSize);
+        std::thread t([id]()
+        {
+            for (uint32_t i = 0; i < bufferSize * 4; i++)
+            {
+                ProfilerTraceEvent e(id);
+            }
+        });
+        t.join();
+        Profiler::setTraceBufferSize(64 * 1024);
+
+        // Each event uses 2 records, so only the last bufferSize / 2 events are kept
+        std::vector<Profiler::TraceEvent> events = Profiler::getTraceEvents();
+        uint32_t count = 0;
+        for (const auto& e : events) count += (e.id == id) ? 1 : 0;
+        EXPECT_EQ(count, bufferSize / 2);
+    }
+
+    CPU_TEST(ProfilerTraceDisabled)
+    {
+        ScopedTrace trace;
+        Profiler::setTraceEnabled(false);
+        Profiler::EventId id = Profiler::registerTraceEvent("ProfilerTraceDisabled");
+        {
+            ProfilerTraceEvent e(id);
+        }
+        for (const auto& e : Profiler::getTraceEvents())
+        {
+            EXPECT_NE(e.id, id);
+        }
+    }
+
+    CPU_BENCHMARK(ProfilerTraceBenchmark)
+    {
+        ScopedTrace trace;
+        const uint32_t eventCount = 1000000;
+        Profiler::EventId id = Profiler::registerTraceEvent("ProfilerTraceBenchmark");
+
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < eventCount; i++)
+        {
+            ProfilerTraceEvent e(id);
+        }
+        double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        logInfo("ProfilerTraceBenchmark: " + std::to_string(ms * 1e6 / eventCount) + " ns per event");
+    }
+}  // namespace Falcor
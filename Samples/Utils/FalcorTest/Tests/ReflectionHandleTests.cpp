@@ -0,0 +1,120 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        using BasicType = ReflectionBasicType::Type;
+
+        /** Builds the reflection of
+            cbuffer PerFrameCB
+            {
+                float4x4 gViewMat;
+                float2 gDim;
+                float gWeights[4];
+                struct { float3 posW; float intensity; float3 color; } gLights[8];
+            };
+        */
+        ReflectionResourceType::SharedPtr createPerFrameCB()
+        {
+            ReflectionStructType::SharedPtr pLight = ReflectionStructType::create(0, 32, "Light");
+            pLight->addMember(ReflectionVar::create("posW", ReflectionBasicType::create(0, BasicType::Float3, false, 12), 0));
+            pLight->addMember(ReflectionVar::create("intensity", ReflectionBasicType::create(12, BasicType::Float, false, 4), 12));
+            pLight->addMember(ReflectionVar::create("color", ReflectionBasicType::create(16, BasicType::Float3, false, 12), 16));
+
+            ReflectionStructType::SharedPtr pCB = ReflectionStructType::create(0, 400, "PerFrameCB");
+            pCB->addMember(ReflectionVar::create("gViewMat", ReflectionBasicType::create(0, BasicType::Float4x4, false, 64), 0));
+            pCB->addMember(ReflectionVar::create("gDim", ReflectionBasicType::create(64, BasicType::Float2, false, 8), 64));
+            pCB->addMember(ReflectionVar::create("gWeights", ReflectionArrayType::create(80, 4, 16, ReflectionBasicType::create(80, BasicType::Float, false, 4)), 80));
+            pCB->addMember(ReflectionVar::create("gLights", ReflectionArrayType::create(144, 8, 32, pLight), 144));
+
+            ReflectionResourceType::SharedPtr pBuffer = ReflectionResourceType::create(ReflectionResourceType::Type::ConstantBuffer, ReflectionResourceType::Dimensions::Buffer);
+            pBuffer->setStructType(pCB);
+            return pBuffer;
+        }
+    }
+
+    CPU_TEST(ReflectionVarHandleMatchesLookup)
+    {
+        ReflectionResourceType::SharedPtr pBuffer = createPerFrameCB();
+        const std::string names[] = { "gViewMat", "gDim", "gWeights", "gWeights[2]", "gLights[0].posW", "gLights[3].intensity", "gLights[7].color" };
+        for (const auto& name : names)
+        {
+            ReflectionVarHandle handle = ReflectionVarHandle::create(pBuffer, name);
+            ReflectionVar::SharedConstPtr pVar = pBuffer->findMember(name);
+            EXPECT(handle.isValid()) << name;
+            EXPECT(pVar != nullptr) << name;
+            if (!handle.isValid() || !pVar) continue;
+
+            const ReflectionResourceType::OffsetDesc& desc = pBuffer->getOffsetDesc(pVar->getOffset());
+            EXPECT_EQ(handle.getOffset(), pVar->getOffset()) << name;
+            EXPECT(handle.getBasicType() == desc.type) << name;
+            EXPECT_EQ(handle.getArraySize(), desc.count) << name;
+            EXPECT(handle.getOwner() == pBuffer.get()) << name;
+        }
+
+        EXPECT_EQ(ReflectionVarHandle::create(pBuffer, "gLights[3].intensity").getOffset(), 144 + 3 * 32 + 12);
+        EXPECT_EQ(ReflectionVarHandle::create(pBuffer, "gWeights").getArraySize(), 4);
+        EXPECT_EQ(ReflectionVarHandle::create(pBuffer, "gWeights[2]").getArraySize(), 2);
+
+        EXPECT(!ReflectionVarHandle::create(pBuffer, "gMissing").isValid());
+        EXPECT(!ReflectionVarHandle::create(pBuffer, "gLights[8].posW").isValid());
+        EXPECT(!ReflectionVarHandle().isValid());
+    }
+
+    GPU_BENCHMARK(ReflectionVarHandleBenchmark)
+    {
+        // Times ConstantBuffer::setVariable() by name, which parses the name and looks it up on every call, against the same sets through pre-resolved handles
+        ConstantBuffer::SharedPtr pCB = ConstantBuffer::create("PerFrameCB", createPerFrameCB());
+        EXPECT(pCB != nullptr);
+        if (!pCB) return;
+
+        std::vector<std::string> names;
+        for (uint32_t i = 0; i < 8; i++) names.push_back("gLights[" + std::to_string(i) + "].intensity");
+        std::vector<ReflectionVarHandle> handles;
+        for (const auto& name : names)
+        {
+            handles.push_back(pCB->getVariableHandle(name));
+            EXPECT(handles.back().isValid()) << name;
+            EXPECT_EQ(handles.back().getOffset(), pCB->getVariableOffset(name)) << name;
+        }
+
+        const uint32_t iterations = 20000;
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < iterations; i++) pCB->setVariable(names[i % names.size()], (float)i);
+        double nameMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < iterations; i++) pCB->setVariable(handles[i % handles.size()], (float)i);
+        double handleMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        logInfo("ReflectionVarHandleBenchmark: " + std::to_string(iterations) + " setVariable() calls, by name " + std::to_string(nameMs) + " ms, by handle " + std::to_string(handleMs) + " ms");
+    }
+}  // namespace Falcor
@@ -0,0 +1,139 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Experimental/RenderGraph/RenderPassReflection.h"
+#include "Experimental/RenderGraph/RenderGraph.h"
+#include "Experimental/RenderGraph/RenderPassLibrary.h"
+#include "Utils/Scripting/Scripting.h"
+
+namespace Falcor
+{
+    static RenderPassReflection createReflection(uint32_t sampleCount, ResourceFormat colorFormat)
+    {
+        RenderPassReflection r;
+        r.addInput("depth", "Depth buffer").format(ResourceFormat::D32Float);
+        r.addOutput("color", "Color buffer").texture2D(0, 0, sampleCount).format(colorFormat);
+        r.addInternal("scratch", "Scratch buffer").format(ResourceFormat::RGBA32Float);
+        return r;
+    }
+
+    CPU_TEST(RenderPassReflectionCompareEqual)
+    {
+        // The render-graph skips recompilation when a changed pass reflects identical fields
+        EXPECT(createReflection(1, ResourceFormat::RGBA8Unorm) == createReflection(1, ResourceFormat::RGBA8Unorm));
+        EXPECT(RenderPassReflection() == RenderPassReflection());
+    }
+
+    CPU_TEST(RenderPassReflectionCompareDifferent)
+    {
+        const RenderPassReflection base = createReflection(1, ResourceFormat::RGBA8Unorm);
+        EXPECT(base != createReflection(4, ResourceFormat::RGBA8Unorm));
+        EXPECT(base != createReflection(1, ResourceFormat::RGBA16Float));
+
+        RenderPassReflection extraField = createReflection(1, ResourceFormat::RGBA8Unorm);
+        extraField.addOutput("normals", "Normals");
+        EXPECT(base != extraField);
+
+        RenderPassReflection optionalInput = createReflection(1, ResourceFormat::RGBA8Unorm);
+        optionalInput.addInput("depth", "Depth buffer").flags(RenderPassReflection::Field::Flags::Optional);
+        EXPECT(base != optionalInput);
+    }
+
+    // A pass whose color output width is a creation parameter, so updatePass() can recreate it with the same or a different reflection
+    class ReflectionTestPass : public RenderPass
+    {
+    public:
+        static SharedPtr create(const Dictionary& dict) { return SharedPtr(new ReflectionTestPass(dict)); }
+
+        RenderPassReflection reflect() const override
+        {
+            RenderPassReflection r;
+            r.addOutput("color", "Color buffer").texture2D(mWidth, 32).format(ResourceFormat::RGBA8Unorm);
+            r.addOutput("normals", "Normals").texture2D(32, 32).format(ResourceFormat::RGBA16Float);
+            return r;
+        }
+
+        void execute(RenderContext* pRenderContext, const RenderData* pData) override {}
+        std::string getDesc() override { return "Render-graph recompilation test pass"; }
+
+    private:
+        ReflectionTestPass(const Dictionary& dict) : RenderPass("ReflectionTestPass")
+        {
+            if (dict.keyExists("width")) mWidth = dict["width"];
+        }
+        uint32_t mWidth = 32;
+    };
+
+    GPU_TEST(RenderGraphUpdatePassReusesResources)
+    {
+        // Pass dictionaries are python objects
+        Scripting::start();
+        static bool registered = false;
+        if (registered == false)
+        {
+            RenderPassLibrary::instance().registerClass("ReflectionTestPass", "Render-graph recompilation test pass", ReflectionTestPass::create);
+            registered = true;
+        }
+
+        Dictionary dict;
+        dict["width"] = 32u;
+        RenderGraph::SharedPtr pGraph = RenderGraph::create("RecompileTest");
+        pGraph->addPass(RenderPassLibrary::instance().createPass("ReflectionTestPass", dict), "pass");
+        pGraph->markOutput("pass.color");
+        pGraph->markOutput("pass.normals");
+        pGraph->onResize(gpDevice->getSwapChainFbo().get());
+        pGraph->execute(gpDevice->getRenderContext());
+
+        const RenderGraph::CompileStats stats = pGraph->getCompileStats();
+        EXPECT_EQ(stats.fullCompileCount, 1);
+        const Resource::SharedPtr pColor = pGraph->getOutput("pass.color");
+        const Resource::SharedPtr pNormals = pGraph->getOutput("pass.normals");
+        EXPECT(pColor != nullptr && pNormals != nullptr);
+
+        // Recreating the pass with the same parameters gives an identical reflection, so nothing is recompiled or reallocated
+        pGraph->updatePass("pass", dict);
+        pGraph->execute(gpDevice->getRenderContext());
+        EXPECT_EQ(pGraph->getCompileStats().fullCompileCount, stats.fullCompileCount);
+        EXPECT_EQ(pGraph->getCompileStats().resourceCompileCount, stats.resourceCompileCount);
+        EXPECT_EQ(pGraph->getCompileStats().skippedCompileCount, stats.skippedCompileCount + 1);
+        EXPECT(pGraph->getOutput("pass.color") == pColor);
+        EXPECT(pGraph->getOutput("pass.normals") == pNormals);
+
+        // A different width only re-resolves the resources. The changed output is reallocated, the unchanged one is reused
+        Dictionary wideDict;
+        wideDict["width"] = 64u;
+        pGraph->updatePass("pass", wideDict);
+        pGraph->execute(gpDevice->getRenderContext());
+        EXPECT_EQ(pGraph->getCompileStats().fullCompileCount, stats.fullCompileCount);
+        EXPECT_EQ(pGraph->getCompileStats().resourceCompileCount, stats.resourceCompileCount + 1);
+        const Texture::SharedPtr pWideColor = std::dynamic_pointer_cast<Texture>(pGraph->getOutput("pass.color"));
+        EXPECT(pWideColor != nullptr && pWideColor != pColor);
+        if (pWideColor) EXPECT_EQ(pWideColor->getWidth(), 64);
+        EXPECT(pGraph->getOutput("pass.normals") == pNormals);
+    }
+}  // namespace Falcor
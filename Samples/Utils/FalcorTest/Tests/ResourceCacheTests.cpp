@@ -0,0 +1,177 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Experimental/RenderGraph/ResourceCache.h"
+#include <random>
+
+namespace Falcor
+{
+    using Interval = ResourceCache::LifetimeInterval;
+
+    static Interval makeInterval(uint32_t firstUsed, uint32_t lastUsed, uint32_t compatClass, uint64_t size, bool canAlias = true)
+    {
+        Interval i;
+        i.firstUsed = firstUsed;
+        i.lastUsed = lastUsed;
+        i.compatClass = compatClass;
+        i.size = size;
+        i.canAlias = canAlias;
+        return i;
+    }
+
+    // Returns true if no two intervals sharing an allocation are used at the same time, and only compatible intervals are shared
+    static bool isValidPacking(const std::vector<Interval>& intervals, const std::vector<uint32_t>& assignment)
+    {
+        for (size_t a = 0; a < intervals.size(); a++)
+        {
+            for (size_t b = a + 1; b < intervals.size(); b++)
+            {
+                if (assignment[a] != assignment[b]) continue;
+                if (intervals[a].canAlias == false || intervals[b].canAlias == false) return false;
+                if (intervals[a].compatClass != intervals[b].compatClass) return false;
+                bool overlap = intervals[a].firstUsed <= intervals[b].lastUsed && intervals[b].firstUsed <= intervals[a].lastUsed;
+                if (overlap) return false;
+            }
+        }
+        return true;
+    }
+
+    CPU_TEST(ResourceCachePackLinearChain)
+    {
+        // A chain of passes where each pass reads the previous pass' output. Only two textures are needed to ping-pong between
+        const uint32_t kPassCount = 10;
+        std::vector<Interval> intervals;
+        for (uint32_t i = 0; i < kPassCount; i++)
+        {
+            intervals.push_back(makeInterval(i, i + 1, 0, 1024));
+        }
+
+        std::vector<uint64_t> sizes;
+        auto assignment = ResourceCache::packLifetimes(intervals, sizes);
+        EXPECT(isValidPacking(intervals, assignment));
+        EXPECT_EQ(sizes.size(), 2);
+    }
+
+    CPU_TEST(ResourceCachePackRespectsClasses)
+    {
+        // Non-overlapping resources with different properties must not share a texture
+        std::vector<Interval> intervals =
+        {
+            makeInterval(0, 1, 0, 256),
+            makeInterval(2, 3, 1, 512),
+            makeInterval(4, 5, 0, 256),
+            makeInterval(6, 7, 1, 512),
+        };
+
+        std::vector<uint64_t> sizes;
+        auto assignment = ResourceCache::packLifetimes(intervals, sizes);
+        EXPECT(isValidPacking(intervals, assignment));
+        EXPECT_EQ(sizes.size(), 2);
+        EXPECT_EQ(assignment[0], assignment[2]);
+        EXPECT_EQ(assignment[1], assignment[3]);
+    }
+
+    CPU_TEST(ResourceCachePackNonAliasable)
+    {
+        // Graph outputs live until the end of the graph, persistent resources can't be shared at all
+        std::vector<Interval> intervals =
+        {
+            makeInterval(0, 0, 0, 64, false),
+            makeInterval(1, 1, 0, 64),
+            makeInterval(2, uint32_t(-1), 0, 64),
+            makeInterval(3, 3, 0, 64),
+            makeInterval(4, 4, 0, 64, false),
+        };
+
+        std::vector<uint64_t> sizes;
+        auto assignment = ResourceCache::packLifetimes(intervals, sizes);
+        EXPECT(isValidPacking(intervals, assignment));
+        EXPECT_EQ(sizes.size(), 4);
+        // The graph output can reuse a texture which was freed before it, but nothing can reuse the graph output
+        EXPECT_EQ(assignment[1], assignment[2]);
+        EXPECT_NE(assignment[2], assignment[3]);
+    }
+
+    CPU_TEST(ResourceCachePackRandomGraphs)
+    {
+        std::mt19937 rng(42);
+        const uint32_t kClassCount = 3;
+        const uint64_t kClassSize[kClassCount] = { 1920 * 1080 * 4, 1920 * 1080 * 8, 1024 * 1024 * 4 };
+
+        for (uint32_t graph = 0; graph < 50; graph++)
+        {
+            const uint32_t passCount = 4 + rng() % 40;
+            std::vector<Interval> intervals;
+            for (uint32_t pass = 0; pass < passCount; pass++)
+            {
+                // Each pass produces 1-3 resources, read by a later pass
+                uint32_t outputCount = 1 + rng() % 3;
+                for (uint32_t o = 0; o < outputCount; o++)
+                {
+                    uint32_t lastUsed = pass + rng() % (passCount - pass);
+                    uint32_t compatClass = rng() % kClassCount;
+                    intervals.push_back(makeInterval(pass, lastUsed, compatClass, kClassSize[compatClass], (rng() % 16) != 0));
+                }
+            }
+
+            std::vector<uint64_t> sizes;
+            auto assignment = ResourceCache::packLifetimes(intervals, sizes);
+            EXPECT(isValidPacking(intervals, assignment));
+
+            // The number of shareable allocations per class must equal the maximum number of resources of that class alive at once
+            uint64_t bytesBefore = 0;
+            uint64_t bytesAfter = 0;
+            for (const auto& i : intervals) bytesBefore += i.size;
+            for (uint64_t s : sizes) bytesAfter += s;
+            EXPECT_LE(bytesAfter, bytesBefore);
+
+            for (uint32_t c = 0; c < kClassCount; c++)
+            {
+                uint32_t maxAlive = 0;
+                for (uint32_t t = 0; t < passCount; t++)
+                {
+                    uint32_t alive = 0;
+                    for (const auto& i : intervals) alive += (i.canAlias && i.compatClass == c && i.firstUsed <= t && t <= i.lastUsed) ? 1 : 0;
+                    maxAlive = std::max(maxAlive, alive);
+                }
+
+                std::vector<bool> seen(sizes.size(), false);
+                uint32_t allocationCount = 0;
+                for (size_t i = 0; i < intervals.size(); i++)
+                {
+                    if (intervals[i].canAlias && intervals[i].compatClass == c && seen[assignment[i]] == false)
+                    {
+                        seen[assignment[i]] = true;
+                        allocationCount++;
+                    }
+                }
+                EXPECT_EQ(allocationCount, maxAlive);
+            }
+        }
+    }
+}  // namespace Falcor
@@ -0,0 +1,151 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/Scene/SceneBVH.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        // A city-like grid of boxes: 128x128 blocks with 12 stacked instances each, ~200k items in total
+        const uint32_t kGridSize = 128;
+        const uint32_t kGridHeight = 12;
+        const uint32_t kCullIterations = 20;
+
+        std::vector<BoundingBox> createBoxGrid()
+        {
+            std::vector<BoundingBox> boxes;
+            boxes.reserve(kGridSize * kGridSize * kGridHeight);
+            for (uint32_t x = 0; x < kGridSize; x++)
+            {
+                for (uint32_t z = 0; z < kGridSize; z++)
+                {
+                    for (uint32_t y = 0; y < kGridHeight; y++)
+                    {
+                        BoundingBox box;
+                        box.center = glm::vec3(x * 4.0f, y * 3.0f, z * 4.0f);
+                        box.extent = glm::vec3(1.0f + (x % 3) * 0.25f, 1.0f, 1.0f + (z % 2) * 0.5f);
+                        boxes.push_back(box);
+                    }
+                }
+            }
+            return boxes;
+        }
+
+        Camera::SharedPtr createCamera()
+        {
+            Camera::SharedPtr pCamera = Camera::create();
+            pCamera->setAspectRatio(16.0f / 9.0f);
+            pCamera->setDepthRange(0.1f, 300.0f);
+            pCamera->setPosition(glm::vec3(-10.0f, 20.0f, -10.0f));
+            pCamera->setTarget(glm::vec3(100.0f, 0.0f, 150.0f));
+            pCamera->setUpVector(glm::vec3(0.0f, 1.0f, 0.0f));
+            return pCamera;
+        }
+
+        uint32_t cullFlat(const Camera* pCamera, const std::vector<BoundingBox>& boxes, std::vector<uint8_t>& visibility)
+        {
+            uint32_t visibleCount = 0;
+            visibility.assign(boxes.size(), 0);
+            for (size_t i = 0; i < boxes.size(); i++)
+            {
+                if (pCamera->isObjectCulled(boxes[i]) == false)
+                {
+                    visibility[i] = 1;
+                    visibleCount++;
+                }
+            }
+            return visibleCount;
+        }
+    }
+
+    CPU_TEST(SceneBVHCullMatchesFlat)
+    {
+        std::vector<BoundingBox> boxes = createBoxGrid();
+        Camera::SharedPtr pCamera = createCamera();
+        SceneBVH::SharedPtr pBVH = SceneBVH::create();
+        pBVH->build(boxes);
+        EXPECT_EQ(pBVH->getItemCount(), (uint32_t)boxes.size());
+
+        std::vector<uint8_t> flat, hierarchical;
+        uint32_t flatCount = cullFlat(pCamera.get(), boxes, flat);
+        uint32_t bvhCount = pBVH->cull(pCamera.get(), hierarchical);
+        EXPECT_GT(flatCount, 0u);
+        EXPECT_LT(flatCount, (uint32_t)boxes.size());
+        EXPECT_EQ(flatCount, bvhCount);
+        for (size_t i = 0; i < boxes.size(); i++)
+        {
+            EXPECT_EQ((int)flat[i], (int)hierarchical[i]) << "item " << i;
+        }
+
+        // Move every 7th box and check that refitting keeps the results in sync
+        for (uint32_t i = 0; i < (uint32_t)boxes.size(); i += 7)
+        {
+            boxes[i].center += glm::vec3(150.0f, 5.0f, -60.0f);
+            pBVH->setItemBounds(i, boxes[i]);
+        }
+        pBVH->refit();
+
+        flatCount = cullFlat(pCamera.get(), boxes, flat);
+        bvhCount = pBVH->cull(pCamera.get(), hierarchical);
+        EXPECT_EQ(flatCount, bvhCount);
+        for (size_t i = 0; i < boxes.size(); i++)
+        {
+            EXPECT_EQ((int)flat[i], (int)hierarchical[i]) << "item " << i;
+        }
+    }
+
+    // The following two tests run the same workload, compare their run times to see the benefit of the hierarchy
+    CPU_BENCHMARK(SceneBVHCullBenchmarkFlat)
+    {
+        std::vector<BoundingBox> boxes = createBoxGrid();
+        Camera::SharedPtr pCamera = createCamera();
+        std::vector<uint8_t> visibility;
+        uint32_t visibleCount = 0;
+        for (uint32_t i = 0; i < kCullIterations; i++)
+        {
+            visibleCount += cullFlat(pCamera.get(), boxes, visibility);
+        }
+        EXPECT_GT(visibleCount, 0u);
+    }
+
+    CPU_BENCHMARK(SceneBVHCullBenchmarkHierarchical)
+    {
+        std::vector<BoundingBox> boxes = createBoxGrid();
+        Camera::SharedPtr pCamera = createCamera();
+        SceneBVH::SharedPtr pBVH = SceneBVH::create();
+        pBVH->build(boxes);
+        std::vector<uint8_t> visibility;
+        uint32_t visibleCount = 0;
+        for (uint32_t i = 0; i < kCullIterations; i++)
+        {
+            visibleCount += pBVH->cull(pCamera.get(), visibility);
+        }
+        EXPECT_GT(visibleCount, 0u);
+    }
+}  // namespace Falcor
@@ -0,0 +1,176 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Points the shader cache to a new empty directory for the duration of a test
+        */
+        class ScopedCacheDirectory
+        {
+        public:
+            ScopedCacheDirectory() : mPrevDirectory(ShaderCache::getDirectory())
+            {
+                mDirectory = getTempFilename() + "_ShaderCache";
+                createDirectory(mDirectory);
+                ShaderCache::setDirectory(mDirectory);
+                ShaderCache::resetStats();
+            }
+
+            ~ScopedCacheDirectory()
+            {
+                ShaderCache::clear();
+                ShaderCache::setDirectory(mPrevDirectory);
+            }
+
+        private:
+            std::string mDirectory;
+            std::string mPrevDirectory;
+        };
+
+        void writeFile(const std::string& filename, const std::string& content)
+        {
+            std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+            file << content;
+        }
+
+        ShaderCache::Entry createEntry(const std::string& dependency)
+        {
+            ShaderCache::Entry entry;
+            entry.code[(uint32_t)ShaderType::Vertex] = { 1, 2, 3, 4 };
+            entry.code[(uint32_t)ShaderType::Pixel] = { 5, 6, 7, 8, 9 };
+            entry.reflection = { 10, 11, 12 };
+            ShaderCache::Dependency d;
+            d.path = dependency;
+            hashFile(dependency, d.hash);
+            entry.dependencies.push_back(d);
+            return entry;
+        }
+    }
+
+    CPU_TEST(ShaderCacheRoundTrip)
+    {
+        ScopedCacheDirectory cacheDir;
+        std::string dependency = getTempFilename();
+        writeFile(dependency, "float4 main() : SV_TARGET { return 1; }");
+
+        const std::string key = "ShaderCacheRoundTrip";
+        ShaderCache::Entry entry = createEntry(dependency);
+        ShaderCache::Entry loaded;
+        EXPECT(!ShaderCache::load(key, loaded));
+        EXPECT(ShaderCache::store(key, entry));
+        EXPECT(ShaderCache::load(key, loaded));
+
+        for (uint32_t i = 0; i < ShaderCache::kShaderCount; i++)
+        {
+            EXPECT(loaded.code[i] == entry.code[i]) << "stage " << i;
+        }
+        EXPECT(loaded.reflection == entry.reflection);
+        EXPECT_EQ(loaded.dependencies.size(), 1);
+        EXPECT_EQ(loaded.dependencies[0].path, dependency);
+        EXPECT_EQ(loaded.dependencies[0].hash, entry.dependencies[0].hash);
+
+        Shader::Blob blob = ShaderCache::createBlob(loaded.code[(uint32_t)ShaderType::Pixel]);
+        EXPECT_EQ(blob->getBufferSize(), 5);
+        EXPECT_EQ(memcmp(blob->getBufferPointer(), loaded.code[(uint32_t)ShaderType::Pixel].data(), 5), 0);
+
+        ShaderCache::Stats stats = ShaderCache::getStats();
+        EXPECT_EQ(stats.hits, 1);
+        EXPECT_EQ(stats.misses, 1);
+        EXPECT_EQ(stats.rejected, 0);
+        EXPECT_EQ(stats.stores, 1);
+        std::remove(dependency.c_str());
+    }
+
+    CPU_TEST(ShaderCacheRejectsInvalidEntries)
+    {
+        ScopedCacheDirectory cacheDir;
+        std::string dependency = getTempFilename();
+        writeFile(dependency, "#define VALUE 1");
+
+        const std::string key = "ShaderCacheRejectsInvalidEntries";
+        ShaderCache::Entry loaded;
+        EXPECT(ShaderCache::store(key, createEntry(dependency)));
+
+        // Flip a byte in the payload
+        std::string filename = ShaderCache::getEntryFilename(key);
+        std::string content = readFile(filename);
+        content[content.size() - 1] ^= 0xff;
+        writeFile(filename, content);
+        EXPECT(!ShaderCache::load(key, loaded));
+
+        // Truncate the file
+        writeFile(filename, content.substr(0, content.size() / 2));
+        EXPECT(!ShaderCache::load(key, loaded));
+
+        // Modify an included file
+        EXPECT(ShaderCache::store(key, createEntry(dependency)));
+        EXPECT(ShaderCache::load(key, loaded));
+        writeFile(dependency, "#define VALUE 2");
+        EXPECT(!ShaderCache::load(key, loaded));
+
+        ShaderCache::Stats stats = ShaderCache::getStats();
+        EXPECT_EQ(stats.hits, 1);
+        EXPECT_EQ(stats.misses, 3);
+        EXPECT_EQ(stats.rejected, 3);
+        std::remove(dependency.c_str());
+    }
+
+    GPU_TEST(ShaderCacheProgram)
+    {
+        ScopedCacheDirectory cacheDir;
+
+        // Use a unique define so that the first compilation can't be found in the cache
+        Program::DefineList defines;
+        defines.add("SHADER_CACHE_TEST", std::to_string(std::hash<std::string>()(getTempFilename())));
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            ctx.createProgram("ShadingUtilsTests.cs.slang", "testRadicalInverse", defines);
+            ctx.allocateStructuredBuffer("result", 4);
+            ctx["TestCB"]["resultSize"] = 4;
+            ctx.runProgram();
+
+            const float *s = ctx.mapBuffer<const float>("result");
+            EXPECT_EQ(s[0], 0.f);
+            EXPECT_EQ(s[1], 0.5f);
+            EXPECT_EQ(s[2], 0.25f);
+            EXPECT_EQ(s[3], 0.75f);
+            ctx.unmapBuffer("result");
+        }
+
+        ShaderCache::Stats stats = ShaderCache::getStats();
+        EXPECT_EQ(stats.misses, 1);
+        EXPECT_EQ(stats.stores, 1);
+        EXPECT_EQ(stats.hits, 1);
+        logInfo("ShaderCacheProgram: miss " + std::to_string(stats.missTimeMs) + " ms, hit " + std::to_string(stats.hitTimeMs) + " ms");
+    }
+}  // namespace Falcor
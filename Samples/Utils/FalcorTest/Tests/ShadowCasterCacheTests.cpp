@@ -0,0 +1,225 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Effects/Shadows/ShadowCasterCache.h"
+#include "glm/gtc/matrix_transform.hpp"
+#include <cmath>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Cascade 0 covers [-10, 10] in x and y, cascade 1 covers [-50, 50]
+        const glm::mat4 kNearCascade = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, -100.0f, 100.0f);
+        const glm::mat4 kFarCascade = glm::ortho(-50.0f, 50.0f, -50.0f, 50.0f, -100.0f, 100.0f);
+
+        BoundingBox createBox(const glm::vec3& center, float halfSize = 1.0f)
+        {
+            return BoundingBox::fromMinMax(center - halfSize, center + halfSize);
+        }
+
+        struct TestCaster
+        {
+            uint64_t id;
+            uint32_t version;
+            glm::vec3 position;
+            bool alwaysDynamic;
+        };
+
+        uint32_t runFrame(ShadowCasterCache* pCache, const std::vector<TestCaster>& casters)
+        {
+            pCache->beginFrame();
+            for (const auto& c : casters) pCache->updateCaster(c.id, c.version, createBox(c.position), c.alwaysDynamic);
+            pCache->setCascade(0, kNearCascade);
+            pCache->setCascade(1, kFarCascade);
+            return pCache->endFrame();
+        }
+    }
+
+    CPU_TEST(ShadowCasterCacheBoxTest)
+    {
+        EXPECT(ShadowCasterCache::isBoxInCascade(createBox(glm::vec3(0.0f)), kNearCascade));
+        EXPECT(ShadowCasterCache::isBoxInCascade(createBox(glm::vec3(10.5f, 0.0f, 0.0f)), kNearCascade));
+        EXPECT(!ShadowCasterCache::isBoxInCascade(createBox(glm::vec3(20.0f, 0.0f, 0.0f)), kNearCascade));
+        EXPECT(!ShadowCasterCache::isBoxInCascade(createBox(glm::vec3(0.0f, -20.0f, 0.0f)), kNearCascade));
+        EXPECT(ShadowCasterCache::isBoxInCascade(createBox(glm::vec3(20.0f, 0.0f, 0.0f)), kFarCascade));
+
+        // Depth is ignored, casters in front of the cascade still shadow it
+        EXPECT(ShadowCasterCache::isBoxInCascade(createBox(glm::vec3(0.0f, 0.0f, 500.0f)), kNearCascade));
+    }
+
+    CPU_TEST(ShadowCasterCacheInvalidation)
+    {
+        ShadowCasterCache::UniquePtr pCache = ShadowCasterCache::create(4);
+        std::vector<TestCaster> casters = { { 0, 0, glm::vec3(0.0f), false }, { 1, 0, glm::vec3(30.0f, 0.0f, 0.0f), false }, { 2, 0, glm::vec3(-30.0f, 0.0f, 0.0f), true } };
+
+        // Everything needs to be rendered on the first frame. New casters are static, unless they are animated
+        EXPECT_EQ(runFrame(pCache.get(), casters), 3u);
+        EXPECT(pCache->isCasterStatic(0));
+        EXPECT(pCache->isCasterStatic(1));
+        EXPECT(!pCache->isCasterStatic(2));
+        EXPECT_EQ(pCache->getStats().staticCasterCount, 2u);
+        EXPECT_EQ(pCache->getStats().dynamicCasterCount, 1u);
+
+        // The invalidation persists until the cascades are rendered
+        EXPECT_EQ(runFrame(pCache.get(), casters), 3u);
+        pCache->markCascadesRendered(3);
+        EXPECT_EQ(pCache->getInvalidCascadeMask(), 0u);
+        EXPECT_EQ(runFrame(pCache.get(), casters), 0u);
+
+        // Moving the far caster dirties the far cascade only. It stays dynamic until it settles
+        casters[1].version++;
+        casters[1].position.x += 1.0f;
+        EXPECT_EQ(runFrame(pCache.get(), casters), 2u);
+        EXPECT(!pCache->isCasterStatic(1));
+        EXPECT_EQ(pCache->getStats().dirtyRegionCount, 1u);
+        pCache->markCascadesRendered(2);
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            EXPECT_EQ(runFrame(pCache.get(), casters), 0u);
+            EXPECT(!pCache->isCasterStatic(1));
+        }
+        EXPECT_EQ(runFrame(pCache.get(), casters), 2u);
+        EXPECT(pCache->isCasterStatic(1));
+        pCache->markCascadesRendered(2);
+
+        // Animated casters never dirty the cache
+        casters[2].version++;
+        EXPECT_EQ(runFrame(pCache.get(), casters), 0u);
+
+        // Removing the near caster dirties both cascades
+        casters.erase(casters.begin());
+        EXPECT_EQ(runFrame(pCache.get(), casters), 3u);
+        pCache->markCascadesRendered(3);
+
+        // A new cascade transform invalidates only that cascade
+        pCache->beginFrame();
+        for (const auto& c : casters) pCache->updateCaster(c.id, c.version, createBox(c.position), c.alwaysDynamic);
+        pCache->setCascade(0, glm::translate(kNearCascade, glm::vec3(1.0f, 0.0f, 0.0f)));
+        pCache->setCascade(1, kFarCascade);
+        EXPECT_EQ(pCache->endFrame(), 1u);
+        pCache->markCascadesRendered(1);
+        EXPECT_EQ(runFrame(pCache.get(), casters), 1u);
+        pCache->markCascadesRendered(1);
+        EXPECT_EQ(runFrame(pCache.get(), casters), 0u);
+
+        pCache->invalidateAll();
+        EXPECT_EQ(runFrame(pCache.get(), casters), 3u);
+        EXPECT_EQ(pCache->getStats().invalidCascadeCount, 2u);
+    }
+
+    CPU_TEST(ShadowCasterCacheDeletedCaster)
+    {
+        ShadowCasterCache::UniquePtr pCache = ShadowCasterCache::create(4);
+        std::vector<TestCaster> casters = { { 100, 0, glm::vec3(0.0f), false }, { 200, 0, glm::vec3(30.0f, 0.0f, 0.0f), false } };
+        runFrame(pCache.get(), casters);
+        pCache->markCascadesRendered(3);
+        EXPECT_EQ(runFrame(pCache.get(), casters), 0u);
+
+        // Deleting a caster only dirties its own region. The other caster keeps its ID, so it stays cached
+        casters.erase(casters.begin());
+        EXPECT_EQ(runFrame(pCache.get(), casters), 3u);
+        EXPECT(pCache->isCasterStatic(200));
+        EXPECT_EQ(pCache->getStats().staticCasterCount, 1u);
+        EXPECT_EQ(pCache->getStats().dirtyRegionCount, 1u);
+        pCache->markCascadesRendered(3);
+        EXPECT_EQ(runFrame(pCache.get(), casters), 0u);
+
+        // An ID which now belongs to a different caster with the same version is detected by its bounds
+        casters[0].position = glm::vec3(-30.0f, 0.0f, 0.0f);
+        EXPECT_EQ(runFrame(pCache.get(), casters), 2u);
+        EXPECT(!pCache->isCasterStatic(200));
+    }
+
+    CPU_BENCHMARK(ShadowCasterCacheBenchmark)
+    {
+        // A static scene with a few characters walking around the camera, and a prop knocked over every now and then
+        const uint32_t casterCount = 20000;
+        const uint32_t movingCount = 16;
+        const uint32_t frameCount = 60;
+        const uint32_t propInterval = 20;
+        std::vector<TestCaster> casters(casterCount);
+        for (uint32_t i = 0; i < casterCount; i++)
+        {
+            casters[i] = { i, 0, glm::vec3(float(i % 200) - 100.0f, float(i / 200) - 50.0f, 0.0f), false };
+        }
+
+        ShadowCasterCache::UniquePtr pCache = ShadowCasterCache::create();
+        runFrame(pCache.get(), casters);
+        pCache->markCascadesRendered(3);
+
+        const glm::mat4 cascades[] = { kNearCascade, kFarCascade };
+        auto isDrawn = [&](const TestCaster& c, uint32_t cascadeMask)
+        {
+            BoundingBox box = createBox(c.position);
+            for (uint32_t i = 0; i < arraysize(cascades); i++)
+            {
+                if ((cascadeMask & (1u << i)) && ShadowCasterCache::isBoxInCascade(box, cascades[i])) return true;
+            }
+            return false;
+        };
+
+        uint32_t uncachedDraws = 0;
+        uint32_t cachedDraws = 0;
+        uint32_t renderedCascades = 0;
+        double ms = 0;
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            for (uint32_t i = 0; i < movingCount; i++)
+            {
+                casters[i].version++;
+                casters[i].position = glm::vec3(5.0f * std::cos(0.1f * frame + i), 5.0f * std::sin(0.1f * frame + i), 0.0f);
+            }
+            if (frame % propInterval == propInterval - 1)
+            {
+                TestCaster& prop = casters[movingCount + frame * 131 % (casterCount - movingCount)];
+                prop.version++;
+                prop.position.z += 1.0f;
+            }
+
+            auto start = CpuTimer::getCurrentTimePoint();
+            const uint32_t invalidCascades = runFrame(pCache.get(), casters);
+            ms += CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+            // Without the cache every caster in the cascades is drawn. With it, the static casters are only drawn into the invalid cascades
+            for (const auto& c : casters)
+            {
+                if (isDrawn(c, 3)) uncachedDraws++;
+                if (isDrawn(c, pCache->isCasterStatic(c.id) ? invalidCascades : 3)) cachedDraws++;
+            }
+            for (uint32_t mask = invalidCascades; mask; mask &= mask - 1) renderedCascades++;
+            pCache->markCascadesRendered(invalidCascades);
+        }
+
+        // Once the characters started moving they stay dynamic, so only their first move and the props invalidate the cache
+        for (uint32_t i = 0; i < movingCount; i++) EXPECT(!pCache->isCasterStatic(i));
+        EXPECT_LE(renderedCascades, 2 * (1 + 2 * (frameCount / propInterval)));
+        EXPECT_LT(cachedDraws, uncachedDraws);
+        logInfo("ShadowCasterCacheBenchmark: " + std::to_string(casterCount) + " casters, " + std::to_string(movingCount) + " moving. Cascades rendered: " + std::to_string(renderedCascades) + " cached vs " + std::to_string(2 * frameCount) + " uncached. Casters drawn per frame: " + std::to_string(cachedDraws / frameCount) + " cached vs " + std::to_string(uncachedDraws / frameCount) + " uncached. " + std::to_string(ms / frameCount) + " ms per frame to track the casters");
+    }
+}  // namespace Falcor
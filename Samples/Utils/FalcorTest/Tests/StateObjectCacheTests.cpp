@@ -0,0 +1,235 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Utils/StateObjectCache.h"
+#include "API/GraphicsStateObject.h"
+#include "Utils/Hash.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidBlend = 0xFFFFFFFF;
+
+        // Only a few distinct hash values, to make sure colliding descriptors are kept apart
+        struct CollidingDesc
+        {
+            uint32_t program = 0;
+            uint32_t blend = 0;
+
+            uint64_t getHash() const { return program % 4; }
+            bool operator==(const CollidingDesc& other) const { return program == other.program && blend == other.blend; }
+        };
+
+        // Hashes all of its fields, like the real descriptors
+        struct TestDesc
+        {
+            uint32_t program = 0;
+            uint32_t blend = 0;
+
+            uint64_t getHash() const { return hashData(this, sizeof(*this)); }
+            bool operator==(const TestDesc& other) const { return program == other.program && blend == other.blend; }
+        };
+
+        // A state object which doesn't need a device
+        template<typename DescType>
+        class TestStateObject
+        {
+        public:
+            using SharedPtr = std::shared_ptr<TestStateObject>;
+            using Desc = DescType;
+
+            static SharedPtr create(const Desc& desc)
+            {
+                sCreateCount++;
+                return (desc.blend == kInvalidBlend) ? nullptr : SharedPtr(new TestStateObject(desc));
+            }
+
+            const Desc& getDesc() const { return mDesc; }
+
+            static uint32_t sCreateCount;
+
+        private:
+            TestStateObject(const Desc& desc) : mDesc(desc) {}
+            Desc mDesc;
+        };
+
+        template<typename DescType>
+        uint32_t TestStateObject<DescType>::sCreateCount = 0;
+
+        using CollidingObject = TestStateObject<CollidingDesc>;
+        using CollidingCache = StateObjectCache<CollidingObject>;
+        using TestObject = TestStateObject<TestDesc>;
+        using TestCache = StateObjectCache<TestObject>;
+
+        template<typename DescType>
+        std::vector<DescType> createDescs(uint32_t count)
+        {
+            std::vector<DescType> descs(count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                descs[i].program = i / 3;
+                descs[i].blend = i % 3;
+            }
+            return descs;
+        }
+    }
+
+    CPU_TEST(StateObjectCacheLookup)
+    {
+        CollidingCache::SharedPtr pCache = CollidingCache::create();
+        CollidingObject::sCreateCount = 0;
+
+        const auto descs = createDescs<CollidingDesc>(64);
+        std::vector<CollidingObject::SharedPtr> objects;
+        for (const auto& d : descs) objects.push_back(pCache->getObject(d));
+        EXPECT_EQ(CollidingObject::sCreateCount, 64u);
+        EXPECT_EQ(pCache->getObjectCount(), 64u);
+
+        // Every descriptor maps to its own object, even though the hashes collide
+        for (size_t i = 0; i < descs.size(); i++)
+        {
+            EXPECT(objects[i] != nullptr);
+            EXPECT(objects[i]->getDesc() == descs[i]);
+            EXPECT(pCache->getObject(descs[i]) == objects[i]) << "desc " << i;
+            EXPECT(pCache->findObject(descs[i]) == objects[i]) << "desc " << i;
+        }
+        EXPECT_EQ(CollidingObject::sCreateCount, 64u);
+
+        CollidingCache::Stats stats = pCache->getStats();
+        EXPECT_EQ(stats.misses, 64ull);
+        EXPECT_EQ(stats.hits, 64ull);
+        EXPECT_EQ(stats.failed, 0ull);
+
+        // Failed objects aren't cached
+        CollidingDesc invalid;
+        invalid.blend = kInvalidBlend;
+        EXPECT(pCache->getObject(invalid) == nullptr);
+        EXPECT(pCache->findObject(invalid) == nullptr);
+        EXPECT_EQ(pCache->getStats().failed, 1ull);
+        EXPECT_EQ(pCache->getObjectCount(), 64u);
+
+        pCache->resetStats();
+        EXPECT_EQ(pCache->getStats().hits, 0ull);
+        pCache->clear();
+        EXPECT_EQ(pCache->getObjectCount(), 0u);
+        EXPECT(pCache->findObject(descs[0]) == nullptr);
+    }
+
+    CPU_TEST(StateObjectCachePrewarm)
+    {
+        // Record the descriptors used by one cache and prewarm another one with them
+        TestCache::SharedPtr pRecorded = TestCache::create();
+        const auto descs = createDescs<TestDesc>(100);
+        for (const auto& d : descs) pRecorded->getObject(d);
+        std::vector<TestDesc> recorded = pRecorded->getDescs();
+        EXPECT_EQ(recorded.size(), descs.size());
+
+        uint32_t customCreateCount = 0;
+        TestCache::SharedPtr pCache = TestCache::create([&customCreateCount](const TestDesc& desc) { customCreateCount++; return TestObject::create(desc); });
+        EXPECT_EQ(pCache->prewarm(recorded), 100u);
+        EXPECT_EQ(pCache->prewarm(recorded), 0u);
+        EXPECT_EQ(customCreateCount, 100u);
+        EXPECT_EQ(pCache->getStats().prewarmed, 100ull);
+
+        for (const auto& d : descs) pCache->getObject(d);
+        EXPECT_EQ(pCache->getStats().hits, 100ull);
+        EXPECT_EQ(pCache->getStats().misses, 0ull);
+        EXPECT_EQ(customCreateCount, 100u);
+    }
+
+    CPU_TEST(StateObjectCacheRemoveIf)
+    {
+        TestCache::SharedPtr pCache = TestCache::create();
+        const auto descs = createDescs<TestDesc>(30);
+        TestObject::SharedPtr pKept = pCache->getObject(descs[0]);
+        for (const auto& d : descs) pCache->getObject(d);
+
+        // Releasing a program's objects keeps the others, and objects in use stay valid
+        EXPECT_EQ(pCache->removeIf([](const TestDesc& desc) { return desc.program == 0; }), 3u);
+        EXPECT_EQ(pCache->getObjectCount(), 27u);
+        EXPECT(pCache->findObject(descs[0]) == nullptr);
+        EXPECT(pCache->findObject(descs[3]) != nullptr);
+        EXPECT(pKept->getDesc() == descs[0]);
+        EXPECT_EQ(pCache->removeIf([](const TestDesc& desc) { return desc.program == 0; }), 0u);
+
+        // A released object is created again on the next lookup
+        EXPECT(pCache->getObject(descs[0]) != pKept);
+        EXPECT_EQ(pCache->getObjectCount(), 28u);
+    }
+
+    CPU_TEST(GraphicsStateObjectDescHash)
+    {
+        RasterizerState::SharedPtr pRastState = RasterizerState::create(RasterizerState::Desc().setCullMode(RasterizerState::CullMode::None));
+        GraphicsStateObject::Desc desc0;
+        desc0.setRasterizerState(pRastState).setPrimitiveType(GraphicsStateObject::PrimitiveType::Triangle).setFboFormats(Fbo::Desc().setColorTarget(0, ResourceFormat::RGBA8Unorm));
+        GraphicsStateObject::Desc desc1 = desc0;
+        EXPECT(desc0 == desc1);
+        EXPECT_EQ(desc0.getHash(), desc1.getHash());
+
+        desc1.setSampleMask(0x1);
+        EXPECT(!(desc0 == desc1));
+        EXPECT_NE(desc0.getHash(), desc1.getHash());
+
+        desc1 = desc0;
+        desc1.setFboFormats(Fbo::Desc().setColorTarget(0, ResourceFormat::RGBA16Float));
+        EXPECT(!(desc0 == desc1));
+        EXPECT_NE(desc0.getHash(), desc1.getHash());
+
+        desc1 = desc0;
+        desc1.setRasterizerState(nullptr);
+        EXPECT(!(desc0 == desc1));
+        EXPECT_NE(desc0.getHash(), desc1.getHash());
+
+        // A null state is the same as the default state
+        GraphicsStateObject::Desc nullStates;
+        GraphicsStateObject::Desc defaultStates;
+        EXPECT(nullStates == defaultStates);
+        EXPECT_EQ(nullStates.getHash(), defaultStates.getHash());
+    }
+
+    CPU_BENCHMARK(StateObjectCacheBenchmark)
+    {
+        // The lookup time must not grow with the number of cached descriptors
+        const uint32_t lookupCount = 100000;
+        for (uint32_t descCount : { 1000u, 10000u, 100000u })
+        {
+            TestCache::SharedPtr pCache = TestCache::create();
+            const auto descs = createDescs<TestDesc>(descCount);
+            pCache->prewarm(descs);
+
+            auto start = CpuTimer::getCurrentTimePoint();
+            for (uint32_t i = 0; i < lookupCount; i++) pCache->getObject(descs[(i * 7919ull) % descCount]);
+            double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+            EXPECT_EQ(pCache->getStats().hits, (uint64_t)lookupCount);
+            EXPECT_EQ(pCache->getStats().misses, 0ull);
+            logInfo("StateObjectCacheBenchmark: " + std::to_string(descCount) + " descriptors, " + std::to_string(ms * 1e6 / lookupCount) + " ns per lookup");
+        }
+    }
+}  // namespace Falcor
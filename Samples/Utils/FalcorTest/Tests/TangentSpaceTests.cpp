@@ -0,0 +1,221 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/Model/TangentSpace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** A wavy grid. Positions are 4 component to exercise the position stride, and every vertex has two UV sets to exercise the texture coordinates stride.
+            A patch of the grid has collapsed UVs, which uses the default direction path
+        */
+        struct WavyGridMesh
+        {
+            std::vector<glm::vec4> positions;
+            std::vector<glm::vec3> normals;
+            std::vector<glm::vec2> texCrd;
+            std::vector<uint32_t> indices;
+        };
+
+        WavyGridMesh createGrid(uint32_t size, std::mt19937& rng)
+        {
+            std::uniform_real_distribution<float> u(-1, 1);
+            WavyGridMesh mesh;
+            for (uint32_t y = 0; y < size; y++)
+            {
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    float fx = float(x) / size;
+                    float fy = float(y) / size;
+                    float h = 0.1f * std::sin(fx * 20) * std::cos(fy * 13);
+                    float dhdx = 2.0f * std::cos(fx * 20) * std::cos(fy * 13);
+                    float dhdy = -1.3f * std::sin(fx * 20) * std::sin(fy * 13);
+                    mesh.positions.push_back(glm::vec4(fx, h, fy, 1));
+                    mesh.normals.push_back(glm::normalize(glm::vec3(-dhdx, 1, -dhdy) + glm::vec3(u(rng), 0, u(rng)) * 0.05f));
+
+                    bool collapsed = (x < size / 8) && (y < size / 8);
+                    glm::vec2 uv = collapsed ? glm::vec2(0.5f) : glm::vec2(fx, fy) * 4.0f + glm::vec2(u(rng), u(rng)) * (0.2f / size);
+                    mesh.texCrd.push_back(uv);
+                    mesh.texCrd.push_back(glm::vec2(fy, fx));
+                }
+            }
+
+            for (uint32_t y = 0; y + 1 < size; y++)
+            {
+                for (uint32_t x = 0; x + 1 < size; x++)
+                {
+                    uint32_t i = y * size + x;
+                    uint32_t quad[6] = { i, i + size, i + 1, i + 1, i + size, i + size + 1 };
+                    mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+                }
+            }
+            return mesh;
+        }
+
+        TangentSpaceInput getInput(const WavyGridMesh& mesh)
+        {
+            TangentSpaceInput input;
+            input.pIndices = mesh.indices.data();
+            input.indexCount = (uint32_t)mesh.indices.size();
+            input.vertexCount = (uint32_t)mesh.positions.size();
+            input.pPositions = mesh.positions.data();
+            input.positionStride = sizeof(glm::vec4);
+            input.pNormals = mesh.normals.data();
+            input.pTexCrd = mesh.texCrd.data();
+            input.texCrdStride = 2;
+            return input;
+        }
+
+        bool isInvalidVec(const glm::vec3& v)
+        {
+            return std::isfinite(v.x) == false || std::isfinite(v.y) == false || std::isfinite(v.z) == false;
+        }
+
+        glm::vec3 projectNormalToBitangent(const glm::vec3& normal)
+        {
+            glm::vec3 bitangent;
+            if (std::abs(normal.x) > std::abs(normal.y))
+            {
+                bitangent = glm::vec3(normal.z, 0.f, -normal.x) / length(glm::vec2(normal.x, normal.z));
+            }
+            else
+            {
+                bitangent = glm::vec3(0.f, normal.z, -normal.y) / length(glm::vec2(normal.y, normal.z));
+            }
+            return normalize(bitangent);
+        }
+
+        /** The serial per-face scatter the importers used before generateBitangents(). Kept as the reference implementation
+        */
+        void generateReferenceBitangents(const WavyGridMesh& mesh, glm::vec3* pBitangents)
+        {
+            const uint32_t vertexCount = (uint32_t)mesh.positions.size();
+            std::memset(pBitangents, 0, vertexCount * sizeof(glm::vec3));
+            for (size_t primID = 0; primID < mesh.indices.size() / 3; primID++)
+            {
+                uint32_t index[3];
+                for (uint32_t i = 0; i < 3; i++) index[i] = mesh.indices[primID * 3 + i];
+
+                glm::vec3 posDelta[2];
+                posDelta[0] = glm::vec3(mesh.positions[index[1]] - mesh.positions[index[0]]);
+                posDelta[1] = glm::vec3(mesh.positions[index[2]] - mesh.positions[index[0]]);
+                glm::vec2 s = mesh.texCrd[index[1] * 2] - mesh.texCrd[index[0] * 2];
+                glm::vec2 t = mesh.texCrd[index[2] * 2] - mesh.texCrd[index[0] * 2];
+
+                glm::vec3 tangent;
+                glm::vec3 bitangent;
+                if ((s == glm::vec2(0, 0)) || (t == glm::vec2(0, 0)))
+                {
+                    const glm::vec3& normal = mesh.normals[index[0]];
+                    bitangent = projectNormalToBitangent(normal);
+                    tangent = cross(bitangent, normal);
+                }
+                else
+                {
+                    float dirCorrection = 1.0f / (s.x * t.y - s.y * t.x);
+                    tangent = (posDelta[0] * t.y - posDelta[1] * t.x) * dirCorrection;
+                    bitangent = (posDelta[1] * s.x - posDelta[0] * s.y) * dirCorrection;
+                }
+
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    const glm::vec3& normal = mesh.normals[index[i]];
+                    glm::vec3 localTangent = glm::normalize(tangent - normal * glm::dot(tangent, normal));
+                    glm::vec3 localBitangent = glm::normalize(bitangent - normal * glm::dot(bitangent, normal));
+                    localBitangent = glm::normalize(localBitangent - localTangent * glm::dot(localBitangent, localTangent));
+                    if (isInvalidVec(bitangent) == false)
+                    {
+                        pBitangents[index[i]] += normalize(localBitangent);
+                    }
+                }
+            }
+
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                pBitangents[v] = normalize(pBitangents[v]);
+                if (isInvalidVec(pBitangents[v]))
+                {
+                    pBitangents[v] = projectNormalToBitangent(mesh.normals[v]);
+                }
+            }
+        }
+
+        float calcMaxError(const std::vector<glm::vec3>& a, const std::vector<glm::vec3>& b)
+        {
+            float maxError = 0;
+            for (size_t i = 0; i < a.size(); i++) maxError = std::max(maxError, glm::length(a[i] - b[i]));
+            return maxError;
+        }
+    }
+
+    CPU_TEST(TangentSpaceMatchesReference)
+    {
+        std::mt19937 rng(5);
+        WavyGridMesh mesh = createGrid(200, rng);
+        std::vector<glm::vec3> reference(mesh.positions.size());
+        generateReferenceBitangents(mesh, reference.data());
+
+        std::vector<glm::vec3> bitangents(mesh.positions.size());
+        generateBitangents(getInput(mesh), bitangents.data());
+        EXPECT_LE(calcMaxError(reference, bitangents), 1e-4f);
+
+        uint32_t invalid = 0;
+        for (const auto& b : bitangents) invalid += (isInvalidVec(b) || std::abs(glm::length(b) - 1) > 1e-3f) ? 1 : 0;
+        EXPECT_EQ(invalid, 0);
+
+        // The result must not depend on how the faces were split between the workers
+        std::vector<glm::vec3> repeated(mesh.positions.size());
+        generateBitangents(getInput(mesh), repeated.data());
+        EXPECT(std::memcmp(bitangents.data(), repeated.data(), bitangents.size() * sizeof(glm::vec3)) == 0);
+    }
+
+    CPU_BENCHMARK(TangentSpaceBenchmark)
+    {
+        const uint32_t runCount = 5;
+        std::mt19937 rng(6);
+        WavyGridMesh mesh = createGrid(1024, rng);
+        std::vector<glm::vec3> reference(mesh.positions.size());
+        std::vector<glm::vec3> bitangents(mesh.positions.size());
+
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < runCount; i++) generateReferenceBitangents(mesh, reference.data());
+        double referenceMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < runCount; i++) generateBitangents(getInput(mesh), bitangents.data());
+        double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        EXPECT_LE(calcMaxError(reference, bitangents), 1e-4f);
+        logInfo("TangentSpaceBenchmark: " + std::to_string(mesh.indices.size() / 3) + " faces, serial reference " + std::to_string(referenceMs / runCount) + " ms, parallel " + std::to_string(ms / runCount) + " ms");
+    }
+}
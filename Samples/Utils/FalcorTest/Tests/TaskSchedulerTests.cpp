@@ -0,0 +1,195 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Synthetic CPU-bound work, roughly the same amount per call
+        */
+        float syntheticWork(uint32_t seed, uint32_t iterations)
+        {
+            float x = (float)seed;
+            for (uint32_t i = 0; i < iterations; i++) x = std::sin(x) * 0.5f + std::sqrt(std::abs(x) + 1.0f);
+            return x;
+        }
+    }
+
+    CPU_TEST(TaskSchedulerParallelFor)
+    {
+        for (uint32_t workerCount : { 0u, 1u, 4u })
+        {
+            TaskScheduler::SharedPtr pScheduler = TaskScheduler::create(workerCount);
+            const uint32_t count = 100000;
+            std::vector<uint32_t> visits(count, 0);
+            pScheduler->parallelFor(0, count, [&](uint32_t i) { visits[i]++; });
+            uint32_t wrong = 0;
+            for (uint32_t v : visits) wrong += (v != 1) ? 1 : 0;
+            EXPECT_EQ(wrong, 0) << "workers " << workerCount;
+
+            // Ranges must cover [begin, end) without overlapping, for any grain size
+            std::atomic<uint32_t> sum(0);
+            std::atomic<uint32_t> emptyRanges(0);
+            pScheduler->parallelForRange(10, 1010, [&](uint32_t b, uint32_t e) { sum += e - b; emptyRanges += (b >= e) ? 1 : 0; }, 7);
+            EXPECT_EQ(sum, 1000);
+            EXPECT_EQ(emptyRanges, 0);
+        }
+    }
+
+    CPU_TEST(TaskSchedulerGroups)
+    {
+        TaskScheduler::SharedPtr pScheduler = TaskScheduler::create(3);
+        std::atomic<uint32_t> counter(0);
+        {
+            TaskGroup group(pScheduler.get());
+            for (uint32_t i = 0; i < 1000; i++) group.run([&]() { counter++; });
+            group.wait();
+            EXPECT(group.isDone());
+            EXPECT_EQ(counter, 1000);
+        }
+
+        // Nested groups. The outer tasks wait for their inner tasks while running on the workers
+        counter = 0;
+        pScheduler->parallelFor(0, 16, [&](uint32_t)
+        {
+            TaskGroup inner(pScheduler.get());
+            for (uint32_t i = 0; i < 64; i++) inner.run([&]() { counter++; });
+        });
+        EXPECT_EQ(counter, 16 * 64);
+    }
+
+    CPU_TEST(TaskSchedulerDependencies)
+    {
+        TaskScheduler::SharedPtr pScheduler = TaskScheduler::create(4);
+        for (uint32_t iteration = 0; iteration < 100; iteration++)
+        {
+            // A diamond: a -> (b, c) -> d
+            std::atomic<uint32_t> order(0);
+            uint32_t a = 0, b = 0, c = 0, d = 0;
+            TaskScheduler::TaskHandle hA = pScheduler->submit([&]() { a = ++order; });
+            TaskScheduler::TaskHandle hB = pScheduler->submit([&]() { b = ++order; }, { hA });
+            TaskScheduler::TaskHandle hC = pScheduler->submit([&]() { c = ++order; }, { hA });
+            TaskScheduler::TaskHandle hD = pScheduler->submit([&]() { d = ++order; }, { hB, hC });
+            pScheduler->wait(hD);
+            EXPECT(hA.isDone() && hB.isDone() && hC.isDone());
+            EXPECT_EQ(a, 1);
+            EXPECT_GT(b, a);
+            EXPECT_GT(c, a);
+            EXPECT_EQ(d, 4);
+        }
+
+        // Continuation of an already finished task
+        TaskScheduler::TaskHandle hDone = pScheduler->submit([]() {});
+        pScheduler->wait(hDone);
+        bool ran = false;
+        pScheduler->wait(pScheduler->submit([&]() { ran = true; }, { hDone, TaskScheduler::TaskHandle() }));
+        EXPECT(ran);
+    }
+
+    CPU_TEST(TaskSchedulerExceptions)
+    {
+        for (uint32_t workerCount : { 0u, 3u })
+        {
+            TaskScheduler::SharedPtr pScheduler = TaskScheduler::create(workerCount);
+
+            // The group still waits for all its tasks, then rethrows
+            std::atomic<uint32_t> counter(0);
+            bool caught = false;
+            {
+                TaskGroup group(pScheduler.get());
+                for (uint32_t i = 0; i < 100; i++) group.run([&, i]() { if (i == 50) throw std::runtime_error("task failed"); counter++; });
+                try
+                {
+                    group.wait();
+                }
+                catch (const std::runtime_error&)
+                {
+                    caught = true;
+                }
+                EXPECT(group.isDone());
+            }
+            EXPECT(caught) << "workers " << workerCount;
+            EXPECT_EQ(counter, 99);
+
+            // Waiting on the handle rethrows, and the continuations of the failed task still run
+            TaskScheduler::TaskHandle hFailed = pScheduler->submit([]() { throw std::runtime_error("task failed"); });
+            bool continued = false;
+            TaskScheduler::TaskHandle hNext = pScheduler->submit([&]() { continued = true; }, { hFailed });
+            caught = false;
+            try
+            {
+                pScheduler->wait(hFailed);
+            }
+            catch (const std::runtime_error&)
+            {
+                caught = true;
+            }
+            EXPECT(caught);
+            pScheduler->wait(hNext);
+            EXPECT(continued);
+        }
+    }
+
+    CPU_TEST(TaskSchedulerDrainOnDestroy)
+    {
+        std::atomic<uint32_t> counter(0);
+        {
+            TaskScheduler::SharedPtr pScheduler = TaskScheduler::create(2);
+            for (uint32_t i = 0; i < 100; i++) pScheduler->submit([&]() { counter++; });
+        }
+        EXPECT_EQ(counter, 100);
+    }
+
+    CPU_BENCHMARK(TaskSchedulerScalingBenchmark)
+    {
+        // Uneven work per index, so that stealing matters
+        const uint32_t count = 4096;
+        auto work = [](uint32_t i) { return syntheticWork(i, 200 + (i % 64) * 20); };
+        std::vector<float> results(count);
+
+        double baseMs = 0;
+        // Always run at least 4 threads so that stealing is exercised, even if that oversubscribes the machine
+        uint32_t maxThreads = std::max(4u, std::thread::hardware_concurrency());
+        for (uint32_t threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            TaskScheduler::SharedPtr pScheduler = TaskScheduler::create(threads - 1);
+            auto start = CpuTimer::getCurrentTimePoint();
+            pScheduler->parallelFor(0, count, [&](uint32_t i) { results[i] = work(i); }, 16);
+            double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+            if (threads == 1) baseMs = ms;
+            logInfo("TaskSchedulerScalingBenchmark: " + std::to_string(threads) + " threads, " + std::to_string(ms) + " ms, speedup " + std::to_string(baseMs / ms));
+
+            for (uint32_t i = 0; i < count; i += 97) EXPECT_EQ(results[i], work(i));
+        }
+    }
+}  // namespace Falcor
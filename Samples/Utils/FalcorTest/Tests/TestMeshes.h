@@ -0,0 +1,112 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Falcor.h"
+#include "glm/gtc/constants.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+    /** A triangle mesh with positions only, shared by the geometry processing tests
+    */
+    struct SyntheticMesh
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    /** A closed unit sphere with counter-clockwise, outward facing triangles. The poles are single vertices, so the mesh has no borders or seams
+    */
+    inline SyntheticMesh createSphere(uint32_t rings, uint32_t segments)
+    {
+        SyntheticMesh mesh;
+        mesh.positions.push_back(glm::vec3(0, 1, 0));
+        for (uint32_t r = 1; r < rings; r++)
+        {
+            for (uint32_t s = 0; s < segments; s++)
+            {
+                float theta = glm::pi<float>() * r / rings;
+                float phi = glm::two_pi<float>() * s / segments;
+                mesh.positions.push_back(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+            }
+        }
+        mesh.positions.push_back(glm::vec3(0, -1, 0));
+
+        const uint32_t south = (uint32_t)mesh.positions.size() - 1;
+        for (uint32_t s = 0; s < segments; s++)
+        {
+            uint32_t next = (s + 1) % segments;
+            mesh.indices.insert(mesh.indices.end(), { 0, 1 + next, 1 + s });
+            mesh.indices.insert(mesh.indices.end(), { south, south - segments + s, south - segments + next });
+        }
+        for (uint32_t r = 0; r + 2 < rings; r++)
+        {
+            for (uint32_t s = 0; s < segments; s++)
+            {
+                uint32_t a = 1 + r * segments + s;
+                uint32_t b = 1 + r * segments + (s + 1) % segments;
+                mesh.indices.insert(mesh.indices.end(), { a, b, a + segments, b, b + segments, a + segments });
+            }
+        }
+        return mesh;
+    }
+
+    /** A flat gridSize x gridSize grid in the XZ plane
+    */
+    inline SyntheticMesh createGrid(uint32_t gridSize)
+    {
+        SyntheticMesh mesh;
+        for (uint32_t y = 0; y <= gridSize; y++)
+        {
+            for (uint32_t x = 0; x <= gridSize; x++) mesh.positions.push_back(glm::vec3(float(x), 0, float(y)));
+        }
+        for (uint32_t y = 0; y < gridSize; y++)
+        {
+            for (uint32_t x = 0; x < gridSize; x++)
+            {
+                uint32_t i0 = y * (gridSize + 1) + x;
+                uint32_t i2 = i0 + gridSize + 1;
+                mesh.indices.insert(mesh.indices.end(), { i0, i2, i0 + 1, i0 + 1, i2, i2 + 1 });
+            }
+        }
+        return mesh;
+    }
+
+    /** Put the triangles of a mesh in random order, keeping their winding. This is the worst case for the vertex cache
+    */
+    inline void shuffleTriangles(SyntheticMesh& mesh, std::mt19937& rng)
+    {
+        std::vector<glm::uvec3> triangles;
+        for (size_t t = 0; t < mesh.indices.size(); t += 3) triangles.push_back(glm::uvec3(mesh.indices[t], mesh.indices[t + 1], mesh.indices[t + 2]));
+        std::shuffle(triangles.begin(), triangles.end(), rng);
+        mesh.indices.clear();
+        for (const auto& t : triangles) mesh.indices.insert(mesh.indices.end(), { t.x, t.y, t.z });
+    }
+}
@@ -0,0 +1,290 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/TextureCompressor.h"
+#include "Graphics/CompressedTextureCache.h"
+#include "Utils/TaskScheduler.h"
+#include <cmath>
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kSize = 256;
+
+        /** Smooth gradients with some noise and hard edges, which is harder to compress than most textures
+        */
+        std::vector<uint8_t> createImage(uint32_t width, uint32_t height, bool hasAlpha)
+        {
+            std::mt19937 rng(1234);
+            std::uniform_int_distribution<int> noise(-6, 6);
+            std::vector<uint8_t> texels((size_t)width * height * 4);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    const bool edge = ((x / 32) + (y / 32)) & 1;
+                    const int value[4] =
+                    {
+                        (int)(x * 255 / width) + noise(rng),
+                        (int)(y * 255 / height) + noise(rng),
+                        edge ? 200 : 40,
+                        hasAlpha ? (int)((x + y) * 255 / (width + height)) : 255,
+                    };
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        texels[((size_t)y * width + x) * 4 + c] = (uint8_t)std::min(255, std::max(0, value[c]));
+                    }
+                }
+            }
+            return texels;
+        }
+
+        /** Radiance-like HDR image spanning several orders of magnitude
+        */
+        std::vector<float> createHdrImage(uint32_t width, uint32_t height)
+        {
+            std::vector<float> texels((size_t)width * height * 4);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    const float intensity = std::exp2(12.0f * x / width - 4);
+                    float* pTexel = &texels[((size_t)y * width + x) * 4];
+                    pTexel[0] = intensity;
+                    pTexel[1] = intensity * (0.5f + 0.5f * y / height);
+                    pTexel[2] = intensity * 0.25f;
+                    pTexel[3] = 1;
+                }
+            }
+            return texels;
+        }
+
+        TextureCompressor::Image getImage(const void* pData, uint32_t width, uint32_t height, ResourceFormat format)
+        {
+            TextureCompressor::Image image;
+            image.width = width;
+            image.height = height;
+            image.format = format;
+            image.pData = pData;
+            return image;
+        }
+
+        /** Points the texture cache to a new empty directory for the duration of a test
+        */
+        class ScopedCacheDirectory
+        {
+        public:
+            ScopedCacheDirectory() : mPrevDirectory(CompressedTextureCache::getDirectory())
+            {
+                mDirectory = getTempFilename() + "_TextureCache";
+                createDirectory(mDirectory);
+                CompressedTextureCache::setDirectory(mDirectory);
+                CompressedTextureCache::resetStats();
+            }
+
+            ~ScopedCacheDirectory()
+            {
+                CompressedTextureCache::clear();
+                CompressedTextureCache::setDirectory(mPrevDirectory);
+            }
+
+        private:
+            std::string mDirectory;
+            std::string mPrevDirectory;
+        };
+    }
+
+    CPU_TEST(TextureCompressorQuality)
+    {
+        const std::vector<uint8_t> opaque = createImage(kSize, kSize, false);
+        const std::vector<uint8_t> transparent = createImage(kSize, kSize, true);
+        const struct
+        {
+            ResourceFormat format;
+            const std::vector<uint8_t>* pTexels;
+            float minPsnr;
+        } kCases[] =
+        {
+            { ResourceFormat::BC1Unorm, &opaque, 32.0f },
+            { ResourceFormat::BC3Unorm, &transparent, 34.0f },
+            { ResourceFormat::BC4Unorm, &opaque, 38.0f },
+            { ResourceFormat::BC5Unorm, &opaque, 38.0f },
+            { ResourceFormat::BC7Unorm, &transparent, 36.0f },
+        };
+
+        for (const auto& c : kCases)
+        {
+            TextureCompressor::Image image = getImage(c.pTexels->data(), kSize, kSize, ResourceFormat::RGBA8Unorm);
+            TextureCompressor::CompressedImage compressed;
+            auto start = CpuTimer::getCurrentTimePoint();
+            EXPECT(TextureCompressor::compress(image, c.format, false, compressed)) << to_string(c.format);
+            double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+            EXPECT_EQ(compressed.mipCount, 1);
+            EXPECT_EQ(compressed.data.size(), (kSize / 4) * (kSize / 4) * getFormatBytesPerBlock(c.format));
+            float psnr = TextureCompressor::computePsnr(image, compressed);
+            EXPECT_GT(psnr, c.minPsnr) << to_string(c.format);
+            logInfo("TextureCompressorQuality: " + to_string(c.format) + " PSNR " + std::to_string(psnr) + " dB, " + std::to_string(kSize * kSize / (ms * 1000)) + " MPixels/s");
+        }
+    }
+
+    CPU_TEST(TextureCompressorHdr)
+    {
+        const std::vector<float> texels = createHdrImage(kSize, kSize);
+        TextureCompressor::Image image = getImage(texels.data(), kSize, kSize, ResourceFormat::RGBA32Float);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(image, TextureCompressor::Mode::Color), ResourceFormat::BC6HU16);
+
+        TextureCompressor::CompressedImage compressed;
+        EXPECT(TextureCompressor::compress(image, ResourceFormat::BC6HU16, false, compressed));
+        EXPECT_EQ(compressed.data.size(), (kSize / 4) * (kSize / 4) * 16);
+
+        // The error is relative to the magnitude, so check the relative error as well as the PSNR
+        std::vector<float> decoded;
+        EXPECT(TextureCompressor::decompress(compressed, 0, decoded));
+        float maxRelativeError = 0;
+        for (size_t i = 0; i < decoded.size(); i++)
+        {
+            if (i % 4 == 3) continue;
+            maxRelativeError = std::max(maxRelativeError, std::abs(decoded[i] - texels[i]) / texels[i]);
+        }
+        EXPECT_LT(maxRelativeError, 0.05f);
+        EXPECT_GT(TextureCompressor::computePsnr(image, compressed), 40.0f);
+
+        // Negative values are clamped
+        std::vector<float> negative(16 * 4, -1.0f);
+        EXPECT(TextureCompressor::compress(getImage(negative.data(), 4, 4, ResourceFormat::RGBA32Float), ResourceFormat::BC6HU16, false, compressed));
+        EXPECT(TextureCompressor::decompress(compressed, 0, decoded));
+        EXPECT_EQ(decoded[0], 0.0f);
+    }
+
+    CPU_TEST(TextureCompressorMips)
+    {
+        // A uniform sRGB color must keep its value in every mip
+        std::vector<uint8_t> texels(64 * 32 * 4);
+        for (size_t i = 0; i < texels.size(); i++) texels[i] = (i % 4 == 3) ? 255 : (i % 4 == 0 ? 180 : 60);
+        TextureCompressor::Image image = getImage(texels.data(), 64, 32, ResourceFormat::RGBA8UnormSrgb);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(image, TextureCompressor::Mode::Color), ResourceFormat::BC1UnormSrgb);
+
+        TextureCompressor::CompressedImage compressed;
+        EXPECT(TextureCompressor::compress(image, ResourceFormat::BC1UnormSrgb, true, compressed));
+        EXPECT_EQ(compressed.mipCount, 7);
+
+        size_t size = 0;
+        for (uint32_t mip = 0; mip < compressed.mipCount; mip++) size += TextureCompressor::getMipSize(64, 32, compressed.format, mip);
+        EXPECT_EQ(compressed.data.size(), size);
+        EXPECT_EQ(TextureCompressor::getMipSize(64, 32, compressed.format, 6), 8);
+
+        std::vector<float> decoded;
+        for (uint32_t mip = 0; mip < compressed.mipCount; mip++)
+        {
+            EXPECT(TextureCompressor::decompress(compressed, mip, decoded));
+            EXPECT_EQ(decoded.size(), std::max(1u, 64u >> mip) * std::max(1u, 32u >> mip) * 4);
+            EXPECT_LE(std::abs(decoded[0] - 180), 4.0f) << "mip " << mip;
+            EXPECT_LE(std::abs(decoded[1] - 60), 4.0f) << "mip " << mip;
+        }
+
+        // A black and white checkerboard averages to middle gray in linear space, which is 188 in sRGB
+        for (size_t i = 0; i < texels.size(); i += 4)
+        {
+            const size_t x = (i / 4) % 64;
+            const size_t y = (i / 4) / 64;
+            texels[i] = texels[i + 1] = texels[i + 2] = ((x + y) & 1) ? 255 : 0;
+        }
+        EXPECT(TextureCompressor::compress(image, ResourceFormat::BC1UnormSrgb, true, compressed));
+        EXPECT(TextureCompressor::decompress(compressed, 1, decoded));
+        EXPECT_LE(std::abs(decoded[0] - 188), 4.0f);
+    }
+
+    CPU_TEST(TextureCompressorFormatSelection)
+    {
+        const std::vector<uint8_t> opaque = createImage(16, 16, false);
+        const std::vector<uint8_t> transparent = createImage(16, 16, true);
+        using Mode = TextureCompressor::Mode;
+
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(getImage(opaque.data(), 16, 16, ResourceFormat::RGBA8Unorm), Mode::Color), ResourceFormat::BC1Unorm);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(getImage(transparent.data(), 16, 16, ResourceFormat::RGBA8Unorm), Mode::Color), ResourceFormat::BC7Unorm);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(getImage(transparent.data(), 16, 16, ResourceFormat::BGRA8UnormSrgb), Mode::Color), ResourceFormat::BC7UnormSrgb);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(getImage(transparent.data(), 16, 16, ResourceFormat::BGRX8Unorm), Mode::Color), ResourceFormat::BC1Unorm);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(getImage(opaque.data(), 16, 16, ResourceFormat::R8Unorm), Mode::Color), ResourceFormat::BC4Unorm);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(getImage(opaque.data(), 16, 16, ResourceFormat::RG8Unorm), Mode::Color), ResourceFormat::BC5Unorm);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(getImage(opaque.data(), 16, 16, ResourceFormat::RGBA8Unorm), Mode::NormalMap), ResourceFormat::BC5Unorm);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(getImage(opaque.data(), 16, 16, ResourceFormat::RGBA8Unorm), Mode::None), ResourceFormat::Unknown);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(getImage(opaque.data(), 14, 16, ResourceFormat::RGBA8Unorm), Mode::Color), ResourceFormat::Unknown);
+        EXPECT_EQ(TextureCompressor::getCompressedFormat(getImage(opaque.data(), 16, 16, ResourceFormat::RGBA16Unorm), Mode::Color), ResourceFormat::Unknown);
+    }
+
+    CPU_TEST(TextureCompressorDeterministic)
+    {
+        // The result doesn't depend on how the blocks are distributed between threads
+        const std::vector<uint8_t> texels = createImage(kSize, kSize, true);
+        TextureCompressor::Image image = getImage(texels.data(), kSize, kSize, ResourceFormat::RGBA8Unorm);
+        TaskScheduler::SharedPtr pSerial = TaskScheduler::create(0);
+        TextureCompressor::CompressedImage serial, parallel;
+        EXPECT(TextureCompressor::compress(image, ResourceFormat::BC7Unorm, true, serial, pSerial.get()));
+        EXPECT(TextureCompressor::compress(image, ResourceFormat::BC7Unorm, true, parallel));
+        EXPECT(serial.data == parallel.data);
+    }
+
+    CPU_TEST(CompressedTextureCacheRoundTrip)
+    {
+        ScopedCacheDirectory cacheDir;
+        const std::vector<uint8_t> texels = createImage(64, 64, false);
+        TextureCompressor::CompressedImage compressed, loaded;
+        EXPECT(TextureCompressor::compress(getImage(texels.data(), 64, 64, ResourceFormat::RGBA8UnormSrgb), ResourceFormat::BC1UnormSrgb, true, compressed));
+
+        const uint64_t key = CompressedTextureCache::getKey(1234, TextureCompressor::Mode::Color, true, true);
+        EXPECT(key != CompressedTextureCache::getKey(1234, TextureCompressor::Mode::Color, false, true));
+        EXPECT(!CompressedTextureCache::load(key, loaded));
+        EXPECT(CompressedTextureCache::store(key, compressed));
+        EXPECT(CompressedTextureCache::load(key, loaded));
+        EXPECT_EQ(loaded.width, 64);
+        EXPECT_EQ(loaded.height, 64);
+        EXPECT_EQ(loaded.mipCount, compressed.mipCount);
+        EXPECT_EQ(loaded.format, ResourceFormat::BC1UnormSrgb);
+        EXPECT(loaded.data == compressed.data);
+
+        // Corrupt the data
+        std::string filename = CompressedTextureCache::getEntryFilename(key);
+        std::string content = readFile(filename);
+        content[content.size() - 1] ^= 0xff;
+        {
+            std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+            file << content;
+        }
+        EXPECT(!CompressedTextureCache::load(key, loaded));
+
+        CompressedTextureCache::Stats stats = CompressedTextureCache::getStats();
+        EXPECT_EQ(stats.hits, 1);
+        EXPECT_EQ(stats.misses, 2);
+        EXPECT_EQ(stats.rejected, 1);
+        EXPECT_EQ(stats.stores, 1);
+    }
+}
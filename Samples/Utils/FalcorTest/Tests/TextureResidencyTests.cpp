@@ -0,0 +1,313 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "UnitTest.h"
+#include "Graphics/TextureResidencyManager.h"
+#include "Utils/TaskScheduler.h"
+#include <atomic>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        using Desc = TextureResidencyManager::TextureDesc;
+
+        /** Records the calls of the manager and checks that the resident mips stay a contiguous chain
+        */
+        class MockBackend : public TextureResidencyManager::Backend
+        {
+        public:
+            uint32_t addTexture(TextureResidencyManager* pManager, uint32_t size)
+            {
+                Desc desc;
+                desc.width = size;
+                desc.height = size;
+                desc.mipCount = 1;
+                while ((size >> desc.mipCount) != 0) desc.mipCount++;
+                desc.format = ResourceFormat::RGBA8Unorm;
+
+                uint32_t tailMip = TextureResidencyManager::getTailMip(desc, 64);
+                mDescs.push_back(desc);
+                mResident.push_back(tailMip);
+                mUsed.push_back(true);
+                mFailing.push_back(false);
+                mReleased.push_back(false);
+                return pManager->addTexture(desc, tailMip);
+            }
+
+            bool readMips(uint32_t id, uint32_t firstMip, uint32_t endMip, std::vector<uint8_t>& data) override
+            {
+                mReadCount++;
+                if (mFailing[id]) return false;
+
+                // Each byte holds the level it belongs to
+                data.clear();
+                for (uint32_t mip = firstMip; mip < endMip; mip++)
+                {
+                    data.resize(data.size() + (size_t)TextureResidencyManager::getMipSize(mDescs[id], mip), (uint8_t)mip);
+                }
+                return true;
+            }
+
+            void uploadMips(uint32_t id, uint32_t firstMip, uint32_t endMip, const uint8_t* pData) override
+            {
+                if (endMip != mResident[id] || firstMip >= endMip || pData[0] != firstMip) mErrors++;
+                mResident[id] = firstMip;
+                mUploadCount++;
+            }
+
+            void evictMips(uint32_t id, uint32_t firstMip) override
+            {
+                if (firstMip <= mResident[id]) mErrors++;
+                mResident[id] = firstMip;
+                mEvictCount++;
+            }
+
+            bool isTextureUsed(uint32_t id) override { return mUsed[id]; }
+            void releaseTexture(uint32_t id) override { mReleased[id] = true; }
+
+            std::vector<Desc> mDescs;
+            std::vector<uint32_t> mResident;
+            std::vector<bool> mUsed;
+            std::vector<bool> mFailing;
+            std::vector<bool> mReleased;
+            std::atomic<uint32_t> mReadCount{ 0 };
+            uint32_t mUploadCount = 0;
+            uint32_t mEvictCount = 0;
+            uint32_t mErrors = 0;
+        };
+
+        uint64_t getResidentSize(const MockBackend& backend, uint32_t id)
+        {
+            const Desc& desc = backend.mDescs[id];
+            return TextureResidencyManager::getMipRangeSize(desc, backend.mResident[id], desc.mipCount);
+        }
+
+        uint64_t getTailSize(const MockBackend& backend, uint32_t id)
+        {
+            const Desc& desc = backend.mDescs[id];
+            return TextureResidencyManager::getMipRangeSize(desc, TextureResidencyManager::getTailMip(desc, 64), desc.mipCount);
+        }
+
+        // Without workers, the loads only run when the manager waits for them
+        void runFrame(TextureResidencyManager* pManager)
+        {
+            pManager->update();
+            pManager->waitForLoads();
+        }
+    }
+
+    CPU_TEST(TextureResidencyRequests)
+    {
+        TaskScheduler::SharedPtr pScheduler = TaskScheduler::create(0);
+        MockBackend backend;
+        TextureResidencyManager::SharedPtr pManager = TextureResidencyManager::create(&backend, 1ull << 30, pScheduler.get());
+
+        for (uint32_t i = 0; i < 3; i++) backend.addTexture(pManager.get(), 1024);
+        EXPECT_EQ(pManager->getTextureState(0).tailMip, 4);
+        EXPECT_EQ(pManager->getStats().residentBytes, 3 * getTailSize(backend, 0));
+
+        // Requests start loads, which are uploaded by the next update
+        pManager->requestMip(0, -1.0f);
+        pManager->requestMip(1, 2.7f);
+        pManager->requestMip(1, 5.0f);
+        pManager->update();
+        EXPECT_EQ(pManager->getTextureState(0).targetMip, 0);
+        EXPECT_EQ(pManager->getTextureState(1).targetMip, 2);
+        EXPECT(pManager->getTextureState(0).isLoading);
+        EXPECT_EQ(pManager->getStats().pendingLoads, 2);
+        EXPECT_EQ(backend.mUploadCount, 0);
+
+        pManager->waitForLoads();
+        pManager->update();
+        EXPECT_EQ(pManager->getTextureState(0).residentMip, 0);
+        EXPECT_EQ(pManager->getTextureState(1).residentMip, 2);
+        EXPECT_EQ(pManager->getTextureState(2).residentMip, 4);
+        EXPECT_EQ(backend.mUploadCount, 2);
+        EXPECT_EQ(pManager->getStats().pendingLoads, 0);
+        EXPECT_EQ(pManager->getStats().residentBytes, getResidentSize(backend, 0) + getResidentSize(backend, 1) + getResidentSize(backend, 2));
+
+        // Mips which are no longer requested stay resident while there is space for them
+        for (uint32_t frame = 0; frame < 10; frame++) runFrame(pManager.get());
+        EXPECT_EQ(pManager->getTextureState(0).residentMip, 0);
+        EXPECT_EQ(backend.mEvictCount, 0);
+
+        // Failed loads aren't retried every frame
+        backend.mFailing[2] = true;
+        uint32_t readCount = backend.mReadCount;
+        for (uint32_t frame = 0; frame < 10; frame++)
+        {
+            pManager->requestMip(2, 0);
+            runFrame(pManager.get());
+        }
+        EXPECT_EQ(backend.mReadCount, readCount + 1);
+        EXPECT_EQ(pManager->getTextureState(2).residentMip, 4);
+
+        // Unused textures are removed
+        backend.mUsed[1] = false;
+        runFrame(pManager.get());
+        EXPECT(backend.mReleased[1]);
+        EXPECT_EQ(pManager->getStats().residentBytes, getResidentSize(backend, 0) + getResidentSize(backend, 2));
+        EXPECT_EQ(backend.mErrors, 0);
+    }
+
+    CPU_TEST(TextureResidencyBudget)
+    {
+        TaskScheduler::SharedPtr pScheduler = TaskScheduler::create(0);
+        MockBackend backend;
+        TextureResidencyManager::SharedPtr pManager = TextureResidencyManager::create(&backend, 0, pScheduler.get());
+
+        const uint32_t textureCount = 8;
+        for (uint32_t i = 0; i < textureCount; i++) backend.addTexture(pManager.get(), 1024);
+        const uint64_t tailSize = textureCount * getTailSize(backend, 0);
+        const uint64_t fullSize = TextureResidencyManager::getMipRangeSize(backend.mDescs[0], 0, backend.mDescs[0].mipCount);
+
+        // Room for about two full textures. Textures which compete for the budget get the same levels, give or take one
+        pManager->setBudget(tailSize + 2 * fullSize);
+        for (uint32_t frame = 0; frame < 10; frame++)
+        {
+            for (uint32_t i = 0; i < textureCount; i++) pManager->requestMip(i, 0);
+            runFrame(pManager.get());
+            EXPECT_LE(pManager->getStats().residentBytes, pManager->getBudget());
+        }
+        uint32_t finest = 100, coarsest = 0;
+        for (uint32_t i = 0; i < textureCount; i++)
+        {
+            finest = std::min(finest, pManager->getTextureState(i).residentMip);
+            coarsest = std::max(coarsest, pManager->getTextureState(i).residentMip);
+        }
+        EXPECT_LE(coarsest - finest, 1);
+        EXPECT_LT(coarsest, 4);
+
+        // Only the first texture is requested from now on. Once the others are no longer recent, it takes over the budget and they lose the mips it needs
+        for (uint32_t frame = 0; frame < 20; frame++)
+        {
+            pManager->requestMip(0, 0);
+            runFrame(pManager.get());
+            EXPECT_LE(pManager->getStats().residentBytes, pManager->getBudget());
+        }
+        EXPECT_EQ(pManager->getTextureState(0).residentMip, 0);
+        EXPECT_GT(backend.mEvictCount, 0);
+
+        // The least recently requested textures are evicted first. Textures requested in the last few frames count as equally recent, so space the requests out
+        pManager->setBudget(tailSize + fullSize + TextureResidencyManager::getMipRangeSize(backend.mDescs[0], 1, 4));
+        for (uint32_t i = 1; i <= 4; i++)
+        {
+            pManager->requestMip(i, 0);
+            for (uint32_t frame = 0; frame < 20; frame++) runFrame(pManager.get());
+        }
+        pManager->requestMip(0, 0);
+        pManager->requestMip(4, 0);
+        runFrame(pManager.get());
+        runFrame(pManager.get());
+        EXPECT_EQ(pManager->getTextureState(0).residentMip, 0);
+        EXPECT_EQ(pManager->getTextureState(4).residentMip, 1);
+        for (uint32_t i = 1; i < 4; i++) EXPECT_EQ(pManager->getTextureState(i).residentMip, 4) << "texture " << i;
+        EXPECT_LE(pManager->getStats().residentBytes, pManager->getBudget());
+        EXPECT_EQ(backend.mErrors, 0);
+    }
+
+    CPU_TEST(TextureResidencyUploadLimit)
+    {
+        TaskScheduler::SharedPtr pScheduler = TaskScheduler::create(0);
+        MockBackend backend;
+        TextureResidencyManager::SharedPtr pManager = TextureResidencyManager::create(&backend, 1ull << 30, pScheduler.get());
+        for (uint32_t i = 0; i < 4; i++) backend.addTexture(pManager.get(), 512);
+
+        // Every load is larger than the limit, so one load is uploaded per frame
+        pManager->setMaxUploadBytesPerFrame(1024);
+        for (uint32_t i = 0; i < 4; i++) pManager->requestMip(i, 0);
+        runFrame(pManager.get());
+        EXPECT_EQ(pManager->getStats().pendingLoads, 4);
+        for (uint32_t frame = 1; frame <= 4; frame++)
+        {
+            runFrame(pManager.get());
+            EXPECT_EQ(backend.mUploadCount, frame);
+        }
+        EXPECT_EQ(pManager->getStats().pendingLoads, 0);
+        for (uint32_t i = 0; i < 4; i++) EXPECT_EQ(pManager->getTextureState(i).residentMip, 0) << "texture " << i;
+
+        // Limit the number of loads in flight
+        pManager->setMaxPendingLoads(2);
+        pManager->setBudget(0);
+        runFrame(pManager.get());
+        pManager->setBudget(1ull << 30);
+        for (uint32_t i = 0; i < 4; i++) pManager->requestMip(i, 0);
+        pManager->update();
+        EXPECT_EQ(pManager->getStats().pendingLoads, 2);
+        pManager->waitForLoads();
+        EXPECT_EQ(backend.mErrors, 0);
+    }
+
+    CPU_TEST(TextureResidencyAsync)
+    {
+        // Loads run on worker threads while the frames are processed, with changing demand and a budget which can't fit everything
+        TaskScheduler::SharedPtr pScheduler = TaskScheduler::create(4);
+        MockBackend backend;
+        TextureResidencyManager::SharedPtr pManager = TextureResidencyManager::create(&backend, 0, pScheduler.get());
+        const uint32_t textureCount = 32;
+        for (uint32_t i = 0; i < textureCount; i++) backend.addTexture(pManager.get(), 256u << (i % 4));
+
+        uint64_t tailSize = 0;
+        for (uint32_t i = 0; i < textureCount; i++) tailSize += getTailSize(backend, i);
+        pManager->setBudget(tailSize + 8 * 1024 * 1024);
+
+        // Every few frames, a different set of textures becomes visible and is requested at different levels
+        std::mt19937 rng(17);
+        std::vector<float> requests(textureCount);
+        uint32_t mismatches = 0;
+        for (uint32_t frame = 0; frame < 200; frame++)
+        {
+            if ((frame % 25) == 0)
+            {
+                for (float& mip : requests) mip = (rng() % 3 == 0) ? (float)(rng() % 8) - 1.0f : -1.0f;
+            }
+            for (uint32_t i = 0; i < textureCount; i++)
+            {
+                if (requests[i] >= 0) pManager->requestMip(i, requests[i]);
+            }
+            pManager->update();
+            EXPECT_LE(pManager->getStats().residentBytes, pManager->getBudget());
+
+            // Frames take much less time than loads here, so give the workers time to finish some of them
+            if ((frame % 10) == 9) pManager->waitForLoads();
+
+            uint64_t residentBytes = 0;
+            for (uint32_t i = 0; i < textureCount; i++)
+            {
+                residentBytes += getResidentSize(backend, i);
+                if (backend.mResident[i] != pManager->getTextureState(i).residentMip) mismatches++;
+            }
+            EXPECT_EQ(residentBytes, pManager->getStats().residentBytes);
+        }
+        pManager->waitForLoads();
+        EXPECT_EQ(mismatches, 0);
+        EXPECT_EQ(backend.mErrors, 0);
+        EXPECT_GT(pManager->getStats().loadCount, 0);
+    }
+}